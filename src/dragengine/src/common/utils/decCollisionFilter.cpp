@@ -24,6 +24,7 @@
 #include <string.h>
 
 #include "decCollisionFilter.h"
+#include "../exceptions.h"
 
 
 
@@ -33,20 +34,31 @@
 // Constructor, destructor
 ////////////////////////////
 
-decCollisionFilter::decCollisionFilter(){
+decCollisionFilter::decCollisionFilter() :
+pTeam( 0 ),
+pIgnoreTeam( false )
+{
 	pFilter.FillMask();
 }
 
 decCollisionFilter::decCollisionFilter( const decLayerMask &mask ) :
-pCategory( mask ), pFilter( mask ){
+pCategory( mask ), pFilter( mask ), pTeam( 0 ), pIgnoreTeam( false ){
 }
 
 decCollisionFilter::decCollisionFilter( const decLayerMask &category, const decLayerMask &filter ) :
-pCategory( category ), pFilter( filter ){
+pCategory( category ), pFilter( filter ), pTeam( 0 ), pIgnoreTeam( false ){
+}
+
+decCollisionFilter::decCollisionFilter( const decLayerMask &category, const decLayerMask &filter,
+int team, bool ignoreTeam ) :
+pCategory( category ), pFilter( filter ), pTeam( 0 ), pIgnoreTeam( ignoreTeam )
+{
+	SetTeam( team );
 }
 
 decCollisionFilter::decCollisionFilter( const decCollisionFilter &other ) :
-pCategory( other.pCategory ), pFilter( other.pFilter ){
+pCategory( other.pCategory ), pFilter( other.pFilter ),
+pTeam( other.pTeam ), pIgnoreTeam( other.pIgnoreTeam ){
 }
 
 decCollisionFilter::~decCollisionFilter(){
@@ -57,12 +69,27 @@ decCollisionFilter::~decCollisionFilter(){
 // Management
 ///////////////
 
+void decCollisionFilter::SetTeam( int team ){
+	if( team < 0 ){
+		DETHROW( deeInvalidParam );
+	}
+	pTeam = team;
+}
+
+void decCollisionFilter::SetIgnoreTeam( bool ignoreTeam ){
+	pIgnoreTeam = ignoreTeam;
+}
+
+
+
 bool decCollisionFilter::Collides( const decCollisionFilter &other ) const{
-	return pFilter.Matches( other.pCategory ) && other.pFilter.Matches( pCategory );
+	return pFilter.Matches( other.pCategory ) && other.pFilter.Matches( pCategory )
+		&& ! pIgnoresTeamOf( other );
 }
 
 bool decCollisionFilter::CollidesNot( const decCollisionFilter &other ) const{
-	return pFilter.MatchesNot( other.pCategory ) || other.pFilter.MatchesNot( pCategory );
+	return pFilter.MatchesNot( other.pCategory ) || other.pFilter.MatchesNot( pCategory )
+		|| pIgnoresTeamOf( other );
 }
 
 bool decCollisionFilter::CanCollide() const{
@@ -79,15 +106,19 @@ bool decCollisionFilter::CanNotCollide() const{
 //////////////
 
 bool decCollisionFilter::operator==( const decCollisionFilter &other ) const{
-	return pCategory == other.pCategory && pFilter == other.pFilter;
+	return pCategory == other.pCategory && pFilter == other.pFilter
+		&& pTeam == other.pTeam && pIgnoreTeam == other.pIgnoreTeam;
 }
 
 bool decCollisionFilter::operator!=( const decCollisionFilter &other ) const{
-	return pCategory != other.pCategory || pFilter != other.pFilter;
+	return pCategory != other.pCategory || pFilter != other.pFilter
+		|| pTeam != other.pTeam || pIgnoreTeam != other.pIgnoreTeam;
 }
 
 decCollisionFilter &decCollisionFilter::operator=( const decCollisionFilter &other ){
 	pCategory = other.pCategory;
 	pFilter = other.pFilter;
+	pTeam = other.pTeam;
+	pIgnoreTeam = other.pIgnoreTeam;
 	return *this;
 }
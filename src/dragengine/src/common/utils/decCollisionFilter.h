@@ -36,11 +36,18 @@
  * filter to the same value. Otherwise category is usually set to the
  * object category and the filter to all categories the object is
  * allowed to collide with.
+ * 
+ * Optionally a team number can be set. Collision filters with the same team number do
+ * not collide if either of them ignores the team. This allows for example projectiles
+ * to pass through team members while team members still collide with each other. Team
+ * number 0 is no team.
  */
 class decCollisionFilter{
 private:
 	decLayerMask pCategory;
 	decLayerMask pFilter;
+	int pTeam;
+	bool pIgnoreTeam;
 	
 	
 	
@@ -60,6 +67,13 @@ public:
 	/** \brief Create new collision filter from a set of layer masks. */
 	decCollisionFilter( const decLayerMask &category, const decLayerMask &filter );
 	
+	/**
+	 * \brief Create new collision filter from a set of layer masks and team.
+	 * \throws deeInvalidParam \em team is less than 0.
+	 */
+	decCollisionFilter( const decLayerMask &category, const decLayerMask &filter,
+		int team, bool ignoreTeam );
+		
 	/** \brief Create copy of a collision filter. */
 	decCollisionFilter( const decCollisionFilter &other );
 	
@@ -79,12 +93,28 @@ public:
 	inline decLayerMask &GetFilter(){ return pFilter; }
 	inline const decLayerMask &GetFilter() const{ return pFilter; }
 	
+	/** \brief Team number or 0 if not in a team. */
+	inline int GetTeam() const{ return pTeam; }
+	
+	/**
+	 * \brief Set team number or 0 if not in a team.
+	 * \throws deeInvalidParam \em team is less than 0.
+	 */
+	void SetTeam( int team );
+	
+	/** \brief Collision filter does not collide with filters of the same team. */
+	inline bool GetIgnoreTeam() const{ return pIgnoreTeam; }
+	
+	/** \brief Set if collision filter does not collide with filters of the same team. */
+	void SetIgnoreTeam( bool ignoreTeam );
+	
 	/**
 	 * \brief Determines if two collision filters can collide.
 	 * 
 	 * Tests if for both collision filters the category matches the other filter.
 	 * Hence the result is this.filter.Matches(other.category) and
-	 * other.filter.Matches(this.category).
+	 * other.filter.Matches(this.category). In addition the filters can not be in
+	 * the same team if one of them ignores the team.
 	 */
 	bool Collides( const decCollisionFilter &other ) const;
 	
@@ -93,7 +123,8 @@ public:
 	 * 
 	 * Tests if for any of both collision filters the category matches not the other filter.
 	 * Hence the result is this.filter.MatchesNot(other.category) or
-	 * other.filter.MatchesNot(this.category).
+	 * other.filter.MatchesNot(this.category). In addition the filters can not collide
+	 * if they are in the same team and one of them ignores the team.
 	 */
 	bool CollidesNot( const decCollisionFilter &other ) const;
 	
@@ -127,6 +158,13 @@ public:
 	/** \brief Sets this collision filter from another one. */
 	decCollisionFilter &operator=( const decCollisionFilter &other );
 	/*@}*/
+	
+	
+	
+private:
+	inline bool pIgnoresTeamOf( const decCollisionFilter &other ) const{
+		return pTeam != 0 && pTeam == other.pTeam && ( pIgnoreTeam || other.pIgnoreTeam );
+	}
 };
 
 #endif
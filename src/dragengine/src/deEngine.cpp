@@ -938,6 +938,7 @@ void deEngine::RunSingleFrame(){
 DEBUG_PRINT_TIMER( "DoFrame: Process input events" );
 	
 	// frame update
+	GetComponentManager()->NextSkinningStatsFrame();
 	pParallelProcessing->Update();
 	scrSys.OnFrameUpdate();
 DEBUG_PRINT_TIMER( "DoFrame: Script OnFrameUpdate" );
@@ -371,6 +371,7 @@ void deParallelProcessing::FinishAndRemoveTasksOwnedBy( deBaseModule *module ){
 					task->SetFinished();
 				}
 				
+				task->Cancelled();
 				pListFinishedTasks.Add( task );
 				
 			}else{
@@ -389,6 +390,7 @@ void deParallelProcessing::FinishAndRemoveTasksOwnedBy( deBaseModule *module ){
 					task->SetFinished();
 				}
 				
+				task->Cancelled();
 				pListFinishedTasks.Add( task );
 				
 			}else{
@@ -512,6 +514,7 @@ void deParallelProcessing::FinishAndRemoveAllTasks(){
 					task->SetFinished();
 				}
 				
+				task->Cancelled();
 				pListFinishedTasks.Add( task );
 				
 			}else{
@@ -530,6 +533,7 @@ void deParallelProcessing::FinishAndRemoveAllTasks(){
 					task->SetFinished();
 				}
 				
+				task->Cancelled();
 				pListFinishedTasks.Add( task );
 				
 			}else{
@@ -620,6 +624,7 @@ deParallelTask *deParallelProcessing::NextPendingTask( bool takeLowPriorityTasks
 				pSemaphoreNewTasks.Signal();
 			}
 			
+			task->Cancelled();
 			pListFinishedTasks.Add( task );
 			
 		}else if( task->CanRun() ){
@@ -679,6 +684,7 @@ deParallelTask *deParallelProcessing::NextPendingTask( bool takeLowPriorityTasks
 				pSemaphoreNewTasks.Signal();
 			}
 			
+			task->Cancelled();
 			pListFinishedTasks.Add( task );
 			
 		}else if( task->CanRun() ){
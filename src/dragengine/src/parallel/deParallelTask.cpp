@@ -175,6 +175,14 @@ void deParallelTask::Reset(){
 
 
 
+// Subclass Responsibility
+////////////////////////////
+
+void deParallelTask::Cancelled(){
+}
+
+
+
 // Debugging
 //////////////
 
@@ -233,6 +233,19 @@ public:
 	 * \warning Do as little work as possible here to not stall too much.
 	 */
 	virtual void Finished() = 0;
+	
+	/**
+	 * \brief Task has been cancelled before Run() has been called.
+	 * 
+	 * Called by deParallelProcessing while dropping a pending cancelled task. Run() is not
+	 * called for such tasks. Finished() is still called later on in the main engine thread.
+	 * This allows tasks to wake up threads other than the main engine thread waiting for
+	 * the task to finish. Default implementation does nothing.
+	 * 
+	 * \warning Called from worker threads or the main engine thread while deParallelProcessing
+	 *          holds the task mutex. Do not call into deParallelProcessing and do not throw.
+	 */
+	virtual void Cancelled();
 	/*@}*/
 	
 	
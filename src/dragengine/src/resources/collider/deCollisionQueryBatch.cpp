@@ -0,0 +1,172 @@
+/* 
+ * Drag[en]gine Game Engine
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "deCollisionQueryBatch.h"
+#include "deCollider.h"
+#include "../../common/exceptions.h"
+
+
+
+// Class deCollisionQueryBatch
+////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+deCollisionQueryBatch::deCollisionQueryBatch() :
+pClosestHitOnly( false ),
+pQueries( NULL ),
+pQueryCount( 0 ),
+pQuerySize( 0 ),
+pHits( NULL ),
+pHitCount( 0 ),
+pHitSize( 0 ){
+}
+
+deCollisionQueryBatch::~deCollisionQueryBatch(){
+	if( pHits ){
+		delete [] pHits;
+	}
+	if( pQueries ){
+		delete [] pQueries;
+	}
+}
+
+
+
+// Management
+///////////////
+
+void deCollisionQueryBatch::SetCollisionFilter( const decCollisionFilter &filter ){
+	pCollisionFilter = filter;
+}
+
+void deCollisionQueryBatch::SetCollider( deCollider *collider ){
+	pCollider = collider;
+}
+
+void deCollisionQueryBatch::SetClosestHitOnly( bool closestHitOnly ){
+	pClosestHitOnly = closestHitOnly;
+}
+
+
+
+// Queries
+////////////
+
+const deCollisionQueryBatch::sQuery &deCollisionQueryBatch::GetQueryAt( int index ) const{
+	if( index < 0 || index >= pQueryCount ){
+		DETHROW( deeInvalidParam );
+	}
+	return pQueries[ index ];
+}
+
+int deCollisionQueryBatch::AddQuery( const decDVector &origin, const decVector &direction ){
+	if( pQueryCount == pQuerySize ){
+		const int newSize = pQuerySize * 3 / 2 + 1;
+		sQuery * const newArray = new sQuery[ newSize ];
+		if( pQueries ){
+			int i;
+			for( i=0; i<pQueryCount; i++ ){
+				newArray[ i ] = pQueries[ i ];
+			}
+			delete [] pQueries;
+		}
+		pQueries = newArray;
+		pQuerySize = newSize;
+	}
+	
+	sQuery &query = pQueries[ pQueryCount ];
+	query.origin = origin;
+	query.direction = direction;
+	query.firstHit = 0;
+	query.hitCount = 0;
+	return pQueryCount++;
+}
+
+void deCollisionQueryBatch::SetQueryAt( int index, const decDVector &origin, const decVector &direction ){
+	if( index < 0 || index >= pQueryCount ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	pQueries[ index ].origin = origin;
+	pQueries[ index ].direction = direction;
+}
+
+void deCollisionQueryBatch::RemoveAllQueries(){
+	pQueryCount = 0;
+	pHitCount = 0;
+}
+
+
+
+// Hits
+/////////
+
+const deCollisionQueryBatch::sHit &deCollisionQueryBatch::GetHitAt( int index ) const{
+	if( index < 0 || index >= pHitCount ){
+		DETHROW( deeInvalidParam );
+	}
+	return pHits[ index ];
+}
+
+void deCollisionQueryBatch::AddHit( const sHit &hit ){
+	if( hit.query < 0 || hit.query >= pQueryCount ){
+		DETHROW( deeInvalidParam );
+	}
+	if( pHitCount > 0 && hit.query < pHits[ pHitCount - 1 ].query ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	if( pHitCount == pHitSize ){
+		const int newSize = pHitSize * 3 / 2 + 1;
+		sHit * const newArray = new sHit[ newSize ];
+		if( pHits ){
+			int i;
+			for( i=0; i<pHitCount; i++ ){
+				newArray[ i ] = pHits[ i ];
+			}
+			delete [] pHits;
+		}
+		pHits = newArray;
+		pHitSize = newSize;
+	}
+	
+	sQuery &query = pQueries[ hit.query ];
+	if( query.hitCount == 0 ){
+		query.firstHit = pHitCount;
+	}
+	query.hitCount++;
+	
+	pHits[ pHitCount++ ] = hit;
+}
+
+void deCollisionQueryBatch::RemoveAllHits(){
+	int i;
+	for( i=0; i<pQueryCount; i++ ){
+		pQueries[ i ].firstHit = 0;
+		pQueries[ i ].hitCount = 0;
+	}
+	pHitCount = 0;
+}
@@ -0,0 +1,206 @@
+/* 
+ * Drag[en]gine Game Engine
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DECOLLISIONQUERYBATCH_H_
+#define _DECOLLISIONQUERYBATCH_H_
+
+#include "deColliderReference.h"
+#include "../../common/math/decMath.h"
+#include "../../common/utils/decCollisionFilter.h"
+
+class deHeightTerrain;
+class deHeightTerrainSector;
+
+
+/**
+ * \brief Batch of collision queries.
+ * 
+ * Stores a list of queries to be tested against a world in one call and the found hits.
+ * Each query is an origin and a direction. If no collider is set a ray is cast from the
+ * origin along the direction. If a collider is set the shapes of the collider are cast
+ * from the origin along the direction using the collider orientation. The collider itself
+ * is ignored during testing and the collider collision filter is used instead of the
+ * batch collision filter.
+ * 
+ * Hits are stored in a flat array grouped by query in the order of the queries. Inside
+ * each group hits are sorted by distance. Use GetQueryAt() to find the first hit and the
+ * number of hits of a query. Hit colliders and height terrains are not referenced and are
+ * valid only until the world is modified.
+ * 
+ * Ray queries call no scripting collider listeners. They use only the batch collision
+ * filter. If the cast collider has a scripting peer its CanHitCollider() is called for
+ * each hit collider on the calling thread. This matches ColliderMoveHits() using the
+ * collider as listener. Physics modules are allowed to support casting only certain
+ * collider types. Casting unsupported collider types finds no hits.
+ * 
+ * Physics modules are free to process queries in parallel. The world is not allowed to
+ * be modified while testing the batch.
+ */
+class deCollisionQueryBatch{
+public:
+	/** \brief Query. */
+	struct sQuery{
+		/** \brief Origin. */
+		decDVector origin;
+		
+		/** \brief Direction including distance. */
+		decVector direction;
+		
+		/** \brief Index of first hit. */
+		int firstHit;
+		
+		/** \brief Number of hits. */
+		int hitCount;
+	};
+	
+	/** \brief Hit. */
+	struct sHit{
+		/** \brief Index of query. */
+		int query;
+		
+		/** \brief Hit collider or NULL. */
+		deCollider *collider;
+		
+		/** \brief Hit collider bone or -1. */
+		int bone;
+		
+		/** \brief Hit collider shape or -1. */
+		int shape;
+		
+		/** \brief Hit collider face or -1. */
+		int face;
+		
+		/** \brief Hit height terrain or NULL. */
+		deHeightTerrain *heightTerrain;
+		
+		/** \brief Hit height terrain sector or NULL. */
+		deHeightTerrainSector *htsector;
+		
+		/** \brief Hit distance as fraction of query direction. */
+		float distance;
+		
+		/** \brief Hit normal. */
+		decVector normal;
+	};
+	
+	
+	
+private:
+	decCollisionFilter pCollisionFilter;
+	deColliderReference pCollider;
+	bool pClosestHitOnly;
+	
+	sQuery *pQueries;
+	int pQueryCount;
+	int pQuerySize;
+	
+	sHit *pHits;
+	int pHitCount;
+	int pHitSize;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create collision query batch. */
+	deCollisionQueryBatch();
+	
+	/** \brief Clean up collision query batch. */
+	~deCollisionQueryBatch();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Collision filter used if no collider is set. */
+	inline const decCollisionFilter &GetCollisionFilter() const{ return pCollisionFilter; }
+	
+	/** \brief Set collision filter used if no collider is set. */
+	void SetCollisionFilter( const decCollisionFilter &filter );
+	
+	/** \brief Collider to cast or NULL to cast rays. */
+	inline deCollider *GetCollider() const{ return pCollider; }
+	
+	/**
+	 * \brief Set collider to cast or NULL to cast rays.
+	 * 
+	 * Physics modules are allowed to support only certain collider types.
+	 */
+	void SetCollider( deCollider *collider );
+	
+	/** \brief Store only the closest hit of each query. */
+	inline bool GetClosestHitOnly() const{ return pClosestHitOnly; }
+	
+	/** \brief Set to store only the closest hit of each query. */
+	void SetClosestHitOnly( bool closestHitOnly );
+	/*@}*/
+	
+	
+	
+	/** \name Queries */
+	/*@{*/
+	/** \brief Number of queries. */
+	inline int GetQueryCount() const{ return pQueryCount; }
+	
+	/** \brief Query at index. */
+	const sQuery &GetQueryAt( int index ) const;
+	
+	/** \brief Queries. */
+	inline const sQuery *GetQueries() const{ return pQueries; }
+	
+	/** \brief Add query returning the index of the query. */
+	int AddQuery( const decDVector &origin, const decVector &direction );
+	
+	/** \brief Set query at index. */
+	void SetQueryAt( int index, const decDVector &origin, const decVector &direction );
+	
+	/** \brief Remove all queries and hits. */
+	void RemoveAllQueries();
+	/*@}*/
+	
+	
+	
+	/** \name Hits */
+	/*@{*/
+	/** \brief Number of hits. */
+	inline int GetHitCount() const{ return pHitCount; }
+	
+	/** \brief Hit at index. */
+	const sHit &GetHitAt( int index ) const;
+	
+	/** \brief Hits. */
+	inline const sHit *GetHits() const{ return pHits; }
+	
+	/**
+	 * \brief Add hit for use by physics modules.
+	 * 
+	 * Hits have to be added grouped by query in the order of the queries.
+	 */
+	void AddHit( const sHit &hit );
+	
+	/** \brief Remove all hits. */
+	void RemoveAllHits();
+	/*@}*/
+};
+
+#endif
@@ -28,6 +28,7 @@
 #include "deComponent.h"
 #include "deComponentBone.h"
 #include "deComponentManager.h"
+#include "deComponentSkinningJob.h"
 #include "deComponentTexture.h"
 #include "../animator/deAnimator.h"
 #include "../decal/deDecal.h"
@@ -51,6 +52,7 @@
 #include "../../logger/deLogger.h"
 #include "../../parallel/deParallelProcessing.h"
 #include "../../parallel/deParallelTask.h"
+#include "../../threading/deMutexGuard.h"
 #include "../../systems/deGraphicSystem.h"
 #include "../../systems/modules/animator/deBaseAnimatorComponent.h"
 #include "../../systems/modules/audio/deBaseAudioComponent.h"
@@ -59,6 +61,16 @@
 
 
 
+// Definitions
+////////////////
+
+// skinning is split into parallel tasks only for meshes with at least this many vertices.
+// smaller meshes are faster skinned on the calling thread than it takes to start tasks
+#define SKINNING_PARALLEL_MIN_VERTICES		8192
+#define SKINNING_CHUNK_SIZE					2048
+
+
+
 // Class deComponent
 //////////////////////
 
@@ -87,6 +99,18 @@ pDecalRoot( NULL ),
 pDecalTail( NULL ),
 pDecalCount( 0 ),
 
+pSkinModelRigMappings( NULL ),
+pSkinModelRigMappingCount( 0 ),
+pSkinBoneMatrices( NULL ),
+pSkinBoneMatrixCount( 0 ),
+pSkinWeights( NULL ),
+pSkinWeightCount( 0 ),
+pSkinVertices( NULL ),
+pSkinVertexCount( 0 ),
+pDirtySkinMappings( true ),
+pDirtySkinWeights( true ),
+pDirtySkinVertices( true ),
+
 pPeerGraphic( NULL ),
 pPeerPhysics( NULL ),
 pPeerAudio( NULL ),
@@ -494,6 +518,11 @@ void deComponent::ValidateBones(){
 }
 
 void deComponent::InvalidateMesh(){
+	pMutexSkinning.Lock();
+	pDirtySkinWeights = true;
+	pDirtySkinVertices = true;
+	pMutexSkinning.Unlock();
+	
 	if( pPeerGraphic ){
 		pPeerGraphic->MeshDirty();
 	}
@@ -715,6 +744,90 @@ void deComponent::WaitAnimatorTaskFinished(){
 
 
 
+// Skinning
+/////////////
+
+void deComponent::PrepareSkinnedWeights(){
+	// preparing bones can finish a pending animator task which invalidates the mesh.
+	// this locks the skinning mutex hence bones have to be prepared before locking
+	PrepareBones();
+	
+	const deMutexGuard guard( pMutexSkinning );
+	pPrepareSkinWeights();
+}
+
+bool deComponent::UseSharedSkinnedWeights( eSkinningRequester requester ){
+	// a pending animator task invalidates the mesh once finished
+	WaitAnimatorTaskFinished();
+	
+	const deMutexGuard guard( pMutexSkinning );
+	
+	if( pDirtySkinMappings || pDirtySkinWeights || pSkinWeightCount == 0 ){
+		return false;
+	}
+	
+	( ( deComponentManager* )GetResourceManager() )->AddSkinningStats( requester, false, 0 );
+	return true;
+}
+
+void deComponent::PrepareSkinnedVertices( eSkinningRequester requester ){
+	deComponentManager &manager = *( ( deComponentManager* )GetResourceManager() );
+	
+	PrepareBones(); // see PrepareSkinnedWeights
+	
+	const deMutexGuard guard( pMutexSkinning );
+	
+	pPrepareSkinWeights();
+	
+	if( ! pDirtySkinVertices ){
+		manager.AddSkinningStats( requester, false, pSkinVertexCount );
+		return;
+	}
+	
+	if( pSkinVertexCount > 0 ){
+		const deModelVertex * const vertices = pModel->GetLODAt( 0 )->GetVertices();
+		deParallelProcessing &parallel = GetEngine()->GetParallelProcessing();
+		
+		if( pSkinVertexCount >= SKINNING_PARALLEL_MIN_VERTICES
+		&& parallel.GetCoreCount() > 1 && ! parallel.GetPaused() ){
+			deComponentSkinningJob * const job = new deComponentSkinningJob(
+				vertices, pSkinWeights, pSkinVertices, pSkinVertexCount, SKINNING_CHUNK_SIZE );
+				
+			try{
+				job->Run( parallel, parallel.GetCoreCount() );
+				
+			}catch( const deException & ){
+				job->FreeReference();
+				throw;
+			}
+			
+			job->FreeReference();
+			
+		}else{
+			deComponentSkinningJob::SkinVertices( vertices, pSkinWeights, pSkinVertices, pSkinVertexCount );
+		}
+	}
+	
+	pDirtySkinVertices = false;
+	manager.AddSkinningStats( requester, true, pSkinVertexCount );
+}
+
+const decMatrix &deComponent::GetSkinnedWeightAt( int index ) const{
+	if( index < 0 || index >= pSkinWeightCount ){
+		DETHROW( deeInvalidParam );
+	}
+	return pSkinWeights[ index ];
+}
+
+const decVector &deComponent::GetSkinnedVertexAt( int index ) const{
+	if( index < 0 || index >= pSkinVertexCount ){
+		DETHROW( deeInvalidParam );
+	}
+	return pSkinVertices[ index ];
+}
+
+
+
 
 
 // Collision Detection
@@ -828,6 +941,8 @@ void deComponent::pCleanUp(){
 	
 	RemoveAllDecals();
 	
+	pFreeSkinArrays();
+	
 	if( pTextures ){
 		delete [] pTextures;
 	}
@@ -876,6 +991,12 @@ void deComponent::pChangeModel( deModel *model ){
 	pTextureCount = textureCount;
 	
 	pModel = model;
+	
+	pMutexSkinning.Lock();
+	pDirtySkinMappings = true;
+	pDirtySkinWeights = true;
+	pDirtySkinVertices = true;
+	pMutexSkinning.Unlock();
 }
 
 void deComponent::pChangeRig( deRig *rig ){
@@ -916,4 +1037,146 @@ void deComponent::pChangeRig( deRig *rig ){
 	pBoneCount = boneCount;
 	
 	pRig = rig;
+	
+	pMutexSkinning.Lock();
+	pDirtySkinMappings = true;
+	pDirtySkinWeights = true;
+	pDirtySkinVertices = true;
+	pMutexSkinning.Unlock();
+}
+
+void deComponent::pPrepareSkinMappings(){
+	if( ! pDirtySkinMappings ){
+		return;
+	}
+	
+	pFreeSkinArrays();
+	
+	if( pBoneCount > 0 ){
+		pSkinBoneMatrices = new decMatrix[ pBoneCount ];
+		pSkinBoneMatrixCount = pBoneCount;
+	}
+	
+	if( pModel ){
+		const deModelLOD &lod = *pModel->GetLODAt( 0 );
+		const int boneCount = pModel->GetBoneCount();
+		const int weightGroupCount = lod.GetWeightGroupCount();
+		const int * const weightGroups = lod.GetWeightGroups();
+		int i, weightCount = 0;
+		
+		if( boneCount > 0 ){
+			pSkinModelRigMappings = new int[ boneCount ];
+			for( pSkinModelRigMappingCount=0; pSkinModelRigMappingCount<boneCount; pSkinModelRigMappingCount++ ){
+				pSkinModelRigMappings[ pSkinModelRigMappingCount ] = pRig
+					? pRig->IndexOfBoneNamed( pModel->GetBoneAt( pSkinModelRigMappingCount )->GetName() ) : -1;
+			}
+		}
+		
+		for( i=0; i<weightGroupCount; i++ ){
+			weightCount += weightGroups[ i ];
+		}
+		if( weightCount > 0 ){
+			pSkinWeights = new decMatrix[ weightCount ];
+			pSkinWeightCount = weightCount;
+		}
+		
+		if( lod.GetVertexCount() > 0 ){
+			pSkinVertices = new decVector[ lod.GetVertexCount() ];
+			pSkinVertexCount = lod.GetVertexCount();
+		}
+	}
+	
+	pDirtySkinMappings = false;
+	pDirtySkinWeights = true;
+	pDirtySkinVertices = true;
+}
+
+void deComponent::pPrepareSkinWeights(){
+	pPrepareSkinMappings();
+	
+	if( ! pDirtySkinWeights ){
+		return;
+	}
+	
+	if( pSkinWeightCount == 0 ){
+		pDirtySkinWeights = false;
+		return;
+	}
+	
+	// bone weight matrices transform from rig space to the animated bone space. bones
+	// have been prepared by the caller before locking the skinning mutex
+	int i;
+	
+	if( pSkinBoneMatrixCount > 0 ){
+		for( i=0; i<pSkinBoneMatrixCount; i++ ){
+			pSkinBoneMatrices[ i ] = pRig->GetBoneAt( i ).GetInverseMatrix().QuickMultiply( pBones[ i ].GetMatrix() );
+		}
+	}
+	
+	// weight sets are grouped by the number of weights they use. the first group contains
+	// weight sets with one weight, the second group weight sets with two weights and so on
+	const deModelLOD &lod = *pModel->GetLODAt( 0 );
+	const int weightGroupCount = lod.GetWeightGroupCount();
+	const int * const weightGroups = lod.GetWeightGroups();
+	const deModelWeight *weight = lod.GetWeights();
+	decMatrix *skinWeight = pSkinWeights;
+	int j, k;
+	
+	for( i=0; i<weightGroupCount; i++ ){
+		const int weightSetCount = weightGroups[ i ];
+		const int weightsPerSet = i + 1;
+		
+		for( j=0; j<weightSetCount; j++ ){
+			for( k=0; k<weightsPerSet; k++, weight++ ){
+				const int bone = pSkinModelRigMappings[ weight->GetBone() ];
+				const float factor = weight->GetWeight();
+				
+				if( k == 0 ){
+					if( bone == -1 ){
+						skinWeight->SetScale( factor, factor, factor );
+						
+					}else{
+						*skinWeight = pSkinBoneMatrices[ bone ].QuickMultiply( factor );
+					}
+					
+				}else{
+					if( bone == -1 ){
+						skinWeight->a11 += factor;
+						skinWeight->a22 += factor;
+						skinWeight->a33 += factor;
+						
+					}else{
+						skinWeight->QuickAddTo( pSkinBoneMatrices[ bone ].QuickMultiply( factor ) );
+					}
+				}
+			}
+			
+			skinWeight++;
+		}
+	}
+	
+	pDirtySkinWeights = false;
+}
+
+void deComponent::pFreeSkinArrays(){
+	if( pSkinVertices ){
+		delete [] pSkinVertices;
+		pSkinVertices = NULL;
+		pSkinVertexCount = 0;
+	}
+	if( pSkinWeights ){
+		delete [] pSkinWeights;
+		pSkinWeights = NULL;
+		pSkinWeightCount = 0;
+	}
+	if( pSkinBoneMatrices ){
+		delete [] pSkinBoneMatrices;
+		pSkinBoneMatrices = NULL;
+		pSkinBoneMatrixCount = 0;
+	}
+	if( pSkinModelRigMappings ){
+		delete [] pSkinModelRigMappings;
+		pSkinModelRigMappings = NULL;
+		pSkinModelRigMappingCount = 0;
+	}
 }
@@ -34,6 +34,7 @@
 #include "../../common/math/decMath.h"
 #include "../../common/utils/decLayerMask.h"
 #include "../../common/string/decString.h"
+#include "../../threading/deMutex.h"
 
 
 class deBaseAnimatorComponent;
@@ -70,6 +71,21 @@ public:
 		emhDynamic
 	};
 	
+	/** \brief Skinning requesters used for statistics. */
+	enum eSkinningRequester{
+		/** \brief Graphic module. */
+		esrGraphic,
+		
+		/** \brief Physics module. */
+		esrPhysics,
+		
+		/** \brief Audio module. */
+		esrAudio,
+		
+		/** \brief Other modules. */
+		esrOther
+	};
+	
 	
 	
 private:
@@ -106,6 +122,19 @@ private:
 	deDecal *pDecalTail;
 	int pDecalCount;
 	
+	int *pSkinModelRigMappings;
+	int pSkinModelRigMappingCount;
+	decMatrix *pSkinBoneMatrices;
+	int pSkinBoneMatrixCount;
+	decMatrix *pSkinWeights;
+	int pSkinWeightCount;
+	decVector *pSkinVertices;
+	int pSkinVertexCount;
+	bool pDirtySkinMappings;
+	bool pDirtySkinWeights;
+	bool pDirtySkinVertices;
+	deMutex pMutexSkinning;
+	
 	deParallelTaskReference pAnimatorTask;
 	
 	deBaseGraphicComponent *pPeerGraphic;
@@ -325,6 +354,68 @@ public:
 	
 	
 	
+	/**
+	 * \name Skinning
+	 * 
+	 * Skinned weight matrices and vertex positions of the first model LOD shared by
+	 * modules working on the main thread. Data is calculated lazily the first time it is
+	 * requested after bones or mesh have been invalidated. Later requests reuse the result.
+	 * Large meshes are skinned using parallel tasks. Skinned data is in component space.
+	 * 
+	 * Bones are prepared before the skinning data is locked since waiting for a pending
+	 * animator task can invalidate the mesh. Modules skinning on their own threads like
+	 * the graphic and audio modules can not access this data from these threads. They
+	 * use UseSharedSkinnedWeights() while synchronizing to copy the weights if another
+	 * module skinned the component already.
+	 */
+	/*@{*/
+	/**
+	 * \brief Prepare skinned weight matrices.
+	 * 
+	 * One weight matrix is calculated for each weight set of the first model LOD.
+	 */
+	void PrepareSkinnedWeights();
+	
+	/**
+	 * \brief Prepare skinned vertex positions.
+	 * 
+	 * Prepares skinned weights if required. Each call is counted in the component
+	 * manager skinning statistics for \em requester.
+	 */
+	void PrepareSkinnedVertices( eSkinningRequester requester );
+	
+	/**
+	 * \brief Skinned weight matrices are prepared and up to date.
+	 * 
+	 * Does not calculate the weights. Returns true if another module prepared them since
+	 * the bones or mesh changed last time. In this case the request is counted as shared
+	 * in the component manager skinning statistics for \em requester.
+	 * 
+	 * \warning Call only from the main thread.
+	 */
+	bool UseSharedSkinnedWeights( eSkinningRequester requester );
+	
+	/** \brief Number of skinned weight matrices. */
+	inline int GetSkinnedWeightCount() const{ return pSkinWeightCount; }
+	
+	/** \brief Skinned weight matrices. Valid after PrepareSkinnedWeights(). */
+	inline const decMatrix *GetSkinnedWeights() const{ return pSkinWeights; }
+	
+	/** \brief Skinned weight matrix at index. Valid after PrepareSkinnedWeights(). */
+	const decMatrix &GetSkinnedWeightAt( int index ) const;
+	
+	/** \brief Number of skinned vertices. */
+	inline int GetSkinnedVertexCount() const{ return pSkinVertexCount; }
+	
+	/** \brief Skinned vertex positions. Valid after PrepareSkinnedVertices(). */
+	inline const decVector *GetSkinnedVertices() const{ return pSkinVertices; }
+	
+	/** \brief Skinned vertex position at index. Valid after PrepareSkinnedVertices(). */
+	const decVector &GetSkinnedVertexAt( int index ) const;
+	/*@}*/
+	
+	
+	
 	/** \name Textures */
 	/*@{*/
 	/** \brief Number of textures. */
@@ -453,6 +544,9 @@ private:
 	void pUpdateBoneAt( int bone );
 	void pChangeModel( deModel *model );
 	void pChangeRig( deRig *rig );
+	void pPrepareSkinMappings();
+	void pPrepareSkinWeights();
+	void pFreeSkinArrays();
 };
 
 #endif
@@ -35,6 +35,7 @@
 #include "../../systems/deScriptingSystem.h"
 #include "../../deEngine.h"
 #include "../../common/exceptions.h"
+#include "../../threading/deMutexGuard.h"
 
 
 // Class deComponentManager
@@ -45,6 +46,9 @@
 
 deComponentManager::deComponentManager( deEngine *engine ) : deResourceManager( engine, ertComponent ){
 	SetLoggingName( "component" );
+	
+	memset( pSkinningStats, 0, sizeof( pSkinningStats ) );
+	memset( pLastSkinningStats, 0, sizeof( pLastSkinningStats ) );
 }
 
 deComponentManager::~deComponentManager(){
@@ -98,6 +102,26 @@ void deComponentManager::ReleaseLeakingResources(){
 
 
 
+// Skinning Statistics
+////////////////////////
+
+deComponentManager::sSkinningStats deComponentManager::GetSkinningStats(
+deComponent::eSkinningRequester requester ) const{
+	if( requester < deComponent::esrGraphic || requester > deComponent::esrOther ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	return pLastSkinningStats[ requester ];
+}
+
+void deComponentManager::NextSkinningStatsFrame(){
+	const deMutexGuard guard( pMutexSkinningStats );
+	memcpy( pLastSkinningStats, pSkinningStats, sizeof( pSkinningStats ) );
+	memset( pSkinningStats, 0, sizeof( pSkinningStats ) );
+}
+
+
+
 // Systems Support
 ////////////////////
 
@@ -191,3 +215,21 @@ void deComponentManager::SystemAnimatorUnload(){
 void deComponentManager::RemoveResource( deResource *resource ){
 	pComponents.RemoveIfPresent( resource );
 }
+
+void deComponentManager::AddSkinningStats( deComponent::eSkinningRequester requester,
+bool skinned, int vertexCount ){
+	if( requester < deComponent::esrGraphic || requester > deComponent::esrOther ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	const deMutexGuard guard( pMutexSkinningStats );
+	sSkinningStats &stats = pSkinningStats[ requester ];
+	
+	if( skinned ){
+		stats.skinnedComponents++;
+		stats.skinnedVertices += vertexCount;
+		
+	}else{
+		stats.sharedComponents++;
+	}
+}
@@ -22,8 +22,10 @@
 #ifndef _DECOMPONENTMANAGER_H_
 #define _DECOMPONENTMANAGER_H_ 
 
+#include "deComponent.h"
 #include "../deResourceManager.h"
 #include "../deResourceList.h"
+#include "../../threading/deMutex.h"
 
 class deEngine;
 class deComponent;
@@ -35,9 +37,28 @@ class deSkin;
  * \brief Scene Component Resource Manager.
  */
 class deComponentManager : public deResourceManager{
+public:
+	/** \brief Skinning statistics of one requester. */
+	struct sSkinningStats{
+		/** \brief Number of components skinned. */
+		int skinnedComponents;
+		
+		/** \brief Number of vertices skinned. */
+		int skinnedVertices;
+		
+		/** \brief Number of requests reusing already skinned vertices or weights. */
+		int sharedComponents;
+	};
+	
+	
+	
 private:
 	deResourceList pComponents;
 	
+	deMutex pMutexSkinningStats;
+	sSkinningStats pSkinningStats[ deComponent::esrOther + 1 ];
+	sSkinningStats pLastSkinningStats[ deComponent::esrOther + 1 ];
+	
 	
 	
 public:
@@ -69,6 +90,25 @@ public:
 	
 	
 	
+	/** \name Skinning Statistics */
+	/*@{*/
+	/**
+	 * \brief Skinning statistics of the last frame for requester.
+	 * \warning Call only from the main thread.
+	 */
+	sSkinningStats GetSkinningStats( deComponent::eSkinningRequester requester ) const;
+	
+	/**
+	 * \brief Start next skinning statistics frame.
+	 * 
+	 * Statistics collected so far become the last frame statistics. Called by the
+	 * engine in the main thread once per frame.
+	 */
+	void NextSkinningStatsFrame();
+	/*@}*/
+	
+	
+	
 	/** \name System Peer Management */
 	/*@{*/
 	void SystemGraphicLoad();
@@ -94,6 +134,9 @@ public:
 	 */
 	/*@{*/
 	void RemoveResource( deResource *resource );
+	
+	/** \brief Add skinning statistics. */
+	void AddSkinningStats( deComponent::eSkinningRequester requester, bool skinned, int vertexCount );
 	/*@}*/
 };
 
@@ -0,0 +1,146 @@
+/* 
+ * Drag[en]gine Game Engine
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "deComponentSkinningJob.h"
+#include "deComponentSkinningTask.h"
+#include "../model/deModelVertex.h"
+#include "../../common/exceptions.h"
+#include "../../parallel/deParallelProcessing.h"
+
+
+
+// Class deComponentSkinningJob
+/////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+deComponentSkinningJob::deComponentSkinningJob( const deModelVertex *vertices,
+const decMatrix *weights, decVector *positions, int vertexCount, int chunkSize ) :
+pVertices( vertices ),
+pWeights( weights ),
+pPositions( positions ),
+pVertexCount( decMath::max( vertexCount, 0 ) ),
+pChunkSize( decMath::max( chunkSize, 1 ) ),
+pChunkCount( ( pVertexCount + pChunkSize - 1 ) / pChunkSize ),
+pNextChunk( 0 ),
+pActiveCount( 0 ),
+pWaiting( false )
+{
+	if( pVertexCount > 0 && ( ! vertices || ! positions ) ){
+		DETHROW( deeInvalidParam );
+	}
+}
+
+deComponentSkinningJob::~deComponentSkinningJob(){
+}
+
+
+
+// Management
+///////////////
+
+void deComponentSkinningJob::Run( deParallelProcessing &parallel, int taskCount ){
+	taskCount = decMath::clamp( taskCount, 0, pChunkCount - 1 );
+	
+	pNextChunk = 0;
+	pActiveCount = 0;
+	pWaiting = false;
+	
+	int i;
+	
+	try{
+		for( i=0; i<taskCount; i++ ){
+			deComponentSkinningTask * const task = new deComponentSkinningTask( *this );
+			parallel.AddTaskAsync( task );
+			task->FreeReference();
+		}
+		
+	}catch( const deException & ){
+		// tasks added so far can be running already. finish the work before failing
+		ProcessChunks();
+		pWaitActiveChunks();
+		throw;
+	}
+	
+	ProcessChunks();
+	pWaitActiveChunks();
+}
+
+void deComponentSkinningJob::ProcessChunks(){
+	while( true ){
+		pMutex.Lock();
+		if( pNextChunk == pChunkCount ){
+			pMutex.Unlock();
+			return;
+		}
+		const int chunk = pNextChunk++;
+		pActiveCount++;
+		pMutex.Unlock();
+		
+		const int first = pChunkSize * chunk;
+		SkinVertices( pVertices + first, pWeights, pPositions + first,
+			decMath::min( pChunkSize, pVertexCount - first ) );
+		
+		pMutex.Lock();
+		pActiveCount--;
+		if( pActiveCount == 0 && pWaiting ){
+			pWaiting = false;
+			pSemaphore.Signal();
+		}
+		pMutex.Unlock();
+	}
+}
+
+void deComponentSkinningJob::SkinVertices( const deModelVertex *vertices,
+const decMatrix *weights, decVector *positions, int count ){
+	int i;
+	
+	for( i=0; i<count; i++ ){
+		const int weightSet = vertices[ i ].GetWeightSet();
+		
+		if( weightSet == -1 ){
+			positions[ i ] = vertices[ i ].GetPosition();
+			
+		}else{
+			positions[ i ] = weights[ weightSet ] * vertices[ i ].GetPosition();
+		}
+	}
+}
+
+
+
+// Private Functions
+//////////////////////
+
+void deComponentSkinningJob::pWaitActiveChunks(){
+	pMutex.Lock();
+	const bool wait = pActiveCount > 0;
+	pWaiting = wait;
+	pMutex.Unlock();
+	
+	if( wait ){
+		pSemaphore.Wait();
+	}
+}
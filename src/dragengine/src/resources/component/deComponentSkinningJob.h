@@ -0,0 +1,112 @@
+/* 
+ * Drag[en]gine Game Engine
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DECOMPONENTSKINNINGJOB_H_
+#define _DECOMPONENTSKINNINGJOB_H_
+
+#include "../../common/math/decMath.h"
+#include "../../threading/deMutex.h"
+#include "../../threading/deSemaphore.h"
+#include "../../threading/deThreadSafeObject.h"
+
+class deModelVertex;
+class deParallelProcessing;
+
+
+/**
+ * \brief Transform model vertices by weight matrices in parallel.
+ * 
+ * Vertices are split into chunks processed by parallel tasks. The calling thread processes
+ * chunks too and waits only for chunks started by parallel tasks to finish. This avoids
+ * blocking if all other threads are busy. Tasks starting after all chunks have been taken
+ * exit without touching the vertex data. Used by deComponent::PrepareSkinnedVertices().
+ */
+class deComponentSkinningJob : public deThreadSafeObject{
+private:
+	const deModelVertex * const pVertices;
+	const decMatrix * const pWeights;
+	decVector * const pPositions;
+	const int pVertexCount;
+	const int pChunkSize;
+	const int pChunkCount;
+	
+	deMutex pMutex;
+	deSemaphore pSemaphore;
+	int pNextChunk;
+	int pActiveCount;
+	bool pWaiting;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create job. */
+	deComponentSkinningJob( const deModelVertex *vertices, const decMatrix *weights,
+		decVector *positions, int vertexCount, int chunkSize );
+		
+protected:
+	/** \brief Clean up job. */
+	virtual ~deComponentSkinningJob();
+	/*@}*/
+	
+	
+	
+public:
+	/** \name Management */
+	/*@{*/
+	/** \brief Number of vertices. */
+	inline int GetVertexCount() const{ return pVertexCount; }
+	
+	/** \brief Number of chunks. */
+	inline int GetChunkCount() const{ return pChunkCount; }
+	
+	/**
+	 * \brief Transform all vertices.
+	 * 
+	 * Adds up to \em taskCount parallel tasks and processes chunks on the calling thread
+	 * until all chunks are done.
+	 */
+	void Run( deParallelProcessing &parallel, int taskCount );
+	
+	/**
+	 * \brief Process chunks until no chunks are left.
+	 * 
+	 * For use by parallel tasks only.
+	 */
+	void ProcessChunks();
+	
+	/**
+	 * \brief Transform vertices.
+	 * 
+	 * Vertices without weight set are copied unchanged.
+	 */
+	static void SkinVertices( const deModelVertex *vertices, const decMatrix *weights,
+		decVector *positions, int count );
+	/*@}*/
+	
+	
+	
+private:
+	void pWaitActiveChunks();
+};
+
+#endif
@@ -0,0 +1,73 @@
+/* 
+ * Drag[en]gine Game Engine
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "deComponentSkinningJob.h"
+#include "deComponentSkinningTask.h"
+#include "../../common/exceptions.h"
+
+
+
+// Class deComponentSkinningTask
+//////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+deComponentSkinningTask::deComponentSkinningTask( deComponentSkinningJob &job ) :
+deParallelTask( NULL ),
+pJob( &job )
+{
+	job.AddReference();
+}
+
+deComponentSkinningTask::~deComponentSkinningTask(){
+	pJob->FreeReference();
+}
+
+
+
+// Management
+///////////////
+
+void deComponentSkinningTask::Run(){
+	pJob->ProcessChunks();
+}
+
+void deComponentSkinningTask::Finished(){
+}
+
+
+
+// Debugging
+//////////////
+
+decString deComponentSkinningTask::GetDebugName() const{
+	return "ComponentSkinning";
+}
+
+decString deComponentSkinningTask::GetDebugDetails() const{
+	decString details;
+	details.Format( "vertices=%d chunks=%d", pJob->GetVertexCount(), pJob->GetChunkCount() );
+	return details;
+}
@@ -153,6 +153,13 @@ void deTouchSensor::NotifyColliderLeft( deCollider *collider ){
 	}
 }
 
+void deTouchSensor::NotifyCollidersChanged( const decObjectList &enteredColliders,
+const decObjectList &leftColliders ){
+	if( pPeerScripting ){
+		pPeerScripting->CollidersChanged( enteredColliders, leftColliders );
+	}
+}
+
 
 
 bool deTouchSensor::IsEmpty() const{
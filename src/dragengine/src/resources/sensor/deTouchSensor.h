@@ -35,6 +35,7 @@ class deBaseScriptingCollider;
 class decShape;
 class deWorld;
 class deCollider;
+class decObjectList;
 
 
 /**
@@ -164,6 +165,14 @@ public:
 	 * \param collider Collider entering the shape.
 	 */
 	void NotifyColliderLeft( deCollider *collider );
+	
+	/**
+	 * \brief Notify scripting module peer colliders entered and left touch sensor.
+	 * \param enteredColliders List of deCollider entering the shape.
+	 * \param leftColliders List of deCollider leaving the shape.
+	 */
+	void NotifyCollidersChanged( const decObjectList &enteredColliders,
+		const decObjectList &leftColliders );
 	/*@}*/
 	
 	
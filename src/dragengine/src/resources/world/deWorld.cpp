@@ -28,6 +28,7 @@
 #include "../billboard/deBillboard.h"
 #include "../camera/deCamera.h"
 #include "../collider/deCollider.h"
+#include "../collider/deCollisionQueryBatch.h"
 #include "../component/deComponent.h"
 #include "../debug/deDebugDrawer.h"
 #include "../forcefield/deForceField.h"
@@ -1754,6 +1755,14 @@ const decVector &rotation, deBaseScriptingCollider *listener ){
 	}
 }
 
+void deWorld::CollisionQueryBatch( deCollisionQueryBatch &batch ){
+	batch.RemoveAllHits();
+	
+	if( pPeerPhysics ){
+		pPeerPhysics->CollisionQueryBatch( batch );
+	}
+}
+
 
 
 // Speakers
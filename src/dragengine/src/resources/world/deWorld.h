@@ -26,6 +26,7 @@
 #include "../../common/math/decMath.h"
 
 class decCollisionFilter;
+class deCollisionQueryBatch;
 class deBaseScriptingCollider;
 class deWorldManager;
 
@@ -897,6 +898,17 @@ public:
 	 */
 	void ColliderMoveRotateHits( deCollider *collider, const decVector &displacement,
 	const decVector &rotation, deBaseScriptingCollider *listener );
+	
+	/**
+	 * \brief Test batch of collision queries.
+	 * 
+	 * Removes all hits from the batch then tests all queries storing the found hits in the
+	 * batch. If the batch casts a collider with a scripting peer CanHitCollider() of the
+	 * peer is called for each hit on the calling thread. Ray queries call no listeners.
+	 * Use this instead of RayHits or ColliderMoveHits if many queries have to be done at
+	 * the same time.
+	 */
+	void CollisionQueryBatch( deCollisionQueryBatch &batch );
 	/*@}*/
 	
 	
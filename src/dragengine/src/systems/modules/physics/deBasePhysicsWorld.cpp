@@ -166,3 +166,6 @@ deBaseScriptingCollider *listener ){
 void deBasePhysicsWorld::ColliderMoveRotateHits( deCollider *collider, const decVector &displacement,
 const decVector &rotation, deBaseScriptingCollider *listener ){
 }
+
+void deBasePhysicsWorld::CollisionQueryBatch( deCollisionQueryBatch &batch ){
+}
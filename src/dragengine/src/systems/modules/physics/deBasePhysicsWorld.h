@@ -28,6 +28,7 @@ class decCollisionFilter;
 class decCollisionVolume;
 class decCollisionSphere;
 class deCollisionInfo;
+class deCollisionQueryBatch;
 class deCollider;
 class deBaseScriptingCollider;
 class deComponent;
@@ -211,6 +212,16 @@ public:
 	 */
 	virtual void ColliderMoveRotateHits( deCollider *collider, const decVector &displacement,
 		const decVector &rotation, deBaseScriptingCollider *listener );
+		
+	/**
+	 * \brief Test batch of collision queries.
+	 * 
+	 * Removes all hits from the batch then tests all queries storing the found hits in the
+	 * batch. Queries can be processed in parallel. If the batch casts a collider with a
+	 * scripting peer CanHitCollider() of the peer has to be called for each hit. Scripting
+	 * peers are not thread safe. Call them only on the calling thread after testing.
+	 */
+	virtual void CollisionQueryBatch( deCollisionQueryBatch &batch );
 	/*@}*/
 	
 };
@@ -20,6 +20,8 @@
  */
 
 #include "deBaseScriptingTouchSensor.h"
+#include "../../../common/collection/decObjectList.h"
+#include "../../../resources/collider/deCollider.h"
 
 
 
@@ -45,3 +47,17 @@ void deBaseScriptingTouchSensor::ColliderEntered( deCollider *collider ){
 
 void deBaseScriptingTouchSensor::ColliderLeft( deCollider *collider ){
 }
+
+void deBaseScriptingTouchSensor::CollidersChanged( const decObjectList &enteredColliders,
+const decObjectList &leftColliders ){
+	const int enteredCount = enteredColliders.GetCount();
+	const int leftCount = leftColliders.GetCount();
+	int i;
+	
+	for( i=0; i<enteredCount; i++ ){
+		ColliderEntered( ( deCollider* )enteredColliders.GetAt( i ) );
+	}
+	for( i=0; i<leftCount; i++ ){
+		ColliderLeft( ( deCollider* )leftColliders.GetAt( i ) );
+	}
+}
@@ -23,6 +23,7 @@
 #define _DEBASESCRIPTINGTOUCHSENSOR_H_
 
 class deCollider;
+class decObjectList;
 
 
 /**
@@ -54,6 +55,20 @@ public:
 	 * \param collider Collider entering the shape.
 	 */
 	virtual void ColliderLeft( deCollider *collider );
+	
+	/**
+	 * \brief Notify scripting module peer colliders entered and left touch sensor.
+	 * 
+	 * Called by physics modules reporting all changes of a simulation step at once. The
+	 * default implementation calls ColliderEntered() for each entered collider followed
+	 * by ColliderLeft() for each left collider. Scripting modules can overwrite this
+	 * method to process the changes without the overhead of individual calls.
+	 * 
+	 * \param enteredColliders List of deCollider entering the shape.
+	 * \param leftColliders List of deCollider leaving the shape.
+	 */
+	virtual void CollidersChanged( const decObjectList &enteredColliders,
+		const decObjectList &leftColliders );
 	/*@}*/
 };
 
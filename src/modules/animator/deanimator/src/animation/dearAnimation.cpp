@@ -129,8 +129,9 @@ void dearAnimation::pCreateMoves(){
 	
 	pMoves.RemoveAll();
 	
+	const bool compress = pModule->GetCompressAnimations();
 	int i;
 	for( i=0; i<count; i++ ){
-		pMoves.Add( new dearAnimationMove( *pAnimation->GetMove( i ) ) );
+		pMoves.Add( new dearAnimationMove( *pAnimation->GetMove( i ), compress ) );
 	}
 }
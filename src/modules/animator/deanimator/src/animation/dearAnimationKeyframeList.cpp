@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <math.h>
 
 #include "dearAnimationKeyframeList.h"
 #include "dearAnimationKeyframe.h"
@@ -29,22 +30,93 @@
 #include <dragengine/deEngine.h>
 #include <dragengine/common/exceptions.h>
 #include <dragengine/resources/animation/deAnimationMove.h>
+#include <dragengine/resources/animation/deAnimationKeyframe.h>
 #include <dragengine/resources/animation/deAnimationKeyframeList.h>
 
 
 
+// Definitions
+////////////////
+
+// maximum error of keyframes dropped from compressed lists
+#define POSITION_TOLERANCE 0.0005f
+#define ROTATION_TOLERANCE 0.0005f
+#define SCALING_TOLERANCE 0.0005f
+
+struct sSourceKeyframe{
+	float time;
+	decVector position;
+	decQuaternion rotation;
+	decVector scaling;
+	bool keep;
+};
+
+static bool fCanDropKeyframes( const sSourceKeyframe *keyframes, int first, int last ){
+	const sSourceKeyframe &keyframe1 = keyframes[ first ];
+	const sSourceKeyframe &keyframe2 = keyframes[ last ];
+	if( keyframe2.time <= keyframe1.time ){
+		return false;
+	}
+	
+	const float timeStep = 1.0f / ( keyframe2.time - keyframe1.time );
+	int i;
+	
+	for( i=first+1; i<last; i++ ){
+		const sSourceKeyframe &keyframe = keyframes[ i ];
+		if( keyframe.time <= keyframe1.time || keyframe.time >= keyframe2.time ){
+			return false;
+		}
+		
+		const float factor = ( keyframe.time - keyframe1.time ) * timeStep;
+		
+		if( ! ( keyframe1.position + ( keyframe2.position - keyframe1.position ) * factor )
+				.IsEqualTo( keyframe.position, POSITION_TOLERANCE )
+		|| ! ( keyframe1.rotation + ( keyframe2.rotation - keyframe1.rotation ) * factor )
+				.IsEqualTo( keyframe.rotation, ROTATION_TOLERANCE )
+		|| ! ( keyframe1.scaling + ( keyframe2.scaling - keyframe1.scaling ) * factor )
+				.IsEqualTo( keyframe.scaling, SCALING_TOLERANCE ) ){
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+static unsigned short fQuantize( float value, float minimum, float quantize ){
+	if( quantize == 0.0f ){
+		return 0;
+	}
+	return ( unsigned short )decMath::clamp( ( int )( ( value - minimum ) / quantize + 0.5f ), 0, 65535 );
+}
+
+static short fQuantizeRotation( float value ){
+	return ( short )decMath::clamp( ( int )floorf( value * 32767.0f + 0.5f ), -32767, 32767 );
+}
+
+
+
+
+
+
 // Class dearAnimationKeyframeList
 ////////////////////////////
 
 // Constructors and Destructors
 /////////////////////////////////
 
-dearAnimationKeyframeList::dearAnimationKeyframeList( const deAnimationKeyframeList &list ){
-	pKeyframes = NULL;
-	pKeyframeCount = 0;
-	
+dearAnimationKeyframeList::dearAnimationKeyframeList( const deAnimationKeyframeList &list, bool compress ) :
+pTimes( NULL ),
+pKeyframes( NULL ),
+pCompressedKeyframes( NULL ),
+pKeyframeCount( 0 )
+{
 	try{
-		pCreateKeyframes( list );
+		if( compress ){
+			pCreateCompressedKeyframes( list );
+			
+		}else{
+			pCreateKeyframes( list );
+		}
 		
 	}catch( const deException & ){
 		pCleanUp();
@@ -62,29 +134,108 @@ dearAnimationKeyframeList::~dearAnimationKeyframeList(){
 ///////////////
 
 dearAnimationKeyframe &dearAnimationKeyframeList::GetAt( int index ) const{
+	if( GetCompressed() ){
+		DETHROW( deeInvalidAction );
+	}
 	if( index < 0 || index >= pKeyframeCount ){
 		DETHROW( deeInvalidParam );
 	}
 	return pKeyframes[ index ];
 }
 
-dearAnimationKeyframe *dearAnimationKeyframeList::GetWithTime( float time ) const{
+int dearAnimationKeyframeList::IndexWithTime( float time, int cursor ) const{
 	if( pKeyframeCount == 0 ){
-		return NULL;
+		return -1;
 	}
 	
-	if( time <= pKeyframes[ 0 ].GetTime() ){
-		return pKeyframes;
+	// animations are usually played forward. check the last keyframe and the one following
+	const int last = pKeyframeCount - 1;
+	
+	if( cursor >= 0 && cursor < last && time >= pTimes[ cursor ] ){
+		if( time < pTimes[ cursor + 1 ] ){
+			return cursor;
+		}
+		if( cursor + 1 == last || time < pTimes[ cursor + 2 ] ){
+			return cursor + 1;
+		}
 	}
 	
-	int i;
-	for( i=1; i<pKeyframeCount; i++ ){
-		if( time < pKeyframes[ i ].GetTime() ){
-			return pKeyframes + ( i - 1 );
+	if( time <= pTimes[ 0 ] ){
+		return 0;
+	}
+	if( time >= pTimes[ last ] ){
+		return last;
+	}
+	
+	// binary search for the last keyframe with time less than or equal to the time
+	int lower = 0;
+	int upper = last;
+	
+	while( upper - lower > 1 ){
+		const int middle = ( lower + upper ) / 2;
+		if( time < pTimes[ middle ] ){
+			upper = middle;
+			
+		}else{
+			lower = middle;
 		}
 	}
 	
-	return pKeyframes + ( pKeyframeCount - 1 );
+	return lower;
+}
+
+bool dearAnimationKeyframeList::Interpolate( float time, int &cursor, decVector &position,
+decQuaternion &rotation, decVector &scaling ) const{
+	cursor = IndexWithTime( time, cursor );
+	if( cursor == -1 ){
+		return false;
+	}
+	
+	const float keyframeTime = time - pTimes[ cursor ];
+	
+	if( pKeyframes ){
+		const dearAnimationKeyframe &keyframe = pKeyframes[ cursor ];
+		position = keyframe.InterpolatePosition( keyframeTime );
+		rotation = keyframe.InterpolateRotation( keyframeTime );
+		scaling = keyframe.InterpolateScaling( keyframeTime );
+		return true;
+	}
+	
+	const sCompressedKeyframe &keyframe = pCompressedKeyframes[ cursor ];
+	pDecompress( keyframe, position, rotation, scaling );
+	
+	if( keyframe.timeStep != 0.0f ){
+		const float factor = keyframeTime * keyframe.timeStep;
+		decVector nextPosition, nextScaling;
+		decQuaternion nextRotation;
+		
+		pDecompress( pCompressedKeyframes[ cursor + 1 ], nextPosition, nextRotation, nextScaling );
+		
+		position += ( nextPosition - position ) * factor;
+		rotation += ( nextRotation - rotation ) * factor;
+		scaling += ( nextScaling - scaling ) * factor;
+	}
+	
+	return true;
+}
+
+bool dearAnimationKeyframeList::Interpolate( float time, decVector &position,
+decQuaternion &rotation, decVector &scaling ) const{
+	int cursor = -1;
+	return Interpolate( time, cursor, position, rotation, scaling );
+}
+
+int dearAnimationKeyframeList::GetMemoryConsumption() const{
+	int consumption = sizeof( dearAnimationKeyframeList ) + sizeof( float ) * pKeyframeCount;
+	
+	if( pKeyframes ){
+		consumption += sizeof( dearAnimationKeyframe ) * pKeyframeCount;
+		
+	}else{
+		consumption += sizeof( sCompressedKeyframe ) * pKeyframeCount;
+	}
+	
+	return consumption;
 }
 
 
@@ -93,9 +244,15 @@ dearAnimationKeyframe *dearAnimationKeyframeList::GetWithTime( float time ) cons
 //////////////////////
 
 void dearAnimationKeyframeList::pCleanUp(){
+	if( pCompressedKeyframes ){
+		delete [] pCompressedKeyframes;
+	}
 	if( pKeyframes ){
 		delete [] pKeyframes;
 	}
+	if( pTimes ){
+		delete [] pTimes;
+	}
 }
 
 
@@ -106,6 +263,7 @@ void dearAnimationKeyframeList::pCreateKeyframes( const deAnimationKeyframeList
 		return;
 	}
 	
+	pTimes = new float[ count ];
 	pKeyframes = new dearAnimationKeyframe[ count ];
 	bool negate = false;
 	
@@ -118,6 +276,130 @@ void dearAnimationKeyframeList::pCreateKeyframes( const deAnimationKeyframeList
 			pKeyframes[ pKeyframeCount ].Set( *list.GetKeyframe( pKeyframeCount ), negate );
 		}
 		
+		pTimes[ pKeyframeCount ] = pKeyframes[ pKeyframeCount ].GetTime();
 		pKeyframeCount++;
 	}
 }
+
+void dearAnimationKeyframeList::pCreateCompressedKeyframes( const deAnimationKeyframeList &list ){
+	const int count = list.GetKeyframeCount();
+	if( count == 0 ){
+		return;
+	}
+	
+	sSourceKeyframe * const source = new sSourceKeyframe[ count ];
+	int i, j;
+	
+	try{
+		// convert keyframes. rotations are negated where required to interpolate the short
+		// way like dearAnimationKeyframe does
+		for( i=0; i<count; i++ ){
+			const deAnimationKeyframe &keyframe = *list.GetKeyframe( i );
+			source[ i ].time = keyframe.GetTime();
+			source[ i ].position = keyframe.GetPosition();
+			source[ i ].rotation.SetFromEuler( keyframe.GetRotation() );
+			source[ i ].scaling = keyframe.GetScale();
+			source[ i ].keep = false;
+			
+			if( i > 0 && source[ i - 1 ].rotation.Dot( source[ i ].rotation ) < 0.0f ){
+				source[ i ].rotation = -source[ i ].rotation;
+			}
+		}
+		
+		// drop keyframes which can be interpolated from the last kept keyframe and the
+		// keyframe following them within the error tolerance
+		int anchor = 0;
+		int keepCount = 1;
+		
+		source[ 0 ].keep = true;
+		for( i=1; i<count - 1; i++ ){
+			if( ! fCanDropKeyframes( source, anchor, i + 1 ) ){
+				source[ i ].keep = true;
+				anchor = i;
+				keepCount++;
+			}
+		}
+		if( count > 1 ){
+			source[ count - 1 ].keep = true;
+			keepCount++;
+		}
+		
+		// quantize position and scaling using the range of the kept keyframes
+		decVector positionMaximum, scalingMaximum;
+		
+		pPositionMinimum = source[ 0 ].position;
+		positionMaximum = source[ 0 ].position;
+		pScalingMinimum = source[ 0 ].scaling;
+		scalingMaximum = source[ 0 ].scaling;
+		
+		for( i=1; i<count; i++ ){
+			if( source[ i ].keep ){
+				pPositionMinimum.SetSmallest( source[ i ].position );
+				positionMaximum.SetLargest( source[ i ].position );
+				pScalingMinimum.SetSmallest( source[ i ].scaling );
+				scalingMaximum.SetLargest( source[ i ].scaling );
+			}
+		}
+		
+		pPositionQuantize = ( positionMaximum - pPositionMinimum ) / 65535.0f;
+		pScalingQuantize = ( scalingMaximum - pScalingMinimum ) / 65535.0f;
+		
+		pTimes = new float[ keepCount ];
+		pCompressedKeyframes = new sCompressedKeyframe[ keepCount ];
+		
+		for( i=0; i<count; i++ ){
+			if( ! source[ i ].keep ){
+				continue;
+			}
+			
+			const sSourceKeyframe &keyframe = source[ i ];
+			sCompressedKeyframe &compressed = pCompressedKeyframes[ pKeyframeCount ];
+			
+			compressed.timeStep = 0.0f;
+			for( j=i+1; j<count; j++ ){
+				if( source[ j ].keep ){
+					if( source[ j ].time > keyframe.time ){
+						compressed.timeStep = 1.0f / ( source[ j ].time - keyframe.time );
+					}
+					break;
+				}
+			}
+			
+			compressed.position[ 0 ] = fQuantize( keyframe.position.x, pPositionMinimum.x, pPositionQuantize.x );
+			compressed.position[ 1 ] = fQuantize( keyframe.position.y, pPositionMinimum.y, pPositionQuantize.y );
+			compressed.position[ 2 ] = fQuantize( keyframe.position.z, pPositionMinimum.z, pPositionQuantize.z );
+			compressed.rotation[ 0 ] = fQuantizeRotation( keyframe.rotation.x );
+			compressed.rotation[ 1 ] = fQuantizeRotation( keyframe.rotation.y );
+			compressed.rotation[ 2 ] = fQuantizeRotation( keyframe.rotation.z );
+			compressed.rotation[ 3 ] = fQuantizeRotation( keyframe.rotation.w );
+			compressed.scaling[ 0 ] = fQuantize( keyframe.scaling.x, pScalingMinimum.x, pScalingQuantize.x );
+			compressed.scaling[ 1 ] = fQuantize( keyframe.scaling.y, pScalingMinimum.y, pScalingQuantize.y );
+			compressed.scaling[ 2 ] = fQuantize( keyframe.scaling.z, pScalingMinimum.z, pScalingQuantize.z );
+			
+			pTimes[ pKeyframeCount ] = keyframe.time;
+			pKeyframeCount++;
+		}
+		
+	}catch( const deException & ){
+		delete [] source;
+		throw;
+	}
+	
+	delete [] source;
+}
+
+void dearAnimationKeyframeList::pDecompress( const sCompressedKeyframe &keyframe,
+decVector &position, decQuaternion &rotation, decVector &scaling ) const{
+	position.x = pPositionMinimum.x + pPositionQuantize.x * ( float )keyframe.position[ 0 ];
+	position.y = pPositionMinimum.y + pPositionQuantize.y * ( float )keyframe.position[ 1 ];
+	position.z = pPositionMinimum.z + pPositionQuantize.z * ( float )keyframe.position[ 2 ];
+	
+	rotation.x = ( float )keyframe.rotation[ 0 ] / 32767.0f;
+	rotation.y = ( float )keyframe.rotation[ 1 ] / 32767.0f;
+	rotation.z = ( float )keyframe.rotation[ 2 ] / 32767.0f;
+	rotation.w = ( float )keyframe.rotation[ 3 ] / 32767.0f;
+	
+	scaling.x = pScalingMinimum.x + pScalingQuantize.x * ( float )keyframe.scaling[ 0 ];
+	scaling.y = pScalingMinimum.y + pScalingQuantize.y * ( float )keyframe.scaling[ 1 ];
+	scaling.z = pScalingMinimum.z + pScalingQuantize.z * ( float )keyframe.scaling[ 2 ];
+}
@@ -31,17 +31,40 @@ class dearAnimationKeyframe;
 
 /**
  * \brief Animation move keyframe list.
+ * 
+ * Keyframe times are stored in a separate array to locate keyframes quickly using the
+ * cursor of the caller or a binary search.
+ * 
+ * Compressed lists drop keyframes which can be interpolated from the remaining keyframes
+ * within an error bound and store the remaining keyframes quantized to 16-bit values.
+ * Compressed lists have no dearAnimationKeyframe objects. Use Interpolate() to sample
+ * keyframe lists regardless if they are compressed or not.
  */
 class dearAnimationKeyframeList{
 private:
+	/** \brief Quantized keyframe. */
+	struct sCompressedKeyframe{
+		float timeStep;
+		unsigned short position[ 3 ];
+		unsigned short scaling[ 3 ];
+		short rotation[ 4 ];
+	};
+	
+	float *pTimes;
 	dearAnimationKeyframe *pKeyframes;
+	sCompressedKeyframe *pCompressedKeyframes;
 	int pKeyframeCount;
 	
+	decVector pPositionMinimum;
+	decVector pPositionQuantize;
+	decVector pScalingMinimum;
+	decVector pScalingQuantize;
+	
 public:
 	/** \name Constructors and Destructors */
 	/*@{*/
 	/** \brief Creates a new animation move keyframe list. */
-	dearAnimationKeyframeList( const deAnimationKeyframeList &list );
+	dearAnimationKeyframeList( const deAnimationKeyframeList &list, bool compress );
 	/** \brief Cleans up the animation move keyframe list. */
 	~dearAnimationKeyframeList();
 	/*@}*/
@@ -50,19 +73,41 @@ public:
 	/*@{*/
 	/** \brief Retrieves the number of keyframes. */
 	inline int GetCount() const{ return pKeyframeCount; }
-	/** \brief Retrieves a keyframe by index. */
+	/** \brief List is compressed. */
+	inline bool GetCompressed() const{ return pCompressedKeyframes != NULL; }
+	/** \brief Retrieves a keyframe by index. Not allowed for compressed lists. */
 	dearAnimationKeyframe &GetAt( int index ) const;
+	
 	/**
-	 * \brief Retrieves the keyframe with the range containing the provided
-	 *        time in seconds or NULL if there are no keyframes.
+	 * \brief Index of keyframe with the range containing the provided time in seconds.
+	 * \details Cursor is the index found by the previous call. If the time is located in
+	 *          the same or the next keyframe no search is required. Returns -1 if there
+	 *          are no keyframes.
 	 */
-	dearAnimationKeyframe *GetWithTime( float time ) const;
+	int IndexWithTime( float time, int cursor ) const;
+	
+	/**
+	 * \brief Interpolate keyframes at time in seconds.
+	 * \details Cursor is updated with the index of the found keyframe and can be
+	 *          reused in the next call. Returns false if there are no keyframes.
+	 */
+	bool Interpolate( float time, int &cursor, decVector &position,
+		decQuaternion &rotation, decVector &scaling ) const;
+		
+	/** \brief Interpolate keyframes at time in seconds without cursor. */
+	bool Interpolate( float time, decVector &position, decQuaternion &rotation, decVector &scaling ) const;
+	
+	/** \brief Memory consumption in bytes. */
+	int GetMemoryConsumption() const;
 	/*@}*/
 	
 private:
 	void pCleanUp();
 	
 	void pCreateKeyframes( const deAnimationKeyframeList &list );
+	void pCreateCompressedKeyframes( const deAnimationKeyframeList &list );
+	void pDecompress( const sCompressedKeyframe &keyframe, decVector &position,
+		decQuaternion &rotation, decVector &scaling ) const;
 };
 
 #endif
@@ -38,7 +38,7 @@
 // Constructors and Destructors
 /////////////////////////////////
 
-dearAnimationMove::dearAnimationMove( const deAnimationMove &move ){
+dearAnimationMove::dearAnimationMove( const deAnimationMove &move, bool compress ){
 	pPlaytime = move.GetPlaytime();
 	pName = move.GetName();
 	
@@ -46,7 +46,7 @@ dearAnimationMove::dearAnimationMove( const deAnimationMove &move ){
 	pKeyframeListCount = 0;
 	
 	try{
-		pCreateKeyframeLists( move );
+		pCreateKeyframeLists( move, compress );
 		
 	}catch( const deException & ){
 		pCleanUp();
@@ -87,7 +87,7 @@ void dearAnimationMove::pCleanUp(){
 
 
 
-void dearAnimationMove::pCreateKeyframeLists( const deAnimationMove &move ){
+void dearAnimationMove::pCreateKeyframeLists( const deAnimationMove &move, bool compress ){
 	const int count = move.GetKeyframeListCount();
 	if( count == 0 ){
 		return;
@@ -96,7 +96,8 @@ void dearAnimationMove::pCreateKeyframeLists( const deAnimationMove &move ){
 	pKeyframeLists = new dearAnimationKeyframeList*[ count ];
 	
 	while( pKeyframeListCount < count ){
-		pKeyframeLists[ pKeyframeListCount ] = new dearAnimationKeyframeList( *move.GetKeyframeList( pKeyframeListCount ) );
+		pKeyframeLists[ pKeyframeListCount ] = new dearAnimationKeyframeList(
+			*move.GetKeyframeList( pKeyframeListCount ), compress );
 		pKeyframeListCount++;
 	}
 }
@@ -43,8 +43,8 @@ private:
 public:
 	/** \name Constructors and Destructors */
 	/*@{*/
-	/** \brief Create a new animation move. */
-	dearAnimationMove( const deAnimationMove &move );
+	/** \brief Create a new animation move optionally compressing the keyframe lists. */
+	dearAnimationMove( const deAnimationMove &move, bool compress );
 	/** \brief Clean up the animation move. */
 	virtual ~dearAnimationMove();
 	/*@}*/
@@ -65,7 +65,7 @@ public:
 private:
 	void pCleanUp();
 	
-	void pCreateKeyframeLists( const deAnimationMove &move );
+	void pCreateKeyframeLists( const deAnimationMove &move, bool compress );
 };
 
 #endif
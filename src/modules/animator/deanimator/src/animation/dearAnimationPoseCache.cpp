@@ -0,0 +1,117 @@
+/* 
+ * Drag[en]gine Animator Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dearAnimationPoseCache.h"
+#include "../dearBoneStateBuffer.h"
+
+#include <dragengine/common/exceptions.h>
+
+
+
+// Definitions
+////////////////
+
+// poses are searched linearly. animator instances in a batch usually use a small number
+// of different moves and times so a small limit is enough
+#define MAX_POSE_COUNT 32
+
+struct dearAnimationPoseCache::sPose{
+	const void *owner;
+	const dearAnimationMove *move;
+	float time;
+	dearBoneStateBuffer buffer;
+};
+
+
+
+// Class dearAnimationPoseCache
+/////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+dearAnimationPoseCache::dearAnimationPoseCache() :
+pPoseCount( 0 ),
+pHitCount( 0 ),
+pMissCount( 0 ){
+}
+
+dearAnimationPoseCache::~dearAnimationPoseCache(){
+	const int count = pPoses.GetCount();
+	int i;
+	
+	for( i=0; i<count; i++ ){
+		delete ( sPose* )pPoses.GetAt( i );
+	}
+}
+
+
+
+// Management
+///////////////
+
+const dearBoneStateBuffer *dearAnimationPoseCache::GetPose( const void *owner,
+const dearAnimationMove *move, float time ){
+	int i;
+	
+	for( i=0; i<pPoseCount; i++ ){
+		const sPose &pose = *( ( sPose* )pPoses.GetAt( i ) );
+		if( pose.owner == owner && pose.move == move && pose.time == time ){
+			pHitCount++;
+			return &pose.buffer;
+		}
+	}
+	
+	pMissCount++;
+	return NULL;
+}
+
+dearBoneStateBuffer *dearAnimationPoseCache::AddPose( const void *owner,
+const dearAnimationMove *move, float time ){
+	if( ! owner || ! move ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	if( pPoseCount == MAX_POSE_COUNT ){
+		return NULL;
+	}
+	
+	if( pPoseCount == pPoses.GetCount() ){
+		pPoses.Add( new sPose );
+	}
+	
+	sPose &pose = *( ( sPose* )pPoses.GetAt( pPoseCount++ ) );
+	pose.owner = owner;
+	pose.move = move;
+	pose.time = time;
+	return &pose.buffer;
+}
+
+void dearAnimationPoseCache::Clear(){
+	pPoseCount = 0;
+	pHitCount = 0;
+	pMissCount = 0;
+}
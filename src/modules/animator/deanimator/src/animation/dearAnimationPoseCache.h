@@ -0,0 +1,87 @@
+/* 
+ * Drag[en]gine Animator Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef _DEARANIMATIONPOSECACHE_H_
+#define _DEARANIMATIONPOSECACHE_H_
+
+#include <dragengine/common/collection/decPointerList.h>
+
+class dearAnimationMove;
+class dearBoneStateBuffer;
+
+
+
+/**
+ * \brief Animation pose cache.
+ * 
+ * Stores poses sampled by animation rules for reuse by other animator instances. Poses are
+ * identified by an owner, the animation move and the move time. The owner identifies the
+ * rule configuration the pose has been sampled for, usually the engine animator rule shared
+ * by all instances of the same animator. Not thread-safe. Used by one task at a time.
+ */
+class dearAnimationPoseCache{
+private:
+	struct sPose;
+	
+	decPointerList pPoses;
+	int pPoseCount;
+	int pHitCount;
+	int pMissCount;
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create pose cache. */
+	dearAnimationPoseCache();
+	
+	/** \brief Clean up pose cache. */
+	~dearAnimationPoseCache();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Number of cached poses. */
+	inline int GetPoseCount() const{ return pPoseCount; }
+	
+	/** \brief Number of times a cached pose has been found. */
+	inline int GetHitCount() const{ return pHitCount; }
+	
+	/** \brief Number of times no cached pose has been found. */
+	inline int GetMissCount() const{ return pMissCount; }
+	
+	/** \brief Cached pose or \em NULL if absent. */
+	const dearBoneStateBuffer *GetPose( const void *owner, const dearAnimationMove *move, float time );
+	
+	/**
+	 * \brief Add pose to fill in by the caller.
+	 * \details Returns \em NULL if the cache is full.
+	 */
+	dearBoneStateBuffer *AddPose( const void *owner, const dearAnimationMove *move, float time );
+	
+	/** \brief Remove all poses keeping the memory for reuse. */
+	void Clear();
+	/*@}*/
+};
+
+#endif
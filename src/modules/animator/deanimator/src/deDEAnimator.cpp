@@ -28,6 +28,7 @@
 #include "deDEAnimator.h"
 #include "animation/dearAnimation.h"
 #include "component/dearComponent.h"
+#include "devmode/dearDeveloperMode.h"
 
 #include <dragengine/systems/modules/deModuleParameter.h>
 #include <dragengine/common/exceptions.h>
@@ -35,6 +36,14 @@
 
 
 
+// Definitions
+////////////////
+
+#define PARAM_COMPRESS_ANIMATIONS "compressAnimations"
+#define PARAM_BATCH_APPLY_RULES "batchApplyRules"
+
+
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -69,10 +78,17 @@ deBaseModule *DEAnimatorCreateModule( deLoadableModule *loadableModule ){
 ////////////////////////////
 
 deDEAnimator::deDEAnimator( deLoadableModule &loadableModule ) :
-deBaseAnimatorModule( loadableModule ){
+deBaseAnimatorModule( loadableModule ),
+pCompressAnimations( false ),
+pBatchApplyRules( false ),
+pDeveloperMode( NULL ){
+	pDeveloperMode = new dearDeveloperMode( *this );
 }
 
 deDEAnimator::~deDEAnimator(){
+	if( pDeveloperMode ){
+		delete pDeveloperMode;
+	}
 }
 
 
@@ -107,3 +123,78 @@ deBaseAnimatorAnimation *deDEAnimator::CreateAnimation( deAnimation *animation )
 deBaseAnimatorComponent *deDEAnimator::CreateComponent( deComponent *component ){
 	return new dearComponent( *this, *component );
 }
+
+
+
+// Parameters
+///////////////
+
+int deDEAnimator::GetParameterCount() const{
+	return 2;
+}
+
+void deDEAnimator::GetParameterInfo( int index, deModuleParameter &parameter ) const{
+	switch( index ){
+	case 0:
+		parameter.SetName( PARAM_COMPRESS_ANIMATIONS );
+		parameter.SetDescription( "Compress animation keyframes. Drops keyframes which can be "
+			"interpolated and stores the remaining keyframes quantized. Reduces memory consumption "
+			"at the cost of a small error. Affects animations loaded after changing the parameter." );
+		parameter.SetType( deModuleParameter::eptBoolean );
+		parameter.SetDisplayName( "Compress Animations" );
+		parameter.SetCategory( deModuleParameter::ecAdvanced );
+		break;
+		
+	case 1:
+		parameter.SetName( PARAM_BATCH_APPLY_RULES );
+		parameter.SetDescription( "Apply animator instances of the same animator in batches "
+			"instead of using one parallel task per instance. Instances in the same batch share "
+			"animation poses sampled at the same move time. Reduces overhead with many animator "
+			"instances." );
+		parameter.SetType( deModuleParameter::eptBoolean );
+		parameter.SetDisplayName( "Batch Apply Rules" );
+		parameter.SetCategory( deModuleParameter::ecAdvanced );
+		break;
+		
+	default:
+		DETHROW( deeInvalidParam );
+	}
+}
+
+int deDEAnimator::IndexOfParameterNamed( const char *name ) const{
+	if( strcmp( name, PARAM_COMPRESS_ANIMATIONS ) == 0 ){
+		return 0;
+		
+	}else if( strcmp( name, PARAM_BATCH_APPLY_RULES ) == 0 ){
+		return 1;
+	}
+	return -1;
+}
+
+decString deDEAnimator::GetParameterValue( const char *name ) const{
+	if( strcmp( name, PARAM_COMPRESS_ANIMATIONS ) == 0 ){
+		return pCompressAnimations ? "1" : "0";
+		
+	}else if( strcmp( name, PARAM_BATCH_APPLY_RULES ) == 0 ){
+		return pBatchApplyRules ? "1" : "0";
+	}
+	DETHROW( deeInvalidParam );
+}
+
+void deDEAnimator::SetParameterValue( const char *name, const char *value ){
+	if( strcmp( name, PARAM_COMPRESS_ANIMATIONS ) == 0 ){
+		pCompressAnimations = decString( value ) == "1";
+		
+	}else if( strcmp( name, PARAM_BATCH_APPLY_RULES ) == 0 ){
+		pBatchApplyRules = decString( value ) == "1";
+		
+	}else{
+		DETHROW( deeInvalidParam );
+	}
+}
+
+void deDEAnimator::SendCommand( const decUnicodeArgumentList &command, decUnicodeString &answer ){
+	if( ! pDeveloperMode->ExecuteCommand( command, answer ) ){
+		deBaseAnimatorModule::SendCommand( command, answer );
+	}
+}
@@ -24,12 +24,22 @@
 
 #include <dragengine/systems/modules/animator/deBaseAnimatorModule.h>
 
+class dearDeveloperMode;
+
 
 
 /**
  * \brief DEAnimator animator module.
  */
 class deDEAnimator : public deBaseAnimatorModule{
+private:
+	bool pCompressAnimations;
+	bool pBatchApplyRules;
+	
+	dearDeveloperMode *pDeveloperMode;
+	
+	
+	
 public:
 	/** \name Constructors and Destructors */
 	/*@{*/
@@ -66,6 +76,41 @@ public:
 	
 	/** \brief Create peer for component. */
 	virtual deBaseAnimatorComponent *CreateComponent( deComponent *component );
+	
+	/**
+	 * \brief Compress keyframes of animations.
+	 * \details Affects only animations created after changing the parameter.
+	 */
+	inline bool GetCompressAnimations() const{ return pCompressAnimations; }
+	
+	/** \brief Apply rules of animator instances in batches instead of one task per instance. */
+	inline bool GetBatchApplyRules() const{ return pBatchApplyRules; }
+	
+	/** \brief Developer mode. */
+	inline dearDeveloperMode &GetDeveloperMode() const{ return *pDeveloperMode; }
+	/*@}*/
+	
+	
+	
+	/** \name Parameters */
+	/*@{*/
+	/** \brief Number of parameters. */
+	virtual int GetParameterCount() const;
+	
+	/** \brief Get information about parameter. */
+	virtual void GetParameterInfo( int index, deModuleParameter &parameter ) const;
+	
+	/** \brief Index of named parameter or -1 if not found. */
+	virtual int IndexOfParameterNamed( const char *name ) const;
+	
+	/** \brief Value of named parameter. */
+	virtual decString GetParameterValue( const char *name ) const;
+	
+	/** \brief Set value of named parameter. */
+	virtual void SetParameterValue( const char *name, const char *value );
+	
+	/** \brief Send command. */
+	virtual void SendCommand( const decUnicodeArgumentList &command, decUnicodeString &answer );
 	/*@}*/
 };
 
@@ -25,6 +25,7 @@
 
 #include "dearAnimator.h"
 #include "deDEAnimator.h"
+#include "task/dearTaskApplyRulesBatch.h"
 
 #include <dragengine/deEngine.h>
 #include <dragengine/common/exceptions.h>
@@ -53,6 +54,14 @@ dearAnimator::~dearAnimator(){
 // Management
 ///////////////
 
+dearTaskApplyRulesBatch *dearAnimator::GetBatchApplyRules() const{
+	return ( dearTaskApplyRulesBatch* )( deThreadSafeObject* )pBatchApplyRules;
+}
+
+void dearAnimator::SetBatchApplyRules( dearTaskApplyRulesBatch *batch ){
+	pBatchApplyRules = batch;
+}
+
 
 
 // Notifications
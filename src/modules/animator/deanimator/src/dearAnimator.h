@@ -23,9 +23,11 @@
 #define _DEARANIMATOR_H_
 
 #include <dragengine/systems/modules/animator/deBaseAnimatorAnimator.h>
+#include <dragengine/threading/deThreadSafeObjectReference.h>
 
 class deDEAnimator;
 class deAnimator;
+class dearTaskApplyRulesBatch;
 
 
 
@@ -38,6 +40,7 @@ private:
 	deDEAnimator &pModule;
 	deAnimator &pAnimator;
 	unsigned int pUpdateTracker;
+	deThreadSafeObjectReference pBatchApplyRules;
 	
 public:
 	/** \name Constructors and Destructors */
@@ -63,6 +66,16 @@ public:
 	
 	/** \brief Current update tracker state. */
 	inline unsigned int GetUpdateTracker() const{ return pUpdateTracker; }
+	
+	/**
+	 * \brief Last batch task started by instances of this animator or \em NULL.
+	 * \details Instances try to join this batch before starting a new one. Only
+	 *          accessed from the main thread.
+	 */
+	dearTaskApplyRulesBatch *GetBatchApplyRules() const;
+	
+	/** \brief Set last batch task started by instances of this animator or \em NULL. */
+	void SetBatchApplyRules( dearTaskApplyRulesBatch *batch );
 	/*@}*/
 	
 	/** \name Notifications */
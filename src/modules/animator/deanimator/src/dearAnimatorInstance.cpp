@@ -34,6 +34,7 @@
 #include "animation/dearAnimation.h"
 #include "dearLink.h"
 #include "task/dearTaskApplyRules.h"
+#include "task/dearTaskApplyRulesBatch.h"
 #include "component/dearComponent.h"
 #include "component/dearComponentBoneState.h"
 
@@ -86,7 +87,10 @@ pDirtyRules( true ),
 pCaptureComponentState( false ),
 
 pUseParallelTask( true ),
-pActiveTaskApplyRule( NULL )
+pActiveTaskApplyRule( NULL ),
+pActiveTaskIsBatch( false ),
+
+pPoseCache( NULL )
 {
 	try{
 		AnimatorChanged();
@@ -151,6 +155,10 @@ void dearAnimatorInstance::SetCaptureComponentState(){
 	pCaptureComponentState = true;
 }
 
+void dearAnimatorInstance::SetPoseCache( dearAnimationPoseCache *poseCache ){
+	pPoseCache = poseCache;
+}
+
 void dearAnimatorInstance::ApplyRules(){
 	int i;
 	for( i=0; i<pRuleCount; i++ ){
@@ -188,7 +196,10 @@ void dearAnimatorInstance::pStartTaskApplyRules(){
 		return;
 	}
 	
-	if( pUseParallelTask ){
+	if( pUseParallelTask && pModule.GetBatchApplyRules() ){
+		pStartBatchApplyRules();
+		
+	}else if( pUseParallelTask ){
 		dearTaskApplyRules * const task = pNewTaskApplyRules();
 		
 		// if we are the first task on the component update the arcomponent. if not set
@@ -206,6 +217,7 @@ void dearAnimatorInstance::pStartTaskApplyRules(){
 		deParallelProcessing &parallelProcessing = pModule.GetGameEngine()->GetParallelProcessing();
 		parallelProcessing.AddTask( task );
 		pActiveTaskApplyRule = task;
+		pActiveTaskIsBatch = false;
 		if( parallelProcessing.GetOutputDebugMessages() ){
 			pModule.LogInfoFormat( "Task %p dispatched (instance=%p component=%p list=%d)",
 				task, this, pComponent, pTaskApplyRules.GetCount() );
@@ -231,8 +243,50 @@ void dearAnimatorInstance::pStartTaskApplyRules(){
 	}
 }
 
+void dearAnimatorInstance::pStartBatchApplyRules(){
+	deParallelProcessing &parallelProcessing = pModule.GetGameEngine()->GetParallelProcessing();
+	deComponent &component = pComponent->GetComponent();
+	deParallelTask * const previousTask = component.GetAnimatorTask();
+	
+	// if we are the first task on the component update the arcomponent. this has to be done
+	// before joining a batch since the batch can start running any time after joining
+	if( ! previousTask ){
+		pComponent->UpdateFromComponent();
+	}
+	
+	// join the batch of the animator if it has not started running yet. tasks can only depend
+	// on tasks added earlier. joining is thus only possible if the component has no animator
+	// task or the animator task is the batch itself. in the later case instances are chained
+	// on the same component and the batch processes them in the order they joined
+	dearTaskApplyRulesBatch *batch = pAnimator->GetBatchApplyRules();
+	
+	if( ! batch || ( previousTask && previousTask != batch ) || ! batch->AddInstance( *this ) ){
+		deThreadSafeObjectReference task;
+		task.TakeOver( new dearTaskApplyRulesBatch( pModule ) );
+		batch = ( dearTaskApplyRulesBatch* )( deThreadSafeObject* )task;
+		
+		batch->AddInstance( *this );
+		if( previousTask ){
+			batch->AddDependsOn( previousTask );
+			batch->SetPreviousTask( previousTask, pComponent );
+		}
+		
+		parallelProcessing.AddTask( batch );
+		pAnimator->SetBatchApplyRules( batch );
+	}
+	
+	pActiveTaskApplyRule = batch;
+	pActiveTaskIsBatch = true;
+	if( parallelProcessing.GetOutputDebugMessages() ){
+		pModule.LogInfoFormat( "Batch task %p joined (instance=%p component=%p)", batch, this, pComponent );
+	}
+	
+	// see pStartTaskApplyRules() for why this has to be done after adding the task
+	component.SetAnimatorTask( batch );
+}
+
 void dearAnimatorInstance::StopTaskApplyRules(){
-	// WARNING called by dearTaskApplyRules::Finished() only!
+	// WARNING called by dearTaskApplyRules::Finished() and dearTaskApplyRulesBatch::Finished() only!
 	
 	if( ! pActiveTaskApplyRule ){
 		return;
@@ -250,6 +304,7 @@ void dearAnimatorInstance::StopTaskApplyRules(){
 			pActiveTaskApplyRule, this, pComponent, pTaskApplyRules.GetCount() );
 	}
 	pActiveTaskApplyRule = NULL;
+	pActiveTaskIsBatch = false;
 }
 
 
@@ -814,6 +869,19 @@ void dearAnimatorInstance::pCancelTaskApplyRules(){
 		return;
 	}
 	
+	if( pActiveTaskIsBatch ){
+		// batch tasks are shared with other instances and can not be cancelled. leave the
+		// batch if it did not start running yet otherwise wait for it to finish
+		dearTaskApplyRulesBatch &batch = *( ( dearTaskApplyRulesBatch* )pActiveTaskApplyRule );
+		if( batch.RemoveInstance( *this ) ){
+			pLeaveBatchApplyRules( batch );
+			
+		}else{
+			pWaitTaskApplyRules();
+		}
+		return;
+	}
+	
 	if( pModule.GetGameEngine()->GetParallelProcessing().GetOutputDebugMessages() ){
 		pModule.LogInfoFormat( "Cancel task %p (instance=%p component=%p list=%d)",
 			pActiveTaskApplyRule, this, pComponent, pTaskApplyRules.GetCount() );
@@ -823,6 +891,25 @@ void dearAnimatorInstance::pCancelTaskApplyRules(){
 	pWaitTaskApplyRules();
 }
 
+void dearAnimatorInstance::pLeaveBatchApplyRules( dearTaskApplyRulesBatch &batch ){
+	// other instances chained on the same component can still be pending in the batch. in
+	// this case the component keeps the batch as animator task. otherwise the component
+	// falls back to the animator task it had before the batch if this one is still pending
+	if( pComponent ){
+		deComponent &component = pComponent->GetComponent();
+		if( component.GetAnimatorTask() == &batch
+		&& ! batch.HasOtherInstanceWithComponent( *this, pComponent ) ){
+			component.SetAnimatorTask( batch.GetPreviousTask( pComponent ) );
+		}
+	}
+	
+	if( pModule.GetGameEngine()->GetParallelProcessing().GetOutputDebugMessages() ){
+		pModule.LogInfoFormat( "Batch task %p left (instance=%p component=%p)", &batch, this, pComponent );
+	}
+	pActiveTaskApplyRule = NULL;
+	pActiveTaskIsBatch = false;
+}
+
 void dearAnimatorInstance::pWaitTaskApplyRules(){
 	if( ! pActiveTaskApplyRule ){
 		return;
@@ -835,6 +922,7 @@ void dearAnimatorInstance::pWaitTaskApplyRules(){
 		parallelProcessing.WaitForTask( pActiveTaskApplyRule );
 	}
 	pActiveTaskApplyRule = NULL;
+	pActiveTaskIsBatch = false;
 }
 
 void dearAnimatorInstance::pWaitAnimTaskFinished(){
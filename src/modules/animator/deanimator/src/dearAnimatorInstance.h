@@ -33,6 +33,9 @@
 
 class dearComponent;
 class dearTaskApplyRules;
+class dearTaskApplyRulesBatch;
+class dearAnimationPoseCache;
+class deParallelTask;
 class deRig;
 class deAnimatorControllerTarget;
 class deAnimatorInstance;
@@ -83,9 +86,12 @@ private:
 	bool pCaptureComponentState;
 	
 	bool pUseParallelTask;
-	dearTaskApplyRules *pActiveTaskApplyRule;
+	deParallelTask *pActiveTaskApplyRule;
+	bool pActiveTaskIsBatch;
 	decThreadSafeObjectOrderedSet pTaskApplyRules;
 	
+	dearAnimationPoseCache *pPoseCache;
+	
 public:
 	/** \name Constructors and Destructors */
 	/*@{*/
@@ -121,6 +127,15 @@ public:
 	/** \brief Set capture current component state to true. */
 	void SetCaptureComponentState();
 	
+	/**
+	 * \brief Pose cache to share sampled poses with other instances or \em NULL.
+	 * \details Set by batch tasks while applying rules.
+	 */
+	inline dearAnimationPoseCache *GetPoseCache() const{ return pPoseCache; }
+	
+	/** \brief Set pose cache to share sampled poses with other instances or \em NULL. */
+	void SetPoseCache( dearAnimationPoseCache *poseCache );
+	
 	
 	
 	/** \brief Number of links. */
@@ -150,7 +165,8 @@ public:
 	
 	/**
 	 * \brief Stop task running apply rules in parallel.
-	 * \details Called by dearTaskApplyRules.Finished() only.
+	 * \details Called by dearTaskApplyRules.Finished() and
+	 *          dearTaskApplyRulesBatch.Finished() only.
 	 */
 	void StopTaskApplyRules();
 	
@@ -245,12 +261,25 @@ private:
 	 */
 	void pStartTaskApplyRules();
 	
+	/**
+	 * \brief Add instance to batch task applying rules.
+	 * \details Joins the batch of the animator if possible otherwise starts a new batch.
+	 */
+	void pStartBatchApplyRules();
+	
 	/**
 	 * \brief Cancel task to apply rules if existing.
 	 * \details Forces parallel tasks to finish to ensure the tasks is finished.
 	 */
 	void pCancelTaskApplyRules();
 	
+	/**
+	 * \brief Leave batch which has not started running yet.
+	 * \details Clears the animator task of the component only if no other instance still
+	 *          has pending work on the component.
+	 */
+	void pLeaveBatchApplyRules( dearTaskApplyRulesBatch &batch );
+	
 	void pWaitTaskApplyRules();
 	
 	void pWaitAnimTaskFinished();
@@ -49,7 +49,9 @@ dearBoneState::dearBoneState(){
 	pChildStates = NULL;
 	pChildStateCount = 0;
 	pChildStateSize = 0;
-	pScale.Set( 1.0f, 1.0f, 1.0f );
+	pPosition = NULL;
+	pOrientation = NULL;
+	pScale = NULL;
 	pProtect = false;
 	pDirty = true;
 }
@@ -99,24 +101,34 @@ void dearBoneState::SetAnimationBone( int index ){
 }
 
 void dearBoneState::SetPosition( const decVector &position ){
-	pPosition = position;
+	*pPosition = position;
 	SetDirty( true );
 }
 
 void dearBoneState::SetOrientation( const decQuaternion &orientation ){
-	pOrientation = orientation;
+	*pOrientation = orientation;
 	SetDirty( true );
 }
 
 void dearBoneState::SetScale( const decVector &size ){
-	pScale = size;
+	*pScale = size;
 	SetDirty( true );
 }
 
 void dearBoneState::SetPosOrient( const decVector &position, const decQuaternion &orientation ){
+	*pPosition = position;
+	*pOrientation = orientation;
+	SetDirty( true );
+}
+
+void dearBoneState::SetStorage( decVector *position, decQuaternion *orientation, decVector *scale ){
+	if( ! position || ! orientation || ! scale ){
+		DETHROW( deeInvalidParam );
+	}
+	
 	pPosition = position;
 	pOrientation = orientation;
-	SetDirty( true );
+	pScale = scale;
 }
 
 void dearBoneState::SetRigLocalMatrix( const decMatrix &matrix ){
@@ -166,7 +178,7 @@ void dearBoneState::UpdateMatrices(){
 	}
 	
 	// local matrices
-	pLocalMatrix.SetWorld( pPosition, pOrientation, pScale );
+	pLocalMatrix.SetWorld( *pPosition, *pOrientation, *pScale );
 	pInvLocalMatrix = pLocalMatrix.QuickInvert();
 	
 	// global matrices
@@ -185,6 +197,25 @@ void dearBoneState::UpdateMatrices(){
 	pDirty = false;
 }
 
+void dearBoneState::UpdateGlobalMatrices(){
+	if( ! pDirty ){
+		return;
+	}
+	
+	if( pParentState ){
+		pParentState->UpdateGlobalMatrices();
+		pGlobalMatrix = pLocalMatrix.QuickMultiply( pRigLocalMatrix )
+			.QuickMultiply( pParentState->GetGlobalMatrix() );
+			
+	}else{
+		pGlobalMatrix = pLocalMatrix.QuickMultiply( pRigLocalMatrix );
+	}
+	
+	pInvGlobalMatrix = pGlobalMatrix.QuickInvert();
+	
+	pDirty = false;
+}
+
 void dearBoneState::UpdateFromGlobalMatrix(){
 	const decMatrix matrix = CalcLocalFromGlobal( pGlobalMatrix );
 	SetPosition( matrix.GetPosition() );
@@ -206,7 +237,7 @@ void dearBoneState::UpdateMatricesKeepGlobal(){
 		return;
 	}
 	
-	pLocalMatrix.SetWorld( pPosition, pOrientation, pScale );
+	pLocalMatrix.SetWorld( *pPosition, *pOrientation, *pScale );
 	pInvLocalMatrix = pLocalMatrix.QuickInvert();
 	
 	pInvGlobalMatrix = pGlobalMatrix.QuickInvert();
@@ -226,23 +257,23 @@ void dearBoneState::ResetMatrices(){
 
 
 void dearBoneState::SetFrom( const dearBoneState &state ){
-	pPosition = state.pPosition;
-	pOrientation = state.pOrientation;
-	pScale = state.pScale;
+	*pPosition = *state.pPosition;
+	*pOrientation = *state.pOrientation;
+	*pScale = *state.pScale;
 	SetDirty( true );
 }
 
 void dearBoneState::SetFrom( const deComponentBone &bone ){
-	pPosition = bone.GetPosition();
-	pOrientation = bone.GetRotation();
-	pScale = bone.GetScale();
+	*pPosition = bone.GetPosition();
+	*pOrientation = bone.GetRotation();
+	*pScale = bone.GetScale();
 	SetDirty( true );
 }
 
 void dearBoneState::SetFrom( const dearComponentBoneState &state ){
-	pPosition = state.GetPosition();
-	pOrientation = state.GetRotation();
-	pScale = state.GetScale();
+	*pPosition = state.GetPosition();
+	*pOrientation = state.GetRotation();
+	*pScale = state.GetScale();
 	SetDirty( true );
 }
 
@@ -294,25 +325,25 @@ bool enablePosition, bool enableOrientation, bool enableScale ){
 		}else if( fabsf( 1.0f - blendFactor ) < FLOAT_SAFE_EPSILON ){ // blendFactor = 1
 			// apply the new state
 			if( enablePosition ){
-				pPosition = position;
+				*pPosition = position;
 			}
 			
 			if( enableOrientation ){
-				pOrientation = orientation;
+				*pOrientation = orientation;
 			}
 			
 			if( enableScale ){
-				pScale = scale;
+				*pScale = scale;
 			}
 			
 		}else{
 			// blend the state
 			if( enablePosition ){
-				pPosition = pPosition * ( 1.0f - blendFactor ) + position * blendFactor;
+				*pPosition = *pPosition * ( 1.0f - blendFactor ) + position * blendFactor;
 			}
 			
 			if( enableOrientation ){
-				pOrientation = pOrientation.Slerp( orientation, blendFactor );
+				*pOrientation = pOrientation->Slerp( orientation, blendFactor );
 				
 				//pOrientation =
 				//	( decQuaternion( 0.0f, 0.0f, 0.0f, blendFactor ) + pOrientation * ( 1.0f - blendFactor ) ) *
@@ -324,7 +355,7 @@ bool enablePosition, bool enableOrientation, bool enableScale ){
 			}
 			
 			if( enableScale ) {
-				pScale = pScale * ( 1.0f - blendFactor ) + scale * blendFactor;
+				*pScale = *pScale * ( 1.0f - blendFactor ) + scale * blendFactor;
 			}
 		}
 		
@@ -337,11 +368,11 @@ bool enablePosition, bool enableOrientation, bool enableScale ){
 		}else{
 			// add new state to the old state
 			if( enablePosition ){
-				pPosition += position * blendFactor;
+				*pPosition += position * blendFactor;
 			}
 			
 			if( enableOrientation ){
-				pOrientation *= decQuaternion().Slerp( orientation, blendFactor );
+				*pOrientation *= decQuaternion().Slerp( orientation, blendFactor );
 				
 				//pOrientation =
 				//	( decQuaternion( 0.0f, 0.0f, 0.0f, blendFactor ) + pOrientation * ( 1.0f - blendFactor ) ) *
@@ -353,7 +384,7 @@ bool enablePosition, bool enableOrientation, bool enableScale ){
 			}
 			
 			if( enableScale ) {
-				pScale += ( scale - decVector( 1.0f, 1.0f, 1.0f ) ) * blendFactor;
+				*pScale += ( scale - decVector( 1.0f, 1.0f, 1.0f ) ) * blendFactor;
 			}
 		}
 		
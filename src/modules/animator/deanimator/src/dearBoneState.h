@@ -48,9 +48,9 @@ private:
 	dearBoneState *pParentState;
 	dearBoneState **pChildStates;
 	int pChildStateCount, pChildStateSize;
-	decVector pPosition;
-	decQuaternion pOrientation;
-	decVector pScale;
+	decVector *pPosition;
+	decQuaternion *pOrientation;
+	decVector *pScale;
 	decMatrix pRigLocalMatrix;
 	decMatrix pInvRigLocalMatrix;
 	decMatrix pLocalMatrix;
@@ -96,20 +96,27 @@ public:
 	/** Sets the parent bone state or NULL if not existing. */
 	void SetParentState( dearBoneState *boneState );
 	/** Retrieves the position. */
-	inline const decVector &GetPosition() const{ return pPosition; }
+	inline const decVector &GetPosition() const{ return *pPosition; }
 	/** Sets the position. */
 	void SetPosition( const decVector &position );
 	/** Retrieves the orientation. */
-	inline const decQuaternion &GetOrientation() const{ return pOrientation; }
+	inline const decQuaternion &GetOrientation() const{ return *pOrientation; }
 	/** Sets the orientation. */
 	void SetOrientation( const decQuaternion &orientation );
 	/** Retrieves the scale. */
-	inline const decVector &GetScale() const{ return pScale; }
+	inline const decVector &GetScale() const{ return *pScale; }
 	/** Sets the scale. */
 	void SetScale( const decVector &size );
 	/** Sets position and orientation. */
 	void SetPosOrient( const decVector &position, const decQuaternion &orientation );
 	
+	/**
+	 * \brief Set storage of position, orientation and scale.
+	 * \details For use by dearBoneStateList only which stores the values of all states
+	 *          in separate arrays.
+	 */
+	void SetStorage( decVector *position, decQuaternion *orientation, decVector *scale );
+	
 	/** Retrieves the rig local matrix. */
 	inline const decMatrix &GetRigLocalMatrix() const{ return pRigLocalMatrix; }
 	/** Retrieves the inverse rig local matrix. */
@@ -151,6 +158,14 @@ public:
 	 * the inverse is calculated and stored.
 	 */
 	void UpdateMatricesKeepGlobal();
+	/**
+	 * \brief Sets the global matrices from the local matrix.
+	 * \details The local matrices have to be up to date for this state and all dirty
+	 *          parent states. Used by dearBoneStateList after building the local
+	 *          matrices of all dirty states.
+	 */
+	void UpdateGlobalMatrices();
+	
 	/** Updates the local parameters from the global matrix. */
 	void UpdateFromGlobalMatrix();
 	/** \brief Calculate local matric from global matrix. */
@@ -0,0 +1,99 @@
+/* 
+ * Drag[en]gine Animator Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dearBoneStateBuffer.h"
+
+#include <dragengine/common/exceptions.h>
+
+
+
+// Class dearBoneStateBuffer
+//////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+dearBoneStateBuffer::dearBoneStateBuffer() :
+pPositions( NULL ),
+pOrientations( NULL ),
+pScales( NULL ),
+pStateIndices( NULL ),
+pCount( 0 ),
+pSize( 0 ){
+}
+
+dearBoneStateBuffer::~dearBoneStateBuffer(){
+	if( pStateIndices ){
+		delete [] pStateIndices;
+	}
+	if( pScales ){
+		delete [] pScales;
+	}
+	if( pOrientations ){
+		delete [] pOrientations;
+	}
+	if( pPositions ){
+		delete [] pPositions;
+	}
+}
+
+
+
+// Management
+///////////////
+
+void dearBoneStateBuffer::SetCount( int count ){
+	if( count < 0 ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	if( count > pSize ){
+		decVector * const positions = new decVector[ count ];
+		decQuaternion * const orientations = new decQuaternion[ count ];
+		decVector * const scales = new decVector[ count ];
+		int * const stateIndices = new int[ count ];
+		
+		if( pStateIndices ){
+			delete [] pStateIndices;
+		}
+		if( pScales ){
+			delete [] pScales;
+		}
+		if( pOrientations ){
+			delete [] pOrientations;
+		}
+		if( pPositions ){
+			delete [] pPositions;
+		}
+		
+		pPositions = positions;
+		pOrientations = orientations;
+		pScales = scales;
+		pStateIndices = stateIndices;
+		pSize = count;
+	}
+	
+	pCount = count;
+}
@@ -0,0 +1,107 @@
+/* 
+ * Drag[en]gine Animator Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEARBONESTATEBUFFER_H_
+#define _DEARBONESTATEBUFFER_H_
+
+#include <dragengine/common/math/decMath.h>
+
+
+
+/**
+ * \brief Bone state buffer.
+ * 
+ * Stores positions, orientations and scales to apply to bone states in separate arrays.
+ * Used by rules to collect the state of all affected bones before applying them to the
+ * bone state list in one go. Each entry stores the index of the bone state to apply the
+ * entry to or -1 to skip the entry.
+ */
+class dearBoneStateBuffer{
+private:
+	decVector *pPositions;
+	decQuaternion *pOrientations;
+	decVector *pScales;
+	int *pStateIndices;
+	int pCount;
+	int pSize;
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create bone state buffer. */
+	dearBoneStateBuffer();
+	
+	/** \brief Clean up bone state buffer. */
+	~dearBoneStateBuffer();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Number of entries. */
+	inline int GetCount() const{ return pCount; }
+	
+	/** \brief Set number of entries. Content of entries is undefined. */
+	void SetCount( int count );
+	
+	/** \brief Positions. */
+	inline decVector *GetPositions() const{ return pPositions; }
+	
+	/** \brief Orientations. */
+	inline decQuaternion *GetOrientations() const{ return pOrientations; }
+	
+	/** \brief Scales. */
+	inline decVector *GetScales() const{ return pScales; }
+	
+	/** \brief Bone state indices. */
+	inline const int *GetStateIndices() const{ return pStateIndices; }
+	
+	/** \brief Set entry. */
+	inline void SetAt( int index, int stateIndex, const decVector &position,
+	const decQuaternion &orientation, const decVector &scale ){
+		pStateIndices[ index ] = stateIndex;
+		pPositions[ index ] = position;
+		pOrientations[ index ] = orientation;
+		pScales[ index ] = scale;
+	}
+	
+	/** \brief Set bone state index of entry. */
+	inline void SetStateIndexAt( int index, int stateIndex ){
+		pStateIndices[ index ] = stateIndex;
+	}
+	
+	/** \brief Set entry to the default state. */
+	inline void SetDefaultAt( int index, int stateIndex ){
+		pStateIndices[ index ] = stateIndex;
+		pPositions[ index ].SetZero();
+		pOrientations[ index ].Set( 0.0f, 0.0f, 0.0f, 1.0f );
+		pScales[ index ].Set( 1.0f, 1.0f, 1.0f );
+	}
+	
+	/** \brief Skip entry. */
+	inline void SkipAt( int index ){
+		pStateIndices[ index ] = -1;
+	}
+	/*@}*/
+};
+
+#endif
@@ -25,6 +25,7 @@
 
 #include "dearBoneState.h"
 #include "dearBoneStateList.h"
+#include "dearBoneStateBuffer.h"
 #include "component/dearComponent.h"
 #include "component/dearComponentBoneState.h"
 
@@ -37,6 +38,312 @@
 #include <dragengine/resources/rig/deRig.h>
 #include <dragengine/resources/rig/deRigBone.h>
 
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define DEAR_BONESTATE_SSE 1
+#include <emmintrin.h>
+#endif
+
+
+
+// Definitions
+////////////////
+
+#ifdef DEAR_BONESTATE_SSE
+
+// quaternions of four states with one register per component
+struct sQuaternion4{
+	__m128 x, y, z, w;
+};
+
+static inline void fLoadQuaternions( sQuaternion4 &result, const decQuaternion * const *quaternions ){
+	__m128 q0 = _mm_loadu_ps( &quaternions[ 0 ]->x );
+	__m128 q1 = _mm_loadu_ps( &quaternions[ 1 ]->x );
+	__m128 q2 = _mm_loadu_ps( &quaternions[ 2 ]->x );
+	__m128 q3 = _mm_loadu_ps( &quaternions[ 3 ]->x );
+	_MM_TRANSPOSE4_PS( q0, q1, q2, q3 );
+	result.x = q0;
+	result.y = q1;
+	result.z = q2;
+	result.w = q3;
+}
+
+static inline void fStoreQuaternions( const sQuaternion4 &quaternion, decQuaternion * const *quaternions, int count ){
+	__m128 q0 = quaternion.x;
+	__m128 q1 = quaternion.y;
+	__m128 q2 = quaternion.z;
+	__m128 q3 = quaternion.w;
+	_MM_TRANSPOSE4_PS( q0, q1, q2, q3 );
+	
+	_mm_storeu_ps( &quaternions[ 0 ]->x, q0 );
+	if( count > 1 ){
+		_mm_storeu_ps( &quaternions[ 1 ]->x, q1 );
+	}
+	if( count > 2 ){
+		_mm_storeu_ps( &quaternions[ 2 ]->x, q2 );
+	}
+	if( count > 3 ){
+		_mm_storeu_ps( &quaternions[ 3 ]->x, q3 );
+	}
+}
+
+// sine for angles in the range from 0 to pi/2. taylor series up to x^11 with an error below 1e-7
+static inline __m128 fSin( __m128 x ){
+	const __m128 x2 = _mm_mul_ps( x, x );
+	__m128 r = _mm_set1_ps( -1.0f / 39916800.0f );
+	r = _mm_add_ps( _mm_mul_ps( r, x2 ), _mm_set1_ps( 1.0f / 362880.0f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, x2 ), _mm_set1_ps( -1.0f / 5040.0f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, x2 ), _mm_set1_ps( 1.0f / 120.0f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, x2 ), _mm_set1_ps( -1.0f / 6.0f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, x2 ), _mm_set1_ps( 1.0f ) );
+	return _mm_mul_ps( r, x );
+}
+
+// arc cosine for values in the range from 0 to 1. approximation from abramowitz and stegun
+// 4.4.46 with an error below 2e-8
+static inline __m128 fAcos( __m128 x ){
+	__m128 r = _mm_set1_ps( -0.0012624911f );
+	r = _mm_add_ps( _mm_mul_ps( r, x ), _mm_set1_ps( 0.0066700901f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, x ), _mm_set1_ps( -0.0170881256f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, x ), _mm_set1_ps( 0.0308918810f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, x ), _mm_set1_ps( -0.0501743046f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, x ), _mm_set1_ps( 0.0889789874f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, x ), _mm_set1_ps( -0.2145988016f ) );
+	r = _mm_add_ps( _mm_mul_ps( r, x ), _mm_set1_ps( 1.5707963050f ) );
+	return _mm_mul_ps( r, _mm_sqrt_ps( _mm_sub_ps( _mm_set1_ps( 1.0f ), x ) ) );
+}
+
+// same as decQuaternion::Slerp
+static inline void fSlerp( sQuaternion4 &result, const sQuaternion4 &a, const sQuaternion4 &b, __m128 factor ){
+	const __m128 one = _mm_set1_ps( 1.0f );
+	__m128 cosom = _mm_add_ps( _mm_add_ps( _mm_mul_ps( a.x, b.x ), _mm_mul_ps( a.y, b.y ) ),
+		_mm_add_ps( _mm_mul_ps( a.z, b.z ), _mm_mul_ps( a.w, b.w ) ) );
+		
+	// negate b if the angle is larger than 90 degrees to interpolate the short way
+	const __m128 negate = _mm_and_ps( cosom, _mm_set1_ps( -0.0f ) );
+	cosom = _mm_min_ps( _mm_xor_ps( cosom, negate ), one );
+	
+	// use linear interpolation for small angles
+	const __m128 useSlerp = _mm_cmpgt_ps( _mm_sub_ps( one, cosom ), _mm_set1_ps( 0.001f ) );
+	const __m128 omega = fAcos( cosom );
+	const __m128 sinom = _mm_div_ps( one, fSin( omega ) );
+	const __m128 factor0 = _mm_sub_ps( one, factor );
+	
+	const __m128 scale0 = _mm_or_ps(
+		_mm_and_ps( useSlerp, _mm_mul_ps( fSin( _mm_mul_ps( omega, factor0 ) ), sinom ) ),
+		_mm_andnot_ps( useSlerp, factor0 ) );
+	const __m128 scale1 = _mm_xor_ps( _mm_or_ps(
+		_mm_and_ps( useSlerp, _mm_mul_ps( fSin( _mm_mul_ps( omega, factor ) ), sinom ) ),
+		_mm_andnot_ps( useSlerp, factor ) ), negate );
+		
+	result.x = _mm_add_ps( _mm_mul_ps( a.x, scale0 ), _mm_mul_ps( b.x, scale1 ) );
+	result.y = _mm_add_ps( _mm_mul_ps( a.y, scale0 ), _mm_mul_ps( b.y, scale1 ) );
+	result.z = _mm_add_ps( _mm_mul_ps( a.z, scale0 ), _mm_mul_ps( b.z, scale1 ) );
+	result.w = _mm_add_ps( _mm_mul_ps( a.w, scale0 ), _mm_mul_ps( b.w, scale1 ) );
+}
+
+// same as decQuaternion::operator*
+static inline void fMultiply( sQuaternion4 &result, const sQuaternion4 &a, const sQuaternion4 &b ){
+	const __m128 x = _mm_add_ps( _mm_sub_ps( _mm_add_ps( _mm_mul_ps( b.x, a.w ), _mm_mul_ps( b.y, a.z ) ),
+		_mm_mul_ps( b.z, a.y ) ), _mm_mul_ps( b.w, a.x ) );
+	const __m128 y = _mm_add_ps( _mm_add_ps( _mm_sub_ps( _mm_mul_ps( b.y, a.w ), _mm_mul_ps( b.x, a.z ) ),
+		_mm_mul_ps( b.z, a.x ) ), _mm_mul_ps( b.w, a.y ) );
+	const __m128 z = _mm_add_ps( _mm_add_ps( _mm_sub_ps( _mm_mul_ps( b.x, a.y ), _mm_mul_ps( b.y, a.x ) ),
+		_mm_mul_ps( b.z, a.w ) ), _mm_mul_ps( b.w, a.z ) );
+	const __m128 w = _mm_sub_ps( _mm_sub_ps( _mm_sub_ps( _mm_mul_ps( b.w, a.w ), _mm_mul_ps( b.x, a.x ) ),
+		_mm_mul_ps( b.y, a.y ) ), _mm_mul_ps( b.z, a.z ) );
+	result.x = x;
+	result.y = y;
+	result.z = z;
+	result.w = w;
+}
+
+#endif
+
+enum eOrientationOperations{
+	// buffer = buffer * state
+	eooDifference,
+	
+	// state = state.Slerp( buffer, factor )
+	eooBlend,
+	
+	// state = state * identity.Slerp( buffer, factor )
+	eooOverlay
+};
+
+#ifdef DEAR_BONESTATE_SSE
+static void fProcessOrientationBatch( decQuaternion **states, decQuaternion **buffer,
+int count, eOrientationOperations operation, float factor ){
+	// fill up batch with the first entry. only valid entries are stored
+	int i;
+	for( i=count; i<4; i++ ){
+		states[ i ] = states[ 0 ];
+		buffer[ i ] = buffer[ 0 ];
+	}
+	
+	sQuaternion4 stateQuaternions, bufferQuaternions, result;
+	fLoadQuaternions( stateQuaternions, states );
+	fLoadQuaternions( bufferQuaternions, buffer );
+	
+	switch( operation ){
+	case eooDifference:
+		fMultiply( result, bufferQuaternions, stateQuaternions );
+		fStoreQuaternions( result, buffer, count );
+		break;
+		
+	case eooBlend:
+		fSlerp( result, stateQuaternions, bufferQuaternions, _mm_set1_ps( factor ) );
+		fStoreQuaternions( result, states, count );
+		break;
+		
+	case eooOverlay:{
+		sQuaternion4 identity;
+		identity.x = _mm_setzero_ps();
+		identity.y = identity.x;
+		identity.z = identity.x;
+		identity.w = _mm_set1_ps( 1.0f );
+		fSlerp( bufferQuaternions, identity, bufferQuaternions, _mm_set1_ps( factor ) );
+		fMultiply( result, stateQuaternions, bufferQuaternions );
+		fStoreQuaternions( result, states, count );
+		}break;
+	}
+}
+#endif
+
+#ifdef DEAR_BONESTATE_SSE
+// same as decMatrix::SetWorld for four states at the same time
+static void fBuildLocalMatrices( dearBoneState * const *states, int count ){
+	const decQuaternion *orientations[ 4 ];
+	float scaleX[ 4 ], scaleY[ 4 ], scaleZ[ 4 ];
+	int i;
+	
+	for( i=0; i<4; i++ ){
+		const dearBoneState &state = *states[ i < count ? i : 0 ];
+		orientations[ i ] = &state.GetOrientation();
+		scaleX[ i ] = state.GetScale().x;
+		scaleY[ i ] = state.GetScale().y;
+		scaleZ[ i ] = state.GetScale().z;
+	}
+	
+	sQuaternion4 q;
+	fLoadQuaternions( q, orientations );
+	
+	const __m128 sqx = _mm_mul_ps( q.x, q.x );
+	const __m128 sqy = _mm_mul_ps( q.y, q.y );
+	const __m128 sqz = _mm_mul_ps( q.z, q.z );
+	const __m128 sqw = _mm_mul_ps( q.w, q.w );
+	
+	const __m128 inv = _mm_div_ps( _mm_set1_ps( 1.0f ),
+		_mm_add_ps( _mm_add_ps( sqx, sqy ), _mm_add_ps( sqz, sqw ) ) );
+	const __m128 invX = _mm_mul_ps( inv, _mm_loadu_ps( scaleX ) );
+	const __m128 invY = _mm_mul_ps( inv, _mm_loadu_ps( scaleY ) );
+	const __m128 invZ = _mm_mul_ps( inv, _mm_loadu_ps( scaleZ ) );
+	const __m128 invX2 = _mm_add_ps( invX, invX );
+	const __m128 invY2 = _mm_add_ps( invY, invY );
+	const __m128 invZ2 = _mm_add_ps( invZ, invZ );
+	
+	const __m128 t1 = _mm_mul_ps( q.x, q.y );
+	const __m128 t2 = _mm_mul_ps( q.z, q.w );
+	const __m128 t3 = _mm_mul_ps( q.x, q.z );
+	const __m128 t4 = _mm_mul_ps( q.y, q.w );
+	const __m128 t5 = _mm_mul_ps( q.y, q.z );
+	const __m128 t6 = _mm_mul_ps( q.x, q.w );
+	
+	float a11[ 4 ], a12[ 4 ], a13[ 4 ], a21[ 4 ], a22[ 4 ], a23[ 4 ], a31[ 4 ], a32[ 4 ], a33[ 4 ];
+	_mm_storeu_ps( a11, _mm_mul_ps( _mm_add_ps( _mm_sub_ps( _mm_sub_ps( sqx, sqy ), sqz ), sqw ), invX ) );
+	_mm_storeu_ps( a22, _mm_mul_ps( _mm_add_ps( _mm_sub_ps( _mm_sub_ps( sqy, sqx ), sqz ), sqw ), invY ) );
+	_mm_storeu_ps( a33, _mm_mul_ps( _mm_add_ps( _mm_sub_ps( _mm_sub_ps( sqz, sqx ), sqy ), sqw ), invZ ) );
+	_mm_storeu_ps( a21, _mm_mul_ps( _mm_add_ps( t1, t2 ), invX2 ) );
+	_mm_storeu_ps( a12, _mm_mul_ps( _mm_sub_ps( t1, t2 ), invY2 ) );
+	_mm_storeu_ps( a31, _mm_mul_ps( _mm_sub_ps( t3, t4 ), invX2 ) );
+	_mm_storeu_ps( a13, _mm_mul_ps( _mm_add_ps( t3, t4 ), invZ2 ) );
+	_mm_storeu_ps( a32, _mm_mul_ps( _mm_add_ps( t5, t6 ), invY2 ) );
+	_mm_storeu_ps( a23, _mm_mul_ps( _mm_sub_ps( t5, t6 ), invZ2 ) );
+	
+	decMatrix matrix;
+	
+	for( i=0; i<count; i++ ){
+		dearBoneState &state = *states[ i ];
+		const decVector &position = state.GetPosition();
+		
+		matrix.a11 = a11[ i ];
+		matrix.a12 = a12[ i ];
+		matrix.a13 = a13[ i ];
+		matrix.a14 = position.x;
+		matrix.a21 = a21[ i ];
+		matrix.a22 = a22[ i ];
+		matrix.a23 = a23[ i ];
+		matrix.a24 = position.y;
+		matrix.a31 = a31[ i ];
+		matrix.a32 = a32[ i ];
+		matrix.a33 = a33[ i ];
+		matrix.a34 = position.z;
+		
+		state.SetLocalMatrix( matrix );
+		state.SetInverseLocalMatrix( matrix.QuickInvert() );
+	}
+}
+#endif
+
+static void fProcessOrientations( decQuaternion *states, const dearBoneStateBuffer &buffer,
+eOrientationOperations operation, float factor, bool useSIMD ){
+	decQuaternion * const orientations = buffer.GetOrientations();
+	const int * const stateIndices = buffer.GetStateIndices();
+	const int count = buffer.GetCount();
+	int i;
+	
+#ifdef DEAR_BONESTATE_SSE
+	if( useSIMD ){
+		// process four orientations at the same time skipping entries without state
+		decQuaternion *batchStates[ 4 ];
+		decQuaternion *batchBuffer[ 4 ];
+		int batchCount = 0;
+		
+		for( i=0; i<count; i++ ){
+			if( stateIndices[ i ] == -1 ){
+				continue;
+			}
+			
+			batchStates[ batchCount ] = states + stateIndices[ i ];
+			batchBuffer[ batchCount ] = orientations + i;
+			
+			if( ++batchCount == 4 ){
+				fProcessOrientationBatch( batchStates, batchBuffer, batchCount, operation, factor );
+				batchCount = 0;
+			}
+		}
+		
+		if( batchCount > 0 ){
+			fProcessOrientationBatch( batchStates, batchBuffer, batchCount, operation, factor );
+		}
+		return;
+	}
+#endif
+	
+	const decQuaternion identity;
+	
+	for( i=0; i<count; i++ ){
+		if( stateIndices[ i ] == -1 ){
+			continue;
+		}
+		
+		decQuaternion &state = states[ stateIndices[ i ] ];
+		
+		switch( operation ){
+		case eooDifference:
+			orientations[ i ] = orientations[ i ] * state;
+			break;
+			
+		case eooBlend:
+			state = state.Slerp( orientations[ i ], factor );
+			break;
+			
+		case eooOverlay:
+			state *= identity.Slerp( orientations[ i ], factor );
+			break;
+		}
+	}
+}
+
 
 
 // Class dearBoneStateList
@@ -47,8 +354,12 @@
 
 dearBoneStateList::dearBoneStateList(){
 	pStates = NULL;
+	pPositions = NULL;
+	pOrientations = NULL;
+	pScales = NULL;
 	pStateCount = 0;
 	pStateSize = 0;
+	pUseSIMD = true;
 }
 
 dearBoneStateList::~dearBoneStateList(){
@@ -57,9 +368,17 @@ dearBoneStateList::~dearBoneStateList(){
 			delete pStates[ pStateCount - 1 ];
 			pStateCount--;
 		}
-		
 		delete [] pStates;
 	}
+	if( pScales ){
+		delete [] pScales;
+	}
+	if( pOrientations ){
+		delete [] pOrientations;
+	}
+	if( pPositions ){
+		delete [] pPositions;
+	}
 }
 
 
@@ -70,23 +389,40 @@ dearBoneStateList::~dearBoneStateList(){
 void dearBoneStateList::SetStateCount( int count ){
 	if( count > pStateSize ){
 		dearBoneState ** const newArray = new dearBoneState*[ count ];
+		decVector * const positions = new decVector[ count ];
+		decQuaternion * const orientations = new decQuaternion[ count ];
+		decVector * const scales = new decVector[ count ];
+		int i;
+		
+		for( i=0; i<pStateSize; i++ ){
+			newArray[ i ] = pStates[ i ];
+			positions[ i ] = pPositions[ i ];
+			orientations[ i ] = pOrientations[ i ];
+			scales[ i ] = pScales[ i ];
+		}
+		for( i=pStateSize; i<count; i++ ){
+			scales[ i ].Set( 1.0f, 1.0f, 1.0f );
+		}
 		
 		if( pStates ){
-			int i;
-			
-			for( i=0; i<pStateSize; i++ ){
-				newArray[ i ] = pStates[ i ];
-			}
-			
 			delete [] pStates;
+			delete [] pPositions;
+			delete [] pOrientations;
+			delete [] pScales;
 		}
-		
 		pStates = newArray;
+		pPositions = positions;
+		pOrientations = orientations;
+		pScales = scales;
 		
 		while( pStateSize < count ){
 			pStates[ pStateSize ] = new dearBoneState;
 			pStateSize++;
 		}
+		
+		for( i=0; i<pStateSize; i++ ){
+			pStates[ i ]->SetStorage( pPositions + i, pOrientations + i, pScales + i );
+		}
 	}
 	
 	pStateCount = count;
@@ -187,11 +523,154 @@ void dearBoneStateList::SetFrom( const dearBoneStateList &stateList ){
 void dearBoneStateList::UpdateStates(){
 	int s;
 	
+	pUpdateLocalMatrices();
+	
 	for( s=0; s<pStateCount; s++ ){
-		pStates[ s ]->UpdateMatrices();
+		pStates[ s ]->UpdateGlobalMatrices();
+	}
+}
+
+void dearBoneStateList::BlendWith( const dearBoneStateBuffer &buffer,
+deAnimatorRule::eBlendModes blendMode, float blendFactor, bool enablePosition,
+bool enableOrientation, bool enableScale ){
+	const decVector * const positions = buffer.GetPositions();
+	const decQuaternion * const orientations = buffer.GetOrientations();
+	const decVector * const scales = buffer.GetScales();
+	const int * const stateIndices = buffer.GetStateIndices();
+	const int count = buffer.GetCount();
+	int i;
+	
+	// blend new state over old state
+	if( blendMode == deAnimatorRule::ebmBlend ){
+		if( fabsf( blendFactor ) < FLOAT_SAFE_EPSILON ){ // blendFactor = 0
+			// keep the old state
+			return;
+			
+		}else if( fabsf( 1.0f - blendFactor ) < FLOAT_SAFE_EPSILON ){ // blendFactor = 1
+			// apply the new state
+			for( i=0; i<count; i++ ){
+				const int index = stateIndices[ i ];
+				if( index == -1 ){
+					continue;
+				}
+				
+				if( enablePosition ){
+					pPositions[ index ] = positions[ i ];
+				}
+				if( enableOrientation ){
+					pOrientations[ index ] = orientations[ i ];
+				}
+				if( enableScale ){
+					pScales[ index ] = scales[ i ];
+				}
+			}
+			
+		}else{
+			// blend the state
+			const float keepFactor = 1.0f - blendFactor;
+			
+			if( enablePosition ){
+				for( i=0; i<count; i++ ){
+					const int index = stateIndices[ i ];
+					if( index != -1 ){
+						pPositions[ index ] = pPositions[ index ] * keepFactor + positions[ i ] * blendFactor;
+					}
+				}
+			}
+			
+			if( enableOrientation ){
+				fProcessOrientations( pOrientations, buffer, eooBlend, blendFactor, pUseSIMD );
+			}
+			
+			if( enableScale ){
+				for( i=0; i<count; i++ ){
+					const int index = stateIndices[ i ];
+					if( index != -1 ){
+						pScales[ index ] = pScales[ index ] * keepFactor + scales[ i ] * blendFactor;
+					}
+				}
+			}
+		}
+		
+	// overlay new state over the old state
+	}else if( blendMode == deAnimatorRule::ebmOverlay ){
+		if( fabsf( blendFactor ) < FLOAT_SAFE_EPSILON ){ // blendFactor = 0
+			// keep the old state
+			return;
+		}
+		
+		// add new state to the old state
+		if( enablePosition ){
+			for( i=0; i<count; i++ ){
+				const int index = stateIndices[ i ];
+				if( index != -1 ){
+					pPositions[ index ] += positions[ i ] * blendFactor;
+				}
+			}
+		}
+		
+		if( enableOrientation ){
+			fProcessOrientations( pOrientations, buffer, eooOverlay, blendFactor, pUseSIMD );
+		}
+		
+		if( enableScale ){
+			const decVector one( 1.0f, 1.0f, 1.0f );
+			
+			for( i=0; i<count; i++ ){
+				const int index = stateIndices[ i ];
+				if( index != -1 ){
+					pScales[ index ] += ( scales[ i ] - one ) * blendFactor;
+				}
+			}
+		}
+		
+	}else{
+		DETHROW( deeInvalidParam );
+	}
+	
+	for( i=0; i<count; i++ ){
+		if( stateIndices[ i ] != -1 ){
+			pStates[ stateIndices[ i ] ]->SetDirty( true );
+		}
 	}
 }
 
+void dearBoneStateList::BlendWithDifference( dearBoneStateBuffer &buffer,
+deAnimatorRule::eBlendModes blendMode, float blendFactor, bool enablePosition,
+bool enableOrientation, bool enableScale ){
+	decVector * const positions = buffer.GetPositions();
+	const int * const stateIndices = buffer.GetStateIndices();
+	const int count = buffer.GetCount();
+	int i;
+	
+	if( enablePosition ){
+		for( i=0; i<count; i++ ){
+			const int index = stateIndices[ i ];
+			if( index != -1 ){
+				positions[ i ] += pPositions[ index ];
+			}
+		}
+	}
+	
+	if( enableOrientation ){
+		fProcessOrientations( pOrientations, buffer, eooDifference, 0.0f, pUseSIMD );
+	}
+	
+	BlendWith( buffer, blendMode, blendFactor, enablePosition, enableOrientation, enableScale );
+}
+
+bool dearBoneStateList::GetSIMDSupported(){
+#ifdef DEAR_BONESTATE_SSE
+	return true;
+#else
+	return false;
+#endif
+}
+
+void dearBoneStateList::SetUseSIMD( bool useSIMD ){
+	pUseSIMD = useSIMD;
+}
+
 void dearBoneStateList::MarkDirty(){
 	int s;
 	
@@ -518,3 +997,50 @@ deAnimatorRule::eBlendModes blendMode, float blendFactor ) const{
 		boneState.SetScale( scale );
 	}
 }
+
+
+
+// Private Functions
+//////////////////////
+
+void dearBoneStateList::pUpdateLocalMatrices(){
+	int s;
+	
+#ifdef DEAR_BONESTATE_SSE
+	if( pUseSIMD ){
+		dearBoneState *batch[ 4 ];
+		int batchCount = 0;
+		
+		for( s=0; s<pStateCount; s++ ){
+			if( ! pStates[ s ]->GetDirty() ){
+				continue;
+			}
+			
+			batch[ batchCount ] = pStates[ s ];
+			
+			if( ++batchCount == 4 ){
+				fBuildLocalMatrices( batch, batchCount );
+				batchCount = 0;
+			}
+		}
+		
+		if( batchCount > 0 ){
+			fBuildLocalMatrices( batch, batchCount );
+		}
+		return;
+	}
+#endif
+	
+	decMatrix matrix;
+	
+	for( s=0; s<pStateCount; s++ ){
+		dearBoneState &state = *pStates[ s ];
+		if( ! state.GetDirty() ){
+			continue;
+		}
+		
+		matrix.SetWorld( state.GetPosition(), state.GetOrientation(), state.GetScale() );
+		state.SetLocalMatrix( matrix );
+		state.SetInverseLocalMatrix( matrix.QuickInvert() );
+	}
+}
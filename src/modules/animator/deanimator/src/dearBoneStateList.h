@@ -27,6 +27,7 @@
 #include <dragengine/common/math/decMath.h>
 #include <dragengine/resources/animator/rule/deAnimatorRule.h>
 
+class dearBoneStateBuffer;
 class dearComponent;
 // predefinitions
 class dearBoneState;
@@ -40,13 +41,19 @@ class deAnimator;
 /**
  * @brief Bone State List.
  *
- * List of bone states.
+ * List of bone states. The positions, orientations and scales of all states are stored
+ * in separate arrays. This allows blending and building matrices for multiple states
+ * at the same time using SIMD instructions if supported.
  */
 class dearBoneStateList{
 private:
 	dearBoneState **pStates;
+	decVector *pPositions;
+	decQuaternion *pOrientations;
+	decVector *pScales;
 	int pStateCount;
 	int pStateSize;
+	bool pUseSIMD;
 	
 public:
 	/** @name Constructors and Destructors */
@@ -76,6 +83,35 @@ public:
 	
 	/** Updates the states. */
 	void UpdateStates();
+	
+	/**
+	 * \brief Blend states with buffer.
+	 * \details Same as calling dearBoneState::BlendWith() for all buffer entries.
+	 */
+	void BlendWith( const dearBoneStateBuffer &buffer, deAnimatorRule::eBlendModes blendMode,
+		float blendFactor, bool enablePosition, bool enableOrientation, bool enableScale );
+		
+	/**
+	 * \brief Blend states with difference buffer.
+	 * \details Buffer positions and orientations are differences added to the states before
+	 *          blending. Buffer scales are used as they are. Modifies the buffer.
+	 */
+	void BlendWithDifference( dearBoneStateBuffer &buffer, deAnimatorRule::eBlendModes blendMode,
+		float blendFactor, bool enablePosition, bool enableOrientation, bool enableScale );
+		
+	/** \brief SIMD kernels are supported. */
+	static bool GetSIMDSupported();
+	
+	/** \brief Use SIMD kernels if supported. */
+	inline bool GetUseSIMD() const{ return pUseSIMD; }
+	
+	/**
+	 * \brief Set to use SIMD kernels if supported.
+	 * \details Disable to use the scalar kernels. Used by the developer mode to benchmark
+	 *          the kernels against each other.
+	 */
+	void SetUseSIMD( bool useSIMD );
+	
 	/** Mark dirty. */
 	void MarkDirty();
 	
@@ -94,6 +130,9 @@ public:
 	/** \brief Apply states to an animator module component. */
 	void ApplyToComponent( dearComponent &component, deAnimatorRule::eBlendModes blendMode, float blendFactor ) const;
 	/*@}*/
+	
+private:
+	void pUpdateLocalMatrices();
 };
 
 // end of include only once
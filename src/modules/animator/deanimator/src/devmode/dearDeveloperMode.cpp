@@ -0,0 +1,552 @@
+/* 
+ * Drag[en]gine Animator Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dearDeveloperMode.h"
+#include "../deDEAnimator.h"
+#include "../dearBoneState.h"
+#include "../dearBoneStateBuffer.h"
+#include "../dearBoneStateList.h"
+#include "../animation/dearAnimationKeyframeList.h"
+
+#include <dragengine/deEngine.h>
+#include <dragengine/common/exceptions.h>
+#include <dragengine/common/collection/decObjectList.h>
+#include <dragengine/common/collection/decPointerList.h>
+#include <dragengine/common/string/unicode/decUnicodeString.h>
+#include <dragengine/common/string/unicode/decUnicodeArgumentList.h>
+#include <dragengine/common/utils/decTimer.h>
+#include <dragengine/resources/animation/deAnimation.h>
+#include <dragengine/resources/animation/deAnimationBone.h>
+#include <dragengine/resources/animation/deAnimationBuilder.h>
+#include <dragengine/resources/animation/deAnimationKeyframe.h>
+#include <dragengine/resources/animation/deAnimationKeyframeList.h>
+#include <dragengine/resources/animation/deAnimationManager.h>
+#include <dragengine/resources/animation/deAnimationMove.h>
+#include <dragengine/resources/animation/deAnimationReference.h>
+#include <dragengine/resources/animator/deAnimator.h>
+#include <dragengine/resources/animator/deAnimatorInstance.h>
+#include <dragengine/resources/animator/deAnimatorInstanceManager.h>
+#include <dragengine/resources/animator/deAnimatorInstanceReference.h>
+#include <dragengine/resources/animator/deAnimatorLink.h>
+#include <dragengine/resources/animator/deAnimatorManager.h>
+#include <dragengine/resources/animator/deAnimatorReference.h>
+#include <dragengine/resources/animator/controller/deAnimatorController.h>
+#include <dragengine/resources/animator/controller/deAnimatorControllerTarget.h>
+#include <dragengine/resources/animator/rule/deAnimatorRuleAnimation.h>
+#include <dragengine/resources/component/deComponent.h>
+#include <dragengine/resources/component/deComponentManager.h>
+#include <dragengine/resources/component/deComponentReference.h>
+#include <dragengine/resources/rig/deRig.h>
+#include <dragengine/resources/rig/deRigBone.h>
+#include <dragengine/resources/rig/deRigBuilder.h>
+#include <dragengine/resources/rig/deRigManager.h>
+#include <dragengine/resources/rig/deRigReference.h>
+
+
+
+// builds a chain of bones for benchmarks
+class dearDMBoneChainRigBuilder : public deRigBuilder{
+public:
+	int boneCount;
+	
+	dearDMBoneChainRigBuilder( int nboneCount ) : boneCount( nboneCount ){
+	}
+	
+	virtual void BuildRig( deRig *rig ){
+		decString name;
+		int i;
+		
+		for( i=0; i<boneCount; i++ ){
+			name.Format( "bone%d", i );
+			deRigBone * const bone = new deRigBone( name );
+			bone->SetParent( i - 1 );
+			bone->SetPosition( decVector( 0.0f, 0.1f, 0.0f ) );
+			rig->AddBone( bone );
+		}
+		
+		rig->SetRootBone( 0 );
+	}
+};
+
+// builds a move swinging a chain of bones for benchmarks
+class dearDMBoneChainAnimationBuilder : public deAnimationBuilder{
+public:
+	int boneCount;
+	int keyframeCount;
+	
+	dearDMBoneChainAnimationBuilder( int nboneCount, int nkeyframeCount ) :
+	boneCount( nboneCount ), keyframeCount( nkeyframeCount ){
+	}
+	
+	virtual void BuildAnimation( deAnimation *animation ){
+		const float playtime = 2.0f;
+		decString name;
+		int i, j;
+		
+		for( i=0; i<boneCount; i++ ){
+			name.Format( "bone%d", i );
+			deAnimationBone * const bone = new deAnimationBone;
+			bone->SetName( name );
+			animation->AddBone( bone );
+		}
+		
+		deAnimationMove * const move = new deAnimationMove;
+		move->SetName( "move" );
+		move->SetPlaytime( playtime );
+		animation->AddMove( move );
+		
+		for( i=0; i<boneCount; i++ ){
+			deAnimationKeyframeList * const list = new deAnimationKeyframeList;
+			move->AddKeyframeList( list );
+			
+			for( j=0; j<keyframeCount; j++ ){
+				const float time = playtime * ( float )j / ( float )( keyframeCount - 1 );
+				const float angle = 0.3f * sinf( time * PI + ( float )i * 0.2f );
+				
+				deAnimationKeyframe * const keyframe = new deAnimationKeyframe;
+				keyframe->SetTime( time );
+				keyframe->SetRotation( decVector( angle, 0.5f * angle, 0.0f ) );
+				keyframe->SetScale( decVector( 1.0f, 1.0f, 1.0f ) );
+				list->AddKeyframe( keyframe );
+			}
+		}
+	}
+};
+
+
+
+// Class dearDeveloperMode
+////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+dearDeveloperMode::dearDeveloperMode( deDEAnimator &module ) :
+pModule( module ),
+pEnabled( false ){
+}
+
+dearDeveloperMode::~dearDeveloperMode(){
+}
+
+
+
+// Management
+///////////////
+
+bool dearDeveloperMode::ExecuteCommand( const decUnicodeArgumentList &command, decUnicodeString &answer ){
+	if( command.MatchesArgumentAt( 0, "dm_enable" ) ){
+		pCmdEnable( command, answer );
+		return true;
+	}
+	
+	if( ! pEnabled ){
+		return false;
+	}
+	
+	if( command.MatchesArgumentAt( 0, "dm_help" ) ){
+		pCmdHelp( command, answer );
+		return true;
+		
+	}else if( command.MatchesArgumentAt( 0, "dm_benchmark_batch" ) ){
+		pCmdBenchmarkBatch( command, answer );
+		return true;
+		
+	}else if( command.MatchesArgumentAt( 0, "dm_benchmark_keyframes" ) ){
+		pCmdBenchmarkKeyframes( command, answer );
+		return true;
+		
+	}else if( command.MatchesArgumentAt( 0, "dm_benchmark_blend" ) ){
+		pCmdBenchmarkBlend( command, answer );
+		return true;
+	}
+	
+	return false;
+}
+
+
+
+// Private functions
+//////////////////////
+
+void dearDeveloperMode::pCmdHelp( const decUnicodeArgumentList &command, decUnicodeString &answer ){
+	answer.SetFromUTF8( "dm_help => Displays this help screen.\n" );
+	answer.AppendFromUTF8( "dm_benchmark_batch [instances] => Benchmark batched against per instance parallel and direct rule application.\n" );
+	answer.AppendFromUTF8( "dm_benchmark_keyframes [bones] [keyframes] => Benchmark sampling uncompressed against compressed keyframe lists.\n" );
+	answer.AppendFromUTF8( "dm_benchmark_blend [bones] => Benchmark scalar against SIMD bone state blending.\n" );
+}
+
+void dearDeveloperMode::pCmdEnable( const decUnicodeArgumentList &command, decUnicodeString &answer ){
+	pEnabled = true;
+	answer.AppendFromUTF8( "Developer Mode is enabled" );
+}
+
+void dearDeveloperMode::pCmdBenchmarkBatch( const decUnicodeArgumentList &command,
+decUnicodeString &answer ){
+	int instanceCount = 500;
+	if( command.GetArgumentCount() > 1 ){
+		instanceCount = decMath::max( command.GetArgumentAt( 1 )->ToInt(), 1 );
+	}
+	
+	deEngine &engine = *pModule.GetGameEngine();
+	const int boneCount = 40;
+	const int frameCount = 20;
+	
+	// temporary animator with a single animation rule driven by a move time controller
+	// applied to components using a chain of bones
+	dearDMBoneChainRigBuilder rigBuilder( boneCount );
+	deRigReference rig;
+	rig.TakeOver( engine.GetRigManager()->CreateRig( "", rigBuilder ) );
+	
+	dearDMBoneChainAnimationBuilder animationBuilder( boneCount, 61 );
+	deAnimationReference animation;
+	animation.TakeOver( engine.GetAnimationManager()->CreateAnimation( "", animationBuilder ) );
+	
+	deAnimatorReference animator;
+	animator.TakeOver( engine.GetAnimatorManager()->CreateAnimator() );
+	animator->SetRig( rig );
+	animator->SetAnimation( animation );
+	
+	deAnimatorController * const controller = new deAnimatorController;
+	controller->SetName( "time" );
+	animator->AddController( controller );
+	
+	deAnimatorLink * const link = new deAnimatorLink;
+	link->SetController( 0 );
+	animator->AddLink( link );
+	
+	deAnimatorRuleAnimation * const rule = new deAnimatorRuleAnimation;
+	rule->SetMoveName( "move" );
+	rule->GetTargetMoveTime().AddLink( 0 );
+	animator->AddRule( rule );
+	rule->FreeReference();
+	
+	decObjectList instances;
+	int i;
+	
+	for( i=0; i<instanceCount; i++ ){
+		deComponentReference component;
+		component.TakeOver( engine.GetComponentManager()->CreateComponent() );
+		component->SetRig( rig );
+		
+		deAnimatorInstanceReference instance;
+		instance.TakeOver( engine.GetAnimatorInstanceManager()->CreateAnimatorInstance() );
+		instance->SetAnimator( animator );
+		instance->SetComponent( component );
+		instances.Add( ( deAnimatorInstance* )instance );
+	}
+	
+	// run all modes with the same number of frames. the batch parameter is restored afterwards
+	const decString paramBatch( pModule.GetParameterValue( "batchApplyRules" ) );
+	float elapsedDirect, elapsedParallel, elapsedBatch;
+	
+	try{
+		pBenchmarkBatchRun( instances, true, 1 ); // warm up
+		elapsedDirect = pBenchmarkBatchRun( instances, true, frameCount );
+		
+		pModule.SetParameterValue( "batchApplyRules", "0" );
+		pBenchmarkBatchRun( instances, false, 1 );
+		elapsedParallel = pBenchmarkBatchRun( instances, false, frameCount );
+		
+		pModule.SetParameterValue( "batchApplyRules", "1" );
+		pBenchmarkBatchRun( instances, false, 1 );
+		elapsedBatch = pBenchmarkBatchRun( instances, false, frameCount );
+		
+	}catch( const deException & ){
+		pModule.SetParameterValue( "batchApplyRules", paramBatch );
+		throw;
+	}
+	
+	pModule.SetParameterValue( "batchApplyRules", paramBatch );
+	
+	decString text;
+	text.Format( "instances=%d bones=%d frames=%d\n", instanceCount, boneCount, frameCount );
+	answer.AppendFromUTF8( text );
+	text.Format( "direct: %.2f ms/frame\n", elapsedDirect * 1e3f / ( float )frameCount );
+	answer.AppendFromUTF8( text );
+	text.Format( "parallel task per instance: %.2f ms/frame (%.2fx)\n",
+		elapsedParallel * 1e3f / ( float )frameCount,
+		elapsedDirect / decMath::max( elapsedParallel, 1e-6f ) );
+	answer.AppendFromUTF8( text );
+	text.Format( "parallel batch: %.2f ms/frame (%.2fx)\n",
+		elapsedBatch * 1e3f / ( float )frameCount,
+		elapsedDirect / decMath::max( elapsedBatch, 1e-6f ) );
+	answer.AppendFromUTF8( text );
+}
+
+float dearDeveloperMode::pBenchmarkBatchRun( const decObjectList &instances, bool direct, int frameCount ){
+	const int count = instances.GetCount();
+	decTimer timer;
+	int i, j;
+	
+	timer.Reset();
+	
+	for( i=0; i<frameCount; i++ ){
+		// instances use a few different move times. instances in the same batch with the
+		// same move time share sampled poses like crowds using the same animation do
+		for( j=0; j<count; j++ ){
+			deAnimatorInstance &instance = *( ( deAnimatorInstance* )instances.GetAt( j ) );
+			instance.GetControllerAt( 0 ).SetCurrentValue( ( float )( ( i + j ) % 8 ) / 8.0f );
+			instance.NotifyControllerChangedAt( 0 );
+			instance.Apply( direct );
+		}
+		
+		for( j=0; j<count; j++ ){
+			( ( deAnimatorInstance* )instances.GetAt( j ) )->GetComponent()->WaitAnimatorTaskFinished();
+		}
+	}
+	
+	return timer.GetElapsedTime();
+}
+
+void dearDeveloperMode::pCmdBenchmarkKeyframes( const decUnicodeArgumentList &command,
+decUnicodeString &answer ){
+	int boneCount = 60;
+	int keyframeCount = 300;
+	if( command.GetArgumentCount() > 1 ){
+		boneCount = decMath::max( command.GetArgumentAt( 1 )->ToInt(), 1 );
+	}
+	if( command.GetArgumentCount() > 2 ){
+		keyframeCount = decMath::max( command.GetArgumentAt( 2 )->ToInt(), 2 );
+	}
+	
+	const float playtime = 2.0f;
+	const int frameCount = 6000; // 100 loops sampled at 60Hz
+	
+	dearDMBoneChainAnimationBuilder builder( boneCount, keyframeCount );
+	deAnimationReference animation;
+	animation.TakeOver( pModule.GetGameEngine()->GetAnimationManager()->CreateAnimation( "", builder ) );
+	const deAnimationMove &move = *animation->GetMove( 0 );
+	
+	decPointerList lists, compressedLists;
+	float elapsedCursor, elapsedSearch, elapsedCompressed;
+	int memory = 0, memoryCompressed = 0, keptCount = 0;
+	float maxPositionError = 0.0f, maxRotationError = 0.0f;
+	int i, j;
+	
+	try{
+		for( i=0; i<boneCount; i++ ){
+			const deAnimationKeyframeList &list = *move.GetKeyframeList( i );
+			
+			dearAnimationKeyframeList * const uncompressed = new dearAnimationKeyframeList( list, false );
+			lists.Add( uncompressed );
+			memory += uncompressed->GetMemoryConsumption();
+			
+			dearAnimationKeyframeList * const compressed = new dearAnimationKeyframeList( list, true );
+			compressedLists.Add( compressed );
+			if( ! compressed->GetCompressed() ){
+				DETHROW( deeInvalidAction );
+			}
+			memoryCompressed += compressed->GetMemoryConsumption();
+			keptCount += compressed->GetCount();
+		}
+		
+		// error of compressed against uncompressed sampling
+		decVector position, positionCompressed, scaling, scalingCompressed;
+		decQuaternion rotation, rotationCompressed;
+		
+		for( i=0; i<boneCount; i++ ){
+			const dearAnimationKeyframeList &uncompressed = *( ( dearAnimationKeyframeList* )lists.GetAt( i ) );
+			const dearAnimationKeyframeList &compressed = *( ( dearAnimationKeyframeList* )compressedLists.GetAt( i ) );
+			
+			for( j=0; j<=120; j++ ){
+				const float time = playtime * ( float )j / 120.0f;
+				uncompressed.Interpolate( time, position, rotation, scaling );
+				compressed.Interpolate( time, positionCompressed, rotationCompressed, scalingCompressed );
+				
+				maxPositionError = decMath::max( maxPositionError, ( positionCompressed - position ).Length() );
+				maxRotationError = decMath::max( maxRotationError, 2.0f * acosf( decMath::clamp(
+					fabsf( rotation.Normalized().Dot( rotationCompressed.Normalized() ) ), 0.0f, 1.0f ) ) );
+			}
+		}
+		
+		pBenchmarkKeyframesRun( lists, true, playtime, 60 ); // warm up
+		elapsedCursor = pBenchmarkKeyframesRun( lists, true, playtime, frameCount );
+		elapsedSearch = pBenchmarkKeyframesRun( lists, false, playtime, frameCount );
+		elapsedCompressed = pBenchmarkKeyframesRun( compressedLists, true, playtime, frameCount );
+		
+	}catch( const deException & ){
+		for( i=0; i<lists.GetCount(); i++ ){
+			delete ( dearAnimationKeyframeList* )lists.GetAt( i );
+		}
+		for( i=0; i<compressedLists.GetCount(); i++ ){
+			delete ( dearAnimationKeyframeList* )compressedLists.GetAt( i );
+		}
+		throw;
+	}
+	
+	for( i=0; i<lists.GetCount(); i++ ){
+		delete ( dearAnimationKeyframeList* )lists.GetAt( i );
+	}
+	for( i=0; i<compressedLists.GetCount(); i++ ){
+		delete ( dearAnimationKeyframeList* )compressedLists.GetAt( i );
+	}
+	
+	const float sampleCount = ( float )boneCount * ( float )frameCount * 1e-6f;
+	decString text;
+	
+	text.Format( "bones=%d keyframes=%d samples=%d\n", boneCount, keyframeCount, boneCount * frameCount );
+	answer.AppendFromUTF8( text );
+	text.Format( "cursor: %.1fM samples/s\n", sampleCount / decMath::max( elapsedCursor, 1e-6f ) );
+	answer.AppendFromUTF8( text );
+	text.Format( "binary search: %.1fM samples/s\n", sampleCount / decMath::max( elapsedSearch, 1e-6f ) );
+	answer.AppendFromUTF8( text );
+	text.Format( "compressed with cursor: %.1fM samples/s\n", sampleCount / decMath::max( elapsedCompressed, 1e-6f ) );
+	answer.AppendFromUTF8( text );
+	text.Format( "memory: %.2fMB uncompressed, %.2fMB compressed with %d of %d keyframes kept\n",
+		( float )memory / 1048576.0f, ( float )memoryCompressed / 1048576.0f,
+		keptCount, boneCount * keyframeCount );
+	answer.AppendFromUTF8( text );
+	text.Format( "compressed maximum error: %.2fmm, %.3f degrees\n",
+		maxPositionError * 1000.0f, maxRotationError * RAD2DEG );
+	answer.AppendFromUTF8( text );
+}
+
+float dearDeveloperMode::pBenchmarkKeyframesRun( const decPointerList &lists, bool cursor,
+float playtime, int frameCount ){
+	const int count = lists.GetCount();
+	int * const cursors = new int[ count ];
+	decVector position, scaling;
+	decQuaternion rotation;
+	decTimer timer;
+	int i, j;
+	
+	for( i=0; i<count; i++ ){
+		cursors[ i ] = -1;
+	}
+	
+	timer.Reset();
+	
+	for( i=0; i<frameCount; i++ ){
+		const float time = fmodf( ( float )i / 60.0f, playtime );
+		
+		for( j=0; j<count; j++ ){
+			const dearAnimationKeyframeList &list = *( ( dearAnimationKeyframeList* )lists.GetAt( j ) );
+			
+			if( cursor ){
+				list.Interpolate( time, cursors[ j ], position, rotation, scaling );
+				
+			}else{
+				list.Interpolate( time, position, rotation, scaling );
+			}
+		}
+	}
+	
+	const float elapsed = timer.GetElapsedTime();
+	delete [] cursors;
+	return elapsed;
+}
+
+void dearDeveloperMode::pCmdBenchmarkBlend( const decUnicodeArgumentList &command,
+decUnicodeString &answer ){
+	int boneCount = 100;
+	if( command.GetArgumentCount() > 1 ){
+		boneCount = decMath::max( command.GetArgumentAt( 1 )->ToInt(), 1 );
+	}
+	
+	const int iterations = 2000;
+	
+	// two state lists with a chain of bones blended with the same buffer. one uses the
+	// scalar kernels and the other the SIMD kernels if supported
+	dearBoneStateList scalarList, simdList;
+	dearBoneStateBuffer buffer;
+	int i;
+	
+	scalarList.SetStateCount( boneCount );
+	scalarList.SetUseSIMD( false );
+	simdList.SetStateCount( boneCount );
+	buffer.SetCount( boneCount );
+	
+	for( i=0; i<boneCount; i++ ){
+		const float angle = ( float )i * 0.1f;
+		const decVector position( 0.0f, 0.1f, 0.0f );
+		const decQuaternion orientation( decQuaternion::CreateFromEuler( angle, 0.5f * angle, 0.0f ) );
+		
+		dearBoneState &scalarState = *scalarList.GetStateAt( i );
+		scalarState.SetPosition( position );
+		scalarState.SetOrientation( orientation );
+		scalarState.SetParentState( i > 0 ? scalarList.GetStateAt( i - 1 ) : NULL );
+		
+		dearBoneState &simdState = *simdList.GetStateAt( i );
+		simdState.SetPosition( position );
+		simdState.SetOrientation( orientation );
+		simdState.SetParentState( i > 0 ? simdList.GetStateAt( i - 1 ) : NULL );
+		
+		buffer.SetAt( i, i, decVector( 0.0f, 0.12f, 0.01f ),
+			decQuaternion::CreateFromEuler( -angle, 0.3f, 0.2f * angle ),
+			decVector( 1.0f, 1.0f, 1.0f ) );
+	}
+	
+	pBenchmarkBlendRun( scalarList, buffer, 10 ); // warm up
+	pBenchmarkBlendRun( simdList, buffer, 10 );
+	
+	const float elapsedScalar = pBenchmarkBlendRun( scalarList, buffer, iterations );
+	const float elapsedSimd = pBenchmarkBlendRun( simdList, buffer, iterations );
+	
+	// both lists received the same operations. compare the results
+	float maxPositionError = 0.0f, maxOrientationError = 0.0f;
+	
+	for( i=0; i<boneCount; i++ ){
+		const dearBoneState &scalarState = *scalarList.GetStateAt( i );
+		const dearBoneState &simdState = *simdList.GetStateAt( i );
+		
+		maxPositionError = decMath::max( maxPositionError, ( simdState.GetGlobalMatrix().GetPosition()
+			- scalarState.GetGlobalMatrix().GetPosition() ).Length() );
+		maxOrientationError = decMath::max( maxOrientationError, 2.0f * acosf( decMath::clamp( fabsf(
+			simdState.GetOrientation().Dot( scalarState.GetOrientation() ) ), 0.0f, 1.0f ) ) );
+	}
+	
+	const float factor = 1e6f / ( float )iterations;
+	decString text;
+	
+	text.Format( "bones=%d iterations=%d simd=%s\n", boneCount, iterations,
+		dearBoneStateList::GetSIMDSupported() ? "sse2" : "unsupported" );
+	answer.AppendFromUTF8( text );
+	text.Format( "scalar: %.2f us/iteration\n", elapsedScalar * factor );
+	answer.AppendFromUTF8( text );
+	text.Format( "simd: %.2f us/iteration (%.2fx)\n", elapsedSimd * factor,
+		elapsedScalar / decMath::max( elapsedSimd, 1e-6f ) );
+	answer.AppendFromUTF8( text );
+	text.Format( "simd maximum error: %.4fmm, %.4f degrees\n",
+		maxPositionError * 1000.0f, maxOrientationError * RAD2DEG );
+	answer.AppendFromUTF8( text );
+}
+
+float dearDeveloperMode::pBenchmarkBlendRun( dearBoneStateList &stateList,
+const dearBoneStateBuffer &buffer, int iterations ){
+	decTimer timer;
+	int i;
+	
+	timer.Reset();
+	
+	// blend and overlay like an animation rule followed by an additive rule
+	for( i=0; i<iterations; i++ ){
+		stateList.BlendWith( buffer, deAnimatorRule::ebmBlend, 0.5f, true, true, true );
+		stateList.BlendWith( buffer, deAnimatorRule::ebmOverlay, 0.1f, true, true, true );
+		stateList.UpdateStates();
+	}
+	
+	return timer.GetElapsedTime();
+}
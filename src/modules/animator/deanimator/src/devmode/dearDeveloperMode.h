@@ -0,0 +1,86 @@
+/* 
+ * Drag[en]gine Animator Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEARDEVELOPERMODE_H_
+#define _DEARDEVELOPERMODE_H_
+
+class deDEAnimator;
+class dearBoneStateBuffer;
+class dearBoneStateList;
+class decObjectList;
+class decPointerList;
+class decUnicodeArgumentList;
+class decUnicodeString;
+
+
+
+/**
+ * \brief Developer Mode.
+ * 
+ * Provides access to the developer mode. This is not required for games
+ * nor editing tools and is used only by the module developers for testing
+ * and trouble shooting.
+ */
+class dearDeveloperMode{
+private:
+	deDEAnimator &pModule;
+	bool pEnabled;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create developer mode. */
+	dearDeveloperMode( deDEAnimator &module );
+	
+	/** \brief Clean up developer mode. */
+	~dearDeveloperMode();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/**
+	 * \brief Executes a command.
+	 * \details If the command is recognized true is returned otherwise false.
+	 */
+	bool ExecuteCommand( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	
+	/** \brief Developer mode is enabled. */
+	inline bool GetEnabled() const{ return pEnabled; }
+	/*@}*/
+	
+	
+	
+private:
+	void pCmdHelp( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	void pCmdEnable( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	void pCmdBenchmarkBatch( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	float pBenchmarkBatchRun( const decObjectList &instances, bool direct, int frameCount );
+	void pCmdBenchmarkKeyframes( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	float pBenchmarkKeyframesRun( const decPointerList &lists, bool cursor, float playtime, int frameCount );
+	void pCmdBenchmarkBlend( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	float pBenchmarkBlendRun( dearBoneStateList &stateList, const dearBoneStateBuffer &buffer, int iterations );
+};
+
+#endif
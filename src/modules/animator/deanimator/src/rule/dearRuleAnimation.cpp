@@ -28,8 +28,8 @@
 #include "../dearBoneStateList.h"
 #include "../animation/dearAnimation.h"
 #include "../animation/dearAnimationMove.h"
-#include "../animation/dearAnimationKeyframe.h"
 #include "../animation/dearAnimationKeyframeList.h"
+#include "../animation/dearAnimationPoseCache.h"
 #include "../dearAnimatorInstance.h"
 
 #include <dragengine/resources/animation/deAnimation.h>
@@ -74,6 +74,8 @@ dearRule( instance, firstLink, rule ),
 pAnimation( rule ),
 
 pMove( NULL ),
+pKeyframeCursors( NULL ),
+pKeyframeCursorCount( 0 ),
 
 pTargetMoveTime( rule.GetTargetMoveTime(), firstLink ),
 
@@ -85,6 +87,9 @@ pEnableSize( rule.GetEnableSize() )
 }
 
 dearRuleAnimation::~dearRuleAnimation(){
+	if( pKeyframeCursors ){
+		delete [] pKeyframeCursors;
+	}
 }
 
 
@@ -113,53 +118,64 @@ DEBUG_RESET_TIMERS;
 	const float moveTime = pMove->GetPlaytime() *
 		decMath::clamp( pTargetMoveTime.GetValue( GetInstance(), pAnimation.GetMoveTime() ), 0.0f, 1.0f );
 	
-	// step through all bones and set animation
+	if( pKeyframeCursorCount != boneCount ){
+		pUpdateKeyframeCursors( boneCount );
+	}
+	
+	// instances of the same animator applied in a batch share sampled poses. the engine rule
+	// is shared by all these instances and identifies the bone mapping used for sampling
+	dearAnimationPoseCache * const poseCache = GetInstance().GetPoseCache();
+	dearBoneStateBuffer *buffer = NULL;
+	
+	if( poseCache ){
+		const dearBoneStateBuffer * const pose = poseCache->GetPose( &pAnimation, pMove, moveTime );
+		if( pose ){
+			stalist.BlendWith( *pose, blendMode, blendFactor, pEnablePosition, pEnableOrientation, pEnableSize );
+DEBUG_PRINT_TIMER;
+			return;
+		}
+		
+		buffer = poseCache->AddPose( &pAnimation, pMove, moveTime );
+	}
+	
+	if( ! buffer ){
+		buffer = &pBoneStateBuffer;
+	}
+	
+	// collect the animation state of all bones then blend them all at once
+	buffer->SetCount( boneCount );
+	
+	decVector * const positions = buffer->GetPositions();
+	decQuaternion * const orientations = buffer->GetOrientations();
+	decVector * const scales = buffer->GetScales();
+	
 	for( i=0; i<boneCount; i++ ){
 		const int animatorBone = GetBoneMappingFor( i );
 		if( animatorBone == -1 ){
+			buffer->SkipAt( i );
 			continue;
 		}
 		
-		dearBoneState &boneState = *stalist.GetStateAt( animatorBone );
-		
 		// determine animation state
-		const int animationBone = boneState.GetAnimationBone();
+		const int animationBone = stalist.GetStateAt( animatorBone )->GetAnimationBone();
 		
 		if( animationBone == -1 ){
-			boneState.BlendWithDefault( blendMode, blendFactor, pEnablePosition, pEnableOrientation, pEnableSize );
+			buffer->SetDefaultAt( i, animatorBone );
+			continue;
+		}
+		
+		// interpolate keyframes at the move time. if there are no keyframes use the default state
+		const dearAnimationKeyframeList &kflist = *pMove->GetKeyframeListAt( animationBone );
+		
+		if( kflist.Interpolate( moveTime, pKeyframeCursors[ i ], positions[ i ], orientations[ i ], scales[ i ] ) ){
+			buffer->SetStateIndexAt( i, animatorBone );
 			
 		}else{
-			// determine keyframe containing the move time
-			const dearAnimationKeyframeList &kflist = *pMove->GetKeyframeListAt( animationBone );
-			const dearAnimationKeyframe * const keyframe = kflist.GetWithTime( moveTime );
-			
-			// if there are no keyframes use the default state
-			if( ! keyframe ){
-				boneState.BlendWithDefault( blendMode, blendFactor, pEnablePosition, pEnableOrientation, pEnableSize );
-				continue;
-			}
-			
-			// calculate bone data
-			const float time = moveTime - keyframe->GetTime();
-			
-			decVector position;
-			decQuaternion orientation;
-			decVector scale( 1.0f, 1.0f, 1.0f );
-			
-			if( pEnablePosition ){
-				position = keyframe->InterpolatePosition( time );
-			}
-			if( pEnableOrientation ){
-				orientation = keyframe->InterpolateRotation( time );
-			}
-			if( pEnableSize ){
-				scale = keyframe->InterpolateScaling( time );
-			}
-			
-			boneState.BlendWith( position, orientation, scale, blendMode,
-				blendFactor, pEnablePosition, pEnableOrientation, pEnableSize );
+			buffer->SetDefaultAt( i, animatorBone );
 		}
 	}
+	
+	stalist.BlendWith( *buffer, blendMode, blendFactor, pEnablePosition, pEnableOrientation, pEnableSize );
 DEBUG_PRINT_TIMER;
 }
 
@@ -188,3 +204,21 @@ void dearRuleAnimation::pUpdateMove(){
 		}
 	}
 }
+
+void dearRuleAnimation::pUpdateKeyframeCursors( int count ){
+	if( pKeyframeCursors ){
+		delete [] pKeyframeCursors;
+		pKeyframeCursors = NULL;
+		pKeyframeCursorCount = 0;
+	}
+	
+	if( count > 0 ){
+		pKeyframeCursors = new int[ count ];
+		pKeyframeCursorCount = count;
+		
+		int i;
+		for( i=0; i<count; i++ ){
+			pKeyframeCursors[ i ] = 0;
+		}
+	}
+}
@@ -23,6 +23,7 @@
 #define _DEARRULEANIMATION_H_
 
 #include "dearRule.h"
+#include "../dearBoneStateBuffer.h"
 
 class dearAnimationMove;
 class deAnimatorRuleAnimation;
@@ -36,6 +37,9 @@ class dearRuleAnimation : public dearRule{
 private:
 	const deAnimatorRuleAnimation &pAnimation;
 	dearAnimationMove *pMove;
+	int *pKeyframeCursors;
+	int pKeyframeCursorCount;
+	dearBoneStateBuffer pBoneStateBuffer;
 	
 	dearControllerTarget pTargetMoveTime;
 	
@@ -66,6 +70,7 @@ public:
 	
 private:
 	void pUpdateMove();
+	void pUpdateKeyframeCursors( int count );
 };
 
 #endif
@@ -30,7 +30,6 @@
 #include "../deDEAnimator.h"
 #include "../animation/dearAnimationMove.h"
 #include "../animation/dearAnimationKeyframeList.h"
-#include "../animation/dearAnimationKeyframe.h"
 #include "../animation/dearAnimation.h"
 #include "../dearAnimatorInstance.h"
 
@@ -120,8 +119,6 @@ DEBUG_RESET_TIMERS;
 	const int boneCount = GetBoneMappingCount();
 	int i;
 	
-	bool newBlendMode = true;//true; // temporary hack
-	
 	// move times
 	const float ltime = pMove1->GetPlaytime() *
 		decMath::clamp( pTargetLeadingMoveTime.GetValue( GetInstance(), pAnimationDifference.GetLeadingMoveTime() ), 0.0f, 1.0f );
@@ -129,93 +126,52 @@ DEBUG_RESET_TIMERS;
 	const float rtime = pMove2->GetPlaytime() *
 		decMath::clamp( pTargetReferenceMoveTime.GetValue( GetInstance(), pAnimationDifference.GetReferenceMoveTime() ), 0.0f, 1.0f );
 	
-	// step through all bones and set animation
+	// collect the difference between the leading and reference state of all bones
+	// then add them to the current state and blend them all at once
+	pBoneStateBuffer.SetCount( boneCount );
+	
+	decVector * const positions = pBoneStateBuffer.GetPositions();
+	decQuaternion * const orientations = pBoneStateBuffer.GetOrientations();
+	decVector * const scales = pBoneStateBuffer.GetScales();
+	
 	for( i=0; i<boneCount; i++ ){
 		const int animatorBone = GetBoneMappingFor( i );
 		if( animatorBone == -1 ){
+			pBoneStateBuffer.SkipAt( i );
 			continue;
 		}
 		
-		dearBoneState &boneState = *stalist.GetStateAt( animatorBone );
-		const int animationBone = boneState.GetAnimationBone();
+		const int animationBone = stalist.GetStateAt( animatorBone )->GetAnimationBone();
 		
 		// if there is no valid bone index there is no difference
 		if( animationBone == -1 ){
+			pBoneStateBuffer.SkipAt( i );
 			continue;
 		}
 		
 		// determine leading animation state
-		const dearAnimationKeyframeList &kflist1 = *pMove1->GetKeyframeListAt( animationBone );
-		const dearAnimationKeyframe * const keyframe1 = kflist1.GetWithTime( ltime );
-		
 		decVector lscale( 1.0f, 1.0f, 1.0f );
 		decQuaternion lorientation;
 		decVector lposition;
 		
-		if( keyframe1 ){
-			const float time = ltime - keyframe1->GetTime();
-			if( pEnablePosition ){
-				lposition = keyframe1->InterpolatePosition( time );
-			}
-			if( pEnableOrientation ){
-				lorientation = keyframe1->InterpolateRotation( time );
-			}
-			if( pEnableSize ){
-				lscale = keyframe1->InterpolateScaling( time );
-			}
-		}
+		pMove1->GetKeyframeListAt( animationBone )->Interpolate( ltime, lposition, lorientation, lscale );
 		
 		// determine reference animation state
-		const dearAnimationKeyframeList &kflist2 = *pMove2->GetKeyframeListAt( animationBone );
-		const dearAnimationKeyframe * const keyframe2 = kflist2.GetWithTime( rtime );
-		
 		decVector rscale( 1.0f, 1.0f, 1.0f );
 		decQuaternion rorientation;
 		decVector rposition;
 		
-		if( keyframe2 ){
-			const float time = rtime - keyframe2->GetTime();
-			if( pEnablePosition ){
-				rposition = keyframe2->InterpolatePosition( time );
-			}
-			if( pEnableOrientation ){
-				rorientation = keyframe2->InterpolateRotation( time );
-			}
-			if( pEnableSize ){
-				rscale = keyframe2->InterpolateScaling( time );
-			}
-		}
+		pMove2->GetKeyframeListAt( animationBone )->Interpolate( rtime, rposition, rorientation, rscale );
 		
-		// blend difference with current state
-		if( newBlendMode ){
-			rposition = boneState.GetPosition() + ( lposition - rposition );
-			rorientation = ( lorientation * rorientation.Conjugate() ) * boneState.GetOrientation();
-			lscale = boneState.GetScale() + ( lscale - rscale );
-			
-		}else{
-			rposition = boneState.GetPosition() + ( lposition - rposition );
-			rorientation = boneState.GetOrientation() + ( lorientation - rorientation );
-			rscale = boneState.GetScale() + ( lscale - rscale );
-			
-			/*
-			if( sourceFactor == 1.0f && destFactor == 0.0f ){
-				boneState->SetPosition( lposition - rposition );
-				boneState->SetOrientation( lorientation - rorientation );
-				//boneState->SetSize( size1 - size2 );
-			}else{
-//				module.LOGINFOFORMAT( "animation difference: bone='%s'->%i drot=(%g,%g,%g,%g)", boneState->GetRigBoneName(), animationBone,
-//					( lorientation - rorientation ).x, ( lorientation - rorientation ).y, ( lorientation - rorientation ).z,
-//					( lorientation - rorientation ).w );
-				boneState->SetPosition( boneState->GetPosition() * destFactor + ( lposition - rposition ) * sourceFactor );
-				boneState->SetOrientation( boneState->GetOrientation() * destFactor + ( lorientation - rorientation ) * sourceFactor );
-				//boneState->SetSize( boneState->GetSize() * destFactor
-				//	+ ( size1 - size2 ) * sourceFactor );
-			}*/
-		}
-		
-		boneState.BlendWith( rposition, rorientation, rscale, blendMode,
-			blendFactor, pEnablePosition, pEnableOrientation, pEnableSize );
+		// difference to add to the current state
+		pBoneStateBuffer.SetStateIndexAt( i, animatorBone );
+		positions[ i ] = lposition - rposition;
+		orientations[ i ] = lorientation * rorientation.Conjugate();
+		scales[ i ] = rscale;
 	}
+	
+	stalist.BlendWithDifference( pBoneStateBuffer, blendMode, blendFactor,
+		pEnablePosition, pEnableOrientation, pEnableSize );
 DEBUG_PRINT_TIMER;
 }
 
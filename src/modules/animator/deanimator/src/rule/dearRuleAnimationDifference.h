@@ -23,6 +23,7 @@
 #define _DEARRULEANIMATIONDIFFERENCE_H_
 
 #include "dearRule.h"
+#include "../dearBoneStateBuffer.h"
 
 class dearAnimationMove;
 class dearAnimationState;
@@ -39,6 +40,7 @@ private:
 	
 	dearAnimationMove *pMove1;
 	dearAnimationMove *pMove2;
+	dearBoneStateBuffer pBoneStateBuffer;
 	 //, pDirtyAnimState;
 //	dearAnimationState *pAnimStates;
 //	int pAnimStateCount;
@@ -30,7 +30,6 @@
 #include "../deDEAnimator.h"
 #include "../animation/dearAnimationMove.h"
 #include "../animation/dearAnimationKeyframeList.h"
-#include "../animation/dearAnimationKeyframe.h"
 #include "../animation/dearAnimation.h"
 #include "../dearAnimatorInstance.h"
 
@@ -146,33 +145,17 @@ DEBUG_RESET_TIMERS;
 			continue;
 		}
 		
-		// determine keyframe containing the move time
+		// interpolate keyframes at the move time
 		const dearAnimationKeyframeList &kflist = *move->GetKeyframeListAt( animationBone );
-		const dearAnimationKeyframe * const keyframe = kflist.GetWithTime( moveTime );
+		decVector position, scale;
+		decQuaternion orientation;
 		
 		// if there are no keyframes use the default state
-		if( ! keyframe ){
+		if( ! kflist.Interpolate( moveTime, position, orientation, scale ) ){
 			boneState.BlendWithDefault( blendMode, blendFactor, pEnablePosition, pEnableOrientation, pEnableSize );
 			continue;
 		}
 		
-		// calculate bone data
-		const float time = moveTime - keyframe->GetTime();
-		
-		decVector position;
-		decQuaternion orientation;
-		decVector scale( 1.0f, 1.0f, 1.0f );
-		
-		if( pEnablePosition ){
-			position = keyframe->InterpolatePosition( time );
-		}
-		if( pEnableOrientation ){
-			orientation = keyframe->InterpolateRotation( time );
-		}
-		if( pEnableSize ){
-			scale = keyframe->InterpolateScaling( time );
-		}
-		
 		boneState.BlendWith( position, orientation, scale, blendMode,
 			blendFactor, pEnablePosition, pEnableOrientation, pEnableSize );
 	}
@@ -188,18 +188,7 @@ DEBUG_RESET_TIMERS;
 		}
 		
 		// apply the state
-		for( i=0; i<boneCount; i++ ){
-			const int animatorBone = GetBoneMappingFor( i );
-			if( animatorBone == -1 ){
-				continue;
-			}
-			
-			const dearBoneState &stateFrom = *pStateList->GetStateAt( animatorBone );
-			dearBoneState &stateTo = *stalist.GetStateAt( animatorBone );
-			
-			stateTo.BlendWith( stateFrom, blendMode, blendFactor,
-				pEnablePosition, pEnableOrientation, pEnableSize );
-		}
+		pBlendStates( stalist, *pStateList, blendMode, blendFactor );
 		break;
 		
 	// apply a blend between two selected rules
@@ -243,34 +232,11 @@ DEBUG_RESET_TIMERS;
 		
 		if( selectIndex < pRuleCount - 1 ){
 			pRules[ selectIndex + 1 ]->Apply( *pStateList2 );
-			
-			for( i=0; i<boneCount; i++ ){
-				const int animatorBone = GetBoneMappingFor( i );
-				if( animatorBone == -1 ){
-					continue;
-				}
-				
-				const dearBoneState &stateFrom = *pStateList2->GetStateAt( animatorBone );
-				dearBoneState &stateTo = *pStateList->GetStateAt( animatorBone );
-				
-				stateTo.BlendWith( stateFrom, deAnimatorRule::ebmBlend, selectBlend,
-					pEnablePosition, pEnableOrientation, pEnableSize );
-			}
+			pBlendStates( *pStateList, *pStateList2, deAnimatorRule::ebmBlend, selectBlend );
 		}
 		
 		// apply the state
-		for( i=0; i<boneCount; i++ ){
-			const int animatorBone = GetBoneMappingFor( i );
-			if( animatorBone == -1 ){
-				continue;
-			}
-			
-			const dearBoneState &stateFrom = *pStateList->GetStateAt( animatorBone );
-			dearBoneState &stateTo = *stalist.GetStateAt( animatorBone );
-			
-			stateTo.BlendWith( stateFrom, blendMode, blendFactor,
-				pEnablePosition, pEnableOrientation, pEnableSize );
-		}
+		pBlendStates( stalist, *pStateList, blendMode, blendFactor );
 		break;
 	}
 DEBUG_PRINT_TIMER;
@@ -337,6 +303,29 @@ void dearRuleGroup::pCleanUp(){
 	}
 }
 
+void dearRuleGroup::pBlendStates( dearBoneStateList &target, const dearBoneStateList &source,
+deAnimatorRule::eBlendModes blendMode, float blendFactor ){
+	const int boneCount = GetBoneMappingCount();
+	int i;
+	
+	pBoneStateBuffer.SetCount( boneCount );
+	
+	for( i=0; i<boneCount; i++ ){
+		const int animatorBone = GetBoneMappingFor( i );
+		if( animatorBone == -1 ){
+			pBoneStateBuffer.SkipAt( i );
+			continue;
+		}
+		
+		const dearBoneState &state = *source.GetStateAt( animatorBone );
+		pBoneStateBuffer.SetAt( i, animatorBone, state.GetPosition(),
+			state.GetOrientation(), state.GetScale() );
+	}
+	
+	target.BlendWith( pBoneStateBuffer, blendMode, blendFactor,
+		pEnablePosition, pEnableOrientation, pEnableSize );
+}
+
 void dearRuleGroup::pCreateRules( int firstLink, const deAnimator &animator, const decIntList &controllerMapping ){
 	const int ruleCount = pGroup.GetRuleCount();
 	if( ruleCount == 0 ){
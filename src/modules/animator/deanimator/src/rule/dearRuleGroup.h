@@ -23,6 +23,7 @@
 #define _DEARRULEGROUP_H_
 
 #include "dearRule.h"
+#include "../dearBoneStateBuffer.h"
 
 #include <dragengine/resources/animator/rule/deAnimatorRuleGroup.h>
 
@@ -45,6 +46,8 @@ private:
 	dearRule **pRules;
 	int pRuleCount;
 	
+	dearBoneStateBuffer pBoneStateBuffer;
+	
 	dearControllerTarget pTargetSelect;
 	
 	const deAnimatorRuleGroup::eApplicationTypes pApplicationType;
@@ -97,6 +100,8 @@ public:
 	
 private:
 	void pCleanUp();
+	void pBlendStates( dearBoneStateList &target, const dearBoneStateList &source,
+		deAnimatorRule::eBlendModes blendMode, float blendFactor );
 	void pCreateRules( int firstLink, const deAnimator &animator, const decIntList &controllerMapping );
 };
 
@@ -32,7 +32,6 @@
 #include "../animation/dearAnimation.h"
 #include "../animation/dearAnimationMove.h"
 #include "../animation/dearAnimationKeyframeList.h"
-#include "../animation/dearAnimationKeyframe.h"
 #include "../component/dearComponent.h"
 #include "../component/dearComponentBoneState.h"
 
@@ -120,6 +119,9 @@ DEBUG_RESET_TIMERS;
 	const int boneCount = GetBoneMappingCount();
 	int i;
 	
+	// collect the state of all bones then blend them all at once
+	pBoneStateBuffer.SetCount( boneCount );
+	
 	if( pUseLastState ){
 		dearComponent * const arcomponent = instance.GetComponent();
 		
@@ -127,28 +129,29 @@ DEBUG_RESET_TIMERS;
 			for( i=0; i<boneCount; i++ ){
 				const int animatorBone = GetBoneMappingFor( i );
 				if( animatorBone == -1 ){
+					pBoneStateBuffer.SkipAt( i );
 					continue;
 				}
 				
-				dearBoneState &state = *stalist.GetStateAt( animatorBone );
-				if( state.GetRigIndex() == -1 ){
+				const int rigIndex = stalist.GetStateAt( animatorBone )->GetRigIndex();
+				if( rigIndex == -1 ){
+					pBoneStateBuffer.SkipAt( i );
 					continue;
 				}
 				
-				stalist.GetStateAt( animatorBone )->BlendWith(
-					arcomponent->GetBoneStateAt( state.GetRigIndex() ), blendMode,
-					blendFactor, pEnablePosition, pEnableOrientation, pEnableSize );
+				const dearComponentBoneState &state = arcomponent->GetBoneStateAt( rigIndex );
+				pBoneStateBuffer.SetAt( i, animatorBone, state.GetPosition(), state.GetRotation(), state.GetScale() );
 			}
 			
 		}else{
 			for( i=0; i<boneCount; i++ ){
 				const int animatorBone = GetBoneMappingFor( i );
 				if( animatorBone == -1 ){
-					continue;
+					pBoneStateBuffer.SkipAt( i );
+					
+				}else{
+					pBoneStateBuffer.SetDefaultAt( i, animatorBone );
 				}
-				
-				stalist.GetStateAt( animatorBone )->BlendWithDefault( blendMode,
-					blendFactor, pEnablePosition, pEnableOrientation, pEnableSize );
 			}
 		}
 		
@@ -156,13 +159,16 @@ DEBUG_RESET_TIMERS;
 		for( i=0; i<boneCount; i++ ){
 			const int animatorBone = GetBoneMappingFor( i );
 			if( animatorBone == -1 ){
+				pBoneStateBuffer.SkipAt( i );
 				continue;
 			}
 			
-			stalist.GetStateAt( animatorBone )->BlendWith( pAnimStates[ i ],
-				blendMode, blendFactor, pEnablePosition, pEnableOrientation, pEnableSize );
+			const dearAnimationState &state = pAnimStates[ i ];
+			pBoneStateBuffer.SetAt( i, animatorBone, state.GetPosition(), state.GetOrientation(), state.GetSize() );
 		}
 	}
+	
+	stalist.BlendWith( pBoneStateBuffer, blendMode, blendFactor, pEnablePosition, pEnableOrientation, pEnableSize );
 DEBUG_PRINT_TIMER;
 }
 
@@ -242,22 +248,20 @@ void dearRuleStateSnapshot::StoreFrameInto( int identifier, const char *moveName
 				continue;
 			}
 			
-			// determine keyframe containing the move time
+			// interpolate keyframes at the move time
 			const dearAnimationKeyframeList &kflist = *move->GetKeyframeListAt( animationBone );
-			const dearAnimationKeyframe * const keyframe = kflist.GetWithTime( moveTime );
+			decVector position, size;
+			decQuaternion orientation;
 			
 			// if there are no keyframes use the default state
-			if( ! keyframe ){
+			if( ! kflist.Interpolate( moveTime, position, orientation, size ) ){
 				pAnimStates[ i ].Reset();
 				continue;
 			}
 			
-			// calculate bone data
-			const float time = moveTime - keyframe->GetTime();
-			
-			pAnimStates[ i ].SetPosition( keyframe->InterpolatePosition( time ) );
-			pAnimStates[ i ].SetOrientation( keyframe->InterpolateRotation( time ) );
-			pAnimStates[ i ].SetSize( keyframe->InterpolateScaling( time ) );
+			pAnimStates[ i ].SetPosition( position );
+			pAnimStates[ i ].SetOrientation( orientation );
+			pAnimStates[ i ].SetSize( size );
 		}
 		
 	}else{
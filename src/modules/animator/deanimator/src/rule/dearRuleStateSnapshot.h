@@ -23,6 +23,7 @@
 #define _DEARRULESTATESNAPSHOT_H_
 
 #include "dearRule.h"
+#include "../dearBoneStateBuffer.h"
 
 class dearAnimationState;
 class deAnimatorRuleStateSnapshot;
@@ -38,6 +39,7 @@ private:
 	
 	dearAnimationState *pAnimStates;
 	int pAnimStateCount;
+	dearBoneStateBuffer pBoneStateBuffer;
 	
 	const bool pEnablePosition;
 	const bool pEnableOrientation;
@@ -0,0 +1,204 @@
+/* 
+ * Drag[en]gine Animator Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dearTaskApplyRulesBatch.h"
+#include "../dearAnimatorInstance.h"
+#include "../deDEAnimator.h"
+#include "../component/dearComponent.h"
+
+#include <dragengine/common/exceptions.h>
+#include <dragengine/resources/component/deComponent.h>
+#include <dragengine/threading/deMutexGuard.h>
+
+
+
+// Definitions
+////////////////
+
+// large enough to keep the task overhead small compared to the work done. small enough
+// to spread many instances across all cores
+#define MAX_INSTANCE_COUNT 32
+
+
+
+// Class dearTaskApplyRulesBatch
+//////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+dearTaskApplyRulesBatch::dearTaskApplyRulesBatch( deDEAnimator &module ) :
+deParallelTask( &module ),
+pStarted( false ),
+pPreviousTaskComponent( NULL ){
+}
+
+dearTaskApplyRulesBatch::~dearTaskApplyRulesBatch(){
+}
+
+
+
+// Management
+///////////////
+
+bool dearTaskApplyRulesBatch::AddInstance( dearAnimatorInstance &instance ){
+	deMutexGuard lock( pMutex );
+	
+	if( pStarted || IsCancelled() || pInstances.GetCount() == MAX_INSTANCE_COUNT ){
+		return false;
+	}
+	
+	pInstances.Add( &instance );
+	return true;
+}
+
+bool dearTaskApplyRulesBatch::RemoveInstance( dearAnimatorInstance &instance ){
+	deMutexGuard lock( pMutex );
+	
+	if( pStarted ){
+		return false;
+	}
+	
+	const int index = pInstances.IndexOf( &instance );
+	if( index != -1 ){
+		pInstances.RemoveFrom( index );
+	}
+	return true;
+}
+
+bool dearTaskApplyRulesBatch::HasOtherInstanceWithComponent(
+const dearAnimatorInstance &instance, const dearComponent *component ) const{
+	// instances are only added and removed by the main thread
+	const int count = pInstances.GetCount();
+	int i;
+	
+	for( i=0; i<count; i++ ){
+		const dearAnimatorInstance * const other = ( const dearAnimatorInstance* )pInstances.GetAt( i );
+		if( other != &instance && other->GetComponent() == component ){
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+void dearTaskApplyRulesBatch::SetPreviousTask( deParallelTask *task, const dearComponent *component ){
+	pPreviousTask = task;
+	pPreviousTaskComponent = task ? component : NULL;
+}
+
+deParallelTask *dearTaskApplyRulesBatch::GetPreviousTask( const dearComponent *component ) const{
+	if( ! pPreviousTask || component != pPreviousTaskComponent ){
+		return NULL;
+	}
+	
+	// the previous task can not be reused while the batch depends on it. if it is not
+	// finished it is still the pending work of the component
+	deParallelTask * const task = ( deParallelTask* )( deThreadSafeObject* )pPreviousTask;
+	return task->GetFinished() ? NULL : task;
+}
+
+
+
+// Subclass Responsibility
+////////////////////////////
+
+void dearTaskApplyRulesBatch::Run(){
+	// no instances can join or leave once started. this makes it safe to access the
+	// instance list without locking from here on
+	deMutexGuard lock( pMutex );
+	pStarted = true;
+	lock.Unlock();
+	
+	const int count = pInstances.GetCount();
+	int i;
+	
+	for( i=0; i<count; i++ ){
+		if( IsCancelled() ){
+			break;
+		}
+		
+		dearAnimatorInstance &instance = *( ( dearAnimatorInstance* )pInstances.GetAt( i ) );
+		
+		instance.SetPoseCache( &pPoseCache );
+		try{
+			instance.ApplyRules();
+			
+		}catch( const deException & ){
+			instance.SetPoseCache( NULL );
+			throw;
+		}
+		instance.SetPoseCache( NULL );
+		
+		instance.ApplyStateToArComponent();
+	}
+	
+	pPoseCache.Clear();
+}
+
+void dearTaskApplyRulesBatch::Finished(){
+	// see dearTaskApplyRules::Finished() for the problems involved. if multiple instances
+	// in the batch affect the same component the first instance updates the component
+	// with the final state and clears the animator task of the component
+	const int count = pInstances.GetCount();
+	int i;
+	
+	for( i=0; i<count; i++ ){
+		dearAnimatorInstance &instance = *( ( dearAnimatorInstance* )pInstances.GetAt( i ) );
+		
+		if( ! IsCancelled() ){
+			dearComponent * const component = instance.GetComponent();
+			if( component && component->GetComponent().GetAnimatorTask() == this ){
+				try{
+					component->UpdateComponent();
+					
+				}catch( const deException & ){
+					for( ; i<count; i++ ){
+						( ( dearAnimatorInstance* )pInstances.GetAt( i ) )->StopTaskApplyRules();
+					}
+					throw;
+				}
+			}
+		}
+		
+		instance.StopTaskApplyRules();
+	}
+}
+
+
+
+// Debugging
+//////////////
+
+decString dearTaskApplyRulesBatch::GetDebugName() const{
+	return "DEAnimator:ApplyRulesBatch";
+}
+
+decString dearTaskApplyRulesBatch::GetDebugDetails() const{
+	decString details;
+	details.Format( "instances=%d", pInstances.GetCount() );
+	return details;
+}
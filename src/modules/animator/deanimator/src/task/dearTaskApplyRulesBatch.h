@@ -0,0 +1,128 @@
+/* 
+ * Drag[en]gine Animator Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef _DEARTASKAPPLYRULESBATCH_H_
+#define _DEARTASKAPPLYRULESBATCH_H_
+
+#include "../animation/dearAnimationPoseCache.h"
+
+#include <dragengine/common/collection/decPointerList.h>
+#include <dragengine/parallel/deParallelTask.h>
+#include <dragengine/threading/deMutex.h>
+#include <dragengine/threading/deThreadSafeObjectReference.h>
+
+class dearAnimatorInstance;
+class dearComponent;
+class deDEAnimator;
+
+
+
+/**
+ * \brief Task applying rules to a batch of animator instance states.
+ * 
+ * Animator instances of the same animator join the batch until the task starts running or
+ * the batch is full. Instances are processed in the order they joined. Poses sampled by
+ * animation rules are shared between the instances using a pose cache.
+ */
+class dearTaskApplyRulesBatch : public deParallelTask{
+private:
+	decPointerList pInstances;
+	bool pStarted;
+	deMutex pMutex;
+	
+	deThreadSafeObjectReference pPreviousTask;
+	const dearComponent *pPreviousTaskComponent;
+	
+	dearAnimationPoseCache pPoseCache;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create task. */
+	dearTaskApplyRulesBatch( deDEAnimator &module );
+	
+	/** \brief Clean up task. */
+	virtual ~dearTaskApplyRulesBatch();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/**
+	 * \brief Add animator instance if the task has not started running and is not full.
+	 * \details Returns \em true if the instance has been added.
+	 */
+	bool AddInstance( dearAnimatorInstance &instance );
+	
+	/**
+	 * \brief Remove animator instance if the task has not started running.
+	 * \details Returns \em true if the instance has been removed.
+	 */
+	bool RemoveInstance( dearAnimatorInstance &instance );
+	
+	/**
+	 * \brief Instance other than \em instance in the batch uses component.
+	 * \warning Call only from main thread.
+	 */
+	bool HasOtherInstanceWithComponent( const dearAnimatorInstance &instance,
+		const dearComponent *component ) const;
+		
+	/**
+	 * \brief Set animator task component had assigned before the batch has been created.
+	 * \details The batch depends on this task.
+	 */
+	void SetPreviousTask( deParallelTask *task, const dearComponent *component );
+	
+	/**
+	 * \brief Animator task to restore if the last instance using component leaves the batch.
+	 * \details Returns NULL if component had no animator task before the batch or if the
+	 *          task is finished.
+	 */
+	deParallelTask *GetPreviousTask( const dearComponent *component ) const;
+	
+	/** \brief Parallel task implementation. */
+	virtual void Run();
+	
+	/**
+	 * \brief Synchronous processing of task Run() finished.
+	 * \details Updates the components of all instances and stops the tasks of all
+	 *          instances. See dearTaskApplyRules::Finished() for details.
+	 */
+	virtual void Finished();
+	/*@}*/
+	
+	
+	
+	/** \name Debugging */
+	/*@{*/
+	/** \brief Short task name for debugging. */
+	virtual decString GetDebugName() const;
+	
+	/** \brief Task details for debugging. */
+	virtual decString GetDebugDetails() const;
+	/*@}*/
+};
+
+#endif
@@ -28,6 +28,7 @@
 #include "deoalAComponentTexture.h"
 #include "../audiothread/deoalAudioThread.h"
 #include "../audiothread/deoalATLogger.h"
+#include "../environment/deoalEnvProbeCache.h"
 #include "../model/deoalAModel.h"
 #include "../model/deoalModelFace.h"
 #include "../model/octree/deoalModelOctree.h"
@@ -40,6 +41,7 @@
 #include <dragengine/common/exceptions.h>
 #include <dragengine/resources/component/deComponent.h>
 #include <dragengine/resources/component/deComponentBone.h>
+#include <dragengine/resources/model/deModel.h>
 #include <dragengine/resources/rig/deRig.h>
 #include <dragengine/resources/rig/deRigBone.h>
 
@@ -59,6 +61,7 @@ pModel( NULL ),
 pSkin( NULL ),
 pAffectsSound( false ),
 pHasScaling( false ),
+pStatic( false ),
 pDirtyMatrices( true ),
 pDirtyWeightMatrices( true ),
 pDirtyExtends( true ),
@@ -113,12 +116,12 @@ void deoalAComponent::UpdateOctreeNode(){
 	if( pParentWorld && pAffectsSound ){
 		pPrepareExtends();
 		pParentWorld->GetOctree()->InsertComponentIntoTree( this, 8 );
-		pParentWorld->InvalidateEnvProbes( pMinExtend, pMaxExtend, pLayerMask );
+		pParentWorld->InvalidateEnvProbes( pMinExtend, pMaxExtend, pLayerMask, pStatic );
 		
 	}else if( pOctreeNode ){
 		pOctreeNode->RemoveComponent( this );
 		if( pParentWorld ){
-			pParentWorld->InvalidateEnvProbes( pMinExtend, pMaxExtend, pLayerMask );
+			pParentWorld->InvalidateEnvProbes( pMinExtend, pMaxExtend, pLayerMask, pStatic );
 		}
 	}
 }
@@ -240,6 +243,18 @@ void deoalAComponent::SetLayerMask( const decLayerMask &layerMask ){
 
 
 
+void deoalAComponent::SetStatic( bool isStatic ){
+	if( isStatic == pStatic ){
+		return;
+	}
+	
+	pStatic = isStatic;
+	
+	if( pParentWorld && pAffectsSound ){
+		pParentWorld->GetEnvProbeCache().StaticGeometryChanged();
+	}
+}
+
 void deoalAComponent::UpdateAffectsSound(){
 	pAffectsSound = false;
 	
@@ -352,11 +367,42 @@ void deoalAComponent::UpdateBoneGeometry( const deComponent &component ){
 	
 	pDirtyWeightMatrices = true;
 	
-	pParentWorld->InvalidateEnvProbes( pMinExtend, pMaxExtend, pLayerMask );
+	// bone geometry is not part of the static geometry hash. invalidate baked probes locally
+	pParentWorld->InvalidateEnvProbes( pMinExtend, pMaxExtend, pLayerMask, false );
 	// NOTE it is possible the invalidate is done here and in an UpdateOctreeNode. check out
 	//      later if this is a performance problem or not
 }
 
+void deoalAComponent::UpdateSharedWeightMatrices( deComponent &component ){
+	if( ! pDirtyWeightMatrices || ! pModel ){
+		return;
+	}
+	
+	// the audio model is built from the last LOD while the engine skins the first LOD
+	const deModel * const model = component.GetModel();
+	if( ! model || component.GetAudioModel() != model || model->GetLODCount() != 1 ){
+		return;
+	}
+	
+	const int weightSetCount = pModel->GetWeightSetCount();
+	if( weightSetCount == 0 || ! component.UseSharedSkinnedWeights( deComponent::esrAudio )
+	|| component.GetSkinnedWeightCount() != weightSetCount ){
+		return;
+	}
+	
+	if( ! pWeightMatrices ){
+		pWeightMatrices = new decMatrix[ weightSetCount ];
+	}
+	
+	const decMatrix * const weights = component.GetSkinnedWeights();
+	int i;
+	for( i=0; i<weightSetCount; i++ ){
+		pWeightMatrices[ i ] = weights[ i ];
+	}
+	
+	pDirtyWeightMatrices = false;
+}
+
 void deoalAComponent::PrepareOctree(){
 	// prepare textures. this has to be done here because GetTextureAt() is potentially called
 	// by concurrent threads
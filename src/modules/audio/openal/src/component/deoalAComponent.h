@@ -82,6 +82,7 @@ private:
 	
 	bool pAffectsSound;
 	bool pHasScaling;
+	bool pStatic;
 	
 	bool pDirtyMatrices;
 	bool pDirtyWeightMatrices;
@@ -215,6 +216,17 @@ public:
 	/** \brief Set layer mask. */
 	void SetLayerMask( const decLayerMask &layerMask );
 	
+	/**
+	 * \brief Component is static geometry.
+	 * 
+	 * Static components are part of the static geometry hash used to bake environment
+	 * probes. Changes to dynamic components invalidate baked environment probes locally.
+	 */
+	inline bool GetStatic() const{ return pStatic; }
+	
+	/** \brief Set if component is static geometry. */
+	void SetStatic( bool isStatic );
+	
 	
 	
 	/** \brief Minimum extend. */
@@ -260,6 +272,15 @@ public:
 	/** \brief Update bone geometry. */
 	void UpdateBoneGeometry( const deComponent &component );
 	
+	/**
+	 * \brief Copy weight matrices skinned by the engine if possible.
+	 * 
+	 * Possible if the audio model is the component model with only one LOD and another
+	 * module skinned the component already. Otherwise weight matrices are calculated
+	 * later on the audio thread. Call only while synchronizing.
+	 */
+	void UpdateSharedWeightMatrices( deComponent &component );
+	
 	/** \brief Dynamic octree or \em NULL to use static model octree. */
 // 	inline deoalModelOctree *GetOctree() const{ return pOctree; }
 	
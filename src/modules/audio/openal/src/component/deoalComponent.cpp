@@ -139,6 +139,7 @@ void deoalComponent::Synchronize(){
 		pAComponent->UpdateBoneGeometry( pComponent );
 		pDirtyBonesGeometry = false;
 	}
+	pAComponent->UpdateSharedWeightMatrices( pComponent );
 	
 	if( pDirtyGeometry ){
 		pAComponent->SetGeometry( pComponent.GetPosition(),
@@ -158,6 +159,7 @@ void deoalComponent::Synchronize(){
 	
 	if( pDirtyOctreeNode ){
 		// depends on affected sound
+		pAComponent->SetStatic( pComponent.GetHintMovement() == deComponent::emhStationary );
 		pAComponent->UpdateOctreeNode();
 		pDirtyOctreeNode = false;
 	}
@@ -262,6 +264,7 @@ void deoalComponent::SkinChanged(){
 	}
 	
 	pDirtySkin = true;
+	pDirtyOctreeNode = true;
 	pDirtyAffectsSound = true;
 	
 	pRequiresSync();
@@ -287,6 +290,7 @@ void deoalComponent::ModelAndSkinChanged(){
 
 void deoalComponent::AudioModelChanged(){
 	pDirtyModel = true;
+	pDirtyOctreeNode = true;
 	
 	if( pDebug ){
 		pDebug->DirtyFaces();
@@ -52,6 +52,8 @@ pEstimateRoomRayCount( 128 ),
 pEAXReverbReflectionGainFactor( 1.0f ),
 pEAXReverbLateReverbGainFactor( 1.0f ),
 
+pEnvProbeCache( false ),
+
 pAsyncAudio( true ),
 pFrameRateLimit( 0 ), // 0 means disabled
 pAsyncAudioSkipSyncTimeRatio( 0.5 )
@@ -192,6 +194,17 @@ void deoalConfiguration::SetEAXReverbLateReverbGainFactor( float factor ){
 
 
 
+void deoalConfiguration::SetEnvProbeCache( bool enable ){
+	if( enable == pEnvProbeCache ){
+		return;
+	}
+	
+	pEnvProbeCache = enable;
+	pDirty = true;
+}
+
+
+
 void deoalConfiguration::SetFrameRateLimit( int frameRateLimit ){
 	if( frameRateLimit == pFrameRateLimit ){
 		return;
@@ -241,6 +254,8 @@ deoalConfiguration &deoalConfiguration::operator=( const deoalConfiguration &con
 	pEAXReverbReflectionGainFactor = config.pEAXReverbReflectionGainFactor;
 	pEAXReverbLateReverbGainFactor = config.pEAXReverbLateReverbGainFactor;
 	
+	pEnvProbeCache = config.pEnvProbeCache;
+	
 	return *this;
 }
 
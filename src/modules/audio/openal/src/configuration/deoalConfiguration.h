@@ -78,6 +78,8 @@ private:
 	float pEAXReverbReflectionGainFactor;
 	float pEAXReverbLateReverbGainFactor;
 	
+	bool pEnvProbeCache;
+	
 	bool pAsyncAudio;
 	int pFrameRateLimit;
 	float pAsyncAudioSkipSyncTimeRatio;
@@ -179,6 +181,19 @@ public:
 	
 	
 	
+	/**
+	 * \brief Reuse environment probes cached across sessions.
+	 * 
+	 * Cached probes are used only if no dynamic components overlap them. They can still be
+	 * outdated if content changes in ways the geometry hash does not cover. Disabled by default.
+	 */
+	inline bool GetEnvProbeCache() const{ return pEnvProbeCache; }
+	
+	/** \brief Set if environment probes cached across sessions are reused. */
+	void SetEnvProbeCache( bool enable );
+	
+	
+	
 	/** \brief Frame rate limit for audio thread. */
 	inline int GetFrameRateLimit() const{ return pFrameRateLimit; }
 	
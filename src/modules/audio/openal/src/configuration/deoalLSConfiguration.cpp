@@ -264,6 +264,9 @@ void deoalLSConfiguration::pLoadConfig( decBaseFileReader *file ){
 		}else if( name == "estimateRoomRayCount" ){
 			pConfig.SetEstimateRoomRayCount( pGetCDataInt( *tag,
 				pConfig.GetEstimateRoomRayCount() ) );
+				
+		}else if( name == "envProbeCache" ){
+			pConfig.SetEnvProbeCache( pGetCDataBool( *tag, pConfig.GetEnvProbeCache() ) );
 		
 		
 		
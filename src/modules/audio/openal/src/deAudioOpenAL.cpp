@@ -33,6 +33,7 @@
 #include "parameters/deoalParameter.h"
 #include "parameters/deoalParameterList.h"
 #include "parameters/deoalPEnableEFX.h"
+#include "parameters/deoalPEnvProbeCache.h"
 #include "parameters/deoalPAurealizationMode.h"
 #include "microphone/deoalMicrophone.h"
 #include "model/deoalModel.h"
@@ -121,6 +122,7 @@ pActiveMicrophone( NULL )
 		pParameters = new deoalParameterList;
 		pParameters->AddParameter( new deoalPEnableEFX( *this ) );
 		pParameters->AddParameter( new deoalPAurealizationMode( *this ) );
+		pParameters->AddParameter( new deoalPEnvProbeCache( *this ) );
 		
 	}catch( const deException &e ){
 		LogException( e );
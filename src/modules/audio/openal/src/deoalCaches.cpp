@@ -27,11 +27,13 @@
 #include "deoalCaches.h"
 #include "deAudioOpenAL.h"
 #include "audiothread/deoalAudioThread.h"
+#include "environment/deoalEnvProbeCacheTask.h"
 
 #include <dragengine/deEngine.h>
 #include <dragengine/common/exceptions.h>
 #include <dragengine/filesystem/deCacheHelper.h>
 #include <dragengine/filesystem/deVirtualFileSystem.h>
+#include <dragengine/parallel/deParallelProcessing.h>
 
 
 
@@ -43,12 +45,16 @@
 
 deoalCaches::deoalCaches( deoalAudioThread &audioThread ) :
 pAudioThread( audioThread ),
-pSound( NULL )
+pSound( NULL ),
+pEnvProbe( NULL )
 {
 	try{
 		pSound = new deCacheHelper( &audioThread.GetOal().GetVFS(),
 			decPath::CreatePathUnix( "/cache/local/sound" ) );
 		
+		pEnvProbe = new deCacheHelper( &audioThread.GetOal().GetVFS(),
+			decPath::CreatePathUnix( "/cache/local/envprobe" ) );
+			
 	}catch( const deException & ){
 		pCleanUp();
 		throw;
@@ -72,12 +78,40 @@ void deoalCaches::Unlock(){
 	pMutex.Unlock();
 }
 
+void deoalCaches::AddEnvProbeTask( deoalEnvProbeCacheTask *task ){
+	if( ! task ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	int i;
+	for( i=pEnvProbeTasks.GetCount()-1; i>=0; i-- ){
+		if( ( ( deoalEnvProbeCacheTask* )pEnvProbeTasks.GetAt( i ) )->GetFinished() ){
+			pEnvProbeTasks.RemoveFrom( i );
+		}
+	}
+	
+	pEnvProbeTasks.Add( task );
+	pAudioThread.GetOal().GetGameEngine()->GetParallelProcessing().AddTaskAsync( task );
+}
+
 
 
 // Private Functions
 //////////////////////
 
 void deoalCaches::pCleanUp(){
+	// tasks can still be pending if worlds have been freed after the parallel tasks
+	// owned by the module have been finished. this flushes pending writes
+	const int taskCount = pEnvProbeTasks.GetCount();
+	int i;
+	for( i=0; i<taskCount; i++ ){
+		( ( deoalEnvProbeCacheTask* )pEnvProbeTasks.GetAt( i ) )->DropCaches();
+	}
+	pEnvProbeTasks.RemoveAll();
+	
+	if( pEnvProbe ){
+		delete pEnvProbe;
+	}
 	if( pSound ){
 		delete pSound;
 	}
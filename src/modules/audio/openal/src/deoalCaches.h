@@ -22,10 +22,12 @@
 #ifndef _DEOALCACHES_H_
 #define _DEOALCACHES_H_
 
+#include <dragengine/common/collection/decThreadSafeObjectOrderedSet.h>
 #include <dragengine/threading/deMutex.h>
 
 class deCacheHelper;
 class deoalAudioThread;
+class deoalEnvProbeCacheTask;
 
 
 
@@ -38,6 +40,9 @@ private:
 	deMutex pMutex;
 	
 	deCacheHelper *pSound;
+	deCacheHelper *pEnvProbe;
+	
+	decThreadSafeObjectOrderedSet pEnvProbeTasks;
 	
 	
 	
@@ -55,6 +60,9 @@ public:
 	
 	/** \name Management */
 	/*@{*/
+	/** \brief Audio thread. */
+	inline deoalAudioThread &GetAudioThread() const{ return pAudioThread; }
+	
 	/** \brief Lock caches. */
 	void Lock();
 	
@@ -64,6 +72,17 @@ public:
 	/** \brief Sound cache. */
 	inline deCacheHelper &GetSound() const{ return *pSound; }
 	
+	/** \brief Environment probe cache. */
+	inline deCacheHelper &GetEnvProbe() const{ return *pEnvProbe; }
+	
+	/**
+	 * \brief Add environment probe cache task to the parallel processing.
+	 * 
+	 * Tasks still pending while the caches are cleaned up are dropped processing pending
+	 * writes and deletes. Call only from the audio thread.
+	 */
+	void AddEnvProbeTask( deoalEnvProbeCacheTask *task );
+	
 	
 	
 private:
@@ -28,9 +28,15 @@
 #include "../extensions/deoalExtensions.h"
 #include "../microphone/deoalMicrophone.h"
 #include "../world/deoalWorld.h"
+#include "../environment/raytrace/deoalIcoSphere.h"
+#include "../environment/raytrace/deoalRayTraceConfig.h"
+#include "../environment/raytrace/visitors/deoalMOVRayHitsClosestPacket.h"
+#include "../model/deoalModelFace.h"
+#include "../model/octree/deoalModelRTBVH.h"
 
 #include <dragengine/deEngine.h>
 #include <dragengine/common/exceptions.h>
+#include <dragengine/common/utils/decTimer.h>
 #include <dragengine/common/string/unicode/decUnicodeString.h>
 #include <dragengine/common/string/unicode/decUnicodeArgumentList.h>
 
@@ -116,6 +122,10 @@ bool deoalDevMode::ExecuteCommand( const decUnicodeArgumentList &command, decUni
 		}else if( command.MatchesArgumentAt( 0, "dm_capture_speaker_direct_closest" ) ){
 			pCmdCaptureSpeakerDirectClosest( command, answer );
 			return true;
+			
+		}else if( command.MatchesArgumentAt( 0, "dm_benchmark_ray_packets" ) ){
+			pCmdBenchmarkRayPackets( command, answer );
+			return true;
 		}
 		
 	}catch( const deException &exception ){
@@ -149,6 +159,8 @@ void deoalDevMode::pCmdHelp( const decUnicodeArgumentList &, decUnicodeString &a
 	answer.AppendFromUTF8( "dm_capture_mic_rays [xray] => Capture microphone sound rays once (visualize).\n" );
 	answer.AppendFromUTF8( "dm_show_audio_models [0|1] => Show audio models.\n" );
 	answer.AppendFromUTF8( "dm_capture_speaker_direct_closest <number> => Capture speaker direct closest.\n" );
+	answer.AppendFromUTF8( "dm_benchmark_ray_packets [subdivisions] => "
+		"Benchmark ray packets against single rays in a test room.\n" );
 }
 
 void deoalDevMode::pCmdEnable( const decUnicodeArgumentList &, decUnicodeString &answer ){
@@ -262,6 +274,210 @@ void deoalDevMode::pCmdCaptureSpeakerDirectClosest( const decUnicodeArgumentList
 }
 
 
+static decVector fAxisVector( int axis, float length ){
+	return decVector( axis == 0 ? length : 0.0f, axis == 1 ? length : 0.0f, axis == 2 ? length : 0.0f );
+}
+
+static void fAddBox( deoalModelFace *faces, int &faceCount, const decVector &center,
+const decVector &halfSize, bool inward, int subdivisions ){
+	const float halfExtends[ 3 ] = { halfSize.x, halfSize.y, halfSize.z };
+	const float factor = 1.0f / ( float )subdivisions;
+	int a, s, i, j;
+	
+	for( a=0; a<3; a++ ){
+		// b and c are chosen so axis b cross axis c equals axis a
+		const int b = ( a + 1 ) % 3;
+		const int c = ( a + 2 ) % 3;
+		
+		for( s=0; s<2; s++ ){
+			const float sign = s == 0 ? 1.0f : -1.0f;
+			const decVector origin( center + fAxisVector( a, halfExtends[ a ] * sign )
+				- fAxisVector( b, halfExtends[ b ] ) - fAxisVector( c, halfExtends[ c ] ) );
+			decVector u( fAxisVector( b, halfExtends[ b ] * 2.0f * factor ) );
+			decVector v( fAxisVector( c, halfExtends[ c ] * 2.0f * factor ) );
+			
+			// faces point outside if u cross v points along the side normal
+			if( ( sign < 0.0f ) != inward ){
+				const decVector temp( u );
+				u = v;
+				v = temp;
+			}
+			
+			for( i=0; i<subdivisions; i++ ){
+				for( j=0; j<subdivisions; j++ ){
+					const decVector p00( origin + u * ( float )i + v * ( float )j );
+					const decVector p10( p00 + u );
+					const decVector p11( p10 + v );
+					const decVector p01( p00 + v );
+					
+					faces[ faceCount ].SetVertex1( p00 );
+					faces[ faceCount ].SetVertex2( p10 );
+					faces[ faceCount ].SetVertex3( p11 );
+					faces[ faceCount++ ].UpdateNormalAndEdges();
+					
+					faces[ faceCount ].SetVertex1( p00 );
+					faces[ faceCount ].SetVertex2( p11 );
+					faces[ faceCount ].SetVertex3( p01 );
+					faces[ faceCount++ ].UpdateNormalAndEdges();
+				}
+			}
+		}
+	}
+}
+
+static float fClosestHitBruteForce( const deoalModelFace *faces, int faceCount,
+const decVector &origin, const decVector &direction ){
+	float closest = 2.0f;
+	int i;
+	
+	for( i=0; i<faceCount; i++ ){
+		const deoalModelFace &face = faces[ i ];
+		const float dot = face.GetNormal() * direction;
+		if( dot > -FLOAT_SAFE_EPSILON ){
+			continue;
+		}
+		
+		const float lambda = ( ( face.GetVertex1() - origin ) * face.GetNormal() ) / dot;
+		if( lambda < 0.0f || lambda > closest ){
+			continue;
+		}
+		
+		const decVector hitPoint( origin + direction * lambda );
+		if( face.GetEdge1Normal() * hitPoint >= face.GetEdge1Distance()
+		&& face.GetEdge2Normal() * hitPoint >= face.GetEdge2Distance()
+		&& face.GetEdge3Normal() * hitPoint >= face.GetEdge3Distance() ){
+			closest = lambda;
+		}
+	}
+	
+	return closest;
+}
+
+void deoalDevMode::pCmdBenchmarkRayPackets( const decUnicodeArgumentList &command, decUnicodeString &answer ){
+	// test room with pillars. does not require an audio device nor a world
+	int subdivisions = 3;
+	if( command.GetArgumentCount() > 1 ){
+		subdivisions = decMath::clamp( command.GetArgumentAt( 1 )->ToUTF8().ToInt(), 0, 5 );
+	}
+	
+	const int wallSubdivisions = 8;
+	const int pillarCount = 4;
+	const int maxFaceCount = 12 * wallSubdivisions * wallSubdivisions + 12 * pillarCount;
+	
+	deoalModelFace * const faces = new deoalModelFace[ maxFaceCount ];
+	deoalModelRTBVH bvh;
+	int faceCount = 0;
+	int i, j, k;
+	
+	try{
+		fAddBox( faces, faceCount, decVector( 0.0f, 3.0f, 0.0f ),
+			decVector( 10.0f, 3.0f, 8.0f ), true, wallSubdivisions );
+			
+		for( i=0; i<pillarCount; i++ ){
+			fAddBox( faces, faceCount, decVector( i % 2 == 0 ? -4.0f : 4.0f, 3.0f,
+				i / 2 == 0 ? -3.0f : 3.0f ), decVector( 0.5f, 3.0f, 0.5f ), false, 1 );
+		}
+		
+		bvh.Build( faces, faceCount );
+		
+		// rays from listener positions in all directions
+		deoalIcoSphere icoSphere( deoalIcoSphere::BaseLevel() );
+		for( i=0; i<subdivisions; i++ ){
+			icoSphere = icoSphere.Subdivide();
+		}
+		
+		deoalRayTraceConfig config;
+		config.SetFromIcoSphere( icoSphere );
+		
+		const decVector origins[ 4 ] = { decVector( 0.0f, 1.6f, 0.0f ),
+			decVector( -7.0f, 1.6f, 5.0f ), decVector( 6.0f, 1.0f, -6.0f ), decVector( 2.0f, 4.5f, 1.0f ) };
+		const int rayCount = config.GetRayCount();
+		const decVector * const directions = config.GetRayDirections();
+		const float rayLength = 40.0f;
+		const int iterations = 20;
+		
+		float * const distancesSingle = new float[ rayCount ];
+		float * const distancesPacket = new float[ rayCount ];
+		deoalMOVRayHitsClosestPacket visitor( NULL );
+		deoalRayTracePacket &packet = visitor.GetPacket();
+		float timeSingle = 0.0f, timePacket = 0.0f;
+		int mismatchCount = 0;
+		decTimer timer;
+		
+		try{
+			for( i=0; i<4; i++ ){
+				const decVector &origin = origins[ i ];
+				
+				// single rays
+				timer.Reset();
+				for( j=0; j<iterations; j++ ){
+					for( k=0; k<rayCount; k++ ){
+						packet.SetRayCount( 1 );
+						packet.SetRayAt( 0, origin, directions[ k ] * rayLength );
+						visitor.VisitBVH( bvh, 1 );
+						distancesSingle[ k ] = visitor.GetResultMask() ? visitor.GetResultDistanceAt( 0 ) : 2.0f;
+					}
+				}
+				timeSingle += timer.GetElapsedTime();
+				
+				// ray packets
+				for( j=0; j<iterations; j++ ){
+					for( k=0; k<rayCount; k+=OAL_RAY_PACKET_SIZE ){
+						const int count = decMath::min( OAL_RAY_PACKET_SIZE, rayCount - k );
+						int l;
+						
+						packet.SetRayCount( count );
+						for( l=0; l<count; l++ ){
+							packet.SetRayAt( l, origin, directions[ k + l ] * rayLength );
+						}
+						
+						visitor.VisitBVH( bvh, packet.GetRayMask() );
+						
+						for( l=0; l<count; l++ ){
+							distancesPacket[ k + l ] = visitor.GetResultMask() & ( 1 << l )
+								? visitor.GetResultDistanceAt( l ) : 2.0f;
+						}
+					}
+				}
+				timePacket += timer.GetElapsedTime();
+				
+				// verify against brute force
+				for( k=0; k<rayCount; k++ ){
+					const float expected = fClosestHitBruteForce( faces, faceCount,
+						origin, directions[ k ] * rayLength );
+					if( fabsf( distancesSingle[ k ] - expected ) > 1e-5f
+					|| fabsf( distancesPacket[ k ] - expected ) > 1e-5f ){
+						mismatchCount++;
+					}
+				}
+			}
+			
+			delete [] distancesSingle;
+			delete [] distancesPacket;
+			
+		}catch( const deException & ){
+			delete [] distancesSingle;
+			delete [] distancesPacket;
+			throw;
+		}
+		
+		const float tracedRays = ( float )( rayCount * iterations * 4 );
+		decString text;
+		text.Format( "dm_benchmark_ray_packets: faces=%d rays=%d packetSize=%d\n"
+			"single: %.1f rays/ms\npacket: %.1f rays/ms (%.2fx)\nmismatches: %d\n",
+			faceCount, rayCount, OAL_RAY_PACKET_SIZE, tracedRays / ( timeSingle * 1e3f ),
+			tracedRays / ( timePacket * 1e3f ), timeSingle / timePacket, mismatchCount );
+		answer.AppendFromUTF8( text );
+		
+		delete [] faces;
+		
+	}catch( const deException & ){
+		delete [] faces;
+		throw;
+	}
+}
+
+
 
 void deoalDevMode::pActiveWorldNotifyDevModeChanged(){
 	if( pOal.GetActiveMicrophone() && pOal.GetActiveMicrophone()->GetParentWorld() ){
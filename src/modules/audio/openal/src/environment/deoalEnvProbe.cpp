@@ -43,6 +43,8 @@
 #include "../soundLevelMeter/deoalASoundLevelMeter.h"
 
 #include <dragengine/common/exceptions.h>
+#include <dragengine/common/file/decBaseFileReader.h>
+#include <dragengine/common/file/decBaseFileWriter.h>
 #include <dragengine/common/utils/decTimer.h>
 
 
@@ -285,6 +287,126 @@ const decDVector &position, deoalASoundLevelMeter *soundLevelMeter ){
 	pCalcListener( listener, world, position, NULL, soundLevelMeter );
 }
 
+void deoalEnvProbe::CopyTraced( const deoalEnvProbe &probe ){
+	Invalidate();
+	
+	pPosition = probe.pPosition;
+	pMinExtend = probe.pMinExtend;
+	pMaxExtend = probe.pMaxExtend;
+	pSoundRayList = probe.pSoundRayList;
+	pRayCount = probe.pRayCount;
+	pRayOpeningAngle = probe.pRayOpeningAngle;
+	
+	pReverberationTimeMedium = probe.pReverberationTimeMedium;
+	pReverberationTimeLow = probe.pReverberationTimeLow;
+	pReverberationTimeHigh = probe.pReverberationTimeHigh;
+	pEchoDelay = probe.pEchoDelay;
+	
+	pRoomCenter = probe.pRoomCenter;
+	pRoomVolume = probe.pRoomVolume;
+	pRoomSurface = probe.pRoomSurface;
+	pRoomSabineLow = probe.pRoomSabineLow;
+	pRoomSabineMedium = probe.pRoomSabineMedium;
+	pRoomSabineHigh = probe.pRoomSabineHigh;
+	pMeanFreePath = probe.pMeanFreePath;
+	pSepTimeFirstLateRefl = probe.pSepTimeFirstLateRefl;
+	pAvgAbsorptionLow = probe.pAvgAbsorptionLow;
+	pAvgAbsorptionMedium = probe.pAvgAbsorptionMedium;
+	pAvgAbsorptionHigh = probe.pAvgAbsorptionHigh;
+	
+	pEstimated = probe.pEstimated;
+}
+
+void deoalEnvProbe::ReadFromFile( decBaseFileReader &reader ){
+	Invalidate();
+	
+	pPosition = reader.ReadDVector();
+	pRange = reader.ReadFloat();
+	pAttenuationRefDist = reader.ReadFloat();
+	pAttenuationRolloff = reader.ReadFloat();
+	
+	pLayerMask.ClearMask();
+	const int layerCount = reader.ReadByte();
+	int i;
+	for( i=0; i<layerCount; i++ ){
+		pLayerMask.SetBit( reader.ReadByte() );
+	}
+	
+	pMinExtend = reader.ReadDVector();
+	pMaxExtend = reader.ReadDVector();
+	pRayCount = reader.ReadInt();
+	pRayOpeningAngle = reader.ReadFloat();
+	
+	pReverberationTimeLow = reader.ReadFloat();
+	pReverberationTimeMedium = reader.ReadFloat();
+	pReverberationTimeHigh = reader.ReadFloat();
+	pEchoDelay = reader.ReadFloat();
+	
+	pRoomCenter = reader.ReadDVector();
+	pRoomVolume = reader.ReadFloat();
+	pRoomSurface = reader.ReadFloat();
+	pRoomSabineLow = reader.ReadFloat();
+	pRoomSabineMedium = reader.ReadFloat();
+	pRoomSabineHigh = reader.ReadFloat();
+	pMeanFreePath = reader.ReadFloat();
+	pSepTimeFirstLateRefl = reader.ReadFloat();
+	pAvgAbsorptionLow = reader.ReadFloat();
+	pAvgAbsorptionMedium = reader.ReadFloat();
+	pAvgAbsorptionHigh = reader.ReadFloat();
+	
+	pSoundRayList.ReadFromFile( reader );
+	
+	pEstimated = false;
+}
+
+void deoalEnvProbe::WriteToFile( decBaseFileWriter &writer ) const{
+	if( pEstimated ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	writer.WriteDVector( pPosition );
+	writer.WriteFloat( pRange );
+	writer.WriteFloat( pAttenuationRefDist );
+	writer.WriteFloat( pAttenuationRolloff );
+	
+	int i, layerCount = 0;
+	for( i=0; i<64; i++ ){
+		if( pLayerMask.IsBitSet( i ) ){
+			layerCount++;
+		}
+	}
+	writer.WriteByte( ( unsigned char )layerCount );
+	for( i=0; i<64; i++ ){
+		if( pLayerMask.IsBitSet( i ) ){
+			writer.WriteByte( ( unsigned char )i );
+		}
+	}
+	
+	writer.WriteDVector( pMinExtend );
+	writer.WriteDVector( pMaxExtend );
+	writer.WriteInt( pRayCount );
+	writer.WriteFloat( pRayOpeningAngle );
+	
+	writer.WriteFloat( pReverberationTimeLow );
+	writer.WriteFloat( pReverberationTimeMedium );
+	writer.WriteFloat( pReverberationTimeHigh );
+	writer.WriteFloat( pEchoDelay );
+	
+	writer.WriteDVector( pRoomCenter );
+	writer.WriteFloat( pRoomVolume );
+	writer.WriteFloat( pRoomSurface );
+	writer.WriteFloat( pRoomSabineLow );
+	writer.WriteFloat( pRoomSabineMedium );
+	writer.WriteFloat( pRoomSabineHigh );
+	writer.WriteFloat( pMeanFreePath );
+	writer.WriteFloat( pSepTimeFirstLateRefl );
+	writer.WriteFloat( pAvgAbsorptionLow );
+	writer.WriteFloat( pAvgAbsorptionMedium );
+	writer.WriteFloat( pAvgAbsorptionHigh );
+	
+	pSoundRayList.WriteToFile( writer );
+}
+
 void deoalEnvProbe::SetLastUsed( unsigned int lastUsed ){
 	pLastUsed = lastUsed;
 }
@@ -41,6 +41,9 @@ class deoalEnvProbeListenerCached;
 class deoalRayTraceConfig;
 class deoalWorldOctree;
 
+class decBaseFileReader;
+class decBaseFileWriter;
+
 
 /**
  * \brief Environment probe.
@@ -330,6 +333,25 @@ public:
 	void CalcListener( deoalEnvProbeListener &listener, deoalAWorld &world,
 		const decDVector &position, deoalASoundLevelMeter *soundLevelMeter );
 	
+	/**
+	 * \brief Copy traced probe data from another probe.
+	 * 
+	 * Copies position, boundaries, room parameters and sound ray list. Range, attenuation,
+	 * layer mask and ray tracing configuration are not copied. The probe needs to be
+	 * re-inserted into the world octree to work properly. The caller is responsible to do this.
+	 */
+	void CopyTraced( const deoalEnvProbe &probe );
+	
+	/**
+	 * \brief Read probe data from file.
+	 * 
+	 * Reads the parameters written by WriteToFile() except the ray tracing configuration.
+	 */
+	void ReadFromFile( decBaseFileReader &reader );
+	
+	/** \brief Write traced probe data to file. */
+	void WriteToFile( decBaseFileWriter &writer ) const;
+	
 	
 	
 	/** \brief Last used. */
@@ -0,0 +1,550 @@
+/* 
+ * Drag[en]gine OpenAL Audio Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "deoalEnvProbe.h"
+#include "deoalEnvProbeCache.h"
+#include "deoalEnvProbeCacheTask.h"
+#include "raytrace/deoalRayTraceConfig.h"
+#include "../deoalCaches.h"
+#include "../audiothread/deoalAudioThread.h"
+#include "../audiothread/deoalATLogger.h"
+#include "../component/deoalAComponent.h"
+#include "../component/deoalAComponentTexture.h"
+#include "../configuration/deoalConfiguration.h"
+#include "../model/deoalAModel.h"
+#include "../world/deoalAWorld.h"
+
+#include <dragengine/common/exceptions.h>
+#include <dragengine/common/file/decBaseFileReader.h>
+#include <dragengine/common/file/decBaseFileReaderReference.h>
+#include <dragengine/common/file/decBaseFileWriter.h>
+#include <dragengine/common/file/decBaseFileWriterReference.h>
+#include <dragengine/common/file/decMemoryFile.h>
+#include <dragengine/common/file/decMemoryFileReader.h>
+#include <dragengine/common/file/decMemoryFileWriter.h>
+
+
+
+// Definitions
+////////////////
+
+// Cache version in the range from 0 to 255. Increment each time the cache
+// format changed. If reaching 256 wrap around to 0. Important is only the
+// number changes to force discarding old caches
+#define CACHE_VERSION 1
+
+#define ENABLE_CACHE_LOGGING false
+
+// Maximum number of cached probes per static geometry. Each probe stores the full sound
+// ray list so this is kept similar to the maximum number of probes of a microphone
+#define MAX_PROBE_COUNT 100
+
+// Time in seconds the static geometry has to stay unchanged before the geometry hash is
+// recalculated. Avoids rehashing all components for each component added at level start
+#define SETTLE_TIME 0.5f
+
+
+
+// Class deoalEnvProbeCache
+/////////////////////////////
+
+// Constructors and Destructors
+/////////////////////////////////
+
+deoalEnvProbeCache::deoalEnvProbeCache( deoalAWorld &world ) :
+pWorld( world ),
+pGeometryHash( 0 ),
+pStaticComponentCount( 0 ),
+pDirtyGeometryHash( true ),
+pChanged( false ),
+pSettleTime( 0.0f ){
+}
+
+deoalEnvProbeCache::~deoalEnvProbeCache(){
+	pRemoveAllProbes();
+}
+
+
+
+// Manegement
+///////////////
+
+void deoalEnvProbeCache::StaticGeometryChanged(){
+	pDirtyGeometryHash = true;
+	pSettleTimer.Reset();
+	pSettleTime = 0.0f;
+}
+
+const deoalEnvProbe *deoalEnvProbeCache::FindProbe( const deoalEnvProbe &probe,
+double reuseDistanceSquared ){
+	if( probe.GetRTConfig() == NULL || ! pUpdate() ){
+		return NULL;
+	}
+	
+	const decDVector &position = probe.GetPosition();
+	const int count = pProbes.GetCount();
+	const deoalEnvProbe *bestProbe = NULL;
+	double bestDistanceSquared = 0.0;
+	sConfig config;
+	int i;
+	
+	pSetConfig( config, probe );
+	
+	for( i=0; i<count; i++ ){
+		const sProbe &entry = *( ( sProbe* )pProbes.GetAt( i ) );
+		const deoalEnvProbe &cached = *entry.probe;
+		
+		const double distanceSquared = ( cached.GetPosition() - position ).LengthSquared();
+		if( distanceSquared > reuseDistanceSquared ){
+			continue;
+		}
+		if( bestProbe && distanceSquared >= bestDistanceSquared ){
+			continue;
+		}
+		
+		if( cached.GetRange() != probe.GetRange()
+		|| cached.GetAttenuationRefDist() != probe.GetAttenuationRefDist()
+		|| cached.GetAttenuationRolloff() != probe.GetAttenuationRolloff()
+		|| cached.GetLayerMask() != probe.GetLayerMask()
+		|| ! pMatchesConfig( entry.config, config ) ){
+			continue;
+		}
+		
+		bestProbe = &cached;
+		bestDistanceSquared = distanceSquared;
+	}
+	
+	return bestProbe;
+}
+
+void deoalEnvProbeCache::AddProbe( const deoalEnvProbe &probe ){
+	if( probe.GetEstimated() || probe.GetRTConfig() == NULL || ! pUpdate() ){
+		return;
+	}
+	
+	if( pStaticComponentCount == 0 || pProbes.GetCount() >= MAX_PROBE_COUNT ){
+		return;
+	}
+	
+	// probes are traced with dynamic components present. caching such probes would
+	// store dynamic geometry as if it is static
+	if( pOverlapsDynamicComponent( probe ) ){
+		return;
+	}
+	
+	sProbe *entry = NULL;
+	
+	try{
+		entry = new sProbe;
+		entry->probe = NULL;
+		pSetConfig( entry->config, probe );
+		
+		entry->probe = new deoalEnvProbe( pWorld.GetAudioThread() );
+		entry->probe->SetRange( probe.GetRange() );
+		entry->probe->SetAttenuation( probe.GetAttenuationRefDist(), probe.GetAttenuationRolloff() );
+		entry->probe->SetLayerMask( probe.GetLayerMask() );
+		entry->probe->CopyTraced( probe );
+		
+		pProbes.Add( entry );
+		
+	}catch( const deException & ){
+		if( entry ){
+			if( entry->probe ){
+				delete entry->probe;
+			}
+			delete entry;
+		}
+		throw;
+	}
+	
+	pChanged = true;
+}
+
+void deoalEnvProbeCache::InvalidateProbesInside( const decDVector &minExtend,
+const decDVector &maxExtend, const decLayerMask &layerMask ){
+	int i;
+	
+	for( i=pProbes.GetCount()-1; i>=0; i-- ){
+		sProbe * const entry = ( sProbe* )pProbes.GetAt( i );
+		const deoalEnvProbe &probe = *entry->probe;
+		
+		if( probe.GetLayerMask().MatchesNot( layerMask ) ){
+			continue;
+		}
+		if( probe.GetMaxExtend() < minExtend || probe.GetMinExtend() > maxExtend ){
+			continue;
+		}
+		
+		pProbes.RemoveFrom( i );
+		delete entry->probe;
+		delete entry;
+		pChanged = true;
+	}
+}
+
+void deoalEnvProbeCache::Save(){
+	// the geometry hash is not updated. cached probes belong to the geometry hash they
+	// have been added with since no probes are added while the geometry hash is dirty
+	if( ! pChanged || pStaticComponentCount == 0 ){
+		return;
+	}
+	
+	const bool enableCacheLogging = ENABLE_CACHE_LOGGING;
+	
+	deoalAudioThread &audioThread = pWorld.GetAudioThread();
+	const decString cacheID( pCacheID() );
+	const int count = pProbes.GetCount();
+	deThreadSafeObjectReference task;
+	
+	pChanged = false;
+	
+	try{
+		// serialize into memory. writing the file is done by the task
+		decMemoryFileReference data;
+		data.TakeOver( new decMemoryFile( cacheID ) );
+		
+		decBaseFileWriterReference writer;
+		writer.TakeOver( new decMemoryFileWriter( data, false ) );
+		writer->WriteByte( CACHE_VERSION );
+		writer->WriteUInt( pGeometryHash );
+		writer->WriteInt( pStaticComponentCount );
+		writer->WriteInt( count );
+		
+		int i;
+		for( i=0; i<count; i++ ){
+			const sProbe &entry = *( ( sProbe* )pProbes.GetAt( i ) );
+			writer->WriteFloat( entry.config.addRayMinLength );
+			writer->WriteInt( entry.config.maxBounceCount );
+			writer->WriteInt( entry.config.maxTransmitCount );
+			writer->WriteFloat( entry.config.thresholdReflect );
+			writer->WriteFloat( entry.config.thresholdTransmit );
+			writer->WriteByte( entry.config.inverseRayTracing ? 1 : 0 );
+			writer->WriteInt( entry.config.rayCount );
+			entry.probe->WriteToFile( writer );
+		}
+		writer = NULL;
+		
+		task.TakeOver( new deoalEnvProbeCacheTask( audioThread.GetCaches(),
+			deoalEnvProbeCacheTask::eoWrite, cacheID, data ) );
+		data = NULL;
+		
+		audioThread.GetCaches().AddEnvProbeTask( ( deoalEnvProbeCacheTask* )( deThreadSafeObject* )task );
+		
+		if( enableCacheLogging ){
+			audioThread.GetLogger().LogInfoFormat( "EnvProbeCache '%s': Writing cache (%d probes)",
+				cacheID.GetString(), count );
+		}
+		
+	}catch( const deException &e ){
+		if( enableCacheLogging ){
+			audioThread.GetLogger().LogException( e );
+			audioThread.GetLogger().LogErrorFormat( "EnvProbeCache '%s': Failed writing cache file",
+				cacheID.GetString() );
+		}
+	}
+}
+
+
+
+// Private Functions
+//////////////////////
+
+static inline unsigned int fHashValue( unsigned int hash, double value, double scale ){
+	// FNV-1a over quantized values. quantizing avoids tiny floating point differences
+	// in component placement producing a different hash
+	const long long quantized = ( long long )floor( value * scale + 0.5 );
+	hash = ( hash ^ ( unsigned int )( quantized & 0xffffffff ) ) * 16777619u;
+	return ( hash ^ ( unsigned int )( quantized >> 32 ) ) * 16777619u;
+}
+
+bool deoalEnvProbeCache::pUpdate(){
+	if( ! pWorld.GetAudioThread().GetConfiguration().GetEnvProbeCache() ){
+		return false;
+	}
+	
+	pFinishLoad();
+	pUpdateGeometryHash();
+	
+	return ! pDirtyGeometryHash && ! pLoadTask;
+}
+
+void deoalEnvProbeCache::pUpdateGeometryHash(){
+	if( ! pDirtyGeometryHash ){
+		return;
+	}
+	
+	pSettleTime += pSettleTimer.GetElapsedTime();
+	if( pSettleTime < SETTLE_TIME ){
+		return;
+	}
+	
+	pDirtyGeometryHash = false;
+	
+	// hash is the sum of the hashes of all static components. this makes the hash
+	// independent of the order components have been added to the world
+	deoalAComponent *component = pWorld.GetRootComponent();
+	unsigned int geometryHash = 0;
+	int staticComponentCount = 0;
+	int i;
+	
+	while( component ){
+		if( component->GetStatic() && component->GetAffectsSound() && component->GetModel() ){
+			const decDVector &position = component->GetPosition();
+			const decQuaternion &orientation = component->GetOrientation();
+			const decVector &scaling = component->GetScaling();
+			const decLayerMask &layerMask = component->GetLayerMask();
+			const int textureCount = component->GetTextureCount();
+			unsigned int hash = component->GetModel()->GetContentHash();
+			
+			hash = fHashValue( hash, position.x, 1000.0 );
+			hash = fHashValue( hash, position.y, 1000.0 );
+			hash = fHashValue( hash, position.z, 1000.0 );
+			hash = fHashValue( hash, orientation.x, 10000.0 );
+			hash = fHashValue( hash, orientation.y, 10000.0 );
+			hash = fHashValue( hash, orientation.z, 10000.0 );
+			hash = fHashValue( hash, orientation.w, 10000.0 );
+			hash = fHashValue( hash, scaling.x, 1000.0 );
+			hash = fHashValue( hash, scaling.y, 1000.0 );
+			hash = fHashValue( hash, scaling.z, 1000.0 );
+			
+			for( i=0; i<64; i++ ){
+				if( layerMask.IsBitSet( i ) ){
+					hash = fHashValue( hash, i, 1.0 );
+				}
+			}
+			
+			// skins and texture overrides change the sound parameters
+			for( i=0; i<textureCount; i++ ){
+				const deoalAComponentTexture &texture = component->GetTextureAt( i );
+				if( ! texture.GetAffectsSound() ){
+					hash = fHashValue( hash, -1.0, 1.0 );
+					continue;
+				}
+				
+				hash = fHashValue( hash, texture.GetAbsorptionLow(), 1000.0 );
+				hash = fHashValue( hash, texture.GetAbsorptionMedium(), 1000.0 );
+				hash = fHashValue( hash, texture.GetAbsorptionHigh(), 1000.0 );
+				hash = fHashValue( hash, texture.GetTransmissionLow(), 1000.0 );
+				hash = fHashValue( hash, texture.GetTransmissionMedium(), 1000.0 );
+				hash = fHashValue( hash, texture.GetTransmissionHigh(), 1000.0 );
+			}
+			
+			geometryHash += hash;
+			staticComponentCount++;
+		}
+		component = component->GetLLWorldNext();
+	}
+	
+	if( geometryHash == pGeometryHash && staticComponentCount == pStaticComponentCount ){
+		return;
+	}
+	
+	// static geometry changed. store probes of the previous static geometry and load the
+	// probes matching the new static geometry. a pending load of the previous static
+	// geometry is obsolete
+	Save();
+	
+	pLoadTask = NULL;
+	pRemoveAllProbes();
+	pChanged = false;
+	pGeometryHash = geometryHash;
+	pStaticComponentCount = staticComponentCount;
+	
+	pLoad();
+}
+
+void deoalEnvProbeCache::pRemoveAllProbes(){
+	const int count = pProbes.GetCount();
+	int i;
+	
+	for( i=0; i<count; i++ ){
+		sProbe * const entry = ( sProbe* )pProbes.GetAt( i );
+		if( entry->probe ){
+			delete entry->probe;
+		}
+		delete entry;
+	}
+	pProbes.RemoveAll();
+}
+
+decString deoalEnvProbeCache::pCacheID() const{
+	decString cacheID;
+	cacheID.Format( "envprobes_%08x_%d", pGeometryHash, pStaticComponentCount );
+	return cacheID;
+}
+
+void deoalEnvProbeCache::pLoad(){
+	if( pStaticComponentCount == 0 ){
+		return;
+	}
+	
+	deoalCaches &caches = pWorld.GetAudioThread().GetCaches();
+	
+	pLoadTask.TakeOver( new deoalEnvProbeCacheTask( caches,
+		deoalEnvProbeCacheTask::eoRead, pCacheID() ) );
+	caches.AddEnvProbeTask( ( deoalEnvProbeCacheTask* )( deThreadSafeObject* )pLoadTask );
+}
+
+void deoalEnvProbeCache::pFinishLoad(){
+	if( ! pLoadTask ){
+		return;
+	}
+	
+	// the task is not touched by other threads once finished. the task reference is
+	// held until the memory file is parsed to keep the memory file alive
+	const deoalEnvProbeCacheTask &task = *( ( deoalEnvProbeCacheTask* )( deThreadSafeObject* )pLoadTask );
+	if( ! task.GetFinished() ){
+		return;
+	}
+	
+	if( task.GetSuccess() && task.GetData() ){
+		pParseCacheFile( task.GetData() );
+	}
+	
+	pLoadTask = NULL;
+}
+
+void deoalEnvProbeCache::pParseCacheFile( decMemoryFile *data ){
+	const bool enableCacheLogging = ENABLE_CACHE_LOGGING;
+	
+	deoalAudioThread &audioThread = pWorld.GetAudioThread();
+	deoalATLogger &logger = audioThread.GetLogger();
+	const decString cacheID( pCacheID() );
+	decBaseFileReaderReference reader;
+	
+	try{
+		reader.TakeOver( new decMemoryFileReader( data ) );
+		
+		// check cache version in case we upgraded and the geometry in case of collisions
+		if( reader->ReadByte() != CACHE_VERSION
+		|| reader->ReadUInt() != pGeometryHash
+		|| reader->ReadInt() != pStaticComponentCount ){
+			DETHROW( deeInvalidFileFormat );
+		}
+		
+		const int count = reader->ReadInt();
+		if( count < 0 || count > MAX_PROBE_COUNT ){
+			DETHROW( deeInvalidFileFormat );
+		}
+		
+		int i;
+		for( i=0; i<count; i++ ){
+			sProbe * const entry = new sProbe;
+			entry->probe = NULL;
+			pProbes.Add( entry );
+			
+			entry->config.addRayMinLength = reader->ReadFloat();
+			entry->config.maxBounceCount = reader->ReadInt();
+			entry->config.maxTransmitCount = reader->ReadInt();
+			entry->config.thresholdReflect = reader->ReadFloat();
+			entry->config.thresholdTransmit = reader->ReadFloat();
+			entry->config.inverseRayTracing = reader->ReadByte() != 0;
+			entry->config.rayCount = reader->ReadInt();
+			
+			entry->probe = new deoalEnvProbe( audioThread );
+			entry->probe->ReadFromFile( reader );
+		}
+		
+		reader = NULL;
+		
+	}catch( const deException & ){
+		// outdated or damaged cache file
+		reader = NULL;
+		pRemoveAllProbes();
+		
+		try{
+			deThreadSafeObjectReference task;
+			task.TakeOver( new deoalEnvProbeCacheTask( audioThread.GetCaches(),
+				deoalEnvProbeCacheTask::eoDelete, cacheID ) );
+			audioThread.GetCaches().AddEnvProbeTask( ( deoalEnvProbeCacheTask* )( deThreadSafeObject* )task );
+			
+		}catch( const deException &e ){
+			logger.LogException( e );
+		}
+		
+		if( enableCacheLogging ){
+			logger.LogInfoFormat( "EnvProbeCache '%s': Cache file outdated or damaged. Cache discarded",
+				cacheID.GetString() );
+		}
+		return;
+	}
+	
+	// dynamic components can be located differently than in the session the probes have
+	// been cached. drop probes overlapping dynamic components
+	int i;
+	for( i=pProbes.GetCount()-1; i>=0; i-- ){
+		sProbe * const entry = ( sProbe* )pProbes.GetAt( i );
+		if( pOverlapsDynamicComponent( *entry->probe ) ){
+			pProbes.RemoveFrom( i );
+			delete entry->probe;
+			delete entry;
+		}
+	}
+	
+	if( enableCacheLogging ){
+		logger.LogInfoFormat( "EnvProbeCache '%s': Loaded %d probes from cache",
+			cacheID.GetString(), pProbes.GetCount() );
+	}
+}
+
+bool deoalEnvProbeCache::pOverlapsDynamicComponent( const deoalEnvProbe &probe ) const{
+	const decDVector &minExtend = probe.GetMinExtend();
+	const decDVector &maxExtend = probe.GetMaxExtend();
+	const decLayerMask &layerMask = probe.GetLayerMask();
+	deoalAComponent *component = pWorld.GetRootComponent();
+	
+	while( component ){
+		if( ! component->GetStatic() && component->GetAffectsSound()
+		&& layerMask.Matches( component->GetLayerMask() )
+		&& component->GetMaxExtend() >= minExtend && component->GetMinExtend() <= maxExtend ){
+			return true;
+		}
+		component = component->GetLLWorldNext();
+	}
+	
+	return false;
+}
+
+void deoalEnvProbeCache::pSetConfig( sConfig &config, const deoalEnvProbe &probe ){
+	const deoalATRayTracing::sConfigSoundTracing &rtConfig = *probe.GetRTConfig();
+	config.addRayMinLength = rtConfig.addRayMinLength;
+	config.maxBounceCount = rtConfig.maxBounceCount;
+	config.maxTransmitCount = rtConfig.maxTransmitCount;
+	config.thresholdReflect = rtConfig.thresholdReflect;
+	config.thresholdTransmit = rtConfig.thresholdTransmit;
+	config.inverseRayTracing = rtConfig.inverseRayTracing;
+	config.rayCount = rtConfig.rtConfig ? rtConfig.rtConfig->GetRayCount() : 0;
+}
+
+bool deoalEnvProbeCache::pMatchesConfig( const sConfig &config, const sConfig &other ){
+	return config.addRayMinLength == other.addRayMinLength
+		&& config.maxBounceCount == other.maxBounceCount
+		&& config.maxTransmitCount == other.maxTransmitCount
+		&& config.thresholdReflect == other.thresholdReflect
+		&& config.thresholdTransmit == other.thresholdTransmit
+		&& config.inverseRayTracing == other.inverseRayTracing
+		&& config.rayCount == other.rayCount;
+}
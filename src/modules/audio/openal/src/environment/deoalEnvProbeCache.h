@@ -0,0 +1,176 @@
+/* 
+ * Drag[en]gine OpenAL Audio Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEOALENVPROBECACHE_H_
+#define _DEOALENVPROBECACHE_H_
+
+#include "../audiothread/deoalATRayTracing.h"
+
+#include <dragengine/common/collection/decPointerList.h>
+#include <dragengine/common/math/decMath.h>
+#include <dragengine/common/string/decString.h>
+#include <dragengine/common/utils/decLayerMask.h>
+#include <dragengine/common/utils/decTimer.h>
+#include <dragengine/threading/deThreadSafeObjectReference.h>
+
+class deoalAWorld;
+class deoalEnvProbe;
+class decMemoryFile;
+
+
+
+/**
+ * \brief Environment probe cache.
+ * 
+ * Stores traced environment probes of a world for static geometry. Probes are written to the
+ * module cache and restored the next time the same static geometry is present in a world.
+ * This avoids the expensive full sound ray tracing at level start. The cache is used only
+ * if enabled in the configuration.
+ * 
+ * Cached probes are identified by a hash calculated from all components affecting sound and
+ * hinted stationary. The hash includes the model content and the sound parameters of the
+ * component textures. Each cache file contains the probes for one geometry hash. If the
+ * static geometry changes the hash is recalculated once the static geometry has not
+ * changed for a short time and the matching cache file is loaded. Cache files are read and
+ * written using parallel tasks. While the hash is dirty or the cache file is loading no
+ * probes are found nor added.
+ * 
+ * Probes are traced with all components present including dynamic ones. Probes overlapping
+ * dynamic components are not cached and loaded probes overlapping dynamic components are
+ * dropped. Changes to dynamic components remove overlapping cached probes.
+ * 
+ * Cached probes are never inserted into the world octree. Environment probe lists copy
+ * matching cached probes into their own probes.
+ */
+class deoalEnvProbeCache{
+public:
+	/** \brief Ray tracing parameters used to trace a cached probe. */
+	struct sConfig{
+		float addRayMinLength;
+		int maxBounceCount;
+		int maxTransmitCount;
+		float thresholdReflect;
+		float thresholdTransmit;
+		bool inverseRayTracing;
+		int rayCount;
+	};
+	
+	
+	
+private:
+	/** \brief Cached probe. */
+	struct sProbe{
+		deoalEnvProbe *probe;
+		sConfig config;
+	};
+	
+	deoalAWorld &pWorld;
+	
+	decPointerList pProbes;
+	unsigned int pGeometryHash;
+	int pStaticComponentCount;
+	bool pDirtyGeometryHash;
+	bool pChanged;
+	
+	decTimer pSettleTimer;
+	float pSettleTime;
+	
+	deThreadSafeObjectReference pLoadTask;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create environment probe cache. */
+	deoalEnvProbeCache( deoalAWorld &world );
+	
+	/** \brief Clean up environment probe cache. */
+	~deoalEnvProbeCache();
+	/*@}*/
+	
+	
+	
+	/** \name Manegement */
+	/*@{*/
+	/** \brief Parent world. */
+	inline deoalAWorld &GetWorld() const{ return pWorld; }
+	
+	/** \brief Hash of static geometry the cached probes belong to. */
+	inline unsigned int GetGeometryHash() const{ return pGeometryHash; }
+	
+	/** \brief Number of static components included in the geometry hash. */
+	inline int GetStaticComponentCount() const{ return pStaticComponentCount; }
+	
+	/** \brief Number of cached probes. */
+	inline int GetProbeCount() const{ return pProbes.GetCount(); }
+	
+	/**
+	 * \brief Static geometry changed.
+	 * 
+	 * The geometry hash is recalculated the next time probes are searched or added once
+	 * the static geometry has not changed for a short time.
+	 */
+	void StaticGeometryChanged();
+	
+	/**
+	 * \brief Find cached probe matching probe parameters.
+	 * 
+	 * Returns the closest cached probe inside reuse distance traced with the same range,
+	 * attenuation, layer mask and ray tracing configuration as \em probe or NULL if absent.
+	 * Returns NULL if the cache is disabled, the static geometry changed recently or the
+	 * cache file is loading.
+	 */
+	const deoalEnvProbe *FindProbe( const deoalEnvProbe &probe, double reuseDistanceSquared );
+	
+	/**
+	 * \brief Add copy of traced probe.
+	 * 
+	 * Estimated probes are ignored. If no static geometry is present, the probe overlaps
+	 * dynamic components or the maximum number of cached probes is reached the probe is
+	 * not added. Probes are also ignored while FindProbe() would return NULL.
+	 */
+	void AddProbe( const deoalEnvProbe &probe );
+	
+	/** \brief Remove cached probes overlapping box in world coordinates. */
+	void InvalidateProbesInside( const decDVector &minExtend, const decDVector &maxExtend,
+		const decLayerMask &layerMask );
+		
+	/** \brief Write cached probes to the module cache if changed using a parallel task. */
+	void Save();
+	/*@}*/
+	
+	
+	
+private:
+	bool pUpdate();
+	void pUpdateGeometryHash();
+	void pRemoveAllProbes();
+	decString pCacheID() const;
+	void pLoad();
+	void pFinishLoad();
+	void pParseCacheFile( decMemoryFile *data );
+	bool pOverlapsDynamicComponent( const deoalEnvProbe &probe ) const;
+	static void pSetConfig( sConfig &config, const deoalEnvProbe &probe );
+	static bool pMatchesConfig( const sConfig &config, const sConfig &other );
+};
+
+#endif
@@ -0,0 +1,349 @@
+/* 
+ * Drag[en]gine OpenAL Audio Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "deoalEnvProbeCacheTask.h"
+#include "../deAudioOpenAL.h"
+#include "../deoalCaches.h"
+#include "../audiothread/deoalAudioThread.h"
+
+#include <dragengine/common/exceptions.h>
+#include <dragengine/common/collection/decPointerList.h>
+#include <dragengine/common/file/decBaseFileReader.h>
+#include <dragengine/common/file/decBaseFileReaderReference.h>
+#include <dragengine/common/file/decBaseFileWriter.h>
+#include <dragengine/common/file/decBaseFileWriterReference.h>
+#include <dragengine/common/file/decMemoryFile.h>
+#include <dragengine/common/utils/decDateTime.h>
+#include <dragengine/filesystem/deCacheHelper.h>
+#include <dragengine/threading/deMutexGuard.h>
+
+
+
+// Definitions
+////////////////
+
+// Index version in the range from 0 to 255. Increment each time the index format changed
+#define INDEX_VERSION 0
+
+#define INDEX_CACHE_ID "envprobes_index"
+
+// Cache files not accessed for this many seconds are deleted (30 days)
+#define MAX_CACHE_AGE ( ( TIME_SYSTEM )30 * 24 * 3600 )
+
+// Cache files are deleted oldest first if the total size exceeds this many bytes (64MB)
+#define MAX_CACHE_SIZE ( 64 * 1024 * 1024 )
+
+struct sIndexEntry{
+	decString cacheID;
+	int size;
+	TIME_SYSTEM accessTime;
+};
+
+
+
+// Class deoalEnvProbeCacheTask
+/////////////////////////////////
+
+// Constructors and Destructors
+/////////////////////////////////
+
+deoalEnvProbeCacheTask::deoalEnvProbeCacheTask( deoalCaches &caches, eOperations operation,
+const char *cacheID, decMemoryFile *data ) :
+deParallelTask( &caches.GetAudioThread().GetOal() ),
+pCaches( &caches ),
+pOperation( operation ),
+pCacheID( cacheID ),
+pData( data ),
+pProcessed( false ),
+pSuccess( false )
+{
+	if( operation == eoWrite && ! data ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	SetMarkFinishedAfterRun( true );
+	SetLowPriority( true );
+}
+
+deoalEnvProbeCacheTask::~deoalEnvProbeCacheTask(){
+}
+
+
+
+// Management
+///////////////
+
+void deoalEnvProbeCacheTask::DropCaches(){
+	deMutexGuard guard( pMutex );
+	
+	if( pCaches && ! pProcessed && pOperation != eoRead ){
+		pProcess();
+	}
+	
+	pCaches = NULL;
+}
+
+void deoalEnvProbeCacheTask::Run(){
+	deMutexGuard guard( pMutex );
+	
+	if( pCaches && ! pProcessed && ! IsCancelled() ){
+		pProcess();
+	}
+}
+
+void deoalEnvProbeCacheTask::Finished(){
+}
+
+
+
+// Debugging
+//////////////
+
+decString deoalEnvProbeCacheTask::GetDebugName() const{
+	return "OpenAL-EnvProbeCache";
+}
+
+decString deoalEnvProbeCacheTask::GetDebugDetails() const{
+	return pCacheID;
+}
+
+
+
+// Private Functions
+//////////////////////
+
+void deoalEnvProbeCacheTask::pProcess(){
+	// called with task mutex held. caches mutex is locked since the cache helper is shared
+	deoalCaches &caches = *pCaches;
+	deCacheHelper &cache = caches.GetEnvProbe();
+	
+	pProcessed = true;
+	
+	caches.Lock();
+	
+	try{
+		switch( pOperation ){
+		case eoRead:{
+			decBaseFileReaderReference reader;
+			reader.TakeOver( cache.Read( pCacheID ) );
+			if( ! reader ){
+				pUpdateIndex( cache, -1 );
+				break;
+			}
+			
+			const int size = reader->GetLength();
+			pData.TakeOver( new decMemoryFile( pCacheID ) );
+			pData->Resize( size );
+			reader->Read( pData->GetPointer(), size );
+			reader = NULL;
+			
+			pUpdateIndex( cache, size );
+			pSuccess = true;
+			}break;
+			
+		case eoWrite:{
+			// update index first. evicting cache files can delete all cache files
+			pUpdateIndex( cache, pData->GetLength() );
+			
+			decBaseFileWriterReference writer;
+			writer.TakeOver( cache.Write( pCacheID ) );
+			writer->Write( pData->GetPointer(), pData->GetLength() );
+			writer = NULL;
+			
+			pData = NULL;
+			pSuccess = true;
+			}break;
+			
+		case eoDelete:
+			cache.Delete( pCacheID );
+			pUpdateIndex( cache, -1 );
+			pSuccess = true;
+			break;
+		}
+		
+	}catch( const deException & ){
+		pData = NULL;
+		pSuccess = false;
+		
+		try{
+			cache.Delete( pCacheID );
+			pUpdateIndex( cache, -1 );
+			
+		}catch( const deException & ){
+		}
+	}
+	
+	caches.Unlock();
+}
+
+void deoalEnvProbeCacheTask::pUpdateIndex( deCacheHelper &cache, int size ){
+	// size is -1 to remove the cache file from the index. otherwise the cache file is
+	// added or updated with the current time as access time
+	const TIME_SYSTEM now = decDateTime::GetSystemTime();
+	decPointerList entries;
+	int i;
+	
+	try{
+		pReadIndex( cache, entries );
+		
+		const int count = entries.GetCount();
+		sIndexEntry *entry = NULL;
+		for( i=0; i<count; i++ ){
+			if( ( ( sIndexEntry* )entries.GetAt( i ) )->cacheID == pCacheID ){
+				entry = ( sIndexEntry* )entries.GetAt( i );
+				break;
+			}
+		}
+		
+		if( size == -1 ){
+			if( entry ){
+				entries.RemoveFrom( entries.IndexOf( entry ) );
+				delete entry;
+			}
+			
+		}else{
+			if( ! entry ){
+				entry = new sIndexEntry;
+				entry->cacheID = pCacheID;
+				entries.Add( entry );
+			}
+			entry->size = size;
+			entry->accessTime = now;
+		}
+		
+		// evict cache files not accessed for a long time
+		int totalSize = 0;
+		
+		for( i=entries.GetCount()-1; i>=0; i-- ){
+			sIndexEntry * const evict = ( sIndexEntry* )entries.GetAt( i );
+			if( evict->cacheID != pCacheID && now - evict->accessTime > MAX_CACHE_AGE ){
+				cache.Delete( evict->cacheID );
+				entries.RemoveFrom( i );
+				delete evict;
+				
+			}else{
+				totalSize += evict->size;
+			}
+		}
+		
+		// evict oldest cache files until the total size is below the limit
+		while( totalSize > MAX_CACHE_SIZE ){
+			const int evictCount = entries.GetCount();
+			sIndexEntry *evict = NULL;
+			
+			for( i=0; i<evictCount; i++ ){
+				sIndexEntry * const check = ( sIndexEntry* )entries.GetAt( i );
+				if( check->cacheID != pCacheID && ( ! evict || check->accessTime < evict->accessTime ) ){
+					evict = check;
+				}
+			}
+			
+			if( ! evict ){
+				break;
+			}
+			
+			totalSize -= evict->size;
+			cache.Delete( evict->cacheID );
+			entries.RemoveFrom( entries.IndexOf( evict ) );
+			delete evict;
+		}
+		
+		pWriteIndex( cache, entries );
+		
+	}catch( const deException & ){
+		pFreeIndex( entries );
+		throw;
+	}
+	
+	pFreeIndex( entries );
+}
+
+void deoalEnvProbeCacheTask::pReadIndex( deCacheHelper &cache, decPointerList &entries ){
+	decBaseFileReaderReference reader;
+	
+	try{
+		reader.TakeOver( cache.Read( INDEX_CACHE_ID ) );
+		
+	}catch( const deException & ){
+	}
+	
+	if( reader ){
+		try{
+			if( reader->ReadByte() != INDEX_VERSION ){
+				DETHROW( deeInvalidFileFormat );
+			}
+			
+			const int count = reader->ReadInt();
+			if( count < 0 ){
+				DETHROW( deeInvalidFileFormat );
+			}
+			
+			int i;
+			for( i=0; i<count; i++ ){
+				sIndexEntry * const entry = new sIndexEntry;
+				entries.Add( entry );
+				entry->cacheID = reader->ReadString8();
+				entry->size = reader->ReadInt();
+				entry->accessTime = ( TIME_SYSTEM )reader->ReadLong();
+			}
+			return;
+			
+		}catch( const deException & ){
+			pFreeIndex( entries );
+		}
+	}
+	
+	// index is absent or damaged. cache files not listed in the index are never evicted.
+	// delete all cache files to start with an empty index
+	reader = NULL;
+	cache.DeleteAll();
+}
+
+void deoalEnvProbeCacheTask::pWriteIndex( deCacheHelper &cache, const decPointerList &entries ){
+	const int count = entries.GetCount();
+	decBaseFileWriterReference writer;
+	int i;
+	
+	writer.TakeOver( cache.Write( INDEX_CACHE_ID ) );
+	writer->WriteByte( INDEX_VERSION );
+	writer->WriteInt( count );
+	
+	for( i=0; i<count; i++ ){
+		const sIndexEntry &entry = *( ( sIndexEntry* )entries.GetAt( i ) );
+		writer->WriteString8( entry.cacheID );
+		writer->WriteInt( entry.size );
+		writer->WriteLong( entry.accessTime );
+	}
+}
+
+void deoalEnvProbeCacheTask::pFreeIndex( decPointerList &entries ){
+	const int count = entries.GetCount();
+	int i;
+	
+	for( i=0; i<count; i++ ){
+		delete ( sIndexEntry* )entries.GetAt( i );
+	}
+	entries.RemoveAll();
+}
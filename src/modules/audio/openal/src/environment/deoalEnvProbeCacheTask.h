@@ -0,0 +1,153 @@
+/* 
+ * Drag[en]gine OpenAL Audio Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEOALENVPROBECACHETASK_H_
+#define _DEOALENVPROBECACHETASK_H_
+
+#include <dragengine/common/file/decMemoryFileReference.h>
+#include <dragengine/common/string/decString.h>
+#include <dragengine/parallel/deParallelTask.h>
+#include <dragengine/threading/deMutex.h>
+
+class deoalCaches;
+class deCacheHelper;
+class decPointerList;
+
+
+
+/**
+ * \brief Environment probe cache file task.
+ * 
+ * Reads, writes or deletes an environment probe cache file outside the audio thread.
+ * Serializing and parsing the probes is done by the audio thread using memory files.
+ * 
+ * The task keeps an index of all cache files storing the size and last access time.
+ * Cache files not accessed for a long time or exceeding the total size limit are deleted
+ * oldest first each time a cache file is written.
+ * 
+ * The task is registered with the caches. If the caches are cleaned up before the task
+ * runs the caches drop the task. Pending write and delete operations are then processed
+ * right away while pending read operations are discarded.
+ */
+class deoalEnvProbeCacheTask : public deParallelTask{
+public:
+	/** \brief Operation. */
+	enum eOperations{
+		/** \brief Read cache file into memory file. */
+		eoRead,
+		
+		/** \brief Write memory file to cache file. */
+		eoWrite,
+		
+		/** \brief Delete cache file. */
+		eoDelete
+	};
+	
+	
+	
+private:
+	deMutex pMutex;
+	deoalCaches *pCaches;
+	eOperations pOperation;
+	decString pCacheID;
+	decMemoryFileReference pData;
+	bool pProcessed;
+	bool pSuccess;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/**
+	 * \brief Create task.
+	 * 
+	 * For write operation \em data is the content to write. Task takes over the
+	 * memory file. Caller has to drop all references to \em data.
+	 */
+	deoalEnvProbeCacheTask( deoalCaches &caches, eOperations operation,
+		const char *cacheID, decMemoryFile *data = NULL );
+		
+protected:
+	/** \brief Clean up task. */
+	virtual ~deoalEnvProbeCacheTask();
+	/*@}*/
+	
+	
+	
+public:
+	/** \name Management */
+	/*@{*/
+	/** \brief Operation. */
+	inline eOperations GetOperation() const{ return pOperation; }
+	
+	/** \brief Cache identifier. */
+	inline const decString &GetCacheID() const{ return pCacheID; }
+	
+	/**
+	 * \brief Operation succeeded.
+	 * 
+	 * For read operations false if the cache file is absent. Valid once the task finished.
+	 */
+	inline bool GetSuccess() const{ return pSuccess; }
+	
+	/** \brief Read content or NULL. Valid once the task finished. */
+	inline decMemoryFile *GetData() const{ return pData; }
+	
+	/**
+	 * \brief Drop caches.
+	 * 
+	 * Called by caches during clean up. Waits for the task to finish if running.
+	 * Processes write and delete operations if not run yet.
+	 */
+	void DropCaches();
+	
+	
+	
+	/** \brief Parallel task implementation. */
+	virtual void Run();
+	
+	/** \brief Processing of task Run() finished. */
+	virtual void Finished();
+	/*@}*/
+	
+	
+	
+	/** \name Debugging */
+	/*@{*/
+	/** \brief Short task name for debugging. */
+	virtual decString GetDebugName() const;
+	
+	/** \brief Task details for debugging. */
+	virtual decString GetDebugDetails() const;
+	/*@}*/
+	
+	
+	
+private:
+	void pProcess();
+	void pUpdateIndex( deCacheHelper &cache, int size );
+	void pReadIndex( deCacheHelper &cache, decPointerList &entries );
+	void pWriteIndex( deCacheHelper &cache, const decPointerList &entries );
+	void pFreeIndex( decPointerList &entries );
+};
+
+#endif
@@ -24,6 +24,7 @@
 #include <string.h>
 
 #include "deoalEnvProbe.h"
+#include "deoalEnvProbeCache.h"
 #include "deoalEnvProbeList.h"
 #include "raytrace/deoalRayTraceConfig.h"
 #include "raytrace/parallel/deoalRTParallelEnvProbe.h"
@@ -250,7 +251,7 @@ deoalEnvProbe *deoalEnvProbeList::GetProbeTraceSoundRays( const decDVector &posi
 			bestProbe->SetLayerMask( pLayerMask );
 			bestProbe->SetRTConfig( pRTConfig );
 			bestProbe->SetLastUsed( pLastUsedCounter );
-			bestProbe->TraceSoundRays( pWorld, pRTWorldBVH, rtconfig );
+			pTraceSoundRays( *bestProbe, rtconfig );
 			pWorld.GetOctree()->IndexOfEnvProbe( bestProbe );
 		}
 		
@@ -266,7 +267,7 @@ deoalEnvProbe *deoalEnvProbeList::GetProbeTraceSoundRays( const decDVector &posi
 		
 		probe->SetPosition( position );
 		probe->SetLastUsed( pLastUsedCounter );
-		probe->TraceSoundRays( pWorld, pRTWorldBVH, rtconfig );
+		pTraceSoundRays( *probe, rtconfig );
 		pWorld.GetOctree()->InsertEnvProbeIntoTree( probe, 8 );
 		return probe;
 	}
@@ -289,7 +290,7 @@ deoalEnvProbe *deoalEnvProbeList::GetProbeTraceSoundRays( const decDVector &posi
 		oldestProbe->Invalidate();
 		oldestProbe->SetPosition( position );
 		oldestProbe->SetLastUsed( pLastUsedCounter );
-		oldestProbe->TraceSoundRays( pWorld, pRTWorldBVH, rtconfig );
+		pTraceSoundRays( *oldestProbe, rtconfig );
 		pWorld.GetOctree()->InsertEnvProbeIntoTree( oldestProbe, 8 );
 		return oldestProbe;
 	}
@@ -305,7 +306,7 @@ deoalEnvProbe *deoalEnvProbeList::GetProbeTraceSoundRays( const decDVector &posi
 		probe->SetLayerMask( pLayerMask );
 		probe->SetRTConfig( pRTConfig );
 		probe->SetLastUsed( pLastUsedCounter );
-		probe->TraceSoundRays( pWorld, pRTWorldBVH, rtconfig );
+		pTraceSoundRays( *probe, rtconfig );
 		pProbes.Add( probe );
 		
 	}catch( const deException &e ){
@@ -379,6 +380,21 @@ int deoalEnvProbeList::GetValidProbeCount() const{
 // Private Functions
 //////////////////////
 
+void deoalEnvProbeList::pTraceSoundRays( deoalEnvProbe &probe, const deoalRayTraceConfig &rtconfig ){
+	// use cached probe traced against the same static geometry if enabled and present.
+	// cached probes never overlap dynamic components. they can still be outdated if
+	// content changes in ways the geometry hash does not cover hence the cache is opt-in
+	deoalEnvProbeCache &cache = pWorld.GetEnvProbeCache();
+	const deoalEnvProbe * const cachedProbe = cache.FindProbe( probe, pReuseDistanceSquared );
+	if( cachedProbe ){
+		probe.CopyTraced( *cachedProbe );
+		return;
+	}
+	
+	probe.TraceSoundRays( pWorld, pRTWorldBVH, rtconfig );
+	cache.AddProbe( probe );
+}
+
 #if 0
 void deoalEnvProbeList::pCreateProbeConfig(){
 	// store constant somewhere. as measurement an ico-sphere can be used in Blender.
@@ -31,6 +31,7 @@
 class deoalAWorld;
 class deoalRTWorldBVH;
 class deoalEnvProbe;
+class deoalRayTraceConfig;
 
 
 
@@ -184,6 +185,11 @@ public:
 	/** \brief Number of valid proves. */
 	int GetValidProbeCount() const;
 	/*@}*/
+	
+	
+	
+private:
+	void pTraceSoundRays( deoalEnvProbe &probe, const deoalRayTraceConfig &rtconfig );
 };
 
 #endif
@@ -0,0 +1,338 @@
+/* 
+ * Drag[en]gine OpenAL Audio Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "deoalRayTracePacket.h"
+
+#include <dragengine/common/exceptions.h>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define OAL_RAYPACKET_SSE 1
+#include <emmintrin.h>
+#endif
+
+
+
+// Definitions
+////////////////
+
+// inverse direction used for axes the ray is parallel to. large enough to push the
+// slab distances out of the [0..1] range but small enough to not produce infinity
+#define INV_DIR_PARALLEL 1e30f
+
+
+
+// Class deoalRayTracePacket
+//////////////////////////////
+
+// Constructors and Destructors
+/////////////////////////////////
+
+deoalRayTracePacket::deoalRayTracePacket() :
+pRayCount( 0 ){
+	SetRayCount( 0 );
+}
+
+deoalRayTracePacket::~deoalRayTracePacket(){
+}
+
+
+
+// Management
+///////////////
+
+void deoalRayTracePacket::SetRayCount( int count ){
+	if( count < 0 || count > OAL_RAY_PACKET_SIZE ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	pRayCount = count;
+	
+	int i;
+	for( i=count; i<OAL_RAY_PACKET_SIZE; i++ ){
+		pOriginX[ i ] = 0.0f;
+		pOriginY[ i ] = 0.0f;
+		pOriginZ[ i ] = 0.0f;
+		pDirectionX[ i ] = 0.0f;
+		pDirectionY[ i ] = 0.0f;
+		pDirectionZ[ i ] = 0.0f;
+		pInvDirectionX[ i ] = INV_DIR_PARALLEL;
+		pInvDirectionY[ i ] = INV_DIR_PARALLEL;
+		pInvDirectionZ[ i ] = INV_DIR_PARALLEL;
+		pLimitDistance[ i ] = -1.0f;
+	}
+}
+
+decVector deoalRayTracePacket::GetRayOriginAt( int index ) const{
+	if( index < 0 || index >= pRayCount ){
+		DETHROW( deeInvalidParam );
+	}
+	return decVector( pOriginX[ index ], pOriginY[ index ], pOriginZ[ index ] );
+}
+
+decVector deoalRayTracePacket::GetRayDirectionAt( int index ) const{
+	if( index < 0 || index >= pRayCount ){
+		DETHROW( deeInvalidParam );
+	}
+	return decVector( pDirectionX[ index ], pDirectionY[ index ], pDirectionZ[ index ] );
+}
+
+void deoalRayTracePacket::SetRayAt( int index, const decVector &origin, const decVector &direction ){
+	if( index < 0 || index >= pRayCount ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	pOriginX[ index ] = origin.x;
+	pOriginY[ index ] = origin.y;
+	pOriginZ[ index ] = origin.z;
+	pDirectionX[ index ] = direction.x;
+	pDirectionY[ index ] = direction.y;
+	pDirectionZ[ index ] = direction.z;
+	
+	if( fabsf( direction.x ) > FLOAT_SAFE_EPSILON ){
+		pInvDirectionX[ index ] = 1.0f / direction.x;
+		
+	}else{
+		pInvDirectionX[ index ] = INV_DIR_PARALLEL;
+	}
+	
+	if( fabsf( direction.y ) > FLOAT_SAFE_EPSILON ){
+		pInvDirectionY[ index ] = 1.0f / direction.y;
+		
+	}else{
+		pInvDirectionY[ index ] = INV_DIR_PARALLEL;
+	}
+	
+	if( fabsf( direction.z ) > FLOAT_SAFE_EPSILON ){
+		pInvDirectionZ[ index ] = 1.0f / direction.z;
+		
+	}else{
+		pInvDirectionZ[ index ] = INV_DIR_PARALLEL;
+	}
+	
+	pLimitDistance[ index ] = 1.0f;
+}
+
+float deoalRayTracePacket::GetLimitDistanceAt( int index ) const{
+	if( index < 0 || index >= pRayCount ){
+		DETHROW( deeInvalidParam );
+	}
+	return pLimitDistance[ index ];
+}
+
+void deoalRayTracePacket::SetLimitDistanceAt( int index, float limitDistance ){
+	if( index < 0 || index >= pRayCount ){
+		DETHROW( deeInvalidParam );
+	}
+	pLimitDistance[ index ] = limitDistance;
+}
+
+decVector deoalRayTracePacket::GetDirectionSum( int mask ) const{
+	decVector sum;
+	int i;
+	for( i=0; i<pRayCount; i++ ){
+		if( mask & ( 1 << i ) ){
+			sum.x += pDirectionX[ i ];
+			sum.y += pDirectionY[ i ];
+			sum.z += pDirectionZ[ i ];
+		}
+	}
+	return sum;
+}
+
+
+
+int deoalRayTracePacket::HitsBox( const decVector &center, const decVector &halfExtends, int mask ) const{
+#ifdef OAL_RAYPACKET_SSE
+	// slab test. for each axis the distances to the two box planes are calculated. the
+	// ray enters the box at the largest near distance and leaves it at the smallest far
+	// distance. rays starting inside the box have a negative near distance clamped to 0
+	const __m128 minX = _mm_set1_ps( center.x - halfExtends.x );
+	const __m128 minY = _mm_set1_ps( center.y - halfExtends.y );
+	const __m128 minZ = _mm_set1_ps( center.z - halfExtends.z );
+	const __m128 maxX = _mm_set1_ps( center.x + halfExtends.x );
+	const __m128 maxY = _mm_set1_ps( center.y + halfExtends.y );
+	const __m128 maxZ = _mm_set1_ps( center.z + halfExtends.z );
+	
+	const __m128 originX = _mm_loadu_ps( pOriginX );
+	const __m128 originY = _mm_loadu_ps( pOriginY );
+	const __m128 originZ = _mm_loadu_ps( pOriginZ );
+	const __m128 invDirX = _mm_loadu_ps( pInvDirectionX );
+	const __m128 invDirY = _mm_loadu_ps( pInvDirectionY );
+	const __m128 invDirZ = _mm_loadu_ps( pInvDirectionZ );
+	
+	const __m128 x1 = _mm_mul_ps( _mm_sub_ps( minX, originX ), invDirX );
+	const __m128 x2 = _mm_mul_ps( _mm_sub_ps( maxX, originX ), invDirX );
+	const __m128 y1 = _mm_mul_ps( _mm_sub_ps( minY, originY ), invDirY );
+	const __m128 y2 = _mm_mul_ps( _mm_sub_ps( maxY, originY ), invDirY );
+	const __m128 z1 = _mm_mul_ps( _mm_sub_ps( minZ, originZ ), invDirZ );
+	const __m128 z2 = _mm_mul_ps( _mm_sub_ps( maxZ, originZ ), invDirZ );
+	
+	const __m128 nearDist = _mm_max_ps( _mm_max_ps( _mm_min_ps( x1, x2 ), _mm_min_ps( y1, y2 ) ),
+		_mm_max_ps( _mm_min_ps( z1, z2 ), _mm_setzero_ps() ) );
+	const __m128 farDist = _mm_min_ps( _mm_min_ps( _mm_max_ps( x1, x2 ), _mm_max_ps( y1, y2 ) ),
+		_mm_min_ps( _mm_max_ps( z1, z2 ), _mm_set1_ps( 1.0f ) ) );
+		
+	const __m128 hits = _mm_and_ps( _mm_cmple_ps( nearDist, farDist ),
+		_mm_cmplt_ps( nearDist, _mm_loadu_ps( pLimitDistance ) ) );
+		
+	return _mm_movemask_ps( hits ) & mask;
+	
+#else
+	const decVector boxMin( center - halfExtends );
+	const decVector boxMax( center + halfExtends );
+	int hits = 0;
+	int i;
+	
+	for( i=0; i<pRayCount; i++ ){
+		if( ! ( mask & ( 1 << i ) ) ){
+			continue;
+		}
+		
+		const float x1 = ( boxMin.x - pOriginX[ i ] ) * pInvDirectionX[ i ];
+		const float x2 = ( boxMax.x - pOriginX[ i ] ) * pInvDirectionX[ i ];
+		const float y1 = ( boxMin.y - pOriginY[ i ] ) * pInvDirectionY[ i ];
+		const float y2 = ( boxMax.y - pOriginY[ i ] ) * pInvDirectionY[ i ];
+		const float z1 = ( boxMin.z - pOriginZ[ i ] ) * pInvDirectionZ[ i ];
+		const float z2 = ( boxMax.z - pOriginZ[ i ] ) * pInvDirectionZ[ i ];
+		
+		const float nearDist = decMath::max( decMath::max( decMath::min( x1, x2 ), decMath::min( y1, y2 ) ),
+			decMath::max( decMath::min( z1, z2 ), 0.0f ) );
+		const float farDist = decMath::min( decMath::min( decMath::max( x1, x2 ), decMath::max( y1, y2 ) ),
+			decMath::min( decMath::max( z1, z2 ), 1.0f ) );
+			
+		if( nearDist <= farDist && nearDist < pLimitDistance[ i ] ){
+			hits |= 1 << i;
+		}
+	}
+	
+	return hits;
+#endif
+}
+
+int deoalRayTracePacket::HitsFace( const decVector &normal, const decVector &baseVertex,
+const decVector *edgeNormals, const float *edgeDistances, bool frontFacing,
+int mask, float *distances ) const{
+#ifdef OAL_RAYPACKET_SSE
+	const __m128 originX = _mm_loadu_ps( pOriginX );
+	const __m128 originY = _mm_loadu_ps( pOriginY );
+	const __m128 originZ = _mm_loadu_ps( pOriginZ );
+	const __m128 dirX = _mm_loadu_ps( pDirectionX );
+	const __m128 dirY = _mm_loadu_ps( pDirectionY );
+	const __m128 dirZ = _mm_loadu_ps( pDirectionZ );
+	
+	const __m128 normalX = _mm_set1_ps( normal.x );
+	const __m128 normalY = _mm_set1_ps( normal.y );
+	const __m128 normalZ = _mm_set1_ps( normal.z );
+	
+	// facing. front facing requires dot < -epsilon, back facing dot > epsilon
+	const __m128 dot = _mm_add_ps( _mm_add_ps( _mm_mul_ps( normalX, dirX ),
+		_mm_mul_ps( normalY, dirY ) ), _mm_mul_ps( normalZ, dirZ ) );
+		
+	__m128 hits;
+	if( frontFacing ){
+		hits = _mm_cmple_ps( dot, _mm_set1_ps( -FLOAT_SAFE_EPSILON ) );
+		
+	}else{
+		hits = _mm_cmpge_ps( dot, _mm_set1_ps( FLOAT_SAFE_EPSILON ) );
+	}
+	
+	if( ( _mm_movemask_ps( hits ) & mask ) == 0 ){
+		return 0;
+	}
+	
+	// hit distance. rays failing the facing test are masked out afterwards. dot is
+	// replaced by 1 for them to avoid dividing by zero
+	const __m128 baseDist = _mm_add_ps( _mm_add_ps(
+		_mm_mul_ps( _mm_sub_ps( _mm_set1_ps( baseVertex.x ), originX ), normalX ),
+		_mm_mul_ps( _mm_sub_ps( _mm_set1_ps( baseVertex.y ), originY ), normalY ) ),
+		_mm_mul_ps( _mm_sub_ps( _mm_set1_ps( baseVertex.z ), originZ ), normalZ ) );
+	const __m128 safeDot = _mm_or_ps( _mm_and_ps( hits, dot ),
+		_mm_andnot_ps( hits, _mm_set1_ps( 1.0f ) ) );
+	const __m128 lambda = _mm_div_ps( baseDist, safeDot );
+	
+	hits = _mm_and_ps( hits, _mm_and_ps( _mm_cmpge_ps( lambda, _mm_setzero_ps() ),
+		_mm_cmple_ps( lambda, _mm_loadu_ps( pLimitDistance ) ) ) );
+		
+	if( ( _mm_movemask_ps( hits ) & mask ) == 0 ){
+		return 0;
+	}
+	
+	// hit point has to be inside all edges
+	const __m128 hitX = _mm_add_ps( originX, _mm_mul_ps( dirX, lambda ) );
+	const __m128 hitY = _mm_add_ps( originY, _mm_mul_ps( dirY, lambda ) );
+	const __m128 hitZ = _mm_add_ps( originZ, _mm_mul_ps( dirZ, lambda ) );
+	int i;
+	
+	for( i=0; i<3; i++ ){
+		const decVector &edgeNormal = edgeNormals[ i ];
+		const __m128 edgeDot = _mm_add_ps( _mm_add_ps(
+			_mm_mul_ps( _mm_set1_ps( edgeNormal.x ), hitX ),
+			_mm_mul_ps( _mm_set1_ps( edgeNormal.y ), hitY ) ),
+			_mm_mul_ps( _mm_set1_ps( edgeNormal.z ), hitZ ) );
+		hits = _mm_and_ps( hits, _mm_cmpge_ps( edgeDot, _mm_set1_ps( edgeDistances[ i ] ) ) );
+	}
+	
+	const int result = _mm_movemask_ps( hits ) & mask;
+	if( result ){
+		_mm_storeu_ps( distances, lambda );
+	}
+	return result;
+	
+#else
+	int hits = 0;
+	int i;
+	
+	for( i=0; i<pRayCount; i++ ){
+		if( ! ( mask & ( 1 << i ) ) ){
+			continue;
+		}
+		
+		const decVector origin( pOriginX[ i ], pOriginY[ i ], pOriginZ[ i ] );
+		const decVector direction( pDirectionX[ i ], pDirectionY[ i ], pDirectionZ[ i ] );
+		
+		const float dot = normal * direction;
+		if( frontFacing ? dot > -FLOAT_SAFE_EPSILON : dot < FLOAT_SAFE_EPSILON ){
+			continue;
+		}
+		
+		const float lambda = ( ( baseVertex - origin ) * normal ) / dot;
+		if( lambda < 0.0f || lambda > pLimitDistance[ i ] ){
+			continue;
+		}
+		
+		const decVector hitPoint( origin + direction * lambda );
+		if( edgeNormals[ 0 ] * hitPoint < edgeDistances[ 0 ]
+		|| edgeNormals[ 1 ] * hitPoint < edgeDistances[ 1 ]
+		|| edgeNormals[ 2 ] * hitPoint < edgeDistances[ 2 ] ){
+			continue;
+		}
+		
+		distances[ i ] = lambda;
+		hits |= 1 << i;
+	}
+	
+	return hits;
+#endif
+}
@@ -0,0 +1,127 @@
+/* 
+ * Drag[en]gine OpenAL Audio Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEOALRAYTRACEPACKET_H_
+#define _DEOALRAYTRACEPACKET_H_
+
+#include <dragengine/common/math/decMath.h>
+
+
+/** \brief Maximum number of rays in a ray packet. */
+#define OAL_RAY_PACKET_SIZE 4
+
+
+
+/**
+ * \brief Ray tracing packet.
+ * 
+ * Stores up to OAL_RAY_PACKET_SIZE rays in structure of arrays layout to test them against
+ * boxes and faces at the same time. Rays are line segments from origin to origin plus
+ * direction. Each ray has a limit distance in the range from 0 to 1 relative to the ray
+ * direction. Tests return a bit mask of rays hitting. Rays can be excluded from tests by
+ * clearing their bit in the test mask.
+ * 
+ * If SSE2 is available all rays are tested at the same time. Otherwise rays are tested
+ * one after the other.
+ */
+class deoalRayTracePacket{
+private:
+	float pOriginX[ OAL_RAY_PACKET_SIZE ];
+	float pOriginY[ OAL_RAY_PACKET_SIZE ];
+	float pOriginZ[ OAL_RAY_PACKET_SIZE ];
+	float pDirectionX[ OAL_RAY_PACKET_SIZE ];
+	float pDirectionY[ OAL_RAY_PACKET_SIZE ];
+	float pDirectionZ[ OAL_RAY_PACKET_SIZE ];
+	float pInvDirectionX[ OAL_RAY_PACKET_SIZE ];
+	float pInvDirectionY[ OAL_RAY_PACKET_SIZE ];
+	float pInvDirectionZ[ OAL_RAY_PACKET_SIZE ];
+	float pLimitDistance[ OAL_RAY_PACKET_SIZE ];
+	int pRayCount;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create empty ray packet. */
+	deoalRayTracePacket();
+	
+	/** \brief Clean up ray packet. */
+	~deoalRayTracePacket();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Number of rays. */
+	inline int GetRayCount() const{ return pRayCount; }
+	
+	/**
+	 * \brief Set number of rays.
+	 * 
+	 * Unused rays are set to zero length with limit distance of -1 never hitting anything.
+	 */
+	void SetRayCount( int count );
+	
+	/** \brief Mask with bits of all rays set. */
+	inline int GetRayMask() const{ return ( 1 << pRayCount ) - 1; }
+	
+	/** \brief Ray origin. */
+	decVector GetRayOriginAt( int index ) const;
+	
+	/** \brief Ray direction. */
+	decVector GetRayDirectionAt( int index ) const;
+	
+	/** \brief Set ray. Limit distance is set to 1. */
+	void SetRayAt( int index, const decVector &origin, const decVector &direction );
+	
+	/** \brief Limit distance. */
+	float GetLimitDistanceAt( int index ) const;
+	
+	/** \brief Set limit distance. */
+	void SetLimitDistanceAt( int index, float limitDistance );
+	
+	/** \brief Sum of ray directions. */
+	decVector GetDirectionSum( int mask ) const;
+	
+	
+	
+	/**
+	 * \brief Rays in mask hitting box closer than their limit distance.
+	 * 
+	 * Rays starting inside the box are hitting.
+	 */
+	int HitsBox( const decVector &center, const decVector &halfExtends, int mask ) const;
+	
+	/**
+	 * \brief Rays in mask hitting face closer than their limit distance.
+	 * 
+	 * \param[in] frontFacing Hit only front facing faces if true or only back facing if false.
+	 * \param[out] distances Hit distance for each ray hitting the face.
+	 */
+	int HitsFace( const decVector &normal, const decVector &baseVertex,
+		const decVector *edgeNormals, const float *edgeDistances, bool frontFacing,
+		int mask, float *distances ) const;
+	/*@}*/
+};
+
+#endif
@@ -28,6 +28,8 @@
 #include "deoalSoundRayList.h"
 
 #include <dragengine/common/exceptions.h>
+#include <dragengine/common/file/decBaseFileReader.h>
+#include <dragengine/common/file/decBaseFileWriter.h>
 
 
 
@@ -210,6 +212,80 @@ void deoalSoundRayList::ReserveSize( int rays, int segments, int transmittedRays
 }
 
 
+void deoalSoundRayList::ReadFromFile( decBaseFileReader &reader ){
+	const int rayCount = reader.ReadInt();
+	const int segmentCount = reader.ReadInt();
+	const int transmittedRayCount = reader.ReadInt();
+	if( rayCount < 0 || segmentCount < 0 || transmittedRayCount < 0 ){
+		DETHROW( deeInvalidFileFormat );
+	}
+	
+	RemoveAllRays();
+	ReserveSize( rayCount, segmentCount, transmittedRayCount );
+	int i;
+	
+	for( i=0; i<rayCount; i++ ){
+		pReadRay( reader, pRays[ i ], segmentCount, transmittedRayCount );
+	}
+	pRayCount = rayCount;
+	
+	for( i=0; i<transmittedRayCount; i++ ){
+		pReadRay( reader, pTransmittedRays[ i ], segmentCount, transmittedRayCount );
+	}
+	pTransmittedRayCount = transmittedRayCount;
+	
+	for( i=0; i<segmentCount; i++ ){
+		deoalSoundRaySegment &segment = pSegments[ i ];
+		segment.SetPosition( reader.ReadVector() );
+		segment.SetDirection( reader.ReadVector() );
+		segment.SetNormal( reader.ReadVector() );
+		segment.SetLength( reader.ReadFloat() );
+		segment.SetDistance( reader.ReadFloat() );
+		segment.SetGainLow( reader.ReadFloat() );
+		segment.SetGainMedium( reader.ReadFloat() );
+		segment.SetGainHigh( reader.ReadFloat() );
+		segment.SetAbsorptionSumLow( reader.ReadFloat() );
+		segment.SetAbsorptionSumMedium( reader.ReadFloat() );
+		segment.SetAbsorptionSumHigh( reader.ReadFloat() );
+		segment.SetBounceCount( reader.ReadUShort() );
+		segment.SetTransmittedCount( reader.ReadUShort() );
+	}
+	pSegmentCount = segmentCount;
+}
+
+void deoalSoundRayList::WriteToFile( decBaseFileWriter &writer ) const{
+	writer.WriteInt( pRayCount );
+	writer.WriteInt( pSegmentCount );
+	writer.WriteInt( pTransmittedRayCount );
+	int i;
+	
+	for( i=0; i<pRayCount; i++ ){
+		pWriteRay( writer, pRays[ i ] );
+	}
+	
+	for( i=0; i<pTransmittedRayCount; i++ ){
+		pWriteRay( writer, pTransmittedRays[ i ] );
+	}
+	
+	for( i=0; i<pSegmentCount; i++ ){
+		const deoalSoundRaySegment &segment = pSegments[ i ];
+		writer.WriteVector( segment.GetPosition() );
+		writer.WriteVector( segment.GetDirection() );
+		writer.WriteVector( segment.GetNormal() );
+		writer.WriteFloat( segment.GetLength() );
+		writer.WriteFloat( segment.GetDistance() );
+		writer.WriteFloat( segment.GetGainLow() );
+		writer.WriteFloat( segment.GetGainMedium() );
+		writer.WriteFloat( segment.GetGainHigh() );
+		writer.WriteFloat( segment.GetAbsorptionSumLow() );
+		writer.WriteFloat( segment.GetAbsorptionSumMedium() );
+		writer.WriteFloat( segment.GetAbsorptionSumHigh() );
+		writer.WriteUShort( ( unsigned short )segment.GetBounceCount() );
+		writer.WriteUShort( ( unsigned short )segment.GetTransmittedCount() );
+	}
+}
+
+
 
 // Operators
 //////////////
@@ -260,3 +336,36 @@ const deoalSoundRayList &list ){
 	
 	return *this;
 }
+
+
+
+// Private Functions
+//////////////////////
+
+void deoalSoundRayList::pReadRay( decBaseFileReader &reader, deoalSoundRay &ray,
+int segmentCount, int transmittedRayCount ){
+	const int firstSegment = reader.ReadInt();
+	const int rayCount = reader.ReadInt();
+	const int firstTransmittedRay = reader.ReadInt();
+	const int transmittedRays = reader.ReadInt();
+	
+	if( firstSegment < 0 || rayCount < 0 || firstSegment + rayCount > segmentCount
+	|| firstTransmittedRay < 0 || transmittedRays < 0
+	|| firstTransmittedRay + transmittedRays > transmittedRayCount ){
+		DETHROW( deeInvalidFileFormat );
+	}
+	
+	ray.SetFirstSegment( firstSegment );
+	ray.SetSegmentCount( rayCount );
+	ray.SetFirstTransmittedRay( firstTransmittedRay );
+	ray.SetTransmittedRayCount( transmittedRays );
+	ray.SetOutside( reader.ReadByte() != 0 );
+}
+
+void deoalSoundRayList::pWriteRay( decBaseFileWriter &writer, const deoalSoundRay &ray ){
+	writer.WriteInt( ray.GetFirstSegment() );
+	writer.WriteInt( ray.GetSegmentCount() );
+	writer.WriteInt( ray.GetFirstTransmittedRay() );
+	writer.WriteInt( ray.GetTransmittedRayCount() );
+	writer.WriteByte( ray.GetOutside() ? 1 : 0 );
+}
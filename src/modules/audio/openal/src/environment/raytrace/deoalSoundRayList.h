@@ -25,6 +25,9 @@
 class deoalSoundRay;
 class deoalSoundRaySegment;
 
+class decBaseFileReader;
+class decBaseFileWriter;
+
 
 
 /**
@@ -97,6 +100,12 @@ public:
 	
 	/** \brief Reserve space in the array to make future AddRay() and AddSegment() more efficient. */
 	void ReserveSize( int rays, int segments, int transmittedRays );
+	
+	/** \brief Read list from file replacing content. */
+	void ReadFromFile( decBaseFileReader &reader );
+	
+	/** \brief Write list to file. */
+	void WriteToFile( decBaseFileWriter &writer ) const;
 	/*@}*/
 	
 	
@@ -109,6 +118,13 @@ public:
 	/** \brief Append. */
 	deoalSoundRayList &operator+=( const deoalSoundRayList &list );
 	/*@}*/
+	
+	
+	
+private:
+	static void pReadRay( decBaseFileReader &reader, deoalSoundRay &ray,
+		int segmentCount, int transmittedRayCount );
+	static void pWriteRay( decBaseFileWriter &writer, const deoalSoundRay &ray );
 };
 
 #endif
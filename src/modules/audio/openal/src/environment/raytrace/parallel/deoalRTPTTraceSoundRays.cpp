@@ -72,6 +72,9 @@ pMaxTransmitCount( 2 ),
 pInitialRayLength( 10.0f ), // 5.0f
 pInverseRayTracing( false ),
 pDetectOutsideLength( 100.0 ),
+#ifdef RTPTTSR_RAY_PACKETS
+pPacketRay( -1 ),
+#endif
 pBackStepDistance( 1e-4 )
 {
 	pWOVRayHitsElement.SetResult( &pRTResult );
@@ -262,9 +265,19 @@ void deoalRTPTTraceSoundRays::Run(){
 	absorptionSum.high = 0.0f;
 	
 	#ifndef RTPTTSR_ONE_TASK_PER_RAY
+	#ifdef RTPTTSR_RAY_PACKETS
+	pTracePacketFirstSegment( rayDirections );
+	#endif
+	
 	for( pRayIndex=0; pRayIndex<pRayCount; pRayIndex++ ){
 		ray.rayIndex = pSoundRayList.AddRay();
 		ray.direction = rayDirections[ pRayIndex ];
+		ray.normal.SetZero();
+		#ifdef RTPTTSR_RAY_PACKETS
+		if( pRTWOVRayHitsClosestPacket.GetRayCount() > 0 ){
+			pPacketRay = pRayIndex;
+		}
+		#endif
 		pTraceRay( ray, gain, absorptionSum );
 	}
 	#else
@@ -362,6 +375,16 @@ const sTraceAbsorptionSum &absorptionSum ){
 		hitElement = NULL;
 		pRTResult.Clear();
 		
+		#ifdef RTPTTSR_RAY_PACKETS
+		if( pPacketRay != -1 ){
+			// first segment has been traced already by pTracePacketFirstSegment
+			if( pRTWOVRayHitsClosestPacket.GetHasResultAt( pPacketRay ) ){
+				hitElement = &pRTWOVRayHitsClosestPacket.GetResultAt( pPacketRay );
+			}
+			pPacketRay = -1;
+			
+		}else
+		#endif
 		if( pRTWorldBVH ){
 			pRTWOVRayHitsClosest.SetRay( *pRTWorldBVH, rayOrigin, rayEnd - rayOrigin );
 			pRTWOVRayHitsClosest.SetFrontFacing( true );
@@ -1099,6 +1122,29 @@ EAX: 0.108675 1.000000 0.063526 (0.080500 0.108675; 0.006904 0.000000)
 	}
 }
 
+#ifdef RTPTTSR_RAY_PACKETS
+void deoalRTPTTraceSoundRays::pTracePacketFirstSegment( const decVector *rayDirections ){
+	// all rays start at the probe position. the first segment is the same pTraceRay
+	// traces in the first step using USE_STEPWISE_RAY_LENGTH
+	if( ! pRTWorldBVH || pRayCount > OAL_RAY_PACKET_SIZE || pRange <= 0.0f ){
+		pRTWOVRayHitsClosestPacket.SetRayCount( 0 );
+		return;
+	}
+	
+	const double segmentLength = decMath::min( pInitialRayLength, pRange );
+	int i;
+	
+	pRTWOVRayHitsClosestPacket.SetRayCount( pRayCount );
+	for( i=0; i<pRayCount; i++ ){
+		pRTWOVRayHitsClosestPacket.SetRayAt( i, *pRTWorldBVH, pPosition,
+			decDVector( rayDirections[ i ] ) * segmentLength );
+	}
+	
+	pRTWOVRayHitsClosestPacket.SetFrontFacing( true );
+	pRTWOVRayHitsClosestPacket.VisitBVH( *pRTWorldBVH );
+}
+#endif
+
 void deoalRTPTTraceSoundRays::pUpdateExtends( const decDVector &position ){
 	if( pFirstHit ){
 		pMinExtend = pMaxExtend = position;
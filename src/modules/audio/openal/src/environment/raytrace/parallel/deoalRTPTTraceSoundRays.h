@@ -26,6 +26,7 @@
 #include "../deoalRayTraceResult.h"
 #include "../visitors/deoalRTWOVRayHitsElement.h"
 #include "../visitors/deoalRTWOVRayHitsClosest.h"
+#include "../visitors/deoalRTWOVRayHitsClosestPacket.h"
 #include "../visitors/deoalRTWOVRayBlocked.h"
 #include "../visitors/deoalWOVRayHitsElement.h"
 #include "../visitors/deoalWOVRayBlocked.h"
@@ -40,7 +41,12 @@ class deoalAWorld;
 class deoalRTWorldBVH;
 
 // use 1-ray-per-task. this is ~26% faster than tracing multiple rays per task
-#define RTPTTSR_ONE_TASK_PER_RAY 1
+// #define RTPTTSR_ONE_TASK_PER_RAY 1
+
+// use 1-packet-per-task. the first segment of all rays in the packet is traced together
+// since they start at the same position and diverge slowly. reflected and transmitted
+// rays are traced as single rays. requires RTPTTSR_ONE_TASK_PER_RAY to be not defined
+#define RTPTTSR_RAY_PACKETS 1
 
 
 /**
@@ -140,6 +146,10 @@ private:
 	deoalWOVRayHitsElement pWOVRayHitsElement;
 	deoalRTWOVRayHitsElement pRTWOVRayHitsElement;
 	deoalRTWOVRayHitsClosest pRTWOVRayHitsClosest;
+	#ifdef RTPTTSR_RAY_PACKETS
+	deoalRTWOVRayHitsClosestPacket pRTWOVRayHitsClosestPacket;
+	int pPacketRay;
+	#endif
 	deoalWOVRayBlocked pWOVRayBlocked;
 	deoalRTWOVRayBlocked pRTWOVRayBlocked;
 	bool pFirstHit;
@@ -299,6 +309,9 @@ public:
 protected:
 	void pTraceRay( const sTraceRay &ray, const sTraceGain &gain,
 		const sTraceAbsorptionSum &absorptionSum );
+	#ifdef RTPTTSR_RAY_PACKETS
+	void pTracePacketFirstSegment( const decVector *rayDirections );
+	#endif
 	void pUpdateExtends( const decDVector &position );
 	float Attenuate( float distance ) const;
 	void DetectRayOutside( const sTraceRay &ray, const decDVector &position );
@@ -606,6 +606,8 @@ const deoalATRayTracing::sConfigSoundTracing &config ){
 	// prepare tracing tasks
 	#ifdef RTPTTSR_ONE_TASK_PER_RAY
 	const int taskCount = config.rtConfig->GetRayCount();
+	#elif defined( RTPTTSR_RAY_PACKETS )
+	const int taskCount = ( config.rtConfig->GetRayCount() + OAL_RAY_PACKET_SIZE - 1 ) / OAL_RAY_PACKET_SIZE;
 	#else
 	const int taskCount = 8;
 	#endif
@@ -619,9 +621,9 @@ const deoalATRayTracing::sConfigSoundTracing &config ){
 		}
 	}
 	
-	#ifndef RTPTTSR_ONE_TASK_PER_RAY
-	const int raysPerTask = probeConfig.GetRayCount() / taskCount;
-	int firstRay = probeConfig.GetRayCount() - raysPerTask * ( taskCount - 1 );
+	#if ! defined( RTPTTSR_ONE_TASK_PER_RAY ) && ! defined( RTPTTSR_RAY_PACKETS )
+	const int raysPerTask = config.rtConfig->GetRayCount() / taskCount;
+	int firstRay = config.rtConfig->GetRayCount() - raysPerTask * ( taskCount - 1 );
 	#endif
 	int i;
 	
@@ -648,6 +650,10 @@ const deoalATRayTracing::sConfigSoundTracing &config ){
 		
 		#ifdef RTPTTSR_ONE_TASK_PER_RAY
 		task.SetFirstRay( i );
+		#elif defined( RTPTTSR_RAY_PACKETS )
+		task.SetFirstRay( OAL_RAY_PACKET_SIZE * i );
+		task.SetRayCount( decMath::min( OAL_RAY_PACKET_SIZE,
+			config.rtConfig->GetRayCount() - OAL_RAY_PACKET_SIZE * i ) );
 		#else
 		if( i == 0 ){
 			task.SetFirstRay( 0 );
@@ -0,0 +1,140 @@
+/* 
+ * Drag[en]gine OpenAL Audio Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "deoalMOVRayHitsClosestPacket.h"
+#include "../../../component/deoalAComponent.h"
+#include "../../../component/deoalAComponentTexture.h"
+
+#include <dragengine/common/exceptions.h>
+
+
+
+// Class deoalMOVRayHitsClosestPacket
+///////////////////////////////////////
+
+// Constructors and Destructors
+/////////////////////////////////
+
+deoalMOVRayHitsClosestPacket::deoalMOVRayHitsClosestPacket( const deoalAComponent *component ) :
+pComponent( component ),
+pFrontFacing( true ),
+pResultMask( 0 ){
+}
+
+deoalMOVRayHitsClosestPacket::~deoalMOVRayHitsClosestPacket(){
+}
+
+
+
+// Visiting
+/////////////
+
+void deoalMOVRayHitsClosestPacket::SetFrontFacing( bool frontFacing ){
+	pFrontFacing = frontFacing;
+}
+
+decVector deoalMOVRayHitsClosestPacket::GetResultPointAt( int index ) const{
+	return pPacket.GetRayOriginAt( index ) + pPacket.GetRayDirectionAt( index ) * pResultDistance[ index ];
+}
+
+void deoalMOVRayHitsClosestPacket::VisitBVH( const deoalModelRTBVH &bvh, int mask ){
+	pResultMask = 0;
+	
+	if( bvh.GetNodeCount() == 0 ){
+		return;
+	}
+	
+	const deoalModelRTBVH::sNode &root = bvh.GetNodes()[ 0 ];
+	mask = pPacket.HitsBox( root.center, root.halfSize, mask & pPacket.GetRayMask() );
+	if( mask ){
+		pVisitNode( bvh, root, mask );
+	}
+}
+
+
+
+// Protected Functions
+////////////////////////
+
+void deoalMOVRayHitsClosestPacket::pVisitNode( const deoalModelRTBVH &bvh,
+const deoalModelRTBVH::sNode &node, int mask ){
+	if( node.faceCount > 0 ){
+		const deoalModelRTBVH::sFace * const faces = bvh.GetFaces() + node.firstFace;
+		float distances[ OAL_RAY_PACKET_SIZE ];
+		int i, j;
+		
+		for( i=0; i<node.faceCount; i++ ){
+			const deoalModelRTBVH::sFace &face = faces[ i ];
+			
+			const int hits = pPacket.HitsFace( face.normal, face.baseVertex, face.edgeNormal,
+				face.edgeDistance, pFrontFacing, mask, distances );
+			if( ! hits || ! pFaceAffectsSound( face ) ){
+				continue;
+			}
+			
+			for( j=0; j<OAL_RAY_PACKET_SIZE; j++ ){
+				if( ! ( hits & ( 1 << j ) ) ){
+					continue;
+				}
+				
+				pResultMask |= 1 << j;
+				pResultDistance[ j ] = distances[ j ];
+				pResultNormal[ j ] = &face.normal;
+				pResultFace[ j ] = face.indexFace;
+				pPacket.SetLimitDistanceAt( j, distances[ j ] );
+			}
+		}
+		
+	}else{
+		const deoalModelRTBVH::sNode &child1 = bvh.GetNodes()[ node.node1 ];
+		const deoalModelRTBVH::sNode &child2 = bvh.GetNodes()[ node.node2 ];
+		
+		// visit closer child first using the average direction of the rays. the mask of
+		// the second child is calculated after visiting the first child since limit
+		// distances of the rays can shrink in between
+		const bool child1First = ( child2.center - child1.center ) * pPacket.GetDirectionSum( mask ) > 0.0f;
+		const deoalModelRTBVH::sNode &first = child1First ? child1 : child2;
+		const deoalModelRTBVH::sNode &second = child1First ? child2 : child1;
+		
+		const int maskFirst = pPacket.HitsBox( first.center, first.halfSize, mask );
+		if( maskFirst ){
+			pVisitNode( bvh, first, maskFirst );
+		}
+		
+		const int maskSecond = pPacket.HitsBox( second.center, second.halfSize, mask );
+		if( maskSecond ){
+			pVisitNode( bvh, second, maskSecond );
+		}
+	}
+}
+
+bool deoalMOVRayHitsClosestPacket::pFaceAffectsSound( const deoalModelRTBVH::sFace &face ) const{
+	if( ! pComponent ){
+		return true;
+	}
+	
+	const int textureIndex = pComponent->GetModelTextureMappings().GetAt( face.indexTexture );
+	return textureIndex != -1 && pComponent->GetTextureAt( textureIndex ).GetAffectsSound();
+}
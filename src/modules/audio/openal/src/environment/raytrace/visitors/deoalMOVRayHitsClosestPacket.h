@@ -0,0 +1,115 @@
+/* 
+ * Drag[en]gine OpenAL Audio Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEOALMOVRAYHITSCLOSESTPACKET_H_
+#define _DEOALMOVRAYHITSCLOSESTPACKET_H_
+
+#include <dragengine/common/math/decMath.h>
+
+#include "../deoalRayTracePacket.h"
+#include "../../../model/octree/deoalModelRTBVH.h"
+
+class deoalAComponent;
+
+
+/**
+ * \brief Model BVH visitor closest hit face for ray packets.
+ * 
+ * Visits model BVH with all rays of a packet at the same time. For each ray the closest
+ * face hit is stored. Child nodes are visited with the mask of rays hitting the node box.
+ * Rays missing a node drop out of the mask while the other rays continue.
+ */
+class deoalMOVRayHitsClosestPacket{
+private:
+	const deoalAComponent *pComponent;
+	deoalRayTracePacket pPacket;
+	bool pFrontFacing;
+	
+	int pResultMask;
+	float pResultDistance[ OAL_RAY_PACKET_SIZE ];
+	const decVector *pResultNormal[ OAL_RAY_PACKET_SIZE ];
+	int pResultFace[ OAL_RAY_PACKET_SIZE ];
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/**
+	 * \brief Create visitor.
+	 * 
+	 * \param[in] component Component to check texture sound flags of or NULL to accept all faces.
+	 */
+	deoalMOVRayHitsClosestPacket( const deoalAComponent *component );
+	
+	/** \brief Clean up visitor. */
+	~deoalMOVRayHitsClosestPacket();
+	/*@}*/
+	
+	
+	
+	/** \name Visiting */
+	/*@{*/
+	/** \brief Ray packet. */
+	inline deoalRayTracePacket &GetPacket(){ return pPacket; }
+	inline const deoalRayTracePacket &GetPacket() const{ return pPacket; }
+	
+	/** \brief Find front facing hits otherwise back facing hits. */
+	inline bool GetFrontFacing() const{ return pFrontFacing; }
+	
+	/** \brief Set to find front facing hits or back facing hits. */
+	void SetFrontFacing( bool frontFacing );
+	
+	
+	
+	/** \brief Mask of rays with result. */
+	inline int GetResultMask() const{ return pResultMask; }
+	
+	/** \brief Result distance relative to ray direction. */
+	inline float GetResultDistanceAt( int index ) const{ return pResultDistance[ index ]; }
+	
+	/** \brief Result point. */
+	decVector GetResultPointAt( int index ) const;
+	
+	/** \brief Result normal. */
+	inline const decVector &GetResultNormalAt( int index ) const{ return *pResultNormal[ index ]; }
+	
+	/** \brief Result face index. */
+	inline int GetResultFaceAt( int index ) const{ return pResultFace[ index ]; }
+	
+	
+	
+	/**
+	 * \brief Visit BVH with rays in mask.
+	 * 
+	 * Limit distances of rays are reduced to the closest hit found.
+	 */
+	void VisitBVH( const deoalModelRTBVH &bvh, int mask );
+	/*@}*/
+	
+	
+	
+protected:
+	void pVisitNode( const deoalModelRTBVH &bvh, const deoalModelRTBVH::sNode &node, int mask );
+	bool pFaceAffectsSound( const deoalModelRTBVH::sFace &face ) const;
+};
+
+#endif
@@ -0,0 +1,213 @@
+/* 
+ * Drag[en]gine OpenAL Audio Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "deoalMOVRayHitsClosest.h"
+#include "deoalMOVRayHitsClosestPacket.h"
+#include "deoalRTWOVRayHitsClosestPacket.h"
+#include "../../../component/deoalAComponent.h"
+#include "../../../model/deoalAModel.h"
+
+#include <dragengine/common/exceptions.h>
+
+
+
+// Class deoalRTWOVRayHitsClosestPacket
+/////////////////////////////////////////
+
+// Constructors and Destructors
+/////////////////////////////////
+
+deoalRTWOVRayHitsClosestPacket::deoalRTWOVRayHitsClosestPacket() :
+pFrontFacing( true ),
+pResultMask( 0 ){
+}
+
+deoalRTWOVRayHitsClosestPacket::~deoalRTWOVRayHitsClosestPacket(){
+}
+
+
+
+// Visiting
+/////////////
+
+void deoalRTWOVRayHitsClosestPacket::SetRayCount( int count ){
+	pPacket.SetRayCount( count );
+}
+
+void deoalRTWOVRayHitsClosestPacket::SetRayAt( int index, const deoalRTWorldBVH &bvh,
+const decDVector &origin, const decDVector &direction ){
+	pPacket.SetRayAt( index, ( origin - bvh.GetPosition() ).ToVector(), direction.ToVector() );
+}
+
+void deoalRTWOVRayHitsClosestPacket::SetFrontFacing( bool frontFacing ){
+	pFrontFacing = frontFacing;
+}
+
+void deoalRTWOVRayHitsClosestPacket::VisitBVH( const deoalRTWorldBVH &bvh ){
+	pResultMask = 0;
+	
+	if( bvh.GetVisitNodeCount() == 0 ){
+		return;
+	}
+	
+	const deoalRTWorldBVH::sVisitNode &root = bvh.GetVisitNodes()[ 0 ];
+	const int mask = pPacket.HitsBox( root.center, root.halfSize, pPacket.GetRayMask() );
+	if( mask ){
+		pVisitNode( bvh, root, mask );
+	}
+}
+
+
+
+// Protected Functions
+////////////////////////
+
+void deoalRTWOVRayHitsClosestPacket::pVisitNode( const deoalRTWorldBVH &bvh,
+const deoalRTWorldBVH::sVisitNode &node, int mask ){
+	if( node.componentCount > 0 ){
+		const deoalRTWorldBVH::sVisitComponent * const components =
+			bvh.GetVisitComponents() + node.firstComponent;
+		int i;
+		
+		for( i=0; i<node.componentCount; i++ ){
+			const deoalRTWorldBVH::sVisitComponent &component = components[ i ];
+			const int maskComponent = pPacket.HitsBox( component.center, component.halfSize, mask );
+			if( maskComponent ){
+				pVisitComponent( component, maskComponent );
+			}
+		}
+		
+	}else{
+		const deoalRTWorldBVH::sVisitNode &child1 = bvh.GetVisitNodes()[ node.node1 ];
+		const deoalRTWorldBVH::sVisitNode &child2 = bvh.GetVisitNodes()[ node.node2 ];
+		
+		const bool child1First = ( child2.center - child1.center ) * pPacket.GetDirectionSum( mask ) > 0.0f;
+		const deoalRTWorldBVH::sVisitNode &first = child1First ? child1 : child2;
+		const deoalRTWorldBVH::sVisitNode &second = child1First ? child2 : child1;
+		
+		const int maskFirst = pPacket.HitsBox( first.center, first.halfSize, mask );
+		if( maskFirst ){
+			pVisitNode( bvh, first, maskFirst );
+		}
+		
+		const int maskSecond = pPacket.HitsBox( second.center, second.halfSize, mask );
+		if( maskSecond ){
+			pVisitNode( bvh, second, maskSecond );
+		}
+	}
+}
+
+void deoalRTWOVRayHitsClosestPacket::pVisitComponent(
+const deoalRTWorldBVH::sVisitComponent &rtcomponent, int mask ){
+	// WARNING everything in here has to be thread-safe
+	
+	// rays diverged. continue with single ray
+	if( ( mask & ( mask - 1 ) ) == 0 ){
+		int index = 0;
+		while( ! ( mask & ( 1 << index ) ) ){
+			index++;
+		}
+		pVisitComponentSingle( rtcomponent, index );
+		return;
+	}
+	
+	const deoalAComponent &component = *rtcomponent.component;
+	const deoalAModel &model = *component.GetModel();
+	const int rayCount = pPacket.GetRayCount();
+	int i;
+	
+	deoalMOVRayHitsClosestPacket visitor( &component );
+	deoalRayTracePacket &packet = visitor.GetPacket();
+	visitor.SetFrontFacing( pFrontFacing );
+	packet.SetRayCount( rayCount );
+	
+	for( i=0; i<rayCount; i++ ){
+		if( mask & ( 1 << i ) ){
+			packet.SetRayAt( i, rtcomponent.inverseMatrix * pPacket.GetRayOriginAt( i ),
+				rtcomponent.inverseMatrix.TransformNormal( pPacket.GetRayDirectionAt( i ) ) );
+			packet.SetLimitDistanceAt( i, pPacket.GetLimitDistanceAt( i ) );
+		}
+	}
+	
+	if( component.GetBVH() ){
+		visitor.VisitBVH( *component.GetBVH(), mask );
+		
+	}else{
+		visitor.VisitBVH( *model.GetRTBVH(), mask );
+	}
+	
+	const int resultMask = visitor.GetResultMask();
+	if( ! resultMask ){
+		return;
+	}
+	
+	for( i=0; i<rayCount; i++ ){
+		if( resultMask & ( 1 << i ) ){
+			pSetResult( i, rtcomponent.component, visitor.GetResultNormalAt( i ),
+				visitor.GetResultPointAt( i ), visitor.GetResultDistanceAt( i ),
+				packet.GetRayDirectionAt( i ).Length(), visitor.GetResultFaceAt( i ) );
+		}
+	}
+}
+
+void deoalRTWOVRayHitsClosestPacket::pVisitComponentSingle(
+const deoalRTWorldBVH::sVisitComponent &rtcomponent, int index ){
+	const deoalAComponent &component = *rtcomponent.component;
+	const deoalAModel &model = *component.GetModel();
+	const float limitDistance = pPacket.GetLimitDistanceAt( index );
+	
+	deoalMOVRayHitsClosest visitor( *rtcomponent.component, model );
+	visitor.SetRay( rtcomponent.inverseMatrix * pPacket.GetRayOriginAt( index ),
+		rtcomponent.inverseMatrix.TransformNormal( pPacket.GetRayDirectionAt( index ) ) );
+	visitor.SetFrontFacing( pFrontFacing );
+	visitor.SetLimitDistance( limitDistance );
+	
+	if( component.GetBVH() ){
+		visitor.VisitBVH( *component.GetBVH() );
+		
+	}else{
+		visitor.VisitBVH( *model.GetRTBVH() );
+	}
+	
+	if( visitor.GetHasResult() && visitor.GetResultDistance() < limitDistance ){
+		pSetResult( index, rtcomponent.component, visitor.GetResultNormal(), visitor.GetResultPoint(),
+			visitor.GetResultDistance(), visitor.GetRayLength(), visitor.GetResultFace() );
+	}
+}
+
+void deoalRTWOVRayHitsClosestPacket::pSetResult( int index, deoalAComponent *component,
+const decVector &normal, const decVector &point, float distance, float rayLength, int face ){
+	const decDMatrix &matrix = component->GetMatrix();
+	decVector worldNormal( matrix.TransformNormal( normal ) );
+	if( component->GetHasScaling() ){
+		worldNormal.Normalize();
+	}
+	
+	pResults[ index ].SetComponentFace( rayLength * distance, matrix * point, worldNormal,
+		component, face, pFrontFacing );
+	pResultMask |= 1 << index;
+	
+	pPacket.SetLimitDistanceAt( index, distance );
+}
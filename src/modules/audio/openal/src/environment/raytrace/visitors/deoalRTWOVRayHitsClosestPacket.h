@@ -0,0 +1,111 @@
+/* 
+ * Drag[en]gine OpenAL Audio Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEOALRTWOVRAYHITSCLOSESTPACKET_H_
+#define _DEOALRTWOVRAYHITSCLOSESTPACKET_H_
+
+#include <dragengine/common/math/decMath.h>
+
+#include "../deoalRayTraceHitElement.h"
+#include "../deoalRayTracePacket.h"
+#include "../../../world/octree/deoalRTWorldBVH.h"
+
+class deoalAComponent;
+
+
+/**
+ * \brief Ray tracing world BVH visitor closest hit elements for ray packets.
+ * 
+ * Visits world BVH with all rays of a packet at the same time. For each ray the closest
+ * element hit is stored. Rays missing a node drop out of the packet mask. Components hit
+ * by only one ray of the packet are tested using deoalMOVRayHitsClosest since packet
+ * tests provide no gain for a single ray.
+ * 
+ * \note Thread safe.
+ */
+class deoalRTWOVRayHitsClosestPacket{
+private:
+	deoalRayTracePacket pPacket;
+	bool pFrontFacing;
+	
+	int pResultMask;
+	deoalRayTraceHitElement pResults[ OAL_RAY_PACKET_SIZE ];
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create visitor. */
+	deoalRTWOVRayHitsClosestPacket();
+	
+	/** \brief Clean up visitor. */
+	~deoalRTWOVRayHitsClosestPacket();
+	/*@}*/
+	
+	
+	
+	/** \name Visiting */
+	/*@{*/
+	/** \brief Number of rays. */
+	inline int GetRayCount() const{ return pPacket.GetRayCount(); }
+	
+	/** \brief Set number of rays. */
+	void SetRayCount( int count );
+	
+	/** \brief Set test ray. Limit distance is set to 1. */
+	void SetRayAt( int index, const deoalRTWorldBVH &bvh, const decDVector &origin,
+		const decDVector &direction );
+		
+	/** \brief Find front facing hits otherwise back facing hits. */
+	inline bool GetFrontFacing() const{ return pFrontFacing; }
+	
+	/** \brief Set to find front facing hits or back facing hits. */
+	void SetFrontFacing( bool frontFacing );
+	
+	
+	
+	/** \brief Mask of rays with result. */
+	inline int GetResultMask() const{ return pResultMask; }
+	
+	/** \brief Ray has result. */
+	inline bool GetHasResultAt( int index ) const{ return ( pResultMask & ( 1 << index ) ) != 0; }
+	
+	/** \brief Result of ray. */
+	inline const deoalRayTraceHitElement &GetResultAt( int index ) const{ return pResults[ index ]; }
+	
+	
+	
+	/** \brief Visit optimized ray-trace BVH node. */
+	void VisitBVH( const deoalRTWorldBVH &bvh );
+	/*@}*/
+	
+	
+	
+protected:
+	void pVisitNode( const deoalRTWorldBVH &bvh, const deoalRTWorldBVH::sVisitNode &node, int mask );
+	void pVisitComponent( const deoalRTWorldBVH::sVisitComponent &rtcomponent, int mask );
+	void pVisitComponentSingle( const deoalRTWorldBVH::sVisitComponent &rtcomponent, int index );
+	void pSetResult( int index, deoalAComponent *component, const decVector &normal,
+		const decVector &point, float distance, float rayLength, int face );
+};
+
+#endif
@@ -19,6 +19,7 @@
  * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
  */
 
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -53,6 +54,7 @@ pAudioThread( audioThread ),
 pFilename( model.GetFilename() ),
 pFaces( NULL ),
 pFaceCount( 0 ),
+pContentHash( 0 ),
 pWeights( NULL ),
 pWeightCount( 0 ),
 pWeightSets( NULL ),
@@ -77,6 +79,7 @@ pRayCache( NULL )
 		pInitTextureNames( model );
 		pBuildWeights( lod );
 		pBuildFaces( lod );
+		pCalcContentHash();
 // 		pInitRTSphere( lod );
 // 		pRayCache = new deoalRayCache( pMinExtend, pMaxExtend );
 		
@@ -234,6 +237,41 @@ void deoalAModel::pBuildFaces( const deModelLOD &lod ){
 	pSize = pMaxExtend - pMinExtend;
 }
 
+static inline unsigned int fHashInt( unsigned int hash, int value ){
+	// FNV-1a
+	hash = ( hash ^ ( unsigned int )( value & 0xffff ) ) * 16777619u;
+	return ( hash ^ ( ( unsigned int )value >> 16 ) ) * 16777619u;
+}
+
+static inline unsigned int fHashVector( unsigned int hash, const decVector &vector ){
+	// quantize to millimeters to avoid tiny floating point differences changing the hash
+	hash = fHashInt( hash, ( int )floorf( vector.x * 1000.0f + 0.5f ) );
+	hash = fHashInt( hash, ( int )floorf( vector.y * 1000.0f + 0.5f ) );
+	return fHashInt( hash, ( int )floorf( vector.z * 1000.0f + 0.5f ) );
+}
+
+void deoalAModel::pCalcContentHash(){
+	const int textureCount = pTextureNames.GetCount();
+	unsigned int hash = 2166136261u;
+	int i;
+	
+	hash = fHashInt( hash, textureCount );
+	for( i=0; i<textureCount; i++ ){
+		hash = fHashInt( hash, ( int )pTextureNames.GetAt( i ).Hash() );
+	}
+	
+	hash = fHashInt( hash, pFaceCount );
+	for( i=0; i<pFaceCount; i++ ){
+		const deoalModelFace &face = pFaces[ i ];
+		hash = fHashVector( hash, face.GetVertex1() );
+		hash = fHashVector( hash, face.GetVertex2() );
+		hash = fHashVector( hash, face.GetVertex3() );
+		hash = fHashInt( hash, face.GetTexture() );
+	}
+	
+	pContentHash = hash;
+}
+
 void deoalAModel::pBuildOctree(){
 	const decVector size( pMaxExtend - pMinExtend );
 	
@@ -66,6 +66,7 @@ private:
 	
 	deoalModelFace *pFaces;
 	int pFaceCount;
+	unsigned int pContentHash;
 	
 	sWeight *pWeights;
 	int pWeightCount;
@@ -125,6 +126,14 @@ public:
 	/** \brief Face at index. */
 	const deoalModelFace &GetFaceAt( int index ) const;
 	
+	/**
+	 * \brief Hash of faces and texture names.
+	 * 
+	 * Changes if the sound affecting content of the model changes even if the filename
+	 * stays the same. Used to identify cached data calculated from the model geometry.
+	 */
+	inline unsigned int GetContentHash() const{ return pContentHash; }
+	
 	
 	
 	/** \brief Weights. */
@@ -187,6 +196,7 @@ private:
 	void pInitTextureNames( const deModel &model );
 	void pBuildWeights( const deModelLOD &lod );
 	void pBuildFaces( const deModelLOD &lod );
+	void pCalcContentHash();
 	void pBuildOctree();
 // 	void pInitRTSphere( const deModelLOD &lod );
 	
@@ -0,0 +1,63 @@
+/* 
+ * Drag[en]gine OpenAL Audio Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "deoalPEnvProbeCache.h"
+#include "../deAudioOpenAL.h"
+#include "../configuration/deoalConfiguration.h"
+
+#include <dragengine/common/exceptions.h>
+
+
+
+// Class deoalPEnvProbeCache
+//////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+deoalPEnvProbeCache::deoalPEnvProbeCache( deAudioOpenAL &oal ) :
+deoalParameterBool( oal )
+{
+	SetName( "envProbeCache" );
+	SetDescription( "Reuse environment probes cached across sessions. Speeds up level start "
+		"but cached probes can be outdated if the level content changed." );
+	SetCategory( ecExpert );
+}
+
+deoalPEnvProbeCache::~deoalPEnvProbeCache(){
+}
+
+
+
+// Management
+///////////////
+
+bool deoalPEnvProbeCache::GetParameterBool(){
+	return pOal.GetConfiguration().GetEnvProbeCache();
+}
+
+void deoalPEnvProbeCache::SetParameterBool( bool value ){
+	pOal.GetConfiguration().SetEnvProbeCache( value );
+}
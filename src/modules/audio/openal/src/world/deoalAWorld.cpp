@@ -28,7 +28,9 @@
 #include "octree/deoalWorldOctreeVisitor.h"
 #include "octree/deoalWOVInvalidateEnvProbes.h"
 #include "../audiothread/deoalAudioThread.h"
+#include "../audiothread/deoalATLogger.h"
 #include "../component/deoalAComponent.h"
+#include "../environment/deoalEnvProbeCache.h"
 #include "../environment/deoalEnvProbeList.h"
 #include "../microphone/deoalAMicrophone.h"
 #include "../speaker/deoalASpeaker.h"
@@ -64,10 +66,12 @@ pRootSoundLevelMeter( NULL ),
 pTailSoundLevelMeter( NULL ),
 pSoundLevelMeterCount( 0 ),
 
-pOctree( NULL )
+pOctree( NULL ),
+pEnvProbeCache( NULL )
 {
 	try{
 		pOctree = new deoalWorldOctree( decDVector(), size * 0.5 );
+		pEnvProbeCache = new deoalEnvProbeCache( *this );
 		
 	}catch( const deException & ){
 		pCleanUp();
@@ -94,9 +98,16 @@ deoalWorldOctreeVisitor &visitor ){
 }
 
 void deoalAWorld::InvalidateEnvProbes( const decDVector &minExtend,
-const decDVector &maxExtend, const decLayerMask &layerMask ){
+const decDVector &maxExtend, const decLayerMask &layerMask, bool staticGeometry ){
 	deoalWOVInvalidateEnvProbes visitor( minExtend, maxExtend, layerMask );
 	VisitRegion( minExtend, maxExtend, visitor );
+	
+	if( staticGeometry ){
+		pEnvProbeCache->StaticGeometryChanged();
+		
+	}else{
+		pEnvProbeCache->InvalidateProbesInside( minExtend, maxExtend, layerMask );
+	}
 }
 
 
@@ -185,6 +196,7 @@ void deoalAWorld::AddComponent( deoalAComponent *component ){
 	pComponentCount++;
 	
 	component->SetParentWorld( this );
+	pEnvProbeCache->StaticGeometryChanged();
 }
 
 void deoalAWorld::RemoveComponent( deoalAComponent *component ){
@@ -211,6 +223,8 @@ void deoalAWorld::RemoveComponent( deoalAComponent *component ){
 	
 	pComponentCount--;
 	component->FreeReference();
+	
+	pEnvProbeCache->StaticGeometryChanged();
 }
 
 void deoalAWorld::RemoveAllComponents(){
@@ -227,6 +241,8 @@ void deoalAWorld::RemoveAllComponents(){
 	}
 	
 	pTailComponent = NULL;
+	
+	pEnvProbeCache->StaticGeometryChanged();
 }
 
 void deoalAWorld::RemoveRemovalMarkedComponents(){
@@ -563,6 +579,16 @@ void deoalAWorld::pCleanUp(){
 	// 
 	// this also means ClearAll() is not called on the octree since PrepareQuickDispose()
 	// is called on the octree content
+	if( pEnvProbeCache ){
+		// store cached environment probes while the static components are still present
+		try{
+			pEnvProbeCache->Save();
+			
+		}catch( const deException &e ){
+			pAudioThread.GetLogger().LogException( e );
+		}
+	}
+	
 	while( pRootComponent ){
 		deoalAComponent * const next = pRootComponent->GetLLWorldNext();
 		pRootComponent->PrepareQuickDispose();
@@ -584,6 +610,9 @@ void deoalAWorld::pCleanUp(){
 		pRootMicrophone = next;
 	}
 	
+	if( pEnvProbeCache ){
+		delete pEnvProbeCache;
+	}
 	if( pOctree ){
 		delete pOctree;
 	}
@@ -31,6 +31,7 @@ class deoalAComponent;
 class deoalAMicrophone;
 class deoalASpeaker;
 class deoalASoundLevelMeter;
+class deoalEnvProbeCache;
 class deoalWorldOctree;
 class deoalWorldOctreeVisitor;
 
@@ -59,6 +60,7 @@ private:
 	int pSoundLevelMeterCount;
 	
 	deoalWorldOctree *pOctree;
+	deoalEnvProbeCache *pEnvProbeCache;
 	
 	decLayerMask pAllMicLayerMask;
 	
@@ -97,9 +99,17 @@ public:
 	
 	
 	
-	/** \brief Invalidate environment probes. */
+	/** \brief Environment probe cache. */
+	inline deoalEnvProbeCache &GetEnvProbeCache() const{ return *pEnvProbeCache; }
+	
+	/**
+	 * \brief Invalidate environment probes.
+	 * 
+	 * If \em staticGeometry is true the static geometry hash of the environment probe cache
+	 * is updated. Otherwise cached environment probes overlapping the box are removed.
+	 */
 	void InvalidateEnvProbes( const decDVector &minExtend, const decDVector &maxExtend,
-		const decLayerMask &layerMask );
+		const decLayerMask &layerMask, bool staticGeometry );
 	
 	
 	
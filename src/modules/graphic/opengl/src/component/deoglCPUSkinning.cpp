@@ -0,0 +1,551 @@
+/* 
+ * Drag[en]gine OpenGL Graphic Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "deoglCPUSkinning.h"
+#include "../model/face/deoglModelFace.h"
+
+#include <dragengine/common/exceptions.h>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define OGL_CPUSKINNING_SSE 1
+#include <emmintrin.h>
+#endif
+
+
+
+// Definitions
+////////////////
+
+static const oglMatrix3x4 vIdentityMatrix = {
+	1.0f, 0.0f, 0.0f, 0.0f,
+	0.0f, 1.0f, 0.0f, 0.0f,
+	0.0f, 0.0f, 1.0f, 0.0f };
+	
+#ifdef OGL_CPUSKINNING_SSE
+// mask ? a : b
+static inline __m128 fSelect( __m128 mask, __m128 a, __m128 b ){
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+#endif
+
+
+
+// Class deoglCPUSkinning
+///////////////////////////
+
+// Skinning
+/////////////
+
+void deoglCPUSkinning::CalculateWeights( oglMatrix3x4 *weights, int weightsCount,
+const oglMatrix3x4 *boneMatrices, const oglModelWeight *entries, const int *entryCounts ){
+#ifdef OGL_CPUSKINNING_SSE
+	int w, e;
+	
+	for( w=0; w<weightsCount; w++ ){
+		float * const weightMatrix = &weights[ w ].a11;
+		const int entryCount = entryCounts[ w ];
+		
+		if( entryCount == 0 ){
+			const float * const identity = &vIdentityMatrix.a11;
+			_mm_storeu_ps( weightMatrix, _mm_loadu_ps( identity ) );
+			_mm_storeu_ps( weightMatrix + 4, _mm_loadu_ps( identity + 4 ) );
+			_mm_storeu_ps( weightMatrix + 8, _mm_loadu_ps( identity + 8 ) );
+			
+		}else if( entryCount == 1 ){
+			const float * const boneMatrix = &boneMatrices[ entries->bone ].a11;
+			_mm_storeu_ps( weightMatrix, _mm_loadu_ps( boneMatrix ) );
+			_mm_storeu_ps( weightMatrix + 4, _mm_loadu_ps( boneMatrix + 4 ) );
+			_mm_storeu_ps( weightMatrix + 8, _mm_loadu_ps( boneMatrix + 8 ) );
+			entries++;
+			
+		}else{
+			__m128 row1 = _mm_setzero_ps();
+			__m128 row2 = _mm_setzero_ps();
+			__m128 row3 = _mm_setzero_ps();
+			
+			for( e=0; e<entryCount; e++ ){
+				const float * const boneMatrix = &boneMatrices[ entries->bone ].a11;
+				const __m128 factor = _mm_set1_ps( entries->weight );
+				
+				row1 = _mm_add_ps( row1, _mm_mul_ps( _mm_loadu_ps( boneMatrix ), factor ) );
+				row2 = _mm_add_ps( row2, _mm_mul_ps( _mm_loadu_ps( boneMatrix + 4 ), factor ) );
+				row3 = _mm_add_ps( row3, _mm_mul_ps( _mm_loadu_ps( boneMatrix + 8 ), factor ) );
+				entries++;
+			}
+			
+			_mm_storeu_ps( weightMatrix, row1 );
+			_mm_storeu_ps( weightMatrix + 4, row2 );
+			_mm_storeu_ps( weightMatrix + 8, row3 );
+		}
+	}
+	
+#else
+	CalculateWeightsScalar( weights, weightsCount, boneMatrices, entries, entryCounts );
+#endif
+}
+
+void deoglCPUSkinning::TransformPositions( oglVector *positions, int positionCount,
+const float *skinPositions, int skinPositionStride, const int *skinWeights,
+const oglMatrix3x4 *weights ){
+	if( positionCount == 0 ){
+		return;
+	}
+	if( ! positions || ! skinPositions || ! skinWeights || skinPositionStride < positionCount ){
+		DETHROW( deeInvalidParam );
+	}
+	
+#ifdef OGL_CPUSKINNING_SSE
+	const float * const positionsX = skinPositions;
+	const float * const positionsY = skinPositions + skinPositionStride;
+	const float * const positionsZ = skinPositions + skinPositionStride * 2;
+	float * const output = &positions[ 0 ].x;
+	const float *matrices[ 4 ];
+	float tail[ 12 ];
+	int i, j;
+	
+	for( i=0; i<positionCount; i+=4 ){
+		for( j=0; j<4; j++ ){
+			const int weight = skinWeights[ i + j ];
+			matrices[ j ] = weight == -1 ? &vIdentityMatrix.a11 : &weights[ weight ].a11;
+		}
+		
+		const __m128 x = _mm_loadu_ps( positionsX + i );
+		const __m128 y = _mm_loadu_ps( positionsY + i );
+		const __m128 z = _mm_loadu_ps( positionsZ + i );
+		
+		// each row of the four matrices is transposed to get one matrix coefficient of all
+		// four positions in one register
+		__m128 c1 = _mm_loadu_ps( matrices[ 0 ] );
+		__m128 c2 = _mm_loadu_ps( matrices[ 1 ] );
+		__m128 c3 = _mm_loadu_ps( matrices[ 2 ] );
+		__m128 c4 = _mm_loadu_ps( matrices[ 3 ] );
+		_MM_TRANSPOSE4_PS( c1, c2, c3, c4 );
+		const __m128 tx = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( c1, x ),
+			_mm_mul_ps( c2, y ) ), _mm_mul_ps( c3, z ) ), c4 );
+			
+		c1 = _mm_loadu_ps( matrices[ 0 ] + 4 );
+		c2 = _mm_loadu_ps( matrices[ 1 ] + 4 );
+		c3 = _mm_loadu_ps( matrices[ 2 ] + 4 );
+		c4 = _mm_loadu_ps( matrices[ 3 ] + 4 );
+		_MM_TRANSPOSE4_PS( c1, c2, c3, c4 );
+		const __m128 ty = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( c1, x ),
+			_mm_mul_ps( c2, y ) ), _mm_mul_ps( c3, z ) ), c4 );
+			
+		c1 = _mm_loadu_ps( matrices[ 0 ] + 8 );
+		c2 = _mm_loadu_ps( matrices[ 1 ] + 8 );
+		c3 = _mm_loadu_ps( matrices[ 2 ] + 8 );
+		c4 = _mm_loadu_ps( matrices[ 3 ] + 8 );
+		_MM_TRANSPOSE4_PS( c1, c2, c3, c4 );
+		const __m128 tz = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( c1, x ),
+			_mm_mul_ps( c2, y ) ), _mm_mul_ps( c3, z ) ), c4 );
+			
+		// interleave to x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+		const __m128 xy01 = _mm_unpacklo_ps( tx, ty );
+		const __m128 xy23 = _mm_unpackhi_ps( tx, ty );
+		const __m128 z0x1 = _mm_shuffle_ps( tz, tx, _MM_SHUFFLE( 1, 1, 0, 0 ) );
+		const __m128 y1z1 = _mm_shuffle_ps( ty, tz, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+		const __m128 z2x3 = _mm_shuffle_ps( tz, tx, _MM_SHUFFLE( 3, 3, 2, 2 ) );
+		const __m128 y3z3 = _mm_shuffle_ps( ty, tz, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+		const __m128 out1 = _mm_shuffle_ps( xy01, z0x1, _MM_SHUFFLE( 2, 0, 1, 0 ) );
+		const __m128 out2 = _mm_shuffle_ps( y1z1, xy23, _MM_SHUFFLE( 1, 0, 2, 0 ) );
+		const __m128 out3 = _mm_shuffle_ps( z2x3, y3z3, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+		
+		// the last group can be partial. store it to a temporary buffer to not write past
+		// the end of the positions array
+		if( i + 4 <= positionCount ){
+			_mm_storeu_ps( output + i * 3, out1 );
+			_mm_storeu_ps( output + i * 3 + 4, out2 );
+			_mm_storeu_ps( output + i * 3 + 8, out3 );
+			
+		}else{
+			_mm_storeu_ps( tail, out1 );
+			_mm_storeu_ps( tail + 4, out2 );
+			_mm_storeu_ps( tail + 8, out3 );
+			memcpy( output + i * 3, tail, sizeof( float ) * 3 * ( positionCount - i ) );
+		}
+	}
+	
+#else
+	int i;
+	
+	for( i=0; i<positionCount; i++ ){
+		const float x = skinPositions[ i ];
+		const float y = skinPositions[ skinPositionStride + i ];
+		const float z = skinPositions[ skinPositionStride * 2 + i ];
+		oglVector &trpos = positions[ i ];
+		
+		if( skinWeights[ i ] == -1 ){
+			trpos.x = x;
+			trpos.y = y;
+			trpos.z = z;
+			
+		}else{
+			const oglMatrix3x4 &matrix = weights[ skinWeights[ i ] ];
+			trpos.x = matrix.a11 * x + matrix.a12 * y + matrix.a13 * z + matrix.a14;
+			trpos.y = matrix.a21 * x + matrix.a22 * y + matrix.a23 * z + matrix.a24;
+			trpos.z = matrix.a31 * x + matrix.a32 * y + matrix.a33 * z + matrix.a34;
+		}
+	}
+#endif
+}
+
+void deoglCPUSkinning::CalculateNormalsTangents( const oglVector *positions, const decVector2 *texCoords,
+const oglModelVertex *vertices, const deoglModelFace *faces, int faceCount,
+oglVector *faceNormals, oglVector *realNormals, int realNormalCount,
+oglVector *normals, int normalCount, oglVector *tangents, int tangentCount ){
+#ifdef OGL_CPUSKINNING_SSE
+	pResetVectors( realNormals, realNormalCount );
+	pResetVectors( normals, normalCount );
+	pResetVectors( tangents, tangentCount );
+	
+	// face normals and tangents are calculated for four faces at the same time. the vertex
+	// data is gathered into structure of arrays layout and the results are scattered back
+	// since faces index vertices freely
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.0f );
+	float e1x[ 4 ], e1y[ 4 ], e1z[ 4 ], e2x[ 4 ], e2y[ 4 ], e2z[ 4 ];
+	float d1y[ 4 ], d2y[ 4 ];
+	float nx[ 4 ], ny[ 4 ], nz[ 4 ], tx[ 4 ], ty[ 4 ], tz[ 4 ];
+	const oglModelVertex *points[ 4 ][ 3 ];
+	int i, j;
+	
+	for( i=0; i<faceCount; i+=4 ){
+		const int count = decMath::min( faceCount - i, 4 );
+		
+		for( j=0; j<count; j++ ){
+			const deoglModelFace &face = faces[ i + j ];
+			const oglModelVertex &point1 = vertices[ face.GetVertex1() ];
+			const oglModelVertex &point2 = vertices[ face.GetVertex2() ];
+			const oglModelVertex &point3 = vertices[ face.GetVertex3() ];
+			const oglVector &position1 = positions[ point1.position ];
+			const oglVector &position2 = positions[ point2.position ];
+			const oglVector &position3 = positions[ point3.position ];
+			const float texCoordY1 = texCoords[ point1.texcoord ].y;
+			
+			points[ j ][ 0 ] = &point1;
+			points[ j ][ 1 ] = &point2;
+			points[ j ][ 2 ] = &point3;
+			
+			e1x[ j ] = position2.x - position1.x;
+			e1y[ j ] = position2.y - position1.y;
+			e1z[ j ] = position2.z - position1.z;
+			e2x[ j ] = position3.x - position1.x;
+			e2y[ j ] = position3.y - position1.y;
+			e2z[ j ] = position3.z - position1.z;
+			d1y[ j ] = texCoords[ point2.texcoord ].y - texCoordY1;
+			d2y[ j ] = texCoords[ point3.texcoord ].y - texCoordY1;
+		}
+		for( ; j<4; j++ ){
+			e1x[ j ] = e1y[ j ] = e1z[ j ] = e2x[ j ] = e2y[ j ] = e2z[ j ] = 0.0f;
+			d1y[ j ] = d2y[ j ] = 0.0f;
+		}
+		
+		const __m128 edge1X = _mm_loadu_ps( e1x );
+		const __m128 edge1Y = _mm_loadu_ps( e1y );
+		const __m128 edge1Z = _mm_loadu_ps( e1z );
+		const __m128 edge2X = _mm_loadu_ps( e2x );
+		const __m128 edge2Y = _mm_loadu_ps( e2y );
+		const __m128 edge2Z = _mm_loadu_ps( e2z );
+		const __m128 delta1Y = _mm_loadu_ps( d1y );
+		const __m128 delta2Y = _mm_loadu_ps( d2y );
+		
+		// normal = normalize( edge1 % edge2 ) or (0,1,0) if zero length
+		__m128 normalX = _mm_sub_ps( _mm_mul_ps( edge1Y, edge2Z ), _mm_mul_ps( edge1Z, edge2Y ) );
+		__m128 normalY = _mm_sub_ps( _mm_mul_ps( edge1Z, edge2X ), _mm_mul_ps( edge1X, edge2Z ) );
+		__m128 normalZ = _mm_sub_ps( _mm_mul_ps( edge1X, edge2Y ), _mm_mul_ps( edge1Y, edge2X ) );
+		__m128 length = _mm_sqrt_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( normalX, normalX ),
+			_mm_mul_ps( normalY, normalY ) ), _mm_mul_ps( normalZ, normalZ ) ) );
+		__m128 valid = _mm_cmpneq_ps( length, zero );
+		__m128 invLength = _mm_div_ps( one, fSelect( valid, length, one ) );
+		
+		_mm_storeu_ps( nx, _mm_and_ps( valid, _mm_mul_ps( normalX, invLength ) ) );
+		_mm_storeu_ps( ny, fSelect( valid, _mm_mul_ps( normalY, invLength ), one ) );
+		_mm_storeu_ps( nz, _mm_and_ps( valid, _mm_mul_ps( normalZ, invLength ) ) );
+		
+		// tangent = normalize( edge1 * d2.y - edge2 * d1.y ) or (1,0,0) if zero length
+		const __m128 tangentX = _mm_sub_ps( _mm_mul_ps( edge1X, delta2Y ), _mm_mul_ps( edge2X, delta1Y ) );
+		const __m128 tangentY = _mm_sub_ps( _mm_mul_ps( edge1Y, delta2Y ), _mm_mul_ps( edge2Y, delta1Y ) );
+		const __m128 tangentZ = _mm_sub_ps( _mm_mul_ps( edge1Z, delta2Y ), _mm_mul_ps( edge2Z, delta1Y ) );
+		length = _mm_sqrt_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( tangentX, tangentX ),
+			_mm_mul_ps( tangentY, tangentY ) ), _mm_mul_ps( tangentZ, tangentZ ) ) );
+		valid = _mm_cmpneq_ps( length, zero );
+		invLength = _mm_div_ps( one, fSelect( valid, length, one ) );
+		
+		_mm_storeu_ps( tx, fSelect( valid, _mm_mul_ps( tangentX, invLength ), one ) );
+		_mm_storeu_ps( ty, _mm_and_ps( valid, _mm_mul_ps( tangentY, invLength ) ) );
+		_mm_storeu_ps( tz, _mm_and_ps( valid, _mm_mul_ps( tangentZ, invLength ) ) );
+		
+		// scatter
+		for( j=0; j<count; j++ ){
+			oglVector &faceNormal = faceNormals[ i + j ];
+			faceNormal.x = nx[ j ];
+			faceNormal.y = ny[ j ];
+			faceNormal.z = nz[ j ];
+			
+			const oglModelVertex ** const facePoints = points[ j ];
+			int k;
+			
+			for( k=0; k<3; k++ ){
+				const oglModelVertex &point = *facePoints[ k ];
+				
+				oglVector &realNormal = realNormals[ point.position ];
+				realNormal.x += nx[ j ];
+				realNormal.y += ny[ j ];
+				realNormal.z += nz[ j ];
+				
+				oglVector &normal = normals[ point.normal ];
+				normal.x += nx[ j ];
+				normal.y += ny[ j ];
+				normal.z += nz[ j ];
+				
+				oglVector &tangent = tangents[ point.tangent ];
+				tangent.x += tx[ j ];
+				tangent.y += ty[ j ];
+				tangent.z += tz[ j ];
+			}
+		}
+	}
+	
+	pFixZeroVectors( realNormals, realNormalCount, 0.0f, 1.0f, 0.0f );
+	pFixZeroVectors( normals, normalCount, 0.0f, 1.0f, 0.0f );
+	pFixZeroVectors( tangents, tangentCount, 1.0f, 0.0f, 0.0f );
+	
+#else
+	CalculateNormalsTangentsScalar( positions, texCoords, vertices, faces, faceCount, faceNormals,
+		realNormals, realNormalCount, normals, normalCount, tangents, tangentCount );
+#endif
+}
+
+
+
+// Reference implementation
+/////////////////////////////
+
+void deoglCPUSkinning::CalculateWeightsScalar( oglMatrix3x4 *weights, int weightsCount,
+const oglMatrix3x4 *boneMatrices, const oglModelWeight *entries, const int *entryCounts ){
+	int w, e;
+	
+	for( w=0; w<weightsCount; w++ ){
+		oglMatrix3x4 &weightsMatrix = weights[ w ];
+		const int entryCount = entryCounts[ w ];
+		
+		if( entryCount == 0 ){
+			weightsMatrix = vIdentityMatrix;
+			
+		}else if( entryCount == 1 ){
+			weightsMatrix = boneMatrices[ entries->bone ];
+			entries++;
+			
+		}else{
+			const oglMatrix3x4 &firstMatrix = boneMatrices[ entries->bone ];
+			float factor = entries->weight;
+			
+			weightsMatrix.a11 = firstMatrix.a11 * factor;
+			weightsMatrix.a12 = firstMatrix.a12 * factor;
+			weightsMatrix.a13 = firstMatrix.a13 * factor;
+			weightsMatrix.a14 = firstMatrix.a14 * factor;
+			weightsMatrix.a21 = firstMatrix.a21 * factor;
+			weightsMatrix.a22 = firstMatrix.a22 * factor;
+			weightsMatrix.a23 = firstMatrix.a23 * factor;
+			weightsMatrix.a24 = firstMatrix.a24 * factor;
+			weightsMatrix.a31 = firstMatrix.a31 * factor;
+			weightsMatrix.a32 = firstMatrix.a32 * factor;
+			weightsMatrix.a33 = firstMatrix.a33 * factor;
+			weightsMatrix.a34 = firstMatrix.a34 * factor;
+			entries++;
+			
+			for( e=1; e<entryCount; e++ ){
+				const oglMatrix3x4 &boneMatrix = boneMatrices[ entries->bone ];
+				factor = entries->weight;
+				
+				weightsMatrix.a11 += boneMatrix.a11 * factor;
+				weightsMatrix.a12 += boneMatrix.a12 * factor;
+				weightsMatrix.a13 += boneMatrix.a13 * factor;
+				weightsMatrix.a14 += boneMatrix.a14 * factor;
+				weightsMatrix.a21 += boneMatrix.a21 * factor;
+				weightsMatrix.a22 += boneMatrix.a22 * factor;
+				weightsMatrix.a23 += boneMatrix.a23 * factor;
+				weightsMatrix.a24 += boneMatrix.a24 * factor;
+				weightsMatrix.a31 += boneMatrix.a31 * factor;
+				weightsMatrix.a32 += boneMatrix.a32 * factor;
+				weightsMatrix.a33 += boneMatrix.a33 * factor;
+				weightsMatrix.a34 += boneMatrix.a34 * factor;
+				entries++;
+			}
+		}
+	}
+}
+
+void deoglCPUSkinning::TransformPositionsScalar( oglVector *positions,
+const oglModelPosition *modelPositions, int positionCount, const oglMatrix3x4 *weights ){
+	int i;
+	
+	for( i=0; i<positionCount; i++ ){
+		const oglModelPosition &modelPosition = modelPositions[ i ];
+		const decVector &orgpos = modelPosition.position;
+		oglVector &trpos = positions[ i ];
+		
+		if( modelPosition.weight == -1 ){
+			trpos.x = orgpos.x;
+			trpos.y = orgpos.y;
+			trpos.z = orgpos.z;
+			
+		}else{
+			const oglMatrix3x4 &matrix = weights[ modelPosition.weight ];
+			
+			trpos.x = matrix.a11 * orgpos.x + matrix.a12 * orgpos.y + matrix.a13 * orgpos.z + matrix.a14;
+			trpos.y = matrix.a21 * orgpos.x + matrix.a22 * orgpos.y + matrix.a23 * orgpos.z + matrix.a24;
+			trpos.z = matrix.a31 * orgpos.x + matrix.a32 * orgpos.y + matrix.a33 * orgpos.z + matrix.a34;
+		}
+	}
+}
+
+void deoglCPUSkinning::CalculateNormalsTangentsScalar( const oglVector *positions,
+const decVector2 *texCoords, const oglModelVertex *vertices, const deoglModelFace *faces,
+int faceCount, oglVector *faceNormals, oglVector *realNormals, int realNormalCount,
+oglVector *normals, int normalCount, oglVector *tangents, int tangentCount ){
+	oglVector edge1, edge2;
+	oglVector tangent;
+	decVector2 d1, d2;
+	float len, invlen;
+	int i, j;
+	
+	pResetVectors( realNormals, realNormalCount );
+	pResetVectors( normals, normalCount );
+	pResetVectors( tangents, tangentCount );
+	
+	for( i=0; i<faceCount; i++ ){
+		const deoglModelFace &face = faces[ i ];
+		const oglModelVertex * const facePoints[ 3 ] = {
+			vertices + face.GetVertex1(), vertices + face.GetVertex2(), vertices + face.GetVertex3() };
+		const oglVector &position1 = positions[ facePoints[ 0 ]->position ];
+		const oglVector &position2 = positions[ facePoints[ 1 ]->position ];
+		const oglVector &position3 = positions[ facePoints[ 2 ]->position ];
+		const decVector2 &texcoord1 = texCoords[ facePoints[ 0 ]->texcoord ];
+		const decVector2 &texcoord2 = texCoords[ facePoints[ 1 ]->texcoord ];
+		const decVector2 &texcoord3 = texCoords[ facePoints[ 2 ]->texcoord ];
+		
+		oglVector &faceNormal = faceNormals[ i ];
+		
+		// calculate edges
+		edge1.x = position2.x - position1.x;
+		edge1.y = position2.y - position1.y;
+		edge1.z = position2.z - position1.z;
+		edge2.x = position3.x - position1.x;
+		edge2.y = position3.y - position1.y;
+		edge2.z = position3.z - position1.z;
+		
+		// calculate normal
+		faceNormal.x = edge1.y * edge2.z - edge1.z * edge2.y;
+		faceNormal.y = edge1.z * edge2.x - edge1.x * edge2.z;
+		faceNormal.z = edge1.x * edge2.y - edge1.y * edge2.x;
+		
+		len = sqrtf( faceNormal.x * faceNormal.x + faceNormal.y * faceNormal.y + faceNormal.z * faceNormal.z );
+		if( len != 0.0f ){
+			invlen = 1.0f / len;
+			faceNormal.x *= invlen;
+			faceNormal.y *= invlen;
+			faceNormal.z *= invlen;
+			
+		}else{
+			faceNormal.x = 0.0f;
+			faceNormal.y = 1.0f;
+			faceNormal.z = 0.0f;
+		}
+		
+		// calculate texture coordinate deltas
+		d1 = texcoord2 - texcoord1;
+		d2 = texcoord3 - texcoord1;
+		
+		// calculate tangent
+		tangent.x = edge1.x * d2.y - edge2.x * d1.y;
+		tangent.y = edge1.y * d2.y - edge2.y * d1.y;
+		tangent.z = edge1.z * d2.y - edge2.z * d1.y;
+		
+		len = sqrtf( tangent.x * tangent.x + tangent.y * tangent.y + tangent.z * tangent.z );
+		if( len != 0.0f ){
+			invlen = 1.0f / len;
+			tangent.x *= invlen;
+			tangent.y *= invlen;
+			tangent.z *= invlen;
+			
+		}else{
+			tangent.x = 1.0f;
+			tangent.y = 0.0f;
+			tangent.z = 0.0f;
+		}
+		
+		// add to real normals, normals and tangents
+		for( j=0; j<3; j++ ){
+			const oglModelVertex &point = *facePoints[ j ];
+			
+			oglVector &vrn = realNormals[ point.position ];
+			vrn.x += faceNormal.x;
+			vrn.y += faceNormal.y;
+			vrn.z += faceNormal.z;
+			
+			oglVector &vn = normals[ point.normal ];
+			vn.x += faceNormal.x;
+			vn.y += faceNormal.y;
+			vn.z += faceNormal.z;
+			
+			oglVector &vt = tangents[ point.tangent ];
+			vt.x += tangent.x;
+			vt.y += tangent.y;
+			vt.z += tangent.z;
+		}
+	}
+	
+	// shaders do not require normalized normals and tangents but to prevent problems due to
+	// zero length vectors we filter them out now in a fast way
+	pFixZeroVectors( realNormals, realNormalCount, 0.0f, 1.0f, 0.0f );
+	pFixZeroVectors( normals, normalCount, 0.0f, 1.0f, 0.0f );
+	pFixZeroVectors( tangents, tangentCount, 1.0f, 0.0f, 0.0f );
+}
+
+
+
+// Private Functions
+//////////////////////
+
+void deoglCPUSkinning::pResetVectors( oglVector *vectors, int count ){
+	if( count > 0 ){
+		memset( vectors, 0, sizeof( oglVector ) * count );
+	}
+}
+
+void deoglCPUSkinning::pFixZeroVectors( oglVector *vectors, int count, float x, float y, float z ){
+	int i;
+	
+	for( i=0; i<count; i++ ){
+		oglVector &vector = vectors[ i ];
+		if( vector.x == 0.0f && vector.y == 0.0f && vector.z == 0.0f ){
+			vector.x = x;
+			vector.y = y;
+			vector.z = z;
+		}
+	}
+}
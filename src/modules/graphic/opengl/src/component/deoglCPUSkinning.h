@@ -0,0 +1,100 @@
+/* 
+ * Drag[en]gine OpenGL Graphic Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEOGLCPUSKINNING_H_
+#define _DEOGLCPUSKINNING_H_
+
+#include "../deoglBasics.h"
+#include "../model/deoglModelLOD.h"
+
+#include <dragengine/common/math/decMath.h>
+
+class deoglModelFace;
+
+
+
+/**
+ * \brief CPU skinning kernels.
+ * 
+ * Calculates skinned positions, normals and tangents on the CPU. If SSE2 is available four
+ * weight matrices, positions or faces are processed at the same time. Positions are read
+ * from the structure of arrays layout prepared by deoglModelLOD. The scalar versions are
+ * the reference implementation used if SSE2 is not available and for testing.
+ */
+class deoglCPUSkinning{
+public:
+	/** \name Skinning */
+	/*@{*/
+	/** \brief Calculate weight matrices from bone matrices. */
+	static void CalculateWeights( oglMatrix3x4 *weights, int weightsCount,
+		const oglMatrix3x4 *boneMatrices, const oglModelWeight *entries, const int *entryCounts );
+		
+	/**
+	 * \brief Transform positions by weight matrices.
+	 * 
+	 * \param[in] skinPositions Positions in structure of arrays layout. X coordinates are
+	 *                          stored first followed by Y and Z coordinates each block
+	 *                          skinPositionStride floats long.
+	 * \param[in] skinWeights Weight matrix index for each position or -1 for unweighted.
+	 *                        Padded to a multiple of 4 with -1.
+	 */
+	static void TransformPositions( oglVector *positions, int positionCount,
+		const float *skinPositions, int skinPositionStride, const int *skinWeights,
+		const oglMatrix3x4 *weights );
+		
+	/**
+	 * \brief Calculate face normals and accumulated real normals, normals and tangents.
+	 * 
+	 * Vectors with zero length are replaced with default vectors.
+	 */
+	static void CalculateNormalsTangents( const oglVector *positions, const decVector2 *texCoords,
+		const oglModelVertex *vertices, const deoglModelFace *faces, int faceCount,
+		oglVector *faceNormals, oglVector *realNormals, int realNormalCount,
+		oglVector *normals, int normalCount, oglVector *tangents, int tangentCount );
+	/*@}*/
+	
+	
+	
+	/** \name Reference implementation */
+	/*@{*/
+	/** \brief Calculate weight matrices from bone matrices. */
+	static void CalculateWeightsScalar( oglMatrix3x4 *weights, int weightsCount,
+		const oglMatrix3x4 *boneMatrices, const oglModelWeight *entries, const int *entryCounts );
+		
+	/** \brief Transform positions by weight matrices. */
+	static void TransformPositionsScalar( oglVector *positions, const oglModelPosition *modelPositions,
+		int positionCount, const oglMatrix3x4 *weights );
+		
+	/** \brief Calculate face normals and accumulated real normals, normals and tangents. */
+	static void CalculateNormalsTangentsScalar( const oglVector *positions, const decVector2 *texCoords,
+		const oglModelVertex *vertices, const deoglModelFace *faces, int faceCount,
+		oglVector *faceNormals, oglVector *realNormals, int realNormalCount,
+		oglVector *normals, int normalCount, oglVector *tangents, int tangentCount );
+	/*@}*/
+	
+	
+	
+private:
+	static void pResetVectors( oglVector *vectors, int count );
+	static void pFixZeroVectors( oglVector *vectors, int count, float x, float y, float z );
+};
+
+#endif
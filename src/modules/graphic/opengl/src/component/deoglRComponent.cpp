@@ -150,6 +150,9 @@ pLLWorldNext( NULL )
 	
 	pBoneMatrices = NULL;
 	pBoneMatrixCount = 0;
+	pSharedWeights = NULL;
+	pSharedWeightCount = 0;
+	pHasSharedWeights = false;
 	
 	pRenderMode = ermStatic;
 	
@@ -270,6 +273,10 @@ void deoglRComponent::SetLayerMask( const decLayerMask &layerMask ){
 	
 	pLayerMask = layerMask;
 	
+	if( pOctreeNode ){
+		pOctreeNode->UpdateComponentCullBox( this );
+	}
+	
 	// light shadow matching potentially changed
 	const deoglLightList list( pLightList );
 	const int count = list.GetCount();
@@ -707,6 +714,8 @@ void deoglRComponent::UpdateBoneMatrices( deComponent &component ){
 			boneMatrix.a34 = matrix.a34;
 		}
 	}
+	
+	pUpdateSharedWeights( component );
 }
 
 
@@ -1311,7 +1320,15 @@ void deoglRComponent::AddLOD( deoglRComponentLOD *lod ){
 }
 
 void deoglRComponent::SetLODErrorScaling( float errorScaling ){
+	if( fabsf( errorScaling - pLODErrorScaling ) < FLOAT_SAFE_EPSILON ){
+		return;
+	}
+	
 	pLODErrorScaling = errorScaling;
+	
+	if( pOctreeNode ){
+		pOctreeNode->UpdateComponentCullBox( this );
+	}
 }
 
 
@@ -1600,6 +1617,9 @@ void deoglRComponent::pCleanUp(){
 	if( pBoneMatrices ){
 		delete [] pBoneMatrices;
 	}
+	if( pSharedWeights ){
+		delete [] pSharedWeights;
+	}
 	
 	if( pOccMeshSharedSPBDoubleSided ){
 		pOccMeshSharedSPBDoubleSided->FreeReference();
@@ -2034,6 +2054,56 @@ void deoglRComponent::pResizeBoneMatrices(){
 	}
 }
 
+void deoglRComponent::pUpdateSharedWeights( deComponent &component ){
+	// if another module skinned the component already the weights of the first LOD are
+	// copied. the first LOD uses them instead of calculating the weights again
+	pHasSharedWeights = false;
+	
+	if( ! pModel || pModel->GetLODCount() == 0 ){
+		return;
+	}
+	
+	const int weightCount = pModel->GetLODAt( 0 ).GetWeightsCount();
+	if( weightCount == 0 || ! component.UseSharedSkinnedWeights( deComponent::esrGraphic )
+	|| component.GetSkinnedWeightCount() != weightCount ){
+		return;
+	}
+	
+	if( weightCount != pSharedWeightCount ){
+		if( pSharedWeights ){
+			delete [] pSharedWeights;
+			pSharedWeights = NULL;
+			pSharedWeightCount = 0;
+		}
+		
+		pSharedWeights = new oglMatrix3x4[ weightCount ];
+		pSharedWeightCount = weightCount;
+	}
+	
+	const decMatrix * const weights = component.GetSkinnedWeights();
+	int i;
+	
+	for( i=0; i<weightCount; i++ ){
+		const decMatrix &weight = weights[ i ];
+		oglMatrix3x4 &sharedWeight = pSharedWeights[ i ];
+		
+		sharedWeight.a11 = weight.a11;
+		sharedWeight.a12 = weight.a12;
+		sharedWeight.a13 = weight.a13;
+		sharedWeight.a14 = weight.a14;
+		sharedWeight.a21 = weight.a21;
+		sharedWeight.a22 = weight.a22;
+		sharedWeight.a23 = weight.a23;
+		sharedWeight.a24 = weight.a24;
+		sharedWeight.a31 = weight.a31;
+		sharedWeight.a32 = weight.a32;
+		sharedWeight.a33 = weight.a33;
+		sharedWeight.a34 = weight.a34;
+	}
+	
+	pHasSharedWeights = true;
+}
+
 
 
 void deoglRComponent::pRemoveFromAllLights(){
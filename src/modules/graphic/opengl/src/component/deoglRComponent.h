@@ -112,6 +112,9 @@ public:
 	// dynamic model data
 	oglMatrix3x4 *pBoneMatrices;
 	int pBoneMatrixCount;
+	oglMatrix3x4 *pSharedWeights;
+	int pSharedWeightCount;
+	bool pHasSharedWeights;
 	
 	// for world
 	bool pLit;
@@ -414,6 +417,18 @@ public:
 	/** \brief Update the bone matrices if required. */
 	void UpdateBoneMatrices( deComponent &component );
 	
+	/**
+	 * \brief Weights of the first LOD skinned by the engine are present.
+	 * \details Present if another module skinned the component before synchronizing.
+	 */
+	inline bool GetHasSharedWeights() const{ return pHasSharedWeights; }
+	
+	/** \brief Weights of the first LOD skinned by the engine. */
+	inline const oglMatrix3x4 *GetSharedWeights() const{ return pSharedWeights; }
+	
+	/** \brief Number of weights of the first LOD skinned by the engine. */
+	inline int GetSharedWeightCount() const{ return pSharedWeightCount; }
+	
 	
 	
 	/** \brief Point offset. */
@@ -705,6 +720,7 @@ private:
 	void pUpdateSolid();
 	
 	void pResizeBoneMatrices();
+	void pUpdateSharedWeights( deComponent &component );
 	
 	void pRemoveFromAllLights();
 };
@@ -24,6 +24,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "deoglCPUSkinning.h"
 #include "deoglRComponent.h"
 #include "deoglRComponentLOD.h"
 #include "../capabilities/deoglCapabilities.h"
@@ -1200,92 +1201,17 @@ void deoglRComponentLOD::pUpdateVAO( deoglModelLOD &modelLOD ){
 
 
 void deoglRComponentLOD::pCalculateWeights( const deoglModelLOD &modelLOD ){
-	const oglModelWeight * weightsEntries = modelLOD.GetWeightsEntries();
-	const int * const weightsCounts = modelLOD.GetWeightsCounts();
-	const int weightsCount = modelLOD.GetWeightsCount();
-	int w, e, entryCount;
-	float factor;
-	
 	//pComponent.UpdateBoneMatrices(); // done already by deoglComponent during synching
 	
-	const oglMatrix3x4 * const boneMatrices = pComponent.GetBoneMatrices();
-	
-	for( w=0; w<weightsCount; w++ ){
-		oglMatrix3x4 &weightsMatrix = pWeights[ w ];
-		entryCount = weightsCounts[ w ];
-		
-		if( entryCount == 0 ){
-			weightsMatrix.a11 = 1.0f;
-			weightsMatrix.a12 = 0.0f;
-			weightsMatrix.a13 = 0.0f;
-			weightsMatrix.a14 = 0.0f;
-			weightsMatrix.a21 = 0.0f;
-			weightsMatrix.a22 = 1.0f;
-			weightsMatrix.a23 = 0.0f;
-			weightsMatrix.a24 = 0.0f;
-			weightsMatrix.a31 = 0.0f;
-			weightsMatrix.a32 = 0.0f;
-			weightsMatrix.a33 = 1.0f;
-			weightsMatrix.a34 = 0.0f;
-			
-		}else if( entryCount == 1 ){
-			const oglMatrix3x4 &boneMatrix = boneMatrices[ weightsEntries->bone ];
-			
-			weightsMatrix.a11 = boneMatrix.a11;
-			weightsMatrix.a12 = boneMatrix.a12;
-			weightsMatrix.a13 = boneMatrix.a13;
-			weightsMatrix.a14 = boneMatrix.a14;
-			weightsMatrix.a21 = boneMatrix.a21;
-			weightsMatrix.a22 = boneMatrix.a22;
-			weightsMatrix.a23 = boneMatrix.a23;
-			weightsMatrix.a24 = boneMatrix.a24;
-			weightsMatrix.a31 = boneMatrix.a31;
-			weightsMatrix.a32 = boneMatrix.a32;
-			weightsMatrix.a33 = boneMatrix.a33;
-			weightsMatrix.a34 = boneMatrix.a34;
-			
-			weightsEntries++;
-			
-		}else{
-			const oglMatrix3x4 &boneMatrix = boneMatrices[ weightsEntries->bone ];
-			factor = weightsEntries->weight;
-			
-			weightsMatrix.a11 = boneMatrix.a11 * factor;
-			weightsMatrix.a12 = boneMatrix.a12 * factor;
-			weightsMatrix.a13 = boneMatrix.a13 * factor;
-			weightsMatrix.a14 = boneMatrix.a14 * factor;
-			weightsMatrix.a21 = boneMatrix.a21 * factor;
-			weightsMatrix.a22 = boneMatrix.a22 * factor;
-			weightsMatrix.a23 = boneMatrix.a23 * factor;
-			weightsMatrix.a24 = boneMatrix.a24 * factor;
-			weightsMatrix.a31 = boneMatrix.a31 * factor;
-			weightsMatrix.a32 = boneMatrix.a32 * factor;
-			weightsMatrix.a33 = boneMatrix.a33 * factor;
-			weightsMatrix.a34 = boneMatrix.a34 * factor;
-			
-			weightsEntries++;
-			
-			for( e=1; e<entryCount; e++ ){
-				const oglMatrix3x4 &boneMatrix = boneMatrices[ weightsEntries->bone ];
-				factor = weightsEntries->weight;
-				
-				weightsMatrix.a11 += boneMatrix.a11 * factor;
-				weightsMatrix.a12 += boneMatrix.a12 * factor;
-				weightsMatrix.a13 += boneMatrix.a13 * factor;
-				weightsMatrix.a14 += boneMatrix.a14 * factor;
-				weightsMatrix.a21 += boneMatrix.a21 * factor;
-				weightsMatrix.a22 += boneMatrix.a22 * factor;
-				weightsMatrix.a23 += boneMatrix.a23 * factor;
-				weightsMatrix.a24 += boneMatrix.a24 * factor;
-				weightsMatrix.a31 += boneMatrix.a31 * factor;
-				weightsMatrix.a32 += boneMatrix.a32 * factor;
-				weightsMatrix.a33 += boneMatrix.a33 * factor;
-				weightsMatrix.a34 += boneMatrix.a34 * factor;
-				
-				weightsEntries++;
-			}
-		}
+	// the first LOD uses the weights skinned by the engine if present
+	if( pLODIndex == 0 && pComponent.GetHasSharedWeights()
+	&& pComponent.GetSharedWeightCount() == modelLOD.GetWeightsCount() ){
+		memcpy( pWeights, pComponent.GetSharedWeights(), sizeof( oglMatrix3x4 ) * modelLOD.GetWeightsCount() );
+		return;
 	}
+	
+	deoglCPUSkinning::CalculateWeights( pWeights, modelLOD.GetWeightsCount(), pComponent.GetBoneMatrices(),
+		modelLOD.GetWeightsEntries(), modelLOD.GetWeightsCounts() );
 #if 0
 	if( weightsCount > 0 ){
 		deGraphicOpenGl &ogl = *pComponent.GetOgl();
@@ -1315,198 +1241,22 @@ void deoglRComponentLOD::pCalculateWeights( const deoglModelLOD &modelLOD ){
 }
 
 void deoglRComponentLOD::pTransformVertices( const deoglModelLOD &modelLOD ){
-	const oglModelPosition * const positions = modelLOD.GetPositions();
-	const int positionCount = modelLOD.GetPositionCount();
-	int i;
-	
-	for( i=0; i<positionCount; i++ ){
-		const oglModelPosition &modelPosition = positions[ i ];
-		const decVector &orgpos = positions[ i ].position;
-		oglVector &trpos = pPositions[ i ];
-		
-		if( modelPosition.weight == -1 ){
-			trpos.x = orgpos.x;
-			trpos.y = orgpos.y;
-			trpos.z = orgpos.z;
-			
-		}else{
-			const oglMatrix3x4 &matrix = pWeights[ modelPosition.weight ];
+	if( modelLOD.GetSkinPositions() ){
+		deoglCPUSkinning::TransformPositions( pPositions, modelLOD.GetPositionCount(),
+			modelLOD.GetSkinPositions(), modelLOD.GetSkinPositionStride(),
+			modelLOD.GetSkinWeights(), pWeights );
 			
-			trpos.x = matrix.a11 * orgpos.x + matrix.a12 * orgpos.y + matrix.a13 * orgpos.z + matrix.a14;
-			trpos.y = matrix.a21 * orgpos.x + matrix.a22 * orgpos.y + matrix.a23 * orgpos.z + matrix.a24;
-			trpos.z = matrix.a31 * orgpos.x + matrix.a32 * orgpos.y + matrix.a33 * orgpos.z + matrix.a34;
-		}
+	}else{
+		deoglCPUSkinning::TransformPositionsScalar( pPositions, modelLOD.GetPositions(),
+			modelLOD.GetPositionCount(), pWeights );
 	}
 }
 
 void deoglRComponentLOD::pCalculateNormalsAndTangents( const deoglModelLOD &modelLOD ){
-	const decVector2 * const texcoords = modelLOD.GetTextureCoordinates();
-	const oglModelVertex * const points = modelLOD.GetVertices();
-	const deoglModelFace * const faces = modelLOD.GetFaces();
-	const int positionCount = modelLOD.GetPositionCount();
-	const int tangentCount = modelLOD.GetTangentCount();
-	const int normalCount = modelLOD.GetNormalCount();
-	const int faceCount = modelLOD.GetFaceCount();
-	oglVector edge1, edge2;
-	oglVector tangent;
-	decVector2 d1, d2;
-	float len, invlen;
-	int i;
-	
-	// reset normals and tangents
-	for( i=0; i<positionCount; i++ ){
-		pRealNormals[ i ].x = 0.0f;
-		pRealNormals[ i ].y = 0.0f;
-		pRealNormals[ i ].z = 0.0f;
-	}
-	for( i=0; i<normalCount; i++ ){
-		pNormals[ i ].x = 0.0f;
-		pNormals[ i ].y = 0.0f;
-		pNormals[ i ].z = 0.0f;
-	}
-	for( i=0; i<tangentCount; i++ ){
-		pTangents[ i ].x = 0.0f;
-		pTangents[ i ].y = 0.0f;
-		pTangents[ i ].z = 0.0f;
-	}
-	
-	// calculate normals and tangents
-	for( i=0; i<faceCount; i++ ){
-		const deoglModelFace &face = faces[ i ];
-		const oglModelVertex &point1 = points[ face.GetVertex1() ];
-		const oglModelVertex &point2 = points[ face.GetVertex2() ];
-		const oglModelVertex &point3 = points[ face.GetVertex3() ];
-		const oglVector &position1 = pPositions[ point1.position ];
-		const oglVector &position2 = pPositions[ point2.position ];
-		const oglVector &position3 = pPositions[ point3.position ];
-		const decVector2 &texcoord1 = texcoords[ point1.texcoord ];
-		const decVector2 &texcoord2 = texcoords[ point2.texcoord ];
-		const decVector2 &texcoord3 = texcoords[ point3.texcoord ];
-		
-		oglVector &faceNormal = pFaceNormals[ i ];
-		
-		// calculate edges
-		edge1.x = position2.x - position1.x;
-		edge1.y = position2.y - position1.y;
-		edge1.z = position2.z - position1.z;
-		edge2.x = position3.x - position1.x;
-		edge2.y = position3.y - position1.y;
-		edge2.z = position3.z - position1.z;
-		
-		// calculate normal
-		faceNormal.x = edge1.y * edge2.z - edge1.z * edge2.y;
-		faceNormal.y = edge1.z * edge2.x - edge1.x * edge2.z;
-		faceNormal.z = edge1.x * edge2.y - edge1.y * edge2.x;
-		
-		len = sqrtf( faceNormal.x * faceNormal.x + faceNormal.y * faceNormal.y + faceNormal.z * faceNormal.z );
-		if( len != 0.0f ){
-			invlen = 1.0f / len;
-			faceNormal.x *= invlen;
-			faceNormal.y *= invlen;
-			faceNormal.z *= invlen;
-			
-		}else{
-			faceNormal.x = 0.0f;
-			faceNormal.y = 1.0f;
-			faceNormal.z = 0.0f;
-		}
-		
-		// add to real normals
-		oglVector &vrn1 = pRealNormals[ point1.position ];
-		vrn1.x += faceNormal.x;
-		vrn1.y += faceNormal.y;
-		vrn1.z += faceNormal.z;
-		
-		oglVector &vrn2 = pRealNormals[ point2.position ];
-		vrn2.x += faceNormal.x;
-		vrn2.y += faceNormal.y;
-		vrn2.z += faceNormal.z;
-		
-		oglVector &vrn3 = pRealNormals[ point3.position ];
-		vrn3.x += faceNormal.x;
-		vrn3.y += faceNormal.y;
-		vrn3.z += faceNormal.z;
-		
-		// add to normals
-		oglVector &vn1 = pNormals[ point1.normal ];
-		vn1.x += faceNormal.x;
-		vn1.y += faceNormal.y;
-		vn1.z += faceNormal.z;
-		
-		oglVector &vn2 = pNormals[ point2.normal ];
-		vn2.x += faceNormal.x;
-		vn2.y += faceNormal.y;
-		vn2.z += faceNormal.z;
-		
-		oglVector &vn3 = pNormals[ point3.normal ];
-		vn3.x += faceNormal.x;
-		vn3.y += faceNormal.y;
-		vn3.z += faceNormal.z;
-		
-		// calculate texture coordinate deltas
-		d1 = texcoord2 - texcoord1;
-		d2 = texcoord3 - texcoord1;
-		
-		// calculate tangent
-		tangent.x = edge1.x * d2.y - edge2.x * d1.y;
-		tangent.y = edge1.y * d2.y - edge2.y * d1.y;
-		tangent.z = edge1.z * d2.y - edge2.z * d1.y;
-		
-		len = sqrtf( tangent.x * tangent.x + tangent.y * tangent.y + tangent.z * tangent.z );
-		if( len != 0.0f ){
-			invlen = 1.0f / len;
-			tangent.x *= invlen;
-			tangent.y *= invlen;
-			tangent.z *= invlen;
-			
-		}else{
-			tangent.x = 1.0f;
-			tangent.y = 0.0f;
-			tangent.z = 0.0f;
-		}
-		
-		// add to tangents
-		oglVector &vt1 = pTangents[ point1.tangent ];
-		vt1.x += tangent.x;
-		vt1.y += tangent.y;
-		vt1.z += tangent.z;
-		
-		oglVector &vt2 = pTangents[ point2.tangent ];
-		vt2.x += tangent.x;
-		vt2.y += tangent.y;
-		vt2.z += tangent.z;
-		
-		oglVector &vt3 = pTangents[ point3.tangent ];
-		vt3.x += tangent.x;
-		vt3.y += tangent.y;
-		vt3.z += tangent.z;
-	}
-	
-	// shaders do not require normalized normals and tangents but to prevent problems due to
-	// zero length vectors we filter them out now in a fast way
-	for( i=0; i<positionCount; i++ ){
-		if( pRealNormals[ i ].x == 0.0f && pRealNormals[ i ].y == 0.0f && pRealNormals[ i ].z == 0.0f ){
-			pRealNormals[ i ].x = 0.0f;
-			pRealNormals[ i ].y = 1.0f;
-			pRealNormals[ i ].z = 0.0f;
-		}
-	}
-	
-	for( i=0; i<normalCount; i++ ){
-		if( pNormals[ i ].x == 0.0f && pNormals[ i ].y == 0.0f && pNormals[ i ].z == 0.0f ){
-			pNormals[ i ].x = 0.0f;
-			pNormals[ i ].y = 1.0f;
-			pNormals[ i ].z = 0.0f;
-		}
-	}
-	
-	for( i=0; i<tangentCount; i++ ){
-		if( pTangents[ i ].x == 0.0f && pTangents[ i ].y == 0.0f && pTangents[ i ].z == 0.0f ){
-			pTangents[ i ].x = 1.0f;
-			pTangents[ i ].y = 0.0f;
-			pTangents[ i ].z = 0.0f;
-		}
-	}
+	deoglCPUSkinning::CalculateNormalsTangents( pPositions, modelLOD.GetTextureCoordinates(),
+		modelLOD.GetVertices(), modelLOD.GetFaces(), modelLOD.GetFaceCount(), pFaceNormals,
+		pRealNormals, modelLOD.GetPositionCount(), pNormals, modelLOD.GetNormalCount(),
+		pTangents, modelLOD.GetTangentCount() );
 }
 
 
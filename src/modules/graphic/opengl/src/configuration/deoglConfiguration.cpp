@@ -136,6 +136,7 @@ pBugNo2ComponentFBOTex( false ),
 
 pDebugNoCulling ( false ),
 pOcclusionTestMode( eoctmTransformFeedback ),
+pSoftwareOcclusionCulling( false ),
 
 pQuickDebug( 0 ),
 
@@ -931,6 +932,14 @@ void deoglConfiguration::SetOcclusionTestMode( eOcclusionTestModes mode ){
 	pDirty = true;
 }
 
+void deoglConfiguration::SetSoftwareOcclusionCulling( bool enable ){
+	if( enable == pSoftwareOcclusionCulling ){
+		return;
+	}
+	pSoftwareOcclusionCulling = enable;
+	pDirty = true;
+}
+
 void deoglConfiguration::SetDebugSnapshot( int snapshot ){
 	if( snapshot == pDebugSnapshot ){
 		return;
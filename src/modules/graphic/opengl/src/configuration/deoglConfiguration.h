@@ -159,6 +159,7 @@ private:
 	
 	bool pDebugNoCulling;
 	eOcclusionTestModes pOcclusionTestMode;
+	bool pSoftwareOcclusionCulling;
 	
 	int pQuickDebug;
 	
@@ -504,6 +505,10 @@ public:
 	inline eOcclusionTestModes GetOcclusionTestMode() const{ return pOcclusionTestMode; }
 	/** Sets the occlusion test mode. */
 	void SetOcclusionTestMode( eOcclusionTestModes mode );
+	/** Determines if occlusion meshes are rasterized on the CPU to cull components. */
+	inline bool GetSoftwareOcclusionCulling() const{ return pSoftwareOcclusionCulling; }
+	/** Sets if occlusion meshes are rasterized on the CPU to cull components. */
+	void SetSoftwareOcclusionCulling( bool enable );
 	
 	/** Retrieves the debug snapshot value. */
 	inline int GetDebugSnapshot() const{ return pDebugSnapshot; }
@@ -68,6 +68,7 @@
 #include "parameters/debug/deoglPShowLightCB.h"
 #include "parameters/debug/deoglPOcclusionReduction.h"
 #include "parameters/debug/deoglPOccTestMode.h"
+#include "parameters/debug/deoglPSoftwareOcclusionCulling.h"
 #include "parameters/debug/deoglPWireframeMode.h"
 #include "parameters/defren/deoglPDefRenEncDepth.h"
 #include "parameters/defren/deoglPDefRenSizeLimit.h"
@@ -621,6 +622,7 @@ void deGraphicOpenGl::pCreateParameters() {
 	pParameters.AddParameter( new deoglPDefRenUsePOTs( *this ) );
 	pParameters.AddParameter( new deoglPDefRenSizeLimit( *this ) );
 	pParameters.AddParameter( new deoglPTranspLayerLimit( *this ) );
+	pParameters.AddParameter( new deoglPSoftwareOcclusionCulling( *this ) );
 	
 #ifdef WITH_DEBUG
 	pParameters.AddParameter( new deoglPDebugContext( *this ) );
@@ -19,20 +19,42 @@
  * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
  */
 
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "deoglDeveloperModeTests.h"
+#include "../deGraphicOpenGl.h"
+#include "../billboard/deoglRBillboard.h"
+#include "../collidelist/deoglCollideList.h"
+#include "../component/deoglCPUSkinning.h"
+#include "../model/face/deoglModelFace.h"
+#include "../occlusiontest/deoglSoftwareOcclusionMap.h"
+#include "../rendering/plan/deoglRenderPlan.h"
+#include "../renderthread/deoglRenderThread.h"
 #include "../shaders/paramblock/deoglSPBlockUBO.h"
 #include "../shaders/paramblock/deoglSPBParameter.h"
+#include "../skin/channel/deoglSCConeMapGenerator.h"
+#include "../texture/pixelbuffer/deoglPixelBufferMipMap.h"
+#include "../utils/collision/deoglCullBoxList.h"
+#include "../utils/collision/deoglDCollisionBox.h"
+#include "../utils/collision/deoglDCollisionFrustum.h"
 #include "../utils/convexhull/deoglConvexHull2D.h"
+#include "../world/deoglWorldOctree.h"
 
 #include <dragengine/deEngine.h>
 #include <dragengine/common/exceptions.h>
+#include <dragengine/common/collection/decObjectList.h>
+#include <dragengine/common/collection/decPointerList.h>
 #include <dragengine/common/string/decString.h>
 #include <dragengine/common/string/unicode/decUnicodeString.h>
 #include <dragengine/common/string/unicode/decUnicodeArgumentList.h>
+#include <dragengine/common/utils/decTimer.h>
+#include <dragengine/parallel/deParallelProcessing.h>
+#include <dragengine/resources/billboard/deBillboard.h>
+#include <dragengine/resources/billboard/deBillboardManager.h>
+#include <dragengine/resources/billboard/deBillboardReference.h>
 
 
 
@@ -77,6 +99,12 @@ void deoglDeveloperModeTests::Help( decUnicodeString &answer ){
 	answer.AppendFromUTF8( "where <mode> can be:\n" );
 	answer.AppendFromUTF8( "shaderParameterBlock => Test deoglSPBlockUBO.\n" );
 	answer.AppendFromUTF8( "convexHull2D => Test deoglConvexHull2D.\n" );
+	answer.AppendFromUTF8( "cullBoxList => Test and benchmark deoglCullBoxList.\n" );
+	answer.AppendFromUTF8( "softwareOcclusionMap => Test and benchmark deoglSoftwareOcclusionMap.\n" );
+	answer.AppendFromUTF8( "coneMap => Test and benchmark deoglSCConeMapGenerator.\n" );
+	answer.AppendFromUTF8( "pixelBufferMipMap => Test and benchmark deoglPixelBufferMipMap.\n" );
+	answer.AppendFromUTF8( "cpuSkinning => Test and benchmark deoglCPUSkinning.\n" );
+	answer.AppendFromUTF8( "cullElements => Test and benchmark parallel deoglRenderPlan culling.\n" );
 }
 
 void deoglDeveloperModeTests::Tests( const decUnicodeArgumentList &command, decUnicodeString &answer ){
@@ -90,6 +118,60 @@ void deoglDeveloperModeTests::Tests( const decUnicodeArgumentList &command, decU
 				AnswerTestFailedWithException( answer, e );
 			}
 			
+		}else if( command.MatchesArgumentAt( 1, "cullBoxList" ) ){
+			try{
+				TestCullBoxList( answer );
+				AnswerTestPassed( answer );
+				
+			}catch( const deException &e ){
+				AnswerTestFailedWithException( answer, e );
+			}
+			
+		}else if( command.MatchesArgumentAt( 1, "softwareOcclusionMap" ) ){
+			try{
+				TestSoftwareOcclusionMap( answer );
+				AnswerTestPassed( answer );
+				
+			}catch( const deException &e ){
+				AnswerTestFailedWithException( answer, e );
+			}
+			
+		}else if( command.MatchesArgumentAt( 1, "coneMap" ) ){
+			try{
+				TestConeMapGenerator( answer );
+				AnswerTestPassed( answer );
+				
+			}catch( const deException &e ){
+				AnswerTestFailedWithException( answer, e );
+			}
+			
+		}else if( command.MatchesArgumentAt( 1, "pixelBufferMipMap" ) ){
+			try{
+				TestPixelBufferMipMap( answer );
+				AnswerTestPassed( answer );
+				
+			}catch( const deException &e ){
+				AnswerTestFailedWithException( answer, e );
+			}
+			
+		}else if( command.MatchesArgumentAt( 1, "cpuSkinning" ) ){
+			try{
+				TestCPUSkinning( answer );
+				AnswerTestPassed( answer );
+				
+			}catch( const deException &e ){
+				AnswerTestFailedWithException( answer, e );
+			}
+			
+		}else if( command.MatchesArgumentAt( 1, "cullElements" ) ){
+			try{
+				TestCullElements( answer );
+				AnswerTestPassed( answer );
+				
+			}catch( const deException &e ){
+				AnswerTestFailedWithException( answer, e );
+			}
+			
 		}else{
 			Help( answer );
 		}
@@ -193,6 +275,685 @@ void deoglDeveloperModeTests::TestConvexHull2D( decUnicodeString &answer ){
 
 
 
+void deoglDeveloperModeTests::TestCullBoxList( decUnicodeString &answer ){
+	// frustum looking down the z axis located far away from the origin to test precision
+	const decDVector origin( 100000.0, 10.0, -50000.0 );
+	const decDVector far( 0.0, 0.0, 500.0 );
+	deoglDCollisionFrustum frustum;
+	frustum.SetFrustum( origin, origin + far + decDVector( -300.0, 200.0, 0.0 ),
+		origin + far + decDVector( 300.0, 200.0, 0.0 ), origin + far + decDVector( 300.0, -200.0, 0.0 ),
+		origin + far + decDVector( -300.0, -200.0, 0.0 ), 0.1 );
+		
+	const decDVector reference( origin + decDVector( 0.0, 0.0, 250.0 ) );
+	const float noTooSmall = 1e10f;
+	decLayerMask layerMask;
+	int visible[ 5 ];
+	
+	// small list with known results
+	deoglCullBoxList smallList( reference );
+	smallList.Add( origin + decDVector( -1.0, -1.0, 99.0 ), origin + decDVector( 1.0, 1.0, 101.0 ), layerMask, 1.0f );
+	smallList.Add( origin + decDVector( -1.0, -1.0, -11.0 ), origin + decDVector( 1.0, 1.0, -9.0 ), layerMask, 1.0f );
+	smallList.Add( origin + decDVector( -1.0, -1.0, 599.0 ), origin + decDVector( 1.0, 1.0, 601.0 ), layerMask, 1.0f );
+	smallList.Add( origin + decDVector( -1.0, 290.0, 399.0 ), origin + decDVector( 1.0, 310.0, 401.0 ), layerMask, 1.0f );
+	smallList.Add( origin + decDVector( 100.0, -1.0, 299.0 ), origin + decDVector( 102.0, 1.0, 301.0 ), layerMask, 1.0f );
+	ASSERT_EQUAL( smallList.GetCount(), 5 );
+	
+	ASSERT_EQUAL( smallList.Cull( &frustum, origin, decDVector( 0.0, 0.0, 1.0 ), noTooSmall, visible ), 2 );
+	ASSERT_EQUAL( visible[ 0 ], 0 );
+	ASSERT_EQUAL( visible[ 1 ], 4 );
+	
+	ASSERT_EQUAL( smallList.Cull( NULL, origin, decDVector( 0.0, 0.0, 1.0 ), noTooSmall, visible ), 5 );
+	
+	// too small filter culls the far away box
+	ASSERT_EQUAL( smallList.Cull( &frustum, origin, decDVector( 0.0, 0.0, 1.0 ), 100.0f, visible ), 1 );
+	ASSERT_EQUAL( visible[ 0 ], 0 );
+	
+	smallList.RemoveFrom( 0 );
+	ASSERT_EQUAL( smallList.GetCount(), 4 );
+	ASSERT_EQUAL( smallList.Cull( &frustum, origin, decDVector( 0.0, 0.0, 1.0 ), noTooSmall, visible ), 1 );
+	ASSERT_EQUAL( visible[ 0 ], 3 );
+	
+	// benchmark 100k boxes against the double precision frustum test
+	const int count = 100000;
+	deoglCullBoxList list( reference );
+	decDVector *minExtends = NULL;
+	decDVector *maxExtends = NULL;
+	int *visibleList = NULL;
+	unsigned int seed = 12345;
+	int i;
+	
+	try{
+		minExtends = new decDVector[ count ];
+		maxExtends = new decDVector[ count ];
+		visibleList = new int[ count ];
+		
+		for( i=0; i<count; i++ ){
+			decDVector position, halfSize;
+			seed = seed * 1103515245 + 12345;
+			position.x = ( double )( ( seed >> 8 ) % 20000 ) * 0.1 - 1000.0;
+			seed = seed * 1103515245 + 12345;
+			position.y = ( double )( ( seed >> 8 ) % 20000 ) * 0.1 - 1000.0;
+			seed = seed * 1103515245 + 12345;
+			position.z = ( double )( ( seed >> 8 ) % 20000 ) * 0.1 - 1000.0;
+			seed = seed * 1103515245 + 12345;
+			halfSize.x = ( double )( ( seed >> 8 ) % 100 ) * 0.1 + 0.05;
+			seed = seed * 1103515245 + 12345;
+			halfSize.y = ( double )( ( seed >> 8 ) % 100 ) * 0.1 + 0.05;
+			seed = seed * 1103515245 + 12345;
+			halfSize.z = ( double )( ( seed >> 8 ) % 100 ) * 0.1 + 0.05;
+			
+			minExtends[ i ] = origin + position - halfSize;
+			maxExtends[ i ] = origin + position + halfSize;
+			list.Add( minExtends[ i ], maxExtends[ i ], layerMask, 1.0f );
+		}
+		
+		decTimer timer;
+		deoglDCollisionBox box;
+		int visibleCountDouble = 0;
+		
+		for( i=0; i<count; i++ ){
+			box.SetFromExtends( minExtends[ i ], maxExtends[ i ] );
+			if( frustum.BoxHitsFrustum( &box ) ){
+				visibleList[ visibleCountDouble++ ] = i;
+			}
+		}
+		const float timeDouble = timer.GetElapsedTime();
+		
+		const int visibleCount = list.Cull( &frustum, origin, decDVector( 0.0, 0.0, 1.0 ), noTooSmall, visibleList );
+		const float timeList = timer.GetElapsedTime();
+		
+		// the single precision test is conservative. it can report slightly more boxes but never less
+		ASSERT_TRUE( visibleCount >= visibleCountDouble );
+		
+		int mismatches = 0, j = 0;
+		for( i=0; i<count; i++ ){
+			box.SetFromExtends( minExtends[ i ], maxExtends[ i ] );
+			const bool hitsDouble = frustum.BoxHitsFrustum( &box );
+			const bool hitsList = j < visibleCount && visibleList[ j ] == i;
+			if( hitsList ){
+				j++;
+			}
+			ASSERT_FALSE( hitsDouble && ! hitsList );
+			if( hitsDouble != hitsList ){
+				mismatches++;
+			}
+		}
+		
+		decString text;
+		text.Format( "Culled %d boxes: double %d visible in %.3fms, list %d visible in %.3fms (%d conservative)\n",
+			count, visibleCountDouble, timeDouble * 1000.0f, visibleCount, timeList * 1000.0f, mismatches );
+		answer.AppendFromUTF8( text );
+		
+		delete [] visibleList;
+		delete [] maxExtends;
+		delete [] minExtends;
+		
+	}catch( const deException & ){
+		if( visibleList ){
+			delete [] visibleList;
+		}
+		if( maxExtends ){
+			delete [] maxExtends;
+		}
+		if( minExtends ){
+			delete [] minExtends;
+		}
+		throw;
+	}
+}
+
+
+
+void deoglDeveloperModeTests::TestSoftwareOcclusionMap( decUnicodeString &answer ){
+	// perspective frustum matrix looking down the z axis with near 0.1 and far 100
+	const double zNear = 0.1, zFar = 100.0;
+	decDMatrix frustumMatrix;
+	frustumMatrix.a11 = 1.0 / tan( 0.6 );
+	frustumMatrix.a12 = frustumMatrix.a13 = frustumMatrix.a14 = 0.0;
+	frustumMatrix.a22 = 2.0 / tan( 0.6 );
+	frustumMatrix.a21 = frustumMatrix.a23 = frustumMatrix.a24 = 0.0;
+	frustumMatrix.a31 = frustumMatrix.a32 = 0.0;
+	frustumMatrix.a33 = ( zFar + zNear ) / ( zFar - zNear );
+	frustumMatrix.a34 = -2.0 * zFar * zNear / ( zFar - zNear );
+	frustumMatrix.a41 = frustumMatrix.a42 = frustumMatrix.a44 = 0.0;
+	frustumMatrix.a43 = 1.0;
+	const decMatrix matrix( frustumMatrix.ToMatrix() );
+	
+	// quad facing the camera. counter clockwise corners are front facing
+	const decVector quad[ 4 ] = { decVector( -2.0f, -2.0f, 10.0f ), decVector( 2.0f, -2.0f, 10.0f ),
+		decVector( 2.0f, 2.0f, 10.0f ), decVector( -2.0f, 2.0f, 10.0f ) };
+	const unsigned short frontFacing[ 6 ] = { 0, 1, 2, 0, 2, 3 };
+	const unsigned short backFacing[ 6 ] = { 0, 2, 1, 0, 3, 2 };
+	const decVector behindMin( -0.5f, -0.5f, 20.0f ), behindMax( 0.5f, 0.5f, 21.0f );
+	
+	deoglSoftwareOcclusionMap map( 250, 125 );
+	ASSERT_EQUAL( map.GetWidth(), 256 );
+	ASSERT_EQUAL( map.GetHeight(), 128 );
+	ASSERT_TRUE( map.BoxVisible( behindMin, behindMax, matrix ) );
+	
+	map.AddTriangles( quad, 4, frontFacing, 2, 0, matrix );
+	map.UpdateHiZ();
+	ASSERT_EQUAL( map.GetTriangleCount(), 2 );
+	ASSERT_FALSE( map.BoxVisible( behindMin, behindMax, matrix ) );
+	ASSERT_TRUE( map.BoxVisible( decVector( -0.5f, -0.5f, 5.0f ), decVector( 0.5f, 0.5f, 6.0f ), matrix ) );
+	ASSERT_TRUE( map.BoxVisible( decVector( 1.5f, -0.5f, 20.0f ), decVector( 4.0f, 0.5f, 21.0f ), matrix ) );
+	ASSERT_TRUE( map.BoxVisible( decVector( -0.5f, -0.5f, -1.0f ), decVector( 0.5f, 0.5f, 21.0f ), matrix ) );
+	
+	// single sided back facing triangles do not occlude while double sided do
+	map.Clear();
+	map.AddTriangles( quad, 4, backFacing, 2, 0, matrix );
+	map.UpdateHiZ();
+	ASSERT_EQUAL( map.GetTriangleCount(), 0 );
+	ASSERT_TRUE( map.BoxVisible( behindMin, behindMax, matrix ) );
+	
+	map.Clear();
+	map.AddTriangles( quad, 4, backFacing, 0, 2, matrix );
+	map.UpdateHiZ();
+	ASSERT_FALSE( map.BoxVisible( behindMin, behindMax, matrix ) );
+	
+	// ground plane crossing the near plane is clipped
+	const decVector ground[ 4 ] = { decVector( -50.0f, -1.0f, -5.0f ), decVector( 50.0f, -1.0f, -5.0f ),
+		decVector( 50.0f, -1.0f, 50.0f ), decVector( -50.0f, -1.0f, 50.0f ) };
+	map.Clear();
+	map.AddTriangles( ground, 4, frontFacing, 0, 2, matrix );
+	map.UpdateHiZ();
+	ASSERT_FALSE( map.BoxVisible( decVector( -0.5f, -3.0f, 20.0f ), decVector( 0.5f, -2.0f, 21.0f ), matrix ) );
+	ASSERT_TRUE( map.BoxVisible( decVector( -0.5f, 0.0f, 20.0f ), decVector( 0.5f, 1.0f, 21.0f ), matrix ) );
+	
+	// benchmark rasterizing 1000 small quads and testing 10000 boxes
+	const int occluderCount = 1000;
+	const int boxCount = 10000;
+	decVector occluder[ 4 ];
+	int i, j, occludedCount = 0;
+	
+	decTimer timer;
+	map.Clear();
+	
+	for( i=0; i<occluderCount; i++ ){
+		const decVector offset( ( float )( i % 40 ) * 0.8f - 16.0f,
+			( float )( i / 40 ) * 0.8f - 10.0f, 10.0f + ( float )i * 0.01f );
+		for( j=0; j<4; j++ ){
+			occluder[ j ] = quad[ j ] * 0.15f + offset;
+		}
+		map.AddTriangles( occluder, 4, frontFacing, 2, 0, matrix );
+	}
+	map.UpdateHiZ();
+	const float timeRasterize = timer.GetElapsedTime();
+	
+	for( i=0; i<boxCount; i++ ){
+		const decVector position( ( float )( i % 100 ) * 0.2f - 10.0f, ( float )( i / 100 ) * 0.1f - 5.0f, 30.0f );
+		if( ! map.BoxVisible( position, position + decVector( 0.1f, 0.1f, 1.0f ), matrix ) ){
+			occludedCount++;
+		}
+	}
+	const float timeTest = timer.GetElapsedTime();
+	
+	decString text;
+	text.Format( "Rasterized %d triangles in %.3fms, tested %d boxes in %.3fms (%d occluded)\n",
+		map.GetTriangleCount(), timeRasterize * 1000.0f, boxCount, timeTest * 1000.0f, occludedCount );
+	answer.AppendFromUTF8( text );
+}
+
+
+
+void deoglDeveloperModeTests::TestConeMapGenerator( decUnicodeString &answer ){
+	const int sizes[ 4 ][ 2 ] = { { 1, 1 }, { 7, 5 }, { 32, 32 }, { 33, 17 } };
+	int i, x, y, x2, y2;
+	
+	// compare against brute force evaluation using the same formula
+	for( i=0; i<4; i++ ){
+		const int width = sizes[ i ][ 0 ];
+		const int height = sizes[ i ][ 1 ];
+		const float factorX = 1.0f / ( float )width;
+		const float factorY = 1.0f / ( float )height;
+		const float factorHeight = 1.0f / 255.0f;
+		deoglPixelBuffer::sByte2 * const layer = new deoglPixelBuffer::sByte2[ width * height ];
+		
+		try{
+			for( y=0; y<height; y++ ){
+				for( x=0; x<width; x++ ){
+					layer[ width * y + x ].r = ( GLubyte )( ( x * 37 + y * 91 + x * y * 13 ) % 256 );
+					layer[ width * y + x ].g = 0;
+				}
+			}
+			
+			deoglSCConeMapGenerator generator( layer, width, height );
+			generator.GenerateRows( 0, height );
+			
+			for( y=0; y<height; y++ ){
+				for( x=0; x<width; x++ ){
+					const int sourceHeight = layer[ width * y + x ].r;
+					float bestRatio = 1.0f;
+					
+					for( y2=0; y2<height; y2++ ){
+						for( x2=0; x2<width; x2++ ){
+							const int targetHeight = layer[ width * y2 + x2 ].r;
+							if( targetHeight <= sourceHeight ){
+								continue;
+							}
+							
+							const float dx = factorX * ( float )abs( x2 - x );
+							const float dy = factorY * ( float )abs( y2 - y );
+							const float ratio = sqrtf( dx * dx + dy * dy )
+								/ ( factorHeight * ( float )( targetHeight - sourceHeight ) );
+							if( ratio < bestRatio ){
+								bestRatio = ratio;
+							}
+						}
+					}
+					
+					ASSERT_EQUAL( layer[ width * y + x ].g, ( GLubyte )( 255.0f * bestRatio ) );
+				}
+			}
+			
+		}catch( const deException & ){
+			delete [] layer;
+			throw;
+		}
+		
+		delete [] layer;
+	}
+	
+	// benchmark single threaded against parallel generation
+	const int benchmarkSize = 512;
+	deoglPixelBuffer::sByte2 * const layer = new deoglPixelBuffer::sByte2[ benchmarkSize * benchmarkSize ];
+	float timeSingle, timeParallel;
+	
+	try{
+		for( y=0; y<benchmarkSize; y++ ){
+			for( x=0; x<benchmarkSize; x++ ){
+				layer[ benchmarkSize * y + x ].r = ( GLubyte )( ( x * 37 + y * 91 + x * y * 13 ) % 256 );
+			}
+		}
+		
+		decTimer timer;
+		deoglSCConeMapGenerator generator( layer, benchmarkSize, benchmarkSize );
+		generator.GenerateRows( 0, benchmarkSize );
+		timeSingle = timer.GetElapsedTime();
+		
+		deoglSCConeMapGenerator generator2( layer, benchmarkSize, benchmarkSize );
+		generator2.Generate( pRenderThread.GetOgl() );
+		timeParallel = timer.GetElapsedTime();
+		
+	}catch( const deException & ){
+		delete [] layer;
+		throw;
+	}
+	
+	delete [] layer;
+	
+	decString text;
+	text.Format( "Generated %dx%d cone map in %.1fms single threaded, %.1fms parallel\n",
+		benchmarkSize, benchmarkSize, timeSingle * 1000.0f, timeParallel * 1000.0f );
+	answer.AppendFromUTF8( text );
+}
+
+
+
+void deoglDeveloperModeTests::TestPixelBufferMipMap( decUnicodeString &answer ){
+	const deoglPixelBuffer::ePixelFormats formats[ 2 ] = { deoglPixelBuffer::epfByte4, deoglPixelBuffer::epfFloat4 };
+	const char * const formatNames[ 2 ] = { "RGBA8", "RGBA32F" };
+	const int sizes[ 2 ] = { 2048, 4096 };
+	decString text;
+	int i, j, k;
+	
+	for( i=0; i<2; i++ ){
+		for( j=0; j<2; j++ ){
+			deoglPixelBufferMipMap mipMapSingle( formats[ i ], sizes[ j ], sizes[ j ], 1, 100 );
+			deoglPixelBufferMipMap mipMapParallel( formats[ i ], sizes[ j ], sizes[ j ], 1, 100 );
+			mipMapParallel.SetOgl( &pRenderThread.GetOgl() );
+			
+			// normal like content to exercise all filters
+			const deoglPixelBuffer &baseSingle = *mipMapSingle.GetPixelBuffer( 0 );
+			const int valueCount = baseSingle.GetImageSize() / ( formats[ i ] == deoglPixelBuffer::epfFloat4 ? 4 : 1 );
+			unsigned int seed = 1;
+			
+			for( k=0; k<valueCount; k++ ){
+				seed = seed * 1103515245 + 12345;
+				if( formats[ i ] == deoglPixelBuffer::epfFloat4 ){
+					( ( GLfloat* )baseSingle.GetPointer() )[ k ] = ( float )( ( seed >> 8 ) % 1000 ) * 0.002f - 1.0f;
+					
+				}else{
+					( ( GLubyte* )baseSingle.GetPointer() )[ k ] = ( GLubyte )( seed >> 16 );
+				}
+			}
+			memcpy( mipMapParallel.GetPixelBuffer( 0 )->GetPointer(), baseSingle.GetPointer(), baseSingle.GetImageSize() );
+			
+			decTimer timer;
+			mipMapSingle.CreateMipMaps();
+			const float timeBoxSingle = timer.GetElapsedTime();
+			mipMapParallel.CreateMipMaps();
+			const float timeBoxParallel = timer.GetElapsedTime();
+			
+			for( k=1; k<mipMapSingle.GetPixelBufferCount(); k++ ){
+				ASSERT_TRUE( memcmp( mipMapSingle.GetPixelBuffer( k )->GetPointer(),
+					mipMapParallel.GetPixelBuffer( k )->GetPointer(),
+					mipMapSingle.GetPixelBuffer( k )->GetImageSize() ) == 0 );
+			}
+			
+			timer.Reset();
+			mipMapSingle.CreateNormalMipMaps();
+			const float timeNormalSingle = timer.GetElapsedTime();
+			mipMapParallel.CreateNormalMipMaps();
+			const float timeNormalParallel = timer.GetElapsedTime();
+			
+			for( k=1; k<mipMapSingle.GetPixelBufferCount(); k++ ){
+				ASSERT_TRUE( memcmp( mipMapSingle.GetPixelBuffer( k )->GetPointer(),
+					mipMapParallel.GetPixelBuffer( k )->GetPointer(),
+					mipMapSingle.GetPixelBuffer( k )->GetImageSize() ) == 0 );
+			}
+			
+			text.Format( "%s %dx%d: box %.1fms single, %.1fms parallel. normal %.1fms single, %.1fms parallel\n",
+				formatNames[ i ], sizes[ j ], sizes[ j ], timeBoxSingle * 1000.0f, timeBoxParallel * 1000.0f,
+				timeNormalSingle * 1000.0f, timeNormalParallel * 1000.0f );
+			answer.AppendFromUTF8( text );
+		}
+	}
+}
+
+
+
+void deoglDeveloperModeTests::TestCPUSkinning( decUnicodeString &answer ){
+	// grid mesh with 50k positions weighted by up to 4 bones
+	const int gridWidth = 250;
+	const int gridHeight = 200;
+	const int positionCount = gridWidth * gridHeight;
+	const int faceCount = ( gridWidth - 1 ) * ( gridHeight - 1 ) * 2;
+	const int stride = ( ( positionCount + 3 ) / 4 ) * 4;
+	const int boneCount = 64;
+	const int weightsCount = 1000;
+	const int iterations = 20;
+	
+	oglMatrix3x4 * const boneMatrices = new oglMatrix3x4[ boneCount ];
+	oglModelWeight * const weightsEntries = new oglModelWeight[ weightsCount * 4 ];
+	int * const weightsCounts = new int[ weightsCount ];
+	oglMatrix3x4 * const weightsSimd = new oglMatrix3x4[ weightsCount ];
+	oglMatrix3x4 * const weightsScalar = new oglMatrix3x4[ weightsCount ];
+	oglModelPosition * const modelPositions = new oglModelPosition[ positionCount ];
+	float * const skinPositions = new float[ stride * 3 ];
+	int * const skinWeights = new int[ stride ];
+	decVector2 * const texCoords = new decVector2[ positionCount ];
+	oglModelVertex * const vertices = new oglModelVertex[ positionCount ];
+	deoglModelFace * const faces = new deoglModelFace[ faceCount ];
+	oglVector * const vectorsSimd = new oglVector[ positionCount * 4 + faceCount ];
+	oglVector * const vectorsScalar = new oglVector[ positionCount * 4 + faceCount ];
+	decString text;
+	int i, j;
+	
+	try{
+		unsigned int seed = 1;
+		int entryCount = 0;
+		
+		for( i=0; i<boneCount; i++ ){
+			decMatrix matrix( decMatrix::CreateRT( decVector( 0.01f * i, 0.02f * i, 0.03f * i ),
+				decVector( 0.1f * i, 0.0f, -0.05f * i ) ) );
+			oglMatrix3x4 &boneMatrix = boneMatrices[ i ];
+			boneMatrix.a11 = matrix.a11;
+			boneMatrix.a12 = matrix.a12;
+			boneMatrix.a13 = matrix.a13;
+			boneMatrix.a14 = matrix.a14;
+			boneMatrix.a21 = matrix.a21;
+			boneMatrix.a22 = matrix.a22;
+			boneMatrix.a23 = matrix.a23;
+			boneMatrix.a24 = matrix.a24;
+			boneMatrix.a31 = matrix.a31;
+			boneMatrix.a32 = matrix.a32;
+			boneMatrix.a33 = matrix.a33;
+			boneMatrix.a34 = matrix.a34;
+		}
+		
+		for( i=0; i<weightsCount; i++ ){
+			weightsCounts[ i ] = i % 5;
+			for( j=0; j<weightsCounts[ i ]; j++ ){
+				seed = seed * 1103515245 + 12345;
+				weightsEntries[ entryCount ].bone = ( int )( ( seed >> 8 ) % boneCount );
+				weightsEntries[ entryCount ].weight = 1.0f / ( float )weightsCounts[ i ];
+				entryCount++;
+			}
+		}
+		
+		for( i=0; i<positionCount; i++ ){
+			const float x = ( float )( i % gridWidth ) * 0.01f;
+			const float y = ( float )( i / gridWidth ) * 0.01f;
+			oglModelPosition &position = modelPositions[ i ];
+			position.position.Set( x, y, 0.1f * sinf( x * 10.0f ) );
+			position.weight = ( i % 17 ) == 0 ? -1 : i % weightsCount;
+			
+			skinPositions[ i ] = position.position.x;
+			skinPositions[ stride + i ] = position.position.y;
+			skinPositions[ stride * 2 + i ] = position.position.z;
+			skinWeights[ i ] = position.weight;
+			
+			texCoords[ i ].Set( x, y );
+			vertices[ i ].position = i;
+			vertices[ i ].texcoord = i;
+			vertices[ i ].normal = i;
+			vertices[ i ].tangent = i;
+		}
+		for( i=positionCount; i<stride; i++ ){
+			skinPositions[ i ] = skinPositions[ stride + i ] = skinPositions[ stride * 2 + i ] = 0.0f;
+			skinWeights[ i ] = -1;
+		}
+		
+		for( i=0, j=0; i<positionCount - gridWidth; i++ ){
+			if( ( i % gridWidth ) == gridWidth - 1 ){
+				continue;
+			}
+			faces[ j ].SetVertex1( i );
+			faces[ j ].SetVertex2( i + 1 );
+			faces[ j ].SetVertex3( i + gridWidth );
+			j++;
+			faces[ j ].SetVertex1( i + 1 );
+			faces[ j ].SetVertex2( i + gridWidth + 1 );
+			faces[ j ].SetVertex3( i + gridWidth );
+			j++;
+		}
+		
+		// weights
+		decTimer timer;
+		for( i=0; i<iterations; i++ ){
+			deoglCPUSkinning::CalculateWeightsScalar( weightsScalar, weightsCount,
+				boneMatrices, weightsEntries, weightsCounts );
+		}
+		const float timeWeightsScalar = timer.GetElapsedTime();
+		for( i=0; i<iterations; i++ ){
+			deoglCPUSkinning::CalculateWeights( weightsSimd, weightsCount,
+				boneMatrices, weightsEntries, weightsCounts );
+		}
+		const float timeWeightsSimd = timer.GetElapsedTime();
+		
+		const float * const compareWeightsSimd = &weightsSimd[ 0 ].a11;
+		const float * const compareWeightsScalar = &weightsScalar[ 0 ].a11;
+		for( i=0; i<weightsCount * 12; i++ ){
+			ASSERT_TRUE( fabsf( compareWeightsSimd[ i ] - compareWeightsScalar[ i ] ) < 1e-5f );
+		}
+		
+		// positions
+		oglVector * const positionsSimd = vectorsSimd;
+		oglVector * const positionsScalar = vectorsScalar;
+		
+		timer.Reset();
+		for( i=0; i<iterations; i++ ){
+			deoglCPUSkinning::TransformPositionsScalar( positionsScalar, modelPositions,
+				positionCount, weightsScalar );
+		}
+		const float timePositionsScalar = timer.GetElapsedTime();
+		for( i=0; i<iterations; i++ ){
+			deoglCPUSkinning::TransformPositions( positionsSimd, positionCount,
+				skinPositions, stride, skinWeights, weightsScalar );
+		}
+		const float timePositionsSimd = timer.GetElapsedTime();
+		
+		for( i=0; i<positionCount; i++ ){
+			ASSERT_TRUE( fabsf( positionsSimd[ i ].x - positionsScalar[ i ].x ) < 1e-5f );
+			ASSERT_TRUE( fabsf( positionsSimd[ i ].y - positionsScalar[ i ].y ) < 1e-5f );
+			ASSERT_TRUE( fabsf( positionsSimd[ i ].z - positionsScalar[ i ].z ) < 1e-5f );
+		}
+		
+		// normals and tangents. positions are identical in both buffers
+		timer.Reset();
+		for( i=0; i<iterations; i++ ){
+			deoglCPUSkinning::CalculateNormalsTangentsScalar( positionsScalar, texCoords, vertices,
+				faces, faceCount, vectorsScalar + positionCount * 4, vectorsScalar + positionCount,
+				positionCount, vectorsScalar + positionCount * 2, positionCount,
+				vectorsScalar + positionCount * 3, positionCount );
+		}
+		const float timeNormalsScalar = timer.GetElapsedTime();
+		for( i=0; i<iterations; i++ ){
+			deoglCPUSkinning::CalculateNormalsTangents( positionsScalar, texCoords, vertices,
+				faces, faceCount, vectorsSimd + positionCount * 4, vectorsSimd + positionCount,
+				positionCount, vectorsSimd + positionCount * 2, positionCount,
+				vectorsSimd + positionCount * 3, positionCount );
+		}
+		const float timeNormalsSimd = timer.GetElapsedTime();
+		
+		for( i=positionCount; i<positionCount * 4 + faceCount; i++ ){
+			ASSERT_TRUE( fabsf( vectorsSimd[ i ].x - vectorsScalar[ i ].x ) < 1e-5f );
+			ASSERT_TRUE( fabsf( vectorsSimd[ i ].y - vectorsScalar[ i ].y ) < 1e-5f );
+			ASSERT_TRUE( fabsf( vectorsSimd[ i ].z - vectorsScalar[ i ].z ) < 1e-5f );
+		}
+		
+		const float factor = 1e6f / ( float )iterations;
+		text.Format( "%d positions, %d faces, %d weights: weights %.1fus scalar, %.1fus simd. "
+			"positions %.1fus scalar, %.1fus simd. normals/tangents %.1fus scalar, %.1fus simd\n",
+			positionCount, faceCount, weightsCount, timeWeightsScalar * factor, timeWeightsSimd * factor,
+			timePositionsScalar * factor, timePositionsSimd * factor,
+			timeNormalsScalar * factor, timeNormalsSimd * factor );
+		answer.AppendFromUTF8( text );
+		
+	}catch( const deException & ){
+		delete [] vectorsScalar;
+		delete [] vectorsSimd;
+		delete [] faces;
+		delete [] vertices;
+		delete [] texCoords;
+		delete [] skinWeights;
+		delete [] skinPositions;
+		delete [] modelPositions;
+		delete [] weightsScalar;
+		delete [] weightsSimd;
+		delete [] weightsCounts;
+		delete [] weightsEntries;
+		delete [] boneMatrices;
+		throw;
+	}
+	
+	delete [] vectorsScalar;
+	delete [] vectorsSimd;
+	delete [] faces;
+	delete [] vertices;
+	delete [] texCoords;
+	delete [] skinWeights;
+	delete [] skinPositions;
+	delete [] modelPositions;
+	delete [] weightsScalar;
+	delete [] weightsSimd;
+	delete [] weightsCounts;
+	delete [] weightsEntries;
+	delete [] boneMatrices;
+}
+
+
+
+void deoglDeveloperModeTests::TestCullElements( decUnicodeString &answer ){
+	// synthetic octree with 64k billboards on a grid. the camera is located at the origin
+	// looking down the z axis. the render plan culls only the content of the octree
+	const deParallelProcessing &processing = pRenderThread.GetOgl().GetGameEngine()->GetParallelProcessing();
+	const decDVector octreeHalfSize( 1024.0, 1024.0, 1024.0 );
+	const double viewDistance = 500.0;
+	const int gridSize = 40;
+	const int iterations = 20;
+	deoglWorldOctree * const octree = new deoglWorldOctree( decDVector(), octreeHalfSize );
+	deoglRenderPlan plan( pRenderThread );
+	deoglDCollisionFrustum frustum;
+	decPointerList sequentialBillboards;
+	decObjectList billboards;
+	decString text;
+	int i, j, k;
+	
+	plan.SetCameraMatrix( decDMatrix() );
+	plan.SetCameraParameters( PI * 0.5f, 1.0f, 0.01f, ( float )viewDistance );
+	plan.SetViewport( 0, 0, 1024, 1024 );
+	
+	frustum.SetFrustum( decDVector(), decDVector( -viewDistance, viewDistance, viewDistance ),
+		decDVector( viewDistance, viewDistance, viewDistance ),
+		decDVector( viewDistance, -viewDistance, viewDistance ),
+		decDVector( -viewDistance, -viewDistance, viewDistance ), 0.01 );
+		
+	try{
+		deBillboardReference engBillboard;
+		engBillboard.TakeOver( pRenderThread.GetOgl().GetGameEngine()->GetBillboardManager()->CreateBillboard() );
+		engBillboard->SetSize( decVector2( 2.0f, 2.0f ) );
+		
+		const double spacing = octreeHalfSize.x * 2.0 / ( double )gridSize;
+		const double offset = spacing * 0.5 - octreeHalfSize.x;
+		
+		for( i=0; i<gridSize; i++ ){
+			for( j=0; j<gridSize; j++ ){
+				for( k=0; k<gridSize; k++ ){
+					engBillboard->SetPosition( decDVector( offset + spacing * i,
+						offset + spacing * j, offset + spacing * k ) );
+						
+					deoglRBillboard * const billboard = new deoglRBillboard( pRenderThread );
+					billboards.Add( billboard );
+					billboard->FreeReference();
+					
+					billboard->UpdateExtends( engBillboard );
+					octree->InsertBillboardIntoTree( billboard, 8 );
+				}
+			}
+		}
+		
+		// sequential culling is the reference. parallel culling has to produce the same
+		// billboards in the same order
+		decTimer timer;
+		float timeSequential = 0.0f;
+		float timeParallel = 0.0f;
+		
+		plan.DevModeCullElements( *octree, frustum, false );
+		const deoglCollideList &collideList = plan.GetCollideList();
+		const int count = collideList.GetBillboardCount();
+		ASSERT_TRUE( count > 0 );
+		for( i=0; i<count; i++ ){
+			sequentialBillboards.Add( collideList.GetBillboardAt( i ) );
+		}
+		
+		plan.DevModeCullElements( *octree, frustum, true );
+		ASSERT_EQUAL( collideList.GetBillboardCount(), count );
+		for( i=0; i<count; i++ ){
+			ASSERT_EQUAL( collideList.GetBillboardAt( i ), sequentialBillboards.GetAt( i ) );
+		}
+		
+		timer.Reset();
+		for( i=0; i<iterations; i++ ){
+			plan.DevModeCullElements( *octree, frustum, false );
+		}
+		timeSequential = timer.GetElapsedTime();
+		
+		for( i=0; i<iterations; i++ ){
+			plan.DevModeCullElements( *octree, frustum, true );
+		}
+		timeParallel = timer.GetElapsedTime();
+		
+		const float factor = 1000.0f / ( float )iterations;
+		text.Format( "billboards %d, visible %d, cores %d%s: %.2fms sequential, %.2fms parallel\n",
+			billboards.GetCount(), count, processing.GetCoreCount(),
+			processing.GetPaused() || processing.GetCoreCount() < 2 ? " (parallel unavailable)" : "",
+			timeSequential * factor, timeParallel * factor );
+		answer.AppendFromUTF8( text );
+		
+	}catch( const deException & ){
+		octree->ClearBillboards();
+		delete octree;
+		throw;
+	}
+	
+	octree->ClearBillboards();
+	delete octree;
+}
+
+
+
 void deoglDeveloperModeTests::AnswerTestPassed( decUnicodeString &answer ){
 	answer.AppendFromUTF8( "Test passed\n" );
 }
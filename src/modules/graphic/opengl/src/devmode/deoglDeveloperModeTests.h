@@ -58,6 +58,24 @@ public:
 	/** Test 2d convex hull class. */
 	void TestConvexHull2D( decUnicodeString &answer );
 	
+	/** Test cull box list and benchmark it against the double precision frustum test. */
+	void TestCullBoxList( decUnicodeString &answer );
+	
+	/** Test software occlusion map and benchmark rasterizing and box testing. */
+	void TestSoftwareOcclusionMap( decUnicodeString &answer );
+	
+	/** Test cone map generator against brute force and benchmark it. */
+	void TestConeMapGenerator( decUnicodeString &answer );
+	
+	/** Test pixel buffer mip map filtering in parallel and benchmark it. */
+	void TestPixelBufferMipMap( decUnicodeString &answer );
+	
+	/** Test SIMD CPU skinning against the scalar version and benchmark it. */
+	void TestCPUSkinning( decUnicodeString &answer );
+	
+	/** Test parallel render plan culling against sequential culling and benchmark it. */
+	void TestCullElements( decUnicodeString &answer );
+	
 	/** Answer test passed. */
 	void AnswerTestPassed( decUnicodeString &answer );
 	/** Answer test failed with exception. */
@@ -85,6 +85,10 @@ pIBOType( deoglVBOLayout::eitUnsignedShort )
 	pPositions = NULL;
 	pPositionCount = 0;
 	
+	pSkinPositions = NULL;
+	pSkinWeights = NULL;
+	pSkinPositionStride = 0;
+	
 	pTexCoords = NULL;
 	pTexCoordCount = 0;
 	
@@ -148,6 +152,8 @@ pIBOType( deoglVBOLayout::eitUnsignedShort )
 		logger.LogInfoFormat( "=> max-error: %f\n", pMaxError );
 		#endif
 		
+		pBuildSkinPositions();
+		
 	}catch( const deException & ){
 		pCleanUp();
 		throw;
@@ -169,6 +175,10 @@ pIBOType( deoglVBOLayout::eitUnsignedShort )
 	pPositions = NULL;
 	pPositionCount = 0;
 	
+	pSkinPositions = NULL;
+	pSkinWeights = NULL;
+	pSkinPositionStride = 0;
+	
 	pTexCoords = NULL;
 	pTexCoordCount = 0;
 	
@@ -206,6 +216,7 @@ pIBOType( deoglVBOLayout::eitUnsignedShort )
 	
 	try{
 		LoadFromCache( cacheReader );
+		pBuildSkinPositions();
 		
 	}catch( ... ){
 		pCleanUp();
@@ -795,6 +806,12 @@ void deoglModelLOD::pCleanUp(){
 	if( pTexCoords ){
 		delete [] pTexCoords;
 	}
+	if( pSkinWeights ){
+		delete [] pSkinWeights;
+	}
+	if( pSkinPositions ){
+		delete [] pSkinPositions;
+	}
 	if( pPositions ){
 		delete [] pPositions;
 	}
@@ -1328,6 +1345,40 @@ void deoglModelLOD::pOptimizeVertexCache(){
 	//	pLODIndex, ( int )( timer.GetElapsedTime() * 1000.0f ) );
 }
 
+void deoglModelLOD::pBuildSkinPositions(){
+	if( pWeightsCount == 0 || pPositionCount == 0 ){
+		return;
+	}
+	
+	// positions stored as blocks of x, y and z coordinates allow CPU skinning to process
+	// four positions at the same time. blocks are padded to a multiple of 4
+	const int stride = ( ( pPositionCount + 3 ) / 4 ) * 4;
+	int i;
+	
+	pSkinPositions = new float[ stride * 3 ];
+	pSkinWeights = new int[ stride ];
+	pSkinPositionStride = stride;
+	
+	float * const positionsX = pSkinPositions;
+	float * const positionsY = pSkinPositions + stride;
+	float * const positionsZ = pSkinPositions + stride * 2;
+	
+	for( i=0; i<pPositionCount; i++ ){
+		const oglModelPosition &position = pPositions[ i ];
+		positionsX[ i ] = position.position.x;
+		positionsY[ i ] = position.position.y;
+		positionsZ[ i ] = position.position.z;
+		pSkinWeights[ i ] = position.weight;
+	}
+	
+	for( i=pPositionCount; i<stride; i++ ){
+		positionsX[ i ] = 0.0f;
+		positionsY[ i ] = 0.0f;
+		positionsZ[ i ] = 0.0f;
+		pSkinWeights[ i ] = -1;
+	}
+}
+
 void deoglModelLOD::pWriteVBOData(){
 	if( ! pVBOBlock ){
 		DETHROW( deeInvalidParam );
@@ -77,6 +77,10 @@ public:
 	oglModelPosition *pPositions;
 	int pPositionCount;
 	
+	float *pSkinPositions;
+	int *pSkinWeights;
+	int pSkinPositionStride;
+	
 	decVector2 *pTexCoords;
 	int pTexCoordCount;
 	
@@ -180,6 +184,20 @@ public:
 	/** Retrieves the number of positions. */
 	inline int GetPositionCount() const{ return pPositionCount; }
 	
+	/**
+	 * \brief Positions in structure of arrays layout for CPU skinning or \em NULL if not weighted.
+	 * 
+	 * X coordinates are stored first followed by Y and Z coordinates. Each block is
+	 * GetSkinPositionStride() floats long padded with 0.
+	 */
+	inline const float *GetSkinPositions() const{ return pSkinPositions; }
+	
+	/** \brief Weight index of positions padded with -1 for CPU skinning or \em NULL if not weighted. */
+	inline const int *GetSkinWeights() const{ return pSkinWeights; }
+	
+	/** \brief Length of skin position blocks. Position count rounded up to a multiple of 4. */
+	inline int GetSkinPositionStride() const{ return pSkinPositionStride; }
+	
 	/** Retrieves the texture coordinates. */
 	inline decVector2 *GetTextureCoordinates() const{ return pTexCoords; }
 	/** Retrieves the number of texture coordinates. */
@@ -244,6 +262,7 @@ private:
 	void pBuildArrays( const deModel &engModel );
 	void pCalcErrorMetrics( const deModel &engModel );
 	void pOptimizeVertexCache();
+	void pBuildSkinPositions();
 	void pWriteVBOData();
 	void pWriteVBODataPositionWeight();
 	void pWriteVBODataCalcNormalTangent();
@@ -0,0 +1,531 @@
+/* 
+ * Drag[en]gine OpenGL Graphic Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "deoglSoftwareOcclusionMap.h"
+#include "mesh/deoglROcclusionMesh.h"
+
+#include <dragengine/common/exceptions.h>
+
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 1 )
+#define OGL_SWOCCMAP_SSE 1
+#include <xmmintrin.h>
+#endif
+
+
+
+// Definitions
+////////////////
+
+// size of hierarchical depth tiles in pixels. width and height are multiple of this size
+#define TILE_SIZE 8
+
+// triangles with a smaller screen area in square pixels are skipped
+#define AREA_EPSILON 1e-6f
+
+
+
+// Class deoglSoftwareOcclusionMap
+////////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+deoglSoftwareOcclusionMap::deoglSoftwareOcclusionMap( int width, int height ) :
+pWidth( 0 ),
+pHeight( 0 ),
+pTileCountX( 0 ),
+pTileCountY( 0 ),
+pDepth( NULL ),
+pTileDepth( NULL ),
+pClipVertices( NULL ),
+pClipVertexSize( 0 ),
+pTriangleCount( 0 )
+{
+	SetSize( width, height );
+}
+
+deoglSoftwareOcclusionMap::~deoglSoftwareOcclusionMap(){
+	if( pClipVertices ){
+		delete [] pClipVertices;
+	}
+	if( pTileDepth ){
+		delete [] pTileDepth;
+	}
+	if( pDepth ){
+		delete [] pDepth;
+	}
+}
+
+
+
+// Management
+///////////////
+
+void deoglSoftwareOcclusionMap::SetSize( int width, int height ){
+	if( width < 1 || height < 1 ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	width = ( ( width + TILE_SIZE - 1 ) / TILE_SIZE ) * TILE_SIZE;
+	height = ( ( height + TILE_SIZE - 1 ) / TILE_SIZE ) * TILE_SIZE;
+	
+	if( width != pWidth || height != pHeight ){
+		const int tileCountX = width / TILE_SIZE;
+		const int tileCountY = height / TILE_SIZE;
+		float * const depth = new float[ width * height ];
+		float *tileDepth = NULL;
+		
+		try{
+			tileDepth = new float[ tileCountX * tileCountY ];
+			
+		}catch( const deException & ){
+			delete [] depth;
+			throw;
+		}
+		
+		if( pTileDepth ){
+			delete [] pTileDepth;
+		}
+		if( pDepth ){
+			delete [] pDepth;
+		}
+		
+		pDepth = depth;
+		pTileDepth = tileDepth;
+		pWidth = width;
+		pHeight = height;
+		pTileCountX = tileCountX;
+		pTileCountY = tileCountY;
+	}
+	
+	Clear();
+}
+
+float deoglSoftwareOcclusionMap::GetDepthAt( int x, int y ) const{
+	if( x < 0 || x >= pWidth || y < 0 || y >= pHeight ){
+		DETHROW( deeInvalidParam );
+	}
+	return pDepth[ pWidth * y + x ];
+}
+
+void deoglSoftwareOcclusionMap::Clear(){
+	const int pixelCount = pWidth * pHeight;
+	const int tileCount = pTileCountX * pTileCountY;
+	int i;
+	
+	for( i=0; i<pixelCount; i++ ){
+		pDepth[ i ] = 1.0f;
+	}
+	for( i=0; i<tileCount; i++ ){
+		pTileDepth[ i ] = 1.0f;
+	}
+	
+	pTriangleCount = 0;
+}
+
+void deoglSoftwareOcclusionMap::AddTriangles( const decVector *vertices, int vertexCount,
+const unsigned short *corners, int singleSidedFaceCount, int doubleSidedFaceCount,
+const decMatrix &matrix ){
+	if( vertexCount < 0 || singleSidedFaceCount < 0 || doubleSidedFaceCount < 0 ){
+		DETHROW( deeInvalidParam );
+	}
+	if( vertexCount == 0 || singleSidedFaceCount + doubleSidedFaceCount == 0 ){
+		return;
+	}
+	if( ! vertices || ! corners ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	pPrepareClipVertices( vertexCount );
+	
+	int i;
+	for( i=0; i<vertexCount; i++ ){
+		const decVector &v = vertices[ i ];
+		pClipVertices[ i ] = matrix * decVector4( v.x, v.y, v.z, 1.0f );
+	}
+	
+	pAddFaces( corners, singleSidedFaceCount, doubleSidedFaceCount );
+}
+
+void deoglSoftwareOcclusionMap::AddOcclusionMesh( const deoglROcclusionMesh &occlusionMesh,
+const decVector *vertices, const decMatrix &matrix ){
+	if( ! vertices ){
+		const deoglROcclusionMesh::sVertex * const meshVertices = occlusionMesh.GetVertices();
+		const int vertexCount = occlusionMesh.GetVertexCount();
+		int i;
+		
+		if( vertexCount == 0 ){
+			return;
+		}
+		
+		pPrepareClipVertices( vertexCount );
+		
+		for( i=0; i<vertexCount; i++ ){
+			const decVector &v = meshVertices[ i ].position;
+			pClipVertices[ i ] = matrix * decVector4( v.x, v.y, v.z, 1.0f );
+		}
+		
+		pAddFaces( occlusionMesh.GetCorners(), occlusionMesh.GetSingleSidedFaceCount(),
+			occlusionMesh.GetDoubleSidedFaceCount() );
+			
+	}else{
+		AddTriangles( vertices, occlusionMesh.GetVertexCount(), occlusionMesh.GetCorners(),
+			occlusionMesh.GetSingleSidedFaceCount(), occlusionMesh.GetDoubleSidedFaceCount(),
+			matrix );
+	}
+}
+
+void deoglSoftwareOcclusionMap::UpdateHiZ(){
+	int tx, ty, x, y;
+	
+	for( ty=0; ty<pTileCountY; ty++ ){
+		for( tx=0; tx<pTileCountX; tx++ ){
+			const float *row = pDepth + pWidth * ( ty * TILE_SIZE ) + tx * TILE_SIZE;
+			
+#ifdef OGL_SWOCCMAP_SSE
+			__m128 maxDepth = _mm_loadu_ps( row );
+			for( y=0; y<TILE_SIZE; y++, row+=pWidth ){
+				for( x=0; x<TILE_SIZE; x+=4 ){
+					maxDepth = _mm_max_ps( maxDepth, _mm_loadu_ps( row + x ) );
+				}
+			}
+			
+			maxDepth = _mm_max_ps( maxDepth, _mm_movehl_ps( maxDepth, maxDepth ) );
+			maxDepth = _mm_max_ss( maxDepth, _mm_shuffle_ps( maxDepth, maxDepth, 1 ) );
+			_mm_store_ss( pTileDepth + pTileCountX * ty + tx, maxDepth );
+			
+#else
+			float maxDepth = row[ 0 ];
+			for( y=0; y<TILE_SIZE; y++, row+=pWidth ){
+				for( x=0; x<TILE_SIZE; x++ ){
+					if( row[ x ] > maxDepth ){
+						maxDepth = row[ x ];
+					}
+				}
+			}
+			
+			pTileDepth[ pTileCountX * ty + tx ] = maxDepth;
+#endif
+		}
+	}
+}
+
+bool deoglSoftwareOcclusionMap::BoxVisible( const decVector &minExtend,
+const decVector &maxExtend, const decMatrix &matrix ) const{
+	// project the corners. the box depth is the depth of the closest corner. boxes
+	// crossing the near plane are always visible
+	float minX = 0.0f, minY = 0.0f, maxX = 0.0f, maxY = 0.0f, minDepth = 0.0f;
+	int i;
+	
+	for( i=0; i<8; i++ ){
+		const decVector4 corner( matrix * decVector4(
+			( i & 1 ) ? maxExtend.x : minExtend.x,
+			( i & 2 ) ? maxExtend.y : minExtend.y,
+			( i & 4 ) ? maxExtend.z : minExtend.z, 1.0f ) );
+			
+		if( corner.z + corner.w <= 0.0f ){
+			return true;
+		}
+		
+		const decVector projected( pProject( corner ) );
+		
+		if( i == 0 ){
+			minX = maxX = projected.x;
+			minY = maxY = projected.y;
+			minDepth = projected.z;
+			
+		}else{
+			minX = decMath::min( minX, projected.x );
+			maxX = decMath::max( maxX, projected.x );
+			minY = decMath::min( minY, projected.y );
+			maxY = decMath::max( maxY, projected.y );
+			minDepth = decMath::min( minDepth, projected.z );
+		}
+	}
+	
+	// covered pixels. boxes outside the map are left to frustum culling
+	const int x1 = decMath::max( ( int )floorf( minX ), 0 );
+	const int y1 = decMath::max( ( int )floorf( minY ), 0 );
+	const int x2 = decMath::min( ( int )ceilf( maxX ), pWidth );
+	const int y2 = decMath::min( ( int )ceilf( maxY ), pHeight );
+	
+	if( x1 >= x2 || y1 >= y2 ){
+		return true;
+	}
+	
+	// test tiles first. if a tile is not fully behind test the covered pixels
+	const int tx1 = x1 / TILE_SIZE;
+	const int ty1 = y1 / TILE_SIZE;
+	const int tx2 = ( x2 - 1 ) / TILE_SIZE;
+	const int ty2 = ( y2 - 1 ) / TILE_SIZE;
+	int tx, ty, x, y;
+	
+	for( ty=ty1; ty<=ty2; ty++ ){
+		for( tx=tx1; tx<=tx2; tx++ ){
+			if( pTileDepth[ pTileCountX * ty + tx ] < minDepth ){
+				continue;
+			}
+			
+			const int px1 = decMath::max( x1, tx * TILE_SIZE );
+			const int py1 = decMath::max( y1, ty * TILE_SIZE );
+			const int px2 = decMath::min( x2, ( tx + 1 ) * TILE_SIZE );
+			const int py2 = decMath::min( y2, ( ty + 1 ) * TILE_SIZE );
+			
+			for( y=py1; y<py2; y++ ){
+				const float * const row = pDepth + pWidth * y;
+				for( x=px1; x<px2; x++ ){
+					if( row[ x ] >= minDepth ){
+						return true;
+					}
+				}
+			}
+		}
+	}
+	
+	return false;
+}
+
+
+
+// Private Functions
+//////////////////////
+
+void deoglSoftwareOcclusionMap::pPrepareClipVertices( int count ){
+	if( count <= pClipVertexSize ){
+		return;
+	}
+	
+	decVector4 * const vertices = new decVector4[ count ];
+	if( pClipVertices ){
+		delete [] pClipVertices;
+	}
+	pClipVertices = vertices;
+	pClipVertexSize = count;
+}
+
+void deoglSoftwareOcclusionMap::pAddFaces( const unsigned short *corners,
+int singleSidedFaceCount, int doubleSidedFaceCount ){
+	const int faceCount = singleSidedFaceCount + doubleSidedFaceCount;
+	int i;
+	
+	for( i=0; i<faceCount; i++, corners+=3 ){
+		pAddTriangle( pClipVertices[ corners[ 0 ] ], pClipVertices[ corners[ 1 ] ],
+			pClipVertices[ corners[ 2 ] ], i >= singleSidedFaceCount );
+	}
+}
+
+void deoglSoftwareOcclusionMap::pAddTriangle( const decVector4 &v1, const decVector4 &v2,
+const decVector4 &v3, bool doubleSided ){
+	// distance to the near plane in clip space is z + w
+	const float d1 = v1.z + v1.w;
+	const float d2 = v2.z + v2.w;
+	const float d3 = v3.z + v3.w;
+	
+	if( d1 >= 0.0f && d2 >= 0.0f && d3 >= 0.0f ){
+		pRasterize( pProject( v1 ), pProject( v2 ), pProject( v3 ), doubleSided );
+		return;
+	}
+	
+	if( d1 < 0.0f && d2 < 0.0f && d3 < 0.0f ){
+		return;
+	}
+	
+	// clip against the near plane. results in 3 or 4 vertices keeping the winding
+	const decVector4 * const inVertices[ 3 ] = { &v1, &v2, &v3 };
+	const float inDistances[ 3 ] = { d1, d2, d3 };
+	decVector4 clipped[ 4 ];
+	int i, clippedCount = 0;
+	
+	for( i=0; i<3; i++ ){
+		const int next = ( i + 1 ) % 3;
+		const float dc = inDistances[ i ];
+		const float dn = inDistances[ next ];
+		
+		if( dc >= 0.0f ){
+			clipped[ clippedCount++ ] = *inVertices[ i ];
+		}
+		
+		if( ( dc >= 0.0f ) != ( dn >= 0.0f ) ){
+			clipped[ clippedCount++ ] = *inVertices[ i ]
+				+ ( *inVertices[ next ] - *inVertices[ i ] ) * ( dc / ( dc - dn ) );
+		}
+	}
+	
+	const decVector p1( pProject( clipped[ 0 ] ) );
+	const decVector p2( pProject( clipped[ 1 ] ) );
+	const decVector p3( pProject( clipped[ 2 ] ) );
+	
+	pRasterize( p1, p2, p3, doubleSided );
+	
+	if( clippedCount == 4 ){
+		pRasterize( p1, p3, pProject( clipped[ 3 ] ), doubleSided );
+	}
+}
+
+void deoglSoftwareOcclusionMap::pRasterize( const decVector &p1, const decVector &p2,
+const decVector &p3, bool doubleSided ){
+	// counter clockwise triangles are front facing. back facing double sided triangles
+	// are flipped to be counter clockwise
+	float area = ( p2.x - p1.x ) * ( p3.y - p1.y ) - ( p3.x - p1.x ) * ( p2.y - p1.y );
+	const decVector *q1 = &p1;
+	const decVector *q2 = &p2;
+	const decVector *q3 = &p3;
+	
+	if( area < 0.0f ){
+		if( ! doubleSided ){
+			return;
+		}
+		
+		q2 = &p3;
+		q3 = &p2;
+		area = -area;
+	}
+	
+	if( area < AREA_EPSILON ){
+		return;
+	}
+	
+	// bounding box of covered pixels. x is aligned to 4 pixels for the SIMD loop. since the
+	// width is a multiple of the tile size the aligned range never exceeds the width
+	int x1 = decMath::max( ( int )floorf( decMath::min( q1->x, q2->x, q3->x ) ), 0 );
+	int x2 = decMath::min( ( int )ceilf( decMath::max( q1->x, q2->x, q3->x ) ), pWidth );
+	const int y1 = decMath::max( ( int )floorf( decMath::min( q1->y, q2->y, q3->y ) ), 0 );
+	const int y2 = decMath::min( ( int )ceilf( decMath::max( q1->y, q2->y, q3->y ) ), pHeight );
+	
+	if( x1 >= x2 || y1 >= y2 ){
+		return;
+	}
+	
+	x1 &= ~3;
+	x2 = ( x2 + 3 ) & ~3;
+	
+	pTriangleCount++;
+	
+	// edge functions. each edge function is positive inside the triangle and is the
+	// weight of the opposite vertex scaled by the area
+	const float e1dx = q2->y - q3->y;
+	const float e1dy = q3->x - q2->x;
+	const float e2dx = q3->y - q1->y;
+	const float e2dy = q1->x - q3->x;
+	const float e3dx = q1->y - q2->y;
+	const float e3dy = q2->x - q1->x;
+	
+	const float startX = ( float )x1 + 0.5f;
+	const float startY = ( float )y1 + 0.5f;
+	const float e1 = e1dy * ( startY - q2->y ) + e1dx * ( startX - q2->x );
+	const float e2 = e2dy * ( startY - q3->y ) + e2dx * ( startX - q3->x );
+	const float e3 = e3dy * ( startY - q1->y ) + e3dx * ( startX - q1->x );
+	
+	// depth plane
+	const float invArea = 1.0f / area;
+	const float zdx = ( e1dx * q1->z + e2dx * q2->z + e3dx * q3->z ) * invArea;
+	const float zdy = ( e1dy * q1->z + e2dy * q2->z + e3dy * q3->z ) * invArea;
+	const float z = ( e1 * q1->z + e2 * q2->z + e3 * q3->z ) * invArea;
+	
+	// pixels are covered if their center is inside or on the triangle edges. testing the
+	// entire pixel would leave holes along edges shared by triangles. depth is the farthest
+	// depth across the pixel
+	float rowE1 = e1;
+	float rowE2 = e2;
+	float rowE3 = e3;
+	float rowZ = z + 0.5f * ( fabsf( zdx ) + fabsf( zdy ) );
+	
+	float *row = pDepth + pWidth * y1;
+	int x, y;
+	
+#ifdef OGL_SWOCCMAP_SSE
+	const __m128 offsets = _mm_set_ps( 3.0f, 2.0f, 1.0f, 0.0f );
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 stepE1 = _mm_set1_ps( e1dx * 4.0f );
+	const __m128 stepE2 = _mm_set1_ps( e2dx * 4.0f );
+	const __m128 stepE3 = _mm_set1_ps( e3dx * 4.0f );
+	const __m128 stepZ = _mm_set1_ps( zdx * 4.0f );
+	const __m128 offsetE1 = _mm_mul_ps( offsets, _mm_set1_ps( e1dx ) );
+	const __m128 offsetE2 = _mm_mul_ps( offsets, _mm_set1_ps( e2dx ) );
+	const __m128 offsetE3 = _mm_mul_ps( offsets, _mm_set1_ps( e3dx ) );
+	const __m128 offsetZ = _mm_mul_ps( offsets, _mm_set1_ps( zdx ) );
+	
+	for( y=y1; y<y2; y++, row+=pWidth ){
+		__m128 pixelE1 = _mm_add_ps( _mm_set1_ps( rowE1 ), offsetE1 );
+		__m128 pixelE2 = _mm_add_ps( _mm_set1_ps( rowE2 ), offsetE2 );
+		__m128 pixelE3 = _mm_add_ps( _mm_set1_ps( rowE3 ), offsetE3 );
+		__m128 pixelZ = _mm_add_ps( _mm_set1_ps( rowZ ), offsetZ );
+		
+		for( x=x1; x<x2; x+=4 ){
+			const __m128 mask = _mm_and_ps( _mm_and_ps( _mm_cmpge_ps( pixelE1, zero ),
+				_mm_cmpge_ps( pixelE2, zero ) ), _mm_cmpge_ps( pixelE3, zero ) );
+				
+			if( _mm_movemask_ps( mask ) ){
+				const __m128 depth = _mm_loadu_ps( row + x );
+				_mm_storeu_ps( row + x, _mm_or_ps( _mm_and_ps( mask, _mm_min_ps( depth, pixelZ ) ),
+					_mm_andnot_ps( mask, depth ) ) );
+			}
+			
+			pixelE1 = _mm_add_ps( pixelE1, stepE1 );
+			pixelE2 = _mm_add_ps( pixelE2, stepE2 );
+			pixelE3 = _mm_add_ps( pixelE3, stepE3 );
+			pixelZ = _mm_add_ps( pixelZ, stepZ );
+		}
+		
+		rowE1 += e1dy;
+		rowE2 += e2dy;
+		rowE3 += e3dy;
+		rowZ += zdy;
+	}
+	
+#else
+	for( y=y1; y<y2; y++, row+=pWidth ){
+		float pixelE1 = rowE1;
+		float pixelE2 = rowE2;
+		float pixelE3 = rowE3;
+		float pixelZ = rowZ;
+		
+		for( x=x1; x<x2; x++ ){
+			if( pixelE1 >= 0.0f && pixelE2 >= 0.0f && pixelE3 >= 0.0f && pixelZ < row[ x ] ){
+				row[ x ] = pixelZ;
+			}
+			
+			pixelE1 += e1dx;
+			pixelE2 += e2dx;
+			pixelE3 += e3dx;
+			pixelZ += zdx;
+		}
+		
+		rowE1 += e1dy;
+		rowE2 += e2dy;
+		rowE3 += e3dy;
+		rowZ += zdy;
+	}
+#endif
+}
+
+decVector deoglSoftwareOcclusionMap::pProject( const decVector4 &v ) const{
+	const float invW = 1.0f / v.w;
+	return decVector(
+		( v.x * invW * 0.5f + 0.5f ) * ( float )pWidth,
+		( v.y * invW * 0.5f + 0.5f ) * ( float )pHeight,
+		v.z * invW );
+}
@@ -0,0 +1,160 @@
+/* 
+ * Drag[en]gine OpenGL Graphic Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEOGLSOFTWAREOCCLUSIONMAP_H_
+#define _DEOGLSOFTWAREOCCLUSIONMAP_H_
+
+#include <dragengine/common/math/decMath.h>
+
+class deoglROcclusionMesh;
+
+
+
+/**
+ * \brief Software occlusion map.
+ * 
+ * Low resolution depth buffer rasterized on the CPU. Occluder triangles are transformed
+ * into clip space, clipped against the near plane and rasterized 4 pixels at a time using
+ * SIMD instructions if supported by the compiler. After all occluders are added a
+ * hierarchical depth level is built storing the farthest depth of each tile. Boxes are
+ * then tested against the tiles first and against individual pixels only where a tile
+ * is not conclusive.
+ * 
+ * Occluders cover pixels with their center inside the triangle and write the farthest depth
+ * across the pixel. Boxes cover all pixels they touch and use the depth of their closest
+ * corner. Boxes crossing the near plane are always visible.
+ * 
+ * The class does not depend on OpenGL and can be used without a render context. Depth
+ * values are normalized device depth in the range from -1 to 1 as produced by the
+ * frustum matrix.
+ */
+class deoglSoftwareOcclusionMap{
+private:
+	int pWidth;
+	int pHeight;
+	int pTileCountX;
+	int pTileCountY;
+	
+	float *pDepth;
+	float *pTileDepth;
+	
+	decVector4 *pClipVertices;
+	int pClipVertexSize;
+	
+	int pTriangleCount;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/**
+	 * \brief Create software occlusion map.
+	 * 
+	 * Width and height are rounded up to a multiple of the tile size.
+	 */
+	deoglSoftwareOcclusionMap( int width, int height );
+	
+	/** \brief Clean up software occlusion map. */
+	~deoglSoftwareOcclusionMap();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Width in pixels. */
+	inline int GetWidth() const{ return pWidth; }
+	
+	/** \brief Height in pixels. */
+	inline int GetHeight() const{ return pHeight; }
+	
+	/**
+	 * \brief Set size.
+	 * 
+	 * Width and height are rounded up to a multiple of the tile size. Clears the map.
+	 */
+	void SetSize( int width, int height );
+	
+	/** \brief Depth of pixel. */
+	float GetDepthAt( int x, int y ) const;
+	
+	/** \brief Number of triangles rasterized since the last Clear(). */
+	inline int GetTriangleCount() const{ return pTriangleCount; }
+	
+	/** \brief Clear map to the far plane. */
+	void Clear();
+	
+	/**
+	 * \brief Add occluder triangles.
+	 * 
+	 * Corners contain 3 vertex indices per face. Single sided faces are located before the
+	 * double sided faces. Single sided faces are front facing if their corners are counter
+	 * clockwise on screen.
+	 * 
+	 * \param[in] vertices Vertex positions.
+	 * \param[in] vertexCount Number of vertex positions.
+	 * \param[in] corners Vertex indices.
+	 * \param[in] singleSidedFaceCount Number of single sided faces.
+	 * \param[in] doubleSidedFaceCount Number of double sided faces.
+	 * \param[in] matrix Matrix transforming vertices into clip space.
+	 */
+	void AddTriangles( const decVector *vertices, int vertexCount, const unsigned short *corners,
+		int singleSidedFaceCount, int doubleSidedFaceCount, const decMatrix &matrix );
+		
+	/**
+	 * \brief Add occlusion mesh.
+	 * 
+	 * \param[in] occlusionMesh Occlusion mesh.
+	 * \param[in] vertices Transformed vertex positions or NULL to use the mesh vertices.
+	 * \param[in] matrix Matrix transforming vertices into clip space.
+	 */
+	void AddOcclusionMesh( const deoglROcclusionMesh &occlusionMesh,
+		const decVector *vertices, const decMatrix &matrix );
+		
+	/** \brief Update hierarchical depth level. Call after adding all occluders. */
+	void UpdateHiZ();
+	
+	/**
+	 * \brief Box is potentially visible.
+	 * 
+	 * \param[in] minExtend Minimum box extend.
+	 * \param[in] maxExtend Maximum box extend.
+	 * \param[in] matrix Matrix transforming box into clip space.
+	 */
+	bool BoxVisible( const decVector &minExtend, const decVector &maxExtend,
+		const decMatrix &matrix ) const;
+	/*@}*/
+	
+	
+	
+private:
+	void pPrepareClipVertices( int count );
+	void pAddFaces( const unsigned short *corners, int singleSidedFaceCount,
+		int doubleSidedFaceCount );
+	void pAddTriangle( const decVector4 &v1, const decVector4 &v2,
+		const decVector4 &v3, bool doubleSided );
+	void pRasterize( const decVector &p1, const decVector &p2,
+		const decVector &p3, bool doubleSided );
+	decVector pProject( const decVector4 &v ) const;
+};
+
+#endif
@@ -79,6 +79,9 @@ public:
 	/** Retrieves the occlusion mesh. */
 	inline deoglROcclusionMesh *GetOcclusionMesh() const{ return pOcclusionMesh; }
 	
+	/** \brief Transformed vertex positions. Valid after calling Prepare(). */
+	inline const decVector *GetVertices() const{ return pVertices; }
+	
 	/** Retrives the vbo. */
 	inline GLuint GetVBO() const{ return pVBO; }
 	/** Retrieves the VAO. */
@@ -0,0 +1,63 @@
+/* 
+ * Drag[en]gine OpenGL Graphic Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "deoglPSoftwareOcclusionCulling.h"
+#include "../../deGraphicOpenGl.h"
+#include "../../configuration/deoglConfiguration.h"
+
+#include <dragengine/common/exceptions.h>
+
+
+
+// Class deoglPSoftwareOcclusionCulling
+/////////////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+deoglPSoftwareOcclusionCulling::deoglPSoftwareOcclusionCulling( deGraphicOpenGl &ogl ) : deoglParameterBool( ogl ){
+	SetName( "softwareOcclusionCulling" );
+	SetDescription( "Rasterize occlusion meshes of visible components into a low resolution"
+		" depth map on the CPU and cull components hidden behind them before GPU occlusion"
+		" testing. Reduces popping caused by occlusion query results arriving late at the"
+		" cost of CPU time." );
+	SetCategory( ecExpert );
+}
+
+deoglPSoftwareOcclusionCulling::~deoglPSoftwareOcclusionCulling(){
+}
+
+
+
+// Management
+///////////////
+
+bool deoglPSoftwareOcclusionCulling::GetParameterBool(){
+	return pOgl.GetConfiguration().GetSoftwareOcclusionCulling();
+}
+
+void deoglPSoftwareOcclusionCulling::SetParameterBool( bool value ){
+	pOgl.GetConfiguration().SetSoftwareOcclusionCulling( value );
+}
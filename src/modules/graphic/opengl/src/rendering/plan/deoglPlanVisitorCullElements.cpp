@@ -30,6 +30,7 @@
 #include "../../light/deoglRLight.h"
 #include "../../particle/deoglRParticleEmitterInstance.h"
 #include "../../world/deoglWorldOctree.h"
+#include "../../utils/collision/deoglCullBoxList.h"
 #include "../../utils/collision/deoglDCollisionVolume.h"
 #include "../../utils/collision/deoglDCollisionSphere.h"
 #include "../../utils/collision/deoglDCollisionBox.h"
@@ -62,9 +63,21 @@ deoglPlanVisitorCullElements::deoglPlanVisitorCullElements( deoglRenderPlan *pla
 	
 	pCullLayerMask = false;
 	
+	pCollideList = NULL;
+	pTestLightVolumes = true;
+	
+	pVisibleComponents = NULL;
+	pVisibleComponentsSize = 0;
+	
 	SetVisitAll( true );
 }
 
+deoglPlanVisitorCullElements::~deoglPlanVisitorCullElements(){
+	if( pVisibleComponents ){
+		delete [] pVisibleComponents;
+	}
+}
+
 
 
 // Management
@@ -188,6 +201,29 @@ void deoglPlanVisitorCullElements::SetLayerMask( const decLayerMask &layerMask )
 
 
 
+void deoglPlanVisitorCullElements::SetCollideList( deoglCollideList *collideList ){
+	pCollideList = collideList;
+	pUntestedLights.RemoveAll();
+}
+
+void deoglPlanVisitorCullElements::SetTestLightVolumes( bool testLightVolumes ){
+	pTestLightVolumes = testLightVolumes;
+}
+
+void deoglPlanVisitorCullElements::SetCullParametersFrom( const deoglPlanVisitorCullElements &visitor ){
+	pFrustum = visitor.pFrustum;
+	pFrustumMinExtend = visitor.pFrustumMinExtend;
+	pFrustumMaxExtend = visitor.pFrustumMaxExtend;
+	pCameraView = visitor.pCameraView;
+	pCullPixelSize = visitor.pCullPixelSize;
+	pErrorScaling = visitor.pErrorScaling;
+	pCullDynamicComponents = visitor.pCullDynamicComponents;
+	pCullLayerMask = visitor.pCullLayerMask;
+	pLayerMask = visitor.pLayerMask;
+}
+
+
+
 void deoglPlanVisitorCullElements::VisitWorldOctree( deoglWorldOctree &octree ){
 	if( ! pFrustum ){
 		DETHROW( deeInvalidParam );
@@ -206,7 +242,7 @@ void deoglPlanVisitorCullElements::VisitNode( deoglDOctree *node, int intersecti
 	bool cullWithVolume = ( intersection != deoglDCollisionDetection::eirInside );
 	const deoglWorldOctree &sonode = *( ( deoglWorldOctree* )node );
 	const decDVector &cameraPosition = pPlan->GetCameraPosition();
-	deoglCollideList &collideList = pPlan->GetCollideList();
+	deoglCollideList &collideList = pCollideList ? *pCollideList : pPlan->GetCollideList();
 	deoglDCollisionBox box;
 	int i, count;
 	
@@ -221,44 +257,36 @@ void deoglPlanVisitorCullElements::VisitNode( deoglDOctree *node, int intersecti
 	cullWithVolume = true;
 	*/
 	
-	// visit components
-	count = sonode.GetComponentCount();
+	// visit components. the frustum and too-small tests run on the structure-of-arrays cull
+	// boxes of the node. the remaining filters are applied to the components passing
+	const deoglCullBoxList &cullBoxes = sonode.GetComponentCullBoxes();
+	count = cullBoxes.GetCount();
+	
+	if( count > pVisibleComponentsSize ){
+		int * const newArray = new int[ count ];
+		if( pVisibleComponents ){
+			delete [] pVisibleComponents;
+		}
+		pVisibleComponents = newArray;
+		pVisibleComponentsSize = count;
+	}
+	
+	count = cullBoxes.Cull( cullWithVolume ? pFrustum : NULL, cameraPosition,
+		pCameraView, pErrorScaling, pVisibleComponents );
 	
 	for( i=0; i<count; i++ ){
-		deoglRComponent * const component = sonode.GetComponentAt( i );
-		
-		const decDVector &minExtend = component->GetMinimumExtend();
-		const decDVector &maxExtend = component->GetMaximumExtend();
+		const int index = pVisibleComponents[ i ];
 		
 		// cull using layer mask if required. components with empty layer mask never match
 		// and thus are never culled
-		if( pCullLayerMask && component->GetLayerMask().IsNotEmpty()
-		&& pLayerMask.MatchesNot( component->GetLayerMask() ) ){
-			continue;
-		}
-		
-		// cull using cull volume if required
-		if( cullWithVolume ){
-			// possible optmizations:
-			// - check against pFrustum*Extend before checking against the frustum volume
-			// - depending on the size of the object use a sphere instead of a box
-			// - maybe use the sphere for the test against the pFrustum*Extend ?
-			
-			box.SetFromExtends( minExtend, maxExtend );
-			
-			if( ! pFrustum->BoxHitsFrustum( &box ) ){
+		if( pCullLayerMask ){
+			const decLayerMask &layerMask = cullBoxes.GetLayerMaskAt( index );
+			if( layerMask.IsNotEmpty() && pLayerMask.MatchesNot( layerMask ) ){
 				continue;
 			}
 		}
 		
-		// cull using too small filter
-		const decDVector center = ( minExtend + maxExtend ) * 0.5;
-		const float radius = ( float )( ( maxExtend - minExtend ).Length() * 0.5 );
-		const float componentDistance = ( float )( ( center - cameraPosition ) * pCameraView ) - radius;
-		
-		if( componentDistance > ( radius * component->GetLODErrorScaling() ) * pErrorScaling ){
-			continue;
-		}
+		deoglRComponent * const component = sonode.GetComponentAt( index );
 		
 		// cull dynamic if required
 		//if( pCullDynamicComponents && ! component->GetStatic() ){
@@ -328,6 +356,19 @@ void deoglPlanVisitorCullElements::VisitNode( deoglDOctree *node, int intersecti
 			collideList.AddLight( light );
 		}
 		
+	}else if( ! pTestLightVolumes ){
+		for( i=0; i<count; i++ ){
+			deoglRLight * const light = sonode.GetLightAt( i );
+			
+			if( pCullLayerMask && light->GetLayerMask().IsNotEmpty()
+			&& pLayerMask.MatchesNot( light->GetLayerMask() ) ){
+				continue;
+			}
+			
+			pUntestedLights.Add( collideList.GetLightCount() );
+			collideList.AddLight( light );
+		}
+		
 	}else{
 		for( i=0; i<count; i++ ){
 			deoglRLight * const light = sonode.GetLightAt( i );
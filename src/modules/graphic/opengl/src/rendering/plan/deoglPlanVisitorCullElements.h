@@ -22,12 +22,14 @@
 #ifndef _DEOGLPLANVISITORCULLELEMENTS_H_
 #define _DEOGLPLANVISITORCULLELEMENTS_H_
 
+#include <dragengine/common/collection/decIntList.h>
 #include <dragengine/common/math/decMath.h>
 #include <dragengine/common/utils/decLayerMask.h>
 #include <dragengine/common/string/decString.h>
 
 #include "../../world/deoglDefaultWorldOctreeVisitor.h"
 
+class deoglCollideList;
 class deoglDCollisionFrustum;
 class deoglRenderPlan;
 class deoglWorldOctree;
@@ -74,11 +76,27 @@ private:
 	bool pCullLayerMask;
 	decLayerMask pLayerMask;
 	
+	// collide list to add elements to. NULL to use the plan collide list
+	deoglCollideList *pCollideList;
+	
+	// test lights against the frustum. light collision volumes are updated lazily
+	// which is not thread-safe. parallel culling tests lights after merging
+	bool pTestLightVolumes;
+	
+	// indices of lights in the collide list added without testing the collision volume
+	decIntList pUntestedLights;
+	
+	// indices of visible components reported by the node cull boxes
+	int *pVisibleComponents;
+	int pVisibleComponentsSize;
+	
 public:
 	/** @name Constructors and Destructors */
 	/*@{*/
 	/** Creates a new visitor. */
 	deoglPlanVisitorCullElements( deoglRenderPlan *plan );
+	/** Cleans up the visitor. */
+	virtual ~deoglPlanVisitorCullElements();
 	/*@}*/
 	
 	/** @name Management */
@@ -124,6 +142,37 @@ public:
 	/** Sets the layer mask. */
 	void SetLayerMask( const decLayerMask &layerMask );
 	
+	/** Collide list to add elements to or NULL to use the plan collide list. */
+	inline deoglCollideList *GetCollideList() const{ return pCollideList; }
+	/**
+	 * Set collide list to add elements to or NULL to use the plan collide list.
+	 * Clears the untested lights list.
+	 */
+	void SetCollideList( deoglCollideList *collideList );
+	
+	/** Determines if lights are tested against the frustum. */
+	inline bool GetTestLightVolumes() const{ return pTestLightVolumes; }
+	/**
+	 * Sets if lights are tested against the frustum. If disabled lights in nodes partially
+	 * inside the frustum are only tested against the layer mask and their collide list index
+	 * is added to the untested lights list. Disable if the visitor is used by a parallel task
+	 * since the light collision volume is updated lazily which is not thread-safe. The caller
+	 * has to test the untested lights afterwards.
+	 */
+	void SetTestLightVolumes( bool testLightVolumes );
+	
+	/**
+	 * Indices of lights in the collide list added without testing the collision volume.
+	 * Lights in nodes fully inside the frustum are not listed since they need no test.
+	 */
+	inline const decIntList &GetUntestedLights() const{ return pUntestedLights; }
+	
+	/**
+	 * Copy cull parameters from another visitor. Copies the frustum, camera parameters,
+	 * cull filters and layer mask but not the collide list or light volume testing.
+	 */
+	void SetCullParametersFrom( const deoglPlanVisitorCullElements &visitor );
+	
 	/** Visit a world octree using this visitor. */
 	void VisitWorldOctree( deoglWorldOctree &octree );
 	/*@}*/
@@ -29,6 +29,7 @@
 #include "deoglRenderPlanMasked.h"
 #include "deoglPlanVisitorCullElements.h"
 #include "deoglRenderPlanEnvMap.h"
+#include "parallel/deoglRPTCullElements.h"
 #include "../deoglRenderOcclusion.h"
 #include "../deoglRenderReflection.h"
 #include "../deoglRenderWorld.h"
@@ -43,6 +44,7 @@
 #include "../../collidelist/deoglCollideListManager.h"
 #include "../../component/deoglRComponent.h"
 #include "../../configuration/deoglConfiguration.h"
+#include "../../deGraphicOpenGl.h"
 #include "../../debug/deoglDebugInformation.h"
 #include "../../devmode/deoglDeveloperMode.h"
 #include "../../envmap/deoglEnvironmentMap.h"
@@ -51,6 +53,10 @@
 #include "../../model/deoglModelLOD.h"
 #include "../../model/deoglRModel.h"
 #include "../../occlusiontest/deoglOcclusionTest.h"
+#include "../../occlusiontest/deoglSoftwareOcclusionMap.h"
+#include "../../occlusiontest/mesh/deoglDynamicOcclusionMesh.h"
+#include "../../occlusiontest/mesh/deoglROcclusionMesh.h"
+#include "../../particle/deoglParticleEmitterInstanceList.h"
 #include "../../particle/deoglRParticleEmitter.h"
 #include "../../particle/deoglRParticleEmitterInstance.h"
 #include "../../particle/deoglRParticleEmitterInstanceType.h"
@@ -74,12 +80,19 @@
 #include "../../terrain/heightmap/deoglHTViewSector.h"
 #include "../../terrain/heightmap/deoglRHeightTerrain.h"
 #include "../../texture/texture2d/deoglRenderableColorTexture.h"
+#include "../../utils/collision/deoglDCollisionBox.h"
+#include "../../utils/collision/deoglDCollisionDetection.h"
 #include "../../utils/collision/deoglDCollisionFrustum.h"
 #include "../../utils/collision/deoglDCollisionSphere.h"
 #include "../../world/deoglRCamera.h"
 #include "../../world/deoglRWorld.h"
+#include "../../world/deoglWorldOctree.h"
 
+#include <dragengine/deEngine.h>
 #include <dragengine/common/exceptions.h>
+#include <dragengine/parallel/deParallelProcessing.h>
+#include <dragengine/threading/deMutexGuard.h>
+#include <dragengine/threading/deThreadSafeObjectReference.h>
 
 #ifdef OS_W32
 #undef near
@@ -146,6 +159,20 @@ pRenderThread( renderThread ){
 	pDirtyProjMat = true;
 	
 	pVisitorCullElements = new deoglPlanVisitorCullElements( this );
+	pCullElementsFragmentCount = 0;
+	
+	// cull elements tasks are created up front and reused across frames. this way the render
+	// thread never creates or frees tasks. the octree is split at depth 2 hence 64 tasks are
+	// enough to cover all possible work items
+	int i;
+	for( i=0; i<64; i++ ){
+		deThreadSafeObjectReference task;
+		task.TakeOver( new deoglRPTCullElements( *this ) );
+		pCullElementsTaskPool.Add( task );
+		pCullElementsTasksReady.Add( task );
+	}
+	
+	pSoftwareOcclusionMap = NULL;
 	
 	pNoRenderedOccMesh = false;
 	pFlipCulling = false;
@@ -237,6 +264,23 @@ deoglRenderPlan::~deoglRenderPlan(){
 		delete pVisitorCullElements;
 	}
 	
+	if( pSoftwareOcclusionMap ){
+		delete pSoftwareOcclusionMap;
+	}
+	
+	// tasks still held by the parallel processing return to the pool once the main thread
+	// calls Finished() on them. detach them so they do not access the plan anymore
+	int i, count = pCullElementsTaskPool.GetCount();
+	for( i=0; i<count; i++ ){
+		( ( deoglRPTCullElements* )pCullElementsTaskPool.GetAt( i ) )->DropPlan();
+	}
+	pCullElementsTaskPool.RemoveAll();
+	
+	count = pCullElementsFragments.GetCount();
+	for( i=0; i<count; i++ ){
+		delete ( deoglCollideList* )pCullElementsFragments.GetAt( i );
+	}
+	
 	pDirectEnvMapFader.DropAll();
 	
 	if( pEnvMaps ){
@@ -683,9 +727,15 @@ void deoglRenderPlan::pPlanCollideList( deoglDCollisionFrustum *frustum ){
 	pVisitorCullElements->SetCullLayerMask( pUseLayerMask );
 	pVisitorCullElements->SetLayerMask( pLayerMask );
 	
-	pVisitorCullElements->VisitWorldOctree( pWorld->GetOctree() );
+	pPlanCullElements( pWorld->GetOctree(), frustum, true );
 // DEBUG_PRINT_TIMER( "RenderPlan.PrepareRender: Add elements colliding" );
 	
+	if( pRenderThread.GetConfiguration().GetSoftwareOcclusionCulling()
+	&& ! pRenderThread.GetConfiguration().GetDebugNoCulling() ){
+		pPlanSoftwareOcclusion();
+// DEBUG_PRINT_TIMER( "RenderPlan.PrepareRender: Software occlusion culling" );
+	}
+	
 	if( pHTView ){
 		pCollideList.AddHTSectorsColliding( pHTView, frustum );
 	}
@@ -726,6 +776,333 @@ void deoglRenderPlan::pPlanCollideList( deoglDCollisionFrustum *frustum ){
 	pDebugVisibleNoCull();
 }
 
+void deoglRenderPlan::pPlanCullElements( deoglWorldOctree &octree,
+deoglDCollisionFrustum *frustum, bool parallel ){
+	// the octree is split into work items in depth first order. nodes above the split depth
+	// are visited alone while nodes at the split depth are visited including their sub tree.
+	// each work item writes into an own collide list fragment. merging the fragments in work
+	// item order reproduces the order of the sequential visiting
+	deParallelProcessing &processing = pRenderThread.GetOgl().GetGameEngine()->GetParallelProcessing();
+	
+	if( ! parallel || processing.GetPaused() || processing.GetCoreCount() < 2 ){
+		pVisitorCullElements->VisitWorldOctree( octree );
+		return;
+	}
+	
+	pCullElementsNodes.RemoveAll();
+	pCullElementsTasks.RemoveAll();
+	pCullElementsFragmentCount = 0;
+	
+	// take tasks from the pool. tasks used by the previous frame return to the pool once the
+	// main thread called Finished() on them. if not enough tasks are ready yet the octree is
+	// visited sequentially
+	deMutexGuard lock( pMutexCullElementsTasks );
+	bool enoughTasks;
+	
+	try{
+		enoughTasks = pAddCullElementsNodes( octree, frustum, 0 );
+		
+	}catch( const deException & ){
+		lock.Unlock();
+		pReleaseCullElementsTasks();
+		throw;
+	}
+	
+	lock.Unlock();
+	
+	const int count = pCullElementsNodes.GetCount();
+	int i, taskCount = 0;
+	
+	for( i=0; i<count; i++ ){
+		if( pCullElementsTasks.GetAt( i ) ){
+			taskCount++;
+		}
+	}
+	
+	if( ! enoughTasks || taskCount < 2 ){
+		pReleaseCullElementsTasks();
+		pVisitorCullElements->VisitWorldOctree( octree );
+		return;
+	}
+	
+	// start tasks
+	const bool asyncRendering = pRenderThread.GetAsyncRendering();
+	int startedCount = 0;
+	
+	try{
+		for( i=0; i<count; i++ ){
+			deParallelTask * const task = ( deParallelTask* )pCullElementsTasks.GetAt( i );
+			if( ! task ){
+				continue;
+			}
+			
+			if( asyncRendering ){
+				processing.AddTaskAsync( task );
+				
+			}else{
+				processing.AddTask( task );
+			}
+			startedCount++;
+		}
+		
+		// visit nodes above the split depth while the tasks are running
+		for( i=0; i<count; i++ ){
+			if( pCullElementsTasks.GetAt( i ) ){
+				continue;
+			}
+			
+			pVisitorCullElements->SetCollideList( ( deoglCollideList* )pCullElementsFragments.GetAt( i ) );
+			pVisitorCullElements->VisitNode( ( deoglWorldOctree* )pCullElementsNodes.GetAt( i ),
+				deoglDCollisionDetection::eirPartial );
+		}
+		pVisitorCullElements->SetCollideList( NULL );
+		
+	}catch( const deException & ){
+		pVisitorCullElements->SetCollideList( NULL );
+		
+		// started tasks have to finish before the fragments can be touched again. they return
+		// to the pool by themselves. tasks not started are returned to the pool here
+		for( i=0; i<count; i++ ){
+			deParallelTask * const task = ( deParallelTask* )pCullElementsTasks.GetAt( i );
+			if( ! task ){
+				continue;
+			}
+			
+			if( startedCount == 0 ){
+				deMutexGuard lockReady( pMutexCullElementsTasks );
+				pCullElementsTasksReady.Add( task );
+				continue;
+			}
+			
+			if( asyncRendering ){
+				pSemaphoreCullElements.Wait();
+				
+			}else{
+				processing.WaitForTask( task );
+			}
+			startedCount--;
+		}
+		
+		pCullElementsNodes.RemoveAll();
+		pCullElementsTasks.RemoveAll();
+		throw;
+	}
+	
+	// wait for tasks to finish and merge the fragments in work item order. the semaphore is
+	// signaled once per task by the worker thread either after running or after dropping the
+	// cancelled task. lights of nodes visited above have been tested already
+	bool cancelled = false;
+	
+	for( i=0; i<count; i++ ){
+		deoglRPTCullElements * const task = ( deoglRPTCullElements* )pCullElementsTasks.GetAt( i );
+		const deoglCollideList &fragment = *( ( deoglCollideList* )pCullElementsFragments.GetAt( i ) );
+		
+		if( ! task ){
+			if( ! cancelled ){
+				pMergeCullElementsFragment( fragment, NULL, frustum );
+			}
+			continue;
+		}
+		
+		if( asyncRendering ){
+			pSemaphoreCullElements.Wait();
+			
+		}else{
+			processing.WaitForTask( task );
+		}
+		
+		if( task->IsCancelled() ){
+			cancelled = true;
+		}
+		
+		if( ! cancelled ){
+			pMergeCullElementsFragment( fragment, &task->GetUntestedLights(), frustum );
+		}
+	}
+	
+	pCullElementsNodes.RemoveAll();
+	pCullElementsTasks.RemoveAll();
+	
+	if( cancelled ){
+		DETHROW( deeInvalidAction );
+	}
+}
+
+bool deoglRenderPlan::pAddCullElementsNodes( deoglWorldOctree &node,
+deoglDCollisionFrustum *frustum, int depth ){
+	deoglDCollisionBox box( node.GetCenter(), node.GetHalfSize() );
+	if( ! frustum->BoxHitsVolume( &box ) ){
+		return true;
+	}
+	
+	// task semaphore is only used with asynchronous rendering since the render thread is
+	// not the main thread and can not use WaitForTask()
+	if( depth == 2 ){
+		const int readyCount = pCullElementsTasksReady.GetCount();
+		if( readyCount == 0 ){
+			return false;
+		}
+		
+		deoglCollideList &fragment = pNextCullElementsFragment();
+		deoglRPTCullElements * const task = ( deoglRPTCullElements* )
+			pCullElementsTasksReady.GetAt( readyCount - 1 );
+		pCullElementsTasksReady.RemoveFrom( readyCount - 1 );
+		pCullElementsNodes.Add( &node );
+		pCullElementsTasks.Add( task );
+		
+		task->Prepare( fragment, node, pRenderThread.GetAsyncRendering() ? &pSemaphoreCullElements : NULL );
+		return true;
+	}
+	
+	pNextCullElementsFragment();
+	pCullElementsNodes.Add( &node );
+	pCullElementsTasks.Add( NULL );
+	
+	int i;
+	for( i=0; i<8; i++ ){
+		deoglDOctree * const child = node.GetNodeAt( i );
+		if( child && ! pAddCullElementsNodes( *( ( deoglWorldOctree* )child ), frustum, depth + 1 ) ){
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+void deoglRenderPlan::pReleaseCullElementsTasks(){
+	// return tasks not started to the pool
+	deMutexGuard lock( pMutexCullElementsTasks );
+	
+	const int count = pCullElementsTasks.GetCount();
+	int i;
+	for( i=0; i<count; i++ ){
+		void * const task = pCullElementsTasks.GetAt( i );
+		if( task ){
+			pCullElementsTasksReady.Add( task );
+		}
+	}
+	
+	pCullElementsNodes.RemoveAll();
+	pCullElementsTasks.RemoveAll();
+}
+
+deoglCollideList &deoglRenderPlan::pNextCullElementsFragment(){
+	deoglCollideList *fragment;
+	
+	if( pCullElementsFragmentCount < pCullElementsFragments.GetCount() ){
+		fragment = ( deoglCollideList* )pCullElementsFragments.GetAt( pCullElementsFragmentCount );
+		fragment->Clear();
+		
+	}else{
+		fragment = new deoglCollideList;
+		pCullElementsFragments.Add( fragment );
+	}
+	
+	pCullElementsFragmentCount++;
+	return *fragment;
+}
+
+void deoglRenderPlan::pMergeCullElementsFragment( const deoglCollideList &fragment,
+const decIntList *untestedLights, deoglDCollisionFrustum *frustum ){
+	int i, count = fragment.GetComponentCount();
+	for( i=0; i<count; i++ ){
+		pCollideList.AddComponent( fragment.GetComponentAt( i )->GetComponent() );
+	}
+	
+	count = fragment.GetBillboardCount();
+	for( i=0; i<count; i++ ){
+		pCollideList.AddBillboard( fragment.GetBillboardAt( i ) );
+	}
+	
+	// tasks skip the light volume test since light collision volumes are updated lazily.
+	// lights of nodes fully inside the frustum are not listed and need no test. the untested
+	// light indices are in ascending order
+	count = fragment.GetLightCount();
+	const int untestedCount = untestedLights ? untestedLights->GetCount() : 0;
+	int nextUntested = 0;
+	
+	for( i=0; i<count; i++ ){
+		deoglRLight * const light = fragment.GetLightAt( i );
+		
+		if( nextUntested < untestedCount && untestedLights->GetAt( nextUntested ) == i ){
+			nextUntested++;
+			if( ! light->GetCollisionVolume()->VolumeHitsVolume( frustum ) ){
+				continue;
+			}
+		}
+		
+		pCollideList.AddLight( light );
+	}
+	
+	const deoglParticleEmitterInstanceList &emitters = fragment.GetParticleEmitterList();
+	count = emitters.GetCount();
+	for( i=0; i<count; i++ ){
+		pCollideList.GetParticleEmitterList().Add( emitters.GetAt( i ) );
+	}
+}
+
+void deoglRenderPlan::pPlanSoftwareOcclusion(){
+	const int componentCount = pCollideList.GetComponentCount();
+	if( componentCount == 0 ){
+		return;
+	}
+	
+	// the map width is fixed. the height follows the viewport aspect ratio
+	const int width = 256;
+	const int height = decMath::clamp( width * pViewportHeight / decMath::max( pViewportWidth, 1 ), 8, 256 );
+	
+	if( pSoftwareOcclusionMap ){
+		pSoftwareOcclusionMap->SetSize( width, height );
+		
+	}else{
+		pSoftwareOcclusionMap = new deoglSoftwareOcclusionMap( width, height );
+	}
+	
+	// rasterize occlusion meshes of all components in the collide list
+	const decDMatrix matrixCamera( pCameraMatrix * pFrustumMatrix );
+	int i, occluderCount = 0;
+	
+	for( i=0; i<componentCount; i++ ){
+		deoglRComponent &component = *pCollideList.GetComponentAt( i )->GetComponent();
+		const deoglROcclusionMesh * const occlusionMesh = component.GetOcclusionMesh();
+		if( ! occlusionMesh ){
+			continue;
+		}
+		
+		const decMatrix matrix( ( component.GetMatrix() * matrixCamera ).ToMatrix() );
+		deoglDynamicOcclusionMesh * const dynamicOcclusionMesh = component.GetDynamicOcclusionMesh();
+		
+		if( dynamicOcclusionMesh ){
+			dynamicOcclusionMesh->Prepare();
+			pSoftwareOcclusionMap->AddOcclusionMesh( *occlusionMesh,
+				dynamicOcclusionMesh->GetVertices(), matrix );
+				
+		}else{
+			pSoftwareOcclusionMap->AddOcclusionMesh( *occlusionMesh, NULL, matrix );
+		}
+		occluderCount++;
+	}
+	
+	if( occluderCount == 0 ){
+		return;
+	}
+	
+	pSoftwareOcclusionMap->UpdateHiZ();
+	
+	// remove components hidden behind occluders. boxes are tested relative to the camera
+	// position to keep single precision accurate
+	const decMatrix matrixBox( ( decDMatrix::CreateTranslation( pCameraPosition ) * matrixCamera ).ToMatrix() );
+	
+	for( i=0; i<componentCount; i++ ){
+		deoglRComponent &component = *pCollideList.GetComponentAt( i )->GetComponent();
+		component.SetRenderVisible( pSoftwareOcclusionMap->BoxVisible(
+			( component.GetMinimumExtend() - pCameraPosition ).ToVector(),
+			( component.GetMaximumExtend() - pCameraPosition ).ToVector(), matrixBox ) );
+	}
+	
+	pCollideList.RemoveVisibleComponents( false );
+}
+
 void deoglRenderPlan::pPlanOcclusionTestInputData(){
 	const int componentCount = pCollideList.GetComponentCount();
 	deoglOcclusionTest &occtest = pRenderThread.GetOcclusionTest();
@@ -1560,6 +1937,25 @@ void deoglRenderPlan::SetCustomFrustumScreenArea( const decBoundary &area ){
 }
 
 
+void deoglRenderPlan::CullElementsTaskFinished( deoglRPTCullElements *task ){
+	deMutexGuard lock( pMutexCullElementsTasks );
+	pCullElementsTasksReady.Add( task );
+}
+
+void deoglRenderPlan::DevModeCullElements( deoglWorldOctree &octree,
+deoglDCollisionFrustum &frustum, bool parallel ){
+	pCollideList.Clear();
+	
+	pVisitorCullElements->Init( &frustum );
+	pVisitorCullElements->SetCullPixelSize( 1.0f );
+	pVisitorCullElements->SetCullDynamicComponents( pIgnoreDynamicComponents );
+	pVisitorCullElements->SetCullLayerMask( pUseLayerMask );
+	pVisitorCullElements->SetLayerMask( pLayerMask );
+	
+	pPlanCullElements( octree, &frustum, parallel );
+}
+
+
 
 void deoglRenderPlan::SetNoRenderedOccMesh( bool noRenderedOccMesh ){
 	pNoRenderedOccMesh = noRenderedOccMesh;
@@ -27,21 +27,27 @@
 #include "../../utils/collision/deoglDCollisionFrustum.h"
 
 #include <dragengine/common/collection/decPointerList.h>
+#include <dragengine/common/collection/decThreadSafeObjectOrderedSet.h>
 #include <dragengine/common/math/decMath.h>
 #include <dragengine/common/utils/decLayerMask.h>
 #include <dragengine/common/string/decString.h>
+#include <dragengine/threading/deMutex.h>
+#include <dragengine/threading/deSemaphore.h>
 
 #define OGL_RENDER_GAMMA		2.2f
 #define OGL_RENDER_INVGAMMA		( 1.0f / 2.2f )
 
 class deoglRenderThread;
 class deoglRCamera;
+class deoglWorldOctree;
 class deoglFramebuffer;
 class deoglGraphicContext;
 class deoglHTView;
 class deoglOcclusionMap;
+class deoglSoftwareOcclusionMap;
 class deoglRenderPlanEnvMap;
 class deoglPlanVisitorCullElements;
+class deoglRPTCullElements;
 class deoglRenderCacheLight;
 class deoglRenderCacheLightShadow;
 class deoglRenderPlanDebug;
@@ -52,6 +58,7 @@ class deoglTexture;
 class deoglRWorld;
 class deoglRSkyInstance;
 class deoglRSkyInstanceLayer;
+class decIntList;
 
 
 
@@ -115,6 +122,15 @@ private:
 	
 	deoglCollideList pCollideList;
 	deoglPlanVisitorCullElements *pVisitorCullElements;
+	decPointerList pCullElementsNodes;
+	decPointerList pCullElementsTasks;
+	decThreadSafeObjectOrderedSet pCullElementsTaskPool;
+	decPointerList pCullElementsTasksReady;
+	deMutex pMutexCullElementsTasks;
+	decPointerList pCullElementsFragments;
+	int pCullElementsFragmentCount;
+	deSemaphore pSemaphoreCullElements;
+	deoglSoftwareOcclusionMap *pSoftwareOcclusionMap;
 	
 	bool pNoRenderedOccMesh;
 	bool pFlipCulling;
@@ -440,6 +456,27 @@ public:
 	/** \brief Collider list. */
 	inline deoglCollideList &GetCollideList(){ return pCollideList; }
 	
+	/** \brief Cull elements visitor. */
+	inline deoglPlanVisitorCullElements *GetVisitorCullElements() const{ return pVisitorCullElements; }
+	
+	/**
+	 * \brief Cull octree elements into the collide list for developer mode testing.
+	 * 
+	 * Clears the collide list then culls the elements of \em octree against \em frustum
+	 * using the camera parameters of the plan. If \em parallel is false elements are culled
+	 * sequentially otherwise in parallel if possible. Used to benchmark sequential against
+	 * parallel culling using a synthetic octree.
+	 */
+	void DevModeCullElements( deoglWorldOctree &octree, deoglDCollisionFrustum &frustum, bool parallel );
+	
+	/**
+	 * \brief Cull elements task finished.
+	 * 
+	 * Returns the task to the pool of ready tasks. Called by deoglRPTCullElements::Finished()
+	 * from the main thread.
+	 */
+	void CullElementsTaskFinished( deoglRPTCullElements *task );
+	
 	
 	
 	/** \brief Ignore occlusion meshes if owner component has rendered skins. */
@@ -650,6 +687,13 @@ private:
 	void pPlanShadowCasting();
 	void pPlanOcclusionTesting();
 	void pPlanCollideList( deoglDCollisionFrustum *frustum );
+	void pPlanCullElements( deoglWorldOctree &octree, deoglDCollisionFrustum *frustum, bool parallel );
+	bool pAddCullElementsNodes( deoglWorldOctree &node, deoglDCollisionFrustum *frustum, int depth );
+	void pReleaseCullElementsTasks();
+	deoglCollideList &pNextCullElementsFragment();
+	void pPlanSoftwareOcclusion();
+	void pMergeCullElementsFragment( const deoglCollideList &fragment,
+		const decIntList *untestedLights, deoglDCollisionFrustum *frustum );
 	void pPlanOcclusionTestInputData();
 	void pPlanLODLevels();
 	void pPlanEnvMaps();
@@ -0,0 +1,130 @@
+/* 
+ * Drag[en]gine OpenGL Graphic Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "deoglRPTCullElements.h"
+#include "../deoglRenderPlan.h"
+#include "../../../deGraphicOpenGl.h"
+#include "../../../renderthread/deoglRenderThread.h"
+#include "../../../world/deoglWorldOctree.h"
+
+#include <dragengine/common/exceptions.h>
+#include <dragengine/threading/deMutexGuard.h>
+#include <dragengine/threading/deSemaphore.h>
+
+
+
+// Class deoglRPTCullElements
+///////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+deoglRPTCullElements::deoglRPTCullElements( deoglRenderPlan &plan ) :
+deParallelTask( &plan.GetRenderThread().GetOgl() ),
+pPlan( &plan ),
+pVisitor( &plan ),
+pNode( NULL ),
+pSemaphore( NULL )
+{
+	pVisitor.SetTestLightVolumes( false );
+	
+	SetMarkFinishedAfterRun( true );
+}
+
+deoglRPTCullElements::~deoglRPTCullElements(){
+}
+
+
+
+// Management
+///////////////
+
+void deoglRPTCullElements::Prepare( deoglCollideList &collideList,
+deoglWorldOctree &node, deSemaphore *semaphore ){
+	pVisitor.SetCullParametersFrom( *pPlan->GetVisitorCullElements() );
+	pVisitor.SetCollideList( &collideList );
+	pNode = &node;
+	pSemaphore = semaphore;
+}
+
+void deoglRPTCullElements::DropPlan(){
+	deMutexGuard lock( pMutexPlan );
+	pPlan = NULL;
+}
+
+const decIntList &deoglRPTCullElements::GetUntestedLights() const{
+	return pVisitor.GetUntestedLights();
+}
+
+void deoglRPTCullElements::Run(){
+	try{
+		pVisitor.VisitWorldOctree( *pNode );
+		
+	}catch( ... ){
+		Cancel();
+		if( pSemaphore ){
+			pSemaphore->Signal();
+		}
+		throw;
+	}
+	
+	if( pSemaphore ){
+		pSemaphore->Signal();
+	}
+}
+
+void deoglRPTCullElements::Finished(){
+	// the semaphore has been signaled already by Run() or Cancelled(). return the task to
+	// the pool unless the render plan has been destroyed in the mean time
+	deMutexGuard lock( pMutexPlan );
+	if( pPlan ){
+		pPlan->CullElementsTaskFinished( this );
+	}
+}
+
+void deoglRPTCullElements::Cancelled(){
+	// called by the parallel processing while dropping the task without running it
+	if( pSemaphore ){
+		pSemaphore->Signal();
+	}
+}
+
+
+
+// Debugging
+//////////////
+
+decString deoglRPTCullElements::GetDebugName() const{
+	return "OpenGL-RPTCullElements";
+}
+
+decString deoglRPTCullElements::GetDebugDetails() const{
+	decString details;
+	if( pNode ){
+		details.Format( "node=(%.1f,%.1f,%.1f)", pNode->GetCenter().x,
+			pNode->GetCenter().y, pNode->GetCenter().z );
+	}
+	return details;
+}
@@ -0,0 +1,119 @@
+/* 
+ * Drag[en]gine OpenGL Graphic Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEOGLRPTCULLELEMENTS_H_
+#define _DEOGLRPTCULLELEMENTS_H_
+
+#include "../deoglPlanVisitorCullElements.h"
+
+#include <dragengine/parallel/deParallelTask.h>
+#include <dragengine/threading/deMutex.h>
+
+class deoglCollideList;
+class decIntList;
+class deoglRenderPlan;
+class deoglWorldOctree;
+class deSemaphore;
+
+
+/**
+ * \brief Render plan parallel task culling world octree elements.
+ * 
+ * Visits a world octree sub tree adding elements passing the cull filters to a collide
+ * list fragment. The cull parameters are copied from the render plan cull visitor. Lights
+ * in nodes partially inside the frustum are added without testing their collision volume
+ * since these are updated lazily. The render plan tests them while merging the fragments.
+ * 
+ * Tasks are owned by the render plan and reused across frames. Prepare() configures the
+ * task before it is added to the parallel processing. Finished() returns the task to the
+ * render plan. If the render plan is destroyed first DropPlan() detaches the task.
+ * 
+ * If a semaphore is used it is signaled exactly once. Run() signals it after visiting. If
+ * the task is cancelled before running Cancelled() signals it instead. Both are called by
+ * the parallel processing worker threads hence the waiting thread never depends on the
+ * main thread to wake up.
+ */
+class deoglRPTCullElements : public deParallelTask{
+private:
+	deoglRenderPlan *pPlan;
+	deMutex pMutexPlan;
+	deoglPlanVisitorCullElements pVisitor;
+	deoglWorldOctree *pNode;
+	deSemaphore *pSemaphore;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create task. */
+	deoglRPTCullElements( deoglRenderPlan &plan );
+		
+protected:
+	/** \brief Clean up task. */
+	virtual ~deoglRPTCullElements();
+	/*@}*/
+	
+	
+	
+public:
+	/** \name Management */
+	/*@{*/
+	/**
+	 * \brief Prepare task for running.
+	 * \param[in] collideList Collide list fragment to add elements to.
+	 * \param[in] node Octree node to visit including all child nodes.
+	 * \param[in] semaphore Semaphore to signal once the task run or has been cancelled or NULL.
+	 */
+	void Prepare( deoglCollideList &collideList, deoglWorldOctree &node, deSemaphore *semaphore );
+	
+	/** \brief Detach task from render plan. Called by the render plan destructor. */
+	void DropPlan();
+	
+	/**
+	 * \brief Indices of lights in the collide list fragment not tested against the frustum.
+	 * \warning Valid only after the task finished.
+	 */
+	const decIntList &GetUntestedLights() const;
+	
+	/** \brief Parallel task implementation. */
+	virtual void Run();
+	
+	/** \brief Processing of task Run() finished. */
+	virtual void Finished();
+	
+	/** \brief Task has been cancelled before Run() has been called. */
+	virtual void Cancelled();
+	/*@}*/
+	
+	
+	
+	/** \name Debugging */
+	/*@{*/
+	/** \brief Short task name for debugging. */
+	virtual decString GetDebugName() const;
+	
+	/** \brief Task details for debugging. */
+	virtual decString GetDebugDetails() const;
+	/*@}*/
+};
+
+#endif
@@ -0,0 +1,320 @@
+/* 
+ * Drag[en]gine OpenGL Graphic Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "deoglSCConeMapGenerator.h"
+#include "parallel/deoglSCPTGenerateConeMap.h"
+#include "../../deGraphicOpenGl.h"
+
+#include <dragengine/deEngine.h>
+#include <dragengine/common/exceptions.h>
+#include <dragengine/common/collection/decPointerList.h>
+#include <dragengine/common/math/decMath.h>
+#include <dragengine/parallel/deParallelProcessing.h>
+
+
+
+// Definitions
+////////////////
+
+// traversal pushes at most 4 nodes per level and pops one before pushing. 128 entries
+// are enough for textures up to 2^32 texels along each axis
+#define STACK_SIZE 128
+
+struct sConeMapNode{
+	int level;
+	int x;
+	int y;
+};
+
+
+
+// Class deoglSCConeMapGenerator
+//////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+deoglSCConeMapGenerator::deoglSCConeMapGenerator( deoglPixelBuffer::sByte2 *layer, int width, int height ) :
+pLayer( layer ),
+pWidth( width ),
+pHeight( height ),
+pHeights( NULL ),
+pLevelCount( 0 ),
+pLevelWidth( NULL ),
+pLevelHeight( NULL ),
+pLevelOffset( NULL )
+{
+	if( ! layer || width < 1 || height < 1 ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	try{
+		pBuildPyramid();
+		
+	}catch( const deException & ){
+		if( pLevelOffset ){
+			delete [] pLevelOffset;
+		}
+		if( pLevelHeight ){
+			delete [] pLevelHeight;
+		}
+		if( pLevelWidth ){
+			delete [] pLevelWidth;
+		}
+		if( pHeights ){
+			delete [] pHeights;
+		}
+		throw;
+	}
+}
+
+deoglSCConeMapGenerator::~deoglSCConeMapGenerator(){
+	if( pLevelOffset ){
+		delete [] pLevelOffset;
+	}
+	if( pLevelHeight ){
+		delete [] pLevelHeight;
+	}
+	if( pLevelWidth ){
+		delete [] pLevelWidth;
+	}
+	if( pHeights ){
+		delete [] pHeights;
+	}
+}
+
+
+
+// Management
+///////////////
+
+void deoglSCConeMapGenerator::GenerateRows( int firstRow, int rowCount ){
+	if( firstRow < 0 || rowCount < 0 || firstRow + rowCount > pHeight ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	const int lastRow = firstRow + rowCount;
+	int x, y;
+	
+	for( y=firstRow; y<lastRow; y++ ){
+		deoglPixelBuffer::sByte2 * const line = pLayer + pWidth * y;
+		
+		for( x=0; x<pWidth; x++ ){
+			line[ x ].g = ( GLubyte )( 255.0f * pConeRatio( x, y ) );
+		}
+	}
+}
+
+
+
+void deoglSCConeMapGenerator::Generate( deGraphicOpenGl &ogl ){
+	deParallelProcessing &parallel = ogl.GetGameEngine()->GetParallelProcessing();
+	const int taskCount = parallel.GetPaused() ? 1 : decMath::min( pHeight, parallel.GetCoreCount() * 4 );
+	
+	if( taskCount < 2 ){
+		GenerateRows( 0, pHeight );
+		return;
+	}
+	
+	// WaitForTask returns also for cancelled tasks. tasks can not outlive the generator
+	decPointerList tasks;
+	int i;
+	
+	try{
+		for( i=0; i<taskCount; i++ ){
+			const int firstRow = pHeight * i / taskCount;
+			const int lastRow = pHeight * ( i + 1 ) / taskCount;
+			
+			deoglSCPTGenerateConeMap * const task = new deoglSCPTGenerateConeMap(
+				ogl, *this, firstRow, lastRow - firstRow );
+			tasks.Add( task );
+			parallel.AddTask( task );
+		}
+		
+	}catch( const deException & ){
+		pWaitForTasks( parallel, tasks );
+		throw;
+	}
+	
+	if( pWaitForTasks( parallel, tasks ) ){
+		DETHROW( deeInvalidAction );
+	}
+}
+
+
+
+// Private Functions
+//////////////////////
+
+bool deoglSCConeMapGenerator::pWaitForTasks( deParallelProcessing &parallel, decPointerList &tasks ){
+	const int count = tasks.GetCount();
+	bool cancelled = false;
+	int i;
+	
+	for( i=0; i<count; i++ ){
+		deParallelTask * const task = ( deParallelTask* )tasks.GetAt( i );
+		parallel.WaitForTask( task );
+		if( task->IsCancelled() ){
+			cancelled = true;
+		}
+	}
+	
+	for( i=0; i<count; i++ ){
+		( ( deParallelTask* )tasks.GetAt( i ) )->FreeReference();
+	}
+	tasks.RemoveAll();
+	
+	return cancelled;
+}
+
+void deoglSCConeMapGenerator::pBuildPyramid(){
+	// count levels
+	int width = pWidth;
+	int height = pHeight;
+	int heightCount = 0;
+	
+	pLevelCount = 1;
+	heightCount = width * height;
+	while( width > 1 || height > 1 ){
+		width = ( width + 1 ) / 2;
+		height = ( height + 1 ) / 2;
+		heightCount += width * height;
+		pLevelCount++;
+	}
+	
+	pLevelWidth = new int[ pLevelCount ];
+	pLevelHeight = new int[ pLevelCount ];
+	pLevelOffset = new int[ pLevelCount ];
+	pHeights = new unsigned char[ heightCount ];
+	
+	// base level contains the heights of the layer
+	const int pixelCount = pWidth * pHeight;
+	int i, x, y;
+	
+	pLevelWidth[ 0 ] = pWidth;
+	pLevelHeight[ 0 ] = pHeight;
+	pLevelOffset[ 0 ] = 0;
+	
+	for( i=0; i<pixelCount; i++ ){
+		pHeights[ i ] = pLayer[ i ].r;
+	}
+	
+	// each higher level contains the maximum height of the 2x2 nodes below
+	for( i=1; i<pLevelCount; i++ ){
+		const int lowerWidth = pLevelWidth[ i - 1 ];
+		const int lowerHeight = pLevelHeight[ i - 1 ];
+		const unsigned char * const lower = pHeights + pLevelOffset[ i - 1 ];
+		
+		pLevelWidth[ i ] = ( lowerWidth + 1 ) / 2;
+		pLevelHeight[ i ] = ( lowerHeight + 1 ) / 2;
+		pLevelOffset[ i ] = pLevelOffset[ i - 1 ] + lowerWidth * lowerHeight;
+		
+		unsigned char * const level = pHeights + pLevelOffset[ i ];
+		
+		for( y=0; y<pLevelHeight[ i ]; y++ ){
+			const int y1 = y * 2;
+			const int y2 = decMath::min( y1 + 1, lowerHeight - 1 );
+			
+			for( x=0; x<pLevelWidth[ i ]; x++ ){
+				const int x1 = x * 2;
+				const int x2 = decMath::min( x1 + 1, lowerWidth - 1 );
+				
+				level[ pLevelWidth[ i ] * y + x ] = decMath::max(
+					decMath::max( lower[ lowerWidth * y1 + x1 ], lower[ lowerWidth * y1 + x2 ] ),
+					decMath::max( lower[ lowerWidth * y2 + x1 ], lower[ lowerWidth * y2 + x2 ] ) );
+			}
+		}
+	}
+}
+
+float deoglSCConeMapGenerator::pConeRatio( int x, int y ) const{
+	const float factorX = 1.0f / ( float )pWidth;
+	const float factorY = 1.0f / ( float )pHeight;
+	const float factorHeight = 1.0f / 255.0f;
+	const int sourceHeight = pHeights[ pWidth * y + x ];
+	float bestRatio = 1.0f;
+	
+	sConeMapNode stack[ STACK_SIZE ];
+	int stackCount = 1;
+	int i;
+	
+	stack[ 0 ].level = pLevelCount - 1;
+	stack[ 0 ].x = 0;
+	stack[ 0 ].y = 0;
+	
+	while( stackCount > 0 ){
+		const sConeMapNode node( stack[ --stackCount ] );
+		const int nodeHeight = pHeights[ pLevelOffset[ node.level ]
+			+ pLevelWidth[ node.level ] * node.y + node.x ];
+			
+		// nodes not above the texel can not limit the cone
+		if( nodeHeight <= sourceHeight ){
+			continue;
+		}
+		
+		// smallest possible ratio inside the node using the closest texel position and the
+		// maximum height. for base level nodes this is the exact ratio
+		const int nodeX1 = node.x << node.level;
+		const int nodeY1 = node.y << node.level;
+		const int nodeX2 = decMath::min( ( node.x + 1 ) << node.level, pWidth ) - 1;
+		const int nodeY2 = decMath::min( ( node.y + 1 ) << node.level, pHeight ) - 1;
+		const int distanceX = x < nodeX1 ? nodeX1 - x : ( x > nodeX2 ? x - nodeX2 : 0 );
+		const int distanceY = y < nodeY1 ? nodeY1 - y : ( y > nodeY2 ? y - nodeY2 : 0 );
+		const float dx = factorX * ( float )distanceX;
+		const float dy = factorY * ( float )distanceY;
+		const float ratio = sqrtf( dx * dx + dy * dy ) / ( factorHeight * ( float )( nodeHeight - sourceHeight ) );
+		
+		if( ratio >= bestRatio ){
+			continue;
+		}
+		
+		if( node.level == 0 ){
+			bestRatio = ratio;
+			continue;
+		}
+		
+		// push child nodes. the child closest to the texel is pushed last to be visited first
+		const int childLevel = node.level - 1;
+		const int childX = node.x * 2;
+		const int childY = node.y * 2;
+		const int nearX = ( x >> childLevel ) > childX ? 1 : 0;
+		const int nearY = ( y >> childLevel ) > childY ? 1 : 0;
+		
+		for( i=0; i<4; i++ ){
+			const int cx = childX + ( ( i & 1 ) ? nearX : 1 - nearX );
+			const int cy = childY + ( ( i & 2 ) ? nearY : 1 - nearY );
+			
+			if( cx < pLevelWidth[ childLevel ] && cy < pLevelHeight[ childLevel ] ){
+				stack[ stackCount ].level = childLevel;
+				stack[ stackCount ].x = cx;
+				stack[ stackCount ].y = cy;
+				stackCount++;
+			}
+		}
+	}
+	
+	return bestRatio;
+}
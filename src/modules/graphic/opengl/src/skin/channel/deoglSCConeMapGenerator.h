@@ -0,0 +1,118 @@
+/* 
+ * Drag[en]gine OpenGL Graphic Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEOGLSCCONEMAPGENERATOR_H_
+#define _DEOGLSCCONEMAPGENERATOR_H_
+
+#include "../../texture/pixelbuffer/deoglPixelBuffer.h"
+
+class deGraphicOpenGl;
+class deParallelProcessing;
+class decPointerList;
+
+
+
+/**
+ * \brief Cone map generator.
+ * 
+ * Generates cone ratios for a layer of a 2 component byte height map. The first component
+ * is the height and the second component receives the cone ratio.
+ * 
+ * The cone ratio of a texel is the smallest ratio of horizontal distance to height
+ * difference towards any texel above it clamped to 1. Distances are in texture coordinates
+ * and heights in the range from 0 to 1. This is the conservative cone of cone step mapping.
+ * A ray stepping inside the cone never crosses the height field.
+ * 
+ * This is not the relaxed cone of http://http.developer.nvidia.com/GPUGems3/gpugems3_ch18.html
+ * used by the removed skin channel implementation. Relaxed cones allow the ray to cross the
+ * height field once and are wider. Shaders written for relaxed cones step less far with
+ * conservative cones but still converge. No shader uses cone maps right now. The generator is
+ * only tested and benchmarked by the developer mode.
+ * 
+ * A maximum height pyramid is built during construction. Cone ratios are found by
+ * traversing the pyramid nearest node first skipping nodes which can not contain a texel
+ * with a smaller ratio than the best found so far. The result is identical to comparing
+ * the texel against all other texels.
+ * 
+ * After construction GenerateRows() can be called concurrently for disjoint rows. Generate()
+ * splits the rows into parallel tasks.
+ */
+class deoglSCConeMapGenerator{
+private:
+	deoglPixelBuffer::sByte2 * const pLayer;
+	const int pWidth;
+	const int pHeight;
+	
+	unsigned char *pHeights;
+	int pLevelCount;
+	int *pLevelWidth;
+	int *pLevelHeight;
+	int *pLevelOffset;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create cone map generator building the maximum height pyramid. */
+	deoglSCConeMapGenerator( deoglPixelBuffer::sByte2 *layer, int width, int height );
+	
+	/** \brief Clean up cone map generator. */
+	~deoglSCConeMapGenerator();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Width in texels. */
+	inline int GetWidth() const{ return pWidth; }
+	
+	/** \brief Height in texels. */
+	inline int GetHeight() const{ return pHeight; }
+	
+	/** \brief Number of pyramid levels. */
+	inline int GetLevelCount() const{ return pLevelCount; }
+	
+	/** \brief Generate cone ratios for rows. */
+	void GenerateRows( int firstRow, int rowCount );
+	
+	/**
+	 * \brief Generate cone ratios for all rows using parallel tasks.
+	 * 
+	 * Blocks until all tasks are finished. Runs on the calling thread if parallel
+	 * processing is paused.
+	 * 
+	 * \warning Call only from the main thread.
+	 * \throws deeInvalidAction A task has been cancelled. Cone ratios are incomplete.
+	 */
+	void Generate( deGraphicOpenGl &ogl );
+	/*@}*/
+	
+	
+	
+private:
+	bool pWaitForTasks( deParallelProcessing &parallel, decPointerList &tasks );
+	void pBuildPyramid();
+	float pConeRatio( int x, int y ) const;
+};
+
+#endif
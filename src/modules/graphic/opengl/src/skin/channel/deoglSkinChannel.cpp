@@ -450,112 +450,6 @@ void deoglSkinChannel::UseSharedImage(){
 
 
 
-#include <dragengine/common/utils/decTimer.h>
-void deoglSkinChannel::GenerateConeMap(){
-	decTimer timer;
-	
-	// see http://http.developer.nvidia.com/GPUGems3/gpugems3_ch18.html
-	deoglPixelBuffer &pixelBufferBase = *pPixelBufferMipMap->GetPixelBuffer( 0 );
-	deoglPixelBuffer::sByte2 * const data = pixelBufferBase.GetPointerByte2();
-	const int height = pixelBufferBase.GetHeight();
-	const int width = pixelBufferBase.GetWidth();
-	const int depth = pixelBufferBase.GetDepth();
-	const float factorX = 1.0f / ( float )width;
-	const float factorY = 1.0f / ( float )height;
-	const float factorHeight = 1.0f / 255.0f;
-	decVector destination;
-	decVector direction;
-	decVector source;
-	decVector test;
-	float coneRadius;
-	float bestConeRadius;
-	int x, y, z, x2, y2, i, x3, y3;
-	const int stepCount = 16; //128;
-	const float stepFactor = 1.0f / ( float )stepCount;
-	float dx, dy;
-	
-	source.z = 1.0; // top
-	for( z=0; z<depth; z++ ){
-		deoglPixelBuffer::sByte2 * const layer = data + width * height * z;
-		
-		for( y=0; y<height; y++ ){
-			deoglPixelBuffer::sByte2 * const line = layer + width * y;
-			source.y = factorY * ( float )y;
-			
-			printf( "line %i:%i\n", z, y );
-			for( x=0; x<width; x++ ){
-				const float sh = factorHeight * ( float )line[ x ].r;
-				source.x = factorX * ( float )x;
-				bestConeRadius = 1.0f;
-				
-				for( y2=0; y2<height; y2++ ){
-					const deoglPixelBuffer::sByte2 * const line2 = layer + width * y2;
-					destination.y = factorY * ( float )y2;
-					
-					for( x2=0; x2<width; x2++ ){
-						destination.z = factorHeight * ( float )line2[ x2 ].r;
-						if( destination.z == source.z ){
-							continue; // avoid div-by zero and anyways if dest is on the same height as source it's no solution
-						}
-						
-						destination.x = factorX * ( float )x2;
-						
-						direction = destination - source;
-						// scale direction so it runs from destination to bottom and split it into the appropriate step size
-						direction *= stepFactor * destination.z / -direction.z;
-						
-						test = destination; // so destination is not modified
-						x3 = x2;
-						y3 = y2;
-						for( i=0; i<stepCount; i++ ){
-							test += direction;
-							
-							x3 = ( int )( test.x * width );
-							if( x3 < 0 ){
-								x3 = 0;
-							}else if( x3 >= width ){
-								x3 = width - 1;
-							}
-							
-							y3 = ( int )( test.y * height );
-							if( y3 < 0 ){
-								y3 = 0;
-							}else if( y3 >= height ){
-								y3 = height - 1;
-							}
-							
-							if( factorHeight * ( float )layer[ width * y3 + x3 ].r <= test.z ){
-								break;
-							}
-						}
-						
-						if( test.z > sh ){ // destination has to be above source
-							dx = factorX * ( float )( x3 - x );
-							//dx = test.x - source.x;
-							dy = factorY * ( float )( y3 - y );
-							//dy = test.y - source.y;
-							coneRadius = sqrtf( dx * dx + dy * dy ) / ( test.z - sh );
-							if( coneRadius < bestConeRadius ){
-								bestConeRadius = coneRadius;
-							}
-						}
-					}
-					
-					if( x2 < width ){
-						break;
-					}
-				}
-				
-				line[ x ].g = ( GLubyte )( 255.0f * bestConeRadius );
-			}
-		}
-	}
-	
-	printf( "GenerateConeMap in %fs\n", timer.GetElapsedTime() );
-}
-
-
-
 void deoglSkinChannel::DropDelayedDeletionObjects(){
 	if( pCombinedTexture ){
 		pCombinedTexture->RemoveUsage();
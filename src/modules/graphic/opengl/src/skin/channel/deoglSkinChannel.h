@@ -377,9 +377,6 @@ public:
 	 */
 	void BuildChannel( const deSkinTexture &engTexture );
 	
-	/** \brief Generate cone map. */
-	void GenerateConeMap();
-	
 	/** \brief Clear cache data build during a call to PrepareChannel not required anymore. */
 	void ClearCacheData();
 	
@@ -0,0 +1,78 @@
+/* 
+ * Drag[en]gine OpenGL Graphic Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEOGLSCPTGENERATECONEMAP_H_
+#define _DEOGLSCPTGENERATECONEMAP_H_
+
+#include <dragengine/parallel/deParallelTask.h>
+
+class deGraphicOpenGl;
+class deoglSCConeMapGenerator;
+
+
+/**
+ * \brief Skin channel parallel task generating cone map rows.
+ */
+class deoglSCPTGenerateConeMap : public deParallelTask{
+private:
+	deoglSCConeMapGenerator &pGenerator;
+	const int pFirstRow;
+	const int pRowCount;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create task. */
+	deoglSCPTGenerateConeMap( deGraphicOpenGl &ogl, deoglSCConeMapGenerator &generator,
+		int firstRow, int rowCount );
+		
+protected:
+	/** \brief Clean up task. */
+	virtual ~deoglSCPTGenerateConeMap();
+	/*@}*/
+	
+	
+	
+public:
+	/** \name Management */
+	/*@{*/
+	/** \brief Parallel task implementation. */
+	virtual void Run();
+	
+	/** \brief Processing of task Run() finished. */
+	virtual void Finished();
+	/*@}*/
+	
+	
+	
+	/** \name Debugging */
+	/*@{*/
+	/** \brief Short task name for debugging. */
+	virtual decString GetDebugName() const;
+	
+	/** \brief Task details for debugging. */
+	virtual decString GetDebugDetails() const;
+	/*@}*/
+};
+
+#endif
@@ -1900,6 +1900,8 @@ void deoglSkinTexture::pCreateMipMaps(){
 			continue;
 		}
 		
+		pbMipMap->SetOgl( &pRenderThread.GetOgl() );
+		
 		// notes:
 		// - solidity: better would be maximum filtered instead of box filtered mip maps
 		switch( ( deoglSkinChannel::eChannelTypes )i ){
@@ -24,6 +24,7 @@
 
 #include "deoglPixelBuffer.h"
 
+class deGraphicOpenGl;
 
 
 /**
@@ -34,6 +35,7 @@ class deoglPixelBufferMipMap{
 private:
 	deoglPixelBuffer **pPixelBuffers;
 	int pPixelBufferCount;
+	deGraphicOpenGl *pOgl;
 	
 public:
 	/** @name Constructors and Destructors */
@@ -51,6 +53,12 @@ public:
 	/** Retrieves the pixel buffer for a mip map level. */
 	deoglPixelBuffer *GetPixelBuffer( int level ) const;
 	
+	/** \brief Module used to filter large levels using parallel tasks or NULL. */
+	inline deGraphicOpenGl *GetOgl() const{ return pOgl; }
+	
+	/** \brief Set module used to filter large levels using parallel tasks or NULL. */
+	void SetOgl( deGraphicOpenGl *ogl );
+	
 	/**
 	 * \brief Create mip maps from the base level using simple box filtering.
 	 * 
@@ -95,6 +103,7 @@ public:
 	
 private:
 	void pCleanUp();
+	void pFilterLevels( int filter, bool maskRed, bool maskGreen, bool maskBlue, bool maskAlpha );
 	void pGetTypeParams( int pixelBufferType, int &componentCount, bool &floatData ) const;
 };
 
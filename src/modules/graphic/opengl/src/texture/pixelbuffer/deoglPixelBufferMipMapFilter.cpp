@@ -0,0 +1,886 @@
+/* 
+ * Drag[en]gine OpenGL Graphic Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "deoglPixelBufferMipMapFilter.h"
+#include "parallel/deoglPBPTFilterMipMap.h"
+#include "../../deGraphicOpenGl.h"
+
+#include <dragengine/deEngine.h>
+#include <dragengine/common/exceptions.h>
+#include <dragengine/common/math/decMath.h>
+#include <dragengine/parallel/deParallelProcessing.h>
+#include <dragengine/parallel/deParallelTaskReference.h>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define OGL_PBMIPMAP_SSE 1
+#include <emmintrin.h>
+#endif
+
+
+
+// Definitions
+////////////////
+
+// levels with less destination pixels are filtered on the calling thread
+#define PARALLEL_MIN_PIXELS 65536
+
+// number of destination pixels processed per chunk
+#define CHUNK_PIXELS 16384
+
+static const float vNormalFactor1 = 1.99215686f / 255.0f; // see doc/normalmap
+static const float vNormalFactor2 = 0.99217224f; // see doc/normalmap
+static const float vVarianceFactorFloat = 1.0f / HALF_PI;
+static const float vVarianceFactorByte = 255.0f / HALF_PI;
+
+
+
+// deviation of 4 normals from their average normal as angle in the range 0 to pi
+static float fNormalDeviation( decVector normal1, decVector normal2, decVector normal3, decVector normal4 ){
+	const float lenNormal1 = normal1.Length();
+	if( lenNormal1 > FLOAT_SAFE_EPSILON ){
+		normal1 /= lenNormal1;
+		
+	}else{
+		normal1.Set( 0.0f, 0.0f, 1.0f );
+	}
+	
+	const float lenNormal2 = normal2.Length();
+	if( lenNormal2 > FLOAT_SAFE_EPSILON ){
+		normal2 /= lenNormal2;
+		
+	}else{
+		normal2.Set( 0.0f, 0.0f, 1.0f );
+	}
+	
+	const float lenNormal3 = normal3.Length();
+	if( lenNormal3 > FLOAT_SAFE_EPSILON ){
+		normal3 /= lenNormal3;
+		
+	}else{
+		normal3.Set( 0.0f, 0.0f, 1.0f );
+	}
+	
+	const float lenNormal4 = normal4.Length();
+	if( lenNormal4 > FLOAT_SAFE_EPSILON ){
+		normal4 /= lenNormal4;
+		
+	}else{
+		normal4.Set( 0.0f, 0.0f, 1.0f );
+	}
+	
+	decVector normalAverage( ( normal1 + normal2 + normal3 + normal4 ) * 0.25f );
+	const float lenNormalAverage = normalAverage.Length();
+	if( lenNormalAverage > FLOAT_SAFE_EPSILON ){
+		normalAverage /= lenNormalAverage;
+		
+	}else{
+		normalAverage.Set( 0.0f, 0.0f, 1.0f );
+	}
+	
+	const float dot = ( normal1 * normalAverage + normal2 * normalAverage
+		+ normal3 * normalAverage + normal4 * normalAverage ) * 0.25f;
+	return acosf( decMath::clamp( dot, -1.0f, 1.0f ) ); // clamp just to be on the safe side
+}
+
+#ifdef OGL_PBMIPMAP_SSE
+// normalize 4 normals stored as components. normals too short are replaced by (0,0,1)
+static inline void fNormalize4( __m128 &x, __m128 &y, __m128 &z ){
+	const __m128 epsilon = _mm_set1_ps( FLOAT_SAFE_EPSILON );
+	const __m128 length = _mm_sqrt_ps( _mm_add_ps( _mm_add_ps(
+		_mm_mul_ps( x, x ), _mm_mul_ps( y, y ) ), _mm_mul_ps( z, z ) ) );
+	const __m128 valid = _mm_cmpgt_ps( length, epsilon );
+	const __m128 divisor = _mm_max_ps( length, epsilon );
+	
+	x = _mm_and_ps( valid, _mm_div_ps( x, divisor ) );
+	y = _mm_and_ps( valid, _mm_div_ps( y, divisor ) );
+	z = _mm_or_ps( _mm_and_ps( valid, _mm_div_ps( z, divisor ) ),
+		_mm_andnot_ps( valid, _mm_set1_ps( 1.0f ) ) );
+}
+
+// same as fNormalDeviation for 4 pixels at the same time. normals are indexed [normal][pixel]
+static void fNormalDeviation4( const float ( *nx )[ 4 ], const float ( *ny )[ 4 ],
+const float ( *nz )[ 4 ], float *deviation ){
+	__m128 x[ 4 ], y[ 4 ], z[ 4 ];
+	int i;
+	
+	for( i=0; i<4; i++ ){
+		x[ i ] = _mm_loadu_ps( nx[ i ] );
+		y[ i ] = _mm_loadu_ps( ny[ i ] );
+		z[ i ] = _mm_loadu_ps( nz[ i ] );
+		fNormalize4( x[ i ], y[ i ], z[ i ] );
+	}
+	
+	const __m128 quarter = _mm_set1_ps( 0.25f );
+	__m128 ax = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_add_ps( x[ 0 ], x[ 1 ] ), x[ 2 ] ), x[ 3 ] ), quarter );
+	__m128 ay = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_add_ps( y[ 0 ], y[ 1 ] ), y[ 2 ] ), y[ 3 ] ), quarter );
+	__m128 az = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_add_ps( z[ 0 ], z[ 1 ] ), z[ 2 ] ), z[ 3 ] ), quarter );
+	fNormalize4( ax, ay, az );
+	
+	__m128 dot = _mm_setzero_ps();
+	for( i=0; i<4; i++ ){
+		const __m128 d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x[ i ], ax ),
+			_mm_mul_ps( y[ i ], ay ) ), _mm_mul_ps( z[ i ], az ) );
+		dot = i == 0 ? d : _mm_add_ps( dot, d );
+	}
+	dot = _mm_mul_ps( dot, quarter );
+	dot = _mm_min_ps( _mm_max_ps( dot, _mm_set1_ps( -1.0f ) ), _mm_set1_ps( 1.0f ) );
+	
+	float dots[ 4 ];
+	_mm_storeu_ps( dots, dot );
+	for( i=0; i<4; i++ ){
+		deviation[ i ] = acosf( dots[ i ] );
+	}
+}
+#endif
+
+
+
+// Class deoglPixelBufferMipMapFilter
+///////////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+deoglPixelBufferMipMapFilter::deoglPixelBufferMipMapFilter( eFilters filter,
+const deoglPixelBuffer &source, deoglPixelBuffer &destination, bool maskRed,
+bool maskGreen, bool maskBlue, bool maskAlpha ) :
+pFilter( filter ),
+pSource( source ),
+pDestination( destination ),
+pComponentCount( 0 ),
+pFloatData( false ),
+pNormal( NULL ),
+pNormalComponentCount( 0 ),
+pNormalFloatData( false ),
+pNormalTransformX( 0.0f ),
+pNormalTransformY( 0.0f ),
+pRowCount( destination.GetDepth() * destination.GetHeight() ),
+pChunkSize( 1 ),
+pNextRow( 0 )
+{
+	if( source.GetFormat() != destination.GetFormat() || source.GetDepth() != destination.GetDepth()
+	|| destination.GetWidth() != decMath::max( source.GetWidth() >> 1, 1 )
+	|| destination.GetHeight() != decMath::max( source.GetHeight() >> 1, 1 ) ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	switch( source.GetFormat() ){
+	case deoglPixelBuffer::epfByte1:
+	case deoglPixelBuffer::epfByte2:
+	case deoglPixelBuffer::epfByte3:
+	case deoglPixelBuffer::epfByte4:
+		pComponentCount = 1 + ( source.GetFormat() - deoglPixelBuffer::epfByte1 );
+		break;
+		
+	case deoglPixelBuffer::epfFloat1:
+	case deoglPixelBuffer::epfFloat2:
+	case deoglPixelBuffer::epfFloat3:
+	case deoglPixelBuffer::epfFloat4:
+		pComponentCount = 1 + ( source.GetFormat() - deoglPixelBuffer::epfFloat1 );
+		pFloatData = true;
+		break;
+		
+	default:
+		DETHROW( deeInvalidParam );
+	}
+	
+	switch( filter ){
+	case efNormal:
+		if( pComponentCount < 4 ){
+			DETHROW( deeInvalidParam );
+		}
+		
+		// normal is box filtered while the alpha component is calculated separately
+		maskRed = true;
+		maskGreen = true;
+		maskBlue = true;
+		maskAlpha = false;
+		break;
+		
+	case efRoughness:
+		if( pComponentCount < 4 ){
+			DETHROW( deeInvalidParam );
+		}
+		
+		// roughness is stored in the alpha component
+		maskRed = false;
+		maskGreen = false;
+		maskBlue = false;
+		maskAlpha = true;
+		break;
+		
+	default:
+		break;
+	}
+	
+	pMask[ 0 ] = maskRed && pComponentCount > 0;
+	pMask[ 1 ] = maskGreen && pComponentCount > 1;
+	pMask[ 2 ] = maskBlue && pComponentCount > 2;
+	pMask[ 3 ] = maskAlpha && pComponentCount > 3;
+	
+	pChunkSize = decMath::max( CHUNK_PIXELS / destination.GetWidth(), 1 );
+}
+
+deoglPixelBufferMipMapFilter::~deoglPixelBufferMipMapFilter(){
+}
+
+
+
+// Management
+///////////////
+
+void deoglPixelBufferMipMapFilter::SetNormal( const deoglPixelBuffer *normal, float transformX, float transformY ){
+	if( pFilter != efRoughness ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	pNormal = normal;
+	pNormalTransformX = transformX;
+	pNormalTransformY = transformY;
+	
+	if( ! normal ){
+		return;
+	}
+	
+	if( normal->GetWidth() < 2 || normal->GetHeight() < 2 ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	switch( normal->GetFormat() ){
+	case deoglPixelBuffer::epfByte3:
+	case deoglPixelBuffer::epfByte4:
+		pNormalComponentCount = 3 + ( normal->GetFormat() - deoglPixelBuffer::epfByte3 );
+		pNormalFloatData = false;
+		break;
+		
+	case deoglPixelBuffer::epfFloat3:
+	case deoglPixelBuffer::epfFloat4:
+		pNormalComponentCount = 3 + ( normal->GetFormat() - deoglPixelBuffer::epfFloat3 );
+		pNormalFloatData = true;
+		break;
+		
+	default:
+		DETHROW( deeInvalidParam );
+	}
+}
+
+void deoglPixelBufferMipMapFilter::FilterRows( int firstRow, int rowCount ){
+	if( firstRow < 0 || rowCount < 0 || firstRow + rowCount > pRowCount ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	const int sourceWidth = pSource.GetWidth();
+	const int sourceHeight = pSource.GetHeight();
+	const int height = pDestination.GetHeight();
+	const int width = pDestination.GetWidth();
+	const int lastRow = firstRow + rowCount;
+	
+	// if the source pixel buffer has a size of 1 along an axis the second pixel along this
+	// axis is the same as the first one. this deals with the second highest mip map level
+	// which can be 2x1 or 1x2 instead of 2x2
+	const int sourceStride = sourceWidth * pComponentCount;
+	const int offsetX = sourceWidth > 1 ? pComponentCount : 0;
+	const int offsetY = sourceHeight > 1 ? sourceStride : 0;
+	const int destinationStride = width * pComponentCount;
+	int row;
+	
+	for( row=firstRow; row<lastRow; row++ ){
+		const int z = row / height;
+		const int y = row % height;
+		const int sourceOffset = sourceStride * ( sourceHeight * z + y * 2 );
+		const int destinationOffset = destinationStride * row;
+		
+		if( pFloatData ){
+			const GLfloat * const row1 = ( const GLfloat * )pSource.GetPointer() + sourceOffset;
+			const GLfloat * const row2 = row1 + offsetY;
+			GLfloat * const destination = ( GLfloat* )pDestination.GetPointer() + destinationOffset;
+			
+			switch( pFilter ){
+			case efBox:
+			case efRoughness:
+				pFilterBoxFloat( row1, row2, destination, offsetX, width );
+				break;
+				
+			case efMaximum:
+				pFilterMaximumFloat( row1, row2, destination, offsetX, width );
+				break;
+				
+			case efNormal:
+				pFilterNormalFloat( row1, row2, destination, offsetX, width );
+				break;
+			}
+			
+		}else{
+			const GLubyte * const row1 = ( const GLubyte * )pSource.GetPointer() + sourceOffset;
+			const GLubyte * const row2 = row1 + offsetY;
+			GLubyte * const destination = ( GLubyte* )pDestination.GetPointer() + destinationOffset;
+			
+			switch( pFilter ){
+			case efBox:
+			case efRoughness:
+				pFilterBoxByte( row1, row2, destination, offsetX, width );
+				break;
+				
+			case efMaximum:
+				pFilterMaximumByte( row1, row2, destination, offsetX, width );
+				break;
+				
+			case efNormal:
+				pFilterNormalByte( row1, row2, destination, offsetX, width );
+				break;
+			}
+		}
+		
+		if( pFilter == efRoughness && pNormal ){
+			pApplyNormalDeviation( z, y, ( GLubyte* )pDestination.GetPointer()
+				+ pDestination.GetLineStride() * row, width );
+		}
+	}
+}
+
+void deoglPixelBufferMipMapFilter::Filter( deGraphicOpenGl *ogl ){
+	const int pixelCount = pRowCount * pDestination.GetWidth();
+	if( ! ogl || pixelCount < PARALLEL_MIN_PIXELS ){
+		FilterRows( 0, pRowCount );
+		return;
+	}
+	
+	deParallelProcessing &parallel = ogl->GetGameEngine()->GetParallelProcessing();
+	const int chunkCount = ( pRowCount - 1 ) / pChunkSize + 1;
+	const int taskCount = parallel.GetPaused() ? 0 : decMath::min( parallel.GetCoreCount(), chunkCount - 1 );
+	if( taskCount < 1 ){
+		FilterRows( 0, pRowCount );
+		return;
+	}
+	
+	pNextRow = 0;
+	
+	// tasks filter chunks until none are left. the calling thread does the same. tasks use a
+	// plain pointer to the filter hence all started tasks have to signal before returning.
+	// tasks starting after all chunks have been taken exit without touching the pixel buffers
+	int i, startedCount = 0;
+	
+	try{
+		for( i=0; i<taskCount; i++ ){
+			deParallelTaskReference task;
+			task.TakeOver( new deoglPBPTFilterMipMap( *ogl, *this ) );
+			pTasks.Add( ( deParallelTask* )task );
+			parallel.AddTaskAsync( task );
+			startedCount++;
+		}
+		
+		FilterChunks();
+		
+	}catch( const deException & ){
+		for( i=0; i<startedCount; i++ ){
+			pSemaphore.Wait();
+		}
+		pTasks.RemoveAll();
+		throw;
+	}
+	
+	for( i=0; i<startedCount; i++ ){
+		pSemaphore.Wait();
+	}
+	pTasks.RemoveAll();
+}
+
+void deoglPixelBufferMipMapFilter::FilterChunks(){
+	while( true ){
+		pMutex.Lock();
+		
+		if( pNextRow >= pRowCount ){
+			pMutex.Unlock();
+			return;
+		}
+		
+		const int firstRow = pNextRow;
+		const int rowCount = decMath::min( pChunkSize, pRowCount - firstRow );
+		pNextRow += rowCount;
+		
+		pMutex.Unlock();
+		
+		FilterRows( firstRow, rowCount );
+	}
+}
+
+void deoglPixelBufferMipMapFilter::TaskFinished(){
+	pSemaphore.Signal();
+}
+
+
+
+// Private Functions
+//////////////////////
+
+void deoglPixelBufferMipMapFilter::pFilterBoxByte( const GLubyte *row1, const GLubyte *row2,
+GLubyte *destination, int offsetX, int width ) const{
+	const int componentCount = pComponentCount;
+	const int sourceScale = componentCount * 2;
+	int x = 0, i;
+	
+	#ifdef OGL_PBMIPMAP_SSE
+	if( offsetX > 0 && componentCount == 4 ){
+		// 8 source pixels per row to 4 destination pixels. components are summed up as
+		// 16-bit values to get the same result as the scalar version
+		const bool allComponents = pMask[ 0 ] && pMask[ 1 ] && pMask[ 2 ] && pMask[ 3 ];
+		const __m128i mask = _mm_set_epi8(
+			pMask[ 3 ] ? -1 : 0, pMask[ 2 ] ? -1 : 0, pMask[ 1 ] ? -1 : 0, pMask[ 0 ] ? -1 : 0,
+			pMask[ 3 ] ? -1 : 0, pMask[ 2 ] ? -1 : 0, pMask[ 1 ] ? -1 : 0, pMask[ 0 ] ? -1 : 0,
+			pMask[ 3 ] ? -1 : 0, pMask[ 2 ] ? -1 : 0, pMask[ 1 ] ? -1 : 0, pMask[ 0 ] ? -1 : 0,
+			pMask[ 3 ] ? -1 : 0, pMask[ 2 ] ? -1 : 0, pMask[ 1 ] ? -1 : 0, pMask[ 0 ] ? -1 : 0 );
+		const __m128i zero = _mm_setzero_si128();
+		
+		for( ; x+4<=width; x+=4 ){
+			const GLubyte * const sp1 = row1 + x * 8;
+			const GLubyte * const sp2 = row2 + x * 8;
+			__m128i sums[ 2 ];
+			
+			for( i=0; i<2; i++ ){
+				const __m128i a = _mm_loadu_si128( ( const __m128i * )( sp1 + i * 16 ) );
+				const __m128i b = _mm_loadu_si128( ( const __m128i * )( sp2 + i * 16 ) );
+				const __m128i low = _mm_add_epi16( _mm_unpacklo_epi8( a, zero ), _mm_unpacklo_epi8( b, zero ) );
+				const __m128i high = _mm_add_epi16( _mm_unpackhi_epi8( a, zero ), _mm_unpackhi_epi8( b, zero ) );
+				sums[ i ] = _mm_srli_epi16( _mm_add_epi16( _mm_unpacklo_epi64( low, high ),
+					_mm_unpackhi_epi64( low, high ) ), 2 );
+			}
+			
+			__m128i result = _mm_packus_epi16( sums[ 0 ], sums[ 1 ] );
+			__m128i * const dp = ( __m128i* )( destination + x * 4 );
+			
+			if( ! allComponents ){
+				result = _mm_or_si128( _mm_and_si128( mask, result ),
+					_mm_andnot_si128( mask, _mm_loadu_si128( dp ) ) );
+			}
+			_mm_storeu_si128( dp, result );
+		}
+		
+	}else if( offsetX > 0 && componentCount == 1 && pMask[ 0 ] ){
+		// 32 source pixels per row to 16 destination pixels
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i one = _mm_set1_epi16( 1 );
+		
+		for( ; x+16<=width; x+=16 ){
+			const GLubyte * const sp1 = row1 + x * 2;
+			const GLubyte * const sp2 = row2 + x * 2;
+			__m128i sums[ 4 ];
+			
+			for( i=0; i<2; i++ ){
+				const __m128i a = _mm_loadu_si128( ( const __m128i * )( sp1 + i * 16 ) );
+				const __m128i b = _mm_loadu_si128( ( const __m128i * )( sp2 + i * 16 ) );
+				const __m128i low = _mm_add_epi16( _mm_unpacklo_epi8( a, zero ), _mm_unpacklo_epi8( b, zero ) );
+				const __m128i high = _mm_add_epi16( _mm_unpackhi_epi8( a, zero ), _mm_unpackhi_epi8( b, zero ) );
+				sums[ i * 2 ] = _mm_srli_epi32( _mm_madd_epi16( low, one ), 2 );
+				sums[ i * 2 + 1 ] = _mm_srli_epi32( _mm_madd_epi16( high, one ), 2 );
+			}
+			
+			_mm_storeu_si128( ( __m128i* )( destination + x ), _mm_packus_epi16(
+				_mm_packs_epi32( sums[ 0 ], sums[ 1 ] ), _mm_packs_epi32( sums[ 2 ], sums[ 3 ] ) ) );
+		}
+	}
+	#endif
+	
+	for( ; x<width; x++ ){
+		const GLubyte * const sp1 = row1 + x * sourceScale;
+		const GLubyte * const sp2 = sp1 + offsetX;
+		const GLubyte * const sp3 = row2 + x * sourceScale;
+		const GLubyte * const sp4 = sp3 + offsetX;
+		GLubyte * const dp = destination + x * componentCount;
+		
+		for( i=0; i<componentCount; i++ ){
+			if( pMask[ i ] ){
+				dp[ i ] = ( GLubyte )( ( sp1[ i ] + sp2[ i ] + sp3[ i ] + sp4[ i ] ) >> 2 );
+			}
+		}
+	}
+}
+
+void deoglPixelBufferMipMapFilter::pFilterBoxFloat( const GLfloat *row1, const GLfloat *row2,
+GLfloat *destination, int offsetX, int width ) const{
+	const int componentCount = pComponentCount;
+	const int sourceScale = componentCount * 2;
+	int x = 0, i;
+	
+	#ifdef OGL_PBMIPMAP_SSE
+	if( offsetX > 0 && componentCount == 4 ){
+		const bool allComponents = pMask[ 0 ] && pMask[ 1 ] && pMask[ 2 ] && pMask[ 3 ];
+		const __m128 mask = _mm_castsi128_ps( _mm_set_epi32( pMask[ 3 ] ? -1 : 0,
+			pMask[ 2 ] ? -1 : 0, pMask[ 1 ] ? -1 : 0, pMask[ 0 ] ? -1 : 0 ) );
+		const __m128 quarter = _mm_set1_ps( 0.25f );
+		
+		for( ; x<width; x++ ){
+			const GLfloat * const sp1 = row1 + x * 8;
+			const GLfloat * const sp3 = row2 + x * 8;
+			__m128 result = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_loadu_ps( sp1 ),
+				_mm_loadu_ps( sp1 + 4 ) ), _mm_loadu_ps( sp3 ) ), _mm_loadu_ps( sp3 + 4 ) ), quarter );
+			GLfloat * const dp = destination + x * 4;
+			
+			if( ! allComponents ){
+				result = _mm_or_ps( _mm_and_ps( mask, result ), _mm_andnot_ps( mask, _mm_loadu_ps( dp ) ) );
+			}
+			_mm_storeu_ps( dp, result );
+		}
+		
+	}else if( offsetX > 0 && componentCount == 1 && pMask[ 0 ] ){
+		// 8 source pixels per row to 4 destination pixels
+		const __m128 quarter = _mm_set1_ps( 0.25f );
+		
+		for( ; x+4<=width; x+=4 ){
+			const GLfloat * const sp1 = row1 + x * 2;
+			const GLfloat * const sp3 = row2 + x * 2;
+			const __m128 a1 = _mm_loadu_ps( sp1 );
+			const __m128 b1 = _mm_loadu_ps( sp1 + 4 );
+			const __m128 a2 = _mm_loadu_ps( sp3 );
+			const __m128 b2 = _mm_loadu_ps( sp3 + 4 );
+			
+			_mm_storeu_ps( destination + x, _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_add_ps(
+				_mm_shuffle_ps( a1, b1, _MM_SHUFFLE( 2, 0, 2, 0 ) ),
+				_mm_shuffle_ps( a1, b1, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ),
+				_mm_shuffle_ps( a2, b2, _MM_SHUFFLE( 2, 0, 2, 0 ) ) ),
+				_mm_shuffle_ps( a2, b2, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ), quarter ) );
+		}
+	}
+	#endif
+	
+	for( ; x<width; x++ ){
+		const GLfloat * const sp1 = row1 + x * sourceScale;
+		const GLfloat * const sp2 = sp1 + offsetX;
+		const GLfloat * const sp3 = row2 + x * sourceScale;
+		const GLfloat * const sp4 = sp3 + offsetX;
+		GLfloat * const dp = destination + x * componentCount;
+		
+		for( i=0; i<componentCount; i++ ){
+			if( pMask[ i ] ){
+				dp[ i ] = ( GLfloat )( ( sp1[ i ] + sp2[ i ] + sp3[ i ] + sp4[ i ] ) * 0.25f );
+			}
+		}
+	}
+}
+
+void deoglPixelBufferMipMapFilter::pFilterMaximumByte( const GLubyte *row1, const GLubyte *row2,
+GLubyte *destination, int offsetX, int width ) const{
+	const int componentCount = pComponentCount;
+	const int sourceScale = componentCount * 2;
+	int x = 0, i;
+	
+	#ifdef OGL_PBMIPMAP_SSE
+	if( offsetX > 0 && componentCount == 4 ){
+		// 8 source pixels per row to 4 destination pixels. even and odd pixels are
+		// separated using a float shuffle treating each pixel as one 32-bit value
+		const bool allComponents = pMask[ 0 ] && pMask[ 1 ] && pMask[ 2 ] && pMask[ 3 ];
+		const __m128i mask = _mm_set_epi8(
+			pMask[ 3 ] ? -1 : 0, pMask[ 2 ] ? -1 : 0, pMask[ 1 ] ? -1 : 0, pMask[ 0 ] ? -1 : 0,
+			pMask[ 3 ] ? -1 : 0, pMask[ 2 ] ? -1 : 0, pMask[ 1 ] ? -1 : 0, pMask[ 0 ] ? -1 : 0,
+			pMask[ 3 ] ? -1 : 0, pMask[ 2 ] ? -1 : 0, pMask[ 1 ] ? -1 : 0, pMask[ 0 ] ? -1 : 0,
+			pMask[ 3 ] ? -1 : 0, pMask[ 2 ] ? -1 : 0, pMask[ 1 ] ? -1 : 0, pMask[ 0 ] ? -1 : 0 );
+			
+		for( ; x+4<=width; x+=4 ){
+			const GLubyte * const sp1 = row1 + x * 8;
+			const GLubyte * const sp2 = row2 + x * 8;
+			const __m128 a = _mm_castsi128_ps( _mm_max_epu8(
+				_mm_loadu_si128( ( const __m128i * )sp1 ), _mm_loadu_si128( ( const __m128i * )sp2 ) ) );
+			const __m128 b = _mm_castsi128_ps( _mm_max_epu8(
+				_mm_loadu_si128( ( const __m128i * )( sp1 + 16 ) ), _mm_loadu_si128( ( const __m128i * )( sp2 + 16 ) ) ) );
+				
+			__m128i result = _mm_max_epu8(
+				_mm_castps_si128( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) ) ),
+				_mm_castps_si128( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ) );
+			__m128i * const dp = ( __m128i* )( destination + x * 4 );
+			
+			if( ! allComponents ){
+				result = _mm_or_si128( _mm_and_si128( mask, result ),
+					_mm_andnot_si128( mask, _mm_loadu_si128( dp ) ) );
+			}
+			_mm_storeu_si128( dp, result );
+		}
+		
+	}else if( offsetX > 0 && componentCount == 1 && pMask[ 0 ] ){
+		// 32 source pixels per row to 16 destination pixels. the maximum of each pixel
+		// pair ends up in the low byte of each 16-bit value
+		const __m128i lowByte = _mm_set1_epi16( 0xff );
+		
+		for( ; x+16<=width; x+=16 ){
+			const GLubyte * const sp1 = row1 + x * 2;
+			const GLubyte * const sp2 = row2 + x * 2;
+			const __m128i a = _mm_max_epu8( _mm_loadu_si128( ( const __m128i * )sp1 ),
+				_mm_loadu_si128( ( const __m128i * )sp2 ) );
+			const __m128i b = _mm_max_epu8( _mm_loadu_si128( ( const __m128i * )( sp1 + 16 ) ),
+				_mm_loadu_si128( ( const __m128i * )( sp2 + 16 ) ) );
+				
+			_mm_storeu_si128( ( __m128i* )( destination + x ), _mm_packus_epi16(
+				_mm_and_si128( _mm_max_epu8( a, _mm_srli_epi16( a, 8 ) ), lowByte ),
+				_mm_and_si128( _mm_max_epu8( b, _mm_srli_epi16( b, 8 ) ), lowByte ) ) );
+		}
+	}
+	#endif
+	
+	for( ; x<width; x++ ){
+		const GLubyte * const sp1 = row1 + x * sourceScale;
+		const GLubyte * const sp2 = sp1 + offsetX;
+		const GLubyte * const sp3 = row2 + x * sourceScale;
+		const GLubyte * const sp4 = sp3 + offsetX;
+		GLubyte * const dp = destination + x * componentCount;
+		
+		for( i=0; i<componentCount; i++ ){
+			if( pMask[ i ] ){
+				dp[ i ] = decMath::max( decMath::max( sp1[ i ], sp2[ i ] ), decMath::max( sp3[ i ], sp4[ i ] ) );
+			}
+		}
+	}
+}
+
+void deoglPixelBufferMipMapFilter::pFilterMaximumFloat( const GLfloat *row1, const GLfloat *row2,
+GLfloat *destination, int offsetX, int width ) const{
+	const int componentCount = pComponentCount;
+	const int sourceScale = componentCount * 2;
+	int x = 0, i;
+	
+	#ifdef OGL_PBMIPMAP_SSE
+	if( offsetX > 0 && componentCount == 4 ){
+		const bool allComponents = pMask[ 0 ] && pMask[ 1 ] && pMask[ 2 ] && pMask[ 3 ];
+		const __m128 mask = _mm_castsi128_ps( _mm_set_epi32( pMask[ 3 ] ? -1 : 0,
+			pMask[ 2 ] ? -1 : 0, pMask[ 1 ] ? -1 : 0, pMask[ 0 ] ? -1 : 0 ) );
+			
+		for( ; x<width; x++ ){
+			const GLfloat * const sp1 = row1 + x * 8;
+			const GLfloat * const sp3 = row2 + x * 8;
+			__m128 result = _mm_max_ps( _mm_max_ps( _mm_loadu_ps( sp1 ), _mm_loadu_ps( sp1 + 4 ) ),
+				_mm_max_ps( _mm_loadu_ps( sp3 ), _mm_loadu_ps( sp3 + 4 ) ) );
+			GLfloat * const dp = destination + x * 4;
+			
+			if( ! allComponents ){
+				result = _mm_or_ps( _mm_and_ps( mask, result ), _mm_andnot_ps( mask, _mm_loadu_ps( dp ) ) );
+			}
+			_mm_storeu_ps( dp, result );
+		}
+		
+	}else if( offsetX > 0 && componentCount == 1 && pMask[ 0 ] ){
+		for( ; x+4<=width; x+=4 ){
+			const GLfloat * const sp1 = row1 + x * 2;
+			const GLfloat * const sp3 = row2 + x * 2;
+			const __m128 a = _mm_max_ps( _mm_loadu_ps( sp1 ), _mm_loadu_ps( sp3 ) );
+			const __m128 b = _mm_max_ps( _mm_loadu_ps( sp1 + 4 ), _mm_loadu_ps( sp3 + 4 ) );
+			
+			_mm_storeu_ps( destination + x, _mm_max_ps(
+				_mm_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) ),
+				_mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ) );
+		}
+	}
+	#endif
+	
+	for( ; x<width; x++ ){
+		const GLfloat * const sp1 = row1 + x * sourceScale;
+		const GLfloat * const sp2 = sp1 + offsetX;
+		const GLfloat * const sp3 = row2 + x * sourceScale;
+		const GLfloat * const sp4 = sp3 + offsetX;
+		GLfloat * const dp = destination + x * componentCount;
+		
+		for( i=0; i<componentCount; i++ ){
+			if( pMask[ i ] ){
+				dp[ i ] = decMath::max( decMath::max( sp1[ i ], sp2[ i ] ), decMath::max( sp3[ i ], sp4[ i ] ) );
+			}
+		}
+	}
+}
+
+void deoglPixelBufferMipMapFilter::pFilterNormalByte( const GLubyte *row1, const GLubyte *row2,
+GLubyte *destination, int offsetX, int width ) const{
+	// box filter the normal. the variance is the maximum variance plus the deviation of the
+	// normals from their average. the deviation is stored as a linear function mapping the
+	// spread angle in the range of 0 to half-pi to the range from 0 to 1. since the deviation
+	// can be only positive clamping is only required towards the largest allowed pixel value
+	pFilterBoxByte( row1, row2, destination, offsetX, width );
+	
+	int x = 0, i, j;
+	
+	#ifdef OGL_PBMIPMAP_SSE
+	float nx[ 4 ][ 4 ], ny[ 4 ][ 4 ], nz[ 4 ][ 4 ];
+	float deviation[ 4 ];
+	
+	for( ; x+4<=width; x+=4 ){
+		for( i=0; i<4; i++ ){
+			const GLubyte * const sp[ 4 ] = { row1 + ( x + i ) * 8, row1 + ( x + i ) * 8 + offsetX,
+				row2 + ( x + i ) * 8, row2 + ( x + i ) * 8 + offsetX };
+				
+			for( j=0; j<4; j++ ){
+				nx[ j ][ i ] = ( float )sp[ j ][ 0 ] * vNormalFactor1 - vNormalFactor2;
+				ny[ j ][ i ] = ( float )sp[ j ][ 1 ] * vNormalFactor1 - vNormalFactor2;
+				nz[ j ][ i ] = ( float )sp[ j ][ 2 ] * vNormalFactor1 - vNormalFactor2;
+			}
+		}
+		
+		fNormalDeviation4( nx, ny, nz, deviation );
+		
+		for( i=0; i<4; i++ ){
+			const GLubyte * const sp1 = row1 + ( x + i ) * 8;
+			const GLubyte * const sp3 = row2 + ( x + i ) * 8;
+			const int variance = decMath::max( decMath::max( sp1[ 3 ], sp1[ offsetX + 3 ] ),
+				decMath::max( sp3[ 3 ], sp3[ offsetX + 3 ] ) )
+					+ ( int )( deviation[ i ] * vVarianceFactorByte );
+			destination[ ( x + i ) * 4 + 3 ] = ( GLubyte )decMath::min( variance, 255 );
+		}
+	}
+	#endif
+	
+	for( ; x<width; x++ ){
+		const GLubyte * const sp1 = row1 + x * 8;
+		const GLubyte * const sp2 = sp1 + offsetX;
+		const GLubyte * const sp3 = row2 + x * 8;
+		const GLubyte * const sp4 = sp3 + offsetX;
+		
+		const float deviation = fNormalDeviation(
+			decVector( ( float )sp1[ 0 ], ( float )sp1[ 1 ], ( float )sp1[ 2 ] ) * vNormalFactor1
+				- decVector( vNormalFactor2, vNormalFactor2, vNormalFactor2 ),
+			decVector( ( float )sp2[ 0 ], ( float )sp2[ 1 ], ( float )sp2[ 2 ] ) * vNormalFactor1
+				- decVector( vNormalFactor2, vNormalFactor2, vNormalFactor2 ),
+			decVector( ( float )sp3[ 0 ], ( float )sp3[ 1 ], ( float )sp3[ 2 ] ) * vNormalFactor1
+				- decVector( vNormalFactor2, vNormalFactor2, vNormalFactor2 ),
+			decVector( ( float )sp4[ 0 ], ( float )sp4[ 1 ], ( float )sp4[ 2 ] ) * vNormalFactor1
+				- decVector( vNormalFactor2, vNormalFactor2, vNormalFactor2 ) );
+				
+		const int variance = decMath::max( decMath::max( sp1[ 3 ], sp2[ 3 ] ), decMath::max( sp3[ 3 ], sp4[ 3 ] ) )
+			+ ( int )( deviation * vVarianceFactorByte );
+		destination[ x * 4 + 3 ] = ( GLubyte )decMath::min( variance, 255 );
+	}
+}
+
+void deoglPixelBufferMipMapFilter::pFilterNormalFloat( const GLfloat *row1, const GLfloat *row2,
+GLfloat *destination, int offsetX, int width ) const{
+	// see pFilterNormalByte
+	pFilterBoxFloat( row1, row2, destination, offsetX, width );
+	
+	int x = 0, i, j;
+	
+	#ifdef OGL_PBMIPMAP_SSE
+	float nx[ 4 ][ 4 ], ny[ 4 ][ 4 ], nz[ 4 ][ 4 ];
+	float deviation[ 4 ];
+	
+	for( ; x+4<=width; x+=4 ){
+		for( i=0; i<4; i++ ){
+			const GLfloat * const sp[ 4 ] = { row1 + ( x + i ) * 8, row1 + ( x + i ) * 8 + offsetX,
+				row2 + ( x + i ) * 8, row2 + ( x + i ) * 8 + offsetX };
+				
+			for( j=0; j<4; j++ ){
+				nx[ j ][ i ] = sp[ j ][ 0 ];
+				ny[ j ][ i ] = sp[ j ][ 1 ];
+				nz[ j ][ i ] = sp[ j ][ 2 ];
+			}
+		}
+		
+		fNormalDeviation4( nx, ny, nz, deviation );
+		
+		for( i=0; i<4; i++ ){
+			const GLfloat * const sp1 = row1 + ( x + i ) * 8;
+			const GLfloat * const sp3 = row2 + ( x + i ) * 8;
+			const float variance = decMath::max( decMath::max( sp1[ 3 ], sp1[ offsetX + 3 ] ),
+				decMath::max( sp3[ 3 ], sp3[ offsetX + 3 ] ) ) + deviation[ i ] * vVarianceFactorFloat;
+			destination[ ( x + i ) * 4 + 3 ] = ( GLfloat )decMath::min( variance, 1.0f );
+		}
+	}
+	#endif
+	
+	for( ; x<width; x++ ){
+		const GLfloat * const sp1 = row1 + x * 8;
+		const GLfloat * const sp2 = sp1 + offsetX;
+		const GLfloat * const sp3 = row2 + x * 8;
+		const GLfloat * const sp4 = sp3 + offsetX;
+		
+		const float deviation = fNormalDeviation( decVector( sp1[ 0 ], sp1[ 1 ], sp1[ 2 ] ),
+			decVector( sp2[ 0 ], sp2[ 1 ], sp2[ 2 ] ), decVector( sp3[ 0 ], sp3[ 1 ], sp3[ 2 ] ),
+			decVector( sp4[ 0 ], sp4[ 1 ], sp4[ 2 ] ) );
+			
+		const float variance = decMath::max( decMath::max( sp1[ 3 ], sp2[ 3 ] ), decMath::max( sp3[ 3 ], sp4[ 3 ] ) )
+			+ deviation * vVarianceFactorFloat;
+		destination[ x * 4 + 3 ] = ( GLfloat )decMath::min( variance, 1.0f );
+	}
+}
+
+void deoglPixelBufferMipMapFilter::pApplyNormalDeviation( int layer, int y, void *destination, int width ) const{
+	// for the offsets the same 2x2 pattern is used even if the normal mip map level and
+	// roughness mip map level dimensions do not match. this is a rare case and leads anyways
+	// to debatable results hence using the simple and fast 2x2 version is well enough
+	const deoglPixelBuffer &normal = *pNormal;
+	const int normalLayer = layer < normal.GetDepth() ? layer : 0;
+	const int normalWidth = normal.GetWidth();
+	const int normalHeight = normal.GetHeight();
+	const int normalComponentCount = pNormalComponentCount;
+	const int ny = decMath::min( ( int )( pNormalTransformY * ( float )y ), normalHeight - 2 );
+	const int normalRowOffset = normalWidth * ( normalHeight * normalLayer + ny ) * normalComponentCount;
+	const int normalStride = normalWidth * normalComponentCount;
+	decVector normal1, normal2, normal3, normal4;
+	int x;
+	
+	for( x=0; x<width; x++ ){
+		const int nx = decMath::min( ( int )( pNormalTransformX * ( float )x ), normalWidth - 2 );
+		const int normalOffset = normalRowOffset + nx * normalComponentCount;
+		
+		// retrieve the four normals of the lower mip map level
+		if( pNormalFloatData ){
+			const GLfloat * const np1 = ( const GLfloat * )normal.GetPointer() + normalOffset;
+			const GLfloat * const np2 = np1 + normalComponentCount;
+			const GLfloat * const np3 = np1 + normalStride;
+			const GLfloat * const np4 = np3 + normalComponentCount;
+			
+			normal1.Set( np1[ 0 ], np1[ 1 ], np1[ 2 ] );
+			normal2.Set( np2[ 0 ], np2[ 1 ], np2[ 2 ] );
+			normal3.Set( np3[ 0 ], np3[ 1 ], np3[ 2 ] );
+			normal4.Set( np4[ 0 ], np4[ 1 ], np4[ 2 ] );
+			
+		}else{
+			const GLubyte * const np1 = ( const GLubyte * )normal.GetPointer() + normalOffset;
+			const GLubyte * const np2 = np1 + normalComponentCount;
+			const GLubyte * const np3 = np1 + normalStride;
+			const GLubyte * const np4 = np3 + normalComponentCount;
+			
+			normal1.Set( ( float )np1[ 0 ] / 127.5f - 1.0f, ( float )np1[ 1 ] / 127.5f - 1.0f, ( float )np1[ 2 ] / 127.5f - 1.0f );
+			normal2.Set( ( float )np2[ 0 ] / 127.5f - 1.0f, ( float )np2[ 1 ] / 127.5f - 1.0f, ( float )np2[ 2 ] / 127.5f - 1.0f );
+			normal3.Set( ( float )np3[ 0 ] / 127.5f - 1.0f, ( float )np3[ 1 ] / 127.5f - 1.0f, ( float )np3[ 2 ] / 127.5f - 1.0f );
+			normal4.Set( ( float )np4[ 0 ] / 127.5f - 1.0f, ( float )np4[ 1 ] / 127.5f - 1.0f, ( float )np4[ 2 ] / 127.5f - 1.0f );
+		}
+		
+		// the average is the same as the normal on the current mip map level. it is faster to
+		// calculate it like this instead of reading from the matching normal map level.
+		// the minimum dot product between each normal and the average normal gives the largest
+		// deviation. this is a conservative solution which is correct more often than others
+		const decVector normalAverage( ( normal1 + normal2 + normal3 + normal4 ) * 0.25f );
+		const float dotMin = decMath::min( decMath::min( normal1 * normalAverage, normal2 * normalAverage ),
+			decMath::min( normal3 * normalAverage, normal4 * normalAverage ) );
+			
+		// roughness is defined as a linear function mapping the spread angle in the range of
+		// 0 to half-pi to the range from 0 to 1. the deviation is thus directly converted to
+		// an increase in roughness. since the increase is always positive the resulting
+		// roughness has to be only clamped at 1
+		const float correction = acosf( decMath::clamp( dotMin, -1.0f, 1.0f ) ) / HALF_PI;
+		
+		if( pFloatData ){
+			GLfloat &roughness = ( ( GLfloat* )destination )[ x * 4 + 3 ];
+			roughness = ( GLfloat )decMath::min( roughness + correction, 1.0f );
+			
+		}else{
+			GLubyte &roughness = ( ( GLubyte* )destination )[ x * 4 + 3 ];
+			roughness = ( GLubyte )( decMath::min( ( float )roughness / 255.0f + correction, 1.0f ) * 255.0f );
+		}
+	}
+}
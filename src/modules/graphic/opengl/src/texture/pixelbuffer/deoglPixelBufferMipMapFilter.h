@@ -0,0 +1,183 @@
+/* 
+ * Drag[en]gine OpenGL Graphic Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEOGLPIXELBUFFERMIPMAPFILTER_H_
+#define _DEOGLPIXELBUFFERMIPMAPFILTER_H_
+
+#include "deoglPixelBuffer.h"
+
+#include <dragengine/common/collection/decThreadSafeObjectOrderedSet.h>
+#include <dragengine/threading/deMutex.h>
+#include <dragengine/threading/deSemaphore.h>
+
+class deGraphicOpenGl;
+
+
+
+/**
+ * \brief Filter pixel buffer mip map level from the next lower level.
+ * 
+ * Each destination pixel is calculated from the 2x2 source pixels below. Rows of all layers
+ * are processed independently of each other. Filtering can be split into chunks of rows
+ * processed by parallel tasks. The calling thread processes chunks too. Tasks are owned by
+ * the filter and use a plain pointer to it. The calling thread waits for all tasks to run
+ * or to be cancelled before Filter() returns. The filter is owned by the calling thread
+ * and has to stay alive until Filter() returned. Do not call Filter() from inside a
+ * parallel task since the calling thread waits for the queued tasks.
+ * 
+ * Filters use SIMD instructions if supported by the compiler for 1 and 4 component pixel
+ * buffers. Other pixel buffers are processed using scalar code.
+ */
+class deoglPixelBufferMipMapFilter{
+public:
+	/** \brief Filters. */
+	enum eFilters{
+		/** \brief Box filter. */
+		efBox,
+		
+		/** \brief Maximum filter. */
+		efMaximum,
+		
+		/**
+		 * \brief Normal filter.
+		 * 
+		 * Box filters the normal and stores the maximum variance plus the deviation of
+		 * the normals in the alpha component.
+		 */
+		efNormal,
+		
+		/**
+		 * \brief Roughness filter.
+		 * 
+		 * Box filters the alpha component and adds the deviation of the normals from the
+		 * normal pixel buffer if set.
+		 */
+		efRoughness
+	};
+	
+	
+	
+private:
+	const eFilters pFilter;
+	const deoglPixelBuffer &pSource;
+	deoglPixelBuffer &pDestination;
+	int pComponentCount;
+	bool pFloatData;
+	bool pMask[ 4 ];
+	
+	const deoglPixelBuffer *pNormal;
+	int pNormalComponentCount;
+	bool pNormalFloatData;
+	float pNormalTransformX;
+	float pNormalTransformY;
+	
+	deMutex pMutex;
+	deSemaphore pSemaphore;
+	int pRowCount;
+	int pChunkSize;
+	int pNextRow;
+	decThreadSafeObjectOrderedSet pTasks;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/**
+	 * \brief Create filter.
+	 * 
+	 * Only components with their mask set to true are processed.
+	 */
+	deoglPixelBufferMipMapFilter( eFilters filter, const deoglPixelBuffer &source,
+		deoglPixelBuffer &destination, bool maskRed, bool maskGreen, bool maskBlue, bool maskAlpha );
+		
+	/** \brief Clean up filter. */
+	~deoglPixelBufferMipMapFilter();
+	/*@}*/
+	
+	
+	
+public:
+	/** \name Management */
+	/*@{*/
+	/** \brief Filter. */
+	inline eFilters GetFilter() const{ return pFilter; }
+	
+	/** \brief Number of rows across all layers. */
+	inline int GetRowCount() const{ return pRowCount; }
+	
+	/**
+	 * \brief Set normal pixel buffer for roughness filter or NULL to not use one.
+	 * 
+	 * Normal pixel buffer has to be at least 2x2 in size.
+	 */
+	void SetNormal( const deoglPixelBuffer *normal, float transformX, float transformY );
+	
+	/**
+	 * \brief Filter rows.
+	 * 
+	 * Rows are counted across all layers. Row index is layer times height plus row.
+	 */
+	void FilterRows( int firstRow, int rowCount );
+	
+	/**
+	 * \brief Filter all rows.
+	 * 
+	 * If \em ogl is not NULL and the level is large enough filtering is split into chunks
+	 * processed by parallel tasks together with the calling thread.
+	 */
+	void Filter( deGraphicOpenGl *ogl );
+	
+	/**
+	 * \brief Filter chunks until no chunks are left.
+	 * 
+	 * For use by parallel tasks only.
+	 */
+	void FilterChunks();
+	
+	/**
+	 * \brief Task finished running or has been cancelled.
+	 * 
+	 * For use by parallel tasks only. Called exactly once per task as the last access of
+	 * the task to the filter.
+	 */
+	void TaskFinished();
+	/*@}*/
+	
+	
+	
+private:
+	void pFilterBoxByte( const GLubyte *row1, const GLubyte *row2, GLubyte *destination,
+		int offsetX, int width ) const;
+	void pFilterBoxFloat( const GLfloat *row1, const GLfloat *row2, GLfloat *destination,
+		int offsetX, int width ) const;
+	void pFilterMaximumByte( const GLubyte *row1, const GLubyte *row2, GLubyte *destination,
+		int offsetX, int width ) const;
+	void pFilterMaximumFloat( const GLfloat *row1, const GLfloat *row2, GLfloat *destination,
+		int offsetX, int width ) const;
+	void pFilterNormalByte( const GLubyte *row1, const GLubyte *row2, GLubyte *destination,
+		int offsetX, int width ) const;
+	void pFilterNormalFloat( const GLfloat *row1, const GLfloat *row2, GLfloat *destination,
+		int offsetX, int width ) const;
+	void pApplyNormalDeviation( int layer, int y, void *destination, int width ) const;
+};
+
+#endif
@@ -0,0 +1,90 @@
+/* 
+ * Drag[en]gine OpenGL Graphic Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "deoglPBPTFilterMipMap.h"
+#include "../deoglPixelBufferMipMapFilter.h"
+#include "../../../deGraphicOpenGl.h"
+
+#include <dragengine/common/exceptions.h>
+
+
+
+// Class deoglPBPTFilterMipMap
+////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+deoglPBPTFilterMipMap::deoglPBPTFilterMipMap( deGraphicOpenGl &ogl, deoglPixelBufferMipMapFilter &filter ) :
+deParallelTask( &ogl ),
+pFilter( &filter ),
+pFilterType( filter.GetFilter() ),
+pRowCount( filter.GetRowCount() )
+{
+	SetMarkFinishedAfterRun( true );
+}
+
+deoglPBPTFilterMipMap::~deoglPBPTFilterMipMap(){
+}
+
+
+
+// Management
+///////////////
+
+void deoglPBPTFilterMipMap::Run(){
+	// the filter can be destroyed as soon as TaskFinished() has been called
+	try{
+		pFilter->FilterChunks();
+		
+	}catch( const deException & ){
+		pFilter->TaskFinished();
+		throw;
+	}
+	
+	pFilter->TaskFinished();
+}
+
+void deoglPBPTFilterMipMap::Finished(){
+}
+
+void deoglPBPTFilterMipMap::Cancelled(){
+	pFilter->TaskFinished();
+}
+
+
+
+// Debugging
+//////////////
+
+decString deoglPBPTFilterMipMap::GetDebugName() const{
+	return "OpenGL-PBPTFilterMipMap";
+}
+
+decString deoglPBPTFilterMipMap::GetDebugDetails() const{
+	decString details;
+	details.Format( "filter=%d rows=%d", pFilterType, pRowCount );
+	return details;
+}
@@ -0,0 +1,80 @@
+/* 
+ * Drag[en]gine OpenGL Graphic Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEOGLPBPTFILTERMIPMAP_H_
+#define _DEOGLPBPTFILTERMIPMAP_H_
+
+#include <dragengine/parallel/deParallelTask.h>
+
+class deGraphicOpenGl;
+class deoglPixelBufferMipMapFilter;
+
+
+/**
+ * \brief Pixel buffer parallel task filtering mip map level chunks.
+ */
+class deoglPBPTFilterMipMap : public deParallelTask{
+private:
+	deoglPixelBufferMipMapFilter *pFilter;
+	const int pFilterType;
+	const int pRowCount;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create task. */
+	deoglPBPTFilterMipMap( deGraphicOpenGl &ogl, deoglPixelBufferMipMapFilter &filter );
+	
+protected:
+	/** \brief Clean up task. */
+	virtual ~deoglPBPTFilterMipMap();
+	/*@}*/
+	
+	
+	
+public:
+	/** \name Management */
+	/*@{*/
+	/** \brief Parallel task implementation. */
+	virtual void Run();
+	
+	/** \brief Processing of task Run() finished. */
+	virtual void Finished();
+	
+	/** \brief Task has been cancelled before Run() has been called. */
+	virtual void Cancelled();
+	/*@}*/
+	
+	
+	
+	/** \name Debugging */
+	/*@{*/
+	/** \brief Short task name for debugging. */
+	virtual decString GetDebugName() const;
+	
+	/** \brief Task details for debugging. */
+	virtual decString GetDebugDetails() const;
+	/*@}*/
+};
+
+#endif
@@ -0,0 +1,359 @@
+/* 
+ * Drag[en]gine OpenGL Graphic Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "deoglCullBoxList.h"
+#include "deoglDCollisionFrustum.h"
+
+#include <dragengine/common/exceptions.h>
+
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 1 )
+#define OGL_CULLBOX_SSE 1
+#include <xmmintrin.h>
+#endif
+
+
+
+// Definitions
+////////////////
+
+// boxes are padded by this amount to make the single precision tests conservative
+#define PADDING_HALF_SIZE 0.001f
+
+
+
+// Class deoglCullBoxList
+///////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+deoglCullBoxList::deoglCullBoxList( const decDVector &referencePosition ) :
+pReferencePosition( referencePosition ),
+pCenterX( NULL ),
+pCenterY( NULL ),
+pCenterZ( NULL ),
+pHalfSizeX( NULL ),
+pHalfSizeY( NULL ),
+pHalfSizeZ( NULL ),
+pLODErrorScaling( NULL ),
+pLayerMasks( NULL ),
+pCount( 0 ),
+pSize( 0 ){
+}
+
+deoglCullBoxList::~deoglCullBoxList(){
+	if( pLayerMasks ){
+		delete [] pLayerMasks;
+	}
+	if( pLODErrorScaling ){
+		delete [] pLODErrorScaling;
+	}
+	if( pHalfSizeZ ){
+		delete [] pHalfSizeZ;
+	}
+	if( pHalfSizeY ){
+		delete [] pHalfSizeY;
+	}
+	if( pHalfSizeX ){
+		delete [] pHalfSizeX;
+	}
+	if( pCenterZ ){
+		delete [] pCenterZ;
+	}
+	if( pCenterY ){
+		delete [] pCenterY;
+	}
+	if( pCenterX ){
+		delete [] pCenterX;
+	}
+}
+
+
+
+// Management
+///////////////
+
+const decLayerMask &deoglCullBoxList::GetLayerMaskAt( int index ) const{
+	if( index < 0 || index >= pCount ){
+		DETHROW( deeInvalidParam );
+	}
+	return pLayerMasks[ index ];
+}
+
+float deoglCullBoxList::GetLODErrorScalingAt( int index ) const{
+	if( index < 0 || index >= pCount ){
+		DETHROW( deeInvalidParam );
+	}
+	return pLODErrorScaling[ index ];
+}
+
+void deoglCullBoxList::Add( const decDVector &minExtend, const decDVector &maxExtend,
+const decLayerMask &layerMask, float lodErrorScaling ){
+	if( pCount == pSize ){
+		// size is kept a multiple of 4 so the SIMD path can read full blocks
+		const int newSize = ( ( pSize * 3 / 2 + 4 ) + 3 ) & ~3;
+		float * const newCenterX = new float[ newSize ];
+		float * const newCenterY = new float[ newSize ];
+		float * const newCenterZ = new float[ newSize ];
+		float * const newHalfSizeX = new float[ newSize ];
+		float * const newHalfSizeY = new float[ newSize ];
+		float * const newHalfSizeZ = new float[ newSize ];
+		float * const newLODErrorScaling = new float[ newSize ];
+		decLayerMask * const newLayerMasks = new decLayerMask[ newSize ];
+		
+		// padding entries are never reported but keep them valid numbers
+		memset( newCenterX, 0, sizeof( float ) * newSize );
+		memset( newCenterY, 0, sizeof( float ) * newSize );
+		memset( newCenterZ, 0, sizeof( float ) * newSize );
+		memset( newHalfSizeX, 0, sizeof( float ) * newSize );
+		memset( newHalfSizeY, 0, sizeof( float ) * newSize );
+		memset( newHalfSizeZ, 0, sizeof( float ) * newSize );
+		memset( newLODErrorScaling, 0, sizeof( float ) * newSize );
+		
+		if( pSize > 0 ){
+			memcpy( newCenterX, pCenterX, sizeof( float ) * pCount );
+			memcpy( newCenterY, pCenterY, sizeof( float ) * pCount );
+			memcpy( newCenterZ, pCenterZ, sizeof( float ) * pCount );
+			memcpy( newHalfSizeX, pHalfSizeX, sizeof( float ) * pCount );
+			memcpy( newHalfSizeY, pHalfSizeY, sizeof( float ) * pCount );
+			memcpy( newHalfSizeZ, pHalfSizeZ, sizeof( float ) * pCount );
+			memcpy( newLODErrorScaling, pLODErrorScaling, sizeof( float ) * pCount );
+			
+			int i;
+			for( i=0; i<pCount; i++ ){
+				newLayerMasks[ i ] = pLayerMasks[ i ];
+			}
+			
+			delete [] pCenterX;
+			delete [] pCenterY;
+			delete [] pCenterZ;
+			delete [] pHalfSizeX;
+			delete [] pHalfSizeY;
+			delete [] pHalfSizeZ;
+			delete [] pLODErrorScaling;
+			delete [] pLayerMasks;
+		}
+		
+		pCenterX = newCenterX;
+		pCenterY = newCenterY;
+		pCenterZ = newCenterZ;
+		pHalfSizeX = newHalfSizeX;
+		pHalfSizeY = newHalfSizeY;
+		pHalfSizeZ = newHalfSizeZ;
+		pLODErrorScaling = newLODErrorScaling;
+		pLayerMasks = newLayerMasks;
+		pSize = newSize;
+	}
+	
+	pSetAt( pCount, minExtend, maxExtend, layerMask, lodErrorScaling );
+	pCount++;
+}
+
+void deoglCullBoxList::SetAt( int index, const decDVector &minExtend, const decDVector &maxExtend,
+const decLayerMask &layerMask, float lodErrorScaling ){
+	if( index < 0 || index >= pCount ){
+		DETHROW( deeInvalidParam );
+	}
+	pSetAt( index, minExtend, maxExtend, layerMask, lodErrorScaling );
+}
+
+void deoglCullBoxList::RemoveFrom( int index ){
+	if( index < 0 || index >= pCount ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	const int moveCount = pCount - index - 1;
+	if( moveCount > 0 ){
+		memmove( pCenterX + index, pCenterX + index + 1, sizeof( float ) * moveCount );
+		memmove( pCenterY + index, pCenterY + index + 1, sizeof( float ) * moveCount );
+		memmove( pCenterZ + index, pCenterZ + index + 1, sizeof( float ) * moveCount );
+		memmove( pHalfSizeX + index, pHalfSizeX + index + 1, sizeof( float ) * moveCount );
+		memmove( pHalfSizeY + index, pHalfSizeY + index + 1, sizeof( float ) * moveCount );
+		memmove( pHalfSizeZ + index, pHalfSizeZ + index + 1, sizeof( float ) * moveCount );
+		memmove( pLODErrorScaling + index, pLODErrorScaling + index + 1, sizeof( float ) * moveCount );
+		
+		int i;
+		for( i=index+1; i<pCount; i++ ){
+			pLayerMasks[ i - 1 ] = pLayerMasks[ i ];
+		}
+	}
+	
+	pCount--;
+}
+
+void deoglCullBoxList::RemoveAll(){
+	pCount = 0;
+}
+
+
+
+int deoglCullBoxList::Cull( const deoglDCollisionFrustum *frustum, const decDVector &cameraPosition,
+const decDVector &cameraView, float errorScaling, int *visible ) const{
+	if( pCount == 0 ){
+		return 0;
+	}
+	if( ! visible ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	// convert frustum planes into single precision planes relative to the reference position.
+	// the test is: box passes plane if center*normal + halfSize*abs(normal) >= distance .
+	// without frustum no planes are tested
+	float planeNX[ 6 ], planeNY[ 6 ], planeNZ[ 6 ], planeAX[ 6 ], planeAY[ 6 ], planeAZ[ 6 ], planeDist[ 6 ];
+	int i, planeCount = 0;
+	
+	if( frustum ){
+		const decDVector normals[ 6 ] = { frustum->GetNearNormal(), frustum->GetFarNormal(),
+			frustum->GetLeftNormal(), frustum->GetRightNormal(),
+			frustum->GetTopNormal(), frustum->GetBottomNormal() };
+		const double distances[ 6 ] = { frustum->GetNearDistance(), frustum->GetFarDistance(),
+			frustum->GetLeftDistance(), frustum->GetRightDistance(),
+			frustum->GetTopDistance(), frustum->GetBottomDistance() };
+			
+		for( i=0; i<6; i++ ){
+			planeNX[ i ] = ( float )normals[ i ].x;
+			planeNY[ i ] = ( float )normals[ i ].y;
+			planeNZ[ i ] = ( float )normals[ i ].z;
+			planeAX[ i ] = fabsf( planeNX[ i ] );
+			planeAY[ i ] = fabsf( planeNY[ i ] );
+			planeAZ[ i ] = fabsf( planeNZ[ i ] );
+			planeDist[ i ] = ( float )( distances[ i ] - normals[ i ] * pReferencePosition );
+		}
+		planeCount = 6;
+	}
+	
+	// too small filter: box is culled if ( center - camera ) * view - radius > radius * lodScale * errorScaling
+	const decVector camera( cameraPosition - pReferencePosition );
+	const decVector view( cameraView );
+	int visibleCount = 0;
+	
+#ifdef OGL_CULLBOX_SSE
+	const __m128 vCameraX = _mm_set1_ps( camera.x );
+	const __m128 vCameraY = _mm_set1_ps( camera.y );
+	const __m128 vCameraZ = _mm_set1_ps( camera.z );
+	const __m128 vViewX = _mm_set1_ps( view.x );
+	const __m128 vViewY = _mm_set1_ps( view.y );
+	const __m128 vViewZ = _mm_set1_ps( view.z );
+	const __m128 vErrorScaling = _mm_set1_ps( errorScaling );
+	int j, b;
+	
+	for( i=0; i<pCount; i+=4 ){
+		const __m128 cx = _mm_loadu_ps( pCenterX + i );
+		const __m128 cy = _mm_loadu_ps( pCenterY + i );
+		const __m128 cz = _mm_loadu_ps( pCenterZ + i );
+		const __m128 hx = _mm_loadu_ps( pHalfSizeX + i );
+		const __m128 hy = _mm_loadu_ps( pHalfSizeY + i );
+		const __m128 hz = _mm_loadu_ps( pHalfSizeZ + i );
+		__m128 pass = _mm_cmpeq_ps( cx, cx ); // all bits set
+		
+		for( j=0; j<planeCount; j++ ){
+			const __m128 dot = _mm_add_ps( _mm_add_ps(
+				_mm_mul_ps( cx, _mm_set1_ps( planeNX[ j ] ) ),
+				_mm_mul_ps( cy, _mm_set1_ps( planeNY[ j ] ) ) ),
+				_mm_mul_ps( cz, _mm_set1_ps( planeNZ[ j ] ) ) );
+			const __m128 reach = _mm_add_ps( _mm_add_ps(
+				_mm_mul_ps( hx, _mm_set1_ps( planeAX[ j ] ) ),
+				_mm_mul_ps( hy, _mm_set1_ps( planeAY[ j ] ) ) ),
+				_mm_mul_ps( hz, _mm_set1_ps( planeAZ[ j ] ) ) );
+			pass = _mm_and_ps( pass, _mm_cmpge_ps( _mm_add_ps( dot, reach ), _mm_set1_ps( planeDist[ j ] ) ) );
+		}
+		
+		const __m128 radius = _mm_sqrt_ps( _mm_add_ps( _mm_add_ps(
+			_mm_mul_ps( hx, hx ), _mm_mul_ps( hy, hy ) ), _mm_mul_ps( hz, hz ) ) );
+		const __m128 distance = _mm_sub_ps( _mm_add_ps( _mm_add_ps(
+			_mm_mul_ps( _mm_sub_ps( cx, vCameraX ), vViewX ),
+			_mm_mul_ps( _mm_sub_ps( cy, vCameraY ), vViewY ) ),
+			_mm_mul_ps( _mm_sub_ps( cz, vCameraZ ), vViewZ ) ), radius );
+		const __m128 threshold = _mm_mul_ps( _mm_mul_ps( radius,
+			_mm_loadu_ps( pLODErrorScaling + i ) ), vErrorScaling );
+		pass = _mm_and_ps( pass, _mm_cmple_ps( distance, threshold ) );
+		
+		const int mask = _mm_movemask_ps( pass );
+		if( mask == 0 ){
+			continue;
+		}
+		
+		for( b=0; b<4; b++ ){
+			if( ( mask & ( 1 << b ) ) && i + b < pCount ){
+				visible[ visibleCount++ ] = i + b;
+			}
+		}
+	}
+	
+#else
+	int j;
+	
+	for( i=0; i<pCount; i++ ){
+		const float cx = pCenterX[ i ];
+		const float cy = pCenterY[ i ];
+		const float cz = pCenterZ[ i ];
+		const float hx = pHalfSizeX[ i ];
+		const float hy = pHalfSizeY[ i ];
+		const float hz = pHalfSizeZ[ i ];
+		
+		for( j=0; j<planeCount; j++ ){
+			if( cx * planeNX[ j ] + cy * planeNY[ j ] + cz * planeNZ[ j ]
+			+ hx * planeAX[ j ] + hy * planeAY[ j ] + hz * planeAZ[ j ] < planeDist[ j ] ){
+				break;
+			}
+		}
+		if( j < planeCount ){
+			continue;
+		}
+		
+		const float radius = sqrtf( hx * hx + hy * hy + hz * hz );
+		const float distance = ( cx - camera.x ) * view.x + ( cy - camera.y ) * view.y
+			+ ( cz - camera.z ) * view.z - radius;
+		if( distance > radius * pLODErrorScaling[ i ] * errorScaling ){
+			continue;
+		}
+		
+		visible[ visibleCount++ ] = i;
+	}
+#endif
+	
+	return visibleCount;
+}
+
+
+
+// Private Functions
+//////////////////////
+
+void deoglCullBoxList::pSetAt( int index, const decDVector &minExtend, const decDVector &maxExtend,
+const decLayerMask &layerMask, float lodErrorScaling ){
+	const decDVector center( ( minExtend + maxExtend ) * 0.5 - pReferencePosition );
+	const decDVector halfSize( ( maxExtend - minExtend ) * 0.5 );
+	
+	pCenterX[ index ] = ( float )center.x;
+	pCenterY[ index ] = ( float )center.y;
+	pCenterZ[ index ] = ( float )center.z;
+	pHalfSizeX[ index ] = ( float )halfSize.x + PADDING_HALF_SIZE;
+	pHalfSizeY[ index ] = ( float )halfSize.y + PADDING_HALF_SIZE;
+	pHalfSizeZ[ index ] = ( float )halfSize.z + PADDING_HALF_SIZE;
+	pLODErrorScaling[ index ] = lodErrorScaling;
+	pLayerMasks[ index ] = layerMask;
+}
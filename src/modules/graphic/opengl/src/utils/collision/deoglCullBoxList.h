@@ -0,0 +1,126 @@
+/* 
+ * Drag[en]gine OpenGL Graphic Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEOGLCULLBOXLIST_H_
+#define _DEOGLCULLBOXLIST_H_
+
+#include <dragengine/common/math/decMath.h>
+#include <dragengine/common/utils/decLayerMask.h>
+
+class deoglDCollisionFrustum;
+
+
+
+/**
+ * \brief List of boxes to cull in structure-of-arrays layout.
+ * 
+ * Stores axis aligned boxes together with the layer mask and LOD error scaling of the
+ * element the box belongs to. Boxes are stored as single precision center and half size
+ * relative to a fixed reference position. This keeps the precision high enough for large
+ * worlds while allowing the cull tests to run on 4 boxes at the same time using SIMD
+ * instructions if supported by the compiler. The double precision frustum is converted
+ * into single precision planes relative to the reference position once per cull call.
+ * 
+ * Indices in the list match the indices of the elements stored in the owner. Removing
+ * boxes keeps the order of the remaining boxes.
+ */
+class deoglCullBoxList{
+private:
+	decDVector pReferencePosition;
+	
+	float *pCenterX;
+	float *pCenterY;
+	float *pCenterZ;
+	float *pHalfSizeX;
+	float *pHalfSizeY;
+	float *pHalfSizeZ;
+	float *pLODErrorScaling;
+	decLayerMask *pLayerMasks;
+	int pCount;
+	int pSize;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create cull box list. */
+	deoglCullBoxList( const decDVector &referencePosition );
+	
+	/** \brief Clean up cull box list. */
+	~deoglCullBoxList();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Reference position. */
+	inline const decDVector &GetReferencePosition() const{ return pReferencePosition; }
+	
+	/** \brief Number of boxes. */
+	inline int GetCount() const{ return pCount; }
+	
+	/** \brief Layer mask at index. */
+	const decLayerMask &GetLayerMaskAt( int index ) const;
+	
+	/** \brief LOD error scaling at index. */
+	float GetLODErrorScalingAt( int index ) const;
+	
+	/** \brief Add box. */
+	void Add( const decDVector &minExtend, const decDVector &maxExtend,
+		const decLayerMask &layerMask, float lodErrorScaling );
+		
+	/** \brief Set box at index. */
+	void SetAt( int index, const decDVector &minExtend, const decDVector &maxExtend,
+		const decLayerMask &layerMask, float lodErrorScaling );
+		
+	/** \brief Remove box at index keeping the order of the remaining boxes. */
+	void RemoveFrom( int index );
+	
+	/** \brief Remove all boxes. */
+	void RemoveAll();
+	
+	
+	
+	/**
+	 * \brief Cull boxes.
+	 * 
+	 * Writes the indices of all boxes passing the tests to \em visible which has to be
+	 * large enough to hold GetCount() indices. Returns the number of indices written.
+	 * 
+	 * \param[in] frustum Frustum to test boxes against or NULL to skip the test.
+	 * \param[in] cameraPosition Camera position for the too-small filter.
+	 * \param[in] cameraView Normalized camera view direction for the too-small filter.
+	 * \param[in] errorScaling Error scaling for the too-small filter.
+	 */
+	int Cull( const deoglDCollisionFrustum *frustum, const decDVector &cameraPosition,
+		const decDVector &cameraView, float errorScaling, int *visible ) const;
+	/*@}*/
+	
+	
+	
+private:
+	void pSetAt( int index, const decDVector &minExtend, const decDVector &maxExtend,
+		const decLayerMask &layerMask, float lodErrorScaling );
+};
+
+#endif
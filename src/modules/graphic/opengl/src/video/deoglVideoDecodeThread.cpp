@@ -19,6 +19,7 @@
  * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
  */
 
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -59,19 +60,30 @@ deoglVideoDecodeThread::deoglVideoDecodeThread( deVideoDecoder *decoder, deVideo
 pDecoder( decoder ),
 pVideo( video ),
 pFrame( -1 ),
-pNextFrame( -1 ),
 
 pPixelBufferDecode( NULL ),
 pPixelBufferTexture( NULL ),
 
-pDecoding( false ),
+pIdentityConversion( true ),
+
 pHasDecodedFrame( false ),
+pWaitFinished( false ),
+pIdle( true ),
 pShutDown( false )
 {
 	if( ! decoder || ! video ){
 		DETHROW( deeInvalidParam );
 	}
 	
+	int i;
+	for( i=0; i<AheadFrameCount; i++ ){
+		pAheadFrames[ i ].frame = -1;
+		pAheadFrames[ i ].pixelBuffer = NULL;
+		pAheadFrames[ i ].ready = false;
+	}
+	
+	pInitConversion();
+	
 	//printf( "Start decode thread %p\n", this );
 	Start();
 }
@@ -80,6 +92,13 @@ deoglVideoDecodeThread::~deoglVideoDecodeThread(){
 	//printf( "Shut down decode thread %p\n", this );
 	pSafelyShutDownThread();
 	
+	int i;
+	for( i=0; i<AheadFrameCount; i++ ){
+		if( pAheadFrames[ i ].pixelBuffer ){
+			delete pAheadFrames[ i ].pixelBuffer;
+		}
+	}
+	
 	if( pPixelBufferTexture ){
 		delete pPixelBufferTexture;
 	}
@@ -94,60 +113,70 @@ deoglVideoDecodeThread::~deoglVideoDecodeThread(){
 ///////////////
 
 void deoglVideoDecodeThread::StartDecode( int frame ){
-	bool startDecoding = false;
-	bool waitFinished = false;
-	
 	deMutexGuard guard( pMutex );
 	
-// 	printf( "DecodeThread(%p) StartDecode(%p,%p,%i)\n", this, decoder, video, frame );
+// 	printf( "DecodeThread(%p) StartDecode(%i)\n", this, frame );
 	
-	if( pDecoding && ! pHasDecodedFrame ){
-		if( pFrame == frame ){
-			// if the new next frame to decode is identical to the currently decoded frame cancel the next
-			// decoding to avoid wasting time decoding two times the same frame
-			//printf( "DecodeThread(%p) StartDecode(%p,%p,%i): Next frame identical to current frame.\n", this, decoder, video, frame );
-			pNextFrame = -1;
-			
-		}else{
-			//printf( "DecodeThread(%p) StartDecode(%p,%p,%i): Set next frame to decode.\n", this, decoder, video, frame );
-			pNextFrame = frame;
-		}
-		
-	}else{
-		waitFinished = ( pDecoding && pHasDecodedFrame );
-		
-		if( pFrame != frame ){
-			//printf( "DecodeThread(%p) StartDecode(%p,%p,%i): Set frame to decode.\n", this, decoder, video, frame );
-			pFrame = frame;
-			startDecoding = true;
-			
-		}else{
-			//printf( "DecodeThread(%p) StartDecode(%p,%p,%i): Same frame, not decoding.\n", this, decoder, video, frame );
-		}
+	if( frame == pFrame ){
+		return;
 	}
 	
-	guard.Unlock();
+	pFrame = frame;
+	pHasDecodedFrame = false;
 	
-	if( waitFinished ){
-		DEBUG_SYNC_MT_WAIT("StartDecode() finished")
-		pSemaphoreFinished.Wait();
-		DEBUG_SYNC_MT_DONE("StartDecode() finished")
-		pDecoding = false;
+	// discard frames decoded ahead which are not following the frame. the frame
+	// currently decoding is left alone and discarded once finished if not used
+	const int lastFrame = frame + AheadFrameCount - 1;
+	int i;
+	
+	for( i=0; i<AheadFrameCount; i++ ){
+		sAheadFrame &aheadFrame = pAheadFrames[ i ];
+		
+		if( aheadFrame.ready && ( aheadFrame.frame < frame || aheadFrame.frame > lastFrame ) ){
+			aheadFrame.frame = -1;
+			aheadFrame.ready = false;
+		}
 	}
-	if( startDecoding ){
-		pDecoding = true;
-		pHasDecodedFrame = false;
+	
+	if( pIdle ){
+		pIdle = false;
 		DEBUG_SYNC_MT_SIGNAL("StartDecode() decode")
 		pSemaphoreDecode.Signal();
 	}
 }
 
 deoglPixelBuffer *deoglVideoDecodeThread::GetTexturePixelBuffer(){
-	if( pDecoding ){
+	deMutexGuard guard( pMutex );
+	
+	while( pFrame != -1 && ! pHasDecodedFrame ){
+		const int slot = pFindAheadFrame( pFrame );
+		
+		if( slot != -1 && pAheadFrames[ slot ].ready ){
+			// swap pixel buffers. the texture pixel buffer is reused by the thread
+			sAheadFrame &aheadFrame = pAheadFrames[ slot ];
+			deoglPixelBuffer * const pixelBuffer = pPixelBufferTexture;
+			pPixelBufferTexture = aheadFrame.pixelBuffer;
+			aheadFrame.pixelBuffer = pixelBuffer;
+			aheadFrame.frame = -1;
+			aheadFrame.ready = false;
+			pHasDecodedFrame = true;
+			break;
+		}
+		
+		// the thread decodes the requested frame first if not decoding it already.
+		// if the thread is idle the frame can not be decoded
+		if( pIdle ){
+			break;
+		}
+		
+		pWaitFinished = true;
+		guard.Unlock();
+		
 		DEBUG_SYNC_MT_WAIT("GetTexturePixelBuffer() finished")
 		pSemaphoreFinished.Wait();
 		DEBUG_SYNC_MT_DONE("GetTexturePixelBuffer() finished")
-		pDecoding = false;
+		
+		guard.Lock();
 	}
 	
 	if( pHasDecodedFrame ){
@@ -161,82 +190,216 @@ deoglPixelBuffer *deoglVideoDecodeThread::GetTexturePixelBuffer(){
 }
 
 void deoglVideoDecodeThread::SetTexturePixelBuffer( deoglPixelBuffer *pixelBuffer ){
+	const deMutexGuard guard( pMutex );
 	pPixelBufferTexture = pixelBuffer;
 }
 
 void deoglVideoDecodeThread::StopDecode(){
-	// clear the next decoding parameters if set.
-	// stops the decoder from decoding a new frame
+	// clear the decoding parameters and discard frames decoded ahead. stops the
+	// decoder from decoding new frames
 	deMutexGuard guard( pMutex );
-	pNextFrame = -1;
-	guard.Unlock();
+	pFrame = -1;
+	pHasDecodedFrame = false;
+	
+	int i;
+	for( i=0; i<AheadFrameCount; i++ ){
+		pAheadFrames[ i ].frame = -1;
+		pAheadFrames[ i ].ready = false;
+	}
 	
 	// wait for the decoding to finish if running
-	if( pDecoding ){
-		DEBUG_SYNC_MT_WAIT("SetTexturePixelBuffer() finished")
+	while( ! pIdle ){
+		pWaitFinished = true;
+		guard.Unlock();
+		
+		DEBUG_SYNC_MT_WAIT("StopDecode() finished")
 		pSemaphoreFinished.Wait();
-		DEBUG_SYNC_MT_DONE("SetTexturePixelBuffer() finished")
-		pDecoding = false;
+		DEBUG_SYNC_MT_DONE("StopDecode() finished")
+		
+		guard.Lock();
 	}
-	
-	// clear the decoding parameters
-	pFrame = -1;
 }
 
 
 
 void deoglVideoDecodeThread::Run(){
-	bool keepDecoding;
 // 	decTimer timer;
 	
-	while( ! pShutDown ){
+	while( true ){
 		DEBUG_SYNC_MT_WAIT("Run() decode")
 		pSemaphoreDecode.Wait();
 		DEBUG_SYNC_MT_DONE("Run() decode")
 		
-		if( pShutDown ){
-			break;
-		}
+		deMutexGuard guard( pMutex );
 		
-		keepDecoding = true;
-		while( keepDecoding && ! pShutDown ){
-			keepDecoding = false;
+		while( ! pShutDown ){
+			int slot = -1;
+			const int frame = pNextDecodeFrame( slot );
+			if( frame == -1 ){
+				break;
+			}
+			
+			sAheadFrame &aheadFrame = pAheadFrames[ slot ];
+			aheadFrame.frame = frame;
+			aheadFrame.ready = false;
+			guard.Unlock();
 			
 // 			timer.Reset();
 			
+			// the slot is not touched by other threads while decoding
 			try{
-				PreparePixelBuffers();
-				DecodeFrame();
+				pPreparePixelBuffer( aheadFrame.pixelBuffer );
+				pDecodeFrame( frame, *aheadFrame.pixelBuffer );
 				
 			}catch( const deException & ){
-				SetErrorPixelBuffer();
+				if( aheadFrame.pixelBuffer ){
+					pSetErrorPixelBuffer( *aheadFrame.pixelBuffer );
+				}
 			}
 			
-// 			printf( "DecodeThread(%p) Run(%p,%p,%i): Decoded in %iys\n", this, pDecoder, pVideo, pFrame, ( int )( timer.GetElapsedTime() * 1e6f ) );
+// 			printf( "DecodeThread(%p) Run(%i): Decoded in %iys\n", this, frame, ( int )( timer.GetElapsedTime() * 1e6f ) );
 			
-			deMutexGuard guard( pMutex );
+			guard.Lock();
 			
-			if( pNextFrame != -1 ){
-				pFrame = pNextFrame;
-				pNextFrame = -1;
-				
-				keepDecoding = true;
-// 				printf( "DecodeThread(%p) Run(%p,%p,%i): Decode next frame.\n", this, pDecoder, pVideo, pFrame );
+			// StartDecode or StopDecode can discard the frame while decoding
+			if( aheadFrame.frame == frame && aheadFrame.pixelBuffer
+			&& pFrame != -1 && frame >= pFrame && frame < pFrame + AheadFrameCount ){
+				aheadFrame.ready = true;
 				
 			}else{
-				pHasDecodedFrame = true;
-// 				printf( "DecodeThread(%p) Run(%p,%p,%i): Finished decoding frame.\n", this, pDecoder, pVideo, pFrame );
+				aheadFrame.frame = -1;
+			}
+			
+			if( pWaitFinished ){
+				pWaitFinished = false;
+				DEBUG_SYNC_MT_SIGNAL("Run() finished")
+				pSemaphoreFinished.Signal();
 			}
 		}
 		
-		DEBUG_SYNC_MT_SIGNAL("Run() finished")
-		pSemaphoreFinished.Signal();
+		pIdle = true;
+		
+		if( pWaitFinished ){
+			pWaitFinished = false;
+			DEBUG_SYNC_MT_SIGNAL("Run() finished")
+			pSemaphoreFinished.Signal();
+		}
+		
+		if( pShutDown ){
+			break;
+		}
+	}
+}
+
+
+
+// Private Functions
+//////////////////////
+
+void deoglVideoDecodeThread::pSafelyShutDownThread(){
+	if( ! IsRunning() ){
+		return;
+	}
+	
+	deMutexGuard guard( pMutex );
+	pFrame = -1;
+	pShutDown = true;
+	const bool idle = pIdle;
+	pIdle = false;
+	guard.Unlock();
+	
+	if( idle ){
+		DEBUG_SYNC_MT_SIGNAL("pSafelyShutDownThread() decode")
+		pSemaphoreDecode.Signal();
+	}
+	WaitForExit();
+}
+
+void deoglVideoDecodeThread::pInitConversion(){
+	// videos decoding to RGB use the identity matrix. in this case frames are copied.
+	// otherwise the matrix is converted to fixed point with 16 fractional bits. the
+	// matrix transforms from [0..1] to [0..1] while the coefficients transform from
+	// [0..255] to [0..255] instead. the offsets include rounding to the nearest value
+	const decColorMatrix3 &matrix = pVideo->GetColorConversionMatrix();
+	const float coefficients[ 12 ] = {
+		matrix.a11, matrix.a12, matrix.a13, matrix.a14,
+		matrix.a21, matrix.a22, matrix.a23, matrix.a24,
+		matrix.a31, matrix.a32, matrix.a33, matrix.a34 };
+	const float identity[ 12 ] = {
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f };
+	int i;
+	
+	pIdentityConversion = true;
+	
+	for( i=0; i<12; i++ ){
+		if( coefficients[ i ] != identity[ i ] ){
+			pIdentityConversion = false;
+		}
+		
+		if( i % 4 == 3 ){
+			pConversion[ i ] = ( int )floorf( coefficients[ i ] * 255.0f * 65536.0f + 0.5f ) + 32768;
+			
+		}else{
+			pConversion[ i ] = ( int )floorf( coefficients[ i ] * 65536.0f + 0.5f );
+		}
 	}
 }
 
+int deoglVideoDecodeThread::pFindAheadFrame( int frame ) const{
+	int i;
+	for( i=0; i<AheadFrameCount; i++ ){
+		if( pAheadFrames[ i ].frame == frame ){
+			return i;
+		}
+	}
+	return -1;
+}
 
+int deoglVideoDecodeThread::pNextDecodeFrame( int &slot ){
+	if( pFrame == -1 ){
+		return -1;
+	}
+	
+	// first frame starting with the requested one which is neither decoded nor decoding.
+	// the requested frame has been taken already if it has been decoded
+	const int frameCount = pVideo->GetFrameCount();
+	int frame = pHasDecodedFrame ? pFrame + 1 : pFrame;
+	const int lastFrame = decMath::min( pFrame + AheadFrameCount - 1, frameCount - 1 );
+	
+	while( frame <= lastFrame && pFindAheadFrame( frame ) != -1 ){
+		frame++;
+	}
+	if( frame > lastFrame ){
+		return -1;
+	}
+	
+	// use a free slot. the requested frame takes the slot of the farthest frame
+	// decoded ahead if no slot is free
+	int i;
+	slot = -1;
+	
+	for( i=0; i<AheadFrameCount; i++ ){
+		if( pAheadFrames[ i ].frame == -1 ){
+			slot = i;
+			break;
+		}
+	}
+	
+	if( slot == -1 && frame == pFrame ){
+		for( i=0; i<AheadFrameCount; i++ ){
+			if( pAheadFrames[ i ].ready && ( slot == -1
+			|| pAheadFrames[ i ].frame > pAheadFrames[ slot ].frame ) ){
+				slot = i;
+			}
+		}
+	}
+	
+	return slot != -1 ? frame : -1;
+}
 
-void deoglVideoDecodeThread::PreparePixelBuffers(){
+void deoglVideoDecodeThread::pPreparePixelBuffer( deoglPixelBuffer *&pixelBuffer ){
 	deoglPixelBuffer::ePixelFormats pbFormat = deoglPixelBuffer::epfByte3;
 	const deVideo::ePixelFormat pixelFormat = pVideo->GetPixelFormat();
 	const int height = pVideo->GetHeight();
@@ -248,71 +411,70 @@ void deoglVideoDecodeThread::PreparePixelBuffers(){
 	}
 	
 	// if the pixel buffers do not match the required size free them
-	if( pPixelBufferTexture ){
-		if( pPixelBufferTexture->GetWidth() != width || pPixelBufferTexture->GetHeight() != height ){
-			delete pPixelBufferTexture;
-			pPixelBufferTexture = NULL;
-		}
+	if( pixelBuffer && ( pixelBuffer->GetFormat() != pbFormat
+	|| pixelBuffer->GetWidth() != width || pixelBuffer->GetHeight() != height ) ){
+		delete pixelBuffer;
+		pixelBuffer = NULL;
 	}
 	
-	if( pPixelBufferDecode ){
-		if( pPixelBufferDecode->GetWidth() != width || pPixelBufferDecode->GetHeight() != height ){
-			delete pPixelBufferDecode;
-			pPixelBufferDecode = NULL;
-		}
+	if( pPixelBufferDecode && ( pPixelBufferDecode->GetFormat() != pbFormat
+	|| pPixelBufferDecode->GetWidth() != width || pPixelBufferDecode->GetHeight() != height ) ){
+		delete pPixelBufferDecode;
+		pPixelBufferDecode = NULL;
 	}
 	
 	// create pixel buffers if not existing
+	if( ! pixelBuffer ){
+		pixelBuffer = new deoglPixelBuffer( pbFormat, width, height, 1 );
+	}
+	
 	if( ! pPixelBufferDecode ){
 		pPixelBufferDecode = new deoglPixelBuffer( pbFormat, width, height, 1 );
 	}
+}
+
+void deoglVideoDecodeThread::pDecodeFrame( int frame, deoglPixelBuffer &pixelBuffer ){
+	pDecoder->SetPosition( frame ); // decoding ahead continuously this usually does not seek
 	
-	if( ! pPixelBufferTexture ){
-		pPixelBufferTexture = new deoglPixelBuffer( pbFormat, width, height, 1 );
+	if( pDecoder->DecodeFrame( pPixelBufferDecode->GetPointer(),
+	pPixelBufferDecode->GetImageSize(), NULL, 0 ) ){
+		pConvertColors( pixelBuffer );
+		
+	}else{
+		pSetErrorPixelBuffer( pixelBuffer );
 	}
 }
 
-void deoglVideoDecodeThread::DecodeFrame(){
-	if( pFrame == -1 ){
-		return; // sanity check
-	}
-	
+void deoglVideoDecodeThread::pConvertColors( deoglPixelBuffer &pixelBuffer ){
 	const int height = pVideo->GetHeight();
 	const int width = pVideo->GetWidth();
-	
-	pDecoder->SetPosition( pFrame ); // in most cases this should not seek
-	
-	if( ! pDecoder->DecodeFrame( pPixelBufferDecode->GetPointer(),
-	pPixelBufferDecode->GetImageSize(), NULL, 0 ) ){
-		SetErrorPixelBuffer();
-		return;
-	}
-	
-	const decColorMatrix3 &colorMatrix = pVideo->GetColorConversionMatrix();
-	const float factor = 1.0f / 255.0f;
-	decColor color;
+	const int * const c = pConversion;
 	int x, y;
 	
-	switch( pPixelBufferTexture->GetFormat() ){
+	// frames are decoded top-down. textures are stored bottom-up
+	switch( pixelBuffer.GetFormat() ){
 	case deoglPixelBuffer::epfByte3:
 		{
 		const deoglPixelBuffer::sByte3 * const pixelsDecode = pPixelBufferDecode->GetPointerByte3();
-		deoglPixelBuffer::sByte3 * const pixelsTexture = pPixelBufferTexture->GetPointerByte3();
+		deoglPixelBuffer::sByte3 * const pixelsTexture = pixelBuffer.GetPointerByte3();
 		
 		for( y=0; y<height; y++ ){
 			deoglPixelBuffer::sByte3 * const pixelLineTexture = pixelsTexture + width * ( height - y - 1 );
 			const deoglPixelBuffer::sByte3 * const pixelLineDecode = pixelsDecode + width * y;
 			
+			if( pIdentityConversion ){
+				memcpy( pixelLineTexture, pixelLineDecode, sizeof( deoglPixelBuffer::sByte3 ) * width );
+				continue;
+			}
+			
 			for( x=0; x<width; x++ ){
-				color.r = ( float )pixelLineDecode[ x ].r * factor;
-				color.g = ( float )pixelLineDecode[ x ].g * factor;
-				color.b = ( float )pixelLineDecode[ x ].b * factor;
+				const int r = pixelLineDecode[ x ].r;
+				const int g = pixelLineDecode[ x ].g;
+				const int b = pixelLineDecode[ x ].b;
 				
-				color = colorMatrix * color;
-				
-				pixelLineTexture[ x ].r = decMath::clamp( ( int )( color.r * 255.0f ), 0, 255 );
-				pixelLineTexture[ x ].g = decMath::clamp( ( int )( color.g * 255.0f ), 0, 255 );
-				pixelLineTexture[ x ].b = decMath::clamp( ( int )( color.b * 255.0f ), 0, 255 );
+				pixelLineTexture[ x ].r = ( GLubyte )decMath::clamp( ( c[ 0 ] * r + c[ 1 ] * g + c[ 2 ] * b + c[ 3 ] ) >> 16, 0, 255 );
+				pixelLineTexture[ x ].g = ( GLubyte )decMath::clamp( ( c[ 4 ] * r + c[ 5 ] * g + c[ 6 ] * b + c[ 7 ] ) >> 16, 0, 255 );
+				pixelLineTexture[ x ].b = ( GLubyte )decMath::clamp( ( c[ 8 ] * r + c[ 9 ] * g + c[ 10 ] * b + c[ 11 ] ) >> 16, 0, 255 );
 			}
 		}
 		} break;
@@ -320,24 +482,26 @@ void deoglVideoDecodeThread::DecodeFrame(){
 	case deoglPixelBuffer::epfByte4:
 		{
 		const deoglPixelBuffer::sByte4 * const pixelsDecode = pPixelBufferDecode->GetPointerByte4();
-		deoglPixelBuffer::sByte4 * const pixelsTexture = pPixelBufferTexture->GetPointerByte4();
+		deoglPixelBuffer::sByte4 * const pixelsTexture = pixelBuffer.GetPointerByte4();
 		
 		for( y=0; y<height; y++ ){
 			deoglPixelBuffer::sByte4 * const pixelLineTexture = pixelsTexture + width * ( height - y - 1 );
 			const deoglPixelBuffer::sByte4 * const pixelLineDecode = pixelsDecode + width * y;
 			
+			if( pIdentityConversion ){
+				memcpy( pixelLineTexture, pixelLineDecode, sizeof( deoglPixelBuffer::sByte4 ) * width );
+				continue;
+			}
+			
 			for( x=0; x<width; x++ ){
-				color.r = ( float )pixelLineDecode[ x ].r * factor;
-				color.g = ( float )pixelLineDecode[ x ].g * factor;
-				color.b = ( float )pixelLineDecode[ x ].b * factor;
-				color.a = ( float )pixelLineDecode[ x ].a * factor;
-				
-				color = colorMatrix * color;
+				const int r = pixelLineDecode[ x ].r;
+				const int g = pixelLineDecode[ x ].g;
+				const int b = pixelLineDecode[ x ].b;
 				
-				pixelLineTexture[ x ].r = decMath::clamp( ( int )( color.r * 255.0f ), 0, 255 );
-				pixelLineTexture[ x ].g = decMath::clamp( ( int )( color.g * 255.0f ), 0, 255 );
-				pixelLineTexture[ x ].b = decMath::clamp( ( int )( color.b * 255.0f ), 0, 255 );
-				pixelLineTexture[ x ].a = decMath::clamp( ( int )( color.a * 255.0f ), 0, 255 );
+				pixelLineTexture[ x ].r = ( GLubyte )decMath::clamp( ( c[ 0 ] * r + c[ 1 ] * g + c[ 2 ] * b + c[ 3 ] ) >> 16, 0, 255 );
+				pixelLineTexture[ x ].g = ( GLubyte )decMath::clamp( ( c[ 4 ] * r + c[ 5 ] * g + c[ 6 ] * b + c[ 7 ] ) >> 16, 0, 255 );
+				pixelLineTexture[ x ].b = ( GLubyte )decMath::clamp( ( c[ 8 ] * r + c[ 9 ] * g + c[ 10 ] * b + c[ 11 ] ) >> 16, 0, 255 );
+				pixelLineTexture[ x ].a = pixelLineDecode[ x ].a;
 			}
 		}
 		} break;
@@ -347,16 +511,16 @@ void deoglVideoDecodeThread::DecodeFrame(){
 	}
 }
 
-void deoglVideoDecodeThread::SetErrorPixelBuffer(){
+void deoglVideoDecodeThread::pSetErrorPixelBuffer( deoglPixelBuffer &pixelBuffer ){
 	const int height = pVideo->GetHeight();
 	const int width = pVideo->GetWidth();
 	const int count = width * height;
 	int i;
 	
-	switch( pPixelBufferTexture->GetFormat() ){
+	switch( pixelBuffer.GetFormat() ){
 	case deoglPixelBuffer::epfByte3:
 		{
-		deoglPixelBuffer::sByte3 * const pixels = pPixelBufferTexture->GetPointerByte3();
+		deoglPixelBuffer::sByte3 * const pixels = pixelBuffer.GetPointerByte3();
 		for( i=0; i<count; i++ ){
 			pixels[ i ].r = 255;
 			pixels[ i ].g = 0;
@@ -366,7 +530,7 @@ void deoglVideoDecodeThread::SetErrorPixelBuffer(){
 		
 	case deoglPixelBuffer::epfByte4:
 		{
-		deoglPixelBuffer::sByte4 * const pixels = pPixelBufferTexture->GetPointerByte4();
+		deoglPixelBuffer::sByte4 * const pixels = pixelBuffer.GetPointerByte4();
 		for( i=0; i<count; i++ ){
 			pixels[ i ].r = 255;
 			pixels[ i ].g = 0;
@@ -379,23 +543,3 @@ void deoglVideoDecodeThread::SetErrorPixelBuffer(){
 		break;
 	}
 }
-
-
-
-// Private Functions
-//////////////////////
-
-void deoglVideoDecodeThread::pSafelyShutDownThread(){
-	if( ! IsRunning() ){
-		return;
-	}
-	
-	deMutexGuard guard( pMutex );
-	pNextFrame = -1;
-	pShutDown = true;
-	guard.Unlock();
-	
-	DEBUG_SYNC_MT_SIGNAL("pSafelyShutDownThread() decode")
-	pSemaphoreDecode.Signal();
-	WaitForExit();
-}
@@ -32,22 +32,48 @@ class deoglPixelBuffer;
 
 /**
  * \brief Video Decode Thread.
+ * 
+ * Decodes the requested frame and the frames following it ahead of time into a small ring
+ * of pixel buffers. While a video is playing the next frame is usually decoded already
+ * once it is requested so retrieving it does not have to wait for the decoder.
  */
 class deoglVideoDecodeThread : public deThread{
 public:
+	/** \brief Number of frames decoded ahead including the requested frame. */
+	static const int AheadFrameCount = 4;
+	
+	
+	
+private:
+	/** \brief Decoded frame. */
+	struct sAheadFrame{
+		/** \brief Frame number or -1 if not used. */
+		int frame;
+		
+		/** \brief Pixel buffer or NULL if not created yet. */
+		deoglPixelBuffer *pixelBuffer;
+		
+		/** \brief Frame is decoded and pixel buffer can be used. */
+		bool ready;
+	};
+	
 	const deVideoDecoderReference pDecoder;
 	const deVideoReference pVideo;
 	int pFrame;
-	int pNextFrame;
+	sAheadFrame pAheadFrames[ AheadFrameCount ];
 	
 	deoglPixelBuffer *pPixelBufferDecode;
 	deoglPixelBuffer *pPixelBufferTexture;
 	
+	bool pIdentityConversion;
+	int pConversion[ 12 ];
+	
 	deMutex pMutex;
 	deSemaphore pSemaphoreDecode;
 	deSemaphore pSemaphoreFinished;
-	bool pDecoding;
 	bool pHasDecodedFrame;
+	bool pWaitFinished;
+	bool pIdle;
 	bool pShutDown;
 	
 	
@@ -69,19 +95,18 @@ public:
 	/**
 	 * \brief Start decoding a frame.
 	 * 
-	 * If a decoding is in progress the new decoding parameters are
-	 * stored aside. Once the current decoding is finished the decoding continues with the
-	 * stored aside parameters. This is done since stopping the thread could cut the decoder
-	 * in a very bad situation causing various problems. This way decoding never can end
-	 * up in an unhealthy state while guaranteeing the last set frame is always decoded and
-	 * ready to be retrieved. Intermediate results are discarded.
+	 * If the frame has been decoded ahead already nothing has to be done. Otherwise the
+	 * frame is decoded next. Frames decoded ahead which are not following the frame are
+	 * discarded. Decoding never stops in the middle of a frame since this could cut the
+	 * decoder in a very bad situation causing various problems.
 	 */
 	void StartDecode( int frame );
 	
 	/**
 	 * \brief Pixel buffer to upload to the texture.
 	 * 
-	 * Waits for the decoding to finish. If no decoding is in progress \em NULL is returned.
+	 * Waits for the decoding of the frame to finish if it has not been decoded ahead.
+	 * If no frame is decoding \em NULL is returned.
 	 */
 	deoglPixelBuffer *GetTexturePixelBuffer();
 	
@@ -103,21 +128,19 @@ public:
 	
 	/** \brief Run function of the thread */
 	virtual void Run();
-	
-	/** \brief Ensure pixel buffers are ready for decoding. */
-	void PreparePixelBuffers();
-	
-	/** \brief Decode frame. */
-	void DecodeFrame();
-	
-	/** \brief Set pixel buffer to the error result. */
-	void SetErrorPixelBuffer();
 	/*@}*/
 	
 	
 	
 private:
 	void pSafelyShutDownThread();
+	void pInitConversion();
+	int pFindAheadFrame( int frame ) const;
+	int pNextDecodeFrame( int &slot );
+	void pPreparePixelBuffer( deoglPixelBuffer *&pixelBuffer );
+	void pDecodeFrame( int frame, deoglPixelBuffer &pixelBuffer );
+	void pConvertColors( deoglPixelBuffer &pixelBuffer );
+	void pSetErrorPixelBuffer( deoglPixelBuffer &pixelBuffer );
 };
 
 #endif
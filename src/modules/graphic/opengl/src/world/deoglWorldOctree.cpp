@@ -47,7 +47,8 @@
 /////////////////////////////////
 
 deoglWorldOctree::deoglWorldOctree( const decDVector &center, const decDVector &halfSize ) :
-deoglDOctree( center, halfSize ){
+deoglDOctree( center, halfSize ),
+pComponentCullBoxes( center ){
 }
 
 deoglWorldOctree::~deoglWorldOctree(){
@@ -220,6 +221,10 @@ void deoglWorldOctree::InsertComponentIntoTree( deoglRComponent *component, int
 			// remove from the current node
 			currentNode->RemoveComponent( component );
 			currentNode = NULL;
+			
+		}else{
+			// same node but extends potentially changed
+			currentNode->UpdateComponentCullBox( component );
 		}
 	}
 	
@@ -363,6 +368,8 @@ void deoglWorldOctree::AddComponent( deoglRComponent *component ){
 	}
 	
 	pComponents.Add( component );
+	pComponentCullBoxes.Add( component->GetMinimumExtend(), component->GetMaximumExtend(),
+		component->GetLayerMask(), component->GetLODErrorScaling() );
 	
 	component->SetOctreeNode( this );
 }
@@ -374,6 +381,7 @@ void deoglWorldOctree::RemoveComponent( deoglRComponent *component ){
 	}
 	
 	pComponents.RemoveFrom( index );
+	pComponentCullBoxes.RemoveFrom( index );
 	
 	component->SetOctreeNode( NULL );
 }
@@ -387,6 +395,17 @@ void deoglWorldOctree::RemoveAllComponents(){
 	}
 	
 	pComponents.RemoveAll();
+	pComponentCullBoxes.RemoveAll();
+}
+
+void deoglWorldOctree::UpdateComponentCullBox( deoglRComponent *component ){
+	const int index = pComponents.IndexOf( component );
+	if( index == -1 ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	pComponentCullBoxes.SetAt( index, component->GetMinimumExtend(), component->GetMaximumExtend(),
+		component->GetLayerMask(), component->GetLODErrorScaling() );
 }
 
 
@@ -25,6 +25,7 @@
 #include "../billboard/deoglBillboardList.h"
 #include "../envmap/deoglEnvironmentMapList.h"
 #include "../particle/deoglParticleEmitterInstanceList.h"
+#include "../utils/collision/deoglCullBoxList.h"
 #include "../utils/octree/deoglDOctree.h"
 
 #include <dragengine/common/collection/decPointerList.h>
@@ -47,6 +48,7 @@ private:
 	deoglParticleEmitterInstanceList pParticleEmitters;
 	
 	decPointerList pComponents;
+	deoglCullBoxList pComponentCullBoxes;
 	decPointerList pLights;
 	decPointerList pLumimeters;
 	
@@ -138,6 +140,16 @@ public:
 	
 	/** \brief Remove all components. */
 	void RemoveAllComponents();
+	
+	/**
+	 * \brief Cull boxes of components.
+	 * 
+	 * Boxes are stored in the same order as the components and are relative to the node center.
+	 */
+	inline const deoglCullBoxList &GetComponentCullBoxes() const{ return pComponentCullBoxes; }
+	
+	/** \brief Update cull box of component after extends, layer mask or LOD error scaling changed. */
+	void UpdateComponentCullBox( deoglRComponent *component );
 	/*@}*/
 	
 	
@@ -106,10 +106,19 @@ debpBulletShapeCollision::~debpBulletShapeCollision(){
 void debpBulletShapeCollision::ShapeCast( const btConvexShape *castShape, const btTransform &castFromTrans,
 const btTransform &castToTrans, const btCollisionObjectWrapper *colObjWrap,
 btCollisionWorld::ConvexResultCallback &resultCallback, btScalar allowedPenetration ){
+	ShapeCast( castShape, castFromTrans, castToTrans, colObjWrap, resultCallback,
+		allowedPenetration, pRayTestStacks );
+}
+
+void debpBulletShapeCollision::ShapeCast( const btConvexShape *castShape, const btTransform &castFromTrans,
+const btTransform &castToTrans, const btCollisionObjectWrapper *colObjWrap,
+btCollisionWorld::ConvexResultCallback &resultCallback, btScalar allowedPenetration,
+btAlignedObjectArray<const btDbvtNode*> &stack ){
 	const btCollisionShape * const collisionShape = colObjWrap->getCollisionShape();
 	
 	if( collisionShape->isCompound() ){
-		ShapeCastCompound( castShape, castFromTrans, castToTrans, colObjWrap, resultCallback, allowedPenetration );
+		ShapeCastCompound( castShape, castFromTrans, castToTrans, colObjWrap,
+			resultCallback, allowedPenetration, stack );
 		
 	}else if( collisionShape->isConvex() ){
 		//decTimer timer;
@@ -143,11 +152,12 @@ struct BroadphaseSweepTester : public btDbvt::ICollide{
 	const btConvexShape *m_castShape;
 	const btCollisionObjectWrapper *m_colObjWrap;
 	const btCompoundShape &m_compoundShape;
+	btAlignedObjectArray<const btDbvtNode*> &m_stack;
 	
 	BroadphaseSweepTester( const btConvexShape *castShape, const btCollisionObjectWrapper *colObjWrap,
 	const btCompoundShape &compoundShape, const btTransform &convexFromTrans, const btTransform &convexToTrans,
 	debpBulletShapeCollision &bulletShapeCollision, btCollisionWorld::ConvexResultCallback &resultCallback,
-	btScalar allowedPenetration ) :
+	btScalar allowedPenetration, btAlignedObjectArray<const btDbvtNode*> &stack ) :
 	m_convexFromTrans( convexFromTrans ),
 	m_convexToTrans( convexToTrans ),
 	m_bulletShapeCollision( bulletShapeCollision ),
@@ -155,7 +165,8 @@ struct BroadphaseSweepTester : public btDbvt::ICollide{
 	m_allowedCcdPenetration( allowedPenetration ),
 	m_castShape( castShape ),
 	m_colObjWrap( colObjWrap ),
-	m_compoundShape( compoundShape ){
+	m_compoundShape( compoundShape ),
+	m_stack( stack ){
 	}
 	
 	virtual void Process( const btDbvtNode *leaf ){
@@ -173,13 +184,21 @@ struct BroadphaseSweepTester : public btDbvt::ICollide{
 		
 		LocalInfoAdder cbAdder( childIndex, &m_resultCallback );
 		m_bulletShapeCollision.ShapeCast( m_castShape, m_convexFromTrans,
-			m_convexToTrans, &childWrap, cbAdder, m_allowedCcdPenetration );
+			m_convexToTrans, &childWrap, cbAdder, m_allowedCcdPenetration, m_stack );
 	}
 };
 
 void debpBulletShapeCollision::ShapeCastCompound( const btConvexShape *castShape,
 const btTransform &castFromTrans, const btTransform &castToTrans, const btCollisionObjectWrapper *colObjWrap,
 btCollisionWorld::ConvexResultCallback &resultCallback, btScalar allowedPenetration ){
+	ShapeCastCompound( castShape, castFromTrans, castToTrans, colObjWrap, resultCallback,
+		allowedPenetration, pRayTestStacks );
+}
+
+void debpBulletShapeCollision::ShapeCastCompound( const btConvexShape *castShape,
+const btTransform &castFromTrans, const btTransform &castToTrans, const btCollisionObjectWrapper *colObjWrap,
+btCollisionWorld::ConvexResultCallback &resultCallback, btScalar allowedPenetration,
+btAlignedObjectArray<const btDbvtNode*> &stack ){
 	// check each child with a castShape call
 	const btCompoundShape &compoundShape = *( ( btCompoundShape* )( colObjWrap->getCollisionShape() ) );
 	const int count = compoundShape.getNumChildShapes();
@@ -218,10 +237,10 @@ btCollisionWorld::ConvexResultCallback &resultCallback, btScalar allowedPenetrat
 		const btScalar lambdaMax = rayDir.dot( unnormalizedRayDir );
 		
 		BroadphaseSweepTester convexCaster( castShape, colObjWrap, compoundShape, castFromTrans,
-			castToTrans, *this, resultCallback, allowedPenetration );
+			castToTrans, *this, resultCallback, allowedPenetration, stack );
 		
 		tree->rayTestInternal( tree->m_root, localCastFromTrans.getOrigin(), localCastToTrans.getOrigin(),
-			rayDirectionInverse, signs, lambdaMax, castShapeAabbMin, castShapeAabbMax, pRayTestStacks, convexCaster );
+			rayDirectionInverse, signs, lambdaMax, castShapeAabbMin, castShapeAabbMax, stack, convexCaster );
 		
 	// otherwise iterate over all children and test them
 	}else{
@@ -233,7 +252,7 @@ btCollisionWorld::ConvexResultCallback &resultCallback, btScalar allowedPenetrat
 			const btCollisionObjectWrapper childWrap( colObjWrap, compoundShape.getChildShape( i ),
 				colObjWrap->getCollisionObject(), childTransform, -1, i );
 			LocalInfoAdder cbAdder( i, &resultCallback );
-			ShapeCast( castShape, castFromTrans, castToTrans, &childWrap, cbAdder, allowedPenetration );
+			ShapeCast( castShape, castFromTrans, castToTrans, &childWrap, cbAdder, allowedPenetration, stack );
 		}
 	}
 }
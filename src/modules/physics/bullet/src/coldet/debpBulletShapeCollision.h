@@ -78,6 +78,17 @@ public:
 	const btTransform &castToTrans, const btCollisionObjectWrapper *colObjWrap,
 	btCollisionWorld::ConvexResultCallback &resultCallback, btScalar allowedPenetration );
 	
+	/**
+	 * \brief Tests for collision between two shapes using an external tree traversal stack.
+	 * 
+	 * Thread-safe version of ShapeCast. The stack is used instead of the shared one to
+	 * traverse compound shape trees. Each thread has to use an own stack.
+	 */
+	void ShapeCast( const btConvexShape *castShape, const btTransform &castFromTrans,
+	const btTransform &castToTrans, const btCollisionObjectWrapper *colObjWrap,
+	btCollisionWorld::ConvexResultCallback &resultCallback, btScalar allowedPenetration,
+	btAlignedObjectArray<const btDbvtNode*> &stack );
+	
 	/**
 	 * \brief Test for collision between two a convex shape and a compound shape.
 	 * 
@@ -87,6 +98,15 @@ public:
 	const btTransform &castToTrans, const btCollisionObjectWrapper *colObjWrap,
 	btCollisionWorld::ConvexResultCallback &resultCallback, btScalar allowedPenetration );
 	
+	/**
+	 * \brief Test for collision between a convex shape and a compound shape using an
+	 *        external tree traversal stack.
+	 */
+	void ShapeCastCompound( const btConvexShape *castShape, const btTransform &castFromTrans,
+	const btTransform &castToTrans, const btCollisionObjectWrapper *colObjWrap,
+	btCollisionWorld::ConvexResultCallback &resultCallback, btScalar allowedPenetration,
+	btAlignedObjectArray<const btDbvtNode*> &stack );
+	
 	/**
 	 * \brief Test for collision between two convex shapes.
 	 * 
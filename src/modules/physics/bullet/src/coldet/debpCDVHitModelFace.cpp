@@ -58,6 +58,7 @@ debpCDVHitModelFace::debpCDVHitModelFace( debpCollisionDetection *coldet ){
 	pShape = NULL;
 	
 	pComponent = NULL;
+	pUseSkinnedVertices = false;
 	
 	pHasCollision = false;
 }
@@ -103,6 +104,12 @@ void debpCDVHitModelFace::SetTestCollider( debpCollider *collider ){
 
 
 
+void debpCDVHitModelFace::SetUseSkinnedVertices( bool useSkinnedVertices ){
+	pUseSkinnedVertices = useSkinnedVertices;
+}
+
+
+
 // Visiting
 /////////////
 
@@ -115,7 +122,7 @@ void debpCDVHitModelFace::VisitNode( debpDOctree *node, int intersection ){
 			for( f=0; f<faceCount; f++ ){
 				faceIndex = rnode.GetFaceAt( f );
 				
-				if( pColDet->ShapeHitsModelFace( *pShape, *pComponent, faceIndex ) ){
+				if( pShapeHitsFace( *pShape, faceIndex ) ){
 					pResult.shape1 = 0;
 					pResult.face = faceIndex;
 					pHasCollision = true;
@@ -133,7 +140,7 @@ void debpCDVHitModelFace::VisitNode( debpDOctree *node, int intersection ){
 				for( f=0; f<faceCount; f++ ){
 					faceIndex = rnode.GetFaceAt( f );
 					
-					if( pColDet->ShapeHitsModelFace( shape, *pComponent, faceIndex ) ){
+					if( pShapeHitsFace( shape, faceIndex ) ){
 						pResult.shape1 = s;
 						pResult.face = faceIndex;
 						pHasCollision = true;
@@ -144,3 +151,42 @@ void debpCDVHitModelFace::VisitNode( debpDOctree *node, int intersection ){
 		}
 	}
 }
+
+bool debpCDVHitModelFace::VisitFace( int face ){
+	if( pShape ){
+		if( pShapeHitsFace( *pShape, face ) ){
+			pResult.shape1 = 0;
+			pResult.face = face;
+			pHasCollision = true;
+		}
+		
+	}else if( pColliderVolume ){
+		const debpShapeList &shapes = pColliderVolume->GetShapes();
+		int s, shapeCount = shapes.GetShapeCount();
+		
+		for( s=0; s<shapeCount; s++ ){
+			if( pShapeHitsFace( *shapes.GetShapeAt( s ), face ) ){
+				pResult.shape1 = s;
+				pResult.face = face;
+				pHasCollision = true;
+				break;
+			}
+		}
+	}
+	
+	return ! pHasCollision;
+}
+
+
+
+// Private Functions
+//////////////////////
+
+bool debpCDVHitModelFace::pShapeHitsFace( debpShape &shape, int face ){
+	if( pUseSkinnedVertices ){
+		return pColDet->ShapeHitsSkinnedModelFace( shape, *pComponent, face );
+		
+	}else{
+		return pColDet->ShapeHitsModelFace( shape, *pComponent, face );
+	}
+}
@@ -27,6 +27,7 @@
 #include <dragengine/common/math/decMath.h>
 #include "debpCollisionDetection.h"
 #include "octree/debpDOctreeVisitor.h"
+#include "../component/debpModelBVHVisitor.h"
 
 // predefinitions
 class debpShape;
@@ -40,9 +41,10 @@ class debpColliderComponent;
 /**
  * @brief Hit Model Face Visitor.
  * Visitor for the collision detection class to test for collision of
- * one or more shapes with faces of a model.
+ * one or more shapes with faces of a model. Visits model octree nodes
+ * as well as model BVH faces.
  */
-class debpCDVHitModelFace : public debpDOctreeVisitor{
+class debpCDVHitModelFace : public debpDOctreeVisitor, public debpModelBVHVisitor{
 private:
 	debpCollisionDetection *pColDet;
 	
@@ -51,6 +53,7 @@ private:
 	debpShape *pShape;
 	
 	debpComponent *pComponent;
+	bool pUseSkinnedVertices;
 	
 	debpCollisionResult pResult;
 	bool pHasCollision;
@@ -74,6 +77,8 @@ public:
 	void SetTestShape( debpShape *shape );
 	/** Sets the collider to test with. */
 	void SetTestCollider( debpCollider *collider );
+	/** Sets if the skinned component vertices are used instead of the model vertices. */
+	void SetUseSkinnedVertices( bool useSkinnedVertices );
 	
 	/** Retrieves the result. */
 	inline debpCollisionResult &GetResult(){ return pResult; }
@@ -85,7 +90,12 @@ public:
 	/*@{*/
 	/** Visit a node. */
 	virtual void VisitNode( debpDOctree *node, int intersection );
+	/** Visit a BVH face. */
+	virtual bool VisitFace( int face );
 	/*@}*/
+	
+private:
+	bool pShapeHitsFace( debpShape &shape, int face );
 };
 
 // end of include only once
@@ -43,6 +43,7 @@
 #include "../collider/debpColliderRig.h"
 #include "../component/debpModel.h"
 #include "../component/debpComponent.h"
+#include "../component/debpModelBVH.h"
 #include "../component/debpModelOctree.h"
 #include "../terrain/heightmap/debpHeightTerrain.h"
 #include "../terrain/heightmap/debpHTSector.h"
@@ -1104,6 +1105,32 @@ bool debpCollisionDetection::ShapeHitsModelFace( debpShape &shape, debpComponent
 
 
 
+bool debpCollisionDetection::ShapeHitsSkinnedModelFace( debpShape &shape,
+const debpComponent &component, int face ){
+	if( ! component.GetComponent()->GetModel() ){
+		return false;
+	}
+	
+	const deModelFace &engFace = component.GetComponent()->GetModel()->GetLODAt( 0 )->GetFaceAt( face );
+	debpDCollisionTriangle collisionTriangle;
+	
+	const decDVector p1( component.GetVertex( engFace.GetVertex1() ) );
+	const decDVector p2( component.GetVertex( engFace.GetVertex2() ) );
+	const decDVector p3( component.GetVertex( engFace.GetVertex3() ) );
+	
+	decDVector normal( ( p2 - p1 ) % ( p3 - p2 ) );
+	double length = normal.Length();
+	
+	if( length > 1e-5 ){ // only test against non-degenerated triangles
+		normal /= length;
+		collisionTriangle.SetCorners( p1, p2, p3, normal );
+		
+		return shape.GetCollisionVolume()->TriangleHitsVolume( &collisionTriangle );
+	}
+	
+	return false;
+}
+
 bool debpCollisionDetection::ShapeMoveHitsModelFace( debpShape &shape, const decDVector &displacement,
 const debpComponent &component, int face, debpCollisionResult &result ){
 	if( ! component.GetComponent()->GetModel() ){
@@ -1892,17 +1919,17 @@ debpColliderComponent &collider2, debpCollisionResult &result ){
 			collider1.GetParentWorld(), &collider1, collider2.GetColliderComponent()->GetComponent()->GetModel()
 				? collider2.GetColliderComponent()->GetComponent()->GetModel()->GetFilename() : "-" ) );
 		debpCDVHitModelFace visitor( this );
-		debpDCollisionBox box;
 		
 		component.PrepareMesh();
+		component.GetModel()->PrepareBVH();
 		
 		collider1.UpdateShapesWithMatrix( collider1.GetMatrix().QuickMultiply( collider2.GetInverseMatrix() ) );
 		
 		visitor.SetComponent( &component );
 		visitor.SetTestCollider( &collider1 );
 		
-		box.SetFromExtends( collider1.GetShapeMinimumExtend(), collider1.GetShapeMaximumExtend() );
-		component.GetModel()->GetOctree()->VisitNodesColliding( &visitor, &box );
+		component.GetModel()->GetBVH()->VisitFacesOverlapping( collider1.GetShapeMinimumExtend().ToVector(),
+			collider1.GetShapeMaximumExtend().ToVector(), visitor );
 		
 		if( visitor.HasCollision() ){
 			debpCollisionResult &vresult = visitor.GetResult();
@@ -1923,49 +1950,29 @@ debpColliderComponent &collider2, debpCollisionResult &result ){
 		SPECIAL_DEBUG( pBullet.LogInfoFormat( "ColliderVolumeHitsColliderComponent: Dynamic Model: %p %p %s\n",
 			collider1.GetParentWorld(), &collider1, collider2.GetColliderComponent()->GetComponent()->GetModel()
 				? collider2.GetColliderComponent()->GetComponent()->GetModel()->GetFilename() : "-" ) );
-		const decMatrix &matrix = component.GetComponent()->GetMatrix();
-		const deModel &engModel = component.GetModel()->GetModel();
-		const deModelLOD &engModelLOD = *engModel.GetLODAt( 0 );
-		int f, faceCount = engModelLOD.GetFaceCount();
-		debpDCollisionTriangle coltri;
-		debpDCollisionBox colbox;
+		debpCDVHitModelFace visitor( this );
 		
-		component.PrepareMesh();
-		component.PrepareExtends();
+		component.PrepareBVH();
 		
-		colbox.SetFromExtends( component.GetMinimumExtend(), component.GetMaximumExtend() );
-		colbox.MoveBy( component.GetComponent()->GetPosition() );
+		collider1.UpdateShapesWithMatrix( collider1.GetMatrix().QuickMultiply(
+			component.GetComponent()->GetInverseMatrix() ) );
 		
-		collider1.UpdateShapes();
+		visitor.SetComponent( &component );
+		visitor.SetTestCollider( &collider1 );
+		visitor.SetUseSkinnedVertices( true );
 		
-		for( s1=0; s1<shapeCount1; s1++ ){
-			const debpShape &shape1 = *shapes1.GetShapeAt( s1 );
-			debpDCollisionVolume &colvol1 = *shape1.GetCollisionVolume();
+		component.GetBVH()->VisitFacesOverlapping( collider1.GetShapeMinimumExtend().ToVector(),
+			collider1.GetShapeMaximumExtend().ToVector(), visitor );
 			
-			if( colvol1.BoxHitsVolume( &colbox ) ){
-				for( f=0; f<faceCount; f++ ){
-					const deModelFace &face = engModelLOD.GetFaceAt( f );
-					const decDVector fp1( matrix * component.GetVertex( face.GetVertex1() ) );
-					const decDVector fp2( matrix * component.GetVertex( face.GetVertex2() ) );
-					const decDVector fp3( matrix * component.GetVertex( face.GetVertex3() ) );
-					decDVector normal( ( fp2 - fp1 ) % ( fp3 - fp2 ) );
-					double length = normal.Length();
-					
-					if( length > 1e-5 ){ // only test against non-degenrated triangles
-						normal /= length;
-						coltri.SetCorners( fp1, fp2, fp3, normal );
-						
-						if( colvol1.TriangleHitsVolume( &coltri ) ){
-							result.shape1 = s1;
-							result.shape2 = -1;
-							result.face = f;
-							result.bone2 = -1;
-							
-							return true;
-						}
-					}
-				}
-			}
+		if( visitor.HasCollision() ){
+			debpCollisionResult &vresult = visitor.GetResult();
+			
+			result.shape1 = vresult.shape1;
+			result.shape2 = -1;
+			result.face = vresult.face;
+			result.bone2 = -1;
+			
+			return true;
 		}
 		
 	// test against rig shapes
@@ -259,6 +259,12 @@ public:
 	 */
 	bool ShapeHitsModelFace( debpShape &shape, debpComponent &component, int face );
 	
+	/**
+	 * Determines if a shape hits a model face using the skinned vertices of the component. The shape
+	 * is supposed to be transformed relative to the component. Requires the mesh to be prepared.
+	 */
+	bool ShapeHitsSkinnedModelFace( debpShape &shape, const debpComponent &component, int face );
+	
 	/**
 	 * Determines if a shape move hits a model face. The shape is supposed to be transformed relative
 	 * to the model. If the face is hit the normal and distance parameter of the result are set.
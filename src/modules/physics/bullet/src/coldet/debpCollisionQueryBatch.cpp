@@ -0,0 +1,385 @@
+/* 
+ * Drag[en]gine Game Engine
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "debpCollisionQueryBatch.h"
+#include "debpCollisionDetection.h"
+#include "debpSweepCollisionTest.h"
+#include "../dePhysicsBullet.h"
+#include "../debpCollisionObject.h"
+#include "../collider/debpCollider.h"
+#include "../collider/debpColliderVolume.h"
+#include "../terrain/heightmap/debpHTSector.h"
+#include "../terrain/heightmap/debpHeightTerrain.h"
+#include "../world/debpWorld.h"
+#include "../world/debpCollisionWorld.h"
+#include "../world/debpDelayedOperation.h"
+
+#include "BulletCollision/BroadphaseCollision/btDbvtBroadphase.h"
+#include "BulletCollision/CollisionDispatch/btCollisionObject.h"
+
+#include <dragengine/common/exceptions.h>
+#include <dragengine/resources/collider/deCollider.h>
+#include <dragengine/resources/terrain/heightmap/deHeightTerrain.h>
+#include <dragengine/systems/modules/scripting/deBaseScriptingCollider.h>
+
+
+
+// Definitions
+////////////////
+
+// batches with less queries are processed on the calling thread
+#define PARALLEL_MIN_QUERIES 64
+
+// number of queries processed per chunk
+#define CHUNK_QUERIES 16
+
+
+
+// Structs
+////////////
+
+// collects the hits of a single query. filtering is the same as debpConvexResultCallback
+// except scripting listeners are called later on by the calling thread
+struct debpCQBResultCallback : public btCollisionWorld::ConvexResultCallback{
+	const decCollisionFilter *pRayCollisionFilter;
+	debpCollider *pCollider;
+	const bool pClosestHitOnly;
+	const int pQuery;
+	btAlignedObjectArray<deCollisionQueryBatch::sHit> &pHits;
+	
+	debpCQBResultCallback( const decCollisionFilter *rayCollisionFilter, debpCollider *collider,
+	bool closestHitOnly, int query, btAlignedObjectArray<deCollisionQueryBatch::sHit> &hits ) :
+	pRayCollisionFilter( rayCollisionFilter ),
+	pCollider( collider ),
+	pClosestHitOnly( closestHitOnly ),
+	pQuery( query ),
+	pHits( hits ){
+	}
+	
+	virtual bool needsCollision( btBroadphaseProxy *proxy0 ) const{
+		if( ! ConvexResultCallback::needsCollision( proxy0 ) ){
+			return false;
+		}
+		
+		const btCollisionObject &collisionObject = *( ( btCollisionObject* )proxy0->m_clientObject );
+		const debpCollisionObject &colObj = *( ( debpCollisionObject* )collisionObject.getUserPointer() );
+		
+		if( colObj.IsOwnerCollider() ){
+			const debpCollider * const collider = colObj.GetOwnerCollider();
+			
+			if( pCollider ){
+				return collider != pCollider && ! pCollider->CollidesNot( *collider );
+				
+			}else{
+				return ! pRayCollisionFilter->CollidesNot( collider->GetCollider().GetCollisionFilter() );
+			}
+			
+		}else if( colObj.IsOwnerHTSector() ){
+			const decCollisionFilter &cfHT = colObj.GetOwnerHTSector()->GetHeightTerrain()
+				->GetHeightTerrain()->GetCollisionFilter();
+				
+			if( pCollider ){
+				return pCollider->GetCollider().GetCollisionFilter().Collides( cfHT );
+				
+			}else{
+				return pRayCollisionFilter->Collides( cfHT );
+			}
+		}
+		
+		return false;
+	}
+	
+	virtual btScalar addSingleResult( btCollisionWorld::LocalConvexResult &convexResult, bool normalInWorldSpace ){
+		const debpCollisionObject &colObj = *( ( debpCollisionObject* )convexResult.m_hitCollisionObject->getUserPointer() );
+		deCollisionQueryBatch::sHit hit;
+		
+		hit.query = pQuery;
+		hit.collider = NULL;
+		hit.bone = -1;
+		hit.shape = -1;
+		hit.face = -1;
+		hit.heightTerrain = NULL;
+		hit.htsector = NULL;
+		
+		if( colObj.IsOwnerCollider() ){
+			hit.collider = &colObj.GetOwnerCollider()->GetCollider();
+			hit.bone = colObj.GetOwnerBone();
+			hit.shape = ( int )( intptr_t )convexResult.m_hitCollisionShape->getUserPointer() - 1;
+			
+		}else if( colObj.IsOwnerHTSector() ){
+			const debpHTSector &htsector = *colObj.GetOwnerHTSector();
+			hit.heightTerrain = htsector.GetHeightTerrain()->GetHeightTerrain();
+			hit.htsector = htsector.GetSector();
+			
+		}else{
+			return m_closestHitFraction;
+		}
+		
+		btVector3 hitNormal;
+		if( normalInWorldSpace ){
+			hitNormal = convexResult.m_hitNormalLocal;
+			
+		}else{
+			hitNormal = convexResult.m_hitCollisionObject->getWorldTransform().getBasis() * convexResult.m_hitNormalLocal;
+		}
+		
+		hit.distance = ( float )convexResult.m_hitFraction;
+		hit.normal.Set( ( float )hitNormal.x(), ( float )hitNormal.y(), ( float )hitNormal.z() );
+		
+		// bullet reports only hits closer than m_closestHitFraction. in closest hit mode
+		// lowering m_closestHitFraction ensures each reported hit replaces the last one
+		if( pClosestHitOnly ){
+			pHits.resize( 0 );
+			m_closestHitFraction = convexResult.m_hitFraction;
+		}
+		pHits.push_back( hit );
+		
+		return m_closestHitFraction;
+	}
+};
+
+// Class debpCollisionQueryBatch
+//////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+debpCollisionQueryBatch::debpCollisionQueryBatch( debpWorld &world, deCollisionQueryBatch &batch ) :
+debpParallelCollisionJob( world.GetBullet(), batch.GetQueryCount(), CHUNK_QUERIES ),
+pWorld( world ),
+pBatch( batch ),
+pBroadphase( *( ( btDbvtBroadphase* )world.GetDynamicsWorld()->getBroadphase() ) ),
+pCastShapes( NULL ),
+pCollider( NULL ),
+pCastOrientation( ( btScalar )0.0, ( btScalar )0.0, ( btScalar )0.0, ( btScalar )1.0 ),
+pListener( NULL ),
+pCollectClosestHitOnly( batch.GetClosestHitOnly() ),
+pChunks( NULL )
+{
+	deCollider * const collider = batch.GetCollider();
+	
+	if( collider ){
+		// the listener is asked after testing on the calling thread. a hit rejected by the
+		// listener can hide further hits hence tasks have to collect all hits
+		pListener = collider->GetPeerScripting();
+		if( pListener ){
+			pCollectClosestHitOnly = false;
+		}
+		
+		// only volume colliders have sweep collision tests. other colliders find no hits
+		pCollider = ( debpCollider* )collider->GetPeerPhysics();
+		
+		if( pCollider && pCollider->IsVolume() ){
+			// sweep collision test updates lazily. do it on the calling thread
+			pCastShapes = pCollider->CastToVolume()->GetSweepCollisionTest();
+			
+			const decQuaternion &orientation = collider->GetOrientation();
+			pCastOrientation.setValue( ( btScalar )orientation.x, ( btScalar )orientation.y,
+				( btScalar )orientation.z, ( btScalar )orientation.w );
+		}
+		
+	}else{
+		pCastShapes = &world.GetBullet().GetCollisionDetection().GetRayHackShape();
+	}
+	
+	if( ! pCastShapes || pCastShapes->GetShapeList().GetCount() == 0 ){
+		pCastShapes = NULL;
+		return;
+	}
+	
+	const int chunkCount = GetChunkCount();
+	if( chunkCount == 0 ){
+		return;
+	}
+	
+	pChunks = new sChunk[ chunkCount ];
+	
+	int i;
+	for( i=0; i<chunkCount; i++ ){
+		pChunks[ i ].hits = NULL;
+		pChunks[ i ].hitCount = 0;
+		pChunks[ i ].hitSize = 0;
+	}
+}
+
+debpCollisionQueryBatch::~debpCollisionQueryBatch(){
+	pCleanUp();
+}
+
+
+
+// Management
+///////////////
+
+void debpCollisionQueryBatch::Process(){
+	if( ! pChunks ){
+		return;
+	}
+	
+	debpDelayedOperation &delayedOperation = pWorld.GetDynamicsWorld()->GetDelayedOperation();
+	delayedOperation.Lock();
+	
+	try{
+		Run( PARALLEL_MIN_QUERIES );
+		pFinishChunks();
+		delayedOperation.Unlock();
+		
+	}catch( const deException & ){
+		delayedOperation.Unlock();
+		throw;
+	}
+}
+
+const char *debpCollisionQueryBatch::GetDebugName() const{
+	return "CollisionQueryBatch";
+}
+
+
+
+// Protected Functions
+////////////////////////
+
+void debpCollisionQueryBatch::ProcessChunk( int chunk, int firstItem, int itemCount, sThreadData &threadData ){
+	btAlignedObjectArray<deCollisionQueryBatch::sHit> hits;
+	sChunk &chunkData = pChunks[ chunk ];
+	int i, j;
+	
+	for( i=0; i<itemCount; i++ ){
+		pProcessQuery( firstItem + i, threadData, hits );
+		
+		const int hitCount = hits.size();
+		for( j=0; j<hitCount; j++ ){
+			pAddChunkHit( chunkData, hits[ j ] );
+		}
+	}
+}
+
+
+
+// Private Functions
+//////////////////////
+
+void debpCollisionQueryBatch::pCleanUp(){
+	if( pChunks ){
+		const int chunkCount = GetChunkCount();
+		int i;
+		for( i=0; i<chunkCount; i++ ){
+			if( pChunks[ i ].hits ){
+				delete [] pChunks[ i ].hits;
+			}
+		}
+		delete [] pChunks;
+	}
+}
+
+void debpCollisionQueryBatch::pProcessQuery( int query, sThreadData &threadData,
+btAlignedObjectArray<deCollisionQueryBatch::sHit> &hits ){
+	const deCollisionQueryBatch::sQuery &batchQuery = pBatch.GetQueries()[ query ];
+	int i, j;
+	
+	hits.resize( 0 );
+	
+	debpCQBResultCallback resultCallback( &pBatch.GetCollisionFilter(), pCollider,
+		pCollectClosestHitOnly, query, hits );
+		
+	const decDVector &origin = batchQuery.origin;
+	const decDVector target( origin + decDVector( batchQuery.direction ) );
+	const btTransform from( pCastOrientation, btVector3( ( btScalar )origin.x,
+		( btScalar )origin.y, ( btScalar )origin.z ) );
+	const btTransform to( pCastOrientation, btVector3( ( btScalar )target.x,
+		( btScalar )target.y, ( btScalar )target.z ) );
+		
+	pCastShapes->SweepTest( pBroadphase, from, to, resultCallback,
+		threadData.broadphaseStack, threadData.shapeStack );
+	
+	// sort hits by distance. hit counts per query are small so insertion sort is fine
+	const int hitCount = hits.size();
+	
+	for( i=1; i<hitCount; i++ ){
+		const deCollisionQueryBatch::sHit hit( hits[ i ] );
+		
+		for( j=i; j>0 && hits[ j - 1 ].distance > hit.distance; j-- ){
+			hits[ j ] = hits[ j - 1 ];
+		}
+		hits[ j ] = hit;
+	}
+}
+
+void debpCollisionQueryBatch::pAddChunkHit( sChunk &chunk, const deCollisionQueryBatch::sHit &hit ){
+	if( chunk.hitCount == chunk.hitSize ){
+		const int newSize = chunk.hitSize * 3 / 2 + 1;
+		deCollisionQueryBatch::sHit * const newArray = new deCollisionQueryBatch::sHit[ newSize ];
+		if( chunk.hits ){
+			int i;
+			for( i=0; i<chunk.hitCount; i++ ){
+				newArray[ i ] = chunk.hits[ i ];
+			}
+			delete [] chunk.hits;
+		}
+		chunk.hits = newArray;
+		chunk.hitSize = newSize;
+	}
+	
+	chunk.hits[ chunk.hitCount++ ] = hit;
+}
+
+void debpCollisionQueryBatch::pFinishChunks(){
+	const int chunkCount = GetChunkCount();
+	int i, j;
+	
+	if( ! pListener ){
+		for( i=0; i<chunkCount; i++ ){
+			const sChunk &chunk = pChunks[ i ];
+			for( j=0; j<chunk.hitCount; j++ ){
+				pBatch.AddHit( chunk.hits[ j ] );
+			}
+		}
+		return;
+	}
+	
+	// filter hits using the collider listener. hits of each query are sorted by distance
+	// hence in closest hit mode the first accepted hit of each query is the closest one
+	deCollider * const engCollider = &pCollider->GetCollider();
+	const bool closestHitOnly = pBatch.GetClosestHitOnly();
+	int lastQuery = -1;
+	
+	for( i=0; i<chunkCount; i++ ){
+		const sChunk &chunk = pChunks[ i ];
+		
+		for( j=0; j<chunk.hitCount; j++ ){
+			const deCollisionQueryBatch::sHit &hit = chunk.hits[ j ];
+			
+			if( closestHitOnly && hit.query == lastQuery ){
+				continue;
+			}
+			
+			if( hit.collider && ! pListener->CanHitCollider( engCollider, hit.collider ) ){
+				continue;
+			}
+			
+			pBatch.AddHit( hit );
+			lastQuery = hit.query;
+		}
+	}
+}
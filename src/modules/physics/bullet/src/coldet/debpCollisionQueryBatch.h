@@ -0,0 +1,117 @@
+/* 
+ * Drag[en]gine Game Engine
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEBPCOLLISIONQUERYBATCH_H_
+#define _DEBPCOLLISIONQUERYBATCH_H_
+
+#include "debpParallelCollisionJob.h"
+
+#include "LinearMath/btQuaternion.h"
+
+#include <dragengine/resources/collider/deCollisionQueryBatch.h>
+
+class debpCollider;
+class deBaseScriptingCollider;
+class debpSweepCollisionTest;
+class debpWorld;
+
+class btDbvtBroadphase;
+
+
+/**
+ * \brief Process collision query batch.
+ * 
+ * Queries are processed in chunks by debpParallelCollisionJob. Each chunk stores hits in an
+ * own list. Once all chunks are finished the hits are added to the batch in chunk order.
+ * 
+ * Collision filters are checked by the tasks. If a collider with a scripting peer is cast
+ * the tasks collect all hits. CanHitCollider() of the scripting peer is then called for each
+ * hit on the calling thread while adding the hits to the batch. Scripting is never called
+ * from parallel tasks. The world is locked during processing. Only volume colliders can be
+ * cast. Casting other collider types finds no hits.
+ */
+class debpCollisionQueryBatch : public debpParallelCollisionJob{
+private:
+	/** \brief Hits found by a chunk. */
+	struct sChunk{
+		deCollisionQueryBatch::sHit *hits;
+		int hitCount;
+		int hitSize;
+	};
+	
+	debpWorld &pWorld;
+	deCollisionQueryBatch &pBatch;
+	const btDbvtBroadphase &pBroadphase;
+	const debpSweepCollisionTest *pCastShapes;
+	debpCollider *pCollider;
+	btQuaternion pCastOrientation;
+	deBaseScriptingCollider *pListener;
+	bool pCollectClosestHitOnly;
+	
+	sChunk *pChunks;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create collision query batch processor. */
+	debpCollisionQueryBatch( debpWorld &world, deCollisionQueryBatch &batch );
+	
+protected:
+	/** \brief Clean up collision query batch processor. */
+	virtual ~debpCollisionQueryBatch();
+	/*@}*/
+	
+	
+	
+public:
+	/** \name Management */
+	/*@{*/
+	/**
+	 * \brief Process all queries and add hits to the batch.
+	 * 
+	 * If the batch is large enough processing is split into chunks processed by
+	 * parallel tasks together with the calling thread.
+	 */
+	void Process();
+	
+	/** \brief Short job name for debugging. */
+	virtual const char *GetDebugName() const;
+	/*@}*/
+	
+	
+	
+protected:
+	/** \brief Process queries of chunk. */
+	virtual void ProcessChunk( int chunk, int firstItem, int itemCount, sThreadData &threadData );
+	
+	
+	
+private:
+	void pCleanUp();
+	void pProcessQuery( int query, sThreadData &threadData,
+		btAlignedObjectArray<deCollisionQueryBatch::sHit> &hits );
+	void pAddChunkHit( sChunk &chunk, const deCollisionQueryBatch::sHit &hit );
+	void pFinishChunks();
+};
+
+#endif
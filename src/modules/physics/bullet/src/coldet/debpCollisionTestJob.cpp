@@ -0,0 +1,488 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "debpCollisionTestJob.h"
+#include "debpCollisionDetection.h"
+#include "debpSweepCollisionTest.h"
+#include "../dePhysicsBullet.h"
+#include "../debpCollisionObject.h"
+#include "../collider/debpCollider.h"
+#include "../collider/debpColliderVolume.h"
+#include "../collider/debpColliderCollisionTest.h"
+#include "../terrain/heightmap/debpHTSector.h"
+#include "../terrain/heightmap/debpHeightTerrain.h"
+#include "../world/debpWorld.h"
+#include "../world/debpCollisionWorld.h"
+#include "../world/debpDelayedOperation.h"
+
+#include "BulletCollision/BroadphaseCollision/btDbvtBroadphase.h"
+#include "BulletCollision/CollisionDispatch/btCollisionObject.h"
+
+#include <dragengine/common/exceptions.h>
+#include <dragengine/resources/collider/deCollider.h>
+#include <dragengine/resources/collider/deColliderCollisionTest.h>
+#include <dragengine/resources/collider/deCollisionInfo.h>
+#include <dragengine/resources/terrain/heightmap/deHeightTerrain.h>
+
+
+
+// Definitions
+////////////////
+
+// less collision tests are processed on the calling thread
+#define PARALLEL_MIN_TESTS 32
+
+// number of collision tests processed per chunk
+#define CHUNK_TESTS 8
+
+
+
+// Structs
+////////////
+
+// collects candidate hits. filtering is the same as debpConvexResultCallback without
+// calling scripting listeners. the listener is asked later on the calling thread
+struct debpCTJResultCallback : public btCollisionWorld::ConvexResultCallback{
+	const debpColliderCollisionTest &pTest;
+	const debpCollider *pCollider;
+	const decCollisionFilter *pRayCollisionFilter;
+	btAlignedObjectArray<debpCollisionTestJob::sHit> &pHits;
+	
+	debpCTJResultCallback( const debpColliderCollisionTest &test, const debpCollider *collider,
+	const decCollisionFilter *rayCollisionFilter, btAlignedObjectArray<debpCollisionTestJob::sHit> &hits ) :
+	pTest( test ),
+	pCollider( collider ),
+	pRayCollisionFilter( rayCollisionFilter ),
+	pHits( hits ){
+	}
+	
+	virtual bool needsCollision( btBroadphaseProxy *proxy0 ) const{
+		if( ! ConvexResultCallback::needsCollision( proxy0 ) ){
+			return false;
+		}
+		
+		const btCollisionObject &collisionObject = *( ( btCollisionObject* )proxy0->m_clientObject );
+		const debpCollisionObject &colObj = *( ( debpCollisionObject* )collisionObject.getUserPointer() );
+		
+		if( colObj.IsOwnerCollider() ){
+			const debpCollider * const collider = colObj.GetOwnerCollider();
+			
+			if( pCollider ){
+				if( collider == pCollider || pCollider->CollidesNot( *collider ) ){
+					return false;
+				}
+				
+			}else if( pRayCollisionFilter->CollidesNot( collider->GetCollider().GetCollisionFilter() ) ){
+				return false;
+			}
+			
+			return ! pTest.IgnoresCollider( &collider->GetCollider() );
+			
+		}else if( colObj.IsOwnerHTSector() ){
+			const decCollisionFilter &cfHT = colObj.GetOwnerHTSector()->GetHeightTerrain()
+				->GetHeightTerrain()->GetCollisionFilter();
+				
+			if( pCollider ){
+				return pCollider->GetCollider().GetCollisionFilter().Collides( cfHT );
+				
+			}else{
+				return pRayCollisionFilter->Collides( cfHT );
+			}
+		}
+		
+		return false;
+	}
+	
+	virtual btScalar addSingleResult( btCollisionWorld::LocalConvexResult &convexResult, bool normalInWorldSpace ){
+		const debpCollisionObject &colObj = *( ( debpCollisionObject* )convexResult.m_hitCollisionObject->getUserPointer() );
+		debpCollisionTestJob::sHit hit;
+		
+		hit.collider = NULL;
+		hit.bone = -1;
+		hit.shape = -1;
+		hit.face = -1;
+		hit.heightTerrain = NULL;
+		hit.htsector = NULL;
+		
+		if( colObj.IsOwnerCollider() ){
+			hit.collider = &colObj.GetOwnerCollider()->GetCollider();
+			hit.bone = colObj.GetOwnerBone();
+			hit.shape = ( int )( intptr_t )convexResult.m_hitCollisionShape->getUserPointer() - 1;
+			
+		}else if( colObj.IsOwnerHTSector() ){
+			const debpHTSector &htsector = *colObj.GetOwnerHTSector();
+			hit.heightTerrain = htsector.GetHeightTerrain()->GetHeightTerrain();
+			hit.htsector = htsector.GetSector();
+			
+		}else{
+			return m_closestHitFraction;
+		}
+		
+		btVector3 hitNormal;
+		if( normalInWorldSpace ){
+			hitNormal = convexResult.m_hitNormalLocal;
+			
+		}else{
+			hitNormal = convexResult.m_hitCollisionObject->getWorldTransform().getBasis() * convexResult.m_hitNormalLocal;
+		}
+		
+		hit.distance = ( float )convexResult.m_hitFraction;
+		hit.normal.Set( ( float )hitNormal.x(), ( float )hitNormal.y(), ( float )hitNormal.z() );
+		
+		pHits.push_back( hit );
+		return m_closestHitFraction;
+	}
+};
+
+
+
+// Class debpCollisionTestJob
+///////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+debpCollisionTestJob::debpCollisionTestJob( debpWorld &world, debpCollider * const *colliders, int colliderCount ) :
+debpParallelCollisionJob( world.GetBullet(), pCountTests( colliders, colliderCount ), CHUNK_TESTS ),
+pWorld( world ),
+pBroadphase( *( ( btDbvtBroadphase* )world.GetDynamicsWorld()->getBroadphase() ) ),
+pItems( NULL ),
+pHitsReferenced( false )
+{
+	const int itemCount = GetItemCount();
+	if( itemCount == 0 ){
+		return;
+	}
+	
+	pItems = new sItem[ itemCount ];
+	
+	int i, j, next = 0;
+	for( i=0; i<colliderCount; i++ ){
+		debpCollider * const collider = colliders[ i ];
+		if( ! collider ){
+			continue;
+		}
+		
+		const int testCount = collider->GetCollisionTestCount();
+		for( j=0; j<testCount; j++ ){
+			sItem &item = pItems[ next++ ];
+			item.parentCollider = &collider->GetCollider();
+			item.test = collider->GetCollisionTestAt( j );
+			item.collisionTest = &item.test->GetCollisionTest();
+			item.testIndex = j;
+			item.mode = emSerial;
+			item.testCollider = NULL;
+			item.rayCollisionFilter = NULL;
+			item.castShapes = NULL;
+		}
+	}
+}
+
+debpCollisionTestJob::~debpCollisionTestJob(){
+	pCleanUp();
+}
+
+
+
+// Management
+///////////////
+
+void debpCollisionTestJob::Process(){
+	if( ! pItems ){
+		return;
+	}
+	
+	if( pPrepare() ){
+		pWorld.UpdateOctrees();
+		pWorld.UpdateDynWorldAABBs();
+		
+		debpDelayedOperation &delayedOperation = pWorld.GetDynamicsWorld()->GetDelayedOperation();
+		delayedOperation.Lock();
+		
+		try{
+			Run( PARALLEL_MIN_TESTS );
+			delayedOperation.Unlock();
+			
+		}catch( const deException & ){
+			delayedOperation.Unlock();
+			throw;
+		}
+		
+		pReferenceHits();
+	}
+	
+	pApply();
+}
+
+const char *debpCollisionTestJob::GetDebugName() const{
+	return "CollisionTest";
+}
+
+
+
+// Protected Functions
+////////////////////////
+
+void debpCollisionTestJob::ProcessChunk( int, int firstItem, int itemCount, sThreadData &threadData ){
+	int i;
+	
+	for( i=0; i<itemCount; i++ ){
+		sItem &item = pItems[ firstItem + i ];
+		if( item.mode != emParallel ){
+			continue;
+		}
+		
+		debpCTJResultCallback resultCallback( *item.test, item.testCollider,
+			item.rayCollisionFilter, item.hits );
+		item.castShapes->SweepTest( pBroadphase, item.from, item.to, resultCallback,
+			threadData.broadphaseStack, threadData.shapeStack );
+	}
+}
+
+
+
+// Private Functions
+//////////////////////
+
+int debpCollisionTestJob::pCountTests( debpCollider * const *colliders, int colliderCount ){
+	int i, count = 0;
+	
+	for( i=0; i<colliderCount; i++ ){
+		if( colliders[ i ] ){
+			count += colliders[ i ]->GetCollisionTestCount();
+		}
+	}
+	
+	return count;
+}
+
+void debpCollisionTestJob::pCleanUp(){
+	if( ! pItems ){
+		return;
+	}
+	
+	if( pHitsReferenced ){
+		const int itemCount = GetItemCount();
+		int i, j;
+		
+		for( i=0; i<itemCount; i++ ){
+			const btAlignedObjectArray<sHit> &hits = pItems[ i ].hits;
+			const int hitCount = hits.size();
+			
+			for( j=0; j<hitCount; j++ ){
+				if( hits[ j ].collider ){
+					hits[ j ].collider->FreeReference();
+				}
+				if( hits[ j ].heightTerrain ){
+					hits[ j ].heightTerrain->FreeReference();
+				}
+			}
+		}
+	}
+	
+	delete [] pItems;
+}
+
+bool debpCollisionTestJob::pPrepare(){
+	const btQuaternion identity( ( btScalar )0.0, ( btScalar )0.0, ( btScalar )0.0, ( btScalar )1.0 );
+	debpSweepCollisionTest &rayHackShape = pWorld.GetBullet().GetCollisionDetection().GetRayHackShape();
+	const int itemCount = GetItemCount();
+	bool hasParallel = false;
+	int i;
+	
+	for( i=0; i<itemCount; i++ ){
+		sItem &item = pItems[ i ];
+		const deColliderCollisionTest &collisionTest = item.collisionTest;
+		
+		// touch sensor tests call scripting listeners while testing
+		if( ! collisionTest.GetEnabled() || collisionTest.GetTouchSensor() ){
+			continue;
+		}
+		
+		item.test->PrepareTest( item.position, item.direction );
+		item.mode = emSerialPrepared;
+		
+		const decDVector target( item.position + decDVector( item.direction ) );
+		const btVector3 btfrom( ( btScalar )item.position.x, ( btScalar )item.position.y, ( btScalar )item.position.z );
+		const btVector3 btto( ( btScalar )target.x, ( btScalar )target.y, ( btScalar )target.z );
+		
+		item.collider = collisionTest.GetCollider();
+		
+		if( item.collider ){
+			// collider hits call scripting listeners while testing. moving colliders other
+			// than volumes find no hits
+			if( item.direction.IsZero() ){
+				continue;
+			}
+			
+			debpCollider * const testCollider = ( debpCollider* )item.collider->GetPeerPhysics();
+			if( ! testCollider || ! testCollider->IsVolume() ){
+				continue;
+			}
+			
+			item.castShapes = testCollider->CastToVolume()->GetSweepCollisionTest();
+			if( item.castShapes->GetShapeList().GetCount() == 0 ){
+				continue;
+			}
+			
+			item.testCollider = testCollider;
+			
+			// the test collider is moved to the test position while applying the results
+			const decQuaternion &orientation = item.parentCollider->GetOrientation();
+			const btQuaternion btorientation( ( btScalar )orientation.x, ( btScalar )orientation.y,
+				( btScalar )orientation.z, ( btScalar )orientation.w );
+			item.from = btTransform( btorientation, btfrom );
+			item.to = btTransform( btorientation, btto );
+			
+		}else{
+			// same as debpCollisionDetection::RayHits
+			item.rayCollisionFilter = &collisionTest.GetCollisionFilter();
+			item.castShapes = &rayHackShape;
+			item.from = btTransform( identity, btfrom );
+			item.to = btTransform( identity, btto );
+		}
+		
+		item.mode = emParallel;
+		hasParallel = true;
+	}
+	
+	return hasParallel;
+}
+
+void debpCollisionTestJob::pReferenceHits(){
+	const int itemCount = GetItemCount();
+	int i, j;
+	
+	// hit colliders can be removed by scripting listeners while applying the results
+	for( i=0; i<itemCount; i++ ){
+		const btAlignedObjectArray<sHit> &hits = pItems[ i ].hits;
+		const int hitCount = hits.size();
+		
+		for( j=0; j<hitCount; j++ ){
+			if( hits[ j ].collider ){
+				hits[ j ].collider->AddReference();
+			}
+			if( hits[ j ].heightTerrain ){
+				hits[ j ].heightTerrain->AddReference();
+			}
+		}
+	}
+	
+	pHitsReferenced = true;
+}
+
+void debpCollisionTestJob::pApply(){
+	const int itemCount = GetItemCount();
+	int i;
+	
+	for( i=0; i<itemCount; i++ ){
+		sItem &item = pItems[ i ];
+		
+		// scripting listeners of collision tests processed earlier can remove colliders
+		// and collision tests
+		if( ! pIsValid( item ) ){
+			continue;
+		}
+		
+		switch( item.mode ){
+		case emSerial:
+			item.test->Update();
+			break;
+			
+		case emSerialPrepared:
+			item.test->RunTest( item.position, item.direction );
+			break;
+			
+		case emParallel:
+			if( item.collider != item.collisionTest->GetCollider() ){
+				item.test->RunTest( item.position, item.direction );
+				
+			}else{
+				pApplyHits( item );
+			}
+			break;
+		}
+	}
+}
+
+void debpCollisionTestJob::pApplyHits( sItem &item ){
+	deCollisionInfo &colinfo = *pWorld.GetCollisionInfo();
+	debpColliderCollisionTest &test = *item.test;
+	const btAlignedObjectArray<sHit> &hits = item.hits;
+	const int hitCount = hits.size();
+	deCollider *lastCollider = NULL;
+	bool canHitLastCollider = false;
+	int i;
+	
+	if( item.collider ){
+		// same as debpColliderCollisionTest::ColliderMoveHits
+		item.collider->SetPosition( item.position );
+		item.collider->SetOrientation( item.parentCollider->GetOrientation() );
+	}
+	
+	test.SetSortByDistance( true );
+	
+	for( i=0; i<hitCount; i++ ){
+		const sHit &hit = hits[ i ];
+		
+		if( hit.collider ){
+			// multiple hits with shapes of the same collider are reported in a row
+			if( hit.collider != lastCollider ){
+				lastCollider = hit.collider;
+				canHitLastCollider = test.CanHitCollider( item.collider, hit.collider );
+			}
+			if( ! canHitLastCollider ){
+				continue;
+			}
+			
+			colinfo.SetCollider( hit.collider, hit.bone, hit.shape, hit.face );
+			
+		}else{
+			colinfo.SetHTSector( hit.heightTerrain, hit.htsector );
+		}
+		
+		colinfo.SetDistance( hit.distance );
+		colinfo.SetNormal( hit.normal );
+		test.CollisionResponse( item.collider, &colinfo );
+		
+		// the scripting listener can remove the collision test or its collider
+		if( ! pIsValid( item ) ){
+			return;
+		}
+	}
+	
+	test.SetCollisionTestResult();
+}
+
+bool debpCollisionTestJob::pIsValid( const sItem &item ) const{
+	// the parent collider is referenced but the physics peer can be gone. look it up
+	// instead of storing the peer pointer while creating the job
+	const debpCollider * const parent = ( const debpCollider* )item.parentCollider->GetPeerPhysics();
+	
+	return parent
+		&& parent->GetParentWorld() == &pWorld
+		&& item.testIndex < parent->GetCollisionTestCount()
+		&& parent->GetCollisionTestAt( item.testIndex ) == item.test
+		&& &item.test->GetCollisionTest() == ( deColliderCollisionTest* )item.collisionTest;
+}
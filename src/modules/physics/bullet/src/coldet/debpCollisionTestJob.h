@@ -0,0 +1,158 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEBPCOLLISIONTESTJOB_H_
+#define _DEBPCOLLISIONTESTJOB_H_
+
+#include "debpParallelCollisionJob.h"
+
+#include "LinearMath/btTransform.h"
+
+#include <dragengine/common/math/decMath.h>
+#include <dragengine/resources/collider/deColliderReference.h>
+#include <dragengine/resources/collider/deColliderCollisionTestReference.h>
+
+class debpCollider;
+class debpColliderCollisionTest;
+class debpSweepCollisionTest;
+class debpWorld;
+
+class deCollider;
+class deHeightTerrain;
+class deHeightTerrainSector;
+class decCollisionFilter;
+
+class btDbvtBroadphase;
+
+
+/**
+ * \brief Update collider collision tests in parallel.
+ * 
+ * Ray tests and collider move tests without touch sensor are cast in parallel. Candidate
+ * hits are collected checking only collision filters and ignored colliders. Once all
+ * chunks are finished the candidate hits are filtered using the collision test scripting
+ * listener and stored in the collision tests on the calling thread. Collision tests are
+ * processed in the same order as without using this job. All other collision tests are
+ * updated on the calling thread while storing the results.
+ */
+class debpCollisionTestJob : public debpParallelCollisionJob{
+public:
+	/** \brief Candidate hit. */
+	struct sHit{
+		deCollider *collider;
+		int bone;
+		int shape;
+		int face;
+		deHeightTerrain *heightTerrain;
+		deHeightTerrainSector *htsector;
+		float distance;
+		decVector normal;
+	};
+	
+	
+	
+private:
+	/** \brief Processing mode. */
+	enum eMode{
+		/** \brief Update on calling thread. */
+		emSerial,
+		
+		/** \brief Prepared but run on calling thread. */
+		emSerialPrepared,
+		
+		/** \brief Cast in parallel. */
+		emParallel
+	};
+	
+	/**
+	 * \brief Collision test to update.
+	 * 
+	 * Scripting listeners can remove and delete colliders while results are applied. The
+	 * engine colliders are referenced to keep them alive. The physics peers are looked up
+	 * from the engine colliders before each use.
+	 */
+	struct sItem{
+		deColliderReference parentCollider;
+		debpColliderCollisionTest *test;
+		deColliderCollisionTestReference collisionTest;
+		int testIndex;
+		eMode mode;
+		
+		decDVector position;
+		decVector direction;
+		deColliderReference collider;
+		debpCollider *testCollider;
+		const decCollisionFilter *rayCollisionFilter;
+		const debpSweepCollisionTest *castShapes;
+		btTransform from;
+		btTransform to;
+		btAlignedObjectArray<sHit> hits;
+	};
+	
+	debpWorld &pWorld;
+	const btDbvtBroadphase &pBroadphase;
+	sItem *pItems;
+	bool pHitsReferenced;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create collision test job for all collision tests of colliders. */
+	debpCollisionTestJob( debpWorld &world, debpCollider * const *colliders, int colliderCount );
+	
+protected:
+	/** \brief Clean up collision test job. */
+	virtual ~debpCollisionTestJob();
+	/*@}*/
+	
+	
+	
+public:
+	/** \name Management */
+	/*@{*/
+	/** \brief Update collision tests and store results. */
+	void Process();
+	
+	/** \brief Short job name for debugging. */
+	virtual const char *GetDebugName() const;
+	/*@}*/
+	
+	
+	
+protected:
+	/** \brief Cast collision tests of chunk. */
+	virtual void ProcessChunk( int chunk, int firstItem, int itemCount, sThreadData &threadData );
+	
+	
+	
+private:
+	static int pCountTests( debpCollider * const *colliders, int colliderCount );
+	void pCleanUp();
+	bool pPrepare();
+	void pReferenceHits();
+	void pApply();
+	void pApplyHits( sItem &item );
+	bool pIsValid( const sItem &item ) const;
+};
+
+#endif
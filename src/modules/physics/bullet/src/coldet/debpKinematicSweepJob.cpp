@@ -0,0 +1,260 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "debpKinematicSweepJob.h"
+#include "debpSweepCollisionTest.h"
+#include "../debpCollisionObject.h"
+#include "../collider/debpCollider.h"
+#include "../collider/debpColliderVolume.h"
+#include "../terrain/heightmap/debpHTSector.h"
+#include "../terrain/heightmap/debpHeightTerrain.h"
+#include "../world/debpWorld.h"
+#include "../world/debpCollisionWorld.h"
+#include "../world/debpDelayedOperation.h"
+
+#include "BulletCollision/BroadphaseCollision/btDbvtBroadphase.h"
+#include "BulletCollision/CollisionDispatch/btCollisionObject.h"
+
+#include <dragengine/common/exceptions.h>
+#include <dragengine/resources/collider/deColliderVolume.h>
+#include <dragengine/resources/terrain/heightmap/deHeightTerrain.h>
+
+
+
+// Definitions
+////////////////
+
+// less colliders are processed on the calling thread
+#define PARALLEL_MIN_COLLIDERS 64
+
+// number of colliders processed per chunk
+#define CHUNK_COLLIDERS 32
+
+
+
+// Structs
+////////////
+
+// stops at the first hit. filtering is the same as debpClosestConvexResultCallback
+// without calling scripting listeners. this finds the same or more hits
+struct debpKSJResultCallback : public btCollisionWorld::ConvexResultCallback{
+	const debpCollider &pCollider;
+	
+	debpKSJResultCallback( const debpCollider &collider ) : pCollider( collider ){
+	}
+	
+	virtual bool needsCollision( btBroadphaseProxy *proxy0 ) const{
+		if( ! ConvexResultCallback::needsCollision( proxy0 ) ){
+			return false;
+		}
+		
+		const btCollisionObject &collisionObject = *( ( btCollisionObject* )proxy0->m_clientObject );
+		const debpCollisionObject &colObj = *( ( debpCollisionObject* )collisionObject.getUserPointer() );
+		
+		if( colObj.IsOwnerCollider() ){
+			const debpCollider * const collider = colObj.GetOwnerCollider();
+			return collider != &pCollider && ! pCollider.CollidesNot( *collider );
+			
+		}else if( colObj.IsOwnerHTSector() ){
+			return pCollider.GetCollider().GetCollisionFilter().Collides( colObj.GetOwnerHTSector()
+				->GetHeightTerrain()->GetHeightTerrain()->GetCollisionFilter() );
+		}
+		
+		return false;
+	}
+	
+	virtual btScalar addSingleResult( btCollisionWorld::LocalConvexResult&, bool ){
+		m_closestHitFraction = ( btScalar )0.0;
+		return m_closestHitFraction;
+	}
+};
+
+
+
+// Class debpKinematicSweepJob
+////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+debpKinematicSweepJob::debpKinematicSweepJob( debpWorld &world, debpCollider * const *colliders,
+int colliderCount, float elapsed ) :
+debpParallelCollisionJob( world.GetBullet(), colliderCount, CHUNK_COLLIDERS ),
+pWorld( world ),
+pBroadphase( *( ( btDbvtBroadphase* )world.GetDynamicsWorld()->getBroadphase() ) ),
+pItems( NULL )
+{
+	if( colliderCount == 0 ){
+		return;
+	}
+	
+	pItems = new sItem[ colliderCount ];
+	
+	int i;
+	for( i=0; i<colliderCount; i++ ){
+		pInitItem( pItems[ i ], colliders[ i ], elapsed );
+	}
+}
+
+debpKinematicSweepJob::~debpKinematicSweepJob(){
+	if( pItems ){
+		delete [] pItems;
+	}
+}
+
+
+
+// Management
+///////////////
+
+void debpKinematicSweepJob::Process(){
+	if( ! pItems ){
+		return;
+	}
+	
+	debpDelayedOperation &delayedOperation = pWorld.GetDynamicsWorld()->GetDelayedOperation();
+	delayedOperation.Lock();
+	
+	try{
+		Run( PARALLEL_MIN_COLLIDERS );
+		delayedOperation.Unlock();
+		
+	}catch( const deException & ){
+		delayedOperation.Unlock();
+		throw;
+	}
+}
+
+bool debpKinematicSweepJob::CanApplyMove( int index, const debpCollider &collider ) const{
+	if( index < 0 || index >= GetItemCount() ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	const sItem &item = pItems[ index ];
+	if( item.collider != &collider || item.hasHit ){
+		return false;
+	}
+	
+	// scripting listeners of colliders processed earlier can modify this collider
+	const debpColliderVolume &volume = *item.collider;
+	const deColliderVolume &engVolume = volume.GetColliderVolume();
+	
+	return volume.GetUseKinematicSimulation() && volume.GetIsMoving()
+		&& engVolume.GetEnabled() && ! engVolume.GetCollisionFilter().CanNotCollide()
+		&& ! volume.GetDirtySweepTest()
+		&& volume.GetHasAngularVelocity() == item.hasAngularVelocity
+		&& volume.GetPosition().IsEqualTo( item.position, 0.0 )
+		&& volume.GetOrientation().IsEqualTo( item.orientation, 0.0f )
+		&& volume.GetLinearVelocity().IsEqualTo( item.linearVelocity, 0.0f )
+		&& volume.GetAngularVelocity().IsEqualTo( item.angularVelocity, 0.0f )
+		&& volume.GetGravity().IsEqualTo( item.gravity, 0.0f );
+}
+
+const char *debpKinematicSweepJob::GetDebugName() const{
+	return "KinematicSweep";
+}
+
+
+
+// Protected Functions
+////////////////////////
+
+void debpKinematicSweepJob::ProcessChunk( int, int firstItem, int itemCount, sThreadData &threadData ){
+	int i;
+	
+	for( i=0; i<itemCount; i++ ){
+		sItem &item = pItems[ firstItem + i ];
+		if( ! item.sweep ){
+			continue;
+		}
+		
+		debpKSJResultCallback resultCallback( *item.collider );
+		item.sweepTest->SweepTest( pBroadphase, item.from, item.to, resultCallback,
+			threadData.broadphaseStack, threadData.shapeStack );
+		item.hasHit = resultCallback.hasHit();
+	}
+}
+
+
+
+// Private Functions
+//////////////////////
+
+void debpKinematicSweepJob::pInitItem( sItem &item, debpCollider *collider, float elapsed ){
+	item.collider = NULL;
+	item.sweepTest = NULL;
+	item.hasAngularVelocity = false;
+	item.sweep = false;
+	item.hasHit = false;
+	
+	// other colliders are processed serially
+	if( ! collider || ! collider->IsVolume() || ! collider->GetUseKinematicSimulation()
+	|| ! collider->GetIsMoving() ){
+		return;
+	}
+	
+	debpColliderVolume &volume = *collider->CastToVolume();
+	const deColliderVolume &engVolume = volume.GetColliderVolume();
+	if( ! engVolume.GetEnabled() || engVolume.GetCollisionFilter().CanNotCollide() ){
+		return;
+	}
+	
+	item.collider = &volume;
+	item.sweepTest = volume.GetSweepCollisionTest(); // updates lazily. do it on the calling thread
+	item.position = volume.GetPosition();
+	item.orientation = volume.GetOrientation();
+	item.linearVelocity = volume.GetLinearVelocity();
+	item.angularVelocity = volume.GetAngularVelocity();
+	item.gravity = volume.GetGravity();
+	item.hasAngularVelocity = volume.GetHasAngularVelocity();
+	
+	// same as the first iteration of debpColliderVolume::DetectCustomCollision
+	decVector linearVelocity( item.linearVelocity );
+	linearVelocity += item.gravity * elapsed;
+	
+	const decDVector displacement( linearVelocity * elapsed );
+	const decVector rotation( item.angularVelocity * elapsed );
+	if( displacement.LengthSquared() <= 1e-12 && rotation.LengthSquared() <= 1e-12f ){
+		return;
+	}
+	
+	const btQuaternion btorientation( ( btScalar )item.orientation.x, ( btScalar )item.orientation.y,
+		( btScalar )item.orientation.z, ( btScalar )item.orientation.w );
+	const decDVector &position = item.position;
+	
+	item.from.setRotation( btorientation );
+	item.from.setOrigin( btVector3( ( btScalar )position.x, ( btScalar )position.y, ( btScalar )position.z ) );
+	
+	item.to.setRotation( btorientation );
+	item.to.setOrigin( btVector3( ( btScalar )( position.x + displacement.x ),
+		( btScalar )( position.y + displacement.y ), ( btScalar )( position.z + displacement.z ) ) );
+		
+	if( item.hasAngularVelocity ){
+		const decQuaternion toOrientation( item.orientation * decQuaternion::CreateFromEuler( rotation ) );
+		item.to.setRotation( btQuaternion( ( btScalar )toOrientation.x, ( btScalar )toOrientation.y,
+			( btScalar )toOrientation.z, ( btScalar )toOrientation.w ) );
+	}
+	
+	item.sweep = item.sweepTest->GetShapeList().GetCount() > 0;
+}
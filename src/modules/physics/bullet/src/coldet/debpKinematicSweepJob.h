@@ -0,0 +1,131 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEBPKINEMATICSWEEPJOB_H_
+#define _DEBPKINEMATICSWEEPJOB_H_
+
+#include "debpParallelCollisionJob.h"
+
+#include "LinearMath/btTransform.h"
+
+#include <dragengine/common/math/decMath.h>
+
+class debpCollider;
+class debpColliderVolume;
+class debpSweepCollisionTest;
+class debpWorld;
+
+class btDbvtBroadphase;
+
+
+/**
+ * \brief Speculative kinematic collider sweep tests.
+ * 
+ * Sweeps kinematic colliders along their velocity in parallel using the world state at
+ * the beginning of the detection step. The sweeps stop at the first hit and check only
+ * collision filters. No scripting listeners are called.
+ * 
+ * The world applies the results in the same order colliders are processed serially. If a
+ * sweep found no hit and the collider state did not change since the sweep the collider
+ * is moved using debpColliderVolume::ApplyKinematicMove(). Otherwise the collider is
+ * processed using debpColliderVolume::DetectCustomCollision() which calls the scripting
+ * listeners.
+ * 
+ * Colliders moved using the speculative result do not see changes done earlier in the
+ * same step. This includes colliders moved by scripting listeners as well as colliders
+ * moved directly using their own speculative result. Two kinematic colliders moving
+ * into each other during the same step can thus pass through each other where serial
+ * processing would report a collision. This is the reason the parallel collision
+ * detection is opt-in.
+ */
+class debpKinematicSweepJob : public debpParallelCollisionJob{
+private:
+	/** \brief Collider to sweep. */
+	struct sItem{
+		debpColliderVolume *collider;
+		const debpSweepCollisionTest *sweepTest;
+		decDVector position;
+		decQuaternion orientation;
+		decVector linearVelocity;
+		decVector angularVelocity;
+		decVector gravity;
+		bool hasAngularVelocity;
+		btTransform from;
+		btTransform to;
+		bool sweep;
+		bool hasHit;
+	};
+	
+	debpWorld &pWorld;
+	const btDbvtBroadphase &pBroadphase;
+	sItem *pItems;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/**
+	 * \brief Create kinematic sweep job.
+	 * 
+	 * Stores the state of all kinematic volume colliders able to collide. Items are
+	 * indexed the same as \em colliders.
+	 */
+	debpKinematicSweepJob( debpWorld &world, debpCollider * const *colliders, int colliderCount, float elapsed );
+	
+protected:
+	/** \brief Clean up kinematic sweep job. */
+	virtual ~debpKinematicSweepJob();
+	/*@}*/
+	
+	
+	
+public:
+	/** \name Management */
+	/*@{*/
+	/** \brief Run sweep tests. */
+	void Process();
+	
+	/**
+	 * \brief Collider can be moved using the speculative result.
+	 * 
+	 * True if \em collider is the collider stored at \em index, the sweep found no hit
+	 * and the collider state did not change since the job has been created.
+	 */
+	bool CanApplyMove( int index, const debpCollider &collider ) const;
+	
+	/** \brief Short job name for debugging. */
+	virtual const char *GetDebugName() const;
+	/*@}*/
+	
+	
+	
+protected:
+	/** \brief Process colliders of chunk. */
+	virtual void ProcessChunk( int chunk, int firstItem, int itemCount, sThreadData &threadData );
+	
+	
+	
+private:
+	void pInitItem( sItem &item, debpCollider *collider, float elapsed );
+};
+
+#endif
@@ -0,0 +1,156 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "debpParallelCollisionJob.h"
+#include "parallel/debpPTParallelCollisionJob.h"
+#include "../dePhysicsBullet.h"
+
+#include <dragengine/deEngine.h>
+#include <dragengine/common/exceptions.h>
+#include <dragengine/common/math/decMath.h>
+#include <dragengine/parallel/deParallelProcessing.h>
+
+
+
+// Class debpParallelCollisionJob
+///////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+debpParallelCollisionJob::debpParallelCollisionJob( dePhysicsBullet &bullet, int itemCount, int chunkSize ) :
+pBullet( bullet ),
+pItemCount( decMath::max( itemCount, 0 ) ),
+pChunkSize( decMath::max( chunkSize, 1 ) ),
+pChunkCount( ( pItemCount + pChunkSize - 1 ) / pChunkSize ),
+pMaxTaskCount( -1 ),
+pNextChunk( 0 ),
+pActiveCount( 0 ),
+pWaiting( false ){
+}
+
+debpParallelCollisionJob::~debpParallelCollisionJob(){
+}
+
+
+
+// Management
+///////////////
+
+void debpParallelCollisionJob::SetMaxTaskCount( int maxTaskCount ){
+	pMaxTaskCount = decMath::max( maxTaskCount, -1 );
+}
+
+void debpParallelCollisionJob::Run( int minParallelItems ){
+	deParallelProcessing &parallel = pBullet.GetGameEngine()->GetParallelProcessing();
+	int taskCount = pItemCount < minParallelItems || parallel.GetPaused()
+		? 0 : decMath::min( parallel.GetCoreCount(), pChunkCount - 1 );
+	if( pMaxTaskCount != -1 ){
+		taskCount = decMath::min( taskCount, pMaxTaskCount );
+	}
+	
+	pNextChunk = 0;
+	pActiveCount = 0;
+	pWaiting = false;
+	
+	// tasks process chunks until none are left. the calling thread does the same and waits
+	// only for chunks already started by tasks. tasks starting after all chunks have been
+	// taken exit without touching the job data
+	int i;
+	
+	try{
+		for( i=0; i<taskCount; i++ ){
+			debpPTParallelCollisionJob * const task = new debpPTParallelCollisionJob( pBullet, *this );
+			parallel.AddTaskAsync( task );
+			task->FreeReference();
+		}
+		
+	}catch( const deException & ){
+		// tasks added so far can be running already. finish the work before failing
+		ProcessChunks();
+		pWaitActiveChunks();
+		throw;
+	}
+	
+	ProcessChunks();
+	pWaitActiveChunks();
+}
+
+void debpParallelCollisionJob::ProcessChunks(){
+	sThreadData threadData;
+	
+	while( true ){
+		pMutex.Lock();
+		
+		if( pNextChunk >= pChunkCount ){
+			pMutex.Unlock();
+			return;
+		}
+		
+		const int chunk = pNextChunk++;
+		pActiveCount++;
+		
+		pMutex.Unlock();
+		
+		const int firstItem = pChunkSize * chunk;
+		
+		try{
+			ProcessChunk( chunk, firstItem, decMath::min( pChunkSize, pItemCount - firstItem ), threadData );
+			
+		}catch( const deException & ){
+			pMutex.Lock();
+			pActiveCount--;
+			if( pActiveCount == 0 && pWaiting ){
+				pWaiting = false;
+				pSemaphore.Signal();
+			}
+			pMutex.Unlock();
+			throw;
+		}
+		
+		pMutex.Lock();
+		pActiveCount--;
+		if( pActiveCount == 0 && pWaiting ){
+			pWaiting = false;
+			pSemaphore.Signal();
+		}
+		pMutex.Unlock();
+	}
+}
+
+
+
+// Private Functions
+//////////////////////
+
+void debpParallelCollisionJob::pWaitActiveChunks(){
+	pMutex.Lock();
+	const bool wait = pActiveCount > 0;
+	pWaiting = wait;
+	pMutex.Unlock();
+	
+	if( wait ){
+		pSemaphore.Wait();
+	}
+}
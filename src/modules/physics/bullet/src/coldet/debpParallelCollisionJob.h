@@ -0,0 +1,144 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEBPPARALLELCOLLISIONJOB_H_
+#define _DEBPPARALLELCOLLISIONJOB_H_
+
+#include "LinearMath/btAlignedObjectArray.h"
+
+#include <dragengine/threading/deMutex.h>
+#include <dragengine/threading/deSemaphore.h>
+#include <dragengine/threading/deThreadSafeObject.h>
+
+class dePhysicsBullet;
+
+struct btDbvtNode;
+
+
+/**
+ * \brief Collision detection job split into chunks of items processed in parallel.
+ * 
+ * Chunks are processed by parallel tasks. The calling thread processes chunks too. It waits
+ * only for chunks started by parallel tasks to finish. This avoids blocking if all other
+ * threads are busy. Subclasses implement ProcessChunk() which has to be thread-safe and
+ * must not call scripting listeners. Results are applied by subclasses after Run() returned.
+ */
+class debpParallelCollisionJob : public deThreadSafeObject{
+public:
+	/**
+	 * \brief Per thread data.
+	 * 
+	 * Compound shapes are traversed while the broadphase is traversed. Both require
+	 * an own stack since the traversal resets the stack.
+	 */
+	struct sThreadData{
+		btAlignedObjectArray<const btDbvtNode*> broadphaseStack;
+		btAlignedObjectArray<const btDbvtNode*> shapeStack;
+	};
+	
+	
+	
+private:
+	dePhysicsBullet &pBullet;
+	const int pItemCount;
+	const int pChunkSize;
+	const int pChunkCount;
+	int pMaxTaskCount;
+	
+	deMutex pMutex;
+	deSemaphore pSemaphore;
+	int pNextChunk;
+	int pActiveCount;
+	bool pWaiting;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create job. */
+	debpParallelCollisionJob( dePhysicsBullet &bullet, int itemCount, int chunkSize );
+	
+protected:
+	/** \brief Clean up job. */
+	virtual ~debpParallelCollisionJob();
+	/*@}*/
+	
+	
+	
+public:
+	/** \name Management */
+	/*@{*/
+	/** \brief Bullet module. */
+	inline dePhysicsBullet &GetBullet() const{ return pBullet; }
+	
+	/** \brief Number of items. */
+	inline int GetItemCount() const{ return pItemCount; }
+	
+	/** \brief Number of items per chunk. */
+	inline int GetChunkSize() const{ return pChunkSize; }
+	
+	/** \brief Number of chunks. */
+	inline int GetChunkCount() const{ return pChunkCount; }
+	
+	/** \brief Maximum number of parallel tasks or -1 to use one task per core. */
+	inline int GetMaxTaskCount() const{ return pMaxTaskCount; }
+	
+	/** \brief Set maximum number of parallel tasks or -1 to use one task per core. */
+	void SetMaxTaskCount( int maxTaskCount );
+	
+	/**
+	 * \brief Process all chunks.
+	 * 
+	 * If at least \em minParallelItems items are present processing is split across
+	 * parallel tasks together with the calling thread. Otherwise all chunks are processed
+	 * on the calling thread.
+	 */
+	void Run( int minParallelItems );
+	
+	/**
+	 * \brief Process chunks until no chunks are left.
+	 * 
+	 * For use by parallel tasks only.
+	 */
+	void ProcessChunks();
+	
+	/** \brief Short job name for debugging. */
+	virtual const char *GetDebugName() const = 0;
+	/*@}*/
+	
+	
+	
+protected:
+	/**
+	 * \brief Process items of chunk.
+	 * 
+	 * Called from parallel tasks. Has to be thread-safe.
+	 */
+	virtual void ProcessChunk( int chunk, int firstItem, int itemCount, sThreadData &threadData ) = 0;
+	
+	
+	
+private:
+	void pWaitActiveChunks();
+};
+
+#endif
@@ -24,6 +24,7 @@
 
 #include "debpCollisionDetection.h"
 #include "debpSweepCollisionTest.h"
+#include "debpBulletShapeCollision.h"
 #include "../debpCollisionObject.h"
 #include "../debpGhostObject.h"
 #include "../debpPhysicsBody.h"
@@ -34,6 +35,8 @@
 #include "../collider/debpColliderBones.h"
 #include "../world/debpDelayedOperation.h"
 
+#include "BulletCollision/BroadphaseCollision/btDbvtBroadphase.h"
+#include "BulletCollision/CollisionDispatch/btCollisionObjectWrapper.h"
 #include "BulletCollision/CollisionShapes/btCollisionShape.h"
 #include "BulletCollision/CollisionShapes/btSphereShape.h"
 #include "BulletCollision/CollisionShapes/btConeShape.h"
@@ -43,6 +46,7 @@
 #include "BulletCollision/CollisionShapes/btConvexHullShape.h"
 #include "BulletCollision/CollisionDispatch/btGhostObject.h"
 #include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btTransformUtil.h"
 
 #include <dragengine/common/shape/decShapeBox.h>
 #include <dragengine/common/shape/decShapeSphere.h>
@@ -54,6 +58,51 @@
 
 
 
+// Structs
+////////////
+
+// broadphase leaf tester. same as SingleSweepCallback in debpCollisionWorld but using
+// the given stack for compound shape traversal
+struct debpSCTBroadphaseTester : public btDbvt::ICollide{
+	debpBulletShapeCollision &pShapeCollision;
+	const btConvexShape *pCastShape;
+	const btTransform &pFrom;
+	const btTransform &pTo;
+	btCollisionWorld::ConvexResultCallback &pResultCallback;
+	btAlignedObjectArray<const btDbvtNode*> &pStack;
+	
+	debpSCTBroadphaseTester( debpBulletShapeCollision &shapeCollision, const btConvexShape *castShape,
+	const btTransform &from, const btTransform &to, btCollisionWorld::ConvexResultCallback &resultCallback,
+	btAlignedObjectArray<const btDbvtNode*> &stack ) :
+	pShapeCollision( shapeCollision ),
+	pCastShape( castShape ),
+	pFrom( from ),
+	pTo( to ),
+	pResultCallback( resultCallback ),
+	pStack( stack ){
+	}
+	
+	virtual void Process( const btDbvtNode *leaf ){
+		if( pResultCallback.m_closestHitFraction == ( btScalar )0.0 ){
+			return;
+		}
+		
+		const btBroadphaseProxy &proxy = *( ( const btBroadphaseProxy* )leaf->data );
+		btCollisionObject * const collisionObject = ( btCollisionObject* )proxy.m_clientObject;
+		
+		if( ! pResultCallback.needsCollision( collisionObject->getBroadphaseHandle() ) ){
+			return;
+		}
+		
+		const btCollisionObjectWrapper wrapper( 0, collisionObject->getCollisionShape(),
+			collisionObject, collisionObject->getWorldTransform(), -1, -1 );
+		pShapeCollision.ShapeCast( pCastShape, pFrom, pTo, &wrapper, pResultCallback,
+			( btScalar )0.0, pStack );
+	}
+};
+
+
+
 // Class debpSweepCollisionTest::cShape
 /////////////////////////////////////////
 
@@ -126,6 +175,52 @@ const btTransform &to, debpCollisionWorld::ConvexResultCallback &resultCallback
 	}
 }
 
+void debpSweepCollisionTest::SweepTest( const btDbvtBroadphase &broadphase, const btTransform &from,
+const btTransform &to, debpCollisionWorld::ConvexResultCallback &resultCallback,
+btAlignedObjectArray<const btDbvtNode*> &broadphaseStack,
+btAlignedObjectArray<const btDbvtNode*> &shapeStack ) const{
+	debpBulletShapeCollision &shapeCollision = pColDet.GetBulletShapeCollision();
+	const btVector3 zeroLinVel( ( btScalar )0.0, ( btScalar )0.0, ( btScalar )0.0 );
+	const int count = pShapeList.GetCount();
+	int i, j;
+	
+	for( i=0; i<count; i++ ){
+		const cShape &shape = *( ( cShape* )pShapeList.GetAt( i ) );
+		const btTransform rfrom( from * shape.GetTransform() );
+		const btTransform rto( to * shape.GetTransform() );
+		
+		// same as debpCollisionWorld::convexSweepTest
+		btVector3 castShapeAabbMin;
+		btVector3 castShapeAabbMax;
+		btVector3 linVel, angVel;
+		btTransformUtil::calculateVelocity( rfrom, rto, 1.0f, linVel, angVel );
+		const btTransform R( rfrom.getBasis() );
+		shape.GetShape()->calculateTemporalAabb( R, zeroLinVel, angVel, 1.0f, castShapeAabbMin, castShapeAabbMax );
+		
+		const btVector3 unnormalizedRayDir( rto.getOrigin() - rfrom.getOrigin() );
+		const btVector3 rayDir( unnormalizedRayDir.normalized() );
+		const btVector3 rayDirectionInverse(
+			( rayDir[ 0 ] == ( btScalar )0.0 ) ? ( btScalar )BT_LARGE_FLOAT : ( ( btScalar )1.0 / rayDir[ 0 ] ),
+			( rayDir[ 1 ] == ( btScalar )0.0 ) ? ( btScalar )BT_LARGE_FLOAT : ( ( btScalar )1.0 / rayDir[ 1 ] ),
+			( rayDir[ 2 ] == ( btScalar )0.0 ) ? ( btScalar )BT_LARGE_FLOAT : ( ( btScalar )1.0 / rayDir[ 2 ] ) );
+		unsigned int signs[ 3 ] = {
+			rayDirectionInverse[ 0 ] < ( btScalar )0.0,
+			rayDirectionInverse[ 1 ] < ( btScalar )0.0,
+			rayDirectionInverse[ 2 ] < ( btScalar )0.0 };
+		const btScalar lambdaMax = rayDir.dot( unnormalizedRayDir );
+		
+		debpSCTBroadphaseTester tester( shapeCollision, shape.GetShape(), rfrom, rto,
+			resultCallback, shapeStack );
+			
+		for( j=0; j<2; j++ ){
+			const btDbvt &set = broadphase.m_sets[ j ];
+			set.rayTestInternal( set.m_root, rfrom.getOrigin(), rto.getOrigin(),
+				rayDirectionInverse, signs, lambdaMax, castShapeAabbMin, castShapeAabbMax,
+				broadphaseStack, tester );
+		}
+	}
+}
+
 void debpSweepCollisionTest::SweepTest( debpGhostObject &ghostObject, const btTransform &from,
 const btTransform &to, btCollisionWorld::ConvexResultCallback &resultCallback ){
 	if( ! ghostObject.GetGhostObject() ){
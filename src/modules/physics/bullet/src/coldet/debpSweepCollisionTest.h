@@ -35,7 +35,9 @@ class debpCollider;
 class debpGhostObject;
 class decShapeList;
 class btConvexShape;
+class btDbvtBroadphase;
 class btGhostObject;
+struct btDbvtNode;
 
 
 
@@ -113,6 +115,18 @@ public:
 	/** \brief Script callback safe sweep test for collision against collider. */
 	void SweepTest( debpCollider &collider, const btTransform &from, const btTransform &to,
 		debpCollisionWorld::ConvexResultCallback &resultCallback );
+		
+	/**
+	 * \brief Thread-safe sweep test for collision in a broadphase.
+	 * 
+	 * Traverses the broadphase using the given stacks instead of the shared broadphase
+	 * stack. Multiple threads can run tests at the same time as long as the world is not
+	 * modified and the result callback calls no scripting listeners.
+	 */
+	void SweepTest( const btDbvtBroadphase &broadphase, const btTransform &from, const btTransform &to,
+		debpCollisionWorld::ConvexResultCallback &resultCallback,
+		btAlignedObjectArray<const btDbvtNode*> &broadphaseStack,
+		btAlignedObjectArray<const btDbvtNode*> &shapeStack ) const;
 	/*@}*/
 	
 	
@@ -0,0 +1,78 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ * 
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "debpPTParallelCollisionJob.h"
+#include "../debpParallelCollisionJob.h"
+#include "../../dePhysicsBullet.h"
+
+#include <dragengine/common/exceptions.h>
+
+
+
+// Class debpPTParallelCollisionJob
+/////////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+debpPTParallelCollisionJob::debpPTParallelCollisionJob( dePhysicsBullet &bullet, debpParallelCollisionJob &job ) :
+deParallelTask( &bullet ),
+pJob( &job )
+{
+	SetMarkFinishedAfterRun( true );
+	job.AddReference();
+}
+
+debpPTParallelCollisionJob::~debpPTParallelCollisionJob(){
+	pJob->FreeReference();
+}
+
+
+
+// Management
+///////////////
+
+void debpPTParallelCollisionJob::Run(){
+	pJob->ProcessChunks();
+}
+
+void debpPTParallelCollisionJob::Finished(){
+}
+
+
+
+// Debugging
+//////////////
+
+decString debpPTParallelCollisionJob::GetDebugName() const{
+	return "Bullet-PTParallelCollisionJob";
+}
+
+decString debpPTParallelCollisionJob::GetDebugDetails() const{
+	decString details;
+	details.Format( "job=%s items=%d chunks=%d", pJob->GetDebugName(),
+		pJob->GetItemCount(), pJob->GetChunkCount() );
+	return details;
+}
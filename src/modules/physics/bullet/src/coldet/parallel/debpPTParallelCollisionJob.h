@@ -0,0 +1,75 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ * 
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEBPPTPARALLELCOLLISIONJOB_H_
+#define _DEBPPTPARALLELCOLLISIONJOB_H_
+
+#include <dragengine/parallel/deParallelTask.h>
+
+class dePhysicsBullet;
+class debpParallelCollisionJob;
+
+
+/**
+ * \brief Parallel task processing parallel collision job chunks.
+ */
+class debpPTParallelCollisionJob : public deParallelTask{
+private:
+	debpParallelCollisionJob *pJob;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create task. */
+	debpPTParallelCollisionJob( dePhysicsBullet &bullet, debpParallelCollisionJob &job );
+	
+protected:
+	/** \brief Clean up task. */
+	virtual ~debpPTParallelCollisionJob();
+	/*@}*/
+	
+	
+	
+public:
+	/** \name Management */
+	/*@{*/
+	/** \brief Parallel task implementation. */
+	virtual void Run();
+	
+	/** \brief Processing of task Run() finished. */
+	virtual void Finished();
+	/*@}*/
+	
+	
+	
+	/** \name Debugging */
+	/*@{*/
+	/** \brief Short task name for debugging. */
+	virtual decString GetDebugName() const;
+	
+	/** \brief Task details for debugging. */
+	virtual decString GetDebugDetails() const;
+	/*@}*/
+};
+
+#endif
@@ -70,6 +70,7 @@ pCollider( collider )
 	
 	pParentWorld = NULL;
 	pIndex = -1;
+	pChangeRevision = 0;
 	
 	pAttachments = NULL;
 	pAttachmentCount = 0;
@@ -251,6 +252,7 @@ void debpCollider::MarkMatrixDirty(){
 
 void debpCollider::MarkDirtyOctree(){
 	pDirtyOctree = true;
+	pChangeRevision++;
 	RegisterUpdateOctree();
 	
 	if( pParentWorld ){
@@ -868,9 +870,7 @@ void debpCollider::pRemoveFromAllTrackingTouchSensors(){
 	int i;
 	
 	for( i=0; i< count; i++ ){
-		debpTouchSensor &touchSensor = *( ( debpTouchSensor* )pTrackingTouchSensors.GetAt( i ) );
-		touchSensor.GetLeavingColliders().RemoveIfPresent( this );
-		touchSensor.GetTouchingColliders().RemoveIfPresent( this );
+		( ( debpTouchSensor* )pTrackingTouchSensors.GetAt( i ) )->RemoveCollider( this );
 	}
 	
 	pTrackingTouchSensors.RemoveAll();
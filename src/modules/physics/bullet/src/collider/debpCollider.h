@@ -83,6 +83,7 @@ private:
 	decPointerSet pTrackingTouchSensors;
 	
 	int pIndex;
+	int pChangeRevision;
 	bool pIsMoving;
 	bool pDirtyMatrix;
 	bool pDirtyOctree;
@@ -159,6 +160,13 @@ public:
 	void MarkMatrixDirty();
 	void MarkDirtyOctree();
 	
+	/**
+	 * \brief Change revision.
+	 * \details Incremented each time the octree is marked dirty. Used by touch sensors
+	 *          to reuse test results of colliders not changed since the last test.
+	 */
+	inline int GetChangeRevision() const{ return pChangeRevision; }
+	
 	/** \brief Two collider can collide. */
 	bool Collides( const debpCollider &collider ) const;
 	
@@ -76,15 +76,20 @@ void debpColliderCollisionTest::Update(){
 		return;
 	}
 	
-	const deCollider &parentCollider = pParentCollider.GetCollider();
-	const decQuaternion &orientation = parentCollider.GetOrientation();
+	decDVector position;
+	decVector direction;
+	PrepareTest( position, direction );
+	RunTest( position, direction );
+}
+
+void debpColliderCollisionTest::PrepareTest( decDVector &position, decVector &direction ){
 	const decDMatrix &matrix = pParentCollider.GetMatrix();
 	
 	// cast position altered by bone if existing. for the time being this is just
 	// done by preparing the matrices in the parent collider component if existing.
 	// this will be optimized later
-	decDVector position( pCollisionTest.GetOrigin() );
-	decVector direction( pCollisionTest.GetDirection() );
+	position = pCollisionTest.GetOrigin();
+	direction = pCollisionTest.GetDirection();
 	
 	if( ! pCollisionTest.GetBone().IsEmpty() ){
 		deComponent * const component = pCollisionTest.GetComponent();
@@ -122,10 +127,13 @@ void debpColliderCollisionTest::Update(){
 	pCollisionTest.SetTestOrigin( position );
 	pCollisionTest.SetTestDirection( direction );
 	
+	pCollisionInfoCount = 0;
+}
+
+void debpColliderCollisionTest::RunTest( const decDVector &position, const decVector &direction ){
 	// test collision and store the result
 	deCollider * const collider = pCollisionTest.GetCollider();
-	
-	pCollisionInfoCount = 0;
+	const decQuaternion &orientation = pParentCollider.GetCollider().GetOrientation();
 	
 	if( collider ){
 		if( direction.IsZero() ){
@@ -157,6 +165,19 @@ void debpColliderCollisionTest::SetCollisionTestResult(){
 
 
 
+bool debpColliderCollisionTest::IgnoresCollider( deCollider *collider ) const{
+	// no collision with parent collider
+	const deCollider &parentCollider = pParentCollider.GetCollider();
+	if( collider == &parentCollider ){
+		return true;
+	}
+	
+	// no collision with ignore colliders in the parent collider
+	return parentCollider.HasIgnoreCollider( collider );
+}
+
+
+
 void debpColliderCollisionTest::Reset(){
 	pCollisionInfoCount = 0;
 	pSortByDistance = false;
@@ -389,19 +410,12 @@ void debpColliderCollisionTest::CollisionResponse( deCollider *owner, deCollisio
 }
 
 bool debpColliderCollisionTest::CanHitCollider( deCollider *owner, deCollider *collider ){
-	// no collision with parent collider
-	deCollider * const parentCollider = &pParentCollider.GetCollider();
-	if( collider == parentCollider ){
-		return false;
-	}
-	
-	// no collision with ignore colliders in the parent collider
-	if( parentCollider->HasIgnoreCollider( collider ) ){
+	if( IgnoresCollider( collider ) ){
 		return false;
 	}
 	
 	// otherwise ask parent collider collision listener
-	deBaseScriptingCollider * const listener = parentCollider->GetPeerScripting();
+	deBaseScriptingCollider * const listener = pParentCollider.GetCollider().GetPeerScripting();
 	if( listener ){
 		return listener->CanHitCollider( NULL, collider );
 	}
@@ -69,9 +69,38 @@ public:
 	/** \brief Update collision test. */
 	void Update();
 	
+	/**
+	 * \brief Calculate test origin and direction in world space and reset result.
+	 * 
+	 * First part of Update(). Stores the used parameters in the collider collision test.
+	 */
+	void PrepareTest( decDVector &position, decVector &direction );
+	
+	/**
+	 * \brief Test collision using prepared test origin and direction and store the result.
+	 * 
+	 * Second part of Update().
+	 */
+	void RunTest( const decDVector &position, const decVector &direction );
+	
 	/** \brief Set collider collision test to test result. */
 	void SetCollisionTestResult();
 	
+	/** \brief Sort collisions by distance. */
+	inline bool GetSortByDistance() const{ return pSortByDistance; }
+	
+	/** \brief Set if collisions are sorted by distance. */
+	inline void SetSortByDistance( bool sortByDistance ){ pSortByDistance = sortByDistance; }
+	
+	/**
+	 * \brief Collider is never hit.
+	 * 
+	 * True for the parent collider and colliders ignored by the parent collider. Part of
+	 * CanHitCollider() without asking the scripting listener. Safe to call from parallel
+	 * tasks as long as the parent collider is not modified.
+	 */
+	bool IgnoresCollider( deCollider *collider ) const;
+	
 	
 	
 	/** \brief Reset collision result. */
@@ -351,6 +351,17 @@ void debpColliderVolume::ApplyFakeDynamicResponse( deCollisionInfo &colinfo ){
 	pLinVelo *= 0.95f; // some damping
 }
 
+void debpColliderVolume::ApplyKinematicMove( float elapsed ){
+	ApplyGravity( elapsed );
+	PredictDisplacement( elapsed );
+	
+	if( decDVector( pPredictDisp ).LengthSquared() <= 1e-12 && pPredictRot.LengthSquared() <= 1e-12f ){
+		return;
+	}
+	
+	ApplyDisplacement();
+}
+
 
 #include "debpColliderComponent.h"
 void debpColliderVolume::DetectCustomCollision( float elapsed ){
@@ -101,6 +101,12 @@ public:
 	inline const decVector &GetGravity() const{ return pGravity; }
 	/** Retrieves the linear velocity. */
 	inline const decVector &GetLinearVelocity() const{ return pLinVelo; }
+	/** Retrieves the angular velocity. */
+	inline const decVector &GetAngularVelocity() const{ return pAngVelo; }
+	/** Determines if the angular velocity is large enough to rotate the collider. */
+	inline bool GetHasAngularVelocity() const{ return pHasAngVelo; }
+	/** Determines if the sweep collision test has to be updated. */
+	inline bool GetDirtySweepTest() const{ return pDirtySweepTest; }
 	
 	/** \brief Mark shapes dirty. */
 	void DirtyBPShape();
@@ -118,6 +124,11 @@ public:
 	void ApplyDisplacement();
 	/** Apply fake dynamics response. */
 	void ApplyFakeDynamicResponse( deCollisionInfo &colinfo );
+	/**
+	 * Move kinematic collider without collision. Same as DetectCustomCollision if the
+	 * sweep test finds no collision. Used if the sweep test has been done in parallel.
+	 */
+	void ApplyKinematicMove( float elapsed );
 	
 	/** Updates shapes with the current matirx. */
 	virtual void UpdateShapes();
@@ -23,6 +23,7 @@
 #include <stdlib.h>
 
 #include "debpModel.h"
+#include "debpModelBVH.h"
 #include "debpComponent.h"
 #include "../dePhysicsBullet.h"
 #include "../coldet/collision/debpDCollisionVolume.h"
@@ -61,21 +62,18 @@ pBullet( bullet ),
 pComponent( component ),
 pIndex( -1 ),
 pDirtyModel( true ),
-pDirtyMesh( true ),
 pDirtyExtends( true ),
 pDirtyBoneWeights(  true ),
-pDirtyWeights(  true ),
 pEnabled( false ),
 
 pBones( NULL ),
 pBoneCount( 0 ),
 pModel( NULL ),
 
+pBVH( NULL ),
+pDirtyBVH( true ),
+
 pDirtyModelRigMappings( true ),
-pVertices( NULL ),
-pWeights( NULL ),
-pVertexCount( 0 ),
-pWeightsCount( 0 ),
 
 pLinkedCollider( NULL )
 {
@@ -168,9 +166,7 @@ void debpComponent::ModelChanged(){
 	SetAllBoneDirty();
 	
 	pDirtyModel = true;
-	pDirtyMesh = true;
 	pDirtyBoneWeights = true;
-	pDirtyWeights = true;
 	
 	pModel = NULL;
 	if( pComponent->GetModel() ){
@@ -187,7 +183,6 @@ void debpComponent::ModelChanged(){
 
 void debpComponent::RigChanged(){
 	pRebuildBoneArrays();
-	pDirtyMesh = true;
 	
 	pUpdateModelRigMappings();
 	
@@ -205,8 +200,7 @@ void debpComponent::ExtendsChanged(){
 
 void debpComponent::MeshDirty(){
 	SetAllBoneDirty();
-	
-	pDirtyMesh = true;
+	pDirtyBVH = true;
 	
 	if( pLinkedCollider ){
 		pLinkedCollider->ComponentMeshDirty();
@@ -252,32 +246,28 @@ void debpComponent::FindDecalsTouching( decShape *shape, deDecalList &list ){
 
 
 void debpComponent::PrepareMesh(){
-	if( ! pDirtyMesh ){
-		return;
-	}
-	if( ! pComponent->GetModel() || ! pComponent->GetRig() ){
-		pDirtyMesh = false;
+	pComponent->PrepareSkinnedVertices( deComponent::esrPhysics );
+}
+
+void debpComponent::PrepareBVH(){
+	PrepareMesh();
+	
+	if( ! pModel ){
 		return;
 	}
 	
-	PrepareWeights();
-	
-	const deModelLOD &lod = *pComponent->GetModel()->GetLODAt( 0 );
-	int i;
+	if( ! pBVH ){
+		pModel->PrepareBVH();
+		pBVH = new debpModelBVH( *pModel->GetBVH() );
+		pDirtyBVH = true;
+	}
 	
-	for( i=0; i<pVertexCount; i++ ){
-		const deModelVertex &vertex = lod.GetVertexAt( i );
-		const int weightSet = vertex.GetWeightSet();
-		
-		if( weightSet == -1 ){
-			pVertices[ i ] = vertex.GetPosition();
-			
-		}else{
-			pVertices[ i ] = pWeights[ weightSet ] * vertex.GetPosition();
-		}
+	if( ! pDirtyBVH ){
+		return;
 	}
 	
-	pDirtyMesh = false;
+	pBVH->Refit( *pModel->GetModel().GetLODAt( 0 ), pComponent->GetSkinnedVertices() );
+	pDirtyBVH = false;
 }
 
 void debpComponent::PrepareExtends(){
@@ -383,66 +373,7 @@ void debpComponent::PrepareExtends(){
 }
 
 void debpComponent::PrepareWeights(){
-	if( ! pDirtyWeights ){
-		return;
-	}
-	
-	const deRig * const rig = pComponent->GetRig();
-	if( ! rig ){
-		pDirtyWeights = false;
-		return;
-	}
-	
-	PrepareBoneWeights();
-	
-	// calculate weights matrices
-	const debpModel::sWeightSet * const groups = pModel->GetWeightSets();
-	const int groupCount = pModel->GetWeightSetCount();
-	int i;
-	
-	for( i=0; i<groupCount; i++ ){
-		const int count = groups[ i ].count;
-		
-		if( count == 1 ){
-			const int bone = pModelRigMappings.GetAt( groups[ i ].first[ 0 ].GetBone() );
-			
-			if( bone == -1 ){
-				pWeights[ i ].SetIdentity();
-				
-			}else{
-				pWeights[ i ] = pBones[ bone ].weightMatrix;
-			}
-			
-		}else{
-			const int bone = pModelRigMappings.GetAt( groups[ i ].first[ 0 ].GetBone() );
-			const float value = groups[ i ].first[ 0 ].GetWeight();
-			int b;
-			
-			if( bone == -1 ){
-				pWeights[ i ].SetScale( value, value, value );
-				
-			}else{
-				pWeights[ i ] = pBones[ bone ].weightMatrix.QuickMultiply( value );
-			}
-			
-			for( b=1; b<count; b++ ){
-				const deModelWeight &weight = groups[ i ].first[ b ];
-				const int bone2 = pModelRigMappings.GetAt( weight.GetBone() );
-				const float value2 = weight.GetWeight();
-				
-				if( bone2 == -1 ){
-					pWeights[ i ].a11 += value2;
-					pWeights[ i ].a22 += value2;
-					pWeights[ i ].a33 += value2;
-					
-				}else{
-					pWeights[ i ].QuickAddTo( pBones[ bone2 ].weightMatrix.QuickMultiply( value2 ) );
-				}
-			}
-		}
-	}
-	
-	pDirtyWeights = false;
+	pComponent->PrepareSkinnedWeights();
 }
 
 void debpComponent::PrepareBoneWeights(){
@@ -470,17 +401,11 @@ void debpComponent::PrepareBoneWeights(){
 
 
 const decMatrix &debpComponent::GetWeights( int index ) const{
-	if( index < 0 || index >= pWeightsCount ){
-		DETHROW( deeOutOfBoundary );
-	}
-	return pWeights[ index ];
+	return pComponent->GetSkinnedWeightAt( index );
 }
 
 const decVector &debpComponent::GetVertex( int index ) const{
-	if( index < 0 || index >= pVertexCount ){
-		DETHROW( deeOutOfBoundary );
-	}
-	return pVertices[ index ];
+	return pComponent->GetSkinnedVertexAt( index );
 }
 
 
@@ -495,12 +420,7 @@ void debpComponent::pCleanUp(){
 	if( pBones ){
 		delete [] pBones;
 	}
-	if( pVertices ){
-		delete [] pVertices;
-	}
-	if( pWeights ){
-		delete [] pWeights;
-	}
+	pFreeBVH();
 }
 
 void debpComponent::pRebuildBoneArrays(){
@@ -522,19 +442,8 @@ void debpComponent::pRebuildBoneArrays(){
 }
 
 void debpComponent::pChangeModel(){
-	if( pVertices ){
-		delete [] pVertices;
-		pVertices = NULL;
-		pVertexCount = 0;
-	}
-	
-	if( pWeights ){
-		delete [] pWeights;
-		pWeights = NULL;
-		pWeightsCount = 0;
-	}
-	
 	pModelRigMappings.RemoveAll();
+	pFreeBVH();
 	
 	pMinExtend.SetZero();
 	pMaxExtend.SetZero();
@@ -544,19 +453,7 @@ void debpComponent::pChangeModel(){
 		return;
 	}
 	
-	int count = model->GetLODAt( 0 )->GetVertexCount();
-	if( count > 0 ){
-		pVertices = new decVector[ count ];
-		pVertexCount = count;
-	}
-	
-	count = pModel->GetWeightSetCount();
-	if( count > 0 ){
-		pWeights = new decMatrix[ count ];
-		pWeightsCount = count;
-	}
-	
-	count = model->GetBoneCount();
+	const int count = model->GetBoneCount();
 	while( pModelRigMappings.GetCount() < count ){
 		pModelRigMappings.Add( -1 );
 	}
@@ -565,6 +462,14 @@ void debpComponent::pChangeModel(){
 	pMaxExtend = pModel->GetExtends().maximum;
 }
 
+void debpComponent::pFreeBVH(){
+	if( pBVH ){
+		delete pBVH;
+		pBVH = NULL;
+	}
+	pDirtyBVH = true;
+}
+
 void debpComponent::pUpdateModelRigMappings(){
 	const deModel * const model = pComponent->GetModel();
 	const deRig * const rig = pComponent->GetRig();
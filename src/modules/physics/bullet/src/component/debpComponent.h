@@ -31,6 +31,7 @@ class deComponent;
 class debpWorld;
 class debpColliderComponent;
 class debpModel;
+class debpModelBVH;
 
 
 
@@ -54,22 +55,19 @@ private:
 	decVector pMaxExtend;
 	int pIndex;
 	bool pDirtyModel;
-	bool pDirtyMesh;
 	bool pDirtyExtends;
 	bool pDirtyBoneWeights;
-	bool pDirtyWeights;
 	bool pEnabled;
 	
 	sBone *pBones;
 	int pBoneCount;
 	debpModel *pModel;
 	
+	debpModelBVH *pBVH;
+	bool pDirtyBVH;
+	
 	decIntList pModelRigMappings;
 	bool pDirtyModelRigMappings;
-	decVector *pVertices;
-	decMatrix *pWeights;
-	int pVertexCount;
-	int pWeightsCount;
 	
 	debpColliderComponent *pLinkedCollider;
 	
@@ -113,16 +111,35 @@ public:
 	/** \brief Model or NULL. */
 	inline debpModel *GetModel() const{ return pModel; }
 	
-	/** \brief Prepare mesh. */
+	/**
+	 * \brief Prepare mesh.
+	 * 
+	 * Uses the skinned vertices shared by all modules on the component resource.
+	 */
 	void PrepareMesh();
 	
 	/** \brief Prepare extends. */
 	void PrepareExtends();
 	
+	/** \brief Face BVH refitted to the skinned vertices or \em NULL if not prepared. */
+	inline debpModelBVH *GetBVH() const{ return pBVH; }
+	
+	/**
+	 * \brief Prepare face BVH refitted to the skinned vertices if dirty.
+	 * 
+	 * Copies the BVH of the model the first time and refits it each time the mesh
+	 * changed. Prepares the mesh.
+	 */
+	void PrepareBVH();
+	
 	/** \brief Prepare bone weights. */
 	void PrepareBoneWeights();
 	
-	/** \brief Prepare weights. */
+	/**
+	 * \brief Prepare weights.
+	 * 
+	 * Uses the skinned weights shared by all modules on the component resource.
+	 */
 	void PrepareWeights();
 	
 	/** \brief Weights at index. */
@@ -220,6 +237,7 @@ private:
 	void pCleanUp();
 	void pRebuildBoneArrays();
 	void pChangeModel();
+	void pFreeBVH();
 	void pUpdateModelRigMappings();
 	void pPrepareBone( int index );
 };
@@ -24,6 +24,7 @@
 
 #include "debpBulletShapeModel.h"
 #include "debpModel.h"
+#include "debpModelBVH.h"
 #include "debpModelOctree.h"
 #include "../dePhysicsBullet.h"
 #include "../coldet/octree/debpDefaultDOctree.h"
@@ -53,6 +54,7 @@ pBullet( bullet ),
 pModel( model ),
 
 pOctree( NULL ),
+pBVH( NULL ),
 pCanDeform( false ),
 
 pWeightSets( NULL ),
@@ -120,6 +122,25 @@ void debpModel::PrepareOctree(){
 	}
 }
 
+void debpModel::PrepareBVH(){
+	if( pBVH ){
+		return;
+	}
+	
+	// NOTE if model data has been released RetainModelData() is required to be called first
+	
+	pBVH = new debpModelBVH;
+	
+	try{
+		pBVH->Build( *pModel.GetLODAt( 0 ) );
+		
+	}catch( const deException & ){
+		delete pBVH;
+		pBVH = NULL;
+		throw;
+	}
+}
+
 void debpModel::PrepareNormals(){
 	if( pNormals ){
 		return;
@@ -300,6 +321,9 @@ void debpModel::pCleanUp(){
 	if( pWeightSets ){
 		delete [] pWeightSets;
 	}
+	if( pBVH ){
+		delete pBVH;
+	}
 	if( pOctree ){
 		delete pOctree;
 	}
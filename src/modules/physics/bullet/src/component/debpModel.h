@@ -29,6 +29,7 @@
 class deModel;
 class deModelWeight;
 class debpModelOctree;
+class debpModelBVH;
 class dePhysicsBullet;
 class debpBulletShapeModel;
 
@@ -37,8 +38,8 @@ class debpBulletShapeModel;
  * \brief Bullet Physics Model Peer
  * 
  * The peer for model resources in the ODE Physics Module. The main
- * purpose of this class is to provide an octree of faces for quick
- * collision detection if the model is a simple model. Complex models
+ * purpose of this class is to provide a bounding volume hierarchy of
+ * faces for quick collision detection if the model is a simple model. Complex models
  * have to be stored inside the Component Peer. Simple models are
  * much quicker as they do not change over time. A model is considered
  * simple if it has no weights that could influence the vertices.
@@ -62,6 +63,7 @@ private:
 	deModel &pModel;
 	
 	debpModelOctree *pOctree;
+	debpModelBVH *pBVH;
 	bool pCanDeform;
 	
 	sWeightSet *pWeightSets;
@@ -104,6 +106,12 @@ public:
 	/** \brief Prepare octree if not ready yet. */
 	void PrepareOctree();
 	
+	/** \brief Face BVH or \em NULL if not prepared. */
+	inline debpModelBVH *GetBVH() const{ return pBVH; }
+	
+	/** \brief Prepare face BVH if not ready yet. */
+	void PrepareBVH();
+	
 	
 	
 	/** \brief Weight sets. */
@@ -0,0 +1,590 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "debpModelBVH.h"
+#include "debpModelBVHVisitor.h"
+
+#include <dragengine/common/exceptions.h>
+#include <dragengine/resources/model/deModelFace.h>
+#include <dragengine/resources/model/deModelLOD.h>
+#include <dragengine/resources/model/deModelVertex.h>
+
+
+
+// Definitions
+////////////////
+
+// number of bins used to evaluate the surface area heuristic
+#define BIN_COUNT 12
+
+// nodes with this number of faces or less always become leaf nodes
+#define LEAF_FACES 2
+
+// nodes with this number of faces or less become leaf nodes if splitting is not cheaper
+#define MAX_LEAF_FACES 8
+
+
+
+// Local functions
+////////////////////
+
+struct sSweepRay{
+	decVector origin;
+	decVector halfSize;
+	decVector inverse;
+	bool parallelX;
+	bool parallelY;
+	bool parallelZ;
+};
+
+static inline float vAxis( const decVector &vector, int axis ){
+	return axis == 0 ? vector.x : ( axis == 1 ? vector.y : vector.z );
+}
+
+static inline float vHalfArea( const decVector &minExtend, const decVector &maxExtend ){
+	const decVector size( maxExtend - minExtend );
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+static inline int vBinIndex( float value, float splitMin, float splitScale ){
+	const int bin = ( int )( ( value - splitMin ) * splitScale );
+	return bin < 0 ? 0 : ( bin < BIN_COUNT ? bin : BIN_COUNT - 1 );
+}
+
+static inline bool vSlab( float origin, float inverse, bool parallel,
+float minExtend, float maxExtend, float &tmin, float &tmax ){
+	if( parallel ){
+		return origin >= minExtend && origin <= maxExtend;
+	}
+	
+	float t1 = ( minExtend - origin ) * inverse;
+	float t2 = ( maxExtend - origin ) * inverse;
+	if( t1 > t2 ){
+		const float swap = t1;
+		t1 = t2;
+		t2 = swap;
+	}
+	
+	if( t1 > tmin ){
+		tmin = t1;
+	}
+	if( t2 < tmax ){
+		tmax = t2;
+	}
+	return tmin <= tmax;
+}
+
+static bool vSweepHitsNode( const sSweepRay &ray, const debpModelBVH::sNode &node, float &distance ){
+	float tmin = 0.0f;
+	float tmax = 1.0f;
+	
+	if( ! vSlab( ray.origin.x, ray.inverse.x, ray.parallelX, node.minExtend.x - ray.halfSize.x,
+	node.maxExtend.x + ray.halfSize.x, tmin, tmax ) ){
+		return false;
+	}
+	if( ! vSlab( ray.origin.y, ray.inverse.y, ray.parallelY, node.minExtend.y - ray.halfSize.y,
+	node.maxExtend.y + ray.halfSize.y, tmin, tmax ) ){
+		return false;
+	}
+	if( ! vSlab( ray.origin.z, ray.inverse.z, ray.parallelZ, node.minExtend.z - ray.halfSize.z,
+	node.maxExtend.z + ray.halfSize.z, tmin, tmax ) ){
+		return false;
+	}
+	
+	distance = tmin;
+	return true;
+}
+
+
+
+// Class debpModelBVH
+///////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+debpModelBVH::debpModelBVH() :
+pNodes( NULL ),
+pNodeCount( 0 ),
+pFaces( NULL ),
+pFaceCount( 0 ),
+pDepth( 0 ){
+}
+
+debpModelBVH::debpModelBVH( const debpModelBVH &bvh ) :
+pNodes( NULL ),
+pNodeCount( 0 ),
+pFaces( NULL ),
+pFaceCount( 0 ),
+pDepth( bvh.pDepth )
+{
+	int i;
+	
+	try{
+		if( bvh.pNodeCount > 0 ){
+			pNodes = new sNode[ bvh.pNodeCount ];
+			for( i=0; i<bvh.pNodeCount; i++ ){
+				pNodes[ i ] = bvh.pNodes[ i ];
+			}
+			pNodeCount = bvh.pNodeCount;
+		}
+		
+		if( bvh.pFaceCount > 0 ){
+			pFaces = new int[ bvh.pFaceCount ];
+			for( i=0; i<bvh.pFaceCount; i++ ){
+				pFaces[ i ] = bvh.pFaces[ i ];
+			}
+			pFaceCount = bvh.pFaceCount;
+		}
+		
+	}catch( const deException & ){
+		if( pNodes ){
+			delete [] pNodes;
+		}
+		throw;
+	}
+}
+
+debpModelBVH::~debpModelBVH(){
+	if( pFaces ){
+		delete [] pFaces;
+	}
+	if( pNodes ){
+		delete [] pNodes;
+	}
+}
+
+
+
+// Management
+///////////////
+
+void debpModelBVH::Build( const deModelLOD &lod ){
+	if( pFaces ){
+		delete [] pFaces;
+		pFaces = NULL;
+		pFaceCount = 0;
+	}
+	if( pNodes ){
+		delete [] pNodes;
+		pNodes = NULL;
+		pNodeCount = 0;
+	}
+	pDepth = 0;
+	
+	const int faceCount = lod.GetFaceCount();
+	if( faceCount == 0 ){
+		return;
+	}
+	
+	const deModelVertex * const vertices = lod.GetVertices();
+	const deModelFace * const faces = lod.GetFaces();
+	sBuildFace *buildFaces = NULL;
+	int i;
+	
+	try{
+		buildFaces = new sBuildFace[ faceCount ];
+		for( i=0; i<faceCount; i++ ){
+			const decVector &p1 = vertices[ faces[ i ].GetVertex1() ].GetPosition();
+			const decVector &p2 = vertices[ faces[ i ].GetVertex2() ].GetPosition();
+			const decVector &p3 = vertices[ faces[ i ].GetVertex3() ].GetPosition();
+			sBuildFace &buildFace = buildFaces[ i ];
+			
+			buildFace.minExtend = p1.Smallest( p2 ).Smallest( p3 );
+			buildFace.maxExtend = p1.Largest( p2 ).Largest( p3 );
+			buildFace.center = ( buildFace.minExtend + buildFace.maxExtend ) * 0.5f;
+		}
+		
+		pFaces = new int[ faceCount ];
+		for( pFaceCount=0; pFaceCount<faceCount; pFaceCount++ ){
+			pFaces[ pFaceCount ] = pFaceCount;
+		}
+		
+		// every split creates two non-empty children hence there are at most 2n-1 nodes
+		pNodes = new sNode[ faceCount * 2 - 1 ];
+		pNodeCount = 1;
+		pBuildNode( 0, 0, faceCount, 1, buildFaces );
+		
+		delete [] buildFaces;
+		
+	}catch( const deException & ){
+		if( buildFaces ){
+			delete [] buildFaces;
+		}
+		throw;
+	}
+}
+
+void debpModelBVH::Refit( const deModelLOD &lod, const decVector *positions ){
+	if( lod.GetFaceCount() != pFaceCount ){
+		DETHROW( deeInvalidParam );
+	}
+	if( pFaceCount == 0 ){
+		return;
+	}
+	if( ! positions ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	const deModelFace * const faces = lod.GetFaces();
+	int i, j;
+	
+	// children are always stored after their parent so processing nodes in reverse
+	// order visits children before their parent
+	for( i=pNodeCount-1; i>=0; i-- ){
+		sNode &node = pNodes[ i ];
+		
+		if( node.faceCount > 0 ){
+			const int * const nodeFaces = pFaces + node.first;
+			
+			for( j=0; j<node.faceCount; j++ ){
+				const deModelFace &face = faces[ nodeFaces[ j ] ];
+				const decVector &p1 = positions[ face.GetVertex1() ];
+				const decVector &p2 = positions[ face.GetVertex2() ];
+				const decVector &p3 = positions[ face.GetVertex3() ];
+				
+				if( j == 0 ){
+					node.minExtend = p1.Smallest( p2 ).Smallest( p3 );
+					node.maxExtend = p1.Largest( p2 ).Largest( p3 );
+					
+				}else{
+					node.minExtend.SetSmallest( p1.Smallest( p2 ).Smallest( p3 ) );
+					node.maxExtend.SetLargest( p1.Largest( p2 ).Largest( p3 ) );
+				}
+			}
+			
+		}else{
+			const sNode &child1 = pNodes[ node.first ];
+			const sNode &child2 = pNodes[ node.first + 1 ];
+			node.minExtend = child1.minExtend.Smallest( child2.minExtend );
+			node.maxExtend = child1.maxExtend.Largest( child2.maxExtend );
+		}
+	}
+}
+
+
+
+// Visiting
+/////////////
+
+bool debpModelBVH::VisitFacesOverlapping( const decVector &minExtend,
+const decVector &maxExtend, debpModelBVHVisitor &visitor ) const{
+	if( pNodeCount == 0 ){
+		return true;
+	}
+	
+	int stack[ MaxDepth + 2 ];
+	int stackSize = 1;
+	int i;
+	
+	stack[ 0 ] = 0;
+	
+	while( stackSize > 0 ){
+		const sNode &node = pNodes[ stack[ --stackSize ] ];
+		
+		if( node.maxExtend.x < minExtend.x || node.minExtend.x > maxExtend.x
+		|| node.maxExtend.y < minExtend.y || node.minExtend.y > maxExtend.y
+		|| node.maxExtend.z < minExtend.z || node.minExtend.z > maxExtend.z ){
+			continue;
+		}
+		
+		if( node.faceCount > 0 ){
+			const int * const faces = pFaces + node.first;
+			for( i=0; i<node.faceCount; i++ ){
+				if( ! visitor.VisitFace( faces[ i ] ) ){
+					return false;
+				}
+			}
+			
+		}else{
+			stack[ stackSize++ ] = node.first + 1;
+			stack[ stackSize++ ] = node.first;
+		}
+	}
+	
+	return true;
+}
+
+bool debpModelBVH::VisitFacesAlongRay( const decVector &origin, const decVector &displacement,
+debpModelBVHVisitor &visitor ) const{
+	return pVisitSwept( origin, decVector(), displacement, visitor );
+}
+
+bool debpModelBVH::VisitFacesSwept( const decVector &minExtend, const decVector &maxExtend,
+const decVector &displacement, debpModelBVHVisitor &visitor ) const{
+	return pVisitSwept( ( minExtend + maxExtend ) * 0.5f, ( maxExtend - minExtend ) * 0.5f,
+		displacement, visitor );
+}
+
+
+
+// Private Functions
+//////////////////////
+
+void debpModelBVH::pBuildNode( int nodeIndex, int first, int count, int depth,
+const sBuildFace *buildFaces ){
+	sNode &node = pNodes[ nodeIndex ];
+	int i;
+	
+	const sBuildFace &firstFace = buildFaces[ pFaces[ first ] ];
+	decVector centerMin( firstFace.center );
+	decVector centerMax( firstFace.center );
+	
+	node.minExtend = firstFace.minExtend;
+	node.maxExtend = firstFace.maxExtend;
+	
+	for( i=1; i<count; i++ ){
+		const sBuildFace &buildFace = buildFaces[ pFaces[ first + i ] ];
+		node.minExtend.SetSmallest( buildFace.minExtend );
+		node.maxExtend.SetLargest( buildFace.maxExtend );
+		centerMin.SetSmallest( buildFace.center );
+		centerMax.SetLargest( buildFace.center );
+	}
+	
+	if( depth > pDepth ){
+		pDepth = depth;
+	}
+	
+	if( count <= LEAF_FACES || depth >= MaxDepth ){
+		pMakeLeaf( node, first, count );
+		return;
+	}
+	
+	// split along the axis with the largest spread of face centers
+	const decVector centerSize( centerMax - centerMin );
+	int axis = 0;
+	if( centerSize.y > centerSize.x ){
+		axis = 1;
+	}
+	if( centerSize.z > vAxis( centerSize, axis ) ){
+		axis = 2;
+	}
+	
+	const float axisSize = vAxis( centerSize, axis );
+	int split = 0;
+	
+	if( axisSize > 1e-6f ){
+		const float splitMin = vAxis( centerMin, axis );
+		const float splitScale = ( float )BIN_COUNT / axisSize;
+		decVector binMin[ BIN_COUNT ], binMax[ BIN_COUNT ];
+		int binCount[ BIN_COUNT ];
+		float leftArea[ BIN_COUNT ];
+		int leftCount[ BIN_COUNT ];
+		int b;
+		
+		for( b=0; b<BIN_COUNT; b++ ){
+			binCount[ b ] = 0;
+		}
+		
+		for( i=0; i<count; i++ ){
+			const sBuildFace &buildFace = buildFaces[ pFaces[ first + i ] ];
+			b = vBinIndex( vAxis( buildFace.center, axis ), splitMin, splitScale );
+			
+			if( binCount[ b ] == 0 ){
+				binMin[ b ] = buildFace.minExtend;
+				binMax[ b ] = buildFace.maxExtend;
+				
+			}else{
+				binMin[ b ].SetSmallest( buildFace.minExtend );
+				binMax[ b ].SetLargest( buildFace.maxExtend );
+			}
+			binCount[ b ]++;
+		}
+		
+		// sweep from left to right storing area and count left of each split
+		decVector accMin, accMax;
+		int accCount = 0;
+		
+		for( b=0; b<BIN_COUNT-1; b++ ){
+			if( binCount[ b ] > 0 ){
+				if( accCount == 0 ){
+					accMin = binMin[ b ];
+					accMax = binMax[ b ];
+					
+				}else{
+					accMin.SetSmallest( binMin[ b ] );
+					accMax.SetLargest( binMax[ b ] );
+				}
+				accCount += binCount[ b ];
+			}
+			
+			leftCount[ b ] = accCount;
+			leftArea[ b ] = accCount > 0 ? vHalfArea( accMin, accMax ) : 0.0f;
+		}
+		
+		// sweep from right to left evaluating the cost of splitting after each bin
+		float bestCost = 0.0f;
+		int bestBin = -1;
+		
+		accCount = 0;
+		for( b=BIN_COUNT-1; b>0; b-- ){
+			if( binCount[ b ] > 0 ){
+				if( accCount == 0 ){
+					accMin = binMin[ b ];
+					accMax = binMax[ b ];
+					
+				}else{
+					accMin.SetSmallest( binMin[ b ] );
+					accMax.SetLargest( binMax[ b ] );
+				}
+				accCount += binCount[ b ];
+			}
+			
+			if( accCount == 0 || leftCount[ b - 1 ] == 0 ){
+				continue;
+			}
+			
+			const float cost = leftArea[ b - 1 ] * ( float )leftCount[ b - 1 ]
+				+ vHalfArea( accMin, accMax ) * ( float )accCount;
+			if( bestBin == -1 || cost < bestCost ){
+				bestCost = cost;
+				bestBin = b - 1;
+			}
+		}
+		
+		if( bestBin != -1 ){
+			// splitting costs one node traversal plus testing the faces in the children
+			// weighted by the probability of hitting them
+			const float nodeArea = vHalfArea( node.minExtend, node.maxExtend );
+			if( count <= MAX_LEAF_FACES && bestCost + nodeArea >= nodeArea * ( float )count ){
+				pMakeLeaf( node, first, count );
+				return;
+			}
+			
+			split = pPartition( first, count, axis, splitMin, splitScale, bestBin, buildFaces );
+		}
+	}
+	
+	if( split == 0 || split == count ){
+		if( count <= MAX_LEAF_FACES ){
+			pMakeLeaf( node, first, count );
+			return;
+		}
+		
+		// all face centers are located at the same position. any split is as good as another
+		split = count / 2;
+	}
+	
+	const int child = pNodeCount;
+	pNodeCount += 2;
+	
+	node.first = child;
+	node.faceCount = 0;
+	
+	pBuildNode( child, first, split, depth + 1, buildFaces );
+	pBuildNode( child + 1, first + split, count - split, depth + 1, buildFaces );
+}
+
+void debpModelBVH::pMakeLeaf( sNode &node, int first, int count ){
+	node.first = first;
+	node.faceCount = count;
+}
+
+int debpModelBVH::pPartition( int first, int count, int axis, float splitMin,
+float splitScale, int splitBin, const sBuildFace *buildFaces ){
+	int left = first;
+	int right = first + count - 1;
+	
+	while( left <= right ){
+		if( vBinIndex( vAxis( buildFaces[ pFaces[ left ] ].center, axis ), splitMin, splitScale ) <= splitBin ){
+			left++;
+			
+		}else{
+			const int swap = pFaces[ left ];
+			pFaces[ left ] = pFaces[ right ];
+			pFaces[ right ] = swap;
+			right--;
+		}
+	}
+	
+	return left - first;
+}
+
+bool debpModelBVH::pVisitSwept( const decVector &center, const decVector &halfSize,
+const decVector &displacement, debpModelBVHVisitor &visitor ) const{
+	if( pNodeCount == 0 ){
+		return true;
+	}
+	
+	// slab test of the ray starting at the box center against the node boxes grown
+	// by the half size of the moving box
+	sSweepRay ray;
+	ray.origin = center;
+	ray.halfSize = halfSize;
+	ray.parallelX = fabsf( displacement.x ) < 1e-12f;
+	ray.parallelY = fabsf( displacement.y ) < 1e-12f;
+	ray.parallelZ = fabsf( displacement.z ) < 1e-12f;
+	ray.inverse.x = ray.parallelX ? 0.0f : 1.0f / displacement.x;
+	ray.inverse.y = ray.parallelY ? 0.0f : 1.0f / displacement.y;
+	ray.inverse.z = ray.parallelZ ? 0.0f : 1.0f / displacement.z;
+	
+	int stack[ MaxDepth + 2 ];
+	int stackSize = 0;
+	float distance1, distance2;
+	int i;
+	
+	if( ! vSweepHitsNode( ray, pNodes[ 0 ], distance1 ) ){
+		return true;
+	}
+	stack[ stackSize++ ] = 0;
+	
+	// nodes on the stack are known to be hit
+	while( stackSize > 0 ){
+		const sNode &node = pNodes[ stack[ --stackSize ] ];
+		
+		if( node.faceCount > 0 ){
+			const int * const faces = pFaces + node.first;
+			for( i=0; i<node.faceCount; i++ ){
+				if( ! visitor.VisitFace( faces[ i ] ) ){
+					return false;
+				}
+			}
+			continue;
+		}
+		
+		const bool hit1 = vSweepHitsNode( ray, pNodes[ node.first ], distance1 );
+		const bool hit2 = vSweepHitsNode( ray, pNodes[ node.first + 1 ], distance2 );
+		
+		if( hit1 && hit2 ){
+			// push farther child first to visit the closer child first
+			if( distance1 <= distance2 ){
+				stack[ stackSize++ ] = node.first + 1;
+				stack[ stackSize++ ] = node.first;
+				
+			}else{
+				stack[ stackSize++ ] = node.first;
+				stack[ stackSize++ ] = node.first + 1;
+			}
+			
+		}else if( hit1 ){
+			stack[ stackSize++ ] = node.first;
+			
+		}else if( hit2 ){
+			stack[ stackSize++ ] = node.first + 1;
+		}
+	}
+	
+	return true;
+}
@@ -0,0 +1,171 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEBPMODELBVH_H_
+#define _DEBPMODELBVH_H_
+
+#include <dragengine/common/math/decMath.h>
+
+class deModelLOD;
+class debpModelBVHVisitor;
+
+
+
+/**
+ * \brief Flattened bounding volume hierarchy of model faces.
+ * 
+ * Built once per model using the surface area heuristic with binned splits. Nodes are
+ * stored in a single array with the two children of an inner node next to each other.
+ * Leaf nodes reference a range of the face index array. Faces are stored in exactly one
+ * leaf node unlike the octree which inserts faces into all nodes they overlap.
+ * 
+ * Deformed meshes keep the tree topology of the undeformed model and refit the node
+ * boxes to the deformed vertex positions.
+ */
+class debpModelBVH{
+public:
+	/** \brief Node. */
+	struct sNode{
+		/** \brief Minimum extend. */
+		decVector minExtend;
+		
+		/** \brief Index of first face for leaf nodes or index of first child for inner nodes. */
+		int first;
+		
+		/** \brief Maximum extend. */
+		decVector maxExtend;
+		
+		/** \brief Number of faces for leaf nodes or 0 for inner nodes. */
+		int faceCount;
+	};
+	
+	/** \brief Maximum depth of tree. */
+	static const int MaxDepth = 48;
+	
+	
+	
+private:
+	sNode *pNodes;
+	int pNodeCount;
+	int *pFaces;
+	int pFaceCount;
+	int pDepth;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create empty bvh. */
+	debpModelBVH();
+	
+	/** \brief Create copy of bvh. */
+	debpModelBVH( const debpModelBVH &bvh );
+	
+	/** \brief Clean up bvh. */
+	~debpModelBVH();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Number of nodes. */
+	inline int GetNodeCount() const{ return pNodeCount; }
+	
+	/** \brief Nodes. Root node is the first node if not empty. */
+	inline const sNode *GetNodes() const{ return pNodes; }
+	
+	/** \brief Number of faces. */
+	inline int GetFaceCount() const{ return pFaceCount; }
+	
+	/** \brief Face indices referenced by leaf nodes. */
+	inline const int *GetFaces() const{ return pFaces; }
+	
+	/** \brief Depth of tree. */
+	inline int GetDepth() const{ return pDepth; }
+	
+	/** \brief Build bvh from faces of model lod using the lod vertex positions. */
+	void Build( const deModelLOD &lod );
+	
+	/**
+	 * \brief Refit node boxes to vertex positions keeping the tree topology.
+	 * 
+	 * \param[in] lod Model lod the bvh has been built from.
+	 * \param[in] positions Vertex positions with the same count as the lod vertices.
+	 */
+	void Refit( const deModelLOD &lod, const decVector *positions );
+	/*@}*/
+	
+	
+	
+	/** \name Visiting */
+	/*@{*/
+	/**
+	 * \brief Visit faces with box overlapping box.
+	 * 
+	 * \returns \em false if visitor stopped visiting.
+	 */
+	bool VisitFacesOverlapping( const decVector &minExtend, const decVector &maxExtend,
+		debpModelBVHVisitor &visitor ) const;
+		
+	/**
+	 * \brief Visit faces with box hit by ray.
+	 * 
+	 * Nodes closer to the origin are visited first.
+	 * 
+	 * \returns \em false if visitor stopped visiting.
+	 */
+	bool VisitFacesAlongRay( const decVector &origin, const decVector &displacement,
+		debpModelBVHVisitor &visitor ) const;
+		
+	/**
+	 * \brief Visit faces with box hit by moving box.
+	 * 
+	 * Nodes closer to the start position are visited first. Use with the enclosing box
+	 * of spheres to sweep spheres.
+	 * 
+	 * \returns \em false if visitor stopped visiting.
+	 */
+	bool VisitFacesSwept( const decVector &minExtend, const decVector &maxExtend,
+		const decVector &displacement, debpModelBVHVisitor &visitor ) const;
+	/*@}*/
+	
+	
+	
+private:
+	struct sBuildFace{
+		decVector minExtend;
+		decVector maxExtend;
+		decVector center;
+	};
+	
+	void pBuildNode( int node, int first, int count, int depth, const sBuildFace *buildFaces );
+	void pMakeLeaf( sNode &node, int first, int count );
+	int pPartition( int first, int count, int axis, float splitMin, float splitScale,
+		int splitBin, const sBuildFace *buildFaces );
+	bool pVisitSwept( const decVector &center, const decVector &halfSize,
+		const decVector &displacement, debpModelBVHVisitor &visitor ) const;
+		
+	debpModelBVH &operator=( const debpModelBVH &bvh );
+};
+
+#endif
@@ -41,10 +41,17 @@
 #include "particle/debpParticleEmitterInstance.h"
 #include "parameters/debpParameterList.h"
 #include "parameters/debpPSimulatePropFields.h"
+#include "parameters/debpPParallelCollisionDetection.h"
+#include "parameters/debpPStepRate.h"
+#include "parameters/debpPMaxSubSteps.h"
+#include "parameters/debpPFixedTimeStep.h"
+#include "parameters/debpPParallelDynamics.h"
+#include "parameters/debpPDeterministicDynamics.h"
 #include "propfield/debpPropField.h"
 #include "terrain/heightmap/debpHeightTerrain.h"
 #include "touchsensor/debpTouchSensor.h"
 #include "world/debpWorld.h"
+#include "world/debpTaskScheduler.h"
 
 #include <dragengine/deEngine.h>
 #include <dragengine/systems/modules/deModuleParameter.h>
@@ -154,6 +161,7 @@ pCommandExecuter( NULL ),
 pParameters( NULL ),
 pColInfo( NULL ),
 pCollisionDetection( NULL ),
+pTaskScheduler( NULL ),
 pDebug( *this )
 {
 	gContactAddedCallback = debpCollisionObject::CallbackAddContact;
@@ -164,6 +172,12 @@ pDebug( *this )
 	// create parameters
 	pParameters = new debpParameterList;
 	pParameters->AddParameter( new debpPSimulatePropFields( *this ) );
+	pParameters->AddParameter( new debpPParallelCollisionDetection( *this ) );
+	pParameters->AddParameter( new debpPStepRate( *this ) );
+	pParameters->AddParameter( new debpPMaxSubSteps( *this ) );
+	pParameters->AddParameter( new debpPFixedTimeStep( *this ) );
+	pParameters->AddParameter( new debpPParallelDynamics( *this ) );
+	pParameters->AddParameter( new debpPDeterministicDynamics( *this ) );
 }
 
 dePhysicsBullet::~dePhysicsBullet(){
@@ -181,6 +195,7 @@ dePhysicsBullet::~dePhysicsBullet(){
 
 bool dePhysicsBullet::Init(){
 	pCollisionDetection = new debpCollisionDetection( *this );
+	pTaskScheduler = new debpTaskScheduler( *this );
 	pColInfo = new deCollisionInfo;
 	
 	pConfiguration->LoadConfig();
@@ -199,6 +214,11 @@ void dePhysicsBullet::CleanUp(){
 		pColInfo = NULL;
 	}
 	
+	if( pTaskScheduler ){
+		delete pTaskScheduler;
+		pTaskScheduler = NULL;
+	}
+	
 	if( pCollisionDetection ){
 		delete pCollisionDetection;
 		pCollisionDetection = NULL;
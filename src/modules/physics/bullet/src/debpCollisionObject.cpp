@@ -46,7 +46,7 @@ debpCollisionObject::debpCollisionObject(){
 	pOwnerBone = -1;
 	pOwnerHTSector = NULL;
 	pOwnerTouchSensor = NULL;
-	pDirtyAABB = true;
+	pDirtyAABBIndex = -1;
 }
 
 debpCollisionObject::~debpCollisionObject(){
@@ -94,8 +94,11 @@ bool debpCollisionObject::IsOwnerTouchSensor() const{
 
 
 
-void debpCollisionObject::SetDirtyAABB( bool dirty ){
-	pDirtyAABB = dirty;
+void debpCollisionObject::SetDirtyAABBIndex( int index ){
+	pDirtyAABBIndex = index;
+}
+
+void debpCollisionObject::UpdateAABB(){
 }
 
 
@@ -39,7 +39,7 @@ private:
 	int pOwnerBone;
 	debpHTSector *pOwnerHTSector;
 	debpTouchSensor *pOwnerTouchSensor;
-	bool pDirtyAABB;
+	int pDirtyAABBIndex;
 	
 	
 	
@@ -95,13 +95,25 @@ public:
 	 * \brief AABB is dirty.
 	 * \details Used by debpCollisionWorld for optimizing inter-frame updates.
 	 */
-	inline bool GetDirtyAABB() const{ return pDirtyAABB; }
+	inline bool GetDirtyAABB() const{ return pDirtyAABBIndex != -1; }
 	
 	/**
-	 * \brief Set if AABB is dirty.
+	 * \brief Index in the dirty AABB list of the collision world or -1 if not dirty.
 	 * \details Used by debpCollisionWorld for optimizing inter-frame updates.
 	 */
-	void SetDirtyAABB( bool dirty );
+	inline int GetDirtyAABBIndex() const{ return pDirtyAABBIndex; }
+	
+	/**
+	 * \brief Set index in the dirty AABB list of the collision world or -1 if not dirty.
+	 * \details Used by debpCollisionWorld for optimizing inter-frame updates.
+	 */
+	void SetDirtyAABBIndex( int index );
+	
+	/**
+	 * \brief Update AABB of bullet collision object in the collision world.
+	 * \details Called by debpCollisionWorld for collision objects with dirty AABB.
+	 */
+	virtual void UpdateAABB();
 	
 	
 	
@@ -36,6 +36,7 @@
 #include <dragengine/common/xmlparser/decXmlElementTag.h>
 #include <dragengine/common/xmlparser/decXmlAttValue.h>
 #include <dragengine/common/xmlparser/decXmlVisitor.h>
+#include <dragengine/common/math/decMath.h>
 #include <dragengine/common/exceptions.h>
 #include <dragengine/filesystem/deVirtualFileSystem.h>
 
@@ -56,6 +57,14 @@ debpConfiguration::debpConfiguration( dePhysicsBullet *bullet ){
 	pEnableConstraintSlider = true;
 	
 	pSimulatePropFields = true;
+	pParallelCollisionDetection = false;
+	
+	pStepRate = 60;
+	pMaxSubSteps = 6;
+	pFixedTimeStep = false;
+	
+	pParallelDynamics = false;
+	pDeterministicDynamics = true;
 }
 
 debpConfiguration::~debpConfiguration(){
@@ -88,6 +97,30 @@ void debpConfiguration::SetSimulatePropFields( bool simulatePropFields ){
 	pSimulatePropFields = simulatePropFields;
 }
 
+void debpConfiguration::SetParallelCollisionDetection( bool parallelCollisionDetection ){
+	pParallelCollisionDetection = parallelCollisionDetection;
+}
+
+void debpConfiguration::SetStepRate( int stepRate ){
+	pStepRate = decMath::clamp( stepRate, 10, 1000 );
+}
+
+void debpConfiguration::SetMaxSubSteps( int maxSubSteps ){
+	pMaxSubSteps = decMath::max( maxSubSteps, 1 );
+}
+
+void debpConfiguration::SetFixedTimeStep( bool fixedTimeStep ){
+	pFixedTimeStep = fixedTimeStep;
+}
+
+void debpConfiguration::SetParallelDynamics( bool parallelDynamics ){
+	pParallelDynamics = parallelDynamics;
+}
+
+void debpConfiguration::SetDeterministicDynamics( bool deterministicDynamics ){
+	pDeterministicDynamics = deterministicDynamics;
+}
+
 
 
 // Loading and Saving
@@ -230,6 +263,24 @@ void debpConfiguration::pParseProperty( decXmlElementTag *root ){
 	}else if( strcmp( name, "simulatePropFields" ) == 0 ){
 		SetSimulatePropFields( ( int )strtol( value, NULL, 10 ) != 0 );
 		
+	}else if( strcmp( name, "parallelCollisionDetection" ) == 0 ){
+		SetParallelCollisionDetection( ( int )strtol( value, NULL, 10 ) != 0 );
+		
+	}else if( strcmp( name, "stepRate" ) == 0 ){
+		SetStepRate( ( int )strtol( value, NULL, 10 ) );
+		
+	}else if( strcmp( name, "maxSubSteps" ) == 0 ){
+		SetMaxSubSteps( ( int )strtol( value, NULL, 10 ) );
+		
+	}else if( strcmp( name, "fixedTimeStep" ) == 0 ){
+		SetFixedTimeStep( ( int )strtol( value, NULL, 10 ) != 0 );
+		
+	}else if( strcmp( name, "parallelDynamics" ) == 0 ){
+		SetParallelDynamics( ( int )strtol( value, NULL, 10 ) != 0 );
+		
+	}else if( strcmp( name, "deterministicDynamics" ) == 0 ){
+		SetDeterministicDynamics( ( int )strtol( value, NULL, 10 ) != 0 );
+		
 	}else{
 		pBullet->LogWarnFormat( "bullet.xml(%i:%i): Invalid property name %s, ignoring",
 			root->GetLineNumber(), root->GetPositionNumber(), name );
@@ -44,6 +44,14 @@ private:
 	bool pEnableConstraintSlider;
 	
 	bool pSimulatePropFields;
+	bool pParallelCollisionDetection;
+	
+	int pStepRate;
+	int pMaxSubSteps;
+	bool pFixedTimeStep;
+	
+	bool pParallelDynamics;
+	bool pDeterministicDynamics;
 	
 public:
 	/** @name Constructor, destructor */
@@ -77,6 +85,33 @@ public:
 	inline bool GetSimulatePropFields() const{ return pSimulatePropFields; }
 	/** Sets if prop fields are simulated. */
 	void SetSimulatePropFields( bool simulatePropFields );
+	
+	/** Determines if kinematic colliders and collision tests are processed in parallel. */
+	inline bool GetParallelCollisionDetection() const{ return pParallelCollisionDetection; }
+	/** Sets if kinematic colliders and collision tests are processed in parallel. */
+	void SetParallelCollisionDetection( bool parallelCollisionDetection );
+	
+	/** Simulation steps per second. */
+	inline int GetStepRate() const{ return pStepRate; }
+	/** Sets simulation steps per second clamped to the range from 10 to 1000. */
+	void SetStepRate( int stepRate );
+	/** Maximum number of simulation steps per frame. */
+	inline int GetMaxSubSteps() const{ return pMaxSubSteps; }
+	/** Sets maximum number of simulation steps per frame clamped to at least 1. */
+	void SetMaxSubSteps( int maxSubSteps );
+	/** Determines if kinematic and dynamic simulation run in fixed time steps. */
+	inline bool GetFixedTimeStep() const{ return pFixedTimeStep; }
+	/** Sets if kinematic and dynamic simulation run in fixed time steps. */
+	void SetFixedTimeStep( bool fixedTimeStep );
+	
+	/** Determines if dynamic simulation runs in parallel. */
+	inline bool GetParallelDynamics() const{ return pParallelDynamics; }
+	/** Sets if dynamic simulation runs in parallel. */
+	void SetParallelDynamics( bool parallelDynamics );
+	/** Determines if parallel dynamic simulation results are independent of the thread count. */
+	inline bool GetDeterministicDynamics() const{ return pDeterministicDynamics; }
+	/** Sets if parallel dynamic simulation results are independent of the thread count. */
+	void SetDeterministicDynamics( bool deterministicDynamics );
 	/*@}*/
 	
 	/** @name Loading and Saving */
@@ -79,6 +79,7 @@ void debpGhostObject::SetShape( debpBulletShape *shape ){
 	if( shape ){
 		if( pGhostObject ){
 			pGhostObject->setCollisionShape( shape->GetShape() );
+			MarkDirtyAABB();
 		}
 		
 	}else{
@@ -105,7 +106,7 @@ void debpGhostObject::SetPosition( const decDVector &position ){
 		pPosition = position;
 		pUpdateTransform();
 		pDirtyMatrix = true;
-		SetDirtyAABB( true );
+		MarkDirtyAABB();
 	}
 }
 
@@ -114,7 +115,7 @@ void debpGhostObject::SetOrientation( const decQuaternion &orientation ){
 		pOrientation = orientation;
 		pUpdateTransform();
 		pDirtyMatrix = true;
-		SetDirtyAABB( true );
+		MarkDirtyAABB();
 	}
 }
 
@@ -144,7 +145,8 @@ const decDMatrix &debpGhostObject::GetMatrix(){
 
 
 void debpGhostObject::UpdateAABB(){
-	if( pGhostObject ){
+	// ghost objects waiting in the delayed operation to be added have no broadphase proxy yet
+	if( pGhostObject && pGhostObject->getBroadphaseHandle() ){
 		pDynWorld->updateSingleAabb( pGhostObject );
 	}
 }
@@ -164,8 +166,6 @@ void debpGhostObject::pCleanUp(){
 
 void debpGhostObject::pCreateGhostObject(){
 	if( ! pGhostObject && pEnabled && pDynWorld && pShape ){
-		SetDirtyAABB( true );
-		
 		pGhostObject = new btGhostObject;
 		if( ! pGhostObject ){
 			DETHROW( deeOutOfMemory );
@@ -194,6 +194,8 @@ void debpGhostObject::pCreateGhostObject(){
 
 void debpGhostObject::pFreeGhostObject(){
 	if( pGhostObject ){
+		pDynWorld->RemoveDirtyAABB( this );
+		
 		// destroy the collision object or add it to the delayed operation if the world is locked
 		if( pDynWorld->GetDelayedOperation().IsLocked() ){
 			pDynWorld->GetDelayedOperation().RemoveCollisionObject( pGhostObject );
@@ -207,6 +209,13 @@ void debpGhostObject::pFreeGhostObject(){
 	}
 }
 
+void debpGhostObject::MarkDirtyAABB(){
+	// ghost objects are added with a valid AABB. only existing ghost objects need updating
+	if( pGhostObject ){
+		pDynWorld->AddDirtyAABB( this );
+	}
+}
+
 void debpGhostObject::pUpdateTransform(){
 	if( pGhostObject ){
 		pGhostObject->setWorldTransform( btTransform(
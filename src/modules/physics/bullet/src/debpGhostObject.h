@@ -88,8 +88,16 @@ public:
 	/** \brief Retrieves the ghost object matrix. */
 	const decDMatrix &GetMatrix();
 	
-	/** \brief Update dynamic world AABB if dirty. */
-	void UpdateAABB();
+	/**
+	 * \brief Mark dynamic world AABB dirty.
+	 * 
+	 * Called if the position, orientation or shape changed. Call if the collision shape
+	 * has been modified in place.
+	 */
+	void MarkDirtyAABB();
+	
+	/** \brief Update dynamic world AABB. */
+	virtual void UpdateAABB();
 	/*@}*/
 	
 private:
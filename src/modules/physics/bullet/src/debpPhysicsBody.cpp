@@ -101,6 +101,7 @@ void debpPhysicsBody::SetShape( debpBulletShape *shape ){
 		if( pRigidBody ){
 			pRigidBody->setCollisionShape( shape->GetShape() );
 			pRigidBody->updateInertiaTensor();
+			MarkDirtyAABB();
 		}
 		
 	}else{
@@ -190,7 +191,7 @@ void debpPhysicsBody::SetPosition( const decDVector &position ){
 	
 	pStateChanged = true;
 	pDirtyMatrix = true;
-	SetDirtyAABB( true );
+	MarkDirtyAABB();
 }
 
 void debpPhysicsBody::SetOrientation( const decQuaternion &orientation ){
@@ -211,7 +212,7 @@ void debpPhysicsBody::SetOrientation( const decQuaternion &orientation ){
 	
 	pStateChanged = true;
 	pDirtyMatrix = true;
-	SetDirtyAABB( true );
+	MarkDirtyAABB();
 }
 
 void debpPhysicsBody::SetLinearVelocity( const decVector &linVelo ){
@@ -369,7 +370,8 @@ void debpPhysicsBody::ApplyGravity( float elapsed ){
 }
 
 void debpPhysicsBody::UpdateAABB(){
-	if( pRigidBody ){
+	// rigid bodies waiting in the delayed operation to be added have no broadphase proxy yet
+	if( pRigidBody && pRigidBody->getBroadphaseHandle() ){
 		pDynWorld->updateSingleAabb( pRigidBody );
 	}
 }
@@ -583,8 +585,6 @@ void debpPhysicsBody::pCreateRigidBody(){
 	float mass = 0.0f;
 	int c;
 	
-	SetDirtyAABB( true );
-	
 	// update the motion state to be sure anything works.
 	pMotionState->SetPosition( pPosition );
 	pMotionState->SetOrientation( pOrientation );
@@ -661,6 +661,8 @@ void debpPhysicsBody::pFreeRigidBody(){
 		pConstraints[ c ]->RigidBodyDestroy( this );
 	}
 	
+	pDynWorld->RemoveDirtyAABB( this );
+	
 	// destroy the rigid body or add it to the delayed operation if the world is locked
 	if( pDynWorld->GetDelayedOperation().IsLocked() ){
 		pDynWorld->GetDelayedOperation().RemoveRigidBody( pRigidBody );
@@ -673,6 +675,13 @@ void debpPhysicsBody::pFreeRigidBody(){
 	pRigidBody = NULL;
 }
 
+void debpPhysicsBody::MarkDirtyAABB(){
+	// rigid bodies are added with a valid AABB. only existing rigid bodies need updating
+	if( pRigidBody ){
+		pDynWorld->AddDirtyAABB( this );
+	}
+}
+
 void debpPhysicsBody::pUpdateTransform(){
 	if( ! pRigidBody ){
 		return;
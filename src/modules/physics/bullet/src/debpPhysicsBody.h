@@ -214,8 +214,16 @@ public:
 	/** \brief Apply gravity to linear velocity. */
 	void ApplyGravity( float elapsed );
 	
-	/** \brief Update dynamic world AABB if dirty. */
-	void UpdateAABB();
+	/**
+	 * \brief Mark dynamic world AABB dirty.
+	 * 
+	 * Called if the position, orientation or shape changed. Call if the collision shape
+	 * has been modified in place.
+	 */
+	void MarkDirtyAABB();
+	
+	/** \brief Update dynamic world AABB. */
+	virtual void UpdateAABB();
 	/*@}*/
 	
 	
@@ -19,25 +19,59 @@
  * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
  */
 
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "debpDeveloperMode.h"
 #include "../dePhysicsBullet.h"
+#include "../debpConfiguration.h"
+#include "../coldet/octree/debpDOctreeVisitor.h"
+#include "../component/debpModel.h"
+#include "../component/debpModelBVH.h"
+#include "../component/debpModelBVHVisitor.h"
+#include "../component/debpModelOctree.h"
 #include "../debug/debpDebug.h"
+#include "../particle/debpParticleKernels.h"
+#include "../particle/debpParticleStepJob.h"
+#include "../world/debpCollisionWorld.h"
+#include "../world/debpTaskScheduler.h"
 #include "../world/debpWorld.h"
 
+#include <dragengine/deEngine.h>
 #include <dragengine/common/exceptions.h>
+#include <dragengine/common/collection/decObjectList.h>
 #include <dragengine/common/file/decPath.h>
+#include <dragengine/common/shape/decShapeBox.h>
+#include <dragengine/common/shape/decShapeList.h>
+#include <dragengine/common/shape/decShapeSphere.h>
 #include <dragengine/common/string/unicode/decUnicodeString.h>
 #include <dragengine/common/string/unicode/decUnicodeArgumentList.h>
+#include <dragengine/common/utils/decTimer.h>
 #include <dragengine/resources/collider/deCollider.h>
+#include <dragengine/resources/collider/deColliderCollisionTest.h>
+#include <dragengine/resources/collider/deColliderCollisionTestReference.h>
+#include <dragengine/resources/collider/deColliderManager.h>
+#include <dragengine/resources/collider/deColliderReference.h>
+#include <dragengine/resources/collider/deColliderVolume.h>
+#include <dragengine/resources/collider/deCollisionInfo.h>
+#include <dragengine/resources/collider/deCollisionQueryBatch.h>
+#include <dragengine/resources/component/deComponentManager.h>
+#include <dragengine/resources/model/deModel.h>
+#include <dragengine/resources/model/deModelLOD.h>
+#include <dragengine/resources/model/deModelManager.h>
+#include <dragengine/resources/model/deModelVertex.h>
+#include <dragengine/resources/world/deWorld.h>
+#include <dragengine/resources/world/deWorldManager.h>
+#include <dragengine/resources/world/deWorldReference.h>
+#include <dragengine/systems/modules/scripting/deBaseScriptingCollider.h>
 
 #include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h"
 #include "BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h"
 #include "BulletDynamics/Dynamics/btDynamicsWorld.h"
 #include "BulletDynamics/Dynamics/btRigidBody.h"
 #include "BulletCollision/BroadphaseCollision/btAxisSweep3.h"
+#include "BulletCollision/BroadphaseCollision/btDbvtBroadphase.h"
 #include "BulletCollision/CollisionShapes/btBoxShape.h"
 #include "BulletCollision/CollisionShapes/btTriangleMeshShape.h"
 #include "BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h"
@@ -45,6 +79,48 @@
 
 
 
+// counts hits reported by sequential ray tests in the query batch benchmark
+class debpDMCountHitsListener : public deBaseScriptingCollider{
+public:
+	int hitCount;
+	
+	debpDMCountHitsListener() : hitCount( 0 ){
+	}
+	
+	virtual void CollisionResponse( deCollider *owner, deCollisionInfo *info ){
+		hitCount++;
+	}
+};
+
+// counts candidate faces visited by the model bvh benchmark
+class debpDMCountBVHFaces : public debpModelBVHVisitor{
+public:
+	int faceCount;
+	
+	debpDMCountBVHFaces() : faceCount( 0 ){
+	}
+	
+	virtual bool VisitFace( int ){
+		faceCount++;
+		return true;
+	}
+};
+
+// counts candidate faces visited by the model octree in the model bvh benchmark
+class debpDMCountOctreeFaces : public debpDOctreeVisitor{
+public:
+	int faceCount;
+	
+	debpDMCountOctreeFaces() : faceCount( 0 ){
+	}
+	
+	virtual void VisitNode( debpDOctree *node, int ){
+		faceCount += ( ( debpModelOctree* )node )->GetFaceCount();
+	}
+};
+
+
+
 // Class debpDeveloperMode
 ////////////////////////////
 
@@ -97,6 +173,34 @@ bool debpDeveloperMode::ExecuteCommand( const decUnicodeArgumentList &command, d
 	}else if( command.MatchesArgumentAt( 0, "dm_debug" ) ){
 		pCmdDebugEnable( command, answer );
 		return true;
+		
+	}else if( command.MatchesArgumentAt( 0, "dm_benchmark_query_batch" ) ){
+		pCmdBenchmarkQueryBatch( command, answer );
+		return true;
+		
+	}else if( command.MatchesArgumentAt( 0, "dm_benchmark_kinematic" ) ){
+		pCmdBenchmarkKinematic( command, answer );
+		return true;
+		
+	}else if( command.MatchesArgumentAt( 0, "dm_benchmark_dynamics" ) ){
+		pCmdBenchmarkDynamics( command, answer );
+		return true;
+		
+	}else if( command.MatchesArgumentAt( 0, "dm_skinning_stats" ) ){
+		pCmdSkinningStats( command, answer );
+		return true;
+		
+	}else if( command.MatchesArgumentAt( 0, "dm_benchmark_particles" ) ){
+		pCmdBenchmarkParticles( command, answer );
+		return true;
+		
+	}else if( command.MatchesArgumentAt( 0, "dm_benchmark_model_bvh" ) ){
+		pCmdBenchmarkModelBVH( command, answer );
+		return true;
+		
+	}else if( command.MatchesArgumentAt( 0, "dm_broadphase_stats" ) ){
+		pCmdBroadphaseStats( command, answer );
+		return true;
 	}
 	
 	return false;
@@ -142,6 +246,13 @@ void debpDeveloperMode::pCmdHelp( const decUnicodeArgumentList &command, decUnic
 	answer.AppendFromUTF8( "dm_show_category => Show collision objects with collision category (comma-separated list of bit-numbers or 'off').\n" );
 	answer.AppendFromUTF8( "dm_highlight_response_type => Highlight response type if dm_show_category is used.\n" );
 	answer.AppendFromUTF8( "dm_debug {enable | disable} => Enable performance debugging.\n" );
+	answer.AppendFromUTF8( "dm_benchmark_query_batch [queries] => Benchmark collision query batch against sequential ray tests.\n" );
+	answer.AppendFromUTF8( "dm_benchmark_kinematic [colliders] => Benchmark parallel against serial kinematic collision detection comparing positions and collision test hits.\n" );
+	answer.AppendFromUTF8( "dm_benchmark_dynamics [bodies] => Benchmark parallel against serial dynamic simulation for different thread counts.\n" );
+	answer.AppendFromUTF8( "dm_skinning_stats => Show components skinned during the last frame by module.\n" );
+	answer.AppendFromUTF8( "dm_benchmark_particles [particles] => Benchmark SIMD and parallel particle simulation against the scalar version.\n" );
+	answer.AppendFromUTF8( "dm_benchmark_model_bvh [queries] => Benchmark model face BVH against the model octree using the loaded model with the most faces.\n" );
+	answer.AppendFromUTF8( "dm_broadphase_stats => Show broadphase and update statistics of all worlds since the last call.\n" );
 }
 
 void debpDeveloperMode::pCmdEnable( const decUnicodeArgumentList &command, decUnicodeString &answer ){
@@ -243,3 +354,771 @@ void debpDeveloperMode::pCmdDebugEnable( const decUnicodeArgumentList &command,
 	text.Format( "dm_debug = %s\n", pBullet.GetDebug().GetEnabled() ? "enabled" : "disabled" );
 	answer.AppendFromUTF8( text );
 }
+
+void debpDeveloperMode::pCmdBenchmarkQueryBatch( const decUnicodeArgumentList &command,
+decUnicodeString &answer ){
+	int queryCount = 10000;
+	if( command.GetArgumentCount() > 1 ){
+		queryCount = decMath::max( command.GetArgumentAt( 1 )->ToInt(), 1 );
+	}
+	
+	deEngine &engine = *pBullet.GetGameEngine();
+	
+	// temporary world with a grid of static boxes of varying height
+	const int gridSize = 64;
+	decLayerMask layerMask;
+	layerMask.SetBit( 0 );
+	const decCollisionFilter collisionFilter( layerMask );
+	
+	deWorldReference world;
+	world.TakeOver( engine.GetWorldManager()->CreateWorld() );
+	
+	int x, z;
+	for( z=0; z<gridSize; z++ ){
+		for( x=0; x<gridSize; x++ ){
+			deColliderReference collider;
+			collider.TakeOver( engine.GetColliderManager()->CreateColliderVolume() );
+			deColliderVolume &volume = ( deColliderVolume& )( deCollider& )collider;
+			
+			decShapeList shapes;
+			shapes.Add( new decShapeBox( decVector( 0.4f, 0.2f + 0.1f * ( float )( ( x + z * 3 ) % 5 ), 0.4f ) ) );
+			volume.SetShapes( shapes );
+			volume.SetResponseType( deCollider::ertStatic );
+			volume.SetCollisionFilter( collisionFilter );
+			volume.SetPosition( decDVector( ( double )x, 0.0, ( double )z ) );
+			
+			world->AddCollider( collider );
+		}
+	}
+	
+	// rays cast slightly tilted downwards from above the grid. positions use a low
+	// discrepancy sequence to be reproducible
+	deCollisionQueryBatch batch;
+	batch.SetCollisionFilter( collisionFilter );
+	
+	int i;
+	for( i=0; i<queryCount; i++ ){
+		const double fx = fmod( 0.7548776662 * ( double )i, 1.0 );
+		const double fz = fmod( 0.5698402910 * ( double )i, 1.0 );
+		batch.AddQuery( decDVector( fx * gridSize, 5.0, fz * gridSize ), decVector( 0.5f, -10.0f, 0.3f ) );
+	}
+	
+	// warm up. this also updates octrees and sweep tests
+	batch.SetClosestHitOnly( true );
+	world->CollisionQueryBatch( batch );
+	
+	decTimer timer;
+	timer.Reset();
+	world->CollisionQueryBatch( batch );
+	const float elapsedClosest = timer.GetElapsedTime();
+	const int hitCountClosest = batch.GetHitCount();
+	
+	batch.SetClosestHitOnly( false );
+	timer.Reset();
+	world->CollisionQueryBatch( batch );
+	const float elapsedBatch = timer.GetElapsedTime();
+	const int hitCountBatch = batch.GetHitCount();
+	
+	debpDMCountHitsListener listener;
+	timer.Reset();
+	for( i=0; i<queryCount; i++ ){
+		const deCollisionQueryBatch::sQuery &query = batch.GetQueryAt( i );
+		world->RayHits( query.origin, query.direction, &listener, collisionFilter );
+	}
+	const float elapsedSequential = timer.GetElapsedTime();
+	
+	decString text;
+	text.Format( "queries=%d colliders=%d\n", queryCount, gridSize * gridSize );
+	answer.AppendFromUTF8( text );
+	text.Format( "sequential: %d hits, %.2f ms, %.0f queries/s\n", listener.hitCount,
+		elapsedSequential * 1e3f, ( float )queryCount / decMath::max( elapsedSequential, 1e-6f ) );
+	answer.AppendFromUTF8( text );
+	text.Format( "batch all hits: %d hits, %.2f ms, %.0f queries/s\n", hitCountBatch,
+		elapsedBatch * 1e3f, ( float )queryCount / decMath::max( elapsedBatch, 1e-6f ) );
+	answer.AppendFromUTF8( text );
+	text.Format( "batch closest hit: %d hits, %.2f ms, %.0f queries/s\n", hitCountClosest,
+		elapsedClosest * 1e3f, ( float )queryCount / decMath::max( elapsedClosest, 1e-6f ) );
+	answer.AppendFromUTF8( text );
+}
+
+void debpDeveloperMode::pCmdBenchmarkKinematic( const decUnicodeArgumentList &command,
+decUnicodeString &answer ){
+	int colliderCount = 5000;
+	if( command.GetArgumentCount() > 1 ){
+		colliderCount = decMath::max( command.GetArgumentAt( 1 )->ToInt(), 1 );
+	}
+	
+	deEngine &engine = *pBullet.GetGameEngine();
+	debpConfiguration &configuration = *pBullet.GetConfiguration();
+	const bool parallelCollisionDetection = configuration.GetParallelCollisionDetection();
+	const int stepCount = 30;
+	const float elapsed = 1.0f / 60.0f;
+	
+	// temporary world with a static ground grid and kinematic spheres moving above it.
+	// the spheres collide only with the ground and never hit it. collision responses
+	// would require scripting listeners. each sphere has a collision test casting a ray
+	// down onto the ground. the hit results of both modes are compared
+	const int gridSize = 64;
+	decLayerMask layerGround, layerKinematic;
+	layerGround.SetBit( 0 );
+	layerKinematic.SetBit( 1 );
+	
+	deWorldReference world;
+	world.TakeOver( engine.GetWorldManager()->CreateWorld() );
+	
+	int i, x, z;
+	for( z=0; z<gridSize; z++ ){
+		for( x=0; x<gridSize; x++ ){
+			deColliderReference collider;
+			collider.TakeOver( engine.GetColliderManager()->CreateColliderVolume() );
+			deColliderVolume &volume = ( deColliderVolume& )( deCollider& )collider;
+			
+			decShapeList shapes;
+			shapes.Add( new decShapeBox( decVector( 0.5f, 0.2f + 0.1f * ( float )( ( x + z * 3 ) % 5 ), 0.5f ) ) );
+			volume.SetShapes( shapes );
+			volume.SetResponseType( deCollider::ertStatic );
+			volume.SetCollisionFilter( decCollisionFilter( layerGround, layerKinematic ) );
+			volume.SetPosition( decDVector( ( double )x, 0.0, ( double )z ) );
+			
+			world->AddCollider( collider );
+		}
+	}
+	
+	decObjectList colliders;
+	decShapeList sphereShapes;
+	sphereShapes.Add( new decShapeSphere( 0.25f ) );
+	
+	for( i=0; i<colliderCount; i++ ){
+		deColliderReference collider;
+		collider.TakeOver( engine.GetColliderManager()->CreateColliderVolume() );
+		deColliderVolume &volume = ( deColliderVolume& )( deCollider& )collider;
+		
+		volume.SetShapes( sphereShapes );
+		volume.SetResponseType( deCollider::ertKinematic );
+		volume.SetCollisionFilter( decCollisionFilter( layerKinematic, layerGround ) );
+		volume.SetUseLocalGravity( true );
+		volume.SetGravity( decVector() );
+		
+		deColliderCollisionTestReference collisionTest;
+		collisionTest.TakeOver( new deColliderCollisionTest );
+		collisionTest->SetCollisionFilter( decCollisionFilter( layerKinematic, layerGround ) );
+		collisionTest->SetDirection( decVector( 0.0f, -8.0f, 0.0f ) );
+		collisionTest->SetLocalDirection( false );
+		volume.AddCollisionTest( collisionTest );
+		
+		world->AddCollider( collider );
+		colliders.Add( ( deCollider* )collider );
+	}
+	
+	// run both modes from the same start state and compare the final positions and the
+	// collision test hits of the last step
+	struct sTestResult{
+		int hitCount;
+		deCollider *hitCollider;
+		float hitDistance;
+	};
+	
+	decDVector *finalPositions = NULL;
+	sTestResult *testResults = NULL;
+	float elapsedModes[ 2 ];
+	double maxDifference = 0.0;
+	float maxHitDistanceDifference = 0.0f;
+	int hitTestCount = 0;
+	int hitMismatchCount = 0;
+	int mode;
+	
+	try{
+		finalPositions = new decDVector[ colliderCount ];
+		testResults = new sTestResult[ colliderCount ];
+		
+		for( mode=0; mode<2; mode++ ){
+			for( i=0; i<colliderCount; i++ ){
+				deCollider &collider = *( ( deCollider* )colliders.GetAt( i ) );
+				const double fx = fmod( 0.7548776662 * ( double )i, 1.0 );
+				const double fz = fmod( 0.5698402910 * ( double )i, 1.0 );
+				collider.SetPosition( decDVector( fx * gridSize, 2.0 + 2.0 * fmod( 0.618034 * ( double )i, 1.0 ), fz * gridSize ) );
+				collider.SetLinearVelocity( decVector( 1.0f, -0.5f, 0.5f ) );
+			}
+			
+			configuration.SetParallelCollisionDetection( mode == 1 );
+			world->ProcessPhysics( elapsed ); // warm up. this also updates octrees and sweep tests
+			
+			decTimer timer;
+			timer.Reset();
+			for( i=0; i<stepCount; i++ ){
+				world->ProcessPhysics( elapsed );
+			}
+			elapsedModes[ mode ] = timer.GetElapsedTime();
+			
+			for( i=0; i<colliderCount; i++ ){
+				const deCollider &collider = *( ( deCollider* )colliders.GetAt( i ) );
+				const decDVector &position = collider.GetPosition();
+				const deColliderCollisionTest &collisionTest = *collider.GetCollisionTestAt( 0 );
+				sTestResult result;
+				
+				result.hitCount = collisionTest.GetCollisionInfoCount();
+				result.hitCollider = NULL;
+				result.hitDistance = 0.0f;
+				if( result.hitCount > 0 ){
+					const deCollisionInfo &info = *collisionTest.GetCollisionInfoAt( 0 );
+					result.hitCollider = info.GetCollider();
+					result.hitDistance = info.GetDistance();
+				}
+				
+				if( mode == 0 ){
+					finalPositions[ i ] = position;
+					testResults[ i ] = result;
+					if( result.hitCount > 0 ){
+						hitTestCount++;
+					}
+					
+				}else{
+					const sTestResult &serial = testResults[ i ];
+					maxDifference = decMath::max( maxDifference, ( position - finalPositions[ i ] ).Length() );
+					
+					if( result.hitCount != serial.hitCount || result.hitCollider != serial.hitCollider ){
+						hitMismatchCount++;
+						
+					}else{
+						maxHitDistanceDifference = decMath::max( maxHitDistanceDifference,
+							fabsf( result.hitDistance - serial.hitDistance ) );
+					}
+				}
+			}
+		}
+		
+		delete [] testResults;
+		delete [] finalPositions;
+		configuration.SetParallelCollisionDetection( parallelCollisionDetection );
+		
+	}catch( const deException & ){
+		if( testResults ){
+			delete [] testResults;
+		}
+		if( finalPositions ){
+			delete [] finalPositions;
+		}
+		configuration.SetParallelCollisionDetection( parallelCollisionDetection );
+		throw;
+	}
+	
+	decString text;
+	text.Format( "colliders=%d ground=%d steps=%d\n", colliderCount, gridSize * gridSize, stepCount );
+	answer.AppendFromUTF8( text );
+	text.Format( "serial: %.2f ms/step\n", elapsedModes[ 0 ] * 1e3f / ( float )stepCount );
+	answer.AppendFromUTF8( text );
+	text.Format( "parallel: %.2f ms/step\n", elapsedModes[ 1 ] * 1e3f / ( float )stepCount );
+	answer.AppendFromUTF8( text );
+	text.Format( "speedup: %.2f\n", elapsedModes[ 1 ] > 0.0f ? elapsedModes[ 0 ] / elapsedModes[ 1 ] : 0.0f );
+	answer.AppendFromUTF8( text );
+	text.Format( "max position difference: %g\n", maxDifference );
+	answer.AppendFromUTF8( text );
+	text.Format( "collision tests hitting: %d/%d\n", hitTestCount, colliderCount );
+	answer.AppendFromUTF8( text );
+	text.Format( "collision test hit mismatches: %d (max distance difference %g)\n",
+		hitMismatchCount, maxHitDistanceDifference );
+	answer.AppendFromUTF8( text );
+}
+
+void debpDeveloperMode::pCmdBenchmarkDynamics( const decUnicodeArgumentList &command,
+decUnicodeString &answer ){
+	int bodyCount = 2000;
+	if( command.GetArgumentCount() > 1 ){
+		bodyCount = decMath::max( command.GetArgumentAt( 1 )->ToInt(), 1 );
+	}
+	
+	debpConfiguration &configuration = *pBullet.GetConfiguration();
+	debpTaskScheduler &taskScheduler = pBullet.GetTaskScheduler();
+	const bool parallelDynamics = configuration.GetParallelDynamics();
+	const int threadCount = taskScheduler.getNumThreads();
+	const int maxThreadCount = taskScheduler.getMaxNumThreads();
+	const int stepCount = 60;
+	
+	decDVector *referencePositions = NULL;
+	decDVector *positions = NULL;
+	decString text;
+	
+	text.Format( "bodies=%d steps=%d deterministic=%s\n", bodyCount, stepCount,
+		configuration.GetDeterministicDynamics() ? "yes" : "no" );
+	answer.AppendFromUTF8( text );
+	
+	try{
+		referencePositions = new decDVector[ bodyCount ];
+		positions = new decDVector[ bodyCount ];
+		
+		configuration.SetParallelDynamics( false );
+		const float elapsedSerial = pBenchmarkDynamicsRun( bodyCount, stepCount, positions );
+		text.Format( "serial: %.2f ms/step\n", elapsedSerial * 1e3f / ( float )stepCount );
+		answer.AppendFromUTF8( text );
+		
+		// parallel runs with doubling thread counts. the first parallel run is the reference
+		// the other runs are compared against to verify the results do not depend on the
+		// number of threads used
+		configuration.SetParallelDynamics( true );
+		int threads = 1;
+		
+		while( true ){
+			taskScheduler.setNumThreads( threads );
+			const float elapsed = pBenchmarkDynamicsRun( bodyCount, stepCount,
+				threads == 1 ? referencePositions : positions );
+				
+			double maxDifference = 0.0;
+			if( threads > 1 ){
+				int i;
+				for( i=0; i<bodyCount; i++ ){
+					maxDifference = decMath::max( maxDifference, ( positions[ i ] - referencePositions[ i ] ).Length() );
+				}
+			}
+			
+			text.Format( "parallel %d threads: %.2f ms/step, speedup %.2f, max position difference %g\n",
+				threads, elapsed * 1e3f / ( float )stepCount,
+				elapsedSerial / decMath::max( elapsed, 1e-6f ), maxDifference );
+			answer.AppendFromUTF8( text );
+			
+			if( threads == maxThreadCount ){
+				break;
+			}
+			threads = decMath::min( threads * 2, maxThreadCount );
+		}
+		
+		delete [] positions;
+		delete [] referencePositions;
+		configuration.SetParallelDynamics( parallelDynamics );
+		taskScheduler.setNumThreads( threadCount );
+		
+	}catch( const deException & ){
+		if( positions ){
+			delete [] positions;
+		}
+		if( referencePositions ){
+			delete [] referencePositions;
+		}
+		configuration.SetParallelDynamics( parallelDynamics );
+		taskScheduler.setNumThreads( threadCount );
+		throw;
+	}
+}
+
+float debpDeveloperMode::pBenchmarkDynamicsRun( int bodyCount, int stepCount, decDVector *positions ){
+	deEngine &engine = *pBullet.GetGameEngine();
+	const float elapsed = 1.0f / 60.0f;
+	
+	// temporary world with a static ground and stacks of dynamic boxes. stacks are placed
+	// apart from each other to form separate simulation islands as long as they stand
+	const int stackHeight = 10;
+	const int stackCount = ( bodyCount + stackHeight - 1 ) / stackHeight;
+	const int gridSize = decMath::max( ( int )ceil( sqrt( ( double )stackCount ) ), 1 );
+	const double spacing = 1.5;
+	decLayerMask layerMask;
+	layerMask.SetBit( 0 );
+	const decCollisionFilter collisionFilter( layerMask );
+	
+	deWorldReference world;
+	world.TakeOver( engine.GetWorldManager()->CreateWorld() );
+	world->SetGravity( decVector( 0.0f, -9.81f, 0.0f ) );
+	
+	{
+	deColliderReference collider;
+	collider.TakeOver( engine.GetColliderManager()->CreateColliderVolume() );
+	deColliderVolume &volume = ( deColliderVolume& )( deCollider& )collider;
+	
+	const float halfSize = ( float )( gridSize * spacing ) * 0.5f + 2.0f;
+	decShapeList shapes;
+	shapes.Add( new decShapeBox( decVector( halfSize, 0.5f, halfSize ) ) );
+	volume.SetShapes( shapes );
+	volume.SetResponseType( deCollider::ertStatic );
+	volume.SetCollisionFilter( collisionFilter );
+	volume.SetPosition( decDVector( ( double )halfSize - 2.0, -0.5, ( double )halfSize - 2.0 ) );
+	
+	world->AddCollider( collider );
+	}
+	
+	decObjectList colliders;
+	decShapeList boxShapes;
+	boxShapes.Add( new decShapeBox( decVector( 0.5f, 0.5f, 0.5f ) ) );
+	
+	int i;
+	for( i=0; i<bodyCount; i++ ){
+		const int stack = i / stackHeight;
+		const int level = i % stackHeight;
+		
+		deColliderReference collider;
+		collider.TakeOver( engine.GetColliderManager()->CreateColliderVolume() );
+		deColliderVolume &volume = ( deColliderVolume& )( deCollider& )collider;
+		
+		// dynamic collisions call the scripting peer. use one ignoring them if missing
+		if( ! volume.GetPeerScripting() ){
+			volume.SetPeerScripting( new deBaseScriptingCollider );
+		}
+		
+		volume.SetShapes( boxShapes );
+		volume.SetResponseType( deCollider::ertDynamic );
+		volume.SetMass( 1.0f );
+		volume.SetCollisionFilter( collisionFilter );
+		volume.SetPosition( decDVector( spacing * ( double )( stack % gridSize ),
+			0.5 + 1.001 * ( double )level, spacing * ( double )( stack / gridSize ) ) );
+			
+		world->AddCollider( collider );
+		colliders.Add( ( deCollider* )collider );
+	}
+	
+	world->ProcessPhysics( elapsed ); // warm up. this also updates octrees
+	
+	decTimer timer;
+	timer.Reset();
+	for( i=0; i<stepCount; i++ ){
+		world->ProcessPhysics( elapsed );
+	}
+	const float elapsedRun = timer.GetElapsedTime();
+	
+	for( i=0; i<bodyCount; i++ ){
+		positions[ i ] = ( ( deCollider* )colliders.GetAt( i ) )->GetPosition();
+	}
+	
+	return elapsedRun;
+}
+
+void debpDeveloperMode::pCmdSkinningStats( const decUnicodeArgumentList &command, decUnicodeString &answer ){
+	const deComponentManager &manager = *pBullet.GetGameEngine()->GetComponentManager();
+	const char * const names[ deComponent::esrOther + 1 ] = { "graphic", "physics", "audio", "other" };
+	decString text;
+	int i;
+	
+	text = "Skinning last frame:\n";
+	for( i=deComponent::esrGraphic; i<=deComponent::esrOther; i++ ){
+		const deComponentManager::sSkinningStats stats( manager.GetSkinningStats(
+			( deComponent::eSkinningRequester )i ) );
+		text.AppendFormat( "- %s: skinned %d components (%d vertices), shared %d components\n",
+			names[ i ], stats.skinnedComponents, stats.skinnedVertices, stats.sharedComponents );
+	}
+	
+	answer.AppendFromUTF8( text );
+}
+
+void debpDeveloperMode::pCmdBenchmarkParticles( const decUnicodeArgumentList &command,
+decUnicodeString &answer ){
+	int particleCount = 100000;
+	if( command.GetArgumentCount() > 1 ){
+		particleCount = decMath::max( command.GetArgumentAt( 1 )->ToInt(), 1 );
+	}
+	
+	const char * const modeNames[ 3 ] = { "scalar", "simd", "simd parallel" };
+	const int streamCount = debpParticleKernels::StreamCount;
+	const int stepCount = 60;
+	const float elapsed = 1.0f / 60.0f;
+	
+	// headless simulation without collision. a radial force field covers about half
+	// of the particles and a linear one all of them
+	debpParticleKernels::sForceField forceFields[ 2 ];
+	
+	forceFields[ 0 ].positionX = 0.0f;
+	forceFields[ 0 ].positionY = 0.0f;
+	forceFields[ 0 ].positionZ = 0.0f;
+	forceFields[ 0 ].directionX = 0.0f;
+	forceFields[ 0 ].directionY = 0.0f;
+	forceFields[ 0 ].directionZ = 0.0f;
+	forceFields[ 0 ].linear = false;
+	forceFields[ 0 ].radius = 10.0f;
+	forceFields[ 0 ].exponent = 2.0f;
+	forceFields[ 0 ].force = 5.0f;
+	forceFields[ 0 ].fluctuationCos = cosf( 0.3f );
+	forceFields[ 0 ].fluctuationSin = sinf( 0.3f );
+	forceFields[ 0 ].factor = debpParticleKernels::effMass;
+	
+	forceFields[ 1 ] = forceFields[ 0 ];
+	forceFields[ 1 ].directionX = 0.6f;
+	forceFields[ 1 ].directionZ = 0.8f;
+	forceFields[ 1 ].linear = true;
+	forceFields[ 1 ].radius = 1000.0f;
+	forceFields[ 1 ].exponent = 1.0f;
+	forceFields[ 1 ].force = 2.0f;
+	forceFields[ 1 ].factor = debpParticleKernels::effSpeed;
+	
+	float *streamData = NULL;
+	float *referencePositions = NULL;
+	float *streams[ debpParticleKernels::StreamCount ];
+	float elapsedModes[ 3 ];
+	float maxDifferences[ 3 ];
+	int i, j, mode;
+	
+	try{
+		streamData = new float[ particleCount * streamCount ];
+		referencePositions = new float[ particleCount * 3 ];
+		
+		for( i=0; i<streamCount; i++ ){
+			streams[ i ] = streamData + particleCount * i;
+		}
+		
+		for( mode=0; mode<3; mode++ ){
+			for( i=0; i<particleCount; i++ ){
+				const float f1 = fmodf( 0.7548776662f * ( float )i, 1.0f );
+				const float f2 = fmodf( 0.5698402910f * ( float )i, 1.0f );
+				const float f3 = fmodf( 0.6180339887f * ( float )i, 1.0f );
+				
+				streams[ debpParticleKernels::esPositionX ][ i ] = f1 * 40.0f - 20.0f;
+				streams[ debpParticleKernels::esPositionY ][ i ] = f2 * 10.0f;
+				streams[ debpParticleKernels::esPositionZ ][ i ] = f3 * 40.0f - 20.0f;
+				streams[ debpParticleKernels::esVelocityX ][ i ] = f2 * 2.0f - 1.0f;
+				streams[ debpParticleKernels::esVelocityY ][ i ] = f3 * 4.0f;
+				streams[ debpParticleKernels::esVelocityZ ][ i ] = f1 * 2.0f - 1.0f;
+				streams[ debpParticleKernels::esMass ][ i ] = 0.1f + f1;
+				streams[ debpParticleKernels::esDamp ][ i ] = ( i % 3 ) == 0 ? 0.0f : 0.01f * f2;
+				streams[ debpParticleKernels::esDrag ][ i ] = ( i % 2 ) == 0 ? 0.0f : 0.001f * f3;
+				streams[ debpParticleKernels::esRotation ][ i ] = f3 * PI;
+				streams[ debpParticleKernels::esAngularVelocity ][ i ] = f1 * 4.0f - 2.0f;
+				streams[ debpParticleKernels::esForceFieldDirect ][ i ] = 1.0f;
+				streams[ debpParticleKernels::esForceFieldSurface ][ i ] = 0.5f;
+				streams[ debpParticleKernels::esForceFieldMass ][ i ] = 0.25f + f2;
+				streams[ debpParticleKernels::esForceFieldSpeed ][ i ] = 0.1f;
+			}
+			
+			decTimer timer;
+			timer.Reset();
+			
+			for( i=0; i<stepCount; i++ ){
+				// gravity. debpParticleEmitterInstanceType sets the force while preparing
+				for( j=0; j<particleCount; j++ ){
+					streams[ debpParticleKernels::esForceX ][ j ] = 0.0f;
+					streams[ debpParticleKernels::esForceY ][ j ] = -9.81f * streams[ debpParticleKernels::esMass ][ j ];
+					streams[ debpParticleKernels::esForceZ ][ j ] = 0.0f;
+				}
+				
+				switch( mode ){
+				case 0:
+					for( j=0; j<2; j++ ){
+						debpParticleKernels::ApplyForceFieldScalar( streams, 0, particleCount, forceFields[ j ] );
+					}
+					debpParticleKernels::IntegrateScalar( streams, 0, particleCount, elapsed );
+					debpParticleKernels::AdvanceScalar( streams, 0, particleCount, elapsed );
+					break;
+					
+				case 1:
+					for( j=0; j<2; j++ ){
+						debpParticleKernels::ApplyForceField( streams, 0, particleCount, forceFields[ j ] );
+					}
+					debpParticleKernels::Integrate( streams, 0, particleCount, elapsed );
+					debpParticleKernels::Advance( streams, 0, particleCount, elapsed );
+					break;
+					
+				default:{
+					for( j=0; j<2; j++ ){
+						debpParticleKernels::ApplyForceField( streams, 0, particleCount, forceFields[ j ] );
+					}
+					
+					debpParticleStepJob * const job = new debpParticleStepJob(
+						pBullet, streams, particleCount, elapsed );
+					try{
+						job->Process();
+						
+					}catch( const deException & ){
+						job->FreeReference();
+						throw;
+					}
+					job->FreeReference();
+					}
+				}
+			}
+			
+			elapsedModes[ mode ] = timer.GetElapsedTime();
+			maxDifferences[ mode ] = 0.0f;
+			
+			for( i=0; i<particleCount; i++ ){
+				for( j=0; j<3; j++ ){
+					const float position = streams[ debpParticleKernels::esPositionX + j ][ i ];
+					if( mode == 0 ){
+						referencePositions[ i * 3 + j ] = position;
+						
+					}else{
+						maxDifferences[ mode ] = decMath::max( maxDifferences[ mode ],
+							fabsf( position - referencePositions[ i * 3 + j ] ) );
+					}
+				}
+			}
+		}
+		
+		delete [] referencePositions;
+		delete [] streamData;
+		
+	}catch( const deException & ){
+		if( referencePositions ){
+			delete [] referencePositions;
+		}
+		if( streamData ){
+			delete [] streamData;
+		}
+		throw;
+	}
+	
+	decString text;
+	text.Format( "particles=%d steps=%d force fields=2\n", particleCount, stepCount );
+	answer.AppendFromUTF8( text );
+	
+	for( mode=0; mode<3; mode++ ){
+		text.Format( "%s: %.2f ms/step, %.0f particles/s", modeNames[ mode ],
+			elapsedModes[ mode ] * 1e3f / ( float )stepCount, ( float )particleCount
+				* ( float )stepCount / decMath::max( elapsedModes[ mode ], 1e-6f ) );
+		if( mode > 0 ){
+			text.AppendFormat( ", speedup %.2fx, max position difference %g",
+				elapsedModes[ 0 ] / decMath::max( elapsedModes[ mode ], 1e-6f ), maxDifferences[ mode ] );
+		}
+		text.AppendCharacter( '\n' );
+		answer.AppendFromUTF8( text );
+	}
+}
+
+void debpDeveloperMode::pCmdBenchmarkModelBVH( const decUnicodeArgumentList &command,
+decUnicodeString &answer ){
+	int queryCount = 10000;
+	if( command.GetArgumentCount() > 1 ){
+		queryCount = decMath::max( command.GetArgumentAt( 1 )->ToInt(), 1 );
+	}
+	
+	// find loaded model with the most faces
+	deModel *engModel = pBullet.GetGameEngine()->GetModelManager()->GetRootModel();
+	debpModel *bestModel = NULL;
+	int bestFaceCount = 0;
+	
+	while( engModel ){
+		if( engModel->GetPeerPhysics() && engModel->GetLODCount() > 0
+		&& engModel->GetLODAt( 0 )->GetFaceCount() > bestFaceCount ){
+			bestModel = ( debpModel* )engModel->GetPeerPhysics();
+			bestFaceCount = engModel->GetLODAt( 0 )->GetFaceCount();
+		}
+		engModel = ( deModel* )engModel->GetLLManagerNext();
+	}
+	
+	if( ! bestModel ){
+		answer.AppendFromUTF8( "No loaded model with faces found.\n" );
+		return;
+	}
+	
+	const deModelLOD &lod = *bestModel->GetModel().GetLODAt( 0 );
+	const decVector &minExtend = bestModel->GetExtends().minimum;
+	const decVector size( bestModel->GetExtends().maximum - minExtend );
+	const decVector boxSize( size * 0.05f );
+	const int vertexCount = lod.GetVertexCount();
+	float elapsedBuildBVH, elapsedRefit, elapsedOctree, elapsedBVH, elapsedSweep;
+	long long octreeFaces = 0, bvhFaces = 0, sweepFaces = 0;
+	decVector *positions = NULL;
+	int i;
+	
+	// build. the octree is always built from scratch for comparison
+	decTimer timer;
+	timer.Reset();
+	
+	debpModelBVH bvh;
+	bvh.Build( lod );
+	elapsedBuildBVH = timer.GetElapsedTime();
+	
+	bestModel->PrepareOctree();
+	
+	// refit to slightly deformed vertices as done for dynamic model colliders
+	try{
+		positions = new decVector[ vertexCount ];
+		for( i=0; i<vertexCount; i++ ){
+			positions[ i ] = lod.GetVertexAt( i ).GetPosition() * 1.01f;
+		}
+		
+		debpModelBVH refitBVH( bvh );
+		timer.Reset();
+		refitBVH.Refit( lod, positions );
+		elapsedRefit = timer.GetElapsedTime();
+		
+		delete [] positions;
+		
+	}catch( const deException & ){
+		if( positions ){
+			delete [] positions;
+		}
+		throw;
+	}
+	
+	// box queries covering 5% of the model size spread across the model
+	timer.Reset();
+	for( i=0; i<queryCount; i++ ){
+		const decVector factor( fmodf( 0.7548776662f * ( float )i, 1.0f ),
+			fmodf( 0.5698402910f * ( float )i, 1.0f ), fmodf( 0.6180339887f * ( float )i, 1.0f ) );
+		const decVector boxMin( minExtend + decVector( size.x * factor.x, size.y * factor.y, size.z * factor.z ) );
+		debpDMCountOctreeFaces visitor;
+		bestModel->GetOctree()->VisitNodesColliding( &visitor, decDVector( boxMin ), decDVector( boxMin + boxSize ) );
+		octreeFaces += visitor.faceCount;
+	}
+	elapsedOctree = timer.GetElapsedTime();
+	
+	timer.Reset();
+	for( i=0; i<queryCount; i++ ){
+		const decVector factor( fmodf( 0.7548776662f * ( float )i, 1.0f ),
+			fmodf( 0.5698402910f * ( float )i, 1.0f ), fmodf( 0.6180339887f * ( float )i, 1.0f ) );
+		const decVector boxMin( minExtend + decVector( size.x * factor.x, size.y * factor.y, size.z * factor.z ) );
+		debpDMCountBVHFaces visitor;
+		bvh.VisitFacesOverlapping( boxMin, boxMin + boxSize, visitor );
+		bvhFaces += visitor.faceCount;
+	}
+	elapsedBVH = timer.GetElapsedTime();
+	
+	// box sweeps across a quarter of the model size
+	timer.Reset();
+	for( i=0; i<queryCount; i++ ){
+		const decVector factor( fmodf( 0.7548776662f * ( float )i, 1.0f ),
+			fmodf( 0.5698402910f * ( float )i, 1.0f ), fmodf( 0.6180339887f * ( float )i, 1.0f ) );
+		const decVector boxMin( minExtend + decVector( size.x * factor.x, size.y * factor.y, size.z * factor.z ) );
+		const decVector displacement( size.x * ( factor.y - 0.5f ) * 0.5f,
+			size.y * ( factor.z - 0.5f ) * 0.5f, size.z * ( factor.x - 0.5f ) * 0.5f );
+		debpDMCountBVHFaces visitor;
+		bvh.VisitFacesSwept( boxMin, boxMin + boxSize, displacement, visitor );
+		sweepFaces += visitor.faceCount;
+	}
+	elapsedSweep = timer.GetElapsedTime();
+	
+	decString text;
+	text.Format( "model=%s faces=%d queries=%d\n", bestModel->GetModel().GetFilename().GetString(),
+		bestFaceCount, queryCount );
+	text.AppendFormat( "bvh: build %.2f ms, refit %.2f ms, nodes %d, depth %d\n", elapsedBuildBVH * 1e3f,
+		elapsedRefit * 1e3f, bvh.GetNodeCount(), bvh.GetDepth() );
+	text.AppendFormat( "octree box: %.2f us/query, %.1f faces/query\n",
+		elapsedOctree * 1e6f / ( float )queryCount, ( float )octreeFaces / ( float )queryCount );
+	text.AppendFormat( "bvh box: %.2f us/query, %.1f faces/query, speedup %.2fx\n",
+		elapsedBVH * 1e6f / ( float )queryCount, ( float )bvhFaces / ( float )queryCount,
+		elapsedOctree / decMath::max( elapsedBVH, 1e-6f ) );
+	text.AppendFormat( "bvh sweep: %.2f us/query, %.1f faces/query\n",
+		elapsedSweep * 1e6f / ( float )queryCount, ( float )sweepFaces / ( float )queryCount );
+	answer.AppendFromUTF8( text );
+}
+
+void debpDeveloperMode::pCmdBroadphaseStats( const decUnicodeArgumentList &command,
+decUnicodeString &answer ){
+	deWorld *engWorld = pBullet.GetGameEngine()->GetWorldManager()->GetRootWorld();
+	decString text;
+	int index = 0;
+	
+	while( engWorld ){
+		debpWorld * const world = ( debpWorld* )engWorld->GetPeerPhysics();
+		if( world ){
+			debpCollisionWorld &dynWorld = *world->GetDynamicsWorld();
+			
+			// debpWorld always uses a dbvt broadphase. leaves in the fixed set are
+			// static or sleeping collision objects not moved since the last rebuild
+			const btDbvtBroadphase &broadphase = *( ( btDbvtBroadphase* )dynWorld.getBroadphase() );
+			const debpWorld::sUpdateStats &stats = world->GetUpdateStats();
+			
+			text.AppendFormat( "World %d: %d collision objects\n", index, dynWorld.getNumCollisionObjects() );
+			text.AppendFormat( "- broadphase: %d dynamic, %d fixed, %d pending dirty aabbs\n",
+				broadphase.m_sets[ 0 ].m_leaves, broadphase.m_sets[ 1 ].m_leaves,
+				dynWorld.GetDirtyAABBCount() );
+			text.AppendFormat( "- UpdateOctrees: %d calls, %d skipped, %d colliders updated\n",
+				stats.updateOctreesCalls, stats.updateOctreesSkipped, stats.updatedColliders );
+			text.AppendFormat( "- UpdateDynWorldAABBs: %d aabbs updated\n", stats.updatedAABBs );
+			
+			world->ResetUpdateStats();
+		}
+		
+		engWorld = ( deWorld* )engWorld->GetLLManagerNext();
+		index++;
+	}
+	
+	if( index == 0 ){
+		text = "No worlds.\n";
+	}
+	
+	answer.AppendFromUTF8( text );
+}
@@ -22,6 +22,7 @@
 #ifndef _DEBPDEVELOPERMODE_H_
 #define _DEBPDEVELOPERMODE_H_
 
+#include <dragengine/common/math/decMath.h>
 #include <dragengine/common/utils/decLayerMask.h>
 
 class dePhysicsBullet;
@@ -102,6 +103,14 @@ private:
 	void pCmdShowCategory( const decUnicodeArgumentList &command, decUnicodeString &answer );
 	void pCmdHighlightResponseType( const decUnicodeArgumentList &command, decUnicodeString &answer );
 	void pCmdDebugEnable( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	void pCmdBenchmarkQueryBatch( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	void pCmdBenchmarkKinematic( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	void pCmdBenchmarkDynamics( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	void pCmdSkinningStats( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	float pBenchmarkDynamicsRun( int bodyCount, int stepCount, decDVector *positions );
+	void pCmdBenchmarkParticles( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	void pCmdBenchmarkModelBVH( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	void pCmdBroadphaseStats( const decUnicodeArgumentList &command, decUnicodeString &answer );
 };
 
 #endif
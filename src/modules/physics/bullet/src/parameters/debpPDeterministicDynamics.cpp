@@ -0,0 +1,62 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "debpPDeterministicDynamics.h"
+#include "../dePhysicsBullet.h"
+#include "../debpConfiguration.h"
+
+#include <dragengine/common/exceptions.h>
+
+
+
+// Class debpPDeterministicDynamics
+///////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+debpPDeterministicDynamics::debpPDeterministicDynamics( dePhysicsBullet &bullet ) : debpParameter( bullet )
+{
+	SetName( "deterministicDynamics" );
+	SetType( deModuleParameter::eptBoolean );
+	SetDescription( "Keeps parallel dynamic simulation results independent of the number of threads used. Disable for slightly faster parallel simulation" );
+	SetCategory( ecExpert );
+	SetDisplayName( "Deterministic Dynamics" );
+}
+
+debpPDeterministicDynamics::~debpPDeterministicDynamics(){
+}
+
+
+
+// Parameter Value
+////////////////////
+
+decString debpPDeterministicDynamics::GetParameterValue(){
+	return pBullet.GetConfiguration()->GetDeterministicDynamics() ? "1" : "0";
+}
+
+void debpPDeterministicDynamics::SetParameterValue( const char *value ){
+	pBullet.GetConfiguration()->SetDeterministicDynamics( decString( value ) == "1" );
+}
@@ -0,0 +1,62 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "debpPFixedTimeStep.h"
+#include "../dePhysicsBullet.h"
+#include "../debpConfiguration.h"
+
+#include <dragengine/common/exceptions.h>
+
+
+
+// Class debpPFixedTimeStep
+///////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+debpPFixedTimeStep::debpPFixedTimeStep( dePhysicsBullet &bullet ) : debpParameter( bullet )
+{
+	SetName( "fixedTimeStep" );
+	SetType( deModuleParameter::eptBoolean );
+	SetDescription( "Enables running kinematic and dynamic simulation in fixed time steps. Dynamic colliders are interpolated between the last two steps" );
+	SetCategory( ecAdvanced );
+	SetDisplayName( "Fixed Time Step" );
+}
+
+debpPFixedTimeStep::~debpPFixedTimeStep(){
+}
+
+
+
+// Parameter Value
+////////////////////
+
+decString debpPFixedTimeStep::GetParameterValue(){
+	return pBullet.GetConfiguration()->GetFixedTimeStep() ? "1" : "0";
+}
+
+void debpPFixedTimeStep::SetParameterValue( const char *value ){
+	pBullet.GetConfiguration()->SetFixedTimeStep( decString( value ) == "1" );
+}
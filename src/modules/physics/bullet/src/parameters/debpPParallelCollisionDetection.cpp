@@ -0,0 +1,65 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "debpPParallelCollisionDetection.h"
+#include "../dePhysicsBullet.h"
+#include "../debpConfiguration.h"
+
+#include <dragengine/common/exceptions.h>
+
+
+
+// Class debpPParallelCollisionDetection
+//////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+debpPParallelCollisionDetection::debpPParallelCollisionDetection( dePhysicsBullet &bullet ) : debpParameter( bullet )
+{
+	SetName( "parallelCollisionDetection" );
+	SetType( deModuleParameter::eptBoolean );
+	SetDescription( "Enables sweeping kinematic colliders and running collider collision tests in parallel. "
+		"Kinematic colliders are swept against the world state at the start of the step. Unlike "
+		"serial processing they do not see colliders moved earlier in the same step, either "
+		"directly or by collision responses. Results can differ from serial processing." );
+	SetCategory( ecAdvanced );
+	SetDisplayName( "Parallel Collision Detection" );
+}
+
+debpPParallelCollisionDetection::~debpPParallelCollisionDetection(){
+}
+
+
+
+// Parameter Value
+////////////////////
+
+decString debpPParallelCollisionDetection::GetParameterValue(){
+	return pBullet.GetConfiguration()->GetParallelCollisionDetection() ? "1" : "0";
+}
+
+void debpPParallelCollisionDetection::SetParameterValue( const char *value ){
+	pBullet.GetConfiguration()->SetParallelCollisionDetection( decString( value ) == "1" );
+}
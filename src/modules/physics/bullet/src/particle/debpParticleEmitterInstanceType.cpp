@@ -27,11 +27,14 @@
 #include "debpParticleEmitter.h"
 #include "debpParticleEmitterType.h"
 #include "debpParticleEmitterInstanceType.h"
+#include "debpParticleResultCallback.h"
 #include "../debpCommon.h"
 #include "../debpCollisionObject.h"
+#include "../debpConfiguration.h"
 #include "../dePhysicsBullet.h"
 #include "../collider/debpCollider.h"
 #include "../coldet/debpConvexResultCallback.h"
+#include "../coldet/debpSweepCollisionTest.h"
 #include "../component/debpModel.h"
 #include "../component/debpComponent.h"
 #include "../forcefield/debpForceField.h"
@@ -47,6 +50,7 @@
 #include <dragengine/deEngine.h>
 #include <dragengine/common/exceptions.h>
 #include <dragengine/common/curve/decCurveBezierEvaluator.h>
+#include <dragengine/common/shape/decShapeSphere.h>
 #include <dragengine/resources/collider/deCollider.h>
 #include <dragengine/resources/component/deComponent.h>
 #include <dragengine/resources/model/deModel.h>
@@ -83,8 +87,13 @@ pType( 0 ),
 pComponent( NULL ),
 
 pParticles( NULL ),
+pStreamData( NULL ),
 pParticleCount( 0 ),
 pParticleSize( 0 ),
+pCollisionResponseCalled( false ),
+
+pSweepTest( NULL ),
+pSweepTestRadius( 0.0f ),
 
 pCastIntervalMin( 0.0f ),
 pCastIntervalGap( 1.0f ),
@@ -94,7 +103,12 @@ pBurstTimer( 0.0f ),
 pBurstLastCurvePoint( -1 ),
 
 pGraParticles( NULL ),
-pGraParticleSize( 0 ){
+pGraParticleSize( 0 )
+{
+	int i;
+	for( i=0; i<debpParticleKernels::StreamCount; i++ ){
+		pStreams[ i ] = NULL;
+	}
 }
 
 debpParticleEmitterInstanceType::~debpParticleEmitterInstanceType(){
@@ -114,6 +128,26 @@ void debpParticleEmitterInstanceType::SetType( int type ){
 	pType = type;
 }
 
+debpSweepCollisionTest &debpParticleEmitterInstanceType::GetSweepCollisionTest(){
+	// the bullet shpere-box test is quite error-prone. particles keep on falling through
+	// no matter what you do. what is the problem here?
+	const deParticleEmitterType &engType = pInstance->GetParticleEmitter()->GetEmitter()->GetTypeAt( pType );
+	const float radius = decMath::max( engType.GetPhysicsSize(), 0.01f );
+	
+	if( ! pSweepTest ){
+		pSweepTest = new debpSweepCollisionTest( pInstance->GetBullet()->GetCollisionDetection() );
+		
+	}else if( fabsf( radius - pSweepTestRadius ) < FLOAT_SAFE_EPSILON ){
+		return *pSweepTest;
+	}
+	
+	decShapeSphere sphere( radius );
+	pSweepTest->RemoveAllShapes();
+	pSweepTest->AddShape( sphere );
+	pSweepTestRadius = radius;
+	return *pSweepTest;
+}
+
 
 
 void debpParticleEmitterInstanceType::PrepareParticles( float elapsed, float travelledDistance ){
@@ -136,7 +170,7 @@ void debpParticleEmitterInstanceType::PrepareParticles( float elapsed, float tra
 			if( particle.timeToLive > 0.0f ){
 				if( updateProgress ){
 					particle.lifetime = 1.0f - particle.lifetimeFactor * particle.timeToLive;
-					ParticleSetProgressParams( particle );
+					ParticleSetProgressParams( p );
 				}
 				
 			}else{
@@ -307,128 +341,120 @@ void debpParticleEmitterInstanceType::PrepareParticles( float elapsed, float tra
 
 void debpParticleEmitterInstanceType::ApplyForceField( const debpForceField &forceField, float elapsed ){
 	const deParticleEmitterType &engType = pInstance->GetParticleEmitter()->GetEmitter()->GetTypeAt( pType );
-	if( engType.GetSimulationType() == deParticleEmitterType::estBeam ){
+	if( engType.GetSimulationType() == deParticleEmitterType::estBeam || pParticleCount == 0 ){
 		return;
 	}
 	
 	const deForceField &engForceField = forceField.GetForceField();
 	const float fluctStrength = pInstance->GetForceFieldFluctuation().GetStrength();
 	const float fluctDirection = pInstance->GetForceFieldFluctuation().GetDirection();
-	const float ffFluctuationDirection = engForceField.GetFluctuationDirection();
-	const float ffFluctuationForce = engForceField.GetFluctuationForce();
-	const float ffExponent = engForceField.GetExponent();
+	const float flucAngle = engForceField.GetFluctuationDirection() * fluctDirection * ( DEG2RAD * 180.0f );
 	const decDVector &ffpos = engForceField.GetPosition();
 	const decVector &ffDir = forceField.GetDirection();
-	const float ffRadius = engForceField.GetRadius();
-	const float ffRadiusSquared = ffRadius * ffRadius;
-	//const float elapsedSquared = elapsed * elapsed;
-	const float ffForce = engForceField.GetForce();
-	//const float ffVelocity = engForceField.GetForce() * 4.5f / 15.0f; // 15N => 4.5 m/s
-	const deForceField::eFieldTypes ffFieldType = engForceField.GetFieldType();
-	const deForceField::eApplicationTypes ffApplyType = engForceField.GetApplicationType();
-	const float flucAngle = DEG2RAD * 180.0f;
-	float distance, distanceSquared;
-	float /*velocity,*/ addForce;
-	//const float volumeFactor = 4.0f * PI / 3.0f;
-	decVector direction;
-	float forceFactor;
-	decMatrix flucmat;
-	int p;
-	
-	for( p=0; p<pParticleCount; p++ ){
-		sParticle &particle = pParticles[ p ];
-		
-		direction.x = ( float )( particle.position.x() - ffpos.x );
-		direction.y = ( float )( particle.position.y() - ffpos.y );
-		direction.z = ( float )( particle.position.z() - ffpos.z );
-		
-		distanceSquared = direction * direction;
-		
-		if( distanceSquared >= ffRadiusSquared ) continue;
-		
-		if( ffFieldType == deForceField::eftLinear ){
-			distance = sqrtf( distanceSquared );
-			direction = ffDir;
-			
-		}else{
-			if( distanceSquared < 1e-6f ) continue;
-			
-			distance = sqrtf( distanceSquared );
-			direction *= 1.0f - distance / ffRadius;
-		}
-		
-		switch( ffApplyType ){
-		case deForceField::eatDirect:
-			//forceFactor = 1.0f;
-			forceFactor = particle.forceFieldDirect;
-			break;
-			
-		case deForceField::eatSurface:
-			//forceFactor = particle.size * particle.size * PI;
-			forceFactor = particle.forceFieldSurface;
-			break;
-			
-		case deForceField::eatMass:
-			//forceFactor = particle.size * particle.size * particle.size * volumeFactor;
-			forceFactor = particle.forceFieldMass * particle.mass;
-			break;
-			
-		case deForceField::eatSpeed:
-			forceFactor = particle.forceFieldSpeed * ( float )particle.linearVelocity.length();
-			break;
-			
-		default:
-			DETHROW( deeInvalidParam );
-		}
-		
-		//printf( "particle %i: velocity=%g dist=%g radius=%g exp=%g elapsed=%g\n", p, velocity, distance, ffRadius, ffExponent, elapsed );
+	debpParticleKernels::sForceField kernelForceField;
+	
+	kernelForceField.positionX = ( float )ffpos.x;
+	kernelForceField.positionY = ( float )ffpos.y;
+	kernelForceField.positionZ = ( float )ffpos.z;
+	kernelForceField.linear = engForceField.GetFieldType() == deForceField::eftLinear;
+	kernelForceField.radius = engForceField.GetRadius();
+	kernelForceField.exponent = engForceField.GetExponent();
+	kernelForceField.force = engForceField.GetForce() + engForceField.GetFluctuationForce() * fluctStrength;
+	
+	// fluctuation rotates the direction around the Y axis
+	kernelForceField.fluctuationCos = cosf( flucAngle );
+	kernelForceField.fluctuationSin = sinf( flucAngle );
+	kernelForceField.directionX = ffDir.x * kernelForceField.fluctuationCos - ffDir.z * kernelForceField.fluctuationSin;
+	kernelForceField.directionY = ffDir.y;
+	kernelForceField.directionZ = ffDir.x * kernelForceField.fluctuationSin + ffDir.z * kernelForceField.fluctuationCos;
+	
+	switch( engForceField.GetApplicationType() ){
+	case deForceField::eatDirect:
+		kernelForceField.factor = debpParticleKernels::effDirect;
+		break;
 		
-		addForce = ( ffForce + ffFluctuationForce * fluctStrength )
-			* powf( 1.0f - distance / ffRadius, ffExponent ) * forceFactor;
+	case deForceField::eatSurface:
+		kernelForceField.factor = debpParticleKernels::effSurface;
+		break;
 		
-		/*if( particle.gravity.y() < 1e-5f ){
-			addvelo = force * 0.02f;
-			//addtorque = 0.0f; //force * ( DEG2RAD * 45.0f );
-			
-		}else{
-			addvelo = force * 0.2f;
-			//addtorque = 0.0f;
-		}*/
-		//addvelo = force * 0.2f; // need a way to influende this parameter
+	case deForceField::eatMass:
+		kernelForceField.factor = debpParticleKernels::effMass;
+		break;
 		
-		flucmat.SetRotationY( ffFluctuationDirection * fluctDirection * flucAngle );
+	case deForceField::eatSpeed:
+		kernelForceField.factor = debpParticleKernels::effSpeed;
+		break;
 		
-		direction = flucmat.TransformNormal( direction ) * addForce;
-		particle.force.setX( particle.force.x() + direction.x );
-		particle.force.setY( particle.force.y() + direction.y );
-		particle.force.setZ( particle.force.z() + direction.z );
-		//particle.angularVelocity += addtorque; // += direction * addtorque;
+	default:
+		DETHROW( deeInvalidParam );
 	}
+	
+	debpParticleKernels::ApplyForceField( pStreams, 0, pParticleCount, kernelForceField );
 }
 
 void debpParticleEmitterInstanceType::StepParticles( float elapsed ){
 	const deParticleEmitterType &engType = pInstance->GetParticleEmitter()->GetEmitter()->GetTypeAt( pType );
-	int i;
+	if( engType.GetSimulationType() == deParticleEmitterType::estBeam || pParticleCount == 0 ){
+		return;
+	}
+	
+	// integrate and sweep all particles in parallel. collision responses call scripting
+	// listeners and are applied serially afterwards. particles are processed backwards
+	// since killing a particle moves particles located after it in the array which are
+	// then already processed
+	dePhysicsBullet &bullet = *pInstance->GetBullet();
+	const bool canCollide = pInstance->GetCanCollide();
+	debpParticleStepJob * const job = new debpParticleStepJob( bullet, pStreams, pParticleCount, elapsed );
 	
-	if( engType.GetSimulationType() != deParticleEmitterType::estBeam ){
-		//pInstance->GetBullet()->LogInfoFormat( "StepParticles: pParticleCount=%i pParticleSize=%i elapsed=%f\n", pParticleCount, pParticleSize, elapsed );
+	try{
+		if( ! bullet.GetConfiguration()->GetParallelCollisionDetection() ){
+			job->SetMaxTaskCount( 0 );
+		}
 		
-		for( i=0; i<pParticleCount; i++ ){
-			sParticle &particle = pParticles[ i ];
+		if( canCollide ){
+			job->EnableCollision( *pInstance->GetParentWorld()->GetDynamicsWorld(),
+				GetSweepCollisionTest(), pInstance->GetInstance()->GetCollisionFilter() );
+		}
+		
+		job->Process();
+		
+		if( canCollide ){
+			int i;
+			
+			pCollisionResponseCalled = false;
 			
-			if( ! ParticleSimulate( particle, elapsed ) ){
-				KillParticle( i );
-				i--;
+			for( i=pParticleCount-1; i>=0; i-- ){
+				// collision response listeners can kill particles or remove the instance
+				if( ! pInstance->GetParentWorld() ){
+					break;
+				}
+				if( i >= pParticleCount ){
+					i = pParticleCount;
+					continue;
+				}
+				
+				// once a listener has been called sweeps run by the job are stale. listeners
+				// can free the hit collision objects or kill particles reordering the array
+				if( ! ParticleTestCollision( i, elapsed,
+				pCollisionResponseCalled ? NULL : &job->GetSweepAt( i ) ) ){
+					KillParticle( i );
+				}
 			}
 		}
+		
+	}catch( const deException & ){
+		job->FreeReference();
+		throw;
 	}
+	
+	job->FreeReference();
 }
 
 void debpParticleEmitterInstanceType::FinishStepping(){
 	int i;
 	
 	for( i=0; i<pParticleCount; i++ ){
-		ParticleUpdateTrailEmitter( pParticles[ i ] );
+		ParticleUpdateTrailEmitter( i );
 	}
 	
 	UpdateGraphicParticles();
@@ -438,6 +464,14 @@ void debpParticleEmitterInstanceType::UpdateGraphicParticles(){
 	const debpParticleEmitter * const emitter = pInstance->GetParticleEmitter();
 	const decDVector &position = pInstance->GetInstance()->GetReferencePosition();
 	const float rotationFactor = 255.0f / ( PI * 2.0f );
+	const float * const positionX = pStreams[ debpParticleKernels::esPositionX ];
+	const float * const positionY = pStreams[ debpParticleKernels::esPositionY ];
+	const float * const positionZ = pStreams[ debpParticleKernels::esPositionZ ];
+	const float * const velocityX = pStreams[ debpParticleKernels::esVelocityX ];
+	const float * const velocityY = pStreams[ debpParticleKernels::esVelocityY ];
+	const float * const velocityZ = pStreams[ debpParticleKernels::esVelocityZ ];
+	const float * const rotation = pStreams[ debpParticleKernels::esRotation ];
+	const float * const angularVelocity = pStreams[ debpParticleKernels::esAngularVelocity ];
 	btScalar factor, velocity;
 	int p;
 	
@@ -461,25 +495,25 @@ void debpParticleEmitterInstanceType::UpdateGraphicParticles(){
 			const sParticle &srcParticle = pParticles[ p ];
 			
 			destParticle.lifetime = srcParticle.lifetime;
-			destParticle.positionX = ( float )( srcParticle.position.x() - position.x );
-			destParticle.positionY = ( float )( srcParticle.position.y() - position.y );
-			destParticle.positionZ = ( float )( srcParticle.position.z() - position.z );
+			destParticle.positionX = ( float )( positionX[ p ] - position.x );
+			destParticle.positionY = ( float )( positionY[ p ] - position.y );
+			destParticle.positionZ = ( float )( positionZ[ p ] - position.z );
 			
-			velocity = srcParticle.linearVelocity.length();
+			velocity = sqrtf( velocityX[ p ] * velocityX[ p ] + velocityY[ p ] * velocityY[ p ] + velocityZ[ p ] * velocityZ[ p ] );
 			if( velocity > 1e-5 ){
 				factor = 127.0 / velocity;
-				destParticle.linearDirectionX = ( signed char )decMath::clamp( ( int )( srcParticle.linearVelocity.x() * factor ), -127, 127 );
-				destParticle.linearDirectionY = ( signed char )decMath::clamp( ( int )( srcParticle.linearVelocity.y() * factor ), -127, 127 );
-				destParticle.linearDirectionZ = ( signed char )decMath::clamp( ( int )( srcParticle.linearVelocity.z() * factor ), -127, 127 );
+				destParticle.linearDirectionX = ( signed char )decMath::clamp( ( int )( velocityX[ p ] * factor ), -127, 127 );
+				destParticle.linearDirectionY = ( signed char )decMath::clamp( ( int )( velocityY[ p ] * factor ), -127, 127 );
+				destParticle.linearDirectionZ = ( signed char )decMath::clamp( ( int )( velocityZ[ p ] * factor ), -127, 127 );
 				
 			}else{ // dummy direction along z axis
 				destParticle.linearDirectionX = 0;
 				destParticle.linearDirectionY = 0;
 				destParticle.linearDirectionZ = 127;
 			}
-			destParticle.angularVelocity = ( signed char )decMath::clamp( ( int )( srcParticle.angularVelocity * factorAngVelo ), -127, 127 );
+			destParticle.angularVelocity = ( signed char )decMath::clamp( ( int )( angularVelocity[ p ] * factorAngVelo ), -127, 127 );
 			destParticle.linearVelocity = ( unsigned char )decMath::min( ( unsigned int )( velocity * factorLinVelo ), 255 );
-			destParticle.rotation = ( unsigned char )decMath::min( ( unsigned int )( srcParticle.rotation * rotationFactor ), 255 );
+			destParticle.rotation = ( unsigned char )decMath::min( ( unsigned int )( rotation[ p ] * rotationFactor ), 255 );
 			
 			destParticle.castSize = srcParticle.castSize;
 			destParticle.castEmissivity = srcParticle.castEmissivity;
@@ -608,12 +642,18 @@ void debpParticleEmitterInstanceType::KillParticle( int index ){
 	
 	if( simtype == deParticleEmitterType::estParticle ){
 		if( index < pParticleCount - 1 ){
-			memcpy( pParticles + index, pParticles + ( pParticleCount - 1 ), sizeof( sParticle ) );
+			pCopyParticle( pParticleCount - 1, index );
 		}
 		
 	}else{ // ribbon or beam
 		if( index < pParticleCount - 1 ){
-			memmove( pParticles + index, pParticles + ( index + 1 ), sizeof( sParticle ) * ( pParticleCount - 1 - index ) );
+			const int moveCount = pParticleCount - 1 - index;
+			int i;
+			
+			memmove( pParticles + index, pParticles + ( index + 1 ), sizeof( sParticle ) * moveCount );
+			for( i=0; i<debpParticleKernels::StreamCount; i++ ){
+				memmove( pStreams[ i ] + index, pStreams[ i ] + ( index + 1 ), sizeof( float ) * moveCount );
+			}
 		}
 	}
 	
@@ -649,23 +689,15 @@ void debpParticleEmitterInstanceType::KillAllParticles(){
 void debpParticleEmitterInstanceType::CastSingleParticle( float distance, float timeOffset ){
 	// enlarge the particles array if required 
 	if( pParticleCount == pParticleSize ){
-		const int newSize = pParticleSize + 10;
-		sParticle * const newArray = new sParticle[ newSize ];
-		
-		if( pParticles ){
-			memcpy( newArray, pParticles, sizeof( sParticle ) * pParticleSize );
-			delete [] pParticles;
-		}
-		pParticles = newArray;
-		pParticleSize = newSize;
+		pEnlargeParticles( pParticleSize * 3 / 2 + 10 );
 	}
 	
 	// set up new particle
-	sParticle &particle = pParticles[ pParticleCount++ ];
+	const int index = pParticleCount++;
 	
-	ParticleSetCastParams( particle, distance, timeOffset );
-	ParticleSetProgressParams( particle );
-	ParticleCreateTrailEmitter( particle );
+	ParticleSetCastParams( index, distance, timeOffset );
+	ParticleSetProgressParams( index );
+	ParticleCreateTrailEmitter( index );
 	
 	//printf( "cast: size=%g emi=%g color=(%i,%i,%i,%i)\n", particle.castSize, particle.castEmissivity, particle.castRed, particle.castGreen, particle.castBlue, particle.castTransparency );
 	//pBullet->LogInfoFormat( "cast particle: i=%i p(%.3g,%.3g,%.3g) v=(%.3g,%.3g,%.3g) s=%.1f ttl=%.1f", pParticleCount-1, P.position.x, P.position.y, P.position.z, P.velocity.x, P.velocity.y, P.velocity.z, P.size, P.timeToLive );
@@ -690,38 +722,30 @@ void debpParticleEmitterInstanceType::CastBeamParticle( float distance ){
 		// enlarge the particles array if required. we enlarge by the maximum particle count even
 		// if we should use less later on
 		if( pParticleCount + particleCount > pParticleSize ){
-			const int newSize = pParticleCount + particleCount + 10;
-			sParticle * const newArray = new sParticle[ newSize ];
-			
-			if( pParticles ){
-				memcpy( newArray, pParticles, sizeof( sParticle ) * pParticleSize );
-				delete [] pParticles;
-			}
-			pParticles = newArray;
-			pParticleSize = newSize;
+			pEnlargeParticles( pParticleCount + ( int )particleCount + 10 );
 		}
 		
 		// set up new particle
-		sParticle &particleCast = pParticles[ pParticleCount++ ];
+		const int castIndex = pParticleCount++;
 		
-		ParticleSetCastParams( particleCast, distance, 0.0f );
-		ParticleSetProgressParams( particleCast );
+		ParticleSetCastParams( castIndex, distance, 0.0f );
+		ParticleSetProgressParams( castIndex );
 		
 		// simulate the particle all the way to the end if there is more than one particle. if a kill particle
 		// is found the end of the beam is assumed
 		if( particleCount > 1 ){
 			const float lifetimeStep = 1.0f / ( float )( particleCount - 1 );
-			const float simTimeStep = particleCast.timeToLive * lifetimeStep;
+			const float simTimeStep = pParticles[ castIndex ].timeToLive * lifetimeStep;
 			
 			for( i=1; i<particleCount; i++ ){
-				memcpy( pParticles + pParticleCount, pParticles + ( pParticleCount - 1 ), sizeof( sParticle ) );
+				pCopyParticle( pParticleCount - 1, pParticleCount );
 				
-				sParticle &particleProgress = pParticles[ pParticleCount++ ];
-				particleProgress.lifetime += lifetimeStep;
+				const int progressIndex = pParticleCount++;
+				pParticles[ progressIndex ].lifetime += lifetimeStep;
 				
-				ParticleSetProgressParams( particleProgress );
-				//ParticleCreateTrailEmitter( particleProgress ); // does this make sense? it would be possible
-				if( ! ParticleSimulate( particleProgress, simTimeStep ) ){
+				ParticleSetProgressParams( progressIndex );
+				//ParticleCreateTrailEmitter( progressIndex ); // does this make sense? it would be possible
+				if( ! ParticleSimulate( progressIndex, simTimeStep ) ){
 					break;
 				}
 			}
@@ -740,13 +764,15 @@ void debpParticleEmitterInstanceType::CastBeamParticle( float distance ){
 		// been cast since the first particle is used as blue print and copied over to all other particles
 		// then modified. if the trail emitter exists already it is multiplied across the beam which is not
 		// only looking wrong it trashes the reference count of the trail emitter.
-		ParticleCreateTrailEmitter( particleCast );
+		ParticleCreateTrailEmitter( castIndex );
 	}
 }
 
 
 
-void debpParticleEmitterInstanceType::ParticleSetCastParams( sParticle &particle, float distance, float timeOffset ){
+void debpParticleEmitterInstanceType::ParticleSetCastParams( int index, float distance, float timeOffset ){
+	sParticle &particle = pParticles[ index ];
+	
 	// important to avoid problems later on in bad cases
 	particle.trailEmitter = NULL;
 	
@@ -830,13 +856,13 @@ void debpParticleEmitterInstanceType::ParticleSetCastParams( sParticle &particle
 	particle.lifetimeFactor = 1.0f / particle.timeToLive;
 	particle.lifetime = timeOffset;
 	
-	particle.position.setValue( ( btScalar )castMatrix.a14, ( btScalar )castMatrix.a24, ( btScalar )castMatrix.a34 );
-	particle.rotation = particle.castRotation;
+	pSetPosition( index, btVector3( ( btScalar )castMatrix.a14, ( btScalar )castMatrix.a24, ( btScalar )castMatrix.a34 ) );
+	pStreams[ debpParticleKernels::esRotation ][ index ] = particle.castRotation;
 	
 	view = castMatrix.TransformView() * particle.castLinearVelocity;
-	particle.linearVelocity.setValue( ( btScalar )view.x, ( btScalar )view.y, ( btScalar )view.z );
+	pSetLinearVelocity( index, btVector3( ( btScalar )view.x, ( btScalar )view.y, ( btScalar )view.z ) );
 	
-	particle.angularVelocity = particle.castAngularVelocity
+	pStreams[ debpParticleKernels::esAngularVelocity ][ index ] = particle.castAngularVelocity
 		* type.EvaluateProgressParameter( debpParticleEmitterType::escAngularVelocity, 0.0f );
 }
 
@@ -1043,7 +1069,7 @@ void debpParticleEmitterInstanceType::ParticleCastMatrix( decDMatrix &matrix ){
 	}
 }
 
-void debpParticleEmitterInstanceType::ParticleCreateTrailEmitter( sParticle &particle ){
+void debpParticleEmitterInstanceType::ParticleCreateTrailEmitter( int index ){
 	const deParticleEmitterType &engType = pInstance->GetParticleEmitter()->GetEmitter()->GetTypeAt( pType );
 	if( ! engType.GetTrailEmitter() ){
 		return;
@@ -1051,7 +1077,9 @@ void debpParticleEmitterInstanceType::ParticleCreateTrailEmitter( sParticle &par
 	
 	deWorld &engWorld = pInstance->GetParentWorld()->GetWorld();
 	const deEngine &engine = *pInstance->GetBullet()->GetGameEngine();
-	const btVector3 direction = -particle.linearVelocity;
+	sParticle &particle = pParticles[ index ];
+	const btVector3 direction = -pGetLinearVelocity( index );
+	const btVector3 position( pGetPosition( index ) );
 	
 	try{
 		particle.trailEmitter = engine.GetParticleEmitterInstanceManager()->CreateInstance();
@@ -1061,7 +1089,7 @@ void debpParticleEmitterInstanceType::ParticleCreateTrailEmitter( sParticle &par
 		particle.trailEmitter->SetTimeScale( 1.0f );
 		particle.trailEmitter->SetEnableCasting( true );
 		
-		particle.trailEmitter->SetPosition( decDVector( particle.position.getX(), particle.position.getY(), particle.position.getZ() ) );
+		particle.trailEmitter->SetPosition( decDVector( position.getX(), position.getY(), position.getZ() ) );
 		particle.trailEmitter->SetReferencePosition( particle.trailEmitter->GetPosition() );
 		
 		if( direction.getY() > 1.0 - DVECTOR_THRESHOLD ){
@@ -1086,34 +1114,36 @@ void debpParticleEmitterInstanceType::ParticleCreateTrailEmitter( sParticle &par
 	}
 }
 
-void debpParticleEmitterInstanceType::ParticleSetProgressParams( sParticle &particle ){
+void debpParticleEmitterInstanceType::ParticleSetProgressParams( int index ){
 	const debpParticleEmitter &emitter = *pInstance->GetParticleEmitter();
 	const debpParticleEmitterType &type = emitter.GetTypeAt( pType );
 	const debpWorld * const world = pInstance->GetParentWorld();
+	sParticle &particle = pParticles[ index ];
 	
 	particle.size = particle.castSize *
 		type.EvaluateProgressParameter( debpParticleEmitterType::escSize, particle.lifetime );
-	particle.mass = decMath::max( 1e-5f, particle.castMass *
+	const float mass = decMath::max( 1e-5f, particle.castMass *
 		type.EvaluateProgressParameter( debpParticleEmitterType::escMass, particle.lifetime ) );
+	pStreams[ debpParticleKernels::esMass ][ index ] = mass;
 	
 	particle.brown = particle.castBrown *
 		type.EvaluateProgressParameter( debpParticleEmitterType::escBrown, particle.lifetime );
-	particle.damp = particle.castDamp *
+	pStreams[ debpParticleKernels::esDamp ][ index ] = particle.castDamp *
 		type.EvaluateProgressParameter( debpParticleEmitterType::escDamp, particle.lifetime );
-	particle.drag = particle.castDrag *
+	pStreams[ debpParticleKernels::esDrag ][ index ] = particle.castDrag *
 		type.EvaluateProgressParameter( debpParticleEmitterType::escDrag, particle.lifetime );
 	particle.elasticity = particle.castElasticity *
 		type.EvaluateProgressParameter( debpParticleEmitterType::escElasticity, particle.lifetime );
 	particle.roughness = particle.castRoughness *
 		type.EvaluateProgressParameter( debpParticleEmitterType::escRoughness, particle.lifetime );
 	
-	particle.forceFieldDirect = particle.castForceFieldDirect *
+	pStreams[ debpParticleKernels::esForceFieldDirect ][ index ] = particle.castForceFieldDirect *
 		type.EvaluateProgressParameter( debpParticleEmitterType::escForceFieldDirect, particle.lifetime );
-	particle.forceFieldSurface = particle.castForceFieldSurface *
+	pStreams[ debpParticleKernels::esForceFieldSurface ][ index ] = particle.castForceFieldSurface *
 		type.EvaluateProgressParameter( debpParticleEmitterType::escForceFieldSurface, particle.lifetime );
-	particle.forceFieldMass = particle.castForceFieldMass *
+	pStreams[ debpParticleKernels::esForceFieldMass ][ index ] = particle.castForceFieldMass *
 		type.EvaluateProgressParameter( debpParticleEmitterType::escForceFieldVolume, particle.lifetime );
-	particle.forceFieldSpeed = particle.castForceFieldSpeed *
+	pStreams[ debpParticleKernels::esForceFieldSpeed ][ index ] = particle.castForceFieldSpeed *
 		type.EvaluateProgressParameter( debpParticleEmitterType::escForceFieldSpeed, particle.lifetime );
 	
 	// calculate gravity. it is a bit convoluted to avoid calculating not used stuff
@@ -1158,7 +1188,7 @@ void debpParticleEmitterInstanceType::ParticleSetProgressParams( sParticle &part
 	}
 	
 	// apply gravity
-	particle.force = particle.gravity * particle.mass;
+	btVector3 force( particle.gravity * mass );
 	
 	// apply brown motion
 	if( particle.brown > 1e-5f ){
@@ -1168,106 +1198,50 @@ void debpParticleEmitterInstanceType::ParticleSetProgressParams( sParticle &part
 		brownMotion.setY( ( btScalar )random() * vRandomFactor * 2.0 - 1.0 );
 		brownMotion.setZ( ( btScalar )random() * vRandomFactor * 2.0 - 1.0 );
 		
-		particle.force += brownMotion * ( btScalar )( particle.brown * particle.mass );
+		force += brownMotion * ( btScalar )( particle.brown * mass );
 	}
+	
+	pStreams[ debpParticleKernels::esForceX ][ index ] = ( float )force.getX();
+	pStreams[ debpParticleKernels::esForceY ][ index ] = ( float )force.getY();
+	pStreams[ debpParticleKernels::esForceZ ][ index ] = ( float )force.getZ();
 }
 
-bool debpParticleEmitterInstanceType::ParticleSimulate( sParticle &particle, float elapsed ){
-	// apply force
-	particle.linearVelocity += particle.force * ( btScalar )( elapsed / particle.mass );
-	
-	// apply air drag
-	if( particle.drag > 1e-10f ){
-		const btScalar factor1 = 1.0 - ( btScalar )( particle.drag * 
-			particle.linearVelocity.dot( particle.linearVelocity ) * elapsed / particle.mass );
-		
-		if( factor1 > 0.0 ){
-			particle.linearVelocity *= factor1;
-			
-		}else{
-			particle.linearVelocity.setZero();
-		}
-	}
-	
-	// damp velocities
-	if( particle.damp > 1e-5f ){
-		const btScalar factor1 = 1.0 - ( btScalar )particle.damp;// * btElapsed;
-		
-		if( factor1 > 0.0 ){
-			particle.linearVelocity *= factor1;
-			particle.angularVelocity *= factor1;
-			
-		}else{
-			particle.linearVelocity.setZero();
-			particle.angularVelocity = 0.0f;
-		}
-	}
-	
-	// apply angular rotation
-	particle.rotation = fmodf( particle.rotation + particle.angularVelocity * elapsed, PI * 2.0f );
+bool debpParticleEmitterInstanceType::ParticleSimulate( int index, float elapsed ){
+	// apply force, air drag, damping and angular rotation
+	debpParticleKernels::IntegrateScalar( pStreams, index, 1, elapsed );
 	
 	// step linear motion
 	if( pInstance->GetCanCollide() ){
-		return ParticleTestCollision( particle, elapsed );
+		return ParticleTestCollision( index, elapsed, NULL );
 		
 	}else{
-		particle.position += particle.linearVelocity * ( btScalar )elapsed;
+		debpParticleKernels::AdvanceScalar( pStreams, index, 1, elapsed );
 	}
 	
 	return true;
 }
 
-class cClosestParticleCallback : public btCollisionWorld::ClosestConvexResultCallback{
-private:
-	const decCollisionFilter &pCollisionFilter;
-	
-public:
-	cClosestParticleCallback( const btVector3 &rayFromWorld, const btVector3 &rayToWorld,
-	const decCollisionFilter &collisionFilter ) :
-	ClosestConvexResultCallback( rayFromWorld, rayToWorld ),
-	pCollisionFilter( collisionFilter ){
-	}
-	
-	virtual bool needsCollision( btBroadphaseProxy *proxy0 ) const {
-		if( ! ClosestConvexResultCallback::needsCollision( proxy0 ) ){
-			return false;
-		}
-		
-		const btCollisionObject &collisionObject = *( ( btCollisionObject* )proxy0->m_clientObject );
-		const debpCollisionObject &colObj = *( ( debpCollisionObject* )collisionObject.getUserPointer() );
-		
-		if( colObj.IsOwnerCollider() ){
-			return pCollisionFilter.Collides( colObj.GetOwnerCollider()->GetCollider().GetCollisionFilter() );
-			
-		}else if( colObj.IsOwnerHTSector() ){
-			return pCollisionFilter.Collides( colObj.GetOwnerHTSector()->GetHeightTerrain()
-				->GetHeightTerrain()->GetCollisionFilter() );
-		}
-		
-		return false;
-	}
-};
-
-bool debpParticleEmitterInstanceType::ParticleTestCollision( sParticle &particle, float elapsed ){
+bool debpParticleEmitterInstanceType::ParticleTestCollision( int index,
+float elapsed, const debpParticleStepJob::sSweep *firstSweep ){
 	// pBullet->LogInfoFormat( "step particle %i: elapsed=%g displacement=(%g,%g,%g)", p, elapsed, displacement.getX(), displacement.getY(), displacement.getZ() );
 	const deParticleEmitterType &engType = pInstance->GetParticleEmitter()->GetEmitter()->GetTypeAt( pType );
 	debpCollisionWorld &dynamicsWorld = *pInstance->GetParentWorld()->GetDynamicsWorld();
 	const decCollisionFilter &collisionFilter = pInstance->GetInstance()->GetCollisionFilter();
-	btVector3 displacement = particle.linearVelocity * elapsed;
+	debpSweepCollisionTest &sweepTest = GetSweepCollisionTest();
+	const sParticle &particle = pParticles[ index ];
+	const float mass = pStreams[ debpParticleKernels::esMass ][ index ];
+	btVector3 position( pGetPosition( index ) );
+	btVector3 linearVelocity( pGetLinearVelocity( index ) );
+	btVector3 displacement = linearVelocity * elapsed;
 	int loop;
 	
-	// the bullet shpere-box test is quite error-prone. particles keep on falling through
-	// no matter what you do. what is the problem here?
-	//btSphereShape sphereShape( ( btScalar )decMath::max( engType.GetPhysicsSize(), 0.001f ) );
-	btSphereShape sphereShape( ( btScalar )decMath::max( engType.GetPhysicsSize(), 0.01f ) );
-	
 	for( loop=0; loop<5; loop++ ){
 		if( displacement.length2() < 1e-8 ){
-			particle.linearVelocity.setZero();
+			linearVelocity.setZero();
 			break;
 		}
 		
-		const btVector3 rayToWorld = particle.position + displacement;
+		const btVector3 rayToWorld = position + displacement;
 		
 		// TODO use size of particle to do a sphere collision test instead of a ray test
 		
@@ -1280,18 +1254,25 @@ bool debpParticleEmitterInstanceType::ParticleTestCollision( sParticle &particle
 		//pBullet->LogInfoFormat( "rayTest: pos=(%g,%g,%g) to(%g,%g,%g) time=%g", particle.position.getX(), particle.position.getY(),
 		//	particle.position.getZ(), rayToWorld.getX(), rayToWorld.getY(), rayToWorld.getZ(), elapsed );
 		
-		cClosestParticleCallback rayResult( particle.position, rayToWorld, collisionFilter );
-		{
-		//sphereShape.setUnscaledRadius( ... );
-		const btQuaternion btQuaterion( ( btScalar )0.0, ( btScalar )0.0, ( btScalar )0.0, ( btScalar )1.0 );
-		const btTransform btTransformFrom( btQuaterion, particle.position );
-		const btTransform btTransformTo( btQuaterion, rayToWorld );
+		debpParticleResultCallback rayResult( position, rayToWorld, collisionFilter );
 		
-		dynamicsWorld.convexSweepTest( &sphereShape, btTransformFrom, btTransformTo, rayResult, BT_ZERO );
+		if( loop == 0 && firstSweep && firstSweep->swept ){
+			// first sweep has been run by the particle step job
+			rayResult.m_closestHitFraction = firstSweep->hitFraction;
+			rayResult.m_hitNormalWorld = firstSweep->hitNormal;
+			rayResult.m_hitPointWorld = firstSweep->hitPoint;
+			rayResult.m_hitCollisionObject = firstSweep->hitCollisionObject;
+			
+		}else{
+			const btQuaternion btQuaterion( ( btScalar )0.0, ( btScalar )0.0, ( btScalar )0.0, ( btScalar )1.0 );
+			const btTransform btTransformFrom( btQuaterion, position );
+			const btTransform btTransformTo( btQuaterion, rayToWorld );
+			
+			sweepTest.SweepTest( dynamicsWorld, btTransformFrom, btTransformTo, rayResult );
 		}
 		
 		if( ! rayResult.hasHit() ){
-			particle.position += displacement;
+			position += displacement;
 			//pBullet->LogInfoFormat( "no hit: pos=(%g,%g,%g)", particle.position.getX(), particle.position.getY(), particle.position.getZ() );
 			break;
 		}
@@ -1302,10 +1283,10 @@ bool debpParticleEmitterInstanceType::ParticleTestCollision( sParticle &particle
 		bool doEmitParticles = false;
 		
 		if( engType.GetCollisionEmitter() ){
-			particleLinearVelocity = ( float )particle.linearVelocity.length();
+			particleLinearVelocity = ( float )linearVelocity.length();
 			particleLinearVelocity *= particle.elasticity;
 			
-			if( particleLinearVelocity * particle.mass > engType.GetEmitMinImpulse() ){
+			if( particleLinearVelocity * mass > engType.GetEmitMinImpulse() ){
 				// sanity check to avoid dead-loops due to an emitter without emit-burst set as these would live forever
 				if( engType.GetCollisionEmitter()->GetEmitBurst() ){
 					doEmitParticles = true;
@@ -1317,8 +1298,8 @@ bool debpParticleEmitterInstanceType::ParticleTestCollision( sParticle &particle
 		deParticleEmitterType::eCollisionResponses collisionResponse = engType.GetCollisionResponse();
 		
 		if( collisionResponse != deParticleEmitterType::ecrDestroy || doEmitParticles ){
-			particle.position += displacement * rayResult.m_closestHitFraction;
-			particle.position += rayResult.m_hitNormalWorld * 0.0001; // prevent falling through
+			position += displacement * rayResult.m_closestHitFraction;
+			position += rayResult.m_hitNormalWorld * 0.0001; // prevent falling through
 			displacement *= 1.0 - rayResult.m_closestHitFraction;
 		}
 		
@@ -1349,23 +1330,29 @@ bool debpParticleEmitterInstanceType::ParticleTestCollision( sParticle &particle
 				( float )rayResult.m_hitNormalWorld.getY(),
 				( float )rayResult.m_hitNormalWorld.getZ() );
 			const decDVector ciposition(
-				( double )particle.position.getX(),
-				( double )particle.position.getY(),
-				( double )particle.position.getZ() );
+				( double )position.getX(),
+				( double )position.getY(),
+				( double )position.getZ() );
 			const decVector civelocity(
-				( float )particle.linearVelocity.getX(),
-				( float )particle.linearVelocity.getY(),
-				( float )particle.linearVelocity.getZ() );
+				( float )linearVelocity.getX(),
+				( float )linearVelocity.getY(),
+				( float )linearVelocity.getZ() );
 			
 			cinfo.SetNormal( cinormal );
 			cinfo.SetDistance( ( float )( elapsed * ( ( btScalar )1.0 - rayResult.m_closestHitFraction ) ) );
 			cinfo.SetParticleLifetime( particle.lifetime );
-			cinfo.SetParticleMass( particle.mass );
+			cinfo.SetParticleMass( mass );
 			cinfo.SetParticlePosition( ciposition );
 			cinfo.SetParticleVelocity( civelocity );
 			cinfo.SetParticleResponse( deParticleEmitterType::ecrDestroy );
 			
 			pInstance->GetInstance()->CollisionResponse( &cinfo );
+			pCollisionResponseCalled = true;
+			
+			// the listener can kill particles or remove the instance from the world
+			if( index >= pParticleCount || ! pInstance->GetParentWorld() ){
+				return true;
+			}
 			
 			collisionResponse = cinfo.GetParticleResponse();
 		}
@@ -1426,7 +1413,7 @@ bool debpParticleEmitterInstanceType::ParticleTestCollision( sParticle &particle
 				}
 				
 				// set controller values
-				ParticleSetEmitterControllers( particle, *emitInstance, particleLinearVelocity );
+				ParticleSetEmitterControllers( index, *emitInstance, particleLinearVelocity );
 				
 				// add to the world. this has to come before casting just to be safe
 				pInstance->GetParentWorld()->GetWorld().AddParticleEmitter( emitInstance );
@@ -1445,7 +1432,7 @@ bool debpParticleEmitterInstanceType::ParticleTestCollision( sParticle &particle
 		// apply collision response
 		switch( collisionResponse ){
 		case deParticleEmitterType::ecrPhysical:
-			particle.linearVelocity = displacement / elapsed;
+			linearVelocity = displacement / elapsed;
 			elapsed *= 1.0f - ( float )rayResult.m_closestHitFraction;
 			break;
 			
@@ -1454,8 +1441,8 @@ bool debpParticleEmitterInstanceType::ParticleTestCollision( sParticle &particle
 			const decDVector &ciposition = cinfo.GetParticlePosition();
 			const decVector &civelocity = cinfo.GetParticleVelocity();
 			
-			particle.position.setValue( ( btScalar )ciposition.x, ( btScalar )ciposition.y, ( btScalar )ciposition.z );
-			particle.linearVelocity.setValue( ( btScalar )civelocity.x, ( btScalar )civelocity.y, ( btScalar )civelocity.z );
+			position.setValue( ( btScalar )ciposition.x, ( btScalar )ciposition.y, ( btScalar )ciposition.z );
+			linearVelocity.setValue( ( btScalar )civelocity.x, ( btScalar )civelocity.y, ( btScalar )civelocity.z );
 			elapsed *= 1.0f - ( float )rayResult.m_closestHitFraction;
 			}break;
 			
@@ -1464,11 +1451,14 @@ bool debpParticleEmitterInstanceType::ParticleTestCollision( sParticle &particle
 		}
 	}
 	
+	pSetPosition( index, position );
+	pSetLinearVelocity( index, linearVelocity );
 	return true;
 }
 
-void debpParticleEmitterInstanceType::ParticleSetEmitterControllers( const sParticle &particle,
+void debpParticleEmitterInstanceType::ParticleSetEmitterControllers( int index,
 deParticleEmitterInstance &instance, float linearVelocity ){
+	const sParticle &particle = pParticles[ index ];
 	const deParticleEmitterType &engType = pInstance->GetParticleEmitter()->GetEmitter()->GetTypeAt( pType );
 	int controllerIndex;
 	
@@ -1480,7 +1470,7 @@ deParticleEmitterInstance &instance, float linearVelocity ){
 	
 	controllerIndex = engType.GetEmitController( deParticleEmitterType::eecMass );
 	if( controllerIndex != -1 ){
-		instance.GetControllerAt( controllerIndex ).SetValue( particle.mass );
+		instance.GetControllerAt( controllerIndex ).SetValue( pStreams[ debpParticleKernels::esMass ][ index ] );
 		instance.NotifyControllerChangedAt( controllerIndex );
 	}
 	
@@ -1492,20 +1482,23 @@ deParticleEmitterInstance &instance, float linearVelocity ){
 	
 	controllerIndex = engType.GetEmitController( deParticleEmitterType::eecAngularVelocity );
 	if( controllerIndex != -1 ){
-		instance.GetControllerAt( controllerIndex ).SetValue( particle.angularVelocity );
+		instance.GetControllerAt( controllerIndex ).SetValue( pStreams[ debpParticleKernels::esAngularVelocity ][ index ] );
 		instance.NotifyControllerChangedAt( controllerIndex );
 	}
 }
 
-void debpParticleEmitterInstanceType::ParticleUpdateTrailEmitter( const sParticle &particle ){
+void debpParticleEmitterInstanceType::ParticleUpdateTrailEmitter( int index ){
+	const sParticle &particle = pParticles[ index ];
 	if( ! particle.trailEmitter ){
 		return;
 	}
 	
-	btVector3 direction( -particle.linearVelocity );
+	const btVector3 linearVelocity( pGetLinearVelocity( index ) );
+	const btVector3 position( pGetPosition( index ) );
+	btVector3 direction( -linearVelocity );
 	
 	// set position and orientation
-	particle.trailEmitter->SetPosition( decDVector( particle.position.getX(), particle.position.getY(), particle.position.getZ() ) );
+	particle.trailEmitter->SetPosition( decDVector( position.getX(), position.getY(), position.getZ() ) );
 	
 	// set orientation only if the linear velocity is not zero. otherwise keep the old orientation
 	if( direction.length() > 0.001 ){
@@ -1524,11 +1517,12 @@ void debpParticleEmitterInstanceType::ParticleUpdateTrailEmitter( const sParticl
 	}
 	
 	// set controller values
-	ParticleSetTrailEmitterControllers( particle, *particle.trailEmitter, particle.linearVelocity.length() );
+	ParticleSetTrailEmitterControllers( index, *particle.trailEmitter, linearVelocity.length() );
 }
 
-void debpParticleEmitterInstanceType::ParticleSetTrailEmitterControllers( const sParticle &particle,
+void debpParticleEmitterInstanceType::ParticleSetTrailEmitterControllers( int index,
 deParticleEmitterInstance &instance, float linearVelocity ){
+	const sParticle &particle = pParticles[ index ];
 	const deParticleEmitterType &engType = pInstance->GetParticleEmitter()->GetEmitter()->GetTypeAt( pType );
 	int controllerIndex;
 	
@@ -1540,7 +1534,7 @@ deParticleEmitterInstance &instance, float linearVelocity ){
 	
 	controllerIndex = engType.GetTrailController( deParticleEmitterType::eecMass );
 	if( controllerIndex != -1 ){
-		instance.GetControllerAt( controllerIndex ).SetValue( particle.mass );
+		instance.GetControllerAt( controllerIndex ).SetValue( pStreams[ debpParticleKernels::esMass ][ index ] );
 		instance.NotifyControllerChangedAt( controllerIndex );
 	}
 	
@@ -1552,7 +1546,7 @@ deParticleEmitterInstance &instance, float linearVelocity ){
 	
 	controllerIndex = engType.GetTrailController( deParticleEmitterType::eecAngularVelocity );
 	if( controllerIndex != -1 ){
-		instance.GetControllerAt( controllerIndex ).SetValue( particle.angularVelocity );
+		instance.GetControllerAt( controllerIndex ).SetValue( pStreams[ debpParticleKernels::esAngularVelocity ][ index ] );
 		instance.NotifyControllerChangedAt( controllerIndex );
 	}
 }
@@ -1571,4 +1565,82 @@ void debpParticleEmitterInstanceType::pCleanUp(){
 	if( pParticles ){
 		delete [] pParticles;
 	}
+	if( pStreamData ){
+		delete [] pStreamData;
+	}
+	if( pSweepTest ){
+		delete pSweepTest;
+	}
+}
+
+void debpParticleEmitterInstanceType::pEnlargeParticles( int size ){
+	if( size <= pParticleSize ){
+		return;
+	}
+	
+	sParticle * const newParticles = new sParticle[ size ];
+	float *newStreamData = NULL;
+	int i;
+	
+	try{
+		newStreamData = new float[ size * debpParticleKernels::StreamCount ];
+		
+	}catch( ... ){
+		delete [] newParticles;
+		throw;
+	}
+	
+	if( pParticles ){
+		memcpy( newParticles, pParticles, sizeof( sParticle ) * pParticleCount );
+		delete [] pParticles;
+	}
+	pParticles = newParticles;
+	
+	for( i=0; i<debpParticleKernels::StreamCount; i++ ){
+		float * const newStream = newStreamData + size * i;
+		if( pStreams[ i ] ){
+			memcpy( newStream, pStreams[ i ], sizeof( float ) * pParticleCount );
+		}
+		pStreams[ i ] = newStream;
+	}
+	
+	if( pStreamData ){
+		delete [] pStreamData;
+	}
+	pStreamData = newStreamData;
+	
+	pParticleSize = size;
+}
+
+void debpParticleEmitterInstanceType::pCopyParticle( int from, int to ){
+	int i;
+	
+	memcpy( pParticles + to, pParticles + from, sizeof( sParticle ) );
+	for( i=0; i<debpParticleKernels::StreamCount; i++ ){
+		pStreams[ i ][ to ] = pStreams[ i ][ from ];
+	}
+}
+
+btVector3 debpParticleEmitterInstanceType::pGetPosition( int index ) const{
+	return btVector3( pStreams[ debpParticleKernels::esPositionX ][ index ],
+		pStreams[ debpParticleKernels::esPositionY ][ index ],
+		pStreams[ debpParticleKernels::esPositionZ ][ index ] );
+}
+
+void debpParticleEmitterInstanceType::pSetPosition( int index, const btVector3 &position ){
+	pStreams[ debpParticleKernels::esPositionX ][ index ] = ( float )position.getX();
+	pStreams[ debpParticleKernels::esPositionY ][ index ] = ( float )position.getY();
+	pStreams[ debpParticleKernels::esPositionZ ][ index ] = ( float )position.getZ();
+}
+
+btVector3 debpParticleEmitterInstanceType::pGetLinearVelocity( int index ) const{
+	return btVector3( pStreams[ debpParticleKernels::esVelocityX ][ index ],
+		pStreams[ debpParticleKernels::esVelocityY ][ index ],
+		pStreams[ debpParticleKernels::esVelocityZ ][ index ] );
+}
+
+void debpParticleEmitterInstanceType::pSetLinearVelocity( int index, const btVector3 &velocity ){
+	pStreams[ debpParticleKernels::esVelocityX ][ index ] = ( float )velocity.getX();
+	pStreams[ debpParticleKernels::esVelocityY ][ index ] = ( float )velocity.getY();
+	pStreams[ debpParticleKernels::esVelocityZ ][ index ] = ( float )velocity.getZ();
 }
@@ -22,6 +22,9 @@
 #ifndef _DEBPPROPPARTICLEEMITTERINSTANCETYPE_H_
 #define _DEBPPROPPARTICLEEMITTERINSTANCETYPE_H_
 
+#include "debpParticleKernels.h"
+#include "debpParticleStepJob.h"
+
 #include "LinearMath/btVector3.h"
 
 #include <dragengine/resources/particle/deParticleEmitterInstanceType.h>
@@ -29,34 +32,27 @@
 class debpForceField;
 class debpParticleEmitterInstance;
 class debpComponent;
+class debpSweepCollisionTest;
 class deParticleEmitterInstance;
 
 
 
 /**
  * @brief Particle Emitter Instance Type.
+ * 
+ * Parameters used during simulation are stored in structure of arrays layout using one
+ * stream per parameter as defined by debpParticleKernels. All other parameters are stored
+ * in sParticle. Both use the same particle index.
  */
 class debpParticleEmitterInstanceType{
 public:
 	struct sParticle{
-		btVector3 position;
-		btVector3 linearVelocity;
-		btVector3 force;
-		float rotation;
-		float angularVelocity;
 		btVector3 gravity;
-		float forceFieldDirect;
-		float forceFieldSurface;
-		float forceFieldMass;
-		float forceFieldSpeed;
 		float timeToLive;
 		float lifetimeFactor;
 		float lifetime;
 		float size;
-		float mass;
 		float brown;
-		float damp;
-		float drag;
 		float elasticity;
 		float roughness;
 		
@@ -95,8 +91,14 @@ private:
 	debpComponent *pComponent;
 	
 	sParticle *pParticles;
+	float *pStreamData;
+	float *pStreams[ debpParticleKernels::StreamCount ];
 	int pParticleCount;
 	int pParticleSize;
+	bool pCollisionResponseCalled;
+	
+	debpSweepCollisionTest *pSweepTest;
+	float pSweepTestRadius;
 	
 	float pCastIntervalMin;
 	float pCastIntervalGap;
@@ -133,6 +135,12 @@ public:
 	/** Retrieves the number of particles. */
 	inline int GetParticlesCount() const{ return pParticleCount; }
 	
+	/** Particle streams indexed by debpParticleKernels::eStreams. */
+	inline float * const *GetStreams() const{ return pStreams; }
+	
+	/** Sweep collision test with particle physics size updated if required. */
+	debpSweepCollisionTest &GetSweepCollisionTest();
+	
 	/** Prepare stepping. */
 	void PrepareParticles( float elapsed, float travelledDistance );
 	/** Applies forces caused by a force field. */
@@ -165,30 +173,40 @@ public:
 	void CastBeamParticle( float distance );
 	
 	/** Set the cast values of a particle. */
-	void ParticleSetCastParams( sParticle &particle, float distance, float timeOffset );
+	void ParticleSetCastParams( int index, float distance, float timeOffset );
 	/** Calculate for a particle the cast matrix. */
 	void ParticleCastMatrix( decDMatrix &matrix );
 	/** Create trail emitter for a particle. */
-	void ParticleCreateTrailEmitter( sParticle &particle );
+	void ParticleCreateTrailEmitter( int index );
 	/** Set particle progress parameters for a point in time from cast parameters using the particle lifetime value. */
-	void ParticleSetProgressParams( sParticle &particle );
+	void ParticleSetProgressParams( int index );
 	
 	/** Simulate particle. Returns false if the particle has to be killed due to a collision or true to keep it alive. */
-	bool ParticleSimulate( sParticle &particle, float elapsed );
-	/** Test for particle collision. Returns false if the particle has to be killed due to a collision or true to keep it alive. */
-	bool ParticleTestCollision( sParticle &particle, float elapsed );
+	bool ParticleSimulate( int index, float elapsed );
+	/**
+	 * Test for particle collision. Returns false if the particle has to be killed due to a collision or true to keep it alive.
+	 * If \em firstSweep is not NULL it is used as result of the first sweep instead of running it.
+	 */
+	bool ParticleTestCollision( int index, float elapsed, const debpParticleStepJob::sSweep *firstSweep );
 	/** Set controllers of a trail or impact emitter. */
-	void ParticleSetEmitterControllers( const sParticle &particle,
+	void ParticleSetEmitterControllers( int index,
 		deParticleEmitterInstance &instance, float linearVelocity );
 	/** Update particle trail emitter if existing. */
-	void ParticleUpdateTrailEmitter( const sParticle &particle );
+	void ParticleUpdateTrailEmitter( int index );
 	/** Set controllers of a trail or impact emitter. */
-	void ParticleSetTrailEmitterControllers( const sParticle &particle,
+	void ParticleSetTrailEmitterControllers( int index,
 		deParticleEmitterInstance &instance, float linearVelocity );
 	/*@}*/
 	
 private:
 	void pCleanUp();
+	void pEnlargeParticles( int size );
+	void pCopyParticle( int from, int to );
+	
+	btVector3 pGetPosition( int index ) const;
+	void pSetPosition( int index, const btVector3 &position );
+	btVector3 pGetLinearVelocity( int index ) const;
+	void pSetLinearVelocity( int index, const btVector3 &velocity );
 };
 
 #endif
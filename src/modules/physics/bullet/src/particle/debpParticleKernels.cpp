@@ -0,0 +1,443 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "debpParticleKernels.h"
+
+#include <dragengine/common/exceptions.h>
+#include <dragengine/common/math/decMath.h>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define BP_PARTICLEKERNELS_SSE 1
+#include <emmintrin.h>
+#endif
+
+
+
+// Definitions
+////////////////
+
+#define PI2 ( PI * 2.0f )
+
+#ifdef BP_PARTICLEKERNELS_SSE
+// mask ? a : b
+static inline __m128 fSelect( __m128 mask, __m128 a, __m128 b ){
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+#endif
+
+
+
+// Class debpParticleKernels
+//////////////////////////////
+
+// Simulation
+///////////////
+
+void debpParticleKernels::Integrate( float * const *streams, int first, int count, float elapsed ){
+#ifdef BP_PARTICLEKERNELS_SSE
+	float * const velocityX = streams[ esVelocityX ];
+	float * const velocityY = streams[ esVelocityY ];
+	float * const velocityZ = streams[ esVelocityZ ];
+	const float * const forceX = streams[ esForceX ];
+	const float * const forceY = streams[ esForceY ];
+	const float * const forceZ = streams[ esForceZ ];
+	const float * const mass = streams[ esMass ];
+	const float * const damp = streams[ esDamp ];
+	const float * const drag = streams[ esDrag ];
+	float * const rotation = streams[ esRotation ];
+	float * const angularVelocity = streams[ esAngularVelocity ];
+	
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 elapsed4 = _mm_set1_ps( elapsed );
+	const __m128 dragThreshold = _mm_set1_ps( 1e-10f );
+	const __m128 dampThreshold = _mm_set1_ps( 1e-5f );
+	const __m128 pi2 = _mm_set1_ps( PI2 );
+	const __m128 invPi2 = _mm_set1_ps( 1.0f / PI2 );
+	const int last = first + ( count & ~3 );
+	int i;
+	
+	for( i=first; i<last; i+=4 ){
+		const __m128 elapsedMass = _mm_div_ps( elapsed4, _mm_loadu_ps( mass + i ) );
+		
+		// apply force
+		__m128 vx = _mm_add_ps( _mm_loadu_ps( velocityX + i ), _mm_mul_ps( _mm_loadu_ps( forceX + i ), elapsedMass ) );
+		__m128 vy = _mm_add_ps( _mm_loadu_ps( velocityY + i ), _mm_mul_ps( _mm_loadu_ps( forceY + i ), elapsedMass ) );
+		__m128 vz = _mm_add_ps( _mm_loadu_ps( velocityZ + i ), _mm_mul_ps( _mm_loadu_ps( forceZ + i ), elapsedMass ) );
+		
+		// apply air drag. negative factors clamp velocity to zero
+		const __m128 d = _mm_loadu_ps( drag + i );
+		const __m128 speedSquared = _mm_add_ps( _mm_add_ps( _mm_mul_ps( vx, vx ), _mm_mul_ps( vy, vy ) ), _mm_mul_ps( vz, vz ) );
+		const __m128 dragFactor = fSelect( _mm_cmpgt_ps( d, dragThreshold ), _mm_max_ps( zero,
+			_mm_sub_ps( one, _mm_mul_ps( _mm_mul_ps( d, speedSquared ), elapsedMass ) ) ), one );
+			
+		// damp velocities
+		const __m128 dp = _mm_loadu_ps( damp + i );
+		const __m128 dampFactor = fSelect( _mm_cmpgt_ps( dp, dampThreshold ),
+			_mm_max_ps( zero, _mm_sub_ps( one, dp ) ), one );
+			
+		const __m128 linearFactor = _mm_mul_ps( dragFactor, dampFactor );
+		vx = _mm_mul_ps( vx, linearFactor );
+		vy = _mm_mul_ps( vy, linearFactor );
+		vz = _mm_mul_ps( vz, linearFactor );
+		
+		_mm_storeu_ps( velocityX + i, vx );
+		_mm_storeu_ps( velocityY + i, vy );
+		_mm_storeu_ps( velocityZ + i, vz );
+		
+		const __m128 av = _mm_mul_ps( _mm_loadu_ps( angularVelocity + i ), dampFactor );
+		_mm_storeu_ps( angularVelocity + i, av );
+		
+		// apply angular rotation. same as fmodf which truncates towards zero
+		const __m128 r = _mm_add_ps( _mm_loadu_ps( rotation + i ), _mm_mul_ps( av, elapsed4 ) );
+		const __m128 turns = _mm_cvtepi32_ps( _mm_cvttps_epi32( _mm_mul_ps( r, invPi2 ) ) );
+		_mm_storeu_ps( rotation + i, _mm_sub_ps( r, _mm_mul_ps( turns, pi2 ) ) );
+	}
+	
+	IntegrateScalar( streams, last, first + count - last, elapsed );
+	
+#else
+	IntegrateScalar( streams, first, count, elapsed );
+#endif
+}
+
+void debpParticleKernels::Advance( float * const *streams, int first, int count, float elapsed ){
+#ifdef BP_PARTICLEKERNELS_SSE
+	float * const positionX = streams[ esPositionX ];
+	float * const positionY = streams[ esPositionY ];
+	float * const positionZ = streams[ esPositionZ ];
+	const float * const velocityX = streams[ esVelocityX ];
+	const float * const velocityY = streams[ esVelocityY ];
+	const float * const velocityZ = streams[ esVelocityZ ];
+	const __m128 elapsed4 = _mm_set1_ps( elapsed );
+	const int last = first + ( count & ~3 );
+	int i;
+	
+	for( i=first; i<last; i+=4 ){
+		_mm_storeu_ps( positionX + i, _mm_add_ps( _mm_loadu_ps( positionX + i ),
+			_mm_mul_ps( _mm_loadu_ps( velocityX + i ), elapsed4 ) ) );
+		_mm_storeu_ps( positionY + i, _mm_add_ps( _mm_loadu_ps( positionY + i ),
+			_mm_mul_ps( _mm_loadu_ps( velocityY + i ), elapsed4 ) ) );
+		_mm_storeu_ps( positionZ + i, _mm_add_ps( _mm_loadu_ps( positionZ + i ),
+			_mm_mul_ps( _mm_loadu_ps( velocityZ + i ), elapsed4 ) ) );
+	}
+	
+	AdvanceScalar( streams, last, first + count - last, elapsed );
+	
+#else
+	AdvanceScalar( streams, first, count, elapsed );
+#endif
+}
+
+void debpParticleKernels::ApplyForceField( float * const *streams, int first, int count,
+const sForceField &forceField ){
+#ifdef BP_PARTICLEKERNELS_SSE
+	const float * const positionX = streams[ esPositionX ];
+	const float * const positionY = streams[ esPositionY ];
+	const float * const positionZ = streams[ esPositionZ ];
+	const float * const velocityX = streams[ esVelocityX ];
+	const float * const velocityY = streams[ esVelocityY ];
+	const float * const velocityZ = streams[ esVelocityZ ];
+	float * const forceX = streams[ esForceX ];
+	float * const forceY = streams[ esForceY ];
+	float * const forceZ = streams[ esForceZ ];
+	const float * const mass = streams[ esMass ];
+	const float *factors = NULL;
+	
+	switch( forceField.factor ){
+	case effDirect:
+		factors = streams[ esForceFieldDirect ];
+		break;
+		
+	case effSurface:
+		factors = streams[ esForceFieldSurface ];
+		break;
+		
+	case effMass:
+		factors = streams[ esForceFieldMass ];
+		break;
+		
+	case effSpeed:
+		factors = streams[ esForceFieldSpeed ];
+		break;
+		
+	default:
+		DETHROW( deeInvalidParam );
+	}
+	
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 ffX = _mm_set1_ps( forceField.positionX );
+	const __m128 ffY = _mm_set1_ps( forceField.positionY );
+	const __m128 ffZ = _mm_set1_ps( forceField.positionZ );
+	const __m128 radiusSquared = _mm_set1_ps( forceField.radius * forceField.radius );
+	const __m128 invRadius = _mm_set1_ps( 1.0f / forceField.radius );
+	const __m128 minDistanceSquared = _mm_set1_ps( 1e-6f );
+	const __m128 force = _mm_set1_ps( forceField.force );
+	const __m128 fluctCos = _mm_set1_ps( forceField.fluctuationCos );
+	const __m128 fluctSin = _mm_set1_ps( forceField.fluctuationSin );
+	const bool linearExponent = fabsf( forceField.exponent - 1.0f ) < 1e-6f;
+	const int last = first + ( count & ~3 );
+	float falloffs[ 4 ];
+	int i, j;
+	
+	for( i=first; i<last; i+=4 ){
+		const __m128 dx = _mm_sub_ps( _mm_loadu_ps( positionX + i ), ffX );
+		const __m128 dy = _mm_sub_ps( _mm_loadu_ps( positionY + i ), ffY );
+		const __m128 dz = _mm_sub_ps( _mm_loadu_ps( positionZ + i ), ffZ );
+		const __m128 distanceSquared = _mm_add_ps( _mm_add_ps( _mm_mul_ps( dx, dx ),
+			_mm_mul_ps( dy, dy ) ), _mm_mul_ps( dz, dz ) );
+			
+		__m128 mask = _mm_cmplt_ps( distanceSquared, radiusSquared );
+		if( ! forceField.linear ){
+			mask = _mm_and_ps( mask, _mm_cmpge_ps( distanceSquared, minDistanceSquared ) );
+		}
+		
+		const int laneMask = _mm_movemask_ps( mask );
+		if( laneMask == 0 ){
+			continue;
+		}
+		
+		const __m128 falloff = _mm_sub_ps( one, _mm_mul_ps( _mm_sqrt_ps( distanceSquared ), invRadius ) );
+		
+		// direction
+		__m128 dirX, dirY, dirZ;
+		
+		if( forceField.linear ){
+			dirX = _mm_set1_ps( forceField.directionX );
+			dirY = _mm_set1_ps( forceField.directionY );
+			dirZ = _mm_set1_ps( forceField.directionZ );
+			
+		}else{
+			const __m128 sx = _mm_mul_ps( dx, falloff );
+			const __m128 sz = _mm_mul_ps( dz, falloff );
+			dirX = _mm_sub_ps( _mm_mul_ps( sx, fluctCos ), _mm_mul_ps( sz, fluctSin ) );
+			dirY = _mm_mul_ps( dy, falloff );
+			dirZ = _mm_add_ps( _mm_mul_ps( sx, fluctSin ), _mm_mul_ps( sz, fluctCos ) );
+		}
+		
+		// force factor
+		__m128 factor = _mm_loadu_ps( factors + i );
+		
+		if( forceField.factor == effMass ){
+			factor = _mm_mul_ps( factor, _mm_loadu_ps( mass + i ) );
+			
+		}else if( forceField.factor == effSpeed ){
+			const __m128 vx = _mm_loadu_ps( velocityX + i );
+			const __m128 vy = _mm_loadu_ps( velocityY + i );
+			const __m128 vz = _mm_loadu_ps( velocityZ + i );
+			factor = _mm_mul_ps( factor, _mm_sqrt_ps( _mm_add_ps( _mm_add_ps(
+				_mm_mul_ps( vx, vx ), _mm_mul_ps( vy, vy ) ), _mm_mul_ps( vz, vz ) ) ) );
+		}
+		
+		// exponent falloff. there is no vector pow so lanes are done one by one
+		__m128 exponentFalloff;
+		
+		if( linearExponent ){
+			exponentFalloff = falloff;
+			
+		}else{
+			_mm_storeu_ps( falloffs, falloff );
+			for( j=0; j<4; j++ ){
+				falloffs[ j ] = ( laneMask & ( 1 << j ) ) ? powf( falloffs[ j ], forceField.exponent ) : 0.0f;
+			}
+			exponentFalloff = _mm_loadu_ps( falloffs );
+		}
+		
+		const __m128 addForce = _mm_and_ps( mask, _mm_mul_ps( _mm_mul_ps( force, exponentFalloff ), factor ) );
+		
+		_mm_storeu_ps( forceX + i, _mm_add_ps( _mm_loadu_ps( forceX + i ), _mm_mul_ps( dirX, addForce ) ) );
+		_mm_storeu_ps( forceY + i, _mm_add_ps( _mm_loadu_ps( forceY + i ), _mm_mul_ps( dirY, addForce ) ) );
+		_mm_storeu_ps( forceZ + i, _mm_add_ps( _mm_loadu_ps( forceZ + i ), _mm_mul_ps( dirZ, addForce ) ) );
+	}
+	
+	ApplyForceFieldScalar( streams, last, first + count - last, forceField );
+	
+#else
+	ApplyForceFieldScalar( streams, first, count, forceField );
+#endif
+}
+
+
+
+// Reference implementation
+/////////////////////////////
+
+void debpParticleKernels::IntegrateScalar( float * const *streams, int first, int count, float elapsed ){
+	float * const velocityX = streams[ esVelocityX ];
+	float * const velocityY = streams[ esVelocityY ];
+	float * const velocityZ = streams[ esVelocityZ ];
+	const float * const forceX = streams[ esForceX ];
+	const float * const forceY = streams[ esForceY ];
+	const float * const forceZ = streams[ esForceZ ];
+	const float * const mass = streams[ esMass ];
+	const float * const damp = streams[ esDamp ];
+	const float * const drag = streams[ esDrag ];
+	float * const rotation = streams[ esRotation ];
+	float * const angularVelocity = streams[ esAngularVelocity ];
+	const int last = first + count;
+	int i;
+	
+	for( i=first; i<last; i++ ){
+		// apply force
+		const float elapsedMass = elapsed / mass[ i ];
+		
+		velocityX[ i ] += forceX[ i ] * elapsedMass;
+		velocityY[ i ] += forceY[ i ] * elapsedMass;
+		velocityZ[ i ] += forceZ[ i ] * elapsedMass;
+		
+		// apply air drag
+		if( drag[ i ] > 1e-10f ){
+			const float factor = 1.0f - drag[ i ] * ( velocityX[ i ] * velocityX[ i ]
+				+ velocityY[ i ] * velocityY[ i ] + velocityZ[ i ] * velocityZ[ i ] ) * elapsedMass;
+				
+			if( factor > 0.0f ){
+				velocityX[ i ] *= factor;
+				velocityY[ i ] *= factor;
+				velocityZ[ i ] *= factor;
+				
+			}else{
+				velocityX[ i ] = 0.0f;
+				velocityY[ i ] = 0.0f;
+				velocityZ[ i ] = 0.0f;
+			}
+		}
+		
+		// damp velocities
+		if( damp[ i ] > 1e-5f ){
+			const float factor = 1.0f - damp[ i ];
+			
+			if( factor > 0.0f ){
+				velocityX[ i ] *= factor;
+				velocityY[ i ] *= factor;
+				velocityZ[ i ] *= factor;
+				angularVelocity[ i ] *= factor;
+				
+			}else{
+				velocityX[ i ] = 0.0f;
+				velocityY[ i ] = 0.0f;
+				velocityZ[ i ] = 0.0f;
+				angularVelocity[ i ] = 0.0f;
+			}
+		}
+		
+		// apply angular rotation
+		rotation[ i ] = fmodf( rotation[ i ] + angularVelocity[ i ] * elapsed, PI2 );
+	}
+}
+
+void debpParticleKernels::AdvanceScalar( float * const *streams, int first, int count, float elapsed ){
+	float * const positionX = streams[ esPositionX ];
+	float * const positionY = streams[ esPositionY ];
+	float * const positionZ = streams[ esPositionZ ];
+	const float * const velocityX = streams[ esVelocityX ];
+	const float * const velocityY = streams[ esVelocityY ];
+	const float * const velocityZ = streams[ esVelocityZ ];
+	const int last = first + count;
+	int i;
+	
+	for( i=first; i<last; i++ ){
+		positionX[ i ] += velocityX[ i ] * elapsed;
+		positionY[ i ] += velocityY[ i ] * elapsed;
+		positionZ[ i ] += velocityZ[ i ] * elapsed;
+	}
+}
+
+void debpParticleKernels::ApplyForceFieldScalar( float * const *streams, int first, int count,
+const sForceField &forceField ){
+	const float * const positionX = streams[ esPositionX ];
+	const float * const positionY = streams[ esPositionY ];
+	const float * const positionZ = streams[ esPositionZ ];
+	const float * const velocityX = streams[ esVelocityX ];
+	const float * const velocityY = streams[ esVelocityY ];
+	const float * const velocityZ = streams[ esVelocityZ ];
+	float * const forceX = streams[ esForceX ];
+	float * const forceY = streams[ esForceY ];
+	float * const forceZ = streams[ esForceZ ];
+	const float radiusSquared = forceField.radius * forceField.radius;
+	const int last = first + count;
+	float directionX, directionY, directionZ;
+	float forceFactor;
+	int i;
+	
+	for( i=first; i<last; i++ ){
+		const float dx = positionX[ i ] - forceField.positionX;
+		const float dy = positionY[ i ] - forceField.positionY;
+		const float dz = positionZ[ i ] - forceField.positionZ;
+		const float distanceSquared = dx * dx + dy * dy + dz * dz;
+		
+		if( distanceSquared >= radiusSquared ){
+			continue;
+		}
+		
+		if( forceField.linear ){
+			directionX = forceField.directionX;
+			directionY = forceField.directionY;
+			directionZ = forceField.directionZ;
+			
+		}else{
+			if( distanceSquared < 1e-6f ){
+				continue;
+			}
+			
+			const float scale = 1.0f - sqrtf( distanceSquared ) / forceField.radius;
+			const float sx = dx * scale;
+			const float sz = dz * scale;
+			
+			directionX = sx * forceField.fluctuationCos - sz * forceField.fluctuationSin;
+			directionY = dy * scale;
+			directionZ = sx * forceField.fluctuationSin + sz * forceField.fluctuationCos;
+		}
+		
+		switch( forceField.factor ){
+		case effDirect:
+			forceFactor = streams[ esForceFieldDirect ][ i ];
+			break;
+			
+		case effSurface:
+			forceFactor = streams[ esForceFieldSurface ][ i ];
+			break;
+			
+		case effMass:
+			forceFactor = streams[ esForceFieldMass ][ i ] * streams[ esMass ][ i ];
+			break;
+			
+		case effSpeed:
+			forceFactor = streams[ esForceFieldSpeed ][ i ] * sqrtf( velocityX[ i ] * velocityX[ i ]
+				+ velocityY[ i ] * velocityY[ i ] + velocityZ[ i ] * velocityZ[ i ] );
+			break;
+			
+		default:
+			DETHROW( deeInvalidParam );
+		}
+		
+		const float addForce = forceField.force * powf( 1.0f - sqrtf( distanceSquared )
+			/ forceField.radius, forceField.exponent ) * forceFactor;
+			
+		forceX[ i ] += directionX * addForce;
+		forceY[ i ] += directionY * addForce;
+		forceZ[ i ] += directionZ * addForce;
+	}
+}
@@ -0,0 +1,140 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef _DEBPPARTICLEKERNELS_H_
+#define _DEBPPARTICLEKERNELS_H_
+
+
+
+/**
+ * \brief Particle simulation kernels.
+ * 
+ * Simulates particles stored in structure of arrays layout. Each particle parameter is
+ * stored in an own float stream indexed by eStreams. If SSE2 is available four particles
+ * are processed at the same time. The scalar versions are the reference implementation
+ * used if SSE2 is not available and for testing.
+ */
+class debpParticleKernels{
+public:
+	/** \brief Particle streams. */
+	enum eStreams{
+		esPositionX,
+		esPositionY,
+		esPositionZ,
+		esVelocityX,
+		esVelocityY,
+		esVelocityZ,
+		esForceX,
+		esForceY,
+		esForceZ,
+		esMass,
+		esDamp,
+		esDrag,
+		esRotation,
+		esAngularVelocity,
+		esForceFieldDirect,
+		esForceFieldSurface,
+		esForceFieldMass,
+		esForceFieldSpeed
+	};
+	
+	/** \brief Number of streams. */
+	static const int StreamCount = esForceFieldSpeed + 1;
+	
+	/** \brief Force field application type. */
+	enum eForceFieldFactor{
+		/** \brief Force field direct factor. */
+		effDirect,
+		
+		/** \brief Force field surface factor. */
+		effSurface,
+		
+		/** \brief Force field mass factor multiplied by mass. */
+		effMass,
+		
+		/** \brief Force field speed factor multiplied by linear velocity. */
+		effSpeed
+	};
+	
+	/** \brief Force field parameters. */
+	struct sForceField{
+		/** \brief Force field position. */
+		float positionX, positionY, positionZ;
+		
+		/** \brief Direction for linear force fields. Fluctuation rotation is applied. */
+		float directionX, directionY, directionZ;
+		
+		/** \brief Force field is linear otherwise radial. */
+		bool linear;
+		
+		/** \brief Radius. */
+		float radius;
+		
+		/** \brief Exponent. */
+		float exponent;
+		
+		/** \brief Force including fluctuation. */
+		float force;
+		
+		/** \brief Cosine and sine of fluctuation rotation around the Y axis. */
+		float fluctuationCos, fluctuationSin;
+		
+		/** \brief Factor to apply. */
+		eForceFieldFactor factor;
+	};
+	
+	
+	
+	/** \name Simulation */
+	/*@{*/
+	/**
+	 * \brief Integrate velocities and rotation.
+	 * 
+	 * Applies force, air drag and damping to velocities and angular velocity to rotation.
+	 * Positions are not changed.
+	 */
+	static void Integrate( float * const *streams, int first, int count, float elapsed );
+	
+	/** \brief Move positions by linear velocity. */
+	static void Advance( float * const *streams, int first, int count, float elapsed );
+	
+	/** \brief Add force field forces to particle forces. */
+	static void ApplyForceField( float * const *streams, int first, int count, const sForceField &forceField );
+	/*@}*/
+	
+	
+	
+	/** \name Reference implementation */
+	/*@{*/
+	/** \brief Integrate velocities and rotation. */
+	static void IntegrateScalar( float * const *streams, int first, int count, float elapsed );
+	
+	/** \brief Move positions by linear velocity. */
+	static void AdvanceScalar( float * const *streams, int first, int count, float elapsed );
+	
+	/** \brief Add force field forces to particle forces. */
+	static void ApplyForceFieldScalar( float * const *streams, int first, int count,
+		const sForceField &forceField );
+	/*@}*/
+};
+
+#endif
@@ -0,0 +1,61 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef _DEBPPARTICLERESULTCALLBACK_H_
+#define _DEBPPARTICLERESULTCALLBACK_H_
+
+#include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
+
+class decCollisionFilter;
+
+
+
+/**
+ * \brief Closest hit particle sweep result callback.
+ * 
+ * Accepts colliders and height terrain sectors matching the particle emitter collision
+ * filter. Calls no scripting listeners and can be used from parallel tasks.
+ */
+class debpParticleResultCallback : public btCollisionWorld::ClosestConvexResultCallback{
+private:
+	const decCollisionFilter &pCollisionFilter;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create result callback. */
+	debpParticleResultCallback( const btVector3 &rayFromWorld, const btVector3 &rayToWorld,
+		const decCollisionFilter &collisionFilter );
+	/*@}*/
+	
+	
+	
+	/** \name Bullet */
+	/*@{*/
+	/** \brief Determines if a collision with a broadphase proxy is possible. */
+	virtual bool needsCollision( btBroadphaseProxy *proxy0 ) const;
+	/*@}*/
+};
+
+#endif
@@ -0,0 +1,175 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "debpParticleStepJob.h"
+#include "debpParticleResultCallback.h"
+#include "../coldet/debpSweepCollisionTest.h"
+#include "../world/debpCollisionWorld.h"
+#include "../world/debpDelayedOperation.h"
+
+#include "BulletCollision/BroadphaseCollision/btDbvtBroadphase.h"
+
+#include <dragengine/common/exceptions.h>
+
+
+
+// Definitions
+////////////////
+
+// less particles are processed on the calling thread
+#define PARALLEL_MIN_PARTICLES 1024
+
+// number of particles processed per chunk. multiple of 4 to keep SIMD lanes filled
+#define CHUNK_PARTICLES 256
+
+
+
+// Class debpParticleStepJob
+//////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+debpParticleStepJob::debpParticleStepJob( dePhysicsBullet &bullet, float * const *streams,
+int particleCount, float elapsed ) :
+debpParallelCollisionJob( bullet, particleCount, CHUNK_PARTICLES ),
+pElapsed( elapsed ),
+pCollisionWorld( NULL ),
+pBroadphase( NULL ),
+pSweepTest( NULL ),
+pCollisionFilter( NULL ),
+pSweeps( NULL )
+{
+	int i;
+	for( i=0; i<debpParticleKernels::StreamCount; i++ ){
+		pStreams[ i ] = streams[ i ];
+	}
+}
+
+debpParticleStepJob::~debpParticleStepJob(){
+	if( pSweeps ){
+		delete [] pSweeps;
+	}
+}
+
+
+
+// Management
+///////////////
+
+void debpParticleStepJob::EnableCollision( debpCollisionWorld &world,
+const debpSweepCollisionTest &sweepTest, const decCollisionFilter &collisionFilter ){
+	if( pSweeps ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	pCollisionWorld = &world;
+	pBroadphase = ( const btDbvtBroadphase* )world.getBroadphase();
+	pSweepTest = &sweepTest;
+	pCollisionFilter = &collisionFilter;
+	
+	if( GetItemCount() > 0 ){
+		pSweeps = new sSweep[ GetItemCount() ];
+	}
+}
+
+void debpParticleStepJob::Process(){
+	if( ! pSweeps ){
+		Run( PARALLEL_MIN_PARTICLES );
+		return;
+	}
+	
+	debpDelayedOperation &delayedOperation = pCollisionWorld->GetDelayedOperation();
+	delayedOperation.Lock();
+	
+	try{
+		Run( PARALLEL_MIN_PARTICLES );
+		delayedOperation.Unlock();
+		
+	}catch( const deException & ){
+		delayedOperation.Unlock();
+		throw;
+	}
+}
+
+const debpParticleStepJob::sSweep &debpParticleStepJob::GetSweepAt( int index ) const{
+	if( ! pSweeps || index < 0 || index >= GetItemCount() ){
+		DETHROW( deeInvalidParam );
+	}
+	return pSweeps[ index ];
+}
+
+const char *debpParticleStepJob::GetDebugName() const{
+	return "ParticleStep";
+}
+
+
+
+// Protected Functions
+////////////////////////
+
+void debpParticleStepJob::ProcessChunk( int, int firstItem, int itemCount, sThreadData &threadData ){
+	debpParticleKernels::Integrate( pStreams, firstItem, itemCount, pElapsed );
+	
+	if( ! pSweeps ){
+		debpParticleKernels::Advance( pStreams, firstItem, itemCount, pElapsed );
+		return;
+	}
+	
+	const float * const positionX = pStreams[ debpParticleKernels::esPositionX ];
+	const float * const positionY = pStreams[ debpParticleKernels::esPositionY ];
+	const float * const positionZ = pStreams[ debpParticleKernels::esPositionZ ];
+	const float * const velocityX = pStreams[ debpParticleKernels::esVelocityX ];
+	const float * const velocityY = pStreams[ debpParticleKernels::esVelocityY ];
+	const float * const velocityZ = pStreams[ debpParticleKernels::esVelocityZ ];
+	const btQuaternion orientation( ( btScalar )0.0, ( btScalar )0.0, ( btScalar )0.0, ( btScalar )1.0 );
+	const int last = firstItem + itemCount;
+	int i;
+	
+	for( i=firstItem; i<last; i++ ){
+		sSweep &sweep = pSweeps[ i ];
+		const btVector3 displacement( velocityX[ i ] * pElapsed,
+			velocityY[ i ] * pElapsed, velocityZ[ i ] * pElapsed );
+			
+		// same threshold as debpParticleEmitterInstanceType::ParticleTestCollision
+		if( displacement.length2() < ( btScalar )1e-8 ){
+			sweep.swept = false;
+			continue;
+		}
+		
+		const btVector3 from( positionX[ i ], positionY[ i ], positionZ[ i ] );
+		const btVector3 to( from + displacement );
+		debpParticleResultCallback result( from, to, *pCollisionFilter );
+		
+		pSweepTest->SweepTest( *pBroadphase, btTransform( orientation, from ),
+			btTransform( orientation, to ), result, threadData.broadphaseStack, threadData.shapeStack );
+			
+		sweep.swept = true;
+		sweep.hitFraction = result.m_closestHitFraction;
+		sweep.hitNormal = result.m_hitNormalWorld;
+		sweep.hitPoint = result.m_hitPointWorld;
+		sweep.hitCollisionObject = result.m_hitCollisionObject;
+	}
+}
@@ -0,0 +1,128 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef _DEBPPARTICLESTEPJOB_H_
+#define _DEBPPARTICLESTEPJOB_H_
+
+#include "debpParticleKernels.h"
+#include "../coldet/debpParallelCollisionJob.h"
+
+#include "LinearMath/btVector3.h"
+
+class debpCollisionWorld;
+class debpSweepCollisionTest;
+class decCollisionFilter;
+
+class btCollisionObject;
+class btDbvtBroadphase;
+
+
+/**
+ * \brief Particle stepping split into chunks processed in parallel.
+ * 
+ * Integrates velocities and rotations of particles using debpParticleKernels. If collision
+ * is disabled particles are moved along their linear velocity. Otherwise the first sweep
+ * of each particle along its displacement is run against the world state at the beginning
+ * of the step. No scripting listeners are called.
+ * 
+ * The particle emitter instance type applies the sweep results afterwards. Collision
+ * responses and further bounces are processed serially since they call scripting listeners.
+ */
+class debpParticleStepJob : public debpParallelCollisionJob{
+public:
+	/** \brief First sweep result of a particle. */
+	struct sSweep{
+		/** \brief Sweep has been run. False if the displacement is too small. */
+		bool swept;
+		
+		/** \brief Hit fraction or 1 if nothing has been hit. */
+		btScalar hitFraction;
+		
+		/** \brief Hit normal in world space. */
+		btVector3 hitNormal;
+		
+		/** \brief Hit point in world space. */
+		btVector3 hitPoint;
+		
+		/** \brief Hit collision object or NULL. */
+		const btCollisionObject *hitCollisionObject;
+	};
+	
+	
+	
+private:
+	float *pStreams[ debpParticleKernels::StreamCount ];
+	const float pElapsed;
+	
+	debpCollisionWorld *pCollisionWorld;
+	const btDbvtBroadphase *pBroadphase;
+	const debpSweepCollisionTest *pSweepTest;
+	const decCollisionFilter *pCollisionFilter;
+	sSweep *pSweeps;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create particle step job. */
+	debpParticleStepJob( dePhysicsBullet &bullet, float * const *streams, int particleCount, float elapsed );
+	
+protected:
+	/** \brief Clean up particle step job. */
+	virtual ~debpParticleStepJob();
+	/*@}*/
+	
+	
+	
+public:
+	/** \name Management */
+	/*@{*/
+	/**
+	 * \brief Enable sweeping particles instead of moving them.
+	 * 
+	 * \em sweepTest and \em collisionFilter have to stay valid until the job is processed.
+	 */
+	void EnableCollision( debpCollisionWorld &world, const debpSweepCollisionTest &sweepTest,
+		const decCollisionFilter &collisionFilter );
+		
+	/** \brief Collision is enabled. */
+	inline bool GetCollisionEnabled() const{ return pSweeps != NULL; }
+	
+	/** \brief Run job. */
+	void Process();
+	
+	/** \brief First sweep result of particle. Only valid if collision is enabled. */
+	const sSweep &GetSweepAt( int index ) const;
+	
+	/** \brief Short job name for debugging. */
+	virtual const char *GetDebugName() const;
+	/*@}*/
+	
+	
+	
+protected:
+	/** \brief Process particles of chunk. */
+	virtual void ProcessChunk( int chunk, int firstItem, int itemCount, sThreadData &threadData );
+};
+
+#endif
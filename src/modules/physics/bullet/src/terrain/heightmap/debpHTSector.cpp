@@ -184,6 +184,10 @@ void debpHTSector::Update(){
 	if( pDirtyPoints ){
 		pUpdatePoints();
 		
+		if( pPhyBody ){
+			pPhyBody->MarkDirtyAABB();
+		}
+		
 		pDirtyPoints = false;
 	}
 	
@@ -0,0 +1,89 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdlib.h>
+
+#include "debpTSColliderSet.h"
+
+#include <dragengine/common/exceptions.h>
+
+
+
+// Class debpTSColliderSet
+////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+debpTSColliderSet::debpTSColliderSet(){
+}
+
+debpTSColliderSet::~debpTSColliderSet(){
+}
+
+
+
+// Management
+///////////////
+
+debpCollider *debpTSColliderSet::GetAt( int index ) const{
+	if( index < 0 || index >= pColliders.size() ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	return *pColliders.getAtIndex( index );
+}
+
+bool debpTSColliderSet::Has( debpCollider *collider ) const{
+	return pColliders.find( btHashPtr( collider ) ) != NULL;
+}
+
+void debpTSColliderSet::Add( debpCollider *collider ){
+	if( ! collider || Has( collider ) ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	pColliders.insert( btHashPtr( collider ), collider );
+}
+
+void debpTSColliderSet::AddIfAbsent( debpCollider *collider ){
+	if( ! collider ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	pColliders.insert( btHashPtr( collider ), collider );
+}
+
+void debpTSColliderSet::Remove( debpCollider *collider ){
+	if( ! Has( collider ) ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	pColliders.remove( btHashPtr( collider ) );
+}
+
+void debpTSColliderSet::RemoveIfPresent( debpCollider *collider ){
+	pColliders.remove( btHashPtr( collider ) );
+}
+
+void debpTSColliderSet::RemoveAll(){
+	pColliders.clear();
+}
@@ -0,0 +1,94 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEBPTSCOLLIDERSET_H_
+#define _DEBPTSCOLLIDERSET_H_
+
+#include "LinearMath/btHashMap.h"
+
+class debpCollider;
+
+
+
+/**
+ * \brief Hashed set of colliders for use by touch sensors.
+ * 
+ * Touch sensors can track hundreds of colliders. Adding, removing and testing colliders
+ * is done in constant time. Colliders are stored in a dense array which can be iterated
+ * by index. Removing a collider moves the last collider into the gap hence the order of
+ * colliders changes.
+ */
+class debpTSColliderSet{
+private:
+	btHashMap<btHashPtr, debpCollider*> pColliders;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create collider set. */
+	debpTSColliderSet();
+	
+	/** \brief Clean up collider set. */
+	~debpTSColliderSet();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Number of colliders. */
+	inline int GetCount() const{ return pColliders.size(); }
+	
+	/** \brief Collider at index. */
+	debpCollider *GetAt( int index ) const;
+	
+	/** \brief Collider is present. */
+	bool Has( debpCollider *collider ) const;
+	
+	/**
+	 * \brief Add collider.
+	 * \throws deeInvalidParam \em collider is NULL or present.
+	 */
+	void Add( debpCollider *collider );
+	
+	/**
+	 * \brief Add collider if absent.
+	 * \throws deeInvalidParam \em collider is NULL.
+	 */
+	void AddIfAbsent( debpCollider *collider );
+	
+	/**
+	 * \brief Remove collider.
+	 * \throws deeInvalidParam \em collider is absent.
+	 */
+	void Remove( debpCollider *collider );
+	
+	/** \brief Remove collider if present. */
+	void RemoveIfPresent( debpCollider *collider );
+	
+	/** \brief Remove all colliders. */
+	void RemoveAll();
+	/*@}*/
+};
+
+#endif
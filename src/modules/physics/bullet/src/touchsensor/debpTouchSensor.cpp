@@ -55,6 +55,7 @@
 
 #include <dragengine/deEngine.h>
 #include <dragengine/common/exceptions.h>
+#include <dragengine/common/collection/decObjectList.h>
 #include <dragengine/common/shape/decShape.h>
 #include <dragengine/resources/collider/deCollider.h>
 #include <dragengine/resources/component/deComponent.h>
@@ -122,6 +123,7 @@ pTouchSensor( touchSensor ),
 pParentWorld( NULL ),
 pDirtyMatrix( true ),
 pDirtyExtends( true ),
+pDirtyTestResults( true ),
 pGhostObject( NULL ),
 pDebugDrawer( NULL ),
 pDDSShape( NULL )
@@ -156,6 +158,7 @@ void debpTouchSensor::SetParentWorld( debpWorld *parentWorld ){
 	}
 	
 	pClearTracking();
+	pDirtyTestResults = true;
 	
 	if( pParentWorld ){
 		if( pDebugDrawer ){
@@ -251,8 +254,18 @@ void debpTouchSensor::ApplyChanges(){
 	deTouchSensorReference guard( &pTouchSensor );
 	
 	// this function is only called if tracking enter-leave is enabled
+	if( pDirtyTestResults ){
+		pTestResults.clear();
+		pDirtyTestResults = false;
+	}
+	
+	decObjectList enteredColliders;
+	decObjectList leftColliders;
+	
 	if( pGhostObject->GetGhostObject() ){
-		// check all collision pairs in the ghost collider for touching the sensor
+		// check all collision pairs in the ghost collider for touching the sensor. the
+		// broadphase adds and removes pairs incrementally. test results of pairs not
+		// changed since the last time are reused
 		const btGhostObject &ghostObject = *pGhostObject->GetGhostObject();
 		const int count = ghostObject.getNumOverlappingObjects();
 		int i;
@@ -269,23 +282,18 @@ void debpTouchSensor::ApplyChanges(){
 // 					collider->UpdateShapes();
 // 				}
 				
-				if( TestCollider( collider ) ){
+				if( pTestColliderCached( collider ) ){
 					if( ! pTouchingColliders.Has( collider ) ){
 						if( pLeavingColliders.Has( collider ) ){
+							// collider left and entered again since the last update. the
+							// scripting module has not been notified about leaving yet
 							pLeavingColliders.Remove( collider );
 							pTouchingColliders.Add( collider );
 							
 						}else{
 							pTouchingColliders.Add( collider );
 							collider->GetTrackingTouchSensors().Add( this );
-						}
-						
-						pTouchSensor.NotifyColliderEntered( &collider->GetCollider() );
-						// at this point we might have been removed from the parent world
-						// by the user. in this case pParentWorld is NULL and all further
-						// actions are invalid. we need to quit the loop
-						if( ! pParentWorld ){
-							break;
+							enteredColliders.Add( &collider->GetCollider() );
 						}
 					}
 					
@@ -301,35 +309,50 @@ void debpTouchSensor::ApplyChanges(){
 			}
 		}
 		
-		// send a notification for all leaving colliders. if we have been removed from the
-		// parent world in the mean time pLeavingColliders is empty so no need to check
-		// if pParentWorld is NULL
+		// all leaving colliders left the shape
 		while( pLeavingColliders.GetCount() > 0 ){
-			const int index = pLeavingColliders.GetCount() - 1;
-			debpCollider * const collider = ( debpCollider* )pLeavingColliders.GetAt( index );
-			pLeavingColliders.RemoveFrom( index );
+			debpCollider * const collider = pLeavingColliders.GetAt( pLeavingColliders.GetCount() - 1 );
+			pLeavingColliders.Remove( collider );
 			collider->GetTrackingTouchSensors().Remove( this );
-			
-			pTouchSensor.NotifyColliderLeft( &collider->GetCollider() );
+			leftColliders.Add( &collider->GetCollider() );
 		}
 		
 	}else{
 		// all colliders left the shape
 		while( pTouchingColliders.GetCount() > 0 ){
-			const int index = pTouchingColliders.GetCount() - 1;
-			debpCollider * const collider = ( debpCollider* )pTouchingColliders.GetAt( index );
-			pTouchingColliders.RemoveFrom( index );
+			debpCollider * const collider = pTouchingColliders.GetAt( pTouchingColliders.GetCount() - 1 );
+			pTouchingColliders.Remove( collider );
 			collider->GetTrackingTouchSensors().Remove( this );
-			
-			pTouchSensor.NotifyColliderLeft( &collider->GetCollider() );
+			leftColliders.Add( &collider->GetCollider() );
 		}
 	}
 	
+	// notify scripting module about all changes at once. the lists hold references to the
+	// colliders in case the scripting module removes colliders while processing the changes
+	if( enteredColliders.GetCount() > 0 || leftColliders.GetCount() > 0 ){
+		pTouchSensor.NotifyCollidersChanged( enteredColliders, leftColliders );
+	}
+	
 	UpdateDebugDrawer();
 }
 
 
 
+void debpTouchSensor::ColliderPairRemoved( debpCollider *collider ){
+	pTestResults.remove( btHashPtr( collider ) );
+	
+	if( pTouchSensor.GetTrackEnterLeave() && pTouchingColliders.Has( collider ) ){
+		pTouchingColliders.Remove( collider );
+		pLeavingColliders.Add( collider );
+	}
+}
+
+void debpTouchSensor::RemoveCollider( debpCollider *collider ){
+	pTestResults.remove( btHashPtr( collider ) );
+	pLeavingColliders.RemoveIfPresent( collider );
+	pTouchingColliders.RemoveIfPresent( collider );
+}
+
 void debpTouchSensor::MarkGhostObjectDirty(){
 	/*
 	btGhostObject * const ghostObject = pGhostObject->GetGhostObject();
@@ -492,6 +515,7 @@ void debpTouchSensor::PositionChanged(){
 	#endif
 	pDirtyMatrix = true;
 	pDirtyExtends = true;
+	pDirtyTestResults = true;
 	
 	const decDVector &position = pTouchSensor.GetPosition();
 	pGhostObject->SetPosition( position );
@@ -510,6 +534,7 @@ void debpTouchSensor::OrientationChanged(){
 	#endif
 	pDirtyMatrix = true;
 	pDirtyExtends = true;
+	pDirtyTestResults = true;
 	
 	const decQuaternion &orientation = pTouchSensor.GetOrientation();
 	pGhostObject->SetOrientation( orientation );
@@ -526,17 +551,21 @@ void debpTouchSensor::OrientationChanged(){
 
 void debpTouchSensor::CollisionFilterChanged(){
 	MarkGhostObjectDirty();
+	pDirtyTestResults = true;
 }
 
 void debpTouchSensor::IgnoreCollidersChanged(){
 	MarkGhostObjectDirty();
+	pDirtyTestResults = true;
 }
 
 void debpTouchSensor::EnabledChanged(){
 	pGhostObject->SetEnabled( pTouchSensor.GetEnabled() );
+	pDirtyTestResults = true;
 }
 
 void debpTouchSensor::TrackEnterLeaveChanged(){
+	pDirtyTestResults = true;
 }
 
 
@@ -550,7 +579,7 @@ int debpTouchSensor::GetColliderCount(){
 }
 
 deCollider *debpTouchSensor::GetColliderAt( int collider ){
-	return &( ( debpCollider* )pTouchingColliders.GetAt( collider ) )->GetCollider();
+	return &pTouchingColliders.GetAt( collider )->GetCollider();
 }
 
 
@@ -559,6 +588,7 @@ void debpTouchSensor::ShapeChanged(){
 	const decShapeList &shapeList = pTouchSensor.GetShape();
 	const int count = shapeList.GetCount();
 	
+	pDirtyTestResults = true;
 	pShape.RemoveAllShapes();
 	if( count == 0 ){
 		return;
@@ -1119,26 +1149,47 @@ void debpTouchSensor::pCalculateBasicExtends(){
 }
 
 void debpTouchSensor::pClearTracking(){
+	decObjectList leftColliders;
+	
 	// remove touching colliders
 	while( pTouchingColliders.GetCount() > 0 ){
-		const int index = pTouchingColliders.GetCount() - 1;
-		debpCollider * const collider = ( debpCollider* )pTouchingColliders.GetAt( index );
-		pTouchingColliders.RemoveFrom( index );
+		debpCollider * const collider = pTouchingColliders.GetAt( pTouchingColliders.GetCount() - 1 );
+		pTouchingColliders.Remove( collider );
 		collider->GetTrackingTouchSensors().Remove( this );
-		
-		pTouchSensor.NotifyColliderLeft( &collider->GetCollider() );
+		leftColliders.Add( &collider->GetCollider() );
 	}
 	
 	// remove leaving colliders
 	while( pLeavingColliders.GetCount() > 0 ){
-		const int index = pLeavingColliders.GetCount() - 1;
-		debpCollider * const collider = ( debpCollider* )pLeavingColliders.GetAt( index );
-		pLeavingColliders.RemoveFrom( index );
+		debpCollider * const collider = pLeavingColliders.GetAt( pLeavingColliders.GetCount() - 1 );
+		pLeavingColliders.Remove( collider );
 		collider->GetTrackingTouchSensors().Remove( this );
-		
-		pTouchSensor.NotifyColliderLeft( &collider->GetCollider() );
+		leftColliders.Add( &collider->GetCollider() );
 	}
 	
 	// in the above both can not happen at the same time so GetTrackingTouchSensors() can not
 	// be altered twice by the same collider (which would result in an exception)
+	
+	if( leftColliders.GetCount() > 0 ){
+		pTouchSensor.NotifyCollidersChanged( decObjectList(), leftColliders );
+	}
+}
+
+bool debpTouchSensor::pTestColliderCached( debpCollider *collider ){
+	// dynamic colliders are moved by the simulation without changing the revision
+	const btHashPtr key( collider );
+	const int revision = collider->GetChangeRevision();
+	
+	if( collider->GetCollider().GetResponseType() != deCollider::ertDynamic ){
+		const sTestResult * const cached = pTestResults.find( key );
+		if( cached && cached->revision == revision ){
+			return cached->touching;
+		}
+	}
+	
+	sTestResult result;
+	result.revision = revision;
+	result.touching = TestCollider( collider );
+	pTestResults.insert( key, result );
+	return result.touching;
 }
@@ -22,10 +22,12 @@
 #ifndef _DEBPTOUCHSENSOR_H_
 #define _DEBPTOUCHSENSOR_H_
 
+#include "debpTSColliderSet.h"
 #include "../shape/debpShapeList.h"
 
+#include "LinearMath/btHashMap.h"
+
 #include <dragengine/common/math/decMath.h>
-#include <dragengine/common/collection/decPointerOrderedSet.h>
 #include <dragengine/systems/modules/physics/deBasePhysicsTouchSensor.h>
 
 class debpCollider;
@@ -42,6 +44,18 @@ class deDebugDrawerShape;
  * \brief Bullet touch sensor peer.
  */
 class debpTouchSensor : public deBasePhysicsTouchSensor{
+public:
+	/** \brief Cached collider test result. */
+	struct sTestResult{
+		/** \brief Collider change revision the test has been done with. */
+		int revision;
+		
+		/** \brief Collider touches the shape. */
+		bool touching;
+	};
+	
+	
+	
 private:
 	dePhysicsBullet &pBullet;
 	deTouchSensor &pTouchSensor;
@@ -57,10 +71,12 @@ private:
 	
 	bool pDirtyMatrix;
 	bool pDirtyExtends;
+	bool pDirtyTestResults;
 	
 	debpShapeList pShape;
-	decPointerOrderedSet pTouchingColliders;
-	decPointerOrderedSet pLeavingColliders;
+	debpTSColliderSet pTouchingColliders;
+	debpTSColliderSet pLeavingColliders;
+	btHashMap<btHashPtr, sTestResult> pTestResults;
 	debpGhostObject *pGhostObject;
 	
 	deDebugDrawer *pDebugDrawer;
@@ -97,12 +113,12 @@ public:
 	inline debpGhostObject *GetGhostObject() const{ return pGhostObject; }
 	
 	/** \brief Retrieves the list of touching colliders. */
-	inline decPointerOrderedSet &GetTouchingColliders(){ return pTouchingColliders; }
-	inline const decPointerOrderedSet &GetTouchingColliders() const{ return pTouchingColliders; }
+	inline debpTSColliderSet &GetTouchingColliders(){ return pTouchingColliders; }
+	inline const debpTSColliderSet &GetTouchingColliders() const{ return pTouchingColliders; }
 	
 	/** \brief Retrieves the list of leaving colliders. */
-	inline decPointerOrderedSet &GetLeavingColliders(){ return pLeavingColliders; }
-	inline const decPointerOrderedSet &GetLeavingColliders() const{ return pLeavingColliders; }
+	inline debpTSColliderSet &GetLeavingColliders(){ return pLeavingColliders; }
+	inline const debpTSColliderSet &GetLeavingColliders() const{ return pLeavingColliders; }
 	
 	
 	
@@ -124,9 +140,28 @@ public:
 	/** \brief Inverse matrix. */
 	const decDMatrix &GetInverseMatrix();
 	
-	/** \brief Apply accumulated changes. */
+	/**
+	 * \brief Apply accumulated changes.
+	 * 
+	 * Tests colliders overlapping the ghost object for touching the shape. Test results
+	 * are reused for colliders not changed since the last test unless the touch sensor
+	 * changed. Dynamic colliders are always tested. All entered and left colliders are
+	 * reported to the scripting module with one notification.
+	 */
 	void ApplyChanges();
 	
+	/**
+	 * \brief Broadphase pair between ghost object and collider has been removed.
+	 * \details Called by debpGhostPairCallback.
+	 */
+	void ColliderPairRemoved( debpCollider *collider );
+	
+	/**
+	 * \brief Remove collider from tracking without notification.
+	 * \details Called by colliders about to be destroyed.
+	 */
+	void RemoveCollider( debpCollider *collider );
+	
 	/** \brief Mark ghost object dirty to force an update. */
 	void MarkGhostObjectDirty();
 	
@@ -271,6 +306,7 @@ private:
 	void pUpdateExtends();
 	void pCalculateBasicExtends();
 	void pClearTracking();
+	bool pTestColliderCached( debpCollider *collider );
 };
 
 #endif
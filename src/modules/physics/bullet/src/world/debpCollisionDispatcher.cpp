@@ -26,7 +26,97 @@
 #include "debpSharedCollisionFiltering.h"
 #include "debpWorld.h"
 
+#include "BulletCollision/BroadphaseCollision/btOverlappingPairCache.h"
+#include "BulletCollision/CollisionDispatch/btCollisionObject.h"
+#include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
+#include "LinearMath/btThreads.h"
+
 #include <dragengine/common/exceptions.h>
+#include <dragengine/threading/deMutexGuard.h>
+
+
+
+// Definitions
+////////////////
+
+// minimum number of pairs to dispatch in parallel and number of pairs per task
+#define PARALLEL_MIN_PAIRS		64
+#define PARALLEL_GRAIN_SIZE		16
+
+
+
+// Parallel dispatching
+/////////////////////////
+
+class debpCDParallelDispatch : public btIParallelForBody{
+private:
+	btBroadphasePair * const * const pPairs;
+	btCollisionDispatcher &pDispatcher;
+	const btDispatcherInfo &pDispatchInfo;
+	
+public:
+	debpCDParallelDispatch( btBroadphasePair * const *pairs, btCollisionDispatcher &dispatcher,
+		const btDispatcherInfo &dispatchInfo ) :
+	pPairs( pairs ),
+	pDispatcher( dispatcher ),
+	pDispatchInfo( dispatchInfo ){
+	}
+	
+	virtual void forLoop( int iBegin, int iEnd ) const{
+		const btNearCallback nearCallback = pDispatcher.getNearCallback();
+		int i;
+		for( i=iBegin; i<iEnd; i++ ){
+			nearCallback( *pPairs[ i ], pDispatcher, pDispatchInfo );
+		}
+	}
+};
+
+static int debpCDBodyId( const btCollisionObject *body ){
+	const btBroadphaseProxy * const proxy = body->getBroadphaseHandle();
+	return proxy ? proxy->m_uniqueId : -1;
+}
+
+static bool debpCDVectorLess( const btVector3 &a, const btVector3 &b ){
+	if( a.getX() != b.getX() ){
+		return a.getX() < b.getX();
+	}
+	if( a.getY() != b.getY() ){
+		return a.getY() < b.getY();
+	}
+	return a.getZ() < b.getZ();
+}
+
+// orders manifolds by the content only. manifolds between the same bodies exist for
+// compound shapes and are told apart by their contact points
+class debpCDManifoldSortPredicate{
+public:
+	bool operator()( const btPersistentManifold *a, const btPersistentManifold *b ) const{
+		int idA = debpCDBodyId( a->getBody0() );
+		int idB = debpCDBodyId( b->getBody0() );
+		if( idA != idB ){
+			return idA < idB;
+		}
+		
+		idA = debpCDBodyId( a->getBody1() );
+		idB = debpCDBodyId( b->getBody1() );
+		if( idA != idB ){
+			return idA < idB;
+		}
+		
+		const int countA = a->getNumContacts();
+		const int countB = b->getNumContacts();
+		if( countA != countB || countA == 0 ){
+			return countA < countB;
+		}
+		
+		const btManifoldPoint &pointA = a->getContactPoint( 0 );
+		const btManifoldPoint &pointB = b->getContactPoint( 0 );
+		if( pointA.m_localPointA != pointB.m_localPointA ){
+			return debpCDVectorLess( pointA.m_localPointA, pointB.m_localPointA );
+		}
+		return debpCDVectorLess( pointA.m_localPointB, pointB.m_localPointB );
+	}
+};
 
 
 
@@ -40,7 +130,10 @@ debpCollisionDispatcher::debpCollisionDispatcher(
 	debpSharedCollisionFiltering &collisionFiltering,
 	btCollisionConfiguration *collisionConfiguration ) :
 btCollisionDispatcher( collisionConfiguration ),
-pCollisionFiltering( collisionFiltering ){
+pCollisionFiltering( collisionFiltering ),
+pTaskScheduler( NULL ),
+pDeterministic( true ),
+pBatchUpdating( false ){
 }
 
 debpCollisionDispatcher::~debpCollisionDispatcher(){
@@ -48,9 +141,120 @@ debpCollisionDispatcher::~debpCollisionDispatcher(){
 
 
 
+// Management
+///////////////
+
+void debpCollisionDispatcher::SetTaskScheduler( btITaskScheduler *taskScheduler ){
+	pTaskScheduler = taskScheduler;
+}
+
+void debpCollisionDispatcher::SetDeterministic( bool deterministic ){
+	pDeterministic = deterministic;
+}
+
+
+
 // Overloads
 //////////////
 
+btPersistentManifold *debpCollisionDispatcher::getNewManifold(
+const btCollisionObject *b0, const btCollisionObject *b1 ){
+	if( pBatchUpdating ){
+		const deMutexGuard lock( pMutex );
+		return btCollisionDispatcher::getNewManifold( b0, b1 );
+	}
+	return btCollisionDispatcher::getNewManifold( b0, b1 );
+}
+
+void debpCollisionDispatcher::releaseManifold( btPersistentManifold *manifold ){
+	if( pBatchUpdating ){
+		const deMutexGuard lock( pMutex );
+		btCollisionDispatcher::releaseManifold( manifold );
+		
+	}else{
+		btCollisionDispatcher::releaseManifold( manifold );
+	}
+}
+
+void *debpCollisionDispatcher::allocateCollisionAlgorithm( int size ){
+	if( pBatchUpdating ){
+		const deMutexGuard lock( pMutex );
+		return btCollisionDispatcher::allocateCollisionAlgorithm( size );
+	}
+	return btCollisionDispatcher::allocateCollisionAlgorithm( size );
+}
+
+void debpCollisionDispatcher::freeCollisionAlgorithm( void *ptr ){
+	if( pBatchUpdating ){
+		const deMutexGuard lock( pMutex );
+		btCollisionDispatcher::freeCollisionAlgorithm( ptr );
+		
+	}else{
+		btCollisionDispatcher::freeCollisionAlgorithm( ptr );
+	}
+}
+
+void debpCollisionDispatcher::dispatchAllCollisionPairs( btOverlappingPairCache *pairCache,
+const btDispatcherInfo &dispatchInfo, btDispatcher *dispatcher ){
+	const int pairCount = pairCache->getNumOverlappingPairs();
+	
+	if( ! pTaskScheduler || pairCount < PARALLEL_MIN_PAIRS
+	|| dispatchInfo.m_dispatchFunc != btDispatcherInfo::DISPATCH_DISCRETE ){
+		btCollisionDispatcher::dispatchAllCollisionPairs( pairCache, dispatchInfo, dispatcher );
+		return;
+	}
+	
+	// soft bodies update shared per-body state while colliding. process these pairs
+	// serially after the parallel pairs
+	btBroadphasePairArray &pairs = pairCache->getOverlappingPairArray();
+	const btNearCallback nearCallback = getNearCallback();
+	int i;
+	
+	pParallelPairs.resize( 0 );
+	for( i=0; i<pairCount; i++ ){
+		btBroadphasePair &pair = pairs[ i ];
+		const btCollisionObject * const colObj0 = ( btCollisionObject* )pair.m_pProxy0->m_clientObject;
+		const btCollisionObject * const colObj1 = ( btCollisionObject* )pair.m_pProxy1->m_clientObject;
+		
+		if( colObj0->getInternalType() != btCollisionObject::CO_SOFT_BODY
+		&& colObj1->getInternalType() != btCollisionObject::CO_SOFT_BODY ){
+			pParallelPairs.push_back( &pair );
+		}
+	}
+	
+	if( pParallelPairs.size() > 0 ){
+		const debpCDParallelDispatch body( &pParallelPairs[ 0 ], *this, dispatchInfo );
+		pBatchUpdating = true;
+		
+		try{
+			pTaskScheduler->parallelFor( 0, pParallelPairs.size(), PARALLEL_GRAIN_SIZE, body );
+			
+		}catch( const deException & ){
+			pBatchUpdating = false;
+			throw;
+		}
+		
+		pBatchUpdating = false;
+	}
+	
+	if( pParallelPairs.size() < pairCount ){
+		for( i=0; i<pairCount; i++ ){
+			btBroadphasePair &pair = pairs[ i ];
+			const btCollisionObject * const colObj0 = ( btCollisionObject* )pair.m_pProxy0->m_clientObject;
+			const btCollisionObject * const colObj1 = ( btCollisionObject* )pair.m_pProxy1->m_clientObject;
+			
+			if( colObj0->getInternalType() == btCollisionObject::CO_SOFT_BODY
+			|| colObj1->getInternalType() == btCollisionObject::CO_SOFT_BODY ){
+				nearCallback( pair, *this, dispatchInfo );
+			}
+		}
+	}
+	
+	if( pDeterministic ){
+		pSortManifolds();
+	}
+}
+
 /*
 // this is disabled because debpOverlapFilterCallback is already doing the same filtering.
 // nobody else than btCollisionPairCallback::processOverlap in btCollisionDispatcher.cpp
@@ -74,3 +278,22 @@ bool debpCollisionDispatcher::needsResponse( const btCollisionObject *body0, con
 	return btCollisionDispatcher::needsResponse( body0, body1 );
 }
 */
+
+
+
+// Private Functions
+//////////////////////
+
+void debpCollisionDispatcher::pSortManifolds(){
+	const int count = m_manifoldsPtr.size();
+	if( count < 2 ){
+		return;
+	}
+	
+	m_manifoldsPtr.quickSort( debpCDManifoldSortPredicate() );
+	
+	int i;
+	for( i=0; i<count; i++ ){
+		m_manifoldsPtr[ i ]->m_index1a = i;
+	}
+}
@@ -23,10 +23,12 @@
 #define _DEBPCOLLISIONDISPATCHER_H_
 
 #include <dragengine/common/math/decMath.h>
+#include <dragengine/threading/deMutex.h>
 
 #include "BulletCollision/CollisionDispatch/btCollisionDispatcher.h"
 
 class btCollisionConfiguration;
+class btITaskScheduler;
 class debpSharedCollisionFiltering;
 
 
@@ -36,11 +38,24 @@ class debpSharedCollisionFiltering;
  * 
  * Enhances the CollisionDispatcher to determine the need for collision detection and
  * response using the callback functions build into the scripting peers.
+ * 
+ * If a task scheduler is set discrete collision pairs are processed in parallel. Creating
+ * and releasing manifolds and collision algorithms is guarded by a mutex while doing so.
+ * Pairs involving soft bodies are processed serially since soft bodies share state across
+ * pairs. If deterministic is enabled the manifolds are sorted afterwards to not depend on
+ * the order parallel tasks created them.
  */
 class debpCollisionDispatcher : public btCollisionDispatcher{
 private:
 	debpSharedCollisionFiltering &pCollisionFiltering;
 	
+	btITaskScheduler *pTaskScheduler;
+	bool pDeterministic;
+	bool pBatchUpdating;
+	deMutex pMutex;
+	
+	btAlignedObjectArray<btBroadphasePair*> pParallelPairs;
+	
 	
 	
 public:
@@ -58,12 +73,49 @@ public:
 	
 	/** \name Management */
 	/*@{*/
+	/** \brief Task scheduler used for parallel dispatching or NULL to dispatch serially. */
+	inline btITaskScheduler *GetTaskScheduler() const{ return pTaskScheduler; }
+	
+	/** \brief Set task scheduler used for parallel dispatching or NULL to dispatch serially. */
+	void SetTaskScheduler( btITaskScheduler *taskScheduler );
+	
+	/** \brief Manifold order is independent of the number of threads used. */
+	inline bool GetDeterministic() const{ return pDeterministic; }
+	
+	/** \brief Set if manifold order is independent of the number of threads used. */
+	void SetDeterministic( bool deterministic );
+	
+	
+	
+	/** \brief Create manifold. */
+	virtual btPersistentManifold *getNewManifold( const btCollisionObject *b0, const btCollisionObject *b1 );
+	
+	/** \brief Release manifold. */
+	virtual void releaseManifold( btPersistentManifold *manifold );
+	
+	/** \brief Allocate collision algorithm memory. */
+	virtual void *allocateCollisionAlgorithm( int size );
+	
+	/** \brief Free collision algorithm memory. */
+	virtual void freeCollisionAlgorithm( void *ptr );
+	
+	/** \brief Dispatch all collision pairs. */
+	virtual void dispatchAllCollisionPairs( btOverlappingPairCache *pairCache,
+		const btDispatcherInfo &dispatchInfo, btDispatcher *dispatcher );
+		
+		
+		
 	/** \brief Collision objects can collide. */
 // 	virtual bool needsCollision( const btCollisionObject *body0, const btCollisionObject *body1 );
 	
 	/** \brief Collision objects need collision response. */
 // 	virtual bool needsResponse( const btCollisionObject *body0, const btCollisionObject *body1 );
 	/*@}*/
+	
+	
+	
+private:
+	void pSortManifolds();
 };
 
 #endif
@@ -21,9 +21,11 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "debpCollisionWorld.h"
 #include "debpDelayedOperation.h"
+#include "debpParallelIslandSolver.h"
 #include "../dePhysicsBullet.h"
 #include "../debpCollisionObject.h"
 #include "../coldet/debpCollisionDetection.h"
@@ -48,6 +50,10 @@
 #include "BulletCollision/CollisionShapes/btCollisionShape.h"
 #include "BulletCollision/CollisionShapes/btBoxShape.h"
 #include "BulletCollision/CollisionShapes/btCompoundShape.h"
+#include "BulletSoftBody/btSoftBodySolvers.h"
+#include "BulletDynamics/ConstraintSolver/btConstraintSolver.h"
+#include "LinearMath/btQuickprof.h"
+#include "LinearMath/btThreads.h"
 
 
 
@@ -70,6 +76,55 @@
 
 
 
+// minimum number of bodies to process in parallel and number of bodies per task
+#define PARALLEL_MIN_BODIES		256
+#define PARALLEL_GRAIN_SIZE		64
+
+
+
+// Parallel body processing
+/////////////////////////////
+
+class debpCWParallelPredictMotion : public btIParallelForBody{
+private:
+	btRigidBody * const * const pBodies;
+	const btScalar pTimeStep;
+	
+public:
+	debpCWParallelPredictMotion( btRigidBody * const *bodies, btScalar timeStep ) :
+	pBodies( bodies ), pTimeStep( timeStep ){
+	}
+	
+	virtual void forLoop( int iBegin, int iEnd ) const{
+		int i;
+		for( i=iBegin; i<iEnd; i++ ){
+			btRigidBody &body = *pBodies[ i ];
+			if( ! body.isStaticOrKinematicObject() ){
+				body.applyDamping( pTimeStep );
+				body.predictIntegratedTransform( pTimeStep, body.getInterpolationWorldTransform() );
+			}
+		}
+	}
+};
+
+class debpCWParallelIntegrateTransforms : public btIParallelForBody{
+private:
+	debpCollisionWorld &pWorld;
+	btRigidBody ** const pBodies;
+	const btScalar pTimeStep;
+	
+public:
+	debpCWParallelIntegrateTransforms( debpCollisionWorld &world, btRigidBody **bodies, btScalar timeStep ) :
+	pWorld( world ), pBodies( bodies ), pTimeStep( timeStep ){
+	}
+	
+	virtual void forLoop( int iBegin, int iEnd ) const{
+		pWorld.IntegrateBodyTransforms( pBodies + iBegin, iEnd - iBegin, pTimeStep );
+	}
+};
+
+
+
 // Dummy manifold point to be used where bullet requires one but dragengine not
 static btManifoldPoint vDummyManifoldPoint;
 
@@ -286,7 +341,13 @@ btBroadphaseInterface *pairCache, btMultiBodyConstraintSolver *constraintSolver,
 btCollisionConfiguration *collisionConfiguration, btSoftBodySolver *softBodySolver ) :
 btSoftMultiBodyDynamicsWorld( dispatcher, pairCache, constraintSolver, collisionConfiguration, softBodySolver ),
 pWorld( world ),
-pDelayedOperation( NULL )
+pDelayedOperation( NULL ),
+pSoftBodySolver( softBodySolver ),
+pTaskScheduler( NULL ),
+pParallelIslandSolver( NULL ),
+pDirtyAABBs( NULL ),
+pDirtyAABBCount( 0 ),
+pDirtyAABBSize( 0 )
 {
 	btContactSolverInfo &solverInfo = getSolverInfo();
 	
@@ -333,6 +394,12 @@ pDelayedOperation( NULL )
 	//solverInfo.m_sor = 1.0f;
 	//solverInfo.m_erp2 = 0.1f;
 	
+	// update only AABBs of active collision objects while stepping. static and sleeping
+	// collision objects keep their broadphase proxy untouched which allows the broadphase
+	// to keep them in the rarely rebuilt fixed set. collision objects moved outside the
+	// simulation step are tracked using the dirty AABB list
+	setForceUpdateAllAabbs( false );
+	
 	// set tick callbacks if required
 #if 0
 	setInternalTickCallback( cbPreTick, this, true );
@@ -397,6 +464,17 @@ pDelayedOperation( NULL )
 }
 
 debpCollisionWorld::~debpCollisionWorld(){
+	int i;
+	for( i=0; i<pDirtyAABBCount; i++ ){
+		pDirtyAABBs[ i ]->SetDirtyAABBIndex( -1 );
+	}
+	if( pDirtyAABBs ){
+		delete [] pDirtyAABBs;
+	}
+	
+	if( pParallelIslandSolver ){
+		delete pParallelIslandSolver;
+	}
 	if( pDelayedOperation ){
 		delete pDelayedOperation;
 	}
@@ -407,28 +485,63 @@ debpCollisionWorld::~debpCollisionWorld(){
 // Management
 ///////////////
 
-void debpCollisionWorld::MarkAllAABBValid(){
-	const btCollisionObjectArray &list = getCollisionObjectArray();
-	const int count = list.size();
-	int i;
+void debpCollisionWorld::SetTaskScheduler( btITaskScheduler *taskScheduler ){
+	pTaskScheduler = taskScheduler;
 	
-	for( i=0; i<count; i++ ){
-		( ( debpCollisionObject* )list.at( i )->getUserPointer() )->SetDirtyAABB( false );
+	if( taskScheduler && ! pParallelIslandSolver ){
+		pParallelIslandSolver = new debpParallelIslandSolver;
 	}
 }
 
-void debpCollisionWorld::UpdateDirtyAABBs(){
-	const btCollisionObjectArray &list = getCollisionObjectArray();
-	const int count = list.size();
-	int i;
+void debpCollisionWorld::AddDirtyAABB( debpCollisionObject *collisionObject ){
+	if( ! collisionObject ){
+		DETHROW( deeInvalidParam );
+	}
+	if( collisionObject->GetDirtyAABBIndex() != -1 ){
+		return;
+	}
 	
-	for( i=0; i<count; i++ ){
-		btCollisionObject * const btColObj = list.at( i );
-		debpCollisionObject &colObj = *( ( debpCollisionObject* )btColObj->getUserPointer() );
-		if( colObj.GetDirtyAABB() ){
-			colObj.SetDirtyAABB( false );
-			updateSingleAabb( btColObj );
+	if( pDirtyAABBCount == pDirtyAABBSize ){
+		const int newSize = pDirtyAABBSize * 3 / 2 + 10;
+		debpCollisionObject ** const newArray = new debpCollisionObject*[ newSize ];
+		if( pDirtyAABBs ){
+			memcpy( newArray, pDirtyAABBs, sizeof( debpCollisionObject* ) * pDirtyAABBSize );
+			delete [] pDirtyAABBs;
 		}
+		pDirtyAABBs = newArray;
+		pDirtyAABBSize = newSize;
+	}
+	
+	collisionObject->SetDirtyAABBIndex( pDirtyAABBCount );
+	pDirtyAABBs[ pDirtyAABBCount++ ] = collisionObject;
+}
+
+void debpCollisionWorld::RemoveDirtyAABB( debpCollisionObject *collisionObject ){
+	if( ! collisionObject ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	const int index = collisionObject->GetDirtyAABBIndex();
+	if( index == -1 ){
+		return;
+	}
+	
+	// move last entry into the gap. the order of dirty AABB updates does not matter
+	pDirtyAABBCount--;
+	if( index < pDirtyAABBCount ){
+		pDirtyAABBs[ index ] = pDirtyAABBs[ pDirtyAABBCount ];
+		pDirtyAABBs[ index ]->SetDirtyAABBIndex( index );
+	}
+	collisionObject->SetDirtyAABBIndex( -1 );
+}
+
+void debpCollisionWorld::UpdateDirtyAABBs(){
+	// UpdateAABB does not add collision objects to the dirty list. clear the entries first
+	// in case an exception is thrown
+	while( pDirtyAABBCount > 0 ){
+		debpCollisionObject &collisionObject = *pDirtyAABBs[ --pDirtyAABBCount ];
+		collisionObject.SetDirtyAABBIndex( -1 );
+		collisionObject.UpdateAABB();
 	}
 }
 
@@ -628,6 +741,14 @@ void debpCollisionWorld::CheckDynamicCollisions( btScalar timeStep ){
 
 
 
+void debpCollisionWorld::InterpolateMotionStates( btScalar remainingTime, btScalar stepSize ){
+	// synchronizeSingleMotionState() integrates the body transform back in time by
+	// (m_localTime - m_fixedTimeStep) if latency motion state interpolation is used
+	m_localTime = remainingTime;
+	m_fixedTimeStep = stepSize;
+	synchronizeMotionStates();
+}
+
 void debpCollisionWorld::safeRayTest( const btVector3 &rayFromWorld, const btVector3 &rayToWorld,
 btCollisionWorld::RayResultCallback &resultCallback ) const{
 	pDelayedOperation->Lock();
@@ -980,7 +1101,85 @@ void debpCollisionWorld::contactTest( btCollisionObject *colObj, btCollisionWorl
 
 
 void debpCollisionWorld::solveConstraints( btContactSolverInfo &solverInfo ){
-	btSoftMultiBodyDynamicsWorld::solveConstraints( solverInfo );
+	// multi bodies need additional processing between solving islands. use the
+	// parallel solver only if the world contains none of them
+	if( ! pTaskScheduler || ! m_islandManager->getSplitIslands()
+	|| m_multiBodies.size() > 0 || m_multiBodyConstraints.size() > 0 ){
+		btSoftMultiBodyDynamicsWorld::solveConstraints( solverInfo );
+		return;
+	}
+	
+	BT_PROFILE( "solveConstraints" );
+	
+	m_constraintSolver->prepareSolve( getNumCollisionObjects(), getDispatcher()->getNumManifolds() );
+	
+	pParallelIslandSolver->Solve( *pTaskScheduler, *m_islandManager, *this,
+		m_constraints.size() > 0 ? &m_constraints[ 0 ] : NULL, m_constraints.size(),
+		solverInfo, getDebugDrawer() );
+		
+	m_constraintSolver->allSolved( solverInfo, getDebugDrawer() );
+}
+
+void debpCollisionWorld::IntegrateBodyTransforms( btRigidBody **bodies, int count, btScalar timeStep ){
+	integrateTransformsInternal( bodies, count, timeStep );
+}
+
+void debpCollisionWorld::predictUnconstraintMotion( btScalar timeStep ){
+	const int count = m_nonStaticRigidBodies.size();
+	if( ! pTaskScheduler || count < PARALLEL_MIN_BODIES ){
+		btSoftMultiBodyDynamicsWorld::predictUnconstraintMotion( timeStep );
+		return;
+	}
+	
+	{
+	BT_PROFILE( "predictUnconstraintMotion" );
+	const debpCWParallelPredictMotion body( &m_nonStaticRigidBodies[ 0 ], timeStep );
+	pTaskScheduler->parallelFor( 0, count, PARALLEL_GRAIN_SIZE, body );
+	}
+	
+	{
+	BT_PROFILE( "predictUnconstraintMotionSoftBody" );
+	pSoftBodySolver->predictMotion( float( timeStep ) );
+	}
+}
+
+void debpCollisionWorld::integrateTransforms( btScalar timeStep ){
+	// speculative contact restitution and multi bodies are processed after integrating
+	// rigid bodies. leave these cases to the base class
+	const int count = m_nonStaticRigidBodies.size();
+	if( ! pTaskScheduler || count < PARALLEL_MIN_BODIES || m_applySpeculativeContactRestitution
+	|| m_multiBodies.size() > 0 ){
+		btSoftMultiBodyDynamicsWorld::integrateTransforms( timeStep );
+		return;
+	}
+	
+	BT_PROFILE( "integrateTransforms" );
+	
+	// bodies using continuous collision detection sweep against the world. integrate
+	// them serially after all other bodies
+	const bool useContinuous = getDispatchInfo().m_useContinuous;
+	int i;
+	
+	pParallelBodies.resize( 0 );
+	for( i=0; i<count; i++ ){
+		btRigidBody * const body = m_nonStaticRigidBodies[ i ];
+		if( ! useContinuous || body->getCcdSquareMotionThreshold() == btScalar( 0 ) ){
+			pParallelBodies.push_back( body );
+		}
+	}
+	
+	if( pParallelBodies.size() > 0 ){
+		const debpCWParallelIntegrateTransforms body( *this, &pParallelBodies[ 0 ], timeStep );
+		pTaskScheduler->parallelFor( 0, pParallelBodies.size(), PARALLEL_GRAIN_SIZE, body );
+	}
+	
+	if( pParallelBodies.size() < count ){
+		for( i=0; i<count; i++ ){
+			if( m_nonStaticRigidBodies[ i ]->getCcdSquareMotionThreshold() != btScalar( 0 ) ){
+				integrateTransformsInternal( &m_nonStaticRigidBodies[ i ], 1, timeStep );
+			}
+		}
+	}
 }
 
 
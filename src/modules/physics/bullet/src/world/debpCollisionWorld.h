@@ -27,7 +27,10 @@
 
 #include <dragengine/common/utils/decTimer.h>
 
+class btITaskScheduler;
+class debpCollisionObject;
 class debpDelayedOperation;
+class debpParallelIslandSolver;
 class debpWorld;
 
 
@@ -41,6 +44,15 @@ private:
 	debpDelayedOperation *pDelayedOperation;
 	decTimer pPerfTimer;
 	
+	btSoftBodySolver *pSoftBodySolver;
+	btITaskScheduler *pTaskScheduler;
+	debpParallelIslandSolver *pParallelIslandSolver;
+	btAlignedObjectArray<btRigidBody*> pParallelBodies;
+	
+	debpCollisionObject **pDirtyAABBs;
+	int pDirtyAABBCount;
+	int pDirtyAABBSize;
+	
 	
 	
 public:
@@ -63,9 +75,32 @@ public:
 	inline debpDelayedOperation &GetDelayedOperation(){ return *pDelayedOperation; }
 	inline const debpDelayedOperation &GetDelayedOperation() const{ return *pDelayedOperation; }
 	
-	/** \brief Mark all collision objects AABB valid. */
-	void MarkAllAABBValid();
-	/** \brief Update all dirty collision objects AABBs. */
+	/** \brief Task scheduler used for parallel simulation or NULL to simulate serially. */
+	inline btITaskScheduler *GetTaskScheduler() const{ return pTaskScheduler; }
+	
+	/**
+	 * \brief Set task scheduler used for parallel simulation or NULL to simulate serially.
+	 * 
+	 * Predicting motion, solving islands and integrating transforms of rigid bodies is done
+	 * in parallel. Worlds containing multi bodies solve islands serially.
+	 */
+	void SetTaskScheduler( btITaskScheduler *taskScheduler );
+	
+	/** \brief Number of collision objects with dirty AABB. */
+	inline int GetDirtyAABBCount() const{ return pDirtyAABBCount; }
+	
+	/** \brief Add collision object with dirty AABB if not added already. */
+	void AddDirtyAABB( debpCollisionObject *collisionObject );
+	
+	/** \brief Remove collision object with dirty AABB if added. */
+	void RemoveDirtyAABB( debpCollisionObject *collisionObject );
+	
+	/**
+	 * \brief Update AABBs of collision objects with dirty AABB.
+	 * 
+	 * Only collision objects moved since the last update are processed. Stepping the
+	 * simulation updates only AABBs of active collision objects.
+	 */
 	void UpdateDirtyAABBs();
 	
 // 	virtual void updateAabbs();
@@ -73,6 +108,18 @@ public:
 	/** \brief Check for dynamic collisions after a simulation step. */
 	void CheckDynamicCollisions( btScalar timeStep );
 	
+	/**
+	 * \brief Interpolate motion states of dynamic bodies.
+	 * 
+	 * Used after stepping the simulation in fixed time steps to place motion states between
+	 * the last two simulation steps. Does the same as stepSimulation() does for motion states
+	 * with a fixed time step. Bodies keep their simulation transform.
+	 * 
+	 * \param[in] remainingTime Time left over after the last step.
+	 * \param[in] stepSize Fixed time step size.
+	 */
+	void InterpolateMotionStates( btScalar remainingTime, btScalar stepSize );
+	
 	/**
 	 * \brief Script callback safe ray testing.
 	 * 
@@ -173,6 +220,15 @@ public:
 	/** \brief Solve constraints. */
 	virtual void solveConstraints( btContactSolverInfo &solverInfo );
 	
+	/** \brief Predict motion of bodies without constraints. */
+	virtual void predictUnconstraintMotion( btScalar timeStep );
+	
+	/** \brief Integrate transforms of bodies. */
+	virtual void integrateTransforms( btScalar timeStep );
+	
+	/** \brief Integrate transforms of range of bodies. For internal use only. */
+	void IntegrateBodyTransforms( btRigidBody **bodies, int count, btScalar timeStep );
+	
 #if 0
 	/**
 	 * rayTest performs a raycast on all objects in the btCollisionWorld, and calls the resultCallback
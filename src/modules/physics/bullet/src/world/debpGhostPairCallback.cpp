@@ -108,19 +108,12 @@ void *debpGhostPairCallback::removeOverlappingPair( btBroadphaseProxy *proxy0, b
 // 		printf( "GPC-: ts=%p s=%p co=%p(%c)\n", touchSensor.GetTouchSensor(), &touchSensor,
 // 			&colObj1, colObj1.IsOwnerCollider() ? 'C' : ( colObj1.IsOwnerHTSector() ? 'H' : 'T' ) );
 		
-		if( touchSensor.GetTouchSensor().GetTrackEnterLeave() ){
-			if( colObj1.IsOwnerCollider() ){
-				debpCollider * const collider = colObj1.GetOwnerCollider();
-				
-				if( touchSensor.GetTouchingColliders().Has( collider ) ){
-// 					printf( "GPC: ts=%p s=%p => remove collider %p\n", touchSensor.GetTouchSensor(), &touchSensor, &colObj1 );
-					touchSensor.GetTouchingColliders().Remove( collider );
-					touchSensor.GetLeavingColliders().Add( collider );
-				}
-				
-			//}else if( colObj1.IsOwnerHTSector() ){
-			//	// TODO
-			}
+		if( colObj1.IsOwnerCollider() ){
+// 			printf( "GPC: ts=%p s=%p => remove collider %p\n", touchSensor.GetTouchSensor(), &touchSensor, &colObj1 );
+			touchSensor.ColliderPairRemoved( colObj1.GetOwnerCollider() );
+			
+		//}else if( colObj1.IsOwnerHTSector() ){
+		//	// TODO
 		}
 		
 	// for all other ghost objects use the default behavior
@@ -136,19 +129,12 @@ void *debpGhostPairCallback::removeOverlappingPair( btBroadphaseProxy *proxy0, b
 // 		printf( "GPC-: ts=%p s=%p co=%p(%c)\n", touchSensor.GetTouchSensor(), &touchSensor,
 // 			&colObj0, colObj0.IsOwnerCollider() ? 'C' : ( colObj0.IsOwnerHTSector() ? 'H' : 'T' ) );
 		
-		if( touchSensor.GetTouchSensor().GetTrackEnterLeave() ){
-			if( colObj0.IsOwnerCollider() ){
-				debpCollider * const collider = colObj0.GetOwnerCollider();
-				
-				if( touchSensor.GetTouchingColliders().Has( collider ) ){
-// 					printf( "GPC: ts=%p s=%p => remove collider %p\n", touchSensor.GetTouchSensor(), &touchSensor, &colObj1 );
-					touchSensor.GetTouchingColliders().Remove( collider );
-					touchSensor.GetLeavingColliders().Add( collider );
-				}
-				
-			//}else if( colObj1.IsOwnerHTSector() ){
-			//	// TODO
-			}
+		if( colObj0.IsOwnerCollider() ){
+// 			printf( "GPC: ts=%p s=%p => remove collider %p\n", touchSensor.GetTouchSensor(), &touchSensor, &colObj1 );
+			touchSensor.ColliderPairRemoved( colObj0.GetOwnerCollider() );
+			
+		//}else if( colObj1.IsOwnerHTSector() ){
+		//	// TODO
 		}
 		
 	// for all other ghost objects use the default behavior
@@ -0,0 +1,339 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "debpParallelIslandSolver.h"
+#include "debpConstraintSolver.h"
+
+#include "BulletCollision/CollisionDispatch/btCollisionWorld.h"
+#include "BulletDynamics/ConstraintSolver/btTypedConstraint.h"
+#include "BulletDynamics/Dynamics/btRigidBody.h"
+#include "LinearMath/btThreads.h"
+
+#include <dragengine/common/exceptions.h>
+#include <dragengine/threading/deMutexGuard.h>
+
+
+
+// Island sorting
+///////////////////
+
+// same as btGetConstraintIslandId2 in btMultiBodyDynamicsWorld.cpp
+static inline int debpPISConstraintIslandId( const btTypedConstraint *constraint ){
+	const btCollisionObject &colObj0 = constraint->getRigidBodyA();
+	const btCollisionObject &colObj1 = constraint->getRigidBodyB();
+	return colObj0.getIslandTag() >= 0 ? colObj0.getIslandTag() : colObj1.getIslandTag();
+}
+
+class debpPISSortConstraintOnIsland{
+public:
+	bool operator()( const btTypedConstraint *lhs, const btTypedConstraint *rhs ) const{
+		return debpPISConstraintIslandId( lhs ) < debpPISConstraintIslandId( rhs );
+	}
+};
+
+
+
+// Parallel solving
+/////////////////////
+
+class debpPISSolveLanes : public btIParallelForBody{
+private:
+	debpParallelIslandSolver &pSolver;
+	
+public:
+	debpPISSolveLanes( debpParallelIslandSolver &solver ) : pSolver( solver ){
+	}
+	
+	virtual void forLoop( int iBegin, int iEnd ) const{
+		pSolver.SolveLanes( iBegin, iEnd );
+	}
+};
+
+
+
+// Class debpParallelIslandSolver
+///////////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+debpParallelIslandSolver::debpParallelIslandSolver() :
+pSolverInfo( NULL ),
+pDebugDrawer( NULL ),
+pDispatcher( NULL )
+{
+	memset( &pOpenGroup, 0, sizeof( pOpenGroup ) );
+}
+
+debpParallelIslandSolver::~debpParallelIslandSolver(){
+	const int count = pSolvers.size();
+	int i;
+	for( i=0; i<count; i++ ){
+		delete pSolvers[ i ];
+	}
+}
+
+
+
+// Management
+///////////////
+
+void debpParallelIslandSolver::Solve( btITaskScheduler &taskScheduler,
+btSimulationIslandManager &islandManager, btCollisionWorld &world,
+btTypedConstraint **constraints, int constraintCount,
+const btContactSolverInfo &solverInfo, btIDebugDraw *debugDrawer ){
+	int i;
+	
+	pSortedConstraints.resize( constraintCount );
+	for( i=0; i<constraintCount; i++ ){
+		pSortedConstraints[ i ] = constraints[ i ];
+	}
+	pSortedConstraints.quickSort( debpPISSortConstraintOnIsland() );
+	
+	pSolverInfo = &solverInfo;
+	pDebugDrawer = debugDrawer;
+	pDispatcher = world.getDispatcher();
+	
+	pBodies.resize( 0 );
+	pManifolds.resize( 0 );
+	pConstraints.resize( 0 );
+	pGroups.resize( 0 );
+	memset( &pOpenGroup, 0, sizeof( pOpenGroup ) );
+	
+	// collect groups. islands are batched the same way btMultiBodyDynamicsWorld does
+	islandManager.buildAndProcessIslands( pDispatcher, &world, this );
+	pCloseGroup();
+	
+	if( pGroups.size() == 0 ){
+		return;
+	}
+	
+	// solve lanes in parallel. each lane is processed by one thread
+	pBuildLanes();
+	
+	const debpPISSolveLanes body( *this );
+	taskScheduler.parallelFor( 0, pLaneFirstGroup.size() - 1, 1, body );
+}
+
+void debpParallelIslandSolver::SolveLanes( int firstLane, int lastLane ){
+	debpConstraintSolver * const solver = pAcquireSolver();
+	btCollisionObject ** const bodies = pBodies.size() > 0 ? &pBodies[ 0 ] : NULL;
+	btPersistentManifold ** const manifolds = pManifolds.size() > 0 ? &pManifolds[ 0 ] : NULL;
+	btTypedConstraint ** const constraints = pConstraints.size() > 0 ? &pConstraints[ 0 ] : NULL;
+	int i, j;
+	
+	for( i=firstLane; i<lastLane; i++ ){
+		const int last = pLaneFirstGroup[ i + 1 ];
+		
+		for( j=pLaneFirstGroup[ i ]; j<last; j++ ){
+			const sGroup &group = pGroups[ pLaneGroups[ j ] ];
+			
+			solver->solveMultiBodyGroup(
+				bodies ? bodies + group.firstBody : NULL, group.bodyCount,
+				manifolds ? manifolds + group.firstManifold : NULL, group.manifoldCount,
+				constraints ? constraints + group.firstConstraint : NULL, group.constraintCount,
+				NULL, 0, *pSolverInfo, pDebugDrawer, pDispatcher );
+		}
+	}
+	
+	pReleaseSolver( solver );
+}
+
+void debpParallelIslandSolver::processIsland( btCollisionObject **bodies, int numBodies,
+btPersistentManifold **manifolds, int numManifolds, int islandId ){
+	// find constraints of this island. constraints are sorted by island
+	const int constraintCount = pSortedConstraints.size();
+	int first = 0;
+	int last = constraintCount;
+	int i;
+	
+	while( first < last ){
+		const int middle = ( first + last ) / 2;
+		if( debpPISConstraintIslandId( pSortedConstraints[ middle ] ) < islandId ){
+			first = middle + 1;
+			
+		}else{
+			last = middle;
+		}
+	}
+	
+	for( last=first; last<constraintCount; last++ ){
+		if( debpPISConstraintIslandId( pSortedConstraints[ last ] ) != islandId ){
+			break;
+		}
+	}
+	
+	// add island to open group
+	for( i=0; i<numBodies; i++ ){
+		pBodies.push_back( bodies[ i ] );
+	}
+	for( i=0; i<numManifolds; i++ ){
+		pManifolds.push_back( manifolds[ i ] );
+	}
+	for( i=first; i<last; i++ ){
+		pConstraints.push_back( pSortedConstraints[ i ] );
+	}
+	
+	pOpenGroup.bodyCount += numBodies;
+	pOpenGroup.manifoldCount += numManifolds;
+	pOpenGroup.constraintCount += last - first;
+	
+	if( pOpenGroup.constraintCount + pOpenGroup.manifoldCount > pSolverInfo->m_minimumSolverBatchSize ){
+		pCloseGroup();
+	}
+}
+
+
+
+// Private Functions
+//////////////////////
+
+void debpParallelIslandSolver::pCloseGroup(){
+	if( pOpenGroup.bodyCount > 0 || pOpenGroup.manifoldCount > 0 || pOpenGroup.constraintCount > 0 ){
+		pGroups.push_back( pOpenGroup );
+	}
+	
+	pOpenGroup.firstBody = pBodies.size();
+	pOpenGroup.bodyCount = 0;
+	pOpenGroup.firstManifold = pManifolds.size();
+	pOpenGroup.manifoldCount = 0;
+	pOpenGroup.firstConstraint = pConstraints.size();
+	pOpenGroup.constraintCount = 0;
+}
+
+void debpParallelIslandSolver::pBuildLanes(){
+	const int groupCount = pGroups.size();
+	int i, j;
+	
+	// merge groups sharing kinematic bodies
+	btHashMap<btHashPtr, int> kinematicGroups;
+	
+	pGroupParent.resize( groupCount );
+	for( i=0; i<groupCount; i++ ){
+		pGroupParent[ i ] = i;
+	}
+	
+	for( i=0; i<groupCount; i++ ){
+		const sGroup &group = pGroups[ i ];
+		
+		for( j=0; j<group.manifoldCount; j++ ){
+			const btPersistentManifold &manifold = *pManifolds[ group.firstManifold + j ];
+			pAddKinematicBody( *manifold.getBody0(), i, kinematicGroups );
+			pAddKinematicBody( *manifold.getBody1(), i, kinematicGroups );
+		}
+		
+		for( j=0; j<group.constraintCount; j++ ){
+			const btTypedConstraint &constraint = *pConstraints[ group.firstConstraint + j ];
+			pAddKinematicBody( constraint.getRigidBodyA(), i, kinematicGroups );
+			pAddKinematicBody( constraint.getRigidBodyB(), i, kinematicGroups );
+		}
+	}
+	
+	// assign lanes in order of their first group. groups keep their order inside lanes
+	btAlignedObjectArray<int> rootLane;
+	btAlignedObjectArray<int> groupLane;
+	int laneCount = 0;
+	
+	rootLane.resize( groupCount, -1 );
+	groupLane.resize( groupCount );
+	
+	for( i=0; i<groupCount; i++ ){
+		const int root = pFindGroupRoot( i );
+		if( rootLane[ root ] == -1 ){
+			rootLane[ root ] = laneCount++;
+		}
+		groupLane[ i ] = rootLane[ root ];
+	}
+	
+	pLaneFirstGroup.resize( laneCount + 1 );
+	for( i=0; i<=laneCount; i++ ){
+		pLaneFirstGroup[ i ] = 0;
+	}
+	for( i=0; i<groupCount; i++ ){
+		pLaneFirstGroup[ groupLane[ i ] + 1 ]++;
+	}
+	for( i=0; i<laneCount; i++ ){
+		pLaneFirstGroup[ i + 1 ] += pLaneFirstGroup[ i ];
+	}
+	
+	btAlignedObjectArray<int> laneNext;
+	laneNext.resize( laneCount );
+	for( i=0; i<laneCount; i++ ){
+		laneNext[ i ] = pLaneFirstGroup[ i ];
+	}
+	
+	pLaneGroups.resize( groupCount );
+	for( i=0; i<groupCount; i++ ){
+		pLaneGroups[ laneNext[ groupLane[ i ] ]++ ] = i;
+	}
+}
+
+void debpParallelIslandSolver::pAddKinematicBody( const btCollisionObject &body, int group,
+btHashMap<btHashPtr, int> &kinematicGroups ){
+	if( ! body.isKinematicObject() ){
+		return;
+	}
+	
+	const btHashPtr key( &body );
+	const int * const found = kinematicGroups.find( key );
+	if( ! found ){
+		kinematicGroups.insert( key, group );
+		return;
+	}
+	
+	const int root1 = pFindGroupRoot( *found );
+	const int root2 = pFindGroupRoot( group );
+	if( root1 < root2 ){
+		pGroupParent[ root2 ] = root1;
+		
+	}else if( root2 < root1 ){
+		pGroupParent[ root1 ] = root2;
+	}
+}
+
+int debpParallelIslandSolver::pFindGroupRoot( int group ){
+	while( pGroupParent[ group ] != group ){
+		pGroupParent[ group ] = pGroupParent[ pGroupParent[ group ] ];
+		group = pGroupParent[ group ];
+	}
+	return group;
+}
+
+debpConstraintSolver *debpParallelIslandSolver::pAcquireSolver(){
+	const deMutexGuard lock( pMutexSolvers );
+	
+	if( pSolvers.size() > 0 ){
+		debpConstraintSolver * const solver = pSolvers[ pSolvers.size() - 1 ];
+		pSolvers.pop_back();
+		return solver;
+	}
+	
+	return new debpConstraintSolver;
+}
+
+void debpParallelIslandSolver::pReleaseSolver( debpConstraintSolver *solver ){
+	const deMutexGuard lock( pMutexSolvers );
+	pSolvers.push_back( solver );
+}
@@ -0,0 +1,133 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEBPPARALLELISLANDSOLVER_H_
+#define _DEBPPARALLELISLANDSOLVER_H_
+
+#include <dragengine/threading/deMutex.h>
+
+#include "BulletCollision/CollisionDispatch/btSimulationIslandManager.h"
+#include "LinearMath/btAlignedObjectArray.h"
+#include "LinearMath/btHashMap.h"
+
+class btCollisionObject;
+class btDispatcher;
+class btIDebugDraw;
+class btITaskScheduler;
+class btPersistentManifold;
+class btTypedConstraint;
+class debpConstraintSolver;
+struct btContactSolverInfo;
+
+
+
+/**
+ * \brief Solve simulation islands in parallel.
+ * 
+ * Islands are batched into groups the same way btMultiBodyDynamicsWorld does. Groups do
+ * not share dynamic bodies but they can share kinematic bodies which the constraint solver
+ * writes to while solving. Groups sharing kinematic bodies are put into the same lane and
+ * solved one after the other. Lanes are solved in parallel each using a constraint solver
+ * from a pool. Since every group is solved the same way as in serial solving the results
+ * are identical to serial solving independent of the number of threads used.
+ * 
+ * Only supports worlds without multi bodies.
+ */
+class debpParallelIslandSolver : public btSimulationIslandManager::IslandCallback{
+public:
+	/** \brief Group of islands. */
+	struct sGroup{
+		int firstBody;
+		int bodyCount;
+		int firstManifold;
+		int manifoldCount;
+		int firstConstraint;
+		int constraintCount;
+	};
+	
+	
+	
+private:
+	const btContactSolverInfo *pSolverInfo;
+	btIDebugDraw *pDebugDrawer;
+	btDispatcher *pDispatcher;
+	
+	btAlignedObjectArray<btTypedConstraint*> pSortedConstraints;
+	
+	btAlignedObjectArray<btCollisionObject*> pBodies;
+	btAlignedObjectArray<btPersistentManifold*> pManifolds;
+	btAlignedObjectArray<btTypedConstraint*> pConstraints;
+	btAlignedObjectArray<sGroup> pGroups;
+	sGroup pOpenGroup;
+	
+	btAlignedObjectArray<int> pGroupParent;
+	btAlignedObjectArray<int> pLaneFirstGroup;
+	btAlignedObjectArray<int> pLaneGroups;
+	
+	btAlignedObjectArray<debpConstraintSolver*> pSolvers;
+	deMutex pMutexSolvers;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create parallel island solver. */
+	debpParallelIslandSolver();
+	
+	/** \brief Clean up parallel island solver. */
+	virtual ~debpParallelIslandSolver();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/**
+	 * \brief Solve constraints of all awake islands.
+	 * 
+	 * Island manager has to split islands.
+	 */
+	void Solve( btITaskScheduler &taskScheduler, btSimulationIslandManager &islandManager,
+		btCollisionWorld &world, btTypedConstraint **constraints, int constraintCount,
+		const btContactSolverInfo &solverInfo, btIDebugDraw *debugDrawer );
+		
+	/** \brief Solve lanes. For internal use only. */
+	void SolveLanes( int firstLane, int lastLane );
+	
+	/** \brief Add island to groups. For internal use only. */
+	virtual void processIsland( btCollisionObject **bodies, int numBodies,
+		btPersistentManifold **manifolds, int numManifolds, int islandId );
+	/*@}*/
+	
+	
+	
+private:
+	void pCloseGroup();
+	void pBuildLanes();
+	void pAddKinematicBody( const btCollisionObject &body, int group,
+		btHashMap<btHashPtr, int> &kinematicGroups );
+	int pFindGroupRoot( int group );
+	debpConstraintSolver *pAcquireSolver();
+	void pReleaseSolver( debpConstraintSolver *solver );
+};
+
+#endif
@@ -0,0 +1,192 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "debpTaskScheduler.h"
+#include "../dePhysicsBullet.h"
+#include "../coldet/debpParallelCollisionJob.h"
+
+#include <dragengine/deEngine.h>
+#include <dragengine/common/exceptions.h>
+#include <dragengine/common/math/decMath.h>
+#include <dragengine/parallel/deParallelProcessing.h>
+
+
+
+// Parallel for job
+/////////////////////
+
+class debpTSParallelForJob : public debpParallelCollisionJob{
+private:
+	const int pBegin;
+	const btIParallelForBody &pBody;
+	
+public:
+	debpTSParallelForJob( dePhysicsBullet &bullet, int begin, int end, int grainSize,
+		const btIParallelForBody &body ) :
+	debpParallelCollisionJob( bullet, end - begin, grainSize ),
+	pBegin( begin ),
+	pBody( body ){
+	}
+	
+	virtual const char *GetDebugName() const{
+		return "ParallelFor";
+	}
+	
+protected:
+	virtual ~debpTSParallelForJob(){
+	}
+	
+	virtual void ProcessChunk( int, int firstItem, int itemCount, sThreadData& ){
+		pBody.forLoop( pBegin + firstItem, pBegin + firstItem + itemCount );
+	}
+};
+
+
+
+// Parallel sum job
+/////////////////////
+
+class debpTSParallelSumJob : public debpParallelCollisionJob{
+private:
+	const int pBegin;
+	const btIParallelSumBody &pBody;
+	btScalar *pSums;
+	
+public:
+	debpTSParallelSumJob( dePhysicsBullet &bullet, int begin, int end, int grainSize,
+		const btIParallelSumBody &body ) :
+	debpParallelCollisionJob( bullet, end - begin, grainSize ),
+	pBegin( begin ),
+	pBody( body ),
+	pSums( NULL )
+	{
+		if( GetChunkCount() > 0 ){
+			pSums = new btScalar[ GetChunkCount() ];
+		}
+	}
+	
+	virtual const char *GetDebugName() const{
+		return "ParallelSum";
+	}
+	
+	btScalar Sum() const{
+		const int count = GetChunkCount();
+		btScalar sum = btScalar( 0 );
+		int i;
+		for( i=0; i<count; i++ ){
+			sum += pSums[ i ];
+		}
+		return sum;
+	}
+	
+protected:
+	virtual ~debpTSParallelSumJob(){
+		if( pSums ){
+			delete [] pSums;
+		}
+	}
+	
+	virtual void ProcessChunk( int chunk, int firstItem, int itemCount, sThreadData& ){
+		pSums[ chunk ] = pBody.sumLoop( pBegin + firstItem, pBegin + firstItem + itemCount );
+	}
+};
+
+
+
+// Class debpTaskScheduler
+////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+debpTaskScheduler::debpTaskScheduler( dePhysicsBullet &bullet ) :
+btITaskScheduler( "Drag[en]gine" ),
+pBullet( bullet ),
+pThreadCount( 1 )
+{
+	pThreadCount = getMaxNumThreads();
+}
+
+debpTaskScheduler::~debpTaskScheduler(){
+}
+
+
+
+// Management
+///////////////
+
+int debpTaskScheduler::getMaxNumThreads() const{
+	return pBullet.GetGameEngine()->GetParallelProcessing().GetCoreCount() + 1;
+}
+
+int debpTaskScheduler::getNumThreads() const{
+	return pThreadCount;
+}
+
+void debpTaskScheduler::setNumThreads( int numThreads ){
+	pThreadCount = decMath::clamp( numThreads, 1, getMaxNumThreads() );
+}
+
+void debpTaskScheduler::parallelFor( int iBegin, int iEnd, int grainSize, const btIParallelForBody &body ){
+	if( iEnd <= iBegin ){
+		return;
+	}
+	
+	debpTSParallelForJob * const job = new debpTSParallelForJob( pBullet, iBegin, iEnd, grainSize, body );
+	job->SetMaxTaskCount( pThreadCount - 1 );
+	
+	try{
+		job->Run( 0 );
+		
+	}catch( const deException & ){
+		job->FreeReference();
+		throw;
+	}
+	
+	job->FreeReference();
+}
+
+btScalar debpTaskScheduler::parallelSum( int iBegin, int iEnd, int grainSize, const btIParallelSumBody &body ){
+	if( iEnd <= iBegin ){
+		return btScalar( 0 );
+	}
+	
+	debpTSParallelSumJob * const job = new debpTSParallelSumJob( pBullet, iBegin, iEnd, grainSize, body );
+	btScalar sum;
+	
+	job->SetMaxTaskCount( pThreadCount - 1 );
+	
+	try{
+		job->Run( 0 );
+		sum = job->Sum();
+		
+	}catch( const deException & ){
+		job->FreeReference();
+		throw;
+	}
+	
+	job->FreeReference();
+	return sum;
+}
@@ -0,0 +1,80 @@
+/* 
+ * Drag[en]gine Bullet Physics Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef _DEBPTASKSCHEDULER_H_
+#define _DEBPTASKSCHEDULER_H_
+
+#include "LinearMath/btThreads.h"
+
+class dePhysicsBullet;
+
+
+
+/**
+ * \brief Bullet task scheduler running parallel loops on the engine parallel processing.
+ * 
+ * Loops are split into chunks of grain size items. Chunks are processed by parallel tasks
+ * and the calling thread. Sums are added up in chunk order to keep results independent
+ * of the number of threads used.
+ * 
+ * Bullet is not build thread-safe. The scheduler is thus not registered with
+ * btSetTaskScheduler() but used by the module classes directly.
+ */
+class debpTaskScheduler : public btITaskScheduler{
+private:
+	dePhysicsBullet &pBullet;
+	int pThreadCount;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create task scheduler. */
+	debpTaskScheduler( dePhysicsBullet &bullet );
+	
+	/** \brief Clean up task scheduler. */
+	virtual ~debpTaskScheduler();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Maximum number of threads. This is the number of cores plus the calling thread. */
+	virtual int getMaxNumThreads() const;
+	
+	/** \brief Number of threads used. */
+	virtual int getNumThreads() const;
+	
+	/** \brief Set number of threads used clamped to the range from 1 to getMaxNumThreads(). */
+	virtual void setNumThreads( int numThreads );
+	
+	/** \brief Run loop in parallel. */
+	virtual void parallelFor( int iBegin, int iEnd, int grainSize, const btIParallelForBody &body );
+	
+	/** \brief Run loop in parallel returning the sum of all chunks. */
+	virtual btScalar parallelSum( int iBegin, int iEnd, int grainSize, const btIParallelSumBody &body );
+	/*@}*/
+};
+
+#endif
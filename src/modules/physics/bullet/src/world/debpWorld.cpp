@@ -28,6 +28,7 @@
 #include "debpGhostPairCallback.h"
 #include "debpOverlapFilterCallback.h"
 #include "debpSharedCollisionFiltering.h"
+#include "debpTaskScheduler.h"
 #include "debpWorld.h"
 #include "../dePhysicsBullet.h"
 #include "../debpConfiguration.h"
@@ -36,6 +37,9 @@
 #include "../debug/debpDebug.h"
 #include "../debug/debpDebugInformation.h"
 #include "../coldet/debpCollisionDetection.h"
+#include "../coldet/debpCollisionQueryBatch.h"
+#include "../coldet/debpCollisionTestJob.h"
+#include "../coldet/debpKinematicSweepJob.h"
 #include "../coldet/unstuck/debpUnstuckCollider.h"
 #include "../coldet/collision/debpDCollisionSphere.h"
 #include "../coldet/collision/debpDCollisionBox.h"
@@ -117,7 +121,6 @@ pOverlapFilterCallback( NULL ),
 pGhostPairCallback( NULL ),
 
 pDirtyOctree( true ),
-pDirtyDynWorldAABB( true ),
 
 pLeftOverTime( 0.0f ),
 
@@ -142,11 +145,13 @@ pUpdateOctreeColliderCount( 0 ),
 pUpdateOctreeColliderSize( 0 ),
 
 // erwin mentioned up to (10, 1/240)
-pSimMaxSubStep( 500 ),
+pSimMaxSubStep( 6 ),
 pSimTimeStep( 1.0f / 60.0f ),
 
 pDynCollisionVelocityThreshold( 0.0f )
 {
+	ResetUpdateStats();
+	
 	// init
 	try{
 		pColInfo = new deCollisionInfo;
@@ -261,7 +266,10 @@ void debpWorld::Update( float elapsed ){
 }
 
 void debpWorld::UpdateOctrees(){
+	pUpdateStats.updateOctreesCalls++;
+	
 	if( ! pDirtyOctree ){
+		pUpdateStats.updateOctreesSkipped++;
 		return;
 	}
 	
@@ -305,6 +313,7 @@ timer.Reset();
 		collider->SetUpdateOctreeIndex( -1 );
 		
 		collider->UpdateOctreePosition();
+		pUpdateStats.updatedColliders++;
 		
 		if( debugInfoCollider ){
 			debugInfoCollider->IncrementElapsedTime( pPerfTimer2.GetElapsedTime() );
@@ -343,16 +352,15 @@ timerUpdateOctreesCount++;
 
 void debpWorld::MarkOctreeDirty(){
 	pDirtyOctree = true;
-	pDirtyDynWorldAABB = true;
 }
 
 void debpWorld::UpdateDynWorldAABBs(){
-	if( pDirtyDynWorldAABB ){
+	if( pDynWorld->GetDirtyAABBCount() > 0 ){
 #ifdef DO_TIMING2
 timer.Reset();
 #endif
+		pUpdateStats.updatedAABBs += pDynWorld->GetDirtyAABBCount();
 		pDynWorld->UpdateDirtyAABBs();
-		pDirtyDynWorldAABB = false;
 #ifdef DO_TIMING2
 timerUpdateDynWorldAABBs += ( int )( timer.GetElapsedTime() * 1e6f );
 timerUpdateDynWorldAABBsCount++;
@@ -360,6 +368,13 @@ timerUpdateDynWorldAABBsCount++;
 	}
 }
 
+void debpWorld::ResetUpdateStats(){
+	pUpdateStats.updateOctreesCalls = 0;
+	pUpdateStats.updateOctreesSkipped = 0;
+	pUpdateStats.updatedColliders = 0;
+	pUpdateStats.updatedAABBs = 0;
+}
+
 
 
 void debpWorld::pColDetPrepareColliderAdd( debpCollider *collider ){
@@ -460,7 +475,7 @@ void debpWorld::pUpdateOctreeColliderAdd( debpCollider *collider ){
 	}
 	
 	if( pUpdateOctreeColliderCount == pUpdateOctreeColliderSize ){
-		const int newSize = pUpdateOctreeColliderSize + 10;
+		const int newSize = pUpdateOctreeColliderSize * 3 / 2 + 10;
 		debpCollider ** const newArray = new debpCollider*[ newSize ];
 		if( pUpdateOctreeColliders ){
 			memcpy( newArray, pUpdateOctreeColliders, sizeof( debpCollider* ) * pUpdateOctreeColliderSize );
@@ -551,88 +566,16 @@ void debpWorld::ProcessPhysics( float elapsed ){
 #endif
 	
 DEBUG_RESET_TIMERS;
-	// prepare for detection
-	pPrepareDetection( elapsed );
-DEBUG_PRINT_TIMER( "Prepare Detection" );
-	
-	// process kinematic physics. this moves collider with kinematic response type
-	// first along their velocity and then along the gravity. colliders are moved
-	// one by one. this is not the best solution yet but it works for the time
-	// being. one of the main problems is that if a collider has been moved already
-	// and then is altered by a collision later on it is not processed again. one
-	// solution would be to use a processed flag or list and re-process colliders
-	// if they get touched during collision detection.
-	if( elapsed > 1e-6f ){
-		pColInfo->Clear();
-		
-		UpdateOctrees(); // deprecated
-		UpdateDynWorldAABBs();
-		
-		debpDebugInformation *debugInfo = NULL;
-		if( pBullet.GetDebug().GetEnabled() ){
-			debugInfo = pBullet.GetDebug().GetDIColliderDetectCustomCollision();
-			pPerfTimer.Reset();
-		}
-		
-		int i;
-		for( i=0; i<pColDetPrepareColliderProcessCount; i++ ){
-			if( ! pColDetPrepareColliders[ i ] ){
-				continue;
-			}
-			pColDetPrepareColliders[ i ]->DetectCustomCollision( elapsed );
-			
-			if( debugInfo ){
-				debugInfo->IncrementElapsedTime( pPerfTimer.GetElapsedTime() );
-				debugInfo->IncrementCounter( 1 );
-			}
-		}
-	}
-DEBUG_PRINT_TIMER( "Detection Loop" );
-	
-	// process dynamic physics. this does a bullet simulation step. due to collisions
-	// with kinematic colliders they can obtain new velocities. these are though
-	// ignored and are considered to be taken into account in the next update.
-	pPrepareForStep();
-DEBUG_PRINT_TIMER( "Prepare For Step" );
+	pUpdateSimulationParameters();
 	
-	// TODO
-	// this runs only one simulation step. if the elapsed time is larger than 1/60
-	// the simulation slows down as well as producing weird results. this has to be
-	// fixed somehow but how is unknown yet (too many recent changes in the code base).
-	#ifdef DO_TIMING
-		pBullet.LogInfoFormat( "World: colObj=%d nonStaRigBod=%d broadNumOPairs=%d",
-			pDynWorld->getNumCollisionObjects(), pDynWorld->GetNumNonStaticRigidBodies(),
-			pDynWorld->getBroadphase()->getOverlappingPairCache()->getNumOverlappingPairs() );
-	#endif
-	if( pBullet.GetDebug().GetEnabled() ){
-		debpDebugInformation &debugInfo = *pBullet.GetDebug().GetDIWorldStepSimulation();
-		decTimer timer;
-		// max steps = max time (0.1s) divided by frquency (1/60) = 6
-		pDynWorld->stepSimulation( elapsed, 6, 1.0f / 60.0f ); // erwin mentioned up to (10, 1/240)
-		debugInfo.IncrementElapsedTime( timer.GetElapsedTime() );
-		debugInfo.IncrementCounter( 1 );
+	if( pBullet.GetConfiguration()->GetFixedTimeStep() ){
+		pSimulateFixedTimeStep( elapsed );
 		
 	}else{
-		pDynWorld->stepSimulation( elapsed, 6, 1.0f / 60.0f ); // erwin mentioned up to (10, 1/240)
-	}
-	#if defined DO_TIMING && ! defined BT_NO_PROFILE
-		//CProfileManager::dumpAll();
-	#endif
-	if( pBullet.GetDebug().GetEnabled() ){
-		CProfileManager::dumpAll();
+		// dynamic simulation is sub stepped by bullet interpolating motion states.
+		// kinematic simulation is done once using the elapsed time
+		pSimulateStep( elapsed, pSimMaxSubStep );
 	}
-	pDynWorld->MarkAllAABBValid();
-	pDirtyDynWorldAABB = false;
-DEBUG_PRINT_TIMER( "Step Simulation" );
-	
-	// update positions
-	pUpdateFromBody();
-DEBUG_PRINT_TIMER( "Update Positions" );
-	
-	// finish detection. this operates on colliders. this is required to be done before
-	// elements relying on colliders potentially changing their geometry information
-	pFinishDetection();
-DEBUG_PRINT_TIMER( "Finish Detection" );
 	
 	// make touch sensors notify their peers about touch changes accumulated during collision
 	// detection. this potentially modifies colliders including adding or removing them
@@ -828,7 +771,7 @@ void debpWorld::PhysicsChanged(){
 		// update the dynamic collision impulse threshold. see debpCollisionWorld::CheckDynamicCollisions
 		// for why this is calculated like this. Gravity times 1 is the minimum amount of impulse applied
 		// by gravity. to avoid incorrect results a value of gravity times 1.2 or even 1.5 is used.
-		pDynCollisionVelocityThreshold = decMath::max( gravity.Length() * 1.2f, 1.0f ) * pSimTimeStep;
+		pUpdateDynCollisionVelocityThreshold();
 	}
 	
 	// update octrees
@@ -1068,6 +1011,27 @@ timerColliderRotateHitsCount++;
 #endif
 }
 
+void debpWorld::CollisionQueryBatch( deCollisionQueryBatch &batch ){
+	if( batch.GetQueryCount() == 0 ){
+		return;
+	}
+	
+	UpdateOctrees();
+	UpdateDynWorldAABBs();
+	
+	debpCollisionQueryBatch * const processor = new debpCollisionQueryBatch( *this, batch );
+	
+	try{
+		processor->Process();
+		
+	}catch( const deException & ){
+		processor->FreeReference();
+		throw;
+	}
+	
+	processor->FreeReference();
+}
+
 
 
 // private functions
@@ -1177,6 +1141,71 @@ void debpWorld::pPrepareDetection( float elapsed ){
 
 
 
+void debpWorld::pDetectCustomCollision( float elapsed ){
+	debpDebugInformation *debugInfo = NULL;
+	if( pBullet.GetDebug().GetEnabled() ){
+		debugInfo = pBullet.GetDebug().GetDIColliderDetectCustomCollision();
+		pPerfTimer.Reset();
+	}
+	
+	int i;
+	for( i=0; i<pColDetPrepareColliderProcessCount; i++ ){
+		if( ! pColDetPrepareColliders[ i ] ){
+			continue;
+		}
+		pColDetPrepareColliders[ i ]->DetectCustomCollision( elapsed );
+		
+		if( debugInfo ){
+			debugInfo->IncrementElapsedTime( pPerfTimer.GetElapsedTime() );
+			debugInfo->IncrementCounter( 1 );
+		}
+	}
+}
+
+void debpWorld::pDetectCustomCollisionParallel( float elapsed ){
+	debpDebugInformation *debugInfo = NULL;
+	if( pBullet.GetDebug().GetEnabled() ){
+		debugInfo = pBullet.GetDebug().GetDIColliderDetectCustomCollision();
+		pPerfTimer.Reset();
+	}
+	
+	// sweep all kinematic colliders in parallel. then process colliders in the same order
+	// as pDetectCustomCollision. colliders without hit are moved directly. all others are
+	// processed as usual since collision responses call scripting listeners
+	debpKinematicSweepJob * const job = new debpKinematicSweepJob( *this,
+		pColDetPrepareColliders, pColDetPrepareColliderProcessCount, elapsed );
+		
+	try{
+		job->Process();
+		
+		int i;
+		for( i=0; i<pColDetPrepareColliderProcessCount; i++ ){
+			debpCollider * const collider = pColDetPrepareColliders[ i ];
+			if( ! collider ){
+				continue;
+			}
+			
+			if( job->CanApplyMove( i, *collider ) ){
+				collider->CastToVolume()->ApplyKinematicMove( elapsed );
+				
+			}else{
+				collider->DetectCustomCollision( elapsed );
+			}
+		}
+		
+	}catch( const deException & ){
+		job->FreeReference();
+		throw;
+	}
+	
+	job->FreeReference();
+	
+	if( debugInfo ){
+		debugInfo->IncrementElapsedTime( pPerfTimer.GetElapsedTime() );
+		debugInfo->IncrementCounter( pColDetPrepareColliderProcessCount );
+	}
+}
+
 void debpWorld::pPrepareForStep(){
 	UpdateOctrees();
 	
@@ -1188,65 +1217,133 @@ void debpWorld::pPrepareForStep(){
 	}
 }
 
-bool debpWorld::pStepPhysics(){
-	float defaultStepSize = 0.01f;
-	float stepSize;
+void debpWorld::pUpdateSimulationParameters(){
+	const debpConfiguration &configuration = *pBullet.GetConfiguration();
+	const float timeStep = 1.0f / ( float )configuration.GetStepRate();
 	
-/*
-#ifdef DO_TIMING
-float elapsedPrepare = 0.0f;
-float elapsedStep = 0.0f;
-float elapsedUpdate = 0.0f;
-decTimer timer;
-#endif
-*/
-	
-	// process physics
-	stepSize = defaultStepSize;
-	while( pLeftOverTime >= stepSize ){
-		// prepare for the next step
-		pPrepareForStep();
-/*
-#ifdef DO_TIMING
-elapsedPrepare += timer.GetElapsedTime();
-#ifdef USE_QUICKPROF
-btProfiler::init( "bullet.profiling", btProfiler::BLOCK_TOTAL_MICROSECONDS );
-#endif
-#endif
-*/
+	pSimMaxSubStep = configuration.GetMaxSubSteps();
+	
+	if( fabsf( timeStep - pSimTimeStep ) > FLOAT_SAFE_EPSILON ){
+		pSimTimeStep = timeStep;
+		pUpdateDynCollisionVelocityThreshold();
+	}
+	
+	btITaskScheduler * const taskScheduler = configuration.GetParallelDynamics()
+		? &pBullet.GetTaskScheduler() : NULL;
+	pColDisp->SetTaskScheduler( taskScheduler );
+	pColDisp->SetDeterministic( configuration.GetDeterministicDynamics() );
+	pDynWorld->SetTaskScheduler( taskScheduler );
+}
+
+void debpWorld::pUpdateDynCollisionVelocityThreshold(){
+	// see debpCollisionWorld::CheckDynamicCollisions for why this is calculated like this.
+	// Gravity times 1 is the minimum amount of impulse applied by gravity. to avoid incorrect
+	// results a value of gravity times 1.2 or even 1.5 is used.
+	pDynCollisionVelocityThreshold = decMath::max( pGravity.Length() * 1.2f, 1.0f ) * pSimTimeStep;
+}
+
+void debpWorld::pSimulateFixedTimeStep( float elapsed ){
+	// run kinematic and dynamic simulation in fixed time steps. time not simulated is
+	// carried over to the next frame. if more than the maximum number of steps would be
+	// required the simulation slows down instead of using more processing time
+	pLeftOverTime += elapsed;
+	
+	int stepCount = ( int )( pLeftOverTime / pSimTimeStep );
+	pLeftOverTime = decMath::max( pLeftOverTime - pSimTimeStep * ( float )stepCount, 0.0f );
+	
+	if( stepCount > pSimMaxSubStep ){
+		stepCount = pSimMaxSubStep;
+	}
+	
+	int i;
+	for( i=0; i<stepCount; i++ ){
+		pSimulateStep( pSimTimeStep, 0 );
+	}
+	
+	// place dynamic colliders between the last two steps. this is required for frames
+	// without steps too otherwise dynamic colliders stutter if the frame rate is higher
+	// than the simulation step rate. bodies keep their simulation state
+	pDynWorld->InterpolateMotionStates( pLeftOverTime, pSimTimeStep );
+	
+	for( i=0; i<pColDetPrepareColliderCount; i++ ){
+		if( pColDetPrepareColliders[ i ] ){
+			pColDetPrepareColliders[ i ]->UpdateFromBody();
+		}
+	}
+DEBUG_PRINT_TIMER( "Interpolate Dynamic Colliders" );
+}
+
+void debpWorld::pSimulateStep( float elapsed, int maxSubSteps ){
+	// prepare for detection
+	pPrepareDetection( elapsed );
+DEBUG_PRINT_TIMER( "Prepare Detection" );
+	
+	// process kinematic physics. this moves collider with kinematic response type
+	// first along their velocity and then along the gravity. colliders are moved
+	// one by one. this is not the best solution yet but it works for the time
+	// being. one of the main problems is that if a collider has been moved already
+	// and then is altered by a collision later on it is not processed again. one
+	// solution would be to use a processed flag or list and re-process colliders
+	// if they get touched during collision detection.
+	if( elapsed > 1e-6f ){
+		pColInfo->Clear();
 		
-		// step simulation
-		pDynWorld->stepSimulation( stepSize, 1 );
-/*
-#ifdef DO_TIMING
-elapsedStep += timer.GetElapsedTime();
-#ifdef USE_QUICKPROF
-btProfiler::endProfilingCycle();
-#endif
-#endif
-*/
+		UpdateOctrees(); // deprecated
+		UpdateDynWorldAABBs();
 		
-		// update positions
-		pUpdateFromBody();
-/*
-#ifdef DO_TIMING
-elapsedUpdate += timer.GetElapsedTime();
-#endif
-*/
+		if( pBullet.GetConfiguration()->GetParallelCollisionDetection() ){
+			pDetectCustomCollisionParallel( elapsed );
+			
+		}else{
+			pDetectCustomCollision( elapsed );
+		}
+	}
+DEBUG_PRINT_TIMER( "Detection Loop" );
+	
+	// process dynamic physics. this does a bullet simulation step. due to collisions
+	// with kinematic colliders they can obtain new velocities. these are though
+	// ignored and are considered to be taken into account in the next update.
+	pPrepareForStep();
+DEBUG_PRINT_TIMER( "Prepare For Step" );
+	
+	// with maxSubSteps larger than 0 bullet sub steps the elapsed time using fixed time
+	// steps and interpolates motion states. with maxSubSteps 0 elapsed is simulated as
+	// one step and motion states are set to the simulation state
+	#ifdef DO_TIMING
+		pBullet.LogInfoFormat( "World: colObj=%d nonStaRigBod=%d broadNumOPairs=%d",
+			pDynWorld->getNumCollisionObjects(), pDynWorld->GetNumNonStaticRigidBodies(),
+			pDynWorld->getBroadphase()->getOverlappingPairCache()->getNumOverlappingPairs() );
+	#endif
+	// bullet only updates the aabbs of active collision objects. static and sleeping
+	// collision objects changed since the last update have to be updated here
+	UpdateDynWorldAABBs();
+	
+	if( pBullet.GetDebug().GetEnabled() ){
+		debpDebugInformation &debugInfo = *pBullet.GetDebug().GetDIWorldStepSimulation();
+		decTimer timer;
+		pDynWorld->stepSimulation( elapsed, maxSubSteps, pSimTimeStep );
+		debugInfo.IncrementElapsedTime( timer.GetElapsedTime() );
+		debugInfo.IncrementCounter( 1 );
 		
-		// update elapsed time
-		pLeftOverTime -= stepSize;
+	}else{
+		pDynWorld->stepSimulation( elapsed, maxSubSteps, pSimTimeStep );
 	}
-/*
-#ifdef DO_TIMING
-pBullet.LogInfoFormat( "World Timer: pStepPhysics: Prepare = %iys", ( int )( elapsedPrepare * 1000000.0 ) );
-pBullet.LogInfoFormat( "World Timer: pStepPhysics: Step = %iys", ( int )( elapsedStep * 1000000.0 ) );
-pBullet.LogInfoFormat( "World Timer: pStepPhysics: Update = %iys", ( int )( elapsedUpdate * 1000000.0 ) );
-#endif
-*/
+	#if defined DO_TIMING && ! defined BT_NO_PROFILE
+		//CProfileManager::dumpAll();
+	#endif
+	if( pBullet.GetDebug().GetEnabled() ){
+		CProfileManager::dumpAll();
+	}
+DEBUG_PRINT_TIMER( "Step Simulation" );
+	
+	// update positions
+	pUpdateFromBody();
+DEBUG_PRINT_TIMER( "Update Positions" );
 	
-	// no collision happened
-	return false;
+	// finish detection. this operates on colliders. this is required to be done before
+	// elements relying on colliders potentially changing their geometry information
+	pFinishDetection();
+DEBUG_PRINT_TIMER( "Finish Detection" );
 }
 
 void debpWorld::pStepForceFields( float elapsed ){
@@ -1621,6 +1718,7 @@ void debpWorld::pFinishDetection(){
 }
 
 void debpWorld::pUpdatePostPhysicsCollisionTests(){
+	const bool parallel = pBullet.GetConfiguration()->GetParallelCollisionDetection();
 	const int count = pPPCTColliderCount;
 	debpDebugInformation *debugInfo = NULL;
 	int i, next;
@@ -1643,6 +1741,10 @@ void debpWorld::pUpdatePostPhysicsCollisionTests(){
 		}
 		next++;
 		
+		if( parallel ){
+			continue;
+		}
+		
 		collider->ProcessColliderCollisionTests();
 		
 		if( debugInfo ){
@@ -1651,6 +1753,27 @@ void debpWorld::pUpdatePostPhysicsCollisionTests(){
 		}
 	}
 	
+	if( parallel && next > 0 ){
+		// the job stores results in the same order as ProcessColliderCollisionTests.
+		// colliders added while processing are processed next frame as usual
+		debpCollisionTestJob * const job = new debpCollisionTestJob( *this, pPPCTColliders, next );
+		
+		try{
+			job->Process();
+			
+		}catch( const deException & ){
+			job->FreeReference();
+			throw;
+		}
+		
+		job->FreeReference();
+		
+		if( debugInfo ){
+			debugInfo->IncrementElapsedTime( pPerfTimer.GetElapsedTime() );
+			debugInfo->IncrementCounter( next );
+		}
+	}
+	
 	for( i=count; i<pPPCTColliderCount; i++ ){
 		debpCollider * const collider = pPPCTColliders[ i ];
 		if( ! collider ){
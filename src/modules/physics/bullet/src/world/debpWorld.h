@@ -37,11 +37,11 @@ class debpPhysicsBody;
 class debpOverlapFilterCallback;
 class debpUnstuckCollider;
 class debpCollider;
+class debpCollisionDispatcher;
 class debpSharedCollisionFiltering;
 
 class btDynamicsWorld;
 class btBroadphaseInterface;
-class btCollisionDispatcher;
 class btMultiBodyConstraintSolver;
 class btCollisionConfiguration;
 struct btSoftBodyWorldInfo;
@@ -52,6 +52,24 @@ class btSoftBodySolver;
  * \brief Physics world peer.
  */
 class debpWorld : public deBasePhysicsWorld{
+public:
+	/** \brief Octree and dynamic world AABB update statistics. */
+	struct sUpdateStats{
+		/** \brief Number of UpdateOctrees calls. */
+		int updateOctreesCalls;
+		
+		/** \brief Number of UpdateOctrees calls skipped since nothing changed. */
+		int updateOctreesSkipped;
+		
+		/** \brief Number of colliders with updated octree position. */
+		int updatedColliders;
+		
+		/** \brief Number of collision objects with updated dynamic world AABB. */
+		int updatedAABBs;
+	};
+	
+	
+	
 private:
 	dePhysicsBullet &pBullet;
 	deWorld &pWorld;
@@ -64,7 +82,7 @@ private:
 	
 	debpCollisionWorld *pDynWorld;
 	btBroadphaseInterface *pBroadPhase;
-	btCollisionDispatcher *pColDisp;
+	debpCollisionDispatcher *pColDisp;
 	btMultiBodyConstraintSolver *pConstraintSolver;
 	btSoftBodySolver *pSoftBodySolver;
 	btCollisionConfiguration *pColConfig;
@@ -73,7 +91,6 @@ private:
 	debpGhostPairCallback *pGhostPairCallback;
 	
 	bool pDirtyOctree;
-	bool pDirtyDynWorldAABB;
 	
 	float pLeftOverTime;
 	
@@ -106,6 +123,8 @@ private:
 	decTimer pPerfTimer;
 	decTimer pPerfTimer2;
 	
+	sUpdateStats pUpdateStats;
+	
 	decLayerMask pLastDebugShowCategory;
 	
 	
@@ -136,10 +155,10 @@ public:
 	
 	
 	
-	/** \brief Maximum sub steps for dynamic simulation. */
+	/** \brief Maximum sub steps per frame. */
 	inline int GetSimulationMaxSubSteps() const{ return pSimMaxSubStep; }
 	
-	/** \brief Fixed time step for dynamic simulation. */
+	/** \brief Fixed time step. */
 	inline float GetSimulationTimeStep() const{ return pSimTimeStep; }
 	
 	
@@ -164,9 +183,20 @@ public:
 	 */
 	void MarkOctreeDirty();
 	
-	/** \brief Update dynamic world aabbs. */
+	/**
+	 * \brief Update dynamic world aabbs.
+	 * 
+	 * Only collision objects marked dirty are updated. Static and sleeping collision
+	 * objects not marked dirty stay in the fixed broadphase set.
+	 */
 	void UpdateDynWorldAABBs();
 	
+	/** \brief Update statistics. */
+	inline const sUpdateStats &GetUpdateStats() const{ return pUpdateStats; }
+	
+	/** \brief Reset update statistics. */
+	void ResetUpdateStats();
+	
 	
 	
 	/** \brief Add collider for prepare collision detection. */
@@ -337,6 +367,13 @@ public:
 	 */
 	virtual void ColliderMoveRotateHits( deCollider *collider, const decVector &displacement,
 	const decVector &rotation, deBaseScriptingCollider *listener );
+	
+	/**
+	 * \brief Test collision query batch.
+	 * \details Queries are processed in parallel if the batch is large enough. Collision
+	 *          filters are checked but no collider listeners are called.
+	 */
+	virtual void CollisionQueryBatch( deCollisionQueryBatch &batch );
 	/*@}*/
 	
 	
@@ -345,9 +382,14 @@ private:
 	void pCleanUp();
 	
 	void pPrepareDetection( float elapsed );
+	void pDetectCustomCollision( float elapsed );
+	void pDetectCustomCollisionParallel( float elapsed );
 	
 	void pPrepareForStep();
-	bool pStepPhysics();
+	void pUpdateSimulationParameters();
+	void pUpdateDynCollisionVelocityThreshold();
+	void pSimulateFixedTimeStep( float elapsed );
+	void pSimulateStep( float elapsed, int maxSubSteps );
 	void pStepForceFields( float elapsed );
 	
 	void pPrepareParticleEmitters( float elapsed );
@@ -1374,6 +1374,59 @@ void deClassCollider::nfColliderListenerSetCustomCanHit::RunFunction( dsRunTime
 	}
 }
 
+// public func bool colliderListenerGetCacheCanHit()
+deClassCollider::nfColliderListenerGetCacheCanHit::nfColliderListenerGetCacheCanHit( const sInitData &init ) : dsFunction( init.clsCol,
+"colliderListenerGetCacheCanHit", DSFT_FUNCTION, DSTM_PUBLIC | DSTM_NATIVE, init.clsBool ){
+}
+void deClassCollider::nfColliderListenerGetCacheCanHit::RunFunction( dsRunTime *rt, dsValue *myself ){
+	const sColNatDat &nd = *( ( sColNatDat* )p_GetNativeData( myself ) );
+	if( ! nd.collider ){
+		DSTHROW( dueNullPointer );
+	}
+	
+	const dedsCollider * const scrCol = ( dedsCollider* )nd.collider->GetPeerScripting();
+	
+	if( scrCol ){
+		rt->PushBool( scrCol->GetCacheCanHit() );
+		
+	}else{
+		rt->PushBool( false );
+	}
+}
+
+// public func void colliderListenerSetCacheCanHit( bool cacheCanHit )
+deClassCollider::nfColliderListenerSetCacheCanHit::nfColliderListenerSetCacheCanHit( const sInitData &init ) : dsFunction( init.clsCol,
+"colliderListenerSetCacheCanHit", DSFT_FUNCTION, DSTM_PUBLIC | DSTM_NATIVE, init.clsVoid ){
+	p_AddParameter( init.clsBool ); // cacheCanHit
+}
+void deClassCollider::nfColliderListenerSetCacheCanHit::RunFunction( dsRunTime *rt, dsValue *myself ){
+	const sColNatDat &nd = *( ( sColNatDat* )p_GetNativeData( myself ) );
+	if( ! nd.collider ){
+		DSTHROW( dueNullPointer );
+	}
+	
+	dedsCollider * const scrCol = ( dedsCollider* )nd.collider->GetPeerScripting();
+	if( scrCol ){
+		scrCol->SetCacheCanHit( rt->GetValue( 0 )->GetBool() );
+	}
+}
+
+// public func void colliderListenerInvalidateCanHitCache()
+deClassCollider::nfColliderListenerInvalidateCanHitCache::nfColliderListenerInvalidateCanHitCache( const sInitData &init ) : dsFunction( init.clsCol,
+"colliderListenerInvalidateCanHitCache", DSFT_FUNCTION, DSTM_PUBLIC | DSTM_NATIVE, init.clsVoid ){
+}
+void deClassCollider::nfColliderListenerInvalidateCanHitCache::RunFunction( dsRunTime *rt, dsValue *myself ){
+	const sColNatDat &nd = *( ( sColNatDat* )p_GetNativeData( myself ) );
+	if( ! nd.collider ){
+		DSTHROW( dueNullPointer );
+	}
+	
+	dedsCollider * const scrCol = ( dedsCollider* )nd.collider->GetPeerScripting();
+	if( scrCol ){
+		scrCol->InvalidateCanHitCache();
+	}
+}
+
 
 
 // public func ColliderBreakingListener getBreakingListener()
@@ -1926,6 +1979,9 @@ void deClassCollider::CreateClassMembers( dsEngine *engine ){
 	AddFunction( new nfSetColliderListener( init ) );
 	AddFunction( new nfColliderListenerGetCustomCanHit( init ) );
 	AddFunction( new nfColliderListenerSetCustomCanHit( init ) );
+	AddFunction( new nfColliderListenerGetCacheCanHit( init ) );
+	AddFunction( new nfColliderListenerSetCacheCanHit( init ) );
+	AddFunction( new nfColliderListenerInvalidateCanHitCache( init ) );
 	
 	AddFunction( new nfGetBreakingListener( init ) );
 	AddFunction( new nfSetBreakingListener( init ) );
@@ -258,6 +258,9 @@ private:
 	DEF_NATFUNC( nfSetColliderListener );
 	DEF_NATFUNC( nfColliderListenerGetCustomCanHit );
 	DEF_NATFUNC( nfColliderListenerSetCustomCanHit );
+	DEF_NATFUNC( nfColliderListenerGetCacheCanHit );
+	DEF_NATFUNC( nfColliderListenerSetCacheCanHit );
+	DEF_NATFUNC( nfColliderListenerInvalidateCanHitCache );
 	
 	DEF_NATFUNC( nfGetBreakingListener );
 	DEF_NATFUNC( nfSetBreakingListener );
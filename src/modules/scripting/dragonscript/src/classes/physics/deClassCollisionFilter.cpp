@@ -115,6 +115,29 @@ void deClassCollisionFilter::nfNewCategoryFilter::RunFunction( dsRunTime *rt, ds
 	nd.layerMask = new decCollisionFilter( category, filter );
 }
 
+// public func new( LayerMask category, LayerMask filter, int team, bool ignoreTeam )
+deClassCollisionFilter::nfNewCategoryFilterTeam::nfNewCategoryFilterTeam( const sInitData &init ) : dsFunction( init.clsCF,
+DSFUNC_CONSTRUCTOR, DSFT_CONSTRUCTOR, DSTM_PUBLIC | DSTM_NATIVE, init.clsVoid ){
+	p_AddParameter( init.clsLyM ); // category
+	p_AddParameter( init.clsLyM ); // filter
+	p_AddParameter( init.clsInt ); // team
+	p_AddParameter( init.clsBool ); // ignoreTeam
+}
+void deClassCollisionFilter::nfNewCategoryFilterTeam::RunFunction( dsRunTime *rt, dsValue *myself ){
+	sCFNatDat &nd = *( ( sCFNatDat* )p_GetNativeData( myself ) );
+	deClassLayerMask &clsLyM = *( ( ( deClassCollisionFilter* )GetOwnerClass() )->GetDS()->GetClassLayerMask() );
+	
+	// clear ( important )
+	nd.layerMask = NULL;
+	
+	// create layer mask
+	const decLayerMask &category = clsLyM.GetLayerMask( rt->GetValue( 0 )->GetRealObject() );
+	const decLayerMask &filter = clsLyM.GetLayerMask( rt->GetValue( 1 )->GetRealObject() );
+	const int team = rt->GetValue( 2 )->GetInt();
+	const bool ignoreTeam = rt->GetValue( 3 )->GetBool();
+	nd.layerMask = new decCollisionFilter( category, filter, team, ignoreTeam );
+}
+
 // public func destructor()
 deClassCollisionFilter::nfDestructor::nfDestructor( const sInitData &init ) : dsFunction( init.clsCF,
 DSFUNC_DESTRUCTOR, DSFT_DESTRUCTOR, DSTM_PUBLIC | DSTM_NATIVE, init.clsVoid ){
@@ -159,6 +182,24 @@ void deClassCollisionFilter::nfGetFilter::RunFunction( dsRunTime *rt, dsValue *m
 	clsLyM.PushLayerMask( rt, collisionFilter.GetFilter() );
 }
 
+// public func int getTeam()
+deClassCollisionFilter::nfGetTeam::nfGetTeam( const sInitData &init ) : dsFunction( init.clsCF,
+"getTeam", DSFT_FUNCTION, DSTM_PUBLIC | DSTM_NATIVE, init.clsInt ){
+}
+void deClassCollisionFilter::nfGetTeam::RunFunction( dsRunTime *rt, dsValue *myself ){
+	const decCollisionFilter &collisionFilter = *( ( ( sCFNatDat* )p_GetNativeData( myself ) )->layerMask );
+	rt->PushInt( collisionFilter.GetTeam() );
+}
+
+// public func bool getIgnoreTeam()
+deClassCollisionFilter::nfGetIgnoreTeam::nfGetIgnoreTeam( const sInitData &init ) : dsFunction( init.clsCF,
+"getIgnoreTeam", DSFT_FUNCTION, DSTM_PUBLIC | DSTM_NATIVE, init.clsBool ){
+}
+void deClassCollisionFilter::nfGetIgnoreTeam::RunFunction( dsRunTime *rt, dsValue *myself ){
+	const decCollisionFilter &collisionFilter = *( ( ( sCFNatDat* )p_GetNativeData( myself ) )->layerMask );
+	rt->PushBool( collisionFilter.GetIgnoreTeam() );
+}
+
 // public func bool collides( CollisionFilter collisionFilter )
 deClassCollisionFilter::nfCollides::nfCollides( const sInitData &init ) : dsFunction( init.clsCF,
 "collides", DSFT_FUNCTION, DSTM_PUBLIC | DSTM_NATIVE, init.clsBool ){
@@ -190,7 +231,7 @@ void deClassCollisionFilter::nfCollidesNot::RunFunction( dsRunTime *rt, dsValue
 // File Handling
 //////////////////
 
-// static public func ShapeList readFromFile( FileReader reader )
+// static public func CollisionFilter readFromFile( FileReader reader )
 deClassCollisionFilter::nfReadFromFile::nfReadFromFile( const sInitData &init ) : dsFunction( init.clsCF,
 "readFromFile", DSFT_FUNCTION, DSTM_PUBLIC | DSTM_NATIVE | DSTM_STATIC, init.clsCF ){
 	p_AddParameter( init.clsFileReader ); // reader
@@ -204,9 +245,20 @@ void deClassCollisionFilter::nfReadFromFile::RunFunction( dsRunTime *rt, dsValue
 		DSTHROW( dueNullPointer );
 	}
 	
+	const int version = reader->ReadByte();
 	decCollisionFilter filter;
-	filter.GetCategory() = decLayerMask::ReadFromFile( *reader );
-	filter.GetFilter() = decLayerMask::ReadFromFile( *reader );
+	
+	switch( version ){
+	case 0:
+		filter.GetCategory() = decLayerMask::ReadFromFile( *reader );
+		filter.GetFilter() = decLayerMask::ReadFromFile( *reader );
+		filter.SetTeam( reader->ReadInt() );
+		filter.SetIgnoreTeam( reader->ReadByte() == 1 );
+		break;
+		
+	default:
+		DSTHROW( dueInvalidParam );
+	}
 	
 	clsCF.PushCollisionFilter( rt, filter );
 }
@@ -226,8 +278,12 @@ void deClassCollisionFilter::nfWriteToFile::RunFunction( dsRunTime *rt, dsValue
 		DSTHROW( dueNullPointer );
 	}
 	
+	writer->WriteByte( 0 ); // version 0
+	
 	collisionFilter.GetCategory().WriteToFile( *writer );
 	collisionFilter.GetFilter().WriteToFile( *writer );
+	writer->WriteInt( collisionFilter.GetTeam() );
+	writer->WriteByte( collisionFilter.GetIgnoreTeam() ? 1 : 0 );
 }
 
 
@@ -276,6 +332,10 @@ void deClassCollisionFilter::nfToString::RunFunction( dsRunTime *rt, dsValue *my
 	text += collisionFilter.GetCategory().ToHexString();
 	text += ",";
 	text += collisionFilter.GetFilter().ToHexString();
+	if( collisionFilter.GetTeam() != 0 ){
+		text.AppendFormat( ",team=%d%s", collisionFilter.GetTeam(),
+			collisionFilter.GetIgnoreTeam() ? " ignored" : "" );
+	}
 	text += "]";
 	
 	rt->PushString( text );
@@ -330,10 +390,13 @@ void deClassCollisionFilter::CreateClassMembers( dsEngine *engine ){
 	AddFunction( new nfNewCopy( init ) );
 	AddFunction( new nfNewMask( init ) );
 	AddFunction( new nfNewCategoryFilter( init ) );
+	AddFunction( new nfNewCategoryFilterTeam( init ) );
 	AddFunction( new nfDestructor( init ) );
 	
 	AddFunction( new nfGetCategory( init ) );
 	AddFunction( new nfGetFilter( init ) );
+	AddFunction( new nfGetTeam( init ) );
+	AddFunction( new nfGetIgnoreTeam( init ) );
 	
 	AddFunction( new nfCollides( init ) );
 	AddFunction( new nfCollidesNot( init ) );
@@ -75,10 +75,13 @@ private:
 	DEF_NATFUNC( nfNewCopy );
 	DEF_NATFUNC( nfNewMask );
 	DEF_NATFUNC( nfNewCategoryFilter );
+	DEF_NATFUNC( nfNewCategoryFilterTeam );
 	DEF_NATFUNC( nfDestructor );
 	
 	DEF_NATFUNC( nfGetCategory );
 	DEF_NATFUNC( nfGetFilter );
+	DEF_NATFUNC( nfGetTeam );
+	DEF_NATFUNC( nfGetIgnoreTeam );
 	
 	DEF_NATFUNC( nfCollides );
 	DEF_NATFUNC( nfCollidesNot );
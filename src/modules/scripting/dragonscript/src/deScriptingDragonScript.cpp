@@ -250,6 +250,7 @@
 
 #include "utils/dedsColliderListenerAdaptor.h"
 #include "utils/dedsColliderListenerClosest.h"
+#include "devmode/dedsDeveloperMode.h"
 
 #include <dragengine/deEngine.h>
 #include <dragengine/app/deCmdLineArgs.h>
@@ -498,9 +499,15 @@ deBaseScriptingModule( loadableModule ){
 	pColInfo = NULL;
 	pColliderListenerClosest = NULL;
 	pColliderListenerAdaptor = NULL;
+	
+	pDeveloperMode = new dedsDeveloperMode( *this );
 }
 deScriptingDragonScript::~deScriptingDragonScript(){
 	ShutDown();
+	
+	if( pDeveloperMode ){
+		delete pDeveloperMode;
+	}
 }
 
 
@@ -965,6 +972,12 @@ void deScriptingDragonScript::UserRequestQuit(){
 	}
 }
 
+void deScriptingDragonScript::SendCommand( const decUnicodeArgumentList &command, decUnicodeString &answer ){
+	if( ! pDeveloperMode->ExecuteCommand( command, answer ) ){
+		deBaseScriptingModule::SendCommand( command, answer );
+	}
+}
+
 
 
 // helper functions
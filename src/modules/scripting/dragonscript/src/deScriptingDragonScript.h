@@ -210,6 +210,7 @@ class deClassWorld;
 class deCollisionInfo;
 class dedsColliderListenerClosest;
 class dedsColliderListenerAdaptor;
+class dedsDeveloperMode;
 
 class dedsResourceLoader;
 class decPath;
@@ -423,6 +424,8 @@ private:
 	dedsColliderListenerClosest *pColliderListenerClosest;
 	dedsColliderListenerAdaptor *pColliderListenerAdaptor;
 	
+	dedsDeveloperMode *pDeveloperMode;
+	
 	decPointerList pDeleteValuesLaterList;
 	
 	// objects
@@ -508,6 +511,9 @@ public:
 	 * Default implementation calls deEngine.Quit().
 	 */
 	virtual void UserRequestQuit();
+	
+	/** \brief Send command. */
+	virtual void SendCommand( const decUnicodeArgumentList &command, decUnicodeString &answer );
 	/*@}*/
 	
 public:
@@ -529,6 +535,9 @@ public:
 	/** \brief Shared collider listener adaptor. */
 	inline dedsColliderListenerAdaptor &GetColliderListenerAdaptor() const{ return *pColliderListenerAdaptor; }
 	
+	/** \brief Developer mode. */
+	inline dedsDeveloperMode &GetDeveloperMode() const{ return *pDeveloperMode; }
+	
 	// classes
 	inline deClassAISystem *GetClassAISystem() const{ return pClsAISys; }
 	inline deClassAnimation *GetClassAnimation() const{ return pClsAnim; }
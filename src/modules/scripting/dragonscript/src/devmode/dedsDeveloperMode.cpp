@@ -0,0 +1,307 @@
+/* 
+ * Drag[en]gine DragonScript Script Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dedsDeveloperMode.h"
+#include "../deScriptingDragonScript.h"
+#include "../peers/dedsCollider.h"
+#include "../utils/dedsCanHitCache.h"
+
+#include <dragengine/deEngine.h>
+#include <dragengine/common/exceptions.h>
+#include <dragengine/common/string/decString.h>
+#include <dragengine/common/string/unicode/decUnicodeString.h>
+#include <dragengine/common/string/unicode/decUnicodeArgumentList.h>
+#include <dragengine/common/utils/decCollisionFilter.h>
+#include <dragengine/common/utils/decLayerMask.h>
+#include <dragengine/resources/collider/deColliderManager.h>
+#include <dragengine/resources/collider/deColliderReference.h>
+#include <dragengine/resources/collider/deColliderVolume.h>
+#include <dragengine/systems/deScriptingSystem.h>
+
+
+
+// counts checks and reports the first failures only to keep the answer readable
+struct sTestResult{
+	int checkCount;
+	int failCount;
+	
+	sTestResult() : checkCount( 0 ), failCount( 0 ){
+	}
+	
+	void Check( bool passed, const char *description, decUnicodeString &answer ){
+		checkCount++;
+		if( passed ){
+			return;
+		}
+		
+		failCount++;
+		if( failCount <= 10 ){
+			answer.AppendFromUTF8( "- failed: " );
+			answer.AppendFromUTF8( description );
+			answer.AppendFromUTF8( "\n" );
+		}
+	}
+	
+	void Check( bool passed, const decString &description, decUnicodeString &answer ){
+		Check( passed, description.GetString(), answer );
+	}
+	
+	void Report( const char *name, decUnicodeString &answer ) const{
+		decString text;
+		text.Format( "%s: %s checks=%d failed=%d\n", name, failCount == 0 ? "passed" : "FAILED",
+			checkCount, failCount );
+		answer.AppendFromUTF8( text );
+	}
+};
+
+// layer mask with none, the first, the second or both test layers set
+static decLayerMask fTestLayerMask( int index ){
+	decLayerMask mask;
+	if( ( index & 1 ) == 1 ){
+		mask.SetBit( 0 );
+	}
+	if( ( index & 2 ) == 2 ){
+		mask.SetBit( 1 );
+	}
+	return mask;
+}
+
+static void fDescribeFilter( decString &text, const decCollisionFilter &filter ){
+	text.AppendFormat( "(category=%s filter=%s team=%d ignoreTeam=%d)",
+		filter.GetCategory().ToHexString().GetString(), filter.GetFilter().ToHexString().GetString(),
+		filter.GetTeam(), filter.GetIgnoreTeam() ? 1 : 0 );
+}
+
+
+
+// Class dedsDeveloperMode
+////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+dedsDeveloperMode::dedsDeveloperMode( deScriptingDragonScript &ds ) :
+pDS( ds ),
+pEnabled( false ){
+}
+
+dedsDeveloperMode::~dedsDeveloperMode(){
+}
+
+
+
+// Management
+///////////////
+
+bool dedsDeveloperMode::ExecuteCommand( const decUnicodeArgumentList &command, decUnicodeString &answer ){
+	if( command.MatchesArgumentAt( 0, "dm_enable" ) ){
+		pCmdEnable( command, answer );
+		return true;
+	}
+	
+	if( ! pEnabled ){
+		return false;
+	}
+	
+	if( command.MatchesArgumentAt( 0, "dm_help" ) ){
+		pCmdHelp( command, answer );
+		return true;
+		
+	}else if( command.MatchesArgumentAt( 0, "dm_test_collision_filter" ) ){
+		pCmdTestCollisionFilter( command, answer );
+		return true;
+		
+	}else if( command.MatchesArgumentAt( 0, "dm_test_can_hit_cache" ) ){
+		pCmdTestCanHitCache( command, answer );
+		return true;
+	}
+	
+	return false;
+}
+
+
+
+// Private Functions
+//////////////////////
+
+void dedsDeveloperMode::pCmdHelp( const decUnicodeArgumentList &command, decUnicodeString &answer ){
+	answer.SetFromUTF8( "dm_help => Displays this help screen.\n" );
+	answer.AppendFromUTF8( "dm_test_collision_filter => Test collision filter layer and team rules for symmetry.\n" );
+	answer.AppendFromUTF8( "dm_test_can_hit_cache => Test can hit cache lookups and invalidation by collider peers.\n" );
+}
+
+void dedsDeveloperMode::pCmdEnable( const decUnicodeArgumentList &command, decUnicodeString &answer ){
+	pEnabled = true;
+	answer.AppendFromUTF8( "Developer Mode is enabled" );
+}
+
+void dedsDeveloperMode::pCmdTestCollisionFilter( const decUnicodeArgumentList &command,
+decUnicodeString &answer ){
+	// all combinations of two layers, teams 0 to 2 and ignore team
+	const int filterCount = 4 * 4 * 3 * 2;
+	decCollisionFilter filters[ filterCount ];
+	int i, j, category, filter, team, ignoreTeam;
+	
+	i = 0;
+	for( category=0; category<4; category++ ){
+		for( filter=0; filter<4; filter++ ){
+			for( team=0; team<3; team++ ){
+				for( ignoreTeam=0; ignoreTeam<2; ignoreTeam++ ){
+					filters[ i++ ] = decCollisionFilter( fTestLayerMask( category ),
+						fTestLayerMask( filter ), team, ignoreTeam == 1 );
+				}
+			}
+		}
+	}
+	
+	sTestResult result;
+	answer.SetFromUTF8( "" );
+	
+	for( i=0; i<filterCount; i++ ){
+		const decCollisionFilter &a = filters[ i ];
+		const decCollisionFilter noTeamA( a.GetCategory(), a.GetFilter() );
+		
+		for( j=0; j<filterCount; j++ ){
+			const decCollisionFilter &b = filters[ j ];
+			
+			const bool layers = a.GetFilter().Matches( b.GetCategory() )
+				&& b.GetFilter().Matches( a.GetCategory() );
+			const bool ignoredByTeam = a.GetTeam() != 0 && a.GetTeam() == b.GetTeam()
+				&& ( a.GetIgnoreTeam() || b.GetIgnoreTeam() );
+			const bool collides = a.Collides( b );
+			
+			decString text;
+			fDescribeFilter( text, a );
+			text.Append( " " );
+			fDescribeFilter( text, b );
+			
+			result.Check( collides == b.Collides( a ), text + ": collides not symmetric", answer );
+			result.Check( a.CollidesNot( b ) == b.CollidesNot( a ), text + ": collidesNot not symmetric", answer );
+			result.Check( a.CollidesNot( b ) == ! collides, text + ": collidesNot differs from not collides", answer );
+			result.Check( collides == ( layers && ! ignoredByTeam ), text + ": team rule violated", answer );
+			result.Check( noTeamA.Collides( b ) == layers, text + ": team 0 differs from layers only", answer );
+		}
+	}
+	
+	result.Report( "collision filter", answer );
+}
+
+void dedsDeveloperMode::pCmdTestCanHitCache( const decUnicodeArgumentList &command,
+decUnicodeString &answer ){
+	answer.SetFromUTF8( "" );
+	
+	// cache on its own. serials are set in ascending order like colliders are created.
+	// clearing on reaching the maximum size is allowed to drop entries but a lookup
+	// has to never return a wrong decision nor find a serial never stored
+	sTestResult result;
+	dedsCanHitCache cache;
+	bool canHit;
+	unsigned int i;
+	
+	result.Check( ! cache.Get( 1, canHit ), "empty cache finds serial", answer );
+	
+	for( i=1; i<=10000; i++ ){
+		cache.Set( i, i % 3 == 0 );
+		result.Check( cache.Get( i, canHit ) && canHit == ( i % 3 == 0 ), "stored serial not found", answer );
+	}
+	
+	int foundCount = 0;
+	for( i=1; i<=10000; i++ ){
+		if( cache.Get( i, canHit ) ){
+			result.Check( canHit == ( i % 3 == 0 ), "serial returns wrong decision", answer );
+			foundCount++;
+		}
+	}
+	result.Check( foundCount == cache.GetCount(), "count differs from found serials", answer );
+	
+	for( i=10001; i<=12000; i++ ){
+		result.Check( ! cache.Get( i, canHit ), "serial never stored found", answer );
+	}
+	
+	cache.Set( 5, true );
+	cache.Set( 5, false );
+	result.Check( cache.Get( 5, canHit ) && ! canHit, "overwritten decision not updated", answer );
+	
+	cache.Clear();
+	result.Check( cache.GetCount() == 0, "clear keeps entries", answer );
+	result.Check( ! cache.Get( 5, canHit ), "cleared cache finds serial", answer );
+	
+	result.Report( "can hit cache", answer );
+	
+	pTestCanHitCachePeers( answer );
+}
+
+void dedsDeveloperMode::pTestCanHitCachePeers( decUnicodeString &answer ){
+	// collider peers are only created if this module is running as the scripting module
+	deEngine &engine = *pDS.GetGameEngine();
+	const deScriptingSystem &scrSys = *engine.GetScriptingSystem();
+	if( ! scrSys.GetIsRunning() || scrSys.GetActiveModule() != &pDS || ! pDS.GetScriptEngine() ){
+		answer.AppendFromUTF8( "collider peers: skipped, module is not running\n" );
+		return;
+	}
+	
+	deColliderManager &colliderManager = *engine.GetColliderManager();
+	sTestResult result;
+	bool canHit;
+	
+	deColliderReference colliderA, colliderB;
+	colliderA.TakeOver( colliderManager.CreateColliderVolume() );
+	colliderB.TakeOver( colliderManager.CreateColliderVolume() );
+	
+	dedsCollider &peerA = *( ( dedsCollider* )colliderA->GetPeerScripting() );
+	const unsigned int serialB = ( ( dedsCollider* )colliderB->GetPeerScripting() )->GetCanHitSerial();
+	
+	result.Check( peerA.GetCanHitSerial() != 0 && serialB != 0, "peer serial is 0", answer );
+	result.Check( peerA.GetCanHitSerial() != serialB, "peer serials not unique", answer );
+	
+	dedsCanHitCache &cache = peerA.GetCanHitCache();
+	
+	cache.Set( serialB, true );
+	peerA.SetCacheCanHit( peerA.GetCacheCanHit() );
+	result.Check( cache.GetCount() == 0, "SetCacheCanHit keeps entries", answer );
+	
+	cache.Set( serialB, true );
+	peerA.InvalidateCanHitCache();
+	result.Check( cache.GetCount() == 0, "InvalidateCanHitCache keeps entries", answer );
+	
+	cache.Set( serialB, true );
+	peerA.SetEnableCanHitCallback( peerA.GetEnableCanHitCallback() );
+	result.Check( cache.GetCount() == 0, "SetEnableCanHitCallback keeps entries", answer );
+	
+	cache.Set( serialB, true );
+	peerA.SetCallback( peerA.GetCallback() );
+	result.Check( cache.GetCount() == 0, "SetCallback keeps entries", answer );
+	
+	// a collider created after deleting another one has to not inherit its cache entry
+	cache.Set( serialB, true );
+	colliderB = NULL;
+	colliderB.TakeOver( colliderManager.CreateColliderVolume() );
+	
+	const unsigned int serialC = ( ( dedsCollider* )colliderB->GetPeerScripting() )->GetCanHitSerial();
+	result.Check( serialC != serialB && serialC != peerA.GetCanHitSerial(), "peer serial reused", answer );
+	result.Check( ! cache.Get( serialC, canHit ), "new peer matches cache entry of deleted peer", answer );
+	
+	result.Report( "collider peers", answer );
+}
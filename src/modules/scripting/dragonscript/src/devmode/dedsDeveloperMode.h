@@ -0,0 +1,79 @@
+/* 
+ * Drag[en]gine DragonScript Script Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DEDSDEVELOPERMODE_H_
+#define _DEDSDEVELOPERMODE_H_
+
+class deScriptingDragonScript;
+class decUnicodeArgumentList;
+class decUnicodeString;
+
+
+
+/**
+ * \brief Developer Mode.
+ * 
+ * Provides access to the developer mode. This is not required for games
+ * nor editing tools and is used only by the module developers for testing
+ * and trouble shooting.
+ */
+class dedsDeveloperMode{
+private:
+	deScriptingDragonScript &pDS;
+	bool pEnabled;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create developer mode. */
+	dedsDeveloperMode( deScriptingDragonScript &ds );
+	
+	/** \brief Clean up developer mode. */
+	~dedsDeveloperMode();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/**
+	 * \brief Executes a command.
+	 * \details If the command is recognized true is returned otherwise false.
+	 */
+	bool ExecuteCommand( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	
+	/** \brief Developer mode is enabled. */
+	inline bool GetEnabled() const{ return pEnabled; }
+	/*@}*/
+	
+	
+	
+private:
+	void pCmdHelp( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	void pCmdEnable( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	void pCmdTestCollisionFilter( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	void pCmdTestCanHitCache( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	void pTestCanHitCachePeers( decUnicodeString &answer );
+};
+
+#endif
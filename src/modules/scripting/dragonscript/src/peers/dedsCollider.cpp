@@ -40,6 +40,10 @@
 // Class dedsCollider
 ///////////////////////
 
+// serial numbers are never reused. cached can hit results of deleted colliders can thus
+// not be matched by colliders created later on at the same memory location
+static unsigned int vNextCanHitSerial = 1;
+
 // Constructor, destructor
 ////////////////////////////
 
@@ -48,6 +52,8 @@ pDS( ds ),
 pCollider( collider ),
 pValOwner( NULL ),
 pEnableCanHitCallback( false ),
+pCacheCanHit( false ),
+pCanHitSerial( vNextCanHitSerial++ ),
 pValCB( NULL ),
 pHasCB( false ),
 pValCBBreaking( NULL ),
@@ -114,6 +120,16 @@ dedsCollider::~dedsCollider(){
 
 void dedsCollider::SetEnableCanHitCallback( bool enable ){
 	pEnableCanHitCallback = enable;
+	pCanHitCache.Clear();
+}
+
+void dedsCollider::SetCacheCanHit( bool cache ){
+	pCacheCanHit = cache;
+	pCanHitCache.Clear();
+}
+
+void dedsCollider::InvalidateCanHitCache(){
+	pCanHitCache.Clear();
 }
 
 
@@ -159,6 +175,8 @@ void dedsCollider::SetCallback( dsRealObject *object ){
 		rt.SetNull( pValCB, pDS.GetClassColliderListener() );
 		pHasCB = false;
 	}
+	
+	pCanHitCache.Clear();
 }
 
 
@@ -243,6 +261,16 @@ bool dedsCollider::CanHitCollider( deCollider *owner, deCollider *collider ){
 		DSTHROW( dueInvalidParam );
 	}
 	
+	// colliders without scripting peer are not cached since they have no serial number
+	const dedsCollider * const otherPeer = pCacheCanHit
+		? ( const dedsCollider* )collider->GetPeerScripting() : NULL;
+	if( otherPeer ){
+		bool canHit;
+		if( pCanHitCache.Get( otherPeer->pCanHitSerial, canHit ) ){
+			return canHit;
+		}
+	}
+		
 		#ifdef DO_TIMING
 		decTimer timer;
 		timer.Reset();
@@ -259,6 +287,10 @@ bool dedsCollider::CanHitCollider( deCollider *owner, deCollider *collider ){
 		rt->RunFunctionFast( pValCB, funcIndex );
 		retVal = rt->GetReturnBool();
 		
+		if( otherPeer ){
+			pCanHitCache.Set( otherPeer->pCanHitSerial, retVal );
+		}
+		
 	}catch( const duException &e ){
 		rt->PrintExceptionTrace();
 		e.PrintError();
@@ -22,6 +22,8 @@
 #ifndef _DEDSCOLLIDER_H_
 #define _DEDSCOLLIDER_H_
 
+#include "../utils/dedsCanHitCache.h"
+
 #include <dragengine/systems/modules/scripting/deBaseScriptingCollider.h>
 
 class deScriptingDragonScript;
@@ -41,6 +43,9 @@ private:
 	dsValue *pValOwner;
 	
 	bool pEnableCanHitCallback;
+	bool pCacheCanHit;
+	const unsigned int pCanHitSerial;
+	dedsCanHitCache pCanHitCache;
 	
 	dsValue *pValCB;
 	bool pHasCB;
@@ -65,6 +70,26 @@ public:
 	/** \brief Can hit collider callback is enabled. */
 	inline bool GetEnableCanHitCallback() const{ return pEnableCanHitCallback; }
 	
+	/** \brief Can hit collider results are cached. */
+	inline bool GetCacheCanHit() const{ return pCacheCanHit; }
+	
+	/**
+	 * \brief Set if can hit collider results are cached.
+	 * 
+	 * If enabled the result of the can hit collider callback is stored for each collider
+	 * and reused until the cache is invalidated. Clears the cache.
+	 */
+	void SetCacheCanHit( bool cache );
+	
+	/** \brief Drop all cached can hit collider results. */
+	void InvalidateCanHitCache();
+	
+	/** \brief Unique serial number used to identify the peer in can hit caches. */
+	inline unsigned int GetCanHitSerial() const{ return pCanHitSerial; }
+	
+	/** \brief Can hit cache for use by developer mode tests. */
+	inline dedsCanHitCache &GetCanHitCache(){ return pCanHitCache; }
+	
 	/** \brief Owner object or \em NULL. */
 	dsRealObject *GetOwner() const;
 	
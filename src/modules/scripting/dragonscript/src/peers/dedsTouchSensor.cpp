@@ -31,6 +31,8 @@
 #include <libdscript/exceptions.h>
 #include <libdscript/libdscript.h>
 
+#include <dragengine/common/collection/decObjectList.h>
+#include <dragengine/resources/collider/deCollider.h>
 #include <dragengine/resources/sensor/deTouchSensor.h>
 
 
@@ -153,3 +155,45 @@ void dedsTouchSensor::ColliderLeft( deCollider *collider ){
 		e.PrintError();
 	}
 }
+
+void dedsTouchSensor::CollidersChanged( const decObjectList &enteredColliders,
+const decObjectList &leftColliders ){
+	if( ! pHasCB ){
+		return;
+	}
+	
+	const deClassTouchSensorListener &clsTSL = *pDS.GetClassTouchSensorListener();
+	const int funcIndexEntered = clsTSL.GetFuncIndexColliderEntered();
+	const int funcIndexLeft = clsTSL.GetFuncIndexColliderLeft();
+	dsRunTime * const rt = pDS.GetScriptEngine()->GetMainRunTime();
+	deClassCollider &clsCol = *pDS.GetClassCollider();
+	const int enteredCount = enteredColliders.GetCount();
+	const int leftCount = leftColliders.GetCount();
+	int i;
+	
+	// the listener can be changed or cleared by the script while processing the changes
+	
+	// colliderEntered( collider )
+	for( i=0; i<enteredCount && pHasCB; i++ ){
+		try{
+			clsCol.PushCollider( rt, ( deCollider* )enteredColliders.GetAt( i ) ); // collider
+			rt->RunFunctionFast( pValCB, funcIndexEntered );
+			
+		}catch( const duException &e ){
+			rt->PrintExceptionTrace();
+			e.PrintError();
+		}
+	}
+	
+	// colliderLeft( collider )
+	for( i=0; i<leftCount && pHasCB; i++ ){
+		try{
+			clsCol.PushCollider( rt, ( deCollider* )leftColliders.GetAt( i ) ); // collider
+			rt->RunFunctionFast( pValCB, funcIndexLeft );
+			
+		}catch( const duException &e ){
+			rt->PrintExceptionTrace();
+			e.PrintError();
+		}
+	}
+}
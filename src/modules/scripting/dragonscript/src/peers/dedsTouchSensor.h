@@ -80,6 +80,14 @@ public:
 	 * \param collider Collider entering the shape.
 	 */
 	virtual void ColliderLeft( deCollider *collider );
+	
+	/**
+	 * \brief Notify scripting module peer colliders entered and left touch sensor.
+	 * \param enteredColliders List of deCollider entering the shape.
+	 * \param leftColliders List of deCollider leaving the shape.
+	 */
+	virtual void CollidersChanged( const decObjectList &enteredColliders,
+		const decObjectList &leftColliders );
 	/*@}*/
 };
 
@@ -0,0 +1,151 @@
+/* 
+ * Drag[en]gine DragonScript Script Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dedsCanHitCache.h"
+
+#include <dragengine/common/exceptions.h>
+
+
+
+// Definitions
+////////////////
+
+// initial and maximum table size. both have to be a power of two
+#define INITIAL_SIZE		16
+#define MAXIMUM_SIZE		4096
+
+
+
+// Class dedsCanHitCache
+//////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+dedsCanHitCache::dedsCanHitCache() :
+pEntries( NULL ),
+pSize( 0 ),
+pCount( 0 ){
+}
+
+dedsCanHitCache::~dedsCanHitCache(){
+	if( pEntries ){
+		delete [] pEntries;
+	}
+}
+
+
+
+// Management
+///////////////
+
+bool dedsCanHitCache::Get( unsigned int serial, bool &canHit ) const{
+	if( pCount == 0 ){
+		return false;
+	}
+	
+	const int index = pFind( serial );
+	if( pEntries[ index ].serial != serial ){
+		return false;
+	}
+	
+	canHit = pEntries[ index ].canHit;
+	return true;
+}
+
+void dedsCanHitCache::Set( unsigned int serial, bool canHit ){
+	if( serial == 0 ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	// keep the load factor below 3/4. once the maximum size is reached start over
+	if( ( pCount + 1 ) * 4 > pSize * 3 ){
+		if( pSize < MAXIMUM_SIZE ){
+			pResize( pSize > 0 ? pSize * 2 : INITIAL_SIZE );
+			
+		}else{
+			Clear();
+		}
+	}
+	
+	const int index = pFind( serial );
+	if( pEntries[ index ].serial == 0 ){
+		pEntries[ index ].serial = serial;
+		pCount++;
+	}
+	pEntries[ index ].canHit = canHit;
+}
+
+void dedsCanHitCache::Clear(){
+	if( pCount == 0 ){
+		return;
+	}
+	
+	memset( pEntries, 0, sizeof( sEntry ) * pSize );
+	pCount = 0;
+}
+
+
+
+// Private Functions
+//////////////////////
+
+int dedsCanHitCache::pFind( unsigned int serial ) const{
+	// linear probing. returns the matching entry or the empty entry to use for the serial
+	const int mask = pSize - 1;
+	int index = ( int )( ( serial * 2654435761u ) & ( unsigned int )mask );
+	
+	while( pEntries[ index ].serial != 0 && pEntries[ index ].serial != serial ){
+		index = ( index + 1 ) & mask;
+	}
+	
+	return index;
+}
+
+void dedsCanHitCache::pResize( int size ){
+	sEntry * const oldEntries = pEntries;
+	const int oldSize = pSize;
+	int i;
+	
+	pEntries = new sEntry[ size ];
+	memset( pEntries, 0, sizeof( sEntry ) * size );
+	pSize = size;
+	pCount = 0;
+	
+	if( ! oldEntries ){
+		return;
+	}
+	
+	for( i=0; i<oldSize; i++ ){
+		if( oldEntries[ i ].serial != 0 ){
+			const int index = pFind( oldEntries[ i ].serial );
+			pEntries[ index ] = oldEntries[ i ];
+			pCount++;
+		}
+	}
+	
+	delete [] oldEntries;
+}
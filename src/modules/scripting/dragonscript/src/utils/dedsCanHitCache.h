@@ -0,0 +1,86 @@
+/* 
+ * Drag[en]gine DragonScript Script Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef _DEDSCANHITCACHE_H_
+#define _DEDSCANHITCACHE_H_
+
+
+
+/**
+ * \brief Cache of can hit collider decisions.
+ * 
+ * Maps collider peer serial numbers to the result of the can hit collider script callback.
+ * Serial numbers are unique for the lifetime of the module. Entries of colliders no longer
+ * existing are thus never matched again. To limit memory consumption the cache is cleared
+ * once it reaches the maximum size.
+ */
+class dedsCanHitCache{
+private:
+	struct sEntry{
+		unsigned int serial;
+		bool canHit;
+	};
+	
+	sEntry *pEntries;
+	int pSize;
+	int pCount;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create can hit cache. */
+	dedsCanHitCache();
+	
+	/** \brief Clean up can hit cache. */
+	~dedsCanHitCache();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/** \brief Number of cached decisions. */
+	inline int GetCount() const{ return pCount; }
+	
+	/**
+	 * \brief Cached decision for collider peer serial.
+	 * \returns true if found and stored in \em canHit or false if not cached.
+	 */
+	bool Get( unsigned int serial, bool &canHit ) const;
+	
+	/** \brief Cache decision for collider peer serial. */
+	void Set( unsigned int serial, bool canHit );
+	
+	/** \brief Remove all cached decisions. */
+	void Clear();
+	/*@}*/
+	
+	
+	
+private:
+	int pFind( unsigned int serial ) const;
+	void pResize( int size );
+};
+
+#endif
@@ -22,17 +22,21 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
 #include "desynCommandExecuter.h"
 #include "desynBasics.h"
 #include "deDESynthesizer.h"
 #include "desynConfiguration.h"
+#include "synthesizer/desynSynthesizerKernels.h"
 
 #include <dragengine/deEngine.h>
 #include <dragengine/common/exceptions.h>
+#include <dragengine/common/math/decMath.h>
 #include <dragengine/common/string/decString.h>
 #include <dragengine/common/string/unicode/decUnicodeString.h>
 #include <dragengine/common/string/unicode/decUnicodeArgumentList.h>
+#include <dragengine/common/utils/decTimer.h>
 
 
 
@@ -62,6 +66,9 @@ void desynCommandExecuter::ExecuteCommand( const decUnicodeArgumentList &command
 		if( command.MatchesArgumentAt( 0, "help" ) ){
 			CmdHelp( command, answer );
 			
+		}else if( command.MatchesArgumentAt( 0, "benchmarkWave" ) ){
+			CmdBenchmarkWave( command, answer );
+			
 		}else{
 			answer.SetFromUTF8( "Unknown command '" );
 			answer += *command.GetArgumentAt( 0 );
@@ -74,4 +81,116 @@ void desynCommandExecuter::ExecuteCommand( const decUnicodeArgumentList &command
 
 void desynCommandExecuter::CmdHelp( const decUnicodeArgumentList &command, decUnicodeString &answer ){
 	answer.SetFromUTF8( "help => Displays this help screen.\n" );
+	answer.AppendFromUTF8( "benchmarkWave [voices] => Benchmark sine wave voices against reference implementation.\n" );
+}
+
+void desynCommandExecuter::CmdBenchmarkWave( const decUnicodeArgumentList &command, decUnicodeString &answer ){
+	const int sampleRate = 44100;
+	const int blockSize = 1024;
+	const float invSampleRate = 1.0f / ( float )sampleRate;
+	int voiceCount = 64;
+	
+	if( command.GetArgumentCount() > 1 ){
+		voiceCount = decMath::max( command.GetArgumentAt( 1 )->ToInt(), 1 );
+	}
+	
+	float *phaseStates = NULL;
+	float *buffer = NULL;
+	int i, j, k;
+	
+	try{
+		phaseStates = new float[ voiceCount ];
+		
+		// frequencies, phases, values, pannings, volumes, output kernel, output reference
+		buffer = new float[ blockSize * 11 ];
+		float * const frequencies = buffer;
+		float * const phases = frequencies + blockSize;
+		float * const values = phases + blockSize;
+		float * const pannings = values + blockSize;
+		float * const volumes = pannings + blockSize;
+		float * const stereo = volumes + blockSize;
+		float * const output = stereo + blockSize * 2;
+		float * const outputReference = output + blockSize * 2;
+		
+		decTimer timer;
+		float timeKernel = 0.0f;
+		float timeReference = 0.0f;
+		float maxError = 0.0f;
+		
+		for( i=0; i<voiceCount; i++ ){
+			phaseStates[ i ] = 0.0f;
+		}
+		
+		for( i=0; i<sampleRate; i+=blockSize ){
+			const int samples = decMath::min( blockSize, sampleRate - i );
+			
+			for( j=0; j<samples * 2; j++ ){
+				output[ j ] = 0.0f;
+				outputReference[ j ] = 0.0f;
+			}
+			
+			// kernels
+			timer.Reset();
+			for( j=0; j<voiceCount; j++ ){
+				const float frequency = 110.0f + 7.0f * ( float )j;
+				const float panning = ( float )( j % 9 - 4 ) * 0.25f;
+				float phase = phaseStates[ j ];
+				
+				for( k=0; k<samples; k++ ){
+					frequencies[ k ] = frequency;
+					pannings[ k ] = panning;
+					volumes[ k ] = 0.5f;
+				}
+				
+				desynSynthesizerKernels::Phases( phases, frequencies, samples, invSampleRate, phase );
+				desynSynthesizerKernels::Sine( values, phases, samples );
+				desynSynthesizerKernels::Pan( stereo, values, pannings, samples );
+				desynSynthesizerKernels::MixStereoAdd( output, stereo, volumes, samples );
+			}
+			timeKernel += timer.GetElapsedTime();
+			
+			// reference
+			timer.Reset();
+			for( j=0; j<voiceCount; j++ ){
+				const float frequency = 110.0f + 7.0f * ( float )j;
+				const float panning = ( float )( j % 9 - 4 ) * 0.25f;
+				
+				for( k=0; k<samples; k++ ){
+					frequencies[ k ] = frequency;
+					pannings[ k ] = panning;
+					volumes[ k ] = 0.5f;
+				}
+				
+				desynSynthesizerKernels::Phases( phases, frequencies, samples, invSampleRate, phaseStates[ j ] );
+				desynSynthesizerKernels::SineScalar( values, phases, samples );
+				desynSynthesizerKernels::PanScalar( stereo, values, pannings, samples );
+				desynSynthesizerKernels::MixStereoAddScalar( outputReference, stereo, volumes, samples );
+			}
+			timeReference += timer.GetElapsedTime();
+			
+			for( j=0; j<samples * 2; j++ ){
+				maxError = decMath::max( maxError, fabsf( output[ j ] - outputReference[ j ] ) );
+			}
+		}
+		
+		decString text;
+		text.Format( "Rendered 1s of %d stereo voices: kernels %.1fms (%d voices real time), "
+			"reference %.1fms (%d voices real time), max error %g\n", voiceCount,
+			timeKernel * 1000.0f, ( int )( ( float )voiceCount / decMath::max( timeKernel, 1e-6f ) ),
+			timeReference * 1000.0f, ( int )( ( float )voiceCount / decMath::max( timeReference, 1e-6f ) ),
+			maxError );
+		answer.SetFromUTF8( text );
+		
+		delete [] buffer;
+		delete [] phaseStates;
+		
+	}catch( const deException & ){
+		if( buffer ){
+			delete [] buffer;
+		}
+		if( phaseStates ){
+			delete [] phaseStates;
+		}
+		throw;
+	}
 }
@@ -61,6 +61,15 @@ public:
 	
 	/** \brief Display help message. */
 	void CmdHelp( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	
+	/**
+	 * \brief Benchmark wave generation.
+	 * 
+	 * Renders one second of panned sine wave voices using the block kernels and the scalar
+	 * reference implementation. Reports the maximum difference and how many voices can be
+	 * rendered in real time on one core.
+	 */
+	void CmdBenchmarkWave( const decUnicodeArgumentList &command, decUnicodeString &answer );
 	/*@}*/
 };
 
@@ -0,0 +1,401 @@
+/* 
+ * Drag[en]gine Synthesizer Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "desynSynthesizerKernels.h"
+
+#include <dragengine/common/math/decMath.h>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define DESYN_KERNELS_SSE 1
+#include <emmintrin.h>
+#endif
+
+
+
+// Definitions
+////////////////
+
+#define PI2 ( PI * 2.0f )
+
+// taylor series coefficients of sin(x) up to x^9. with x folded into the range -pi/2 to pi/2
+// the error is below 4e-6 which is below the resolution of 16-bit samples
+#define SINE_C3 ( -1.0f / 6.0f )
+#define SINE_C5 ( 1.0f / 120.0f )
+#define SINE_C7 ( -1.0f / 5040.0f )
+#define SINE_C9 ( 1.0f / 362880.0f )
+
+// sin(2 pi phase) = -sin(2 pi (phase - 0.5)). x = phase - 0.5 is folded into the range
+// -0.25 to 0.25 using sin(pi - a) = sin(a)
+static inline float fSine( float phase ){
+	float x = phase - 0.5f;
+	x = decMath::min( x, 0.5f - x );
+	x = decMath::max( x, -0.5f - x );
+	
+	const float a = x * PI2;
+	const float a2 = a * a;
+	return -a * ( 1.0f + a2 * ( SINE_C3 + a2 * ( SINE_C5 + a2 * ( SINE_C7 + a2 * SINE_C9 ) ) ) );
+}
+
+static inline float fTriangle( float phase ){
+	const float fract = phase * 4.0f;
+	
+	if( fract < 1.0f ){
+		return fract;
+		
+	}else if( fract > 3.0f ){
+		return fract - 4.0f;
+		
+	}else{
+		return 2.0f - fract;
+	}
+}
+
+#ifdef DESYN_KERNELS_SSE
+// mask ? a : b
+static inline __m128 fSelect( __m128 mask, __m128 a, __m128 b ){
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+#endif
+
+
+
+// Class desynSynthesizerKernels
+//////////////////////////////////
+
+// Oscillators
+////////////////
+
+void desynSynthesizerKernels::Phases( float *phases, const float *frequencies, int count,
+float invSampleRate, float &phase ){
+	// phases depend on the previous phase. this loop is cheap compared to the waves
+	float curPhase = phase;
+	int i;
+	
+	for( i=0; i<count; i++ ){
+		const float frequency = frequencies[ i ];
+		phases[ i ] = curPhase;
+		
+		curPhase += frequency * invSampleRate;
+		if( curPhase >= 1.0f || curPhase < 0.0f ){
+			curPhase -= floorf( curPhase );
+		}
+	}
+	
+	phase = curPhase;
+}
+
+void desynSynthesizerKernels::Sine( float *values, const float *phases, int count ){
+	int i = 0;
+	
+#ifdef DESYN_KERNELS_SSE
+	const __m128 half = _mm_set1_ps( 0.5f );
+	const __m128 negHalf = _mm_set1_ps( -0.5f );
+	const __m128 pi2 = _mm_set1_ps( PI2 );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 c3 = _mm_set1_ps( SINE_C3 );
+	const __m128 c5 = _mm_set1_ps( SINE_C5 );
+	const __m128 c7 = _mm_set1_ps( SINE_C7 );
+	const __m128 c9 = _mm_set1_ps( SINE_C9 );
+	const __m128 signMask = _mm_set1_ps( -0.0f );
+	
+	for( ; i<count-3; i+=4 ){
+		__m128 x = _mm_sub_ps( _mm_loadu_ps( phases + i ), half );
+		x = _mm_min_ps( x, _mm_sub_ps( half, x ) );
+		x = _mm_max_ps( x, _mm_sub_ps( negHalf, x ) );
+		
+		const __m128 a = _mm_mul_ps( x, pi2 );
+		const __m128 a2 = _mm_mul_ps( a, a );
+		__m128 poly = _mm_add_ps( c7, _mm_mul_ps( a2, c9 ) );
+		poly = _mm_add_ps( c5, _mm_mul_ps( a2, poly ) );
+		poly = _mm_add_ps( c3, _mm_mul_ps( a2, poly ) );
+		poly = _mm_add_ps( one, _mm_mul_ps( a2, poly ) );
+		
+		_mm_storeu_ps( values + i, _mm_xor_ps( _mm_mul_ps( a, poly ), signMask ) );
+	}
+#endif
+	
+	for( ; i<count; i++ ){
+		values[ i ] = fSine( phases[ i ] );
+	}
+}
+
+void desynSynthesizerKernels::Square( float *values, const float *phases, int count ){
+	int i = 0;
+	
+#ifdef DESYN_KERNELS_SSE
+	const __m128 half = _mm_set1_ps( 0.5f );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 negOne = _mm_set1_ps( -1.0f );
+	
+	for( ; i<count-3; i+=4 ){
+		const __m128 mask = _mm_cmplt_ps( _mm_loadu_ps( phases + i ), half );
+		_mm_storeu_ps( values + i, fSelect( mask, one, negOne ) );
+	}
+#endif
+	
+	for( ; i<count; i++ ){
+		values[ i ] = phases[ i ] < 0.5f ? 1.0f : -1.0f;
+	}
+}
+
+void desynSynthesizerKernels::SawTooth( float *values, const float *phases, int count ){
+	int i = 0;
+	
+#ifdef DESYN_KERNELS_SSE
+	const __m128 one = _mm_set1_ps( 1.0f );
+	
+	for( ; i<count-3; i+=4 ){
+		_mm_storeu_ps( values + i, _mm_sub_ps( _mm_loadu_ps( phases + i ), one ) );
+	}
+#endif
+	
+	for( ; i<count; i++ ){
+		values[ i ] = phases[ i ] - 1.0f;
+	}
+}
+
+void desynSynthesizerKernels::Triangle( float *values, const float *phases, int count ){
+	int i = 0;
+	
+#ifdef DESYN_KERNELS_SSE
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 two = _mm_set1_ps( 2.0f );
+	const __m128 three = _mm_set1_ps( 3.0f );
+	const __m128 four = _mm_set1_ps( 4.0f );
+	
+	for( ; i<count-3; i+=4 ){
+		const __m128 fract = _mm_mul_ps( _mm_loadu_ps( phases + i ), four );
+		const __m128 middle = fSelect( _mm_cmpgt_ps( fract, three ),
+			_mm_sub_ps( fract, four ), _mm_sub_ps( two, fract ) );
+		_mm_storeu_ps( values + i, fSelect( _mm_cmplt_ps( fract, one ), fract, middle ) );
+	}
+#endif
+	
+	for( ; i<count; i++ ){
+		values[ i ] = fTriangle( phases[ i ] );
+	}
+}
+
+void desynSynthesizerKernels::Pan( float *stereo, const float *values, const float *pannings, int count ){
+	int i = 0;
+	
+#ifdef DESYN_KERNELS_SSE
+	const __m128 one = _mm_set1_ps( 1.0f );
+	
+	for( ; i<count-3; i+=4 ){
+		const __m128 value = _mm_loadu_ps( values + i );
+		const __m128 panning = _mm_loadu_ps( pannings + i );
+		const __m128 left = _mm_mul_ps( _mm_min_ps( _mm_sub_ps( one, panning ), one ), value );
+		const __m128 right = _mm_mul_ps( _mm_min_ps( _mm_add_ps( one, panning ), one ), value );
+		
+		_mm_storeu_ps( stereo + i * 2, _mm_unpacklo_ps( left, right ) );
+		_mm_storeu_ps( stereo + i * 2 + 4, _mm_unpackhi_ps( left, right ) );
+	}
+#endif
+	
+	for( ; i<count; i++ ){
+		stereo[ i * 2 ] = decMath::min( 1.0f - pannings[ i ], 1.0f ) * values[ i ];
+		stereo[ i * 2 + 1 ] = decMath::min( 1.0f + pannings[ i ], 1.0f ) * values[ i ];
+	}
+}
+
+
+
+// Mixing
+///////////
+
+void desynSynthesizerKernels::MixMonoAdd( float *output, const float *generated,
+const float *volumes, int count ){
+	int i = 0;
+	
+#ifdef DESYN_KERNELS_SSE
+	for( ; i<count-3; i+=4 ){
+		_mm_storeu_ps( output + i, _mm_add_ps( _mm_loadu_ps( output + i ),
+			_mm_mul_ps( _mm_loadu_ps( generated + i ), _mm_loadu_ps( volumes + i ) ) ) );
+	}
+#endif
+	
+	for( ; i<count; i++ ){
+		output[ i ] += generated[ i ] * volumes[ i ];
+	}
+}
+
+void desynSynthesizerKernels::MixMonoBlend( float *output, const float *generated,
+const float *volumes, const float *blendFactors, int count ){
+	int i = 0;
+	
+#ifdef DESYN_KERNELS_SSE
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.0f );
+	
+	for( ; i<count-3; i+=4 ){
+		// clamp like decMath::mix does
+		const __m128 blendFactor = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( blendFactors + i ), zero ), one );
+		const __m128 value = _mm_mul_ps( _mm_loadu_ps( generated + i ), _mm_loadu_ps( volumes + i ) );
+		_mm_storeu_ps( output + i, _mm_add_ps(
+			_mm_mul_ps( _mm_loadu_ps( output + i ), _mm_sub_ps( one, blendFactor ) ),
+			_mm_mul_ps( value, blendFactor ) ) );
+	}
+#endif
+	
+	for( ; i<count; i++ ){
+		output[ i ] = decMath::mix( output[ i ], generated[ i ] * volumes[ i ], blendFactors[ i ] );
+	}
+}
+
+void desynSynthesizerKernels::MixStereoAdd( float *output, const float *generated,
+const float *volumes, int count ){
+	int i = 0;
+	
+#ifdef DESYN_KERNELS_SSE
+	for( ; i<count-3; i+=4 ){
+		const __m128 volume = _mm_loadu_ps( volumes + i );
+		float * const out = output + i * 2;
+		const float * const gen = generated + i * 2;
+		
+		_mm_storeu_ps( out, _mm_add_ps( _mm_loadu_ps( out ),
+			_mm_mul_ps( _mm_loadu_ps( gen ), _mm_unpacklo_ps( volume, volume ) ) ) );
+		_mm_storeu_ps( out + 4, _mm_add_ps( _mm_loadu_ps( out + 4 ),
+			_mm_mul_ps( _mm_loadu_ps( gen + 4 ), _mm_unpackhi_ps( volume, volume ) ) ) );
+	}
+#endif
+	
+	for( ; i<count; i++ ){
+		output[ i * 2 ] += generated[ i * 2 ] * volumes[ i ];
+		output[ i * 2 + 1 ] += generated[ i * 2 + 1 ] * volumes[ i ];
+	}
+}
+
+void desynSynthesizerKernels::MixStereoBlend( float *output, const float *generated,
+const float *volumes, const float *blendFactors, int count ){
+	int i = 0;
+	
+#ifdef DESYN_KERNELS_SSE
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.0f );
+	
+	for( ; i<count-3; i+=4 ){
+		const __m128 volume = _mm_loadu_ps( volumes + i );
+		const __m128 blendFactor = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( blendFactors + i ), zero ), one );
+		float * const out = output + i * 2;
+		const float * const gen = generated + i * 2;
+		
+		const __m128 blend1 = _mm_unpacklo_ps( blendFactor, blendFactor );
+		const __m128 value1 = _mm_mul_ps( _mm_loadu_ps( gen ), _mm_unpacklo_ps( volume, volume ) );
+		_mm_storeu_ps( out, _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( out ),
+			_mm_sub_ps( one, blend1 ) ), _mm_mul_ps( value1, blend1 ) ) );
+			
+		const __m128 blend2 = _mm_unpackhi_ps( blendFactor, blendFactor );
+		const __m128 value2 = _mm_mul_ps( _mm_loadu_ps( gen + 4 ), _mm_unpackhi_ps( volume, volume ) );
+		_mm_storeu_ps( out + 4, _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( out + 4 ),
+			_mm_sub_ps( one, blend2 ) ), _mm_mul_ps( value2, blend2 ) ) );
+	}
+#endif
+	
+	for( ; i<count; i++ ){
+		output[ i * 2 ] = decMath::mix( output[ i * 2 ],
+			generated[ i * 2 ] * volumes[ i ], blendFactors[ i ] );
+		output[ i * 2 + 1 ] = decMath::mix( output[ i * 2 + 1 ],
+			generated[ i * 2 + 1 ] * volumes[ i ], blendFactors[ i ] );
+	}
+}
+
+
+
+// Reference implementation
+/////////////////////////////
+
+void desynSynthesizerKernels::SineScalar( float *values, const float *phases, int count ){
+	int i;
+	for( i=0; i<count; i++ ){
+		values[ i ] = sinf( phases[ i ] * PI2 );
+	}
+}
+
+void desynSynthesizerKernels::SquareScalar( float *values, const float *phases, int count ){
+	int i;
+	for( i=0; i<count; i++ ){
+		values[ i ] = phases[ i ] < 0.5f ? 1.0f : -1.0f;
+	}
+}
+
+void desynSynthesizerKernels::SawToothScalar( float *values, const float *phases, int count ){
+	int i;
+	for( i=0; i<count; i++ ){
+		values[ i ] = phases[ i ] - 1.0f;
+	}
+}
+
+void desynSynthesizerKernels::TriangleScalar( float *values, const float *phases, int count ){
+	int i;
+	for( i=0; i<count; i++ ){
+		values[ i ] = fTriangle( phases[ i ] );
+	}
+}
+
+void desynSynthesizerKernels::PanScalar( float *stereo, const float *values,
+const float *pannings, int count ){
+	int i;
+	for( i=0; i<count; i++ ){
+		stereo[ i * 2 ] = decMath::min( 1.0f - pannings[ i ], 1.0f ) * values[ i ];
+		stereo[ i * 2 + 1 ] = decMath::min( 1.0f + pannings[ i ], 1.0f ) * values[ i ];
+	}
+}
+
+void desynSynthesizerKernels::MixMonoAddScalar( float *output, const float *generated,
+const float *volumes, int count ){
+	int i;
+	for( i=0; i<count; i++ ){
+		output[ i ] += generated[ i ] * volumes[ i ];
+	}
+}
+
+void desynSynthesizerKernels::MixMonoBlendScalar( float *output, const float *generated,
+const float *volumes, const float *blendFactors, int count ){
+	int i;
+	for( i=0; i<count; i++ ){
+		output[ i ] = decMath::mix( output[ i ], generated[ i ] * volumes[ i ], blendFactors[ i ] );
+	}
+}
+
+void desynSynthesizerKernels::MixStereoAddScalar( float *output, const float *generated,
+const float *volumes, int count ){
+	int i;
+	for( i=0; i<count; i++ ){
+		output[ i * 2 ] += generated[ i * 2 ] * volumes[ i ];
+		output[ i * 2 + 1 ] += generated[ i * 2 + 1 ] * volumes[ i ];
+	}
+}
+
+void desynSynthesizerKernels::MixStereoBlendScalar( float *output, const float *generated,
+const float *volumes, const float *blendFactors, int count ){
+	int i;
+	for( i=0; i<count; i++ ){
+		output[ i * 2 ] = decMath::mix( output[ i * 2 ],
+			generated[ i * 2 ] * volumes[ i ], blendFactors[ i ] );
+		output[ i * 2 + 1 ] = decMath::mix( output[ i * 2 + 1 ],
+			generated[ i * 2 + 1 ] * volumes[ i ], blendFactors[ i ] );
+	}
+}
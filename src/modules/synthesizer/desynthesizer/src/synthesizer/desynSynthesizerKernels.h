@@ -0,0 +1,121 @@
+/* 
+ * Drag[en]gine Synthesizer Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DESYNSYNTHESIZERKERNELS_H_
+#define _DESYNSYNTHESIZERKERNELS_H_
+
+
+
+/**
+ * \brief Synthesizer sample processing kernels.
+ * 
+ * Generates oscillator waves and mixes generated sound into output buffers working on
+ * blocks of samples. If SSE2 is available four samples are processed at the same time.
+ * Sine waves use a polynomial approximation with an error below 1e-5 instead of sinf.
+ * Stereo buffers are interleaved left and right values. Per sample parameters like volume
+ * or panning are stored one value per sample frame. The scalar versions are the reference
+ * implementation used for testing. Wave kernels can work in-place.
+ */
+class desynSynthesizerKernels{
+public:
+	/** \name Oscillators */
+	/*@{*/
+	/**
+	 * \brief Calculate oscillator phases.
+	 * 
+	 * Stores phase in the range from 0 to 1 for each sample and advances \em phase by
+	 * frequency times inverse sample rate. \em phases and \em frequencies can be the
+	 * same buffer.
+	 */
+	static void Phases( float *phases, const float *frequencies, int count,
+		float invSampleRate, float &phase );
+	
+	/** \brief Sine wave values for phases. */
+	static void Sine( float *values, const float *phases, int count );
+	
+	/** \brief Square wave values for phases. */
+	static void Square( float *values, const float *phases, int count );
+	
+	/** \brief Saw tooth wave values for phases. */
+	static void SawTooth( float *values, const float *phases, int count );
+	
+	/** \brief Triangle wave values for phases. */
+	static void Triangle( float *values, const float *phases, int count );
+	
+	/** \brief Pan mono values into stereo buffer. */
+	static void Pan( float *stereo, const float *values, const float *pannings, int count );
+	/*@}*/
+	
+	
+	
+	/** \name Mixing */
+	/*@{*/
+	/** \brief Add generated mono samples scaled by volume. */
+	static void MixMonoAdd( float *output, const float *generated, const float *volumes, int count );
+	
+	/** \brief Blend generated mono samples scaled by volume. */
+	static void MixMonoBlend( float *output, const float *generated, const float *volumes,
+		const float *blendFactors, int count );
+	
+	/** \brief Add generated stereo samples scaled by volume. */
+	static void MixStereoAdd( float *output, const float *generated, const float *volumes, int count );
+	
+	/** \brief Blend generated stereo samples scaled by volume. */
+	static void MixStereoBlend( float *output, const float *generated, const float *volumes,
+		const float *blendFactors, int count );
+	/*@}*/
+	
+	
+	
+	/** \name Reference implementation */
+	/*@{*/
+	/** \brief Sine wave values for phases using sinf. */
+	static void SineScalar( float *values, const float *phases, int count );
+	
+	/** \brief Square wave values for phases. */
+	static void SquareScalar( float *values, const float *phases, int count );
+	
+	/** \brief Saw tooth wave values for phases. */
+	static void SawToothScalar( float *values, const float *phases, int count );
+	
+	/** \brief Triangle wave values for phases. */
+	static void TriangleScalar( float *values, const float *phases, int count );
+	
+	/** \brief Pan mono values into stereo buffer. */
+	static void PanScalar( float *stereo, const float *values, const float *pannings, int count );
+	
+	/** \brief Add generated mono samples scaled by volume. */
+	static void MixMonoAddScalar( float *output, const float *generated, const float *volumes, int count );
+	
+	/** \brief Blend generated mono samples scaled by volume. */
+	static void MixMonoBlendScalar( float *output, const float *generated, const float *volumes,
+		const float *blendFactors, int count );
+	
+	/** \brief Add generated stereo samples scaled by volume. */
+	static void MixStereoAddScalar( float *output, const float *generated, const float *volumes, int count );
+	
+	/** \brief Blend generated stereo samples scaled by volume. */
+	static void MixStereoBlendScalar( float *output, const float *generated, const float *volumes,
+		const float *blendFactors, int count );
+	/*@}*/
+};
+
+#endif
@@ -33,6 +33,14 @@
 
 
 
+// Definitions
+////////////////
+
+// number of samples between evaluating links. at 44.1kHz this is a control rate of 2.7kHz
+#define CONTROL_BLOCK_SIZE 16
+
+
+
 // Class desynSynthesizerTarget
 /////////////////////////////////
 
@@ -103,3 +111,45 @@ float desynSynthesizerTarget::GetValue( const desynSynthesizerInstance &instance
 	
 	return decMath::clamp( value, 0.0f, 1.0f );
 }
+
+void desynSynthesizerTarget::GetValues( const desynSynthesizerInstance &instance, float *values,
+int samples, float curveOffset, float curveFactor, float defaultValue ) const{
+	if( samples < 1 ){
+		return;
+	}
+	
+	int i;
+	
+	if( pLinkCount == 0 ){
+		for( i=0; i<samples; i++ ){
+			values[ i ] = defaultValue;
+		}
+		return;
+	}
+	
+	const int last = samples - 1;
+	float value = GetValue( instance, ( int )curveOffset, defaultValue );
+	int start = 0;
+	
+	while( start < last ){
+		const int end = decMath::min( start + CONTROL_BLOCK_SIZE, last );
+		const float nextValue = GetValue( instance, ( int )( curveOffset + curveFactor * ( float )end ), defaultValue );
+		
+		if( nextValue == value ){
+			for( i=start; i<end; i++ ){
+				values[ i ] = value;
+			}
+			
+		}else{
+			const float step = ( nextValue - value ) / ( float )( end - start );
+			for( i=start; i<end; i++ ){
+				values[ i ] = value + step * ( float )( i - start );
+			}
+		}
+		
+		value = nextValue;
+		start = end;
+	}
+	
+	values[ last ] = value;
+}
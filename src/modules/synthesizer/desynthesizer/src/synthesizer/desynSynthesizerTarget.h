@@ -66,6 +66,16 @@ public:
 	
 	/** \brief Value of target. */
 	float GetValue( const desynSynthesizerInstance &instance, int sample, float defaultValue ) const;
+	
+	/**
+	 * \brief Values of target for a block of samples.
+	 * 
+	 * Evaluates the target at the start of each control block of samples and linearly
+	 * interpolates the values in between. Curve evaluation position of sample i is
+	 * curveOffset + curveFactor * i. Cheaper than calling GetValue for each sample.
+	 */
+	void GetValues( const desynSynthesizerInstance &instance, float *values, int samples,
+		float curveOffset, float curveFactor, float defaultValue ) const;
 	/*@}*/
 };
 
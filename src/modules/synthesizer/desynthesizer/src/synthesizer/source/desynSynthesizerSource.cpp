@@ -25,6 +25,7 @@
 #include "desynSynthesizerSource.h"
 #include "../desynSynthesizer.h"
 #include "../desynSynthesizerInstance.h"
+#include "../desynSynthesizerKernels.h"
 #include "../desynCreateSynthesizerEffect.h"
 #include "../effect/desynSynthesizerEffect.h"
 #include "../../deDESynthesizer.h"
@@ -110,6 +111,31 @@ float desynSynthesizerSource::GetPanning( const desynSynthesizerInstance &instan
 	return pMinPanning + pPanningRange * pTargetPanning.GetValue( instance, sample, 0.0f );
 }
 
+void desynSynthesizerSource::GetBlendFactors( const desynSynthesizerInstance &instance,
+float *values, int samples, float curveOffset, float curveFactor ) const{
+	pTargetBlendFactor.GetValues( instance, values, samples, curveOffset, curveFactor, 1.0f );
+}
+
+void desynSynthesizerSource::GetVolumes( const desynSynthesizerInstance &instance,
+float *values, int samples, float curveOffset, float curveFactor ) const{
+	pTargetVolume.GetValues( instance, values, samples, curveOffset, curveFactor, 0.0f );
+	
+	int i;
+	for( i=0; i<samples; i++ ){
+		values[ i ] = pMinVolume + pVolumeRange * values[ i ];
+	}
+}
+
+void desynSynthesizerSource::GetPannings( const desynSynthesizerInstance &instance,
+float *values, int samples, float curveOffset, float curveFactor ) const{
+	pTargetPanning.GetValues( instance, values, samples, curveOffset, curveFactor, 0.0f );
+	
+	int i;
+	for( i=0; i<samples; i++ ){
+		values[ i ] = pMinPanning + pPanningRange * values[ i ];
+	}
+}
+
 
 
 int desynSynthesizerSource::StateDataSize( int offset ){
@@ -276,76 +302,89 @@ float *outputBuffer, const float *generatedBuffer, int samples, float curveOffse
 
 void desynSynthesizerSource::ApplyGeneratedSoundMonoAdd( const desynSynthesizerInstance &instance,
 float *outputBuffer, const float *generatedBuffer, int samples, float curveOffset, float curveFactor ){
-	const sGenerateBufferMono * const generatedSamples = ( const sGenerateBufferMono * )generatedBuffer;
-	sGenerateBufferMono * const outputSamples = ( sGenerateBufferMono* )outputBuffer;
-	int i;
-	
-	// TODO: optimize if volume is static
-	// TODO: optimize if volume is 1
+	desynSharedBuffer *sharedBuffer = NULL;
 	
-	for( i=0; i<samples; i++ ){
-		const int curveEvalPos = NearestCurveEvalPosition( i, curveOffset, curveFactor );
-		const float volume = GetVolume( instance, curveEvalPos );
+	try{
+		sharedBuffer = GetModule().GetSharedBufferList().ClaimBuffer( samples );
+		float * const volumes = sharedBuffer->GetBuffer();
+		
+		GetVolumes( instance, volumes, samples, curveOffset, curveFactor );
+		desynSynthesizerKernels::MixMonoAdd( outputBuffer, generatedBuffer, volumes, samples );
+		
+		GetModule().GetSharedBufferList().ReleaseBuffer( sharedBuffer );
 		
-		outputSamples[ i ].value += generatedSamples[ i ].value * volume;
+	}catch( const deException & ){
+		if( sharedBuffer ){
+			GetModule().GetSharedBufferList().ReleaseBuffer( sharedBuffer );
+		}
+		throw;
 	}
 }
 
 void desynSynthesizerSource::ApplyGeneratedSoundMonoBlend( const desynSynthesizerInstance &instance,
 float *outputBuffer, const float *generatedBuffer, int samples, float curveOffset, float curveFactor ){
-	const sGenerateBufferMono * const generatedSamples = ( const sGenerateBufferMono * )generatedBuffer;
-	sGenerateBufferMono * const outputSamples = ( sGenerateBufferMono* )outputBuffer;
-	int i;
-	
-	// TODO: optimize if blend-factor and/or volume is static
-	// TODO: optimize if blend-factor and/or volume is 1
+	desynSharedBuffer *sharedBuffer = NULL;
 	
-	for( i=0; i<samples; i++ ){
-		const int curveEvalPos = NearestCurveEvalPosition( i, curveOffset, curveFactor );
-		const float blendFactor = GetBlendFactor( instance, curveEvalPos );
-		const float volume = GetVolume( instance, curveEvalPos );
+	try{
+		sharedBuffer = GetModule().GetSharedBufferList().ClaimBuffer( samples * 2 );
+		float * const volumes = sharedBuffer->GetBuffer();
+		float * const blendFactors = volumes + samples;
+		
+		GetVolumes( instance, volumes, samples, curveOffset, curveFactor );
+		GetBlendFactors( instance, blendFactors, samples, curveOffset, curveFactor );
+		desynSynthesizerKernels::MixMonoBlend( outputBuffer, generatedBuffer, volumes, blendFactors, samples );
 		
-		outputSamples[ i ].value = decMath::mix( outputSamples[ i ].value,
-			generatedSamples[ i ].value * volume, blendFactor );
+		GetModule().GetSharedBufferList().ReleaseBuffer( sharedBuffer );
+		
+	}catch( const deException & ){
+		if( sharedBuffer ){
+			GetModule().GetSharedBufferList().ReleaseBuffer( sharedBuffer );
+		}
+		throw;
 	}
 }
 
 void desynSynthesizerSource::ApplyGeneratedSoundStereoAdd( const desynSynthesizerInstance &instance,
 float *outputBuffer, const float *generatedBuffer, int samples, float curveOffset, float curveFactor ){
-	const sGenerateBufferStereo * const generatedSamples = ( const sGenerateBufferStereo * )generatedBuffer;
-	sGenerateBufferStereo * const outputSamples = ( sGenerateBufferStereo* )outputBuffer;
-	int i;
-	
-	// TODO: optimize if volume is static
-	// TODO: optimize if volume is 1
+	desynSharedBuffer *sharedBuffer = NULL;
 	
-	for( i=0; i<samples; i++ ){
-		const int curveEvalPos = NearestCurveEvalPosition( i, curveOffset, curveFactor );
-		const float volume = GetVolume( instance, curveEvalPos );
+	try{
+		sharedBuffer = GetModule().GetSharedBufferList().ClaimBuffer( samples );
+		float * const volumes = sharedBuffer->GetBuffer();
+		
+		GetVolumes( instance, volumes, samples, curveOffset, curveFactor );
+		desynSynthesizerKernels::MixStereoAdd( outputBuffer, generatedBuffer, volumes, samples );
 		
-		outputSamples[ i ].left += generatedSamples[ i ].left * volume;
-		outputSamples[ i ].right += generatedSamples[ i ].right * volume;
+		GetModule().GetSharedBufferList().ReleaseBuffer( sharedBuffer );
+		
+	}catch( const deException & ){
+		if( sharedBuffer ){
+			GetModule().GetSharedBufferList().ReleaseBuffer( sharedBuffer );
+		}
+		throw;
 	}
 }
 
 void desynSynthesizerSource::ApplyGeneratedSoundStereoBlend( const desynSynthesizerInstance &instance,
 float *outputBuffer, const float *generatedBuffer, int samples, float curveOffset, float curveFactor ){
-	const sGenerateBufferStereo * const generatedSamples = ( const sGenerateBufferStereo * )generatedBuffer;
-	sGenerateBufferStereo * const outputSamples = ( sGenerateBufferStereo* )outputBuffer;
-	int i;
-	
-	// TODO: optimize if blend-factor and/or volume is static
-	// TODO: optimize if blend-factor and/or volume is 1
+	desynSharedBuffer *sharedBuffer = NULL;
 	
-	for( i=0; i<samples; i++ ){
-		const int curveEvalPos = NearestCurveEvalPosition( i, curveOffset, curveFactor );
-		const float blendFactor = GetBlendFactor( instance, curveEvalPos );
-		const float volume = GetVolume( instance, curveEvalPos );
+	try{
+		sharedBuffer = GetModule().GetSharedBufferList().ClaimBuffer( samples * 2 );
+		float * const volumes = sharedBuffer->GetBuffer();
+		float * const blendFactors = volumes + samples;
 		
-		outputSamples[ i ].left = decMath::mix( outputSamples[ i ].left,
-			generatedSamples[ i ].left * volume, blendFactor );
-		outputSamples[ i ].right = decMath::mix( outputSamples[ i ].right,
-			generatedSamples[ i ].right * volume, blendFactor );
+		GetVolumes( instance, volumes, samples, curveOffset, curveFactor );
+		GetBlendFactors( instance, blendFactors, samples, curveOffset, curveFactor );
+		desynSynthesizerKernels::MixStereoBlend( outputBuffer, generatedBuffer, volumes, blendFactors, samples );
+		
+		GetModule().GetSharedBufferList().ReleaseBuffer( sharedBuffer );
+		
+	}catch( const deException & ){
+		if( sharedBuffer ){
+			GetModule().GetSharedBufferList().ReleaseBuffer( sharedBuffer );
+		}
+		throw;
 	}
 }
 
@@ -147,6 +147,18 @@ public:
 	/** \brief Current panning. */
 	float GetPanning( const desynSynthesizerInstance &instance, int sample ) const;
 	
+	/** \brief Blend factors for block of samples. */
+	void GetBlendFactors( const desynSynthesizerInstance &instance, float *values,
+		int samples, float curveOffset, float curveFactor ) const;
+		
+	/** \brief Volumes for block of samples. */
+	void GetVolumes( const desynSynthesizerInstance &instance, float *values,
+		int samples, float curveOffset, float curveFactor ) const;
+		
+	/** \brief Pannings for block of samples. */
+	void GetPannings( const desynSynthesizerInstance &instance, float *values,
+		int samples, float curveOffset, float curveFactor ) const;
+		
 	
 	
 	/**
@@ -25,7 +25,10 @@
 
 #include "desynSynthesizerSourceWave.h"
 #include "../desynSynthesizerInstance.h"
+#include "../desynSynthesizerKernels.h"
 #include "../../deDESynthesizer.h"
+#include "../../buffer/desynSharedBuffer.h"
+#include "../../buffer/desynSharedBufferList.h"
 
 #include <dragengine/common/exceptions.h>
 #include <dragengine/common/math/decMath.h>
@@ -36,8 +39,6 @@
 // Definitions
 ////////////////
 
-#define PI2 ( PI * 2.0f )
-
 struct sStateData{
 	float phase;
 };
@@ -77,6 +78,16 @@ float desynSynthesizerSourceWave::GetFrequency( const desynSynthesizerInstance &
 	return pMinFrequency + pFrequencyRange * pTargetFrequency.GetValue( instance, sample, 0.0f );
 }
 
+void desynSynthesizerSourceWave::GetFrequencies( const desynSynthesizerInstance &instance,
+float *values, int samples, float curveOffset, float curveFactor ) const{
+	pTargetFrequency.GetValues( instance, values, samples, curveOffset, curveFactor, 0.0f );
+	
+	int i;
+	for( i=0; i<samples; i++ ){
+		values[ i ] = pMinFrequency + pFrequencyRange * values[ i ];
+	}
+}
+
 
 
 int desynSynthesizerSourceWave::StateDataSizeSource( int offset ){
@@ -113,174 +124,73 @@ char *stateData, float *buffer, int samples, float curveOffset, float curveFacto
 
 void desynSynthesizerSourceWave::GenerateSineWave( const desynSynthesizerInstance &instance,
 char *stateData, float *buffer, int samples, float curveOffset, float curveFactor ){
-	sStateData& sdata = *( ( sStateData* )( stateData + GetStateDataOffset() ) );
-	const int channelCount = instance.GetChannelCount();
-	const float invSampleRate = instance.GetInverseSampleRate();
-	int i;
-	
-	if( channelCount == 1 ){
-		sGenerateBufferMono * const sbuf = ( sGenerateBufferMono* )buffer;
-		
-		for( i=0; i<samples; i++ ){
-			const int curveEvalPos = NearestCurveEvalPosition( i, curveOffset, curveFactor );
-			sbuf[ i ].value = sinf( sdata.phase * PI2 );
-			sdata.phase += GetFrequency( instance, curveEvalPos ) * invSampleRate;
-		}
-		
-	}else if( channelCount == 2 ){
-		sGenerateBufferStereo * const sbuf = ( sGenerateBufferStereo* )buffer;
-		
-		for( i=0; i<samples; i++ ){
-			const int curveEvalPos = NearestCurveEvalPosition( i, curveOffset, curveFactor );
-			const float panning = GetPanning( instance, curveEvalPos );
-			const float value = sinf( sdata.phase * PI2 );
-			
-			sbuf[ i ].left = decMath::min( 1.0f - panning, 1.0f ) * value;
-			sbuf[ i ].right = decMath::min( 1.0f + panning, 1.0f ) * value;
-			
-			sdata.phase += GetFrequency( instance, curveEvalPos ) * invSampleRate;
-		}
-	}
-	
-	float intpart;
-	sdata.phase = modff( sdata.phase, &intpart );
+	pGenerateWave( instance, stateData, buffer, samples, curveOffset, curveFactor, desynSynthesizerKernels::Sine );
 }
 
 void desynSynthesizerSourceWave::GenerateSquareWave( const desynSynthesizerInstance &instance,
 char *stateData, float *buffer, int samples, float curveOffset, float curveFactor ){
-	sStateData& sdata = *( ( sStateData* )( stateData + GetStateDataOffset() ) );
-	const int channelCount = instance.GetChannelCount();
-	const float invSampleRate = instance.GetInverseSampleRate();
-	float intpart;
-	int i;
-	
-	if( channelCount == 1 ){
-		sGenerateBufferMono * const sbuf = ( sGenerateBufferMono* )buffer;
-		
-		for( i=0; i<samples; i++ ){
-			const int curveEvalPos = NearestCurveEvalPosition( i, curveOffset, curveFactor );
-			
-			if( sdata.phase < 0.5f ){
-				sbuf[ i ].value = 1.0f;
-				
-			}else{
-				sbuf[ i ].value = -1.0f;
-			}
-			
-			sdata.phase = modff( sdata.phase + GetFrequency( instance, curveEvalPos ) * invSampleRate, &intpart );
-		}
-		
-	}else if( channelCount == 2 ){
-		sGenerateBufferStereo * const sbuf = ( sGenerateBufferStereo* )buffer;
-		
-		for( i=0; i<samples; i++ ){
-			const int curveEvalPos = NearestCurveEvalPosition( i, curveOffset, curveFactor );
-			const float panning = GetPanning( instance, curveEvalPos );
-			const float panLeft = decMath::min( 1.0f - panning, 1.0f );
-			const float panRight = decMath::min( 1.0f + panning, 1.0f );
-			
-			if( sdata.phase < 0.5f ){
-				sbuf[ i ].left = panLeft;
-				sbuf[ i ].right = panRight;
-				
-			}else{
-				sbuf[ i ].left = -panLeft;
-				sbuf[ i ].right = -panRight;
-			}
-			
-			sdata.phase = modff( sdata.phase + GetFrequency( instance, curveEvalPos ) * invSampleRate, &intpart );
-		}
-	}
+	pGenerateWave( instance, stateData, buffer, samples, curveOffset, curveFactor, desynSynthesizerKernels::Square );
 }
 
 void desynSynthesizerSourceWave::GenerateSawToothWave( const desynSynthesizerInstance &instance,
 char *stateData, float *buffer, int samples, float curveOffset, float curveFactor ){
-	sStateData& sdata = *( ( sStateData* )( stateData + GetStateDataOffset() ) );
-	const int channelCount = instance.GetChannelCount();
-	const float invSampleRate = instance.GetInverseSampleRate();
-	float intpart;
-	int i;
-	
-	if( channelCount == 1 ){
-		sGenerateBufferMono * const sbuf = ( sGenerateBufferMono* )buffer;
-		
-		for( i=0; i<samples; i++ ){
-			const int curveEvalPos = NearestCurveEvalPosition( i, curveOffset, curveFactor );
-			sbuf[ i ].value = sdata.phase - 1.0f;
-			sdata.phase = modff( sdata.phase + GetFrequency( instance, curveEvalPos ) * invSampleRate, &intpart );
-		}
-		
-	}else if( channelCount == 2 ){
-		sGenerateBufferStereo * const sbuf = ( sGenerateBufferStereo* )buffer;
-		
-		for( i=0; i<samples; i++ ){
-			const int curveEvalPos = NearestCurveEvalPosition( i, curveOffset, curveFactor );
-			const float panning = GetPanning( instance, curveEvalPos );
-			const float value = sdata.phase - 1.0f;
-			sbuf[ i ].left = decMath::min( 1.0f - panning, 1.0f ) * value;
-			sbuf[ i ].right = decMath::min( 1.0f + panning, 1.0f ) * value;
-			
-			sdata.phase = modff( sdata.phase + GetFrequency( instance, curveEvalPos ) * invSampleRate, &intpart );
-		}
-	}
+	pGenerateWave( instance, stateData, buffer, samples, curveOffset, curveFactor, desynSynthesizerKernels::SawTooth );
 }
 
 void desynSynthesizerSourceWave::GenerateTriangleWave( const desynSynthesizerInstance &instance,
 char *stateData, float *buffer, int samples, float curveOffset, float curveFactor ){
+	pGenerateWave( instance, stateData, buffer, samples, curveOffset, curveFactor, desynSynthesizerKernels::Triangle );
+}
+
+void desynSynthesizerSourceWave::SkipSourceSound( const desynSynthesizerInstance &instance,
+char *stateData, int samples, float curveOffset, float curveFactor ){
+}
+
+
+
+// Private Functions
+//////////////////////
+
+void desynSynthesizerSourceWave::pGenerateWave( const desynSynthesizerInstance &instance,
+char *stateData, float *buffer, int samples, float curveOffset, float curveFactor,
+cWaveKernel waveKernel ){
 	sStateData& sdata = *( ( sStateData* )( stateData + GetStateDataOffset() ) );
 	const int channelCount = instance.GetChannelCount();
 	const float invSampleRate = instance.GetInverseSampleRate();
-	float intpart;
-	int i;
+	desynSharedBuffer *sharedBuffer = NULL;
 	
-	if( channelCount == 1 ){
-		sGenerateBufferMono * const sbuf = ( sGenerateBufferMono* )buffer;
-		
-		for( i=0; i<samples; i++ ){
-			const int curveEvalPos = NearestCurveEvalPosition( i, curveOffset, curveFactor );
-			const float fract = sdata.phase * 4.0f;
+	if( channelCount != 1 && channelCount != 2 ){
+		return;
+	}
+	
+	try{
+		if( channelCount == 1 ){
+			sharedBuffer = GetModule().GetSharedBufferList().ClaimBuffer( samples );
+			float * const phases = sharedBuffer->GetBuffer();
+			
+			GetFrequencies( instance, phases, samples, curveOffset, curveFactor );
+			desynSynthesizerKernels::Phases( phases, phases, samples, invSampleRate, sdata.phase );
+			waveKernel( buffer, phases, samples );
+			
+		}else{
+			sharedBuffer = GetModule().GetSharedBufferList().ClaimBuffer( samples * 2 );
+			float * const values = sharedBuffer->GetBuffer();
+			float * const pannings = values + samples;
 			
-			if( fract < 1.0f ){
-				sbuf[ i ].value = fract;
-				
-			}else if( fract > 3.0f ){
-				sbuf[ i ].value = fract - 4.0f;
-				
-			}else{
-				sbuf[ i ].value = 2.0f - fract;
-			}
+			GetFrequencies( instance, values, samples, curveOffset, curveFactor );
+			desynSynthesizerKernels::Phases( values, values, samples, invSampleRate, sdata.phase );
+			waveKernel( values, values, samples );
 			
-			sdata.phase = modff( sdata.phase + GetFrequency( instance, curveEvalPos ) * invSampleRate, &intpart );
+			GetPannings( instance, pannings, samples, curveOffset, curveFactor );
+			desynSynthesizerKernels::Pan( buffer, values, pannings, samples );
 		}
 		
-	}else if( channelCount == 2 ){
-		sGenerateBufferStereo * const sbuf = ( sGenerateBufferStereo* )buffer;
+		GetModule().GetSharedBufferList().ReleaseBuffer( sharedBuffer );
 		
-		for( i=0; i<samples; i++ ){
-			const int curveEvalPos = NearestCurveEvalPosition( i, curveOffset, curveFactor );
-			const float panning = GetPanning( instance, curveEvalPos );
-			
-			const float fract = sdata.phase * 4.0f;
-			float value;
-			
-			if( fract < 1.0f ){
-				value = fract;
-				
-			}else if( fract > 3.0f ){
-				value = fract - 4.0f;
-				
-			}else{
-				value = 2.0f - fract;
-			}
-			
-			sbuf[ i ].left = decMath::min( 1.0f - panning, 1.0f ) * value;
-			sbuf[ i ].right = decMath::min( 1.0f + panning, 1.0f ) * value;
-			
-			sdata.phase = modff( sdata.phase + GetFrequency( instance, curveEvalPos ) * invSampleRate, &intpart );
+	}catch( const deException & ){
+		if( sharedBuffer ){
+			GetModule().GetSharedBufferList().ReleaseBuffer( sharedBuffer );
 		}
+		throw;
 	}
 }
-
-void desynSynthesizerSourceWave::SkipSourceSound( const desynSynthesizerInstance &instance,
-char *stateData, int samples, float curveOffset, float curveFactor ){
-}
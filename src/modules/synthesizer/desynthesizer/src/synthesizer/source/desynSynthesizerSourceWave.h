@@ -76,6 +76,10 @@ public:
 	/** \brief Current frequency. */
 	float GetFrequency( const desynSynthesizerInstance &instance, int sample ) const;
 	
+	/** \brief Frequencies for block of samples. */
+	void GetFrequencies( const desynSynthesizerInstance &instance, float *values,
+		int samples, float curveOffset, float curveFactor ) const;
+		
 	
 	
 	/**
@@ -125,6 +129,14 @@ public:
 	virtual void SkipSourceSound( const desynSynthesizerInstance &instance, char *stateData,
 		int samples, float curveOffset, float curveFactor );
 	/*@}*/
+	
+	
+	
+private:
+	typedef void (*cWaveKernel)( float *values, const float *phases, int count );
+	
+	void pGenerateWave( const desynSynthesizerInstance &instance, char *stateData,
+		float *buffer, int samples, float curveOffset, float curveFactor, cWaveKernel waveKernel );
 };
 
 #endif
@@ -26,10 +26,14 @@
 #include "deVideoApng.h"
 #include "deapngDecoder.h"
 #include "deapngReader.h"
+#include "deapngFrameCache.h"
 
 #include <dragengine/common/exceptions.h>
 #include <dragengine/common/file/decBaseFileReader.h>
 #include <dragengine/common/file/decBaseFileWriter.h>
+#include <dragengine/common/string/unicode/decUnicodeArgumentList.h>
+#include <dragengine/common/string/unicode/decUnicodeString.h>
+#include <dragengine/threading/deMutexGuard.h>
 #include <dragengine/resources/video/deVideo.h>
 #include <dragengine/systems/modules/video/deBaseVideoInfo.h>
 
@@ -100,3 +104,102 @@ deBaseVideoDecoder *deVideoApng::CreateDecoder( decBaseFileReader *reader ){
 deBaseVideoAudioDecoder *deVideoApng::CreateAudioDecoder( decBaseFileReader* ){
 	return NULL;
 }
+
+
+
+deapngFrameCache *deVideoApng::GetFrameCache( decBaseFileReader &reader, int frameCount, int frameSize ){
+	const TIME_SYSTEM modificationTime = reader.GetModificationTime();
+	const decString filename( reader.GetFilename() );
+	
+	const deMutexGuard guard( pMutexFrameCaches );
+	const int count = pFrameCaches.GetCount();
+	int i;
+	
+	for( i=0; i<count; i++ ){
+		deapngFrameCache * const frameCache = ( deapngFrameCache* )pFrameCaches.GetAt( i );
+		if( frameCache->GetFilename() == filename
+		&& frameCache->GetModificationTime() == modificationTime
+		&& frameCache->GetFrameCount() == frameCount
+		&& frameCache->GetFrameSize() == frameSize ){
+			frameCache->AddReference();
+			return frameCache;
+		}
+	}
+	
+	deapngFrameCache * const frameCache = new deapngFrameCache(
+		filename, modificationTime, frameCount, frameSize );
+		
+	try{
+		pFrameCaches.Add( frameCache );
+		
+	}catch( const deException & ){
+		frameCache->FreeReference();
+		throw;
+	}
+	
+	return frameCache; // list holds a reference and the caller takes over the creation one
+}
+
+void deVideoApng::ReleaseFrameCache( deapngFrameCache *frameCache ){
+	if( ! frameCache ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	// drop the frame cache once only the list holds a reference
+	const deMutexGuard guard( pMutexFrameCaches );
+	frameCache->FreeReference();
+	
+	if( frameCache->GetRefCount() == 1 ){
+		pFrameCaches.Remove( frameCache );
+	}
+}
+
+
+
+void deVideoApng::SendCommand( const decUnicodeArgumentList &command, decUnicodeString &answer ){
+	if( command.GetArgumentCount() == 0 ){
+		deBaseVideoModule::SendCommand( command, answer );
+		
+	}else if( command.MatchesArgumentAt( 0, "help" ) ){
+		answer.SetFromUTF8( "help => Displays this help screen.\n"
+			"frameCache => Displays frame cache statistics.\n" );
+			
+	}else if( command.MatchesArgumentAt( 0, "frameCache" ) ){
+		const deMutexGuard guard( pMutexFrameCaches );
+		const int count = pFrameCaches.GetCount();
+		int totalCachedFrames = 0;
+		int totalHits = 0;
+		int totalMisses = 0;
+		double totalMemory = 0.0;
+		decString text;
+		int i;
+		
+		for( i=0; i<count; i++ ){
+			deapngFrameCache &frameCache = *( ( deapngFrameCache* )pFrameCaches.GetAt( i ) );
+			int cachedFrameCount, hitCount, missCount;
+			frameCache.GetStatistics( cachedFrameCount, hitCount, missCount );
+			
+			const double memory = ( double )cachedFrameCount * ( double )frameCache.GetFrameSize();
+			const int requestCount = hitCount + missCount;
+			
+			text.AppendFormat( "%s: %s, frames %d/%d, memory %.1fMB, hits %d, misses %d, hit rate %.1f%%\n",
+				frameCache.GetFilename().GetString(), frameCache.GetEnabled() ? "enabled" : "disabled",
+				cachedFrameCount, frameCache.GetFrameCount(), memory / 1e6, hitCount, missCount,
+				requestCount > 0 ? 100.0 * ( double )hitCount / ( double )requestCount : 0.0 );
+				
+			totalCachedFrames += cachedFrameCount;
+			totalHits += hitCount;
+			totalMisses += missCount;
+			totalMemory += memory;
+		}
+		
+		text.AppendFormat( "Total: caches %d, frames %d, memory %.1fMB, hits %d, misses %d, hit rate %.1f%%",
+			count, totalCachedFrames, totalMemory / 1e6, totalHits, totalMisses,
+			totalHits + totalMisses > 0 ? 100.0 * ( double )totalHits / ( double )( totalHits + totalMisses ) : 0.0 );
+			
+		answer.SetFromUTF8( text );
+		
+	}else{
+		deBaseVideoModule::SendCommand( command, answer );
+	}
+}
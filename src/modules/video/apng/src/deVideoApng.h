@@ -22,7 +22,11 @@
 #ifndef _DEVIDEOAPNG_H_
 #define _DEVIDEOAPNG_H_
 
+#include <dragengine/common/collection/decThreadSafeObjectOrderedSet.h>
 #include <dragengine/systems/modules/video/deBaseVideoModule.h>
+#include <dragengine/threading/deMutex.h>
+
+class deapngFrameCache;
 
 
 
@@ -30,6 +34,12 @@
  * \brief Animated PNG video module.
  */
 class deVideoApng : public deBaseVideoModule{
+private:
+	decThreadSafeObjectOrderedSet pFrameCaches;
+	deMutex pMutexFrameCaches;
+	
+	
+	
 public:
 	/** \name Constructors and Destructors */
 	/*@{*/
@@ -63,6 +73,23 @@ public:
 	 * If no video audio is present or module does not support audio null is returned..
 	 */
 	virtual deBaseVideoAudioDecoder *CreateAudioDecoder( decBaseFileReader *reader );
+	
+	
+	
+	/**
+	 * \brief Frame cache shared by all decoders of the file.
+	 * 
+	 * Caller receives a reference and has to release it using ReleaseFrameCache().
+	 */
+	deapngFrameCache *GetFrameCache( decBaseFileReader &reader, int frameCount, int frameSize );
+	
+	/** \brief Release frame cache obtained using GetFrameCache(). */
+	void ReleaseFrameCache( deapngFrameCache *frameCache );
+	
+	
+	
+	/** \brief Send command. */
+	virtual void SendCommand( const decUnicodeArgumentList &command, decUnicodeString &answer );
 	/*@}*/
 };
 
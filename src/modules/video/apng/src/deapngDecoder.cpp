@@ -25,6 +25,7 @@
 
 #include "deapngDecoder.h"
 #include "deapngReader.h"
+#include "deapngFrameCache.h"
 #include "deVideoApng.h"
 
 #include <dragengine/common/exceptions.h>
@@ -42,7 +43,9 @@
 deapngDecoder::deapngDecoder( deVideoApng &module, decBaseFileReader *file ) :
 deBaseVideoDecoder( file ),
 pModule( module ),
-pReader( NULL )
+pReader( NULL ),
+pFrameCache( NULL ),
+pPosition( 0 )
 {
 	module.LogInfoFormat( "Create decoder for %s", file->GetFilename() );
 	
@@ -53,6 +56,8 @@ pReader( NULL )
 			pReader->GetWidth(), pReader->GetHeight(), pReader->GetPixelFormat(),
 			pReader->GetFrameCount(), pReader->GetFrameRate() );
 		
+		pFrameCache = module.GetFrameCache( *file, pReader->GetFrameCount(), pReader->GetImageSize() );
+		
 	}catch( const deException &e ){
 		pCleanUp();
 		e.PrintError();
@@ -71,20 +76,40 @@ deapngDecoder::~deapngDecoder(){
 ///////////////
 
 int deapngDecoder::GetPosition(){
-	return pReader->GetCurrentFrame();
+	return pPosition;
 }
 
 void deapngDecoder::SetPosition( int position ){
-	pReader->SeekFrame( position );
+	pPosition = position;
 }
 
 bool deapngDecoder::DecodeFrame( void *buffer1, int size1, void *buffer2, int size2 ){
-	if( pReader->GetCurrentFrame() >= pReader->GetFrameCount() ){
+	if( pPosition < 0 || pPosition >= pReader->GetFrameCount() ){
 		return false; // trying to read past end of stream
 	}
 	
-	pReader->ReadImage();
+	if( pFrameCache->GetFrame( pPosition, buffer1, size1 ) ){
+		pPosition++;
+		return true;
+	}
+	
+	// frames have to be composited in sequence. frames passed while moving the reader
+	// to the position are cached too for other decoders to use
+	if( pPosition < pReader->GetCurrentFrame() ){
+		pReader->Rewind();
+	}
+	
+	while( pReader->GetCurrentFrame() <= pPosition && ! pReader->GetErrorState() ){
+		pReader->ReadImage();
+		
+		if( ! pReader->GetErrorState() ){
+			pFrameCache->AddFrame( pReader->GetCurrentFrame() - 1,
+				pReader->GetAccumData(), pReader->GetImageSize() );
+		}
+	}
+	
 	pReader->CopyAccumImage( buffer1, size1 );
+	pPosition++;
 	return true;
 }
 
@@ -94,6 +119,9 @@ bool deapngDecoder::DecodeFrame( void *buffer1, int size1, void *buffer2, int si
 //////////////////////
 
 void deapngDecoder::pCleanUp(){
+	if( pFrameCache ){
+		pModule.ReleaseFrameCache( pFrameCache );
+	}
 	if( pReader ){
 		delete pReader;
 	}
@@ -27,6 +27,7 @@
 #include <dragengine/systems/modules/video/deBaseVideoDecoder.h>
 
 class deapngReader;
+class deapngFrameCache;
 class deVideoApng;
 
 class decBaseFileReader;
@@ -40,6 +41,8 @@ class deapngDecoder : public deBaseVideoDecoder{
 private:
 	deVideoApng &pModule;
 	deapngReader *pReader;
+	deapngFrameCache *pFrameCache;
+	int pPosition;
 	
 	
 	
@@ -60,7 +63,11 @@ public:
 	/** \brief File position in frames from the beginning. */
 	virtual int GetPosition();
 	
-	/** \brief Set file position in frames from the beginning. */
+	/**
+	 * \brief Set file position in frames from the beginning.
+	 * 
+	 * The reader is moved to the position only if the frame is not cached.
+	 */
 	virtual void SetPosition( int position );
 	
 	/**
@@ -0,0 +1,154 @@
+/* 
+ * Drag[en]gine Animated PNG Video Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "deapngFrameCache.h"
+
+#include <dragengine/common/exceptions.h>
+#include <dragengine/threading/deMutexGuard.h>
+
+
+
+// Definitions
+////////////////
+
+// maximum size of all frames of a video to enable caching. UI animations are usually
+// small enough to fit. for larger videos the graphic module caching takes over
+#define MAX_CACHE_SIZE 32000000
+
+
+
+// Class deapngFrameCache
+///////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+deapngFrameCache::deapngFrameCache( const char *filename, TIME_SYSTEM modificationTime,
+int frameCount, int frameSize ) :
+pFilename( filename ),
+pModificationTime( modificationTime ),
+pFrameCount( frameCount ),
+pFrameSize( frameSize ),
+pEnabled( frameCount > 0 && frameSize > 0 && frameCount <= MAX_CACHE_SIZE / frameSize ),
+pFrames( NULL ),
+pCachedFrameCount( 0 ),
+pHitCount( 0 ),
+pMissCount( 0 )
+{
+	if( frameCount < 0 || frameSize < 0 ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	if( pEnabled ){
+		pFrames = new unsigned char*[ frameCount ];
+		memset( pFrames, 0, sizeof( unsigned char* ) * frameCount );
+	}
+}
+
+deapngFrameCache::~deapngFrameCache(){
+	if( pFrames ){
+		int i;
+		for( i=0; i<pFrameCount; i++ ){
+			if( pFrames[ i ] ){
+				delete [] pFrames[ i ];
+			}
+		}
+		delete [] pFrames;
+	}
+}
+
+
+
+// Management
+///////////////
+
+bool deapngFrameCache::GetFrame( int frame, void *buffer, int size ){
+	if( frame < 0 || frame >= pFrameCount || ! buffer || size != pFrameSize ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	if( ! pEnabled ){
+		return false;
+	}
+	
+	// cached frames are never modified nor removed while the cache exists. copying
+	// the frame data is safe without holding the lock
+	deMutexGuard guard( pMutex );
+	const unsigned char * const data = pFrames[ frame ];
+	
+	if( data ){
+		pHitCount++;
+		
+	}else{
+		pMissCount++;
+	}
+	
+	guard.Unlock();
+	
+	if( ! data ){
+		return false;
+	}
+	
+	memcpy( buffer, data, pFrameSize );
+	return true;
+}
+
+void deapngFrameCache::AddFrame( int frame, const void *data, int size ){
+	if( frame < 0 || frame >= pFrameCount || ! data || size != pFrameSize ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	if( ! pEnabled ){
+		return;
+	}
+	
+	deMutexGuard guard( pMutex );
+	if( pFrames[ frame ] ){
+		return;
+	}
+	guard.Unlock();
+	
+	// copy outside the lock. if another decoder added the frame meanwhile drop the copy
+	unsigned char * const copy = new unsigned char[ pFrameSize ];
+	memcpy( copy, data, pFrameSize );
+	
+	guard.Lock();
+	if( pFrames[ frame ] ){
+		guard.Unlock();
+		delete [] copy;
+		return;
+	}
+	
+	pFrames[ frame ] = copy;
+	pCachedFrameCount++;
+}
+
+void deapngFrameCache::GetStatistics( int &cachedFrameCount, int &hitCount, int &missCount ){
+	const deMutexGuard guard( pMutex );
+	cachedFrameCount = pCachedFrameCount;
+	hitCount = pHitCount;
+	missCount = pMissCount;
+}
@@ -0,0 +1,104 @@
+/* 
+ * Drag[en]gine Animated PNG Video Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef _DEAPNGFRAMECACHE_H_
+#define _DEAPNGFRAMECACHE_H_
+
+#include <dragengine/common/utils/decDateTime.h>
+#include <dragengine/common/string/decString.h>
+#include <dragengine/threading/deMutex.h>
+#include <dragengine/threading/deThreadSafeObject.h>
+
+
+
+/**
+ * \brief Cache of composited animated PNG frames.
+ * 
+ * Shared between all decoders of the same file. Decoding animated PNG frames requires
+ * compositing all frames before them. Frames decoded by one decoder are used by all
+ * other decoders of the same file without decoding them again. The cache is only
+ * enabled if all frames of the video fit into the memory budget since playing videos
+ * in loops would otherwise constantly replace cached frames.
+ */
+class deapngFrameCache : public deThreadSafeObject{
+private:
+	const decString pFilename;
+	const TIME_SYSTEM pModificationTime;
+	const int pFrameCount;
+	const int pFrameSize;
+	const bool pEnabled;
+	
+	unsigned char **pFrames;
+	int pCachedFrameCount;
+	int pHitCount;
+	int pMissCount;
+	
+	deMutex pMutex;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create frame cache. */
+	deapngFrameCache( const char *filename, TIME_SYSTEM modificationTime, int frameCount, int frameSize );
+	
+protected:
+	/** \brief Clean up frame cache. */
+	virtual ~deapngFrameCache();
+	/*@}*/
+	
+	
+	
+public:
+	/** \name Management */
+	/*@{*/
+	/** \brief Filename. */
+	inline const decString &GetFilename() const{ return pFilename; }
+	
+	/** \brief Modification time. */
+	inline TIME_SYSTEM GetModificationTime() const{ return pModificationTime; }
+	
+	/** \brief Number of frames. */
+	inline int GetFrameCount() const{ return pFrameCount; }
+	
+	/** \brief Size of frame in bytes. */
+	inline int GetFrameSize() const{ return pFrameSize; }
+	
+	/** \brief Cache is enabled. */
+	inline bool GetEnabled() const{ return pEnabled; }
+	
+	/**
+	 * \brief Copy cached frame into buffer.
+	 * \returns true if the frame is cached or false otherwise.
+	 */
+	bool GetFrame( int frame, void *buffer, int size );
+	
+	/** \brief Add frame to the cache if not cached yet. */
+	void AddFrame( int frame, const void *data, int size );
+	
+	/** \brief Statistics. */
+	void GetStatistics( int &cachedFrameCount, int &hitCount, int &missCount );
+	/*@}*/
+};
+
+#endif
@@ -106,9 +106,18 @@ public:
 	
 	
 	
+	/** \brief Size of image in bytes. */
+	inline int GetImageSize() const{ return pImageSize; }
+	
 	/** \brief Current frame. */
 	inline int GetCurrentFrame() const{ return pCurFrame; }
 	
+	/** \brief Reading failed and accum image is the error image. */
+	inline bool GetErrorState() const{ return pErrorState; }
+	
+	/** \brief Accum image data. */
+	inline const png_byte *GetAccumData() const{ return pAccumData; }
+	
 	
 	
 	/** \brief Rewinds to the beginning. */
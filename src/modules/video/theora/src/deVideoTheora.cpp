@@ -30,6 +30,7 @@
 #include "dethVideoDecoder.h"
 #include "dethVideoAudioDecoder.h"
 #include "dethOggReader.h"
+#include "dethDeveloperMode.h"
 
 #include <dragengine/common/exceptions.h>
 #include <dragengine/common/file/decBaseFileReader.h>
@@ -68,10 +69,15 @@ deBaseModule *TheoraCreateModule( deLoadableModule *loadableModule ){
 ////////////////////////////
 
 deVideoTheora::deVideoTheora( deLoadableModule &loadableModule ) :
-deBaseVideoModule( loadableModule ){
+deBaseVideoModule( loadableModule ),
+pDeveloperMode( NULL ){
+	pDeveloperMode = new dethDeveloperMode( *this );
 }
 
 deVideoTheora::~deVideoTheora(){
+	if( pDeveloperMode ){
+		delete pDeveloperMode;
+	}
 }
 
 
@@ -129,3 +135,9 @@ deBaseVideoAudioDecoder *deVideoTheora::CreateAudioDecoder( decBaseFileReader *r
 		return NULL;
 	}
 }
+
+void deVideoTheora::SendCommand( const decUnicodeArgumentList &command, decUnicodeString &answer ){
+	if( ! pDeveloperMode->ExecuteCommand( command, answer ) ){
+		deBaseVideoModule::SendCommand( command, answer );
+	}
+}
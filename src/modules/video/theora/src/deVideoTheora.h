@@ -24,12 +24,18 @@
 
 #include <dragengine/systems/modules/video/deBaseVideoModule.h>
 
+class dethDeveloperMode;
 
 
 /**
  * \brief Theora video module.
  */
 class deVideoTheora : public deBaseVideoModule{
+private:
+	dethDeveloperMode *pDeveloperMode;
+	
+	
+	
 public:
 	/** \name Constructors and Destructors */
 	/*@{*/
@@ -63,6 +69,12 @@ public:
 	 * If no video audio is present or module does not support audio null is returned..
 	 */
 	virtual deBaseVideoAudioDecoder *CreateAudioDecoder( decBaseFileReader *reader );
+	
+	/** \brief Send command. */
+	virtual void SendCommand( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	
+	/** \brief Developer mode. */
+	inline dethDeveloperMode &GetDeveloperMode() const{ return *pDeveloperMode; }
 	/*@}*/
 };
 
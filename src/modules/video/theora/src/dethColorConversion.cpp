@@ -0,0 +1,234 @@
+/* 
+ * Drag[en]gine Theora Video Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "dethColorConversion.h"
+
+#include <dragengine/common/math/decMath.h>
+#include <dragengine/resources/image/deImage.h>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define DETH_CONVERT_SSE 1
+#include <emmintrin.h>
+#endif
+
+
+
+// Definitions
+////////////////
+
+// fractional bits of the fixed point color conversion. 13 bits allows coefficients
+// up to 4 to fit into the 16 bit integers used by the SIMD conversion
+#define CONV_BITS 13
+#define CONV_ONE ( 1 << CONV_BITS )
+
+static inline unsigned char fClampConv( int value ){
+	value >>= CONV_BITS;
+	return ( unsigned char )( value < 0 ? 0 : ( value > 255 ? 255 : value ) );
+}
+
+static inline void fConvertPixel( const int *c, int y, int cb, int cr, sRGB8 &pixel ){
+	pixel.red = fClampConv( c[ 0 ] * y + c[ 1 ] * cb + c[ 2 ] * cr + c[ 3 ] );
+	pixel.green = fClampConv( c[ 4 ] * y + c[ 5 ] * cb + c[ 6 ] * cr + c[ 7 ] );
+	pixel.blue = fClampConv( c[ 8 ] * y + c[ 9 ] * cb + c[ 10 ] * cr + c[ 11 ] );
+}
+
+#ifdef DETH_CONVERT_SSE
+// coefficients for multiply-add of interleaved 16 bit value pairs
+static inline __m128i fCoeffPair( int coeff1, int coeff2 ){
+	return _mm_set1_epi32( ( int )( ( ( unsigned int )coeff1 & 0xffff ) | ( ( unsigned int )coeff2 << 16 ) ) );
+}
+
+// convert one channel of 16 pixels. ycb contains Y and Cb interleaved, cr contains Cr
+// interleaved with 0 for each group of 4 pixels
+static inline __m128i fConvertChannel( const __m128i *ycb, const __m128i *cr,
+const __m128i &coeffYCb, const __m128i &coeffCr, const __m128i &offset ){
+	__m128i sums[ 4 ];
+	int i;
+	
+	for( i=0; i<4; i++ ){
+		sums[ i ] = _mm_add_epi32( _mm_madd_epi16( ycb[ i ], coeffYCb ), _mm_madd_epi16( cr[ i ], coeffCr ) );
+		sums[ i ] = _mm_srai_epi32( _mm_add_epi32( sums[ i ], offset ), CONV_BITS );
+	}
+	
+	return _mm_packus_epi16( _mm_packs_epi32( sums[ 0 ], sums[ 1 ] ), _mm_packs_epi32( sums[ 2 ], sums[ 3 ] ) );
+}
+#endif
+
+
+
+// Class dethColorConversion
+//////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+dethColorConversion::dethColorConversion() :
+pCoefficientsSIMD( true ),
+pUseSIMD( true )
+{
+	SetMatrix( decColorMatrix3() );
+}
+
+dethColorConversion::~dethColorConversion(){
+}
+
+
+
+// Management
+///////////////
+
+void dethColorConversion::SetMatrix( const decColorMatrix3 &matrix ){
+	// the color conversion matrix transforms from [0..1] to [0..1]. the fixed point
+	// coefficients transform from [0..255] to [0..255] instead. the offsets include
+	// rounding to the nearest value
+	const float values[ 12 ] = {
+		matrix.a11, matrix.a12, matrix.a13, matrix.a14,
+		matrix.a21, matrix.a22, matrix.a23, matrix.a24,
+		matrix.a31, matrix.a32, matrix.a33, matrix.a34 };
+	int i;
+	
+	pCoefficientsSIMD = true;
+	
+	for( i=0; i<12; i++ ){
+		if( i % 4 == 3 ){
+			pCoefficients[ i ] = ( int )floorf( values[ i ] * 255.0f * ( float )CONV_ONE + 0.5f ) + CONV_ONE / 2;
+			
+		}else{
+			pCoefficients[ i ] = ( int )floorf( values[ i ] * ( float )CONV_ONE + 0.5f );
+			
+			// the SIMD conversion multiplies 16 bit coefficients
+			if( pCoefficients[ i ] < -32768 || pCoefficients[ i ] > 32767 ){
+				pCoefficientsSIMD = false;
+			}
+		}
+	}
+}
+
+bool dethColorConversion::GetSIMDSupported(){
+#ifdef DETH_CONVERT_SSE
+	return true;
+#else
+	return false;
+#endif
+}
+
+void dethColorConversion::SetUseSIMD( bool useSIMD ){
+	pUseSIMD = useSIMD;
+}
+
+void dethColorConversion::ConvertRow( const unsigned char *lineY, const unsigned char *lineCb,
+const unsigned char *lineCr, int pictureX, int width, int chromaShift, sRGB8 *destination ) const{
+	const int * const c = pCoefficients;
+	int x = 0;
+	
+	// pixels are converted starting at the picture position. with chroma subsampling
+	// an odd picture position starts in the middle of a chroma value. convert this
+	// pixel individually to align the SIMD conversion to chroma values
+	if( chromaShift == 1 && ( pictureX & 1 ) == 1 && width > 0 ){
+		fConvertPixel( c, lineY[ pictureX ], lineCb[ pictureX >> 1 ],
+			lineCr[ pictureX >> 1 ], destination[ 0 ] );
+		x++;
+	}
+	
+#ifdef DETH_CONVERT_SSE
+	if( pUseSIMD && pCoefficientsSIMD ){
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i coeffYCbR = fCoeffPair( c[ 0 ], c[ 1 ] );
+		const __m128i coeffYCbG = fCoeffPair( c[ 4 ], c[ 5 ] );
+		const __m128i coeffYCbB = fCoeffPair( c[ 8 ], c[ 9 ] );
+		const __m128i coeffCrR = fCoeffPair( c[ 2 ], 0 );
+		const __m128i coeffCrG = fCoeffPair( c[ 6 ], 0 );
+		const __m128i coeffCrB = fCoeffPair( c[ 10 ], 0 );
+		const __m128i offsetR = _mm_set1_epi32( c[ 3 ] );
+		const __m128i offsetG = _mm_set1_epi32( c[ 7 ] );
+		const __m128i offsetB = _mm_set1_epi32( c[ 11 ] );
+		int i;
+		
+		for( ; x+16<width; x+=16 ){
+			const int px = pictureX + x;
+			const __m128i valueY = _mm_loadu_si128( ( const __m128i * )( lineY + px ) );
+			__m128i valueCb, valueCr;
+			
+			if( chromaShift == 1 ){
+				valueCb = _mm_loadl_epi64( ( const __m128i * )( lineCb + ( px >> 1 ) ) );
+				valueCr = _mm_loadl_epi64( ( const __m128i * )( lineCr + ( px >> 1 ) ) );
+				valueCb = _mm_unpacklo_epi8( valueCb, valueCb );
+				valueCr = _mm_unpacklo_epi8( valueCr, valueCr );
+				
+			}else{
+				valueCb = _mm_loadu_si128( ( const __m128i * )( lineCb + px ) );
+				valueCr = _mm_loadu_si128( ( const __m128i * )( lineCr + px ) );
+			}
+			
+			// pixels 0-7 and 8-15 as 16 bit values with Y and Cb interleaved for the
+			// multiply-add and Cr interleaved with 0
+			const __m128i wordY1 = _mm_unpacklo_epi8( valueY, zero );
+			const __m128i wordY2 = _mm_unpackhi_epi8( valueY, zero );
+			const __m128i wordCb1 = _mm_unpacklo_epi8( valueCb, zero );
+			const __m128i wordCb2 = _mm_unpackhi_epi8( valueCb, zero );
+			const __m128i wordCr1 = _mm_unpacklo_epi8( valueCr, zero );
+			const __m128i wordCr2 = _mm_unpackhi_epi8( valueCr, zero );
+			
+			const __m128i ycb[ 4 ] = {
+				_mm_unpacklo_epi16( wordY1, wordCb1 ), _mm_unpackhi_epi16( wordY1, wordCb1 ),
+				_mm_unpacklo_epi16( wordY2, wordCb2 ), _mm_unpackhi_epi16( wordY2, wordCb2 ) };
+			const __m128i cr[ 4 ] = {
+				_mm_unpacklo_epi16( wordCr1, zero ), _mm_unpackhi_epi16( wordCr1, zero ),
+				_mm_unpacklo_epi16( wordCr2, zero ), _mm_unpackhi_epi16( wordCr2, zero ) };
+				
+			const __m128i red = fConvertChannel( ycb, cr, coeffYCbR, coeffCrR, offsetR );
+			const __m128i green = fConvertChannel( ycb, cr, coeffYCbG, coeffCrG, offsetG );
+			const __m128i blue = fConvertChannel( ycb, cr, coeffYCbB, coeffCrB, offsetB );
+			
+			// interleave to 4 byte pixels and store them overlapping. the last pixel writes
+			// one byte into the next pixel which is why the loop leaves at least one pixel
+			const __m128i rg1 = _mm_unpacklo_epi8( red, green );
+			const __m128i rg2 = _mm_unpackhi_epi8( red, green );
+			const __m128i b1 = _mm_unpacklo_epi8( blue, zero );
+			const __m128i b2 = _mm_unpackhi_epi8( blue, zero );
+			const __m128i quads[ 4 ] = {
+				_mm_unpacklo_epi16( rg1, b1 ), _mm_unpackhi_epi16( rg1, b1 ),
+				_mm_unpacklo_epi16( rg2, b2 ), _mm_unpackhi_epi16( rg2, b2 ) };
+			unsigned char * const pixels = ( unsigned char * )( destination + x );
+			
+			for( i=0; i<4; i++ ){
+				__m128i quad = quads[ i ];
+				int j;
+				
+				for( j=0; j<4; j++ ){
+					const int value = _mm_cvtsi128_si32( quad );
+					memcpy( pixels + ( i * 4 + j ) * 3, &value, 4 );
+					quad = _mm_srli_si128( quad, 4 );
+				}
+			}
+		}
+	}
+#endif
+	
+	for( ; x<width; x++ ){
+		const int px = pictureX + x;
+		fConvertPixel( c, lineY[ px ], lineCb[ px >> chromaShift ],
+			lineCr[ px >> chromaShift ], destination[ x ] );
+	}
+}
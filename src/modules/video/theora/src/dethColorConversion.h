@@ -0,0 +1,90 @@
+/* 
+ * Drag[en]gine Theora Video Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DETHCOLORCONVERSION_H_
+#define _DETHCOLORCONVERSION_H_
+
+class decColorMatrix3;
+struct sRGB8;
+
+
+
+/**
+ * \brief YCbCr to RGB color conversion.
+ * 
+ * Converts rows of YCbCr color planes into interleaved RGB pixels using fixed point
+ * coefficients calculated from a color conversion matrix. Chroma planes with half
+ * width are upsampled by repeating the chroma values.
+ */
+class dethColorConversion{
+private:
+	int pCoefficients[ 12 ];
+	bool pCoefficientsSIMD;
+	bool pUseSIMD;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create color conversion using the identity matrix. */
+	dethColorConversion();
+	
+	/** \brief Clean up color conversion. */
+	~dethColorConversion();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/**
+	 * \brief Set color conversion matrix.
+	 * \details The matrix transforms from [0..1] to [0..1].
+	 */
+	void SetMatrix( const decColorMatrix3 &matrix );
+	
+	/** \brief SIMD conversion is supported. */
+	static bool GetSIMDSupported();
+	
+	/** \brief Use SIMD conversion if supported. */
+	inline bool GetUseSIMD() const{ return pUseSIMD; }
+	
+	/**
+	 * \brief Set to use SIMD conversion if supported.
+	 * \details Disable to use the scalar conversion. Used by the developer mode to
+	 *          test and benchmark the conversions against each other.
+	 */
+	void SetUseSIMD( bool useSIMD );
+	
+	/**
+	 * \brief Convert row.
+	 * 
+	 * Converts \em width pixels starting at \em pictureX in the Y plane. \em chromaShift
+	 * is 1 if the chroma planes have half width or 0 otherwise.
+	 */
+	void ConvertRow( const unsigned char *lineY, const unsigned char *lineCb,
+		const unsigned char *lineCr, int pictureX, int width, int chromaShift,
+		sRGB8 *destination ) const;
+	/*@}*/
+};
+
+#endif
@@ -0,0 +1,489 @@
+/* 
+ * Drag[en]gine Theora Video Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dethDeveloperMode.h"
+#include "dethColorConversion.h"
+#include "dethOggReader.h"
+#include "dethVideoDecoder.h"
+#include "deVideoTheora.h"
+
+#include <dragengine/deEngine.h>
+#include <dragengine/common/exceptions.h>
+#include <dragengine/common/file/decBaseFileReader.h>
+#include <dragengine/common/file/decBaseFileReaderReference.h>
+#include <dragengine/common/file/decPath.h>
+#include <dragengine/common/math/decMath.h>
+#include <dragengine/common/string/decString.h>
+#include <dragengine/common/string/unicode/decUnicodeString.h>
+#include <dragengine/common/string/unicode/decUnicodeArgumentList.h>
+#include <dragengine/common/utils/decTimer.h>
+#include <dragengine/filesystem/deVirtualFileSystem.h>
+#include <dragengine/resources/image/deImage.h>
+
+
+
+// pseudo random values reproducible across runs
+static inline unsigned char fTestValue( unsigned int &seed ){
+	seed = seed * 1103515245 + 12345;
+	return ( unsigned char )( seed >> 16 );
+}
+
+// color conversion using the float matrix rounded to the nearest value
+static inline void fReferencePixel( const decColorMatrix3 &m, int y, int cb, int cr, int *rgb ){
+	const float fy = ( float )y / 255.0f;
+	const float fcb = ( float )cb / 255.0f;
+	const float fcr = ( float )cr / 255.0f;
+	
+	rgb[ 0 ] = decMath::clamp( ( int )floorf( ( m.a11 * fy + m.a12 * fcb + m.a13 * fcr + m.a14 ) * 255.0f + 0.5f ), 0, 255 );
+	rgb[ 1 ] = decMath::clamp( ( int )floorf( ( m.a21 * fy + m.a22 * fcb + m.a23 * fcr + m.a24 ) * 255.0f + 0.5f ), 0, 255 );
+	rgb[ 2 ] = decMath::clamp( ( int )floorf( ( m.a31 * fy + m.a32 * fcb + m.a33 * fcr + m.a34 ) * 255.0f + 0.5f ), 0, 255 );
+}
+
+static inline int fPixelDifference( const sRGB8 &pixel, const int *rgb ){
+	return decMath::max( abs( ( int )pixel.red - rgb[ 0 ] ), abs( ( int )pixel.green - rgb[ 1 ] ),
+		abs( ( int )pixel.blue - rgb[ 2 ] ) );
+}
+
+// compares the scalar and SIMD conversion of a row against each other and the reference
+struct sConversionTestResult{
+	int pixelCount;
+	int differentCount;
+	int maxDifferenceSIMD;
+	int maxDifferenceScalarReference;
+	int maxDifferenceSIMDReference;
+	
+	sConversionTestResult() : pixelCount( 0 ), differentCount( 0 ), maxDifferenceSIMD( 0 ),
+	maxDifferenceScalarReference( 0 ), maxDifferenceSIMDReference( 0 ){
+	}
+	
+	void TestRow( const dethColorConversion &scalar, const dethColorConversion &simd,
+	const decColorMatrix3 &matrix, const unsigned char *lineY, const unsigned char *lineCb,
+	const unsigned char *lineCr, int pictureX, int width, int chromaShift,
+	sRGB8 *rowScalar, sRGB8 *rowSIMD ){
+		scalar.ConvertRow( lineY, lineCb, lineCr, pictureX, width, chromaShift, rowScalar );
+		simd.ConvertRow( lineY, lineCb, lineCr, pictureX, width, chromaShift, rowSIMD );
+		
+		int x, rgb[ 3 ];
+		for( x=0; x<width; x++ ){
+			const int px = pictureX + x;
+			const int rgbSIMD[ 3 ] = { rowSIMD[ x ].red, rowSIMD[ x ].green, rowSIMD[ x ].blue };
+			const int difference = fPixelDifference( rowScalar[ x ], rgbSIMD );
+			if( difference > 0 ){
+				differentCount++;
+				maxDifferenceSIMD = decMath::max( maxDifferenceSIMD, difference );
+			}
+			
+			fReferencePixel( matrix, lineY[ px ], lineCb[ px >> chromaShift ], lineCr[ px >> chromaShift ], rgb );
+			maxDifferenceScalarReference = decMath::max( maxDifferenceScalarReference,
+				fPixelDifference( rowScalar[ x ], rgb ) );
+			maxDifferenceSIMDReference = decMath::max( maxDifferenceSIMDReference,
+				fPixelDifference( rowSIMD[ x ], rgb ) );
+		}
+		
+		pixelCount += width;
+	}
+	
+	bool Passed() const{
+		return maxDifferenceSIMD <= 1 && maxDifferenceScalarReference <= 1 && maxDifferenceSIMDReference <= 1;
+	}
+	
+	void Report( const char *name, decUnicodeString &answer ) const{
+		decString text;
+		text.Format( "%s: %s pixels=%d SIMD/scalar: max difference=%d (%d pixels differ)"
+			" scalar/float: max difference=%d SIMD/float: max difference=%d\n", name,
+			Passed() ? "passed" : "FAILED", pixelCount, maxDifferenceSIMD, differentCount,
+			maxDifferenceScalarReference, maxDifferenceSIMDReference );
+		answer.AppendFromUTF8( text );
+	}
+};
+
+
+
+// Class dethDeveloperMode
+////////////////////////////
+
+// Constructor, destructor
+////////////////////////////
+
+dethDeveloperMode::dethDeveloperMode( deVideoTheora &module ) :
+pModule( module ),
+pEnabled( false ){
+}
+
+dethDeveloperMode::~dethDeveloperMode(){
+}
+
+
+
+// Management
+///////////////
+
+bool dethDeveloperMode::ExecuteCommand( const decUnicodeArgumentList &command, decUnicodeString &answer ){
+	if( command.MatchesArgumentAt( 0, "dm_enable" ) ){
+		pCmdEnable( command, answer );
+		return true;
+	}
+	
+	if( ! pEnabled ){
+		return false;
+	}
+	
+	if( command.MatchesArgumentAt( 0, "dm_help" ) ){
+		pCmdHelp( command, answer );
+		return true;
+		
+	}else if( command.MatchesArgumentAt( 0, "dm_benchmark_seek" ) ){
+		pCmdBenchmarkSeek( command, answer );
+		return true;
+		
+	}else if( command.MatchesArgumentAt( 0, "dm_benchmark_decode" ) ){
+		pCmdBenchmarkDecode( command, answer );
+		return true;
+		
+	}else if( command.MatchesArgumentAt( 0, "dm_benchmark_convert" ) ){
+		pCmdBenchmarkConvert( command, answer );
+		return true;
+		
+	}else if( command.MatchesArgumentAt( 0, "dm_test_conversion" ) ){
+		pCmdTestConversion( command, answer );
+		return true;
+	}
+	
+	return false;
+}
+
+
+
+// Private functions
+//////////////////////
+
+void dethDeveloperMode::pCmdHelp( const decUnicodeArgumentList &command, decUnicodeString &answer ){
+	answer.SetFromUTF8( "dm_help => Displays this help screen.\n" );
+	answer.AppendFromUTF8( "dm_benchmark_seek <path> [seeks] => Benchmark random seeking against sequential decoding of a video file.\n" );
+	answer.AppendFromUTF8( "dm_benchmark_decode <path> [frames] => Benchmark decoding a video file with scalar against SIMD color conversion.\n" );
+	answer.AppendFromUTF8( "dm_benchmark_convert [width] [height] => Benchmark scalar against SIMD color conversion of 4:2:0 frames.\n" );
+	answer.AppendFromUTF8( "dm_test_conversion => Test SIMD against scalar and float reference color conversion.\n" );
+}
+
+void dethDeveloperMode::pCmdEnable( const decUnicodeArgumentList &command, decUnicodeString &answer ){
+	pEnabled = true;
+	answer.AppendFromUTF8( "Developer Mode is enabled" );
+}
+
+void dethDeveloperMode::pCmdBenchmarkSeek( const decUnicodeArgumentList &command,
+decUnicodeString &answer ){
+	if( command.GetArgumentCount() < 2 ){
+		answer.SetFromUTF8( "dm_benchmark_seek <path> [seeks]" );
+		return;
+	}
+	
+	int seekCount = 50;
+	if( command.GetArgumentCount() > 2 ){
+		seekCount = decMath::max( command.GetArgumentAt( 2 )->ToInt(), 1 );
+	}
+	
+	const decPath path( decPath::CreatePathUnix( command.GetArgumentAt( 1 )->ToUTF8() ) );
+	decBaseFileReaderReference reader;
+	reader.TakeOver( pModule.GetGameEngine()->GetVirtualFileSystem()->OpenFileForReading( path ) );
+	
+	dethVideoDecoder decoder( pModule, reader );
+	const int frameCount = decoder.GetFrameCount();
+	if( frameCount < 1 ){
+		answer.SetFromUTF8( "video has no frames" );
+		return;
+	}
+	
+	const int size = decoder.GetWidth() * decoder.GetHeight() * 3;
+	char * const buffer = new char[ size ];
+	const int sequentialCount = decMath::min( frameCount, 100 );
+	int i, failed = 0, misplaced = 0;
+	float elapsedSequential, elapsedSeek;
+	decTimer timer;
+	
+	try{
+		// sequential decoding is the reference cost of a single frame. a seek has to
+		// decode from the previous key frame up to the target frame on top of that
+		decoder.SetPosition( 0 );
+		timer.Reset();
+		for( i=0; i<sequentialCount; i++ ){
+			if( ! decoder.DecodeFrame( buffer, size, NULL, 0 ) ){
+				failed++;
+			}
+		}
+		elapsedSequential = timer.GetElapsedTime();
+		
+		// seek to frames spread evenly over the video in a scattered order. uses the
+		// golden ratio sequence to be reproducible across runs
+		timer.Reset();
+		for( i=0; i<seekCount; i++ ){
+			const int frame = decMath::min( ( int )( fmod( 0.6180339887 * ( double )( i + 1 ), 1.0 )
+				* ( double )frameCount ), frameCount - 1 );
+				
+			decoder.SetPosition( frame );
+			if( decoder.GetPosition() != frame ){
+				misplaced++;
+			}
+			if( ! decoder.DecodeFrame( buffer, size, NULL, 0 ) ){
+				failed++;
+			}
+		}
+		elapsedSeek = timer.GetElapsedTime();
+		
+	}catch( const deException & ){
+		delete [] buffer;
+		throw;
+	}
+	
+	delete [] buffer;
+	
+	decString text;
+	text.Format( "file=%s size=%dx%d frames=%d file size=%d\n", path.GetPathUnix().GetString(),
+		decoder.GetWidth(), decoder.GetHeight(), frameCount, reader->GetLength() );
+	answer.AppendFromUTF8( text );
+	text.Format( "sequential: %.2f ms/frame (%d frames)\n",
+		elapsedSequential * 1e3f / ( float )sequentialCount, sequentialCount );
+	answer.AppendFromUTF8( text );
+	text.Format( "random seek: %.2f ms/seek (%d seeks, %.1f frames decoded per seek)\n",
+		elapsedSeek * 1e3f / ( float )seekCount, seekCount,
+		elapsedSeek / decMath::max( elapsedSequential / ( float )sequentialCount, 1e-6f )
+			/ ( float )seekCount );
+	answer.AppendFromUTF8( text );
+	text.Format( "failed decodes: %d, seeks landing on wrong frame: %d\n", failed, misplaced );
+	answer.AppendFromUTF8( text );
+}
+
+void dethDeveloperMode::pCmdBenchmarkDecode( const decUnicodeArgumentList &command,
+decUnicodeString &answer ){
+	if( command.GetArgumentCount() < 2 ){
+		answer.SetFromUTF8( "dm_benchmark_decode <path> [frames]" );
+		return;
+	}
+	
+	const decPath path( decPath::CreatePathUnix( command.GetArgumentAt( 1 )->ToUTF8() ) );
+	decBaseFileReaderReference reader;
+	reader.TakeOver( pModule.GetGameEngine()->GetVirtualFileSystem()->OpenFileForReading( path ) );
+	
+	dethVideoDecoder decoder( pModule, reader );
+	int frameCount = decMath::min( decoder.GetFrameCount(), 300 );
+	if( command.GetArgumentCount() > 2 ){
+		frameCount = decMath::min( decMath::max( command.GetArgumentAt( 2 )->ToInt(), 1 ),
+			decoder.GetFrameCount() );
+	}
+	if( frameCount < 1 ){
+		answer.SetFromUTF8( "video has no frames" );
+		return;
+	}
+	
+	// decoding includes the theora decoding which is the same for both runs. the
+	// difference between the runs is the time spent converting the color planes
+	const int size = decoder.GetWidth() * decoder.GetHeight() * 3;
+	char * const buffer = new char[ size ];
+	float elapsedScalar, elapsedSIMD;
+	
+	try{
+		decoder.GetConversion().SetUseSIMD( false );
+		elapsedScalar = pBenchmarkDecodeRun( decoder, buffer, size, frameCount );
+		
+		decoder.GetConversion().SetUseSIMD( true );
+		elapsedSIMD = pBenchmarkDecodeRun( decoder, buffer, size, frameCount );
+		
+	}catch( const deException & ){
+		delete [] buffer;
+		throw;
+	}
+	
+	delete [] buffer;
+	
+	decString text;
+	text.Format( "file=%s size=%dx%d frames=%d simd=%s\n", path.GetPathUnix().GetString(),
+		decoder.GetWidth(), decoder.GetHeight(), frameCount,
+		dethColorConversion::GetSIMDSupported() ? "yes" : "no" );
+	answer.AppendFromUTF8( text );
+	text.Format( "scalar: %.2f ms/frame (%.1f fps)\n", elapsedScalar * 1e3f / ( float )frameCount,
+		( float )frameCount / decMath::max( elapsedScalar, 1e-6f ) );
+	answer.AppendFromUTF8( text );
+	text.Format( "SIMD: %.2f ms/frame (%.1f fps, %.2fx)\n", elapsedSIMD * 1e3f / ( float )frameCount,
+		( float )frameCount / decMath::max( elapsedSIMD, 1e-6f ),
+		elapsedScalar / decMath::max( elapsedSIMD, 1e-6f ) );
+	answer.AppendFromUTF8( text );
+}
+
+float dethDeveloperMode::pBenchmarkDecodeRun( dethVideoDecoder &decoder, char *buffer,
+int size, int frameCount ){
+	decTimer timer;
+	int i;
+	
+	decoder.SetPosition( 0 );
+	timer.Reset();
+	
+	for( i=0; i<frameCount; i++ ){
+		if( ! decoder.DecodeFrame( buffer, size, NULL, 0 ) ){
+			break;
+		}
+	}
+	
+	return timer.GetElapsedTime();
+}
+
+void dethDeveloperMode::pCmdBenchmarkConvert( const decUnicodeArgumentList &command,
+decUnicodeString &answer ){
+	int width = 1920;
+	int height = 1080;
+	if( command.GetArgumentCount() > 2 ){
+		width = decMath::max( command.GetArgumentAt( 1 )->ToInt(), 2 ) & ~1;
+		height = decMath::max( command.GetArgumentAt( 2 )->ToInt(), 2 ) & ~1;
+	}
+	
+	decColorMatrix3 matrix;
+	dethOggReader::DefaultColorConversionMatrix( matrix );
+	
+	dethColorConversion conversionScalar;
+	conversionScalar.SetMatrix( matrix );
+	conversionScalar.SetUseSIMD( false );
+	
+	dethColorConversion conversionSIMD;
+	conversionSIMD.SetMatrix( matrix );
+	
+	// 4:2:0 planes filled with noise. the chroma planes have half width and height
+	const int sizeY = width * height;
+	const int sizeChroma = ( width / 2 ) * ( height / 2 );
+	const int frameCount = 30;
+	unsigned char * const planes = new unsigned char[ sizeY + sizeChroma * 2 ];
+	sRGB8 * const destination = new sRGB8[ sizeY ];
+	unsigned int seed = 1;
+	float elapsedScalar, elapsedSIMD;
+	int i;
+	
+	for( i=0; i<sizeY+sizeChroma*2; i++ ){
+		planes[ i ] = fTestValue( seed );
+	}
+	
+	pBenchmarkConvertRun( conversionSIMD, planes, planes + sizeY, planes + sizeY + sizeChroma,
+		width, height, destination, 1 ); // warm up
+	elapsedScalar = pBenchmarkConvertRun( conversionScalar, planes, planes + sizeY,
+		planes + sizeY + sizeChroma, width, height, destination, frameCount );
+	elapsedSIMD = pBenchmarkConvertRun( conversionSIMD, planes, planes + sizeY,
+		planes + sizeY + sizeChroma, width, height, destination, frameCount );
+		
+	delete [] destination;
+	delete [] planes;
+	
+	decString text;
+	text.Format( "size=%dx%d format=4:2:0 frames=%d simd=%s\n", width, height, frameCount,
+		dethColorConversion::GetSIMDSupported() ? "yes" : "no" );
+	answer.AppendFromUTF8( text );
+	text.Format( "scalar: %.2f ms/frame (%.1f fps)\n", elapsedScalar * 1e3f / ( float )frameCount,
+		( float )frameCount / decMath::max( elapsedScalar, 1e-6f ) );
+	answer.AppendFromUTF8( text );
+	text.Format( "SIMD: %.2f ms/frame (%.1f fps, %.2fx)\n", elapsedSIMD * 1e3f / ( float )frameCount,
+		( float )frameCount / decMath::max( elapsedSIMD, 1e-6f ),
+		elapsedScalar / decMath::max( elapsedSIMD, 1e-6f ) );
+	answer.AppendFromUTF8( text );
+}
+
+float dethDeveloperMode::pBenchmarkConvertRun( const dethColorConversion &conversion,
+const unsigned char *planeY, const unsigned char *planeCb, const unsigned char *planeCr,
+int width, int height, sRGB8 *destination, int frameCount ){
+	const int strideChroma = width / 2;
+	decTimer timer;
+	int i, y;
+	
+	timer.Reset();
+	
+	for( i=0; i<frameCount; i++ ){
+		for( y=0; y<height; y++ ){
+			conversion.ConvertRow( planeY + width * y, planeCb + strideChroma * ( y >> 1 ),
+				planeCr + strideChroma * ( y >> 1 ), 0, width, 1, destination + width * y );
+		}
+	}
+	
+	return timer.GetElapsedTime();
+}
+
+void dethDeveloperMode::pCmdTestConversion( const decUnicodeArgumentList &command,
+decUnicodeString &answer ){
+	decColorMatrix3 matrix;
+	dethOggReader::DefaultColorConversionMatrix( matrix );
+	
+	dethColorConversion conversionScalar;
+	conversionScalar.SetMatrix( matrix );
+	conversionScalar.SetUseSIMD( false );
+	
+	dethColorConversion conversionSIMD;
+	conversionSIMD.SetMatrix( matrix );
+	
+	if( ! dethColorConversion::GetSIMDSupported() ){
+		answer.AppendFromUTF8( "SIMD conversion is not supported by this build. Both runs use the scalar conversion.\n" );
+	}
+	
+	// all YCbCr combinations. each row contains all Y values for one Cb/Cr combination.
+	// the rows are 257 pixels wide since the SIMD conversion leaves the last pixel to
+	// the scalar conversion. this way all Y values are converted by the SIMD code
+	unsigned char lineY[ 272 ], lineCb[ 272 ], lineCr[ 272 ];
+	sRGB8 rowScalar[ 272 ], rowSIMD[ 272 ];
+	sConversionTestResult resultAll;
+	int i, cb, cr;
+	
+	for( i=0; i<272; i++ ){
+		lineY[ i ] = ( unsigned char )i;
+	}
+	
+	for( cb=0; cb<256; cb++ ){
+		memset( lineCb, cb, sizeof( lineCb ) );
+		
+		for( cr=0; cr<256; cr++ ){
+			memset( lineCr, cr, sizeof( lineCr ) );
+			resultAll.TestRow( conversionScalar, conversionSIMD, matrix, lineY, lineCb, lineCr,
+				0, 257, 0, rowScalar, rowSIMD );
+		}
+	}
+	
+	resultAll.Report( "all values 4:4:4", answer );
+	
+	// rows with noise using all picture offsets, widths and chroma subsampling. tests the
+	// chroma upsampling and the alignment handling for odd picture offsets
+	sConversionTestResult resultRows[ 2 ];
+	unsigned int seed = 1;
+	int chromaShift, pictureX, width;
+	
+	for( chromaShift=0; chromaShift<2; chromaShift++ ){
+		for( pictureX=0; pictureX<4; pictureX++ ){
+			for( width=1; width<=200; width++ ){
+				for( i=0; i<272; i++ ){
+					lineY[ i ] = fTestValue( seed );
+					lineCb[ i ] = fTestValue( seed );
+					lineCr[ i ] = fTestValue( seed );
+				}
+				
+				resultRows[ chromaShift ].TestRow( conversionScalar, conversionSIMD, matrix,
+					lineY, lineCb, lineCr, pictureX, width, chromaShift, rowScalar, rowSIMD );
+			}
+		}
+	}
+	
+	resultRows[ 0 ].Report( "noise rows 4:4:4", answer );
+	resultRows[ 1 ].Report( "noise rows 4:2:x", answer );
+}
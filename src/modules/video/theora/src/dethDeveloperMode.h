@@ -0,0 +1,87 @@
+/* 
+ * Drag[en]gine Theora Video Module
+ *
+ * Copyright (C) 2020, Roland Plüss (roland@rptd.ch)
+ * 
+ * This program is free software; you can redistribute it and/or 
+ * modify it under the terms of the GNU General Public License 
+ * as published by the Free Software Foundation; either 
+ * version 2 of the License, or (at your option) any later 
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef _DETHDEVELOPERMODE_H_
+#define _DETHDEVELOPERMODE_H_
+
+class deVideoTheora;
+class dethColorConversion;
+class dethVideoDecoder;
+class decUnicodeArgumentList;
+class decUnicodeString;
+struct sRGB8;
+
+
+
+/**
+ * \brief Developer Mode.
+ * 
+ * Provides access to the developer mode. This is not required for games
+ * nor editing tools and is used only by the module developers for testing
+ * and trouble shooting.
+ */
+class dethDeveloperMode{
+private:
+	deVideoTheora &pModule;
+	bool pEnabled;
+	
+	
+	
+public:
+	/** \name Constructors and Destructors */
+	/*@{*/
+	/** \brief Create developer mode. */
+	dethDeveloperMode( deVideoTheora &module );
+	
+	/** \brief Clean up developer mode. */
+	~dethDeveloperMode();
+	/*@}*/
+	
+	
+	
+	/** \name Management */
+	/*@{*/
+	/**
+	 * \brief Executes a command.
+	 * \details If the command is recognized true is returned otherwise false.
+	 */
+	bool ExecuteCommand( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	
+	/** \brief Developer mode is enabled. */
+	inline bool GetEnabled() const{ return pEnabled; }
+	/*@}*/
+	
+	
+	
+private:
+	void pCmdHelp( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	void pCmdEnable( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	void pCmdBenchmarkSeek( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	void pCmdBenchmarkDecode( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	float pBenchmarkDecodeRun( dethVideoDecoder &decoder, char *buffer, int size, int frameCount );
+	void pCmdBenchmarkConvert( const decUnicodeArgumentList &command, decUnicodeString &answer );
+	float pBenchmarkConvertRun( const dethColorConversion &conversion, const unsigned char *planeY,
+		const unsigned char *planeCb, const unsigned char *planeCr, int width, int height,
+		sRGB8 *destination, int frameCount );
+	void pCmdTestConversion( const decUnicodeArgumentList &command, decUnicodeString &answer );
+};
+
+#endif
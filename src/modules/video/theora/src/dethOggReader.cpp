@@ -48,7 +48,11 @@ pModule( module ),
 pReader( reader ),
 pStream( NULL ),
 
-pCurFrame( 0 )
+pCurFrame( 0 ),
+
+pKeyFrames( NULL ),
+pKeyFrameCount( 0 ),
+pKeyFrameSize( 0 )
 {
 	if( ogg_sync_init( &pSyncState ) != 0 ){
 		DETHROW( deeInvalidParam );
@@ -56,6 +60,9 @@ pCurFrame( 0 )
 }
 
 dethOggReader::~dethOggReader(){
+	if( pKeyFrames ){
+		delete [] pKeyFrames;
+	}
 	if( pStream ){
 		delete pStream;
 	}
@@ -73,49 +80,114 @@ void dethOggReader::ReadStreamHeaders( dethInfos &infos ){
 	ogg_page page;
 	int serial;
 	
-	while( /* ! infos.GetHeaderFinished() && */ ReadPage( page ) ){
-		serial = ogg_page_serialno( &page );
-		
-		if( ogg_page_bos( &page ) ){
-			if( ! pStream ){
-				pStream = new dethStreamReader( this, serial );
-				//pModule.LogInfoFormat( "Stream %i: Testing for Theora", serial );
-			}
+	// the key frame index is build using a separate stream state to see all packets. each
+	// key frame stores the offset of the page the packet starts in and the number of packets
+	// starting in this page before it. after seeking to the page the packets before the key
+	// frame are skipped. leading packet data continued from a previous page is dropped by ogg
+	ogg_stream_state indexState;
+	bool hasIndexState = false;
+	ogg_int64_t packetStartOffset = 0;
+	int packetStartIndex = 0;
+	int indexFrame = 0;
+	ogg_packet packet;
+	
+	pKeyFrameCount = 0;
+	
+	try{
+		while( /* ! infos.GetHeaderFinished() && */ ReadPage( page ) ){
+			const ogg_int64_t pageOffset = pPageOffset( page );
+			serial = ogg_page_serialno( &page );
 			
-		}else{
-			if( ! pStream ) break;
-			//pModule.LogInfoFormat( "Stream %i: additional page", serial );
-		}
-		
-		if( pStream && serial == pStream->GetSerial() ){
-			pageGranulePos = ogg_page_granulepos( &page );
-			if( pageGranulePos > maxGranulePos ){
-				maxGranulePos = pageGranulePos;
+			if( ogg_page_bos( &page ) ){
+				if( ! pStream ){
+					pStream = new dethStreamReader( this, serial );
+					//pModule.LogInfoFormat( "Stream %i: Testing for Theora", serial );
+					
+					if( ogg_stream_init( &indexState, serial ) != 0 ){
+						DETHROW( deeOutOfMemory );
+					}
+					hasIndexState = true;
+					indexFrame = 0;
+					pKeyFrameCount = 0;
+				}
+				
+			}else{
+				if( ! pStream ) break;
+				//pModule.LogInfoFormat( "Stream %i: additional page", serial );
 			}
 			
-			if( ! infos.GetHeaderFinished() ){
-				pStream->AddPage( page );
+			if( pStream && serial == pStream->GetSerial() ){
+				pageGranulePos = ogg_page_granulepos( &page );
+				if( pageGranulePos > maxGranulePos ){
+					maxGranulePos = pageGranulePos;
+				}
 				
-				if( ! pStream->ReadTheoraHeader( infos ) ){
-					//pModule.LogWarnFormat( "Stream %i: Not a Theora stream, ignoring it", serial );
-					delete pStream;
-					pStream = NULL;
+				if( ! infos.GetHeaderFinished() ){
+					pStream->AddPage( page );
+					
+					if( ! pStream->ReadTheoraHeader( infos ) ){
+						//pModule.LogWarnFormat( "Stream %i: Not a Theora stream, ignoring it", serial );
+						delete pStream;
+						pStream = NULL;
+						
+						ogg_stream_clear( &indexState );
+						hasIndexState = false;
+						continue;
+					}
+				}
+				
+				// add key frames to index
+				if( ! ogg_page_continued( &page ) ){
+					packetStartOffset = pageOffset;
+					packetStartIndex = 0;
+				}
+				
+				if( ogg_stream_pagein( &indexState, &page ) != 0 ){
+					DETHROW( deeOutOfMemory );
+				}
+				
+				while( ogg_stream_packetout( &indexState, &packet ) == 1 ){
+					if( th_packet_isheader( &packet ) == 0 ){
+						if( th_packet_iskeyframe( &packet ) == 1 ){
+							pAddKeyFrame( indexFrame, packetStartOffset, packetStartIndex );
+						}
+						indexFrame++;
+					}
+					
+					// next packet starts in this page
+					if( packetStartOffset == pageOffset ){
+						packetStartIndex++;
+						
+					}else{
+						packetStartOffset = pageOffset;
+						packetStartIndex = 0;
+					}
 				}
 			}
 		}
+		
+		if( hasIndexState ){
+			ogg_stream_clear( &indexState );
+			hasIndexState = false;
+		}
+		
+	}catch( const deException & ){
+		if( hasIndexState ){
+			ogg_stream_clear( &indexState );
+		}
+		throw;
 	}
 	
 	if( infos.GetHeaderFinished() ){
 		const th_info &tinfo = infos.GetInfo();
-		decColorMatrix3 colorMatrix;
 		
 		infos.SetWidth( tinfo.pic_width );
 		infos.SetHeight( tinfo.pic_height );
 		infos.SetFrameCount( pStream ? pStream->GranuleToFrame( maxGranulePos ) + 1 : 0 );
 		infos.SetFrameRate( tinfo.fps_numerator / tinfo.fps_denominator );
 		
-		DefaultColorConversionMatrix( colorMatrix );
-		infos.SetColorConversionMatrix( colorMatrix );
+		// the decoder converts frames to RGB
+		infos.SetColorConversionMatrix( decColorMatrix3() );
 		
 		switch( tinfo.pixel_fmt ){
 		case TH_PF_420:
@@ -278,8 +350,17 @@ void dethOggReader::SeekFrame( int frame ){
 		
 		//pModule.LogInfoFormat( "Decoder: seek=%i current=%i", frame, pCurFrame );
 		
-		// if the seek goes backwards restart from the beginning of the file
-		if( frame < pCurFrame ){
+		// jump to the closest key frame before the frame if the seek goes backwards or if
+		// the key frame is ahead of the current frame. if the jump fails for some reason
+		// restart from the beginning of the file
+		const int keyFrame = IndexOfKeyFrameBefore( frame );
+		
+		if( keyFrame != -1 && ( frame < pCurFrame || pKeyFrames[ keyFrame ].frame > pCurFrame ) ){
+			if( ! pSeekKeyFrame( pKeyFrames[ keyFrame ] ) ){
+				Rewind();
+			}
+			
+		}else if( frame < pCurFrame ){
 			Rewind();
 		}
 		
@@ -306,6 +387,35 @@ void dethOggReader::SeekFrame( int frame ){
 	}
 }
 
+const dethOggReader::sKeyFrame &dethOggReader::GetKeyFrameAt( int index ) const{
+	if( index < 0 || index >= pKeyFrameCount ){
+		DETHROW( deeInvalidParam );
+	}
+	
+	return pKeyFrames[ index ];
+}
+
+int dethOggReader::IndexOfKeyFrameBefore( int frame ) const{
+	// key frames are sorted by frame index. bisect for the last one not after frame
+	int first = 0;
+	int last = pKeyFrameCount - 1;
+	int found = -1;
+	
+	while( first <= last ){
+		const int middle = ( first + last ) / 2;
+		
+		if( pKeyFrames[ middle ].frame <= frame ){
+			found = middle;
+			first = middle + 1;
+			
+		}else{
+			last = middle - 1;
+		}
+	}
+	
+	return found;
+}
+
 
 
 void dethOggReader::DefaultColorConversionMatrix( decColorMatrix3 &matrix ){
@@ -380,3 +490,71 @@ void dethOggReader::DefaultColorConversionMatrix( decColorMatrix3 &matrix ){
 	matrix.a33 = 0.0f;
 	matrix.a34 = -offY / excY - c4 * offCb / excCb;
 }
+
+
+
+// Private Functions
+//////////////////////
+
+ogg_int64_t dethOggReader::pPageOffset( const ogg_page &page ) const{
+	// the sync state contains the data read from the file since the last reset. the page
+	// has been taken from the buffer and the remaining bytes have not been returned yet
+	return ( ogg_int64_t )pReader.GetPosition() - ( ogg_int64_t )( pSyncState.fill - pSyncState.returned )
+		- ( ogg_int64_t )( page.header_len + page.body_len );
+}
+
+void dethOggReader::pAddKeyFrame( int frame, ogg_int64_t offset, int skipPackets ){
+	if( pKeyFrameCount == pKeyFrameSize ){
+		const int newSize = pKeyFrameSize * 3 / 2 + 16;
+		sKeyFrame * const newArray = new sKeyFrame[ newSize ];
+		if( pKeyFrames ){
+			memcpy( newArray, pKeyFrames, sizeof( sKeyFrame ) * pKeyFrameCount );
+			delete [] pKeyFrames;
+		}
+		pKeyFrames = newArray;
+		pKeyFrameSize = newSize;
+	}
+	
+	sKeyFrame &keyFrame = pKeyFrames[ pKeyFrameCount++ ];
+	keyFrame.frame = frame;
+	keyFrame.offset = offset;
+	keyFrame.skipPackets = skipPackets;
+}
+
+bool dethOggReader::pSeekKeyFrame( const sKeyFrame &keyFrame ){
+	const int serial = pStream->GetSerial();
+	int skipPackets = keyFrame.skipPackets;
+	ogg_int64_t granulePacket;
+	ogg_packet packet;
+	ogg_page page;
+	
+	// reset the sync and stream states and continue reading at the page the key frame
+	// packet starts in. packets starting in the page before the key frame are skipped
+	ogg_sync_reset( &pSyncState );
+	pStream->Reset();
+	
+	// the key frame index stores 64 bit offsets but decBaseFileReader positions are int.
+	// fail instead of seeking to a truncated position
+	if( keyFrame.offset > ( ogg_int64_t )0x7fffffff ){
+		DETHROW( deeInvalidParam );
+	}
+	pReader.SetPosition( ( int )keyFrame.offset );
+	
+	while( ReadPage( page, serial ) ){
+		pStream->AddPage( page );
+		
+		while( pStream->ReadPacket( packet ) == 1 ){
+			if( skipPackets > 0 ){
+				skipPackets--;
+				continue;
+			}
+			
+			pStream->AddPacketToDecoder( packet, granulePacket );
+			pStream->SetGranulePosition( pStream->FrameToGranule( keyFrame.frame, 0 ) );
+			pCurFrame = keyFrame.frame;
+			return true;
+		}
+	}
+	
+	return false;
+}
@@ -43,6 +43,21 @@ class deVideoTheora;
  * \date 2020
  */
 class dethOggReader{
+public:
+	/** \brief Key frame index entry. */
+	struct sKeyFrame{
+		/** \brief Frame index of key frame. */
+		int frame;
+		
+		/** \brief File offset of page the key frame packet starts in. */
+		ogg_int64_t offset;
+		
+		/** \brief Number of packets starting in the page before the key frame packet. */
+		int skipPackets;
+	};
+	
+	
+	
 private:
 	deVideoTheora &pModule;
 	
@@ -52,6 +67,10 @@ private:
 	
 	int pCurFrame;
 	
+	sKeyFrame *pKeyFrames;
+	int pKeyFrameCount;
+	int pKeyFrameSize;
+	
 public:
 	/** @name Constructors and Destructors */
 	/*@{*/
@@ -63,7 +82,10 @@ public:
 	
 	/** @name Management */
 	/*@{*/
-	/** Read streams and find theora header. */
+	/**
+	 * Read streams and find theora header. Scans the entire file to find the frame
+	 * count and builds the key frame index.
+	 */
 	void ReadStreamHeaders( dethInfos &infos );
 	
 	/** Reads data from the file returning the amount of data read. */
@@ -77,14 +99,31 @@ public:
 	inline int GetCurrentFrame() const{ return pCurFrame; }
 	/** Rewind. */
 	void Rewind();
-	/** Seek to frame. */
+	/**
+	 * Seek to frame. Jumps to the closest key frame before the frame if seeking backwards
+	 * or if the key frame is after the current frame. Then decodes up to the frame.
+	 */
 	void SeekFrame( int frame );
 	
+	/** Number of key frames in the index. */
+	inline int GetKeyFrameCount() const{ return pKeyFrameCount; }
+	
+	/** Key frame at index. */
+	const sKeyFrame &GetKeyFrameAt( int index ) const;
+	
+	/** Index of the last key frame not after frame or -1 if not found. */
+	int IndexOfKeyFrameBefore( int frame ) const;
+	
 	/** Retrieves the stream or NULL if not found. */
 	inline dethStreamReader *GetStream() const{ return pStream; }
 	/** Create default color conversion matrix. */
-	void DefaultColorConversionMatrix( decColorMatrix3 &matrix );
+	static void DefaultColorConversionMatrix( decColorMatrix3 &matrix );
 	/*@}*/
+	
+private:
+	ogg_int64_t pPageOffset( const ogg_page &page ) const;
+	void pAddKeyFrame( int frame, ogg_int64_t offset, int skipPackets );
+	bool pSeekKeyFrame( const sKeyFrame &keyFrame );
 };
 
 // end of include only once
@@ -26,10 +26,14 @@
 #include <theora/codec.h>
 #include <theora/theoradec.h>
 
+#include "dethColorConversion.h"
+
+#include <dragengine/common/math/decMath.h>
 #include <dragengine/systems/modules/video/deBaseVideoDecoder.h>
 
 class dethOggReader;
 class deVideoTheora;
+struct sRGB8;
 
 
 
@@ -38,25 +42,6 @@ class deVideoTheora;
  */
 class dethVideoDecoder : public deBaseVideoDecoder{
 public:
-	/** \brief Conversion parameters. */
-	struct sConversionParamers{
-		unsigned char offY;
-		unsigned char offCb;
-		unsigned char offCr;
-		float exclY;
-		float exclCb;
-		float exclCr;
-		float kr;
-		float kb;
-		
-		float c1;
-		float c2;
-		float c3;
-		float c4;
-		
-		float matrix[12];
-	};
-	
 	/** \brief Pixel formats. */
 	enum ePixelFormats{
 		/** \brief 4:4:4 */
@@ -91,7 +76,7 @@ private:
 	int pPictureY;
 	int pInternalPixelFormat;
 	
-	sConversionParamers pConvParams;
+	dethColorConversion pConversion;
 	
 	
 	
@@ -109,6 +94,18 @@ public:
 	
 	/** \name Management */
 	/*@{*/
+	/** \brief Width in pixels. */
+	inline int GetWidth() const{ return pWidth; }
+	
+	/** \brief Height in pixels. */
+	inline int GetHeight() const{ return pHeight; }
+	
+	/** \brief Number of frames. */
+	inline int GetFrameCount() const{ return pFrameCount; }
+	
+	/** \brief Color conversion. */
+	inline dethColorConversion &GetConversion(){ return pConversion; }
+	
 	/** \brief File position in frames from the beginning. */
 	virtual int GetPosition();
 	
@@ -128,14 +125,11 @@ public:
 	 * If successful the file position is advanced. Returns \em true if the frame
 	 * has been decoded successfully. Otherwise \em fals is returned and an error
 	 * is signaled using the engine error signaling.
+	 * 
+	 * The color planes are converted to RGB while interleaving them. The video
+	 * therefore uses the identity color conversion matrix.
 	 */
 	virtual bool DecodeFrame( void *buffer1, int size1, void *buffer2, int size2 );
-	
-	/** \brief Create default conversion parameters. */
-	void DefConvParams( sConversionParamers &convParams );
-	
-	/** \brief Convert colors. */
-	void ConvertColors( void *buffer );
 	/*@}*/
 	
 	